@@ -0,0 +1,647 @@
+/*
+ * Sample kernels shared by the nodes: the inner loops that touch every sample
+ * of a frame, in one place, so a node states what it computes and this module
+ * decides how fast that runs on the target at hand.
+ *
+ * Every kernel has exactly one definition of its result, spelled out on its
+ * declaration below, and each implementation - Arm DSP extension, GCC vector
+ * extensions, portable scalar - produces it bit for bit. A node built on
+ * native_sim and the same node on a Cortex-M therefore agree on every sample,
+ * which is what makes the host test of a node evidence about the target.
+ *
+ * Allocation free and node free, so the arithmetic is testable on its own, the
+ * same way the WAV codec and the I2S wire seam are.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_AUDIO_DSP_H_
+#define ZEPHYR_AUDIO_DSP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Q15 unity gain of the kernels: x * AUDIO_DSP_UNITY_Q15 >> 15 == x. */
+#define AUDIO_DSP_UNITY_Q15 32768
+
+/** @brief Largest audio_dsp_gain.shift: a gain of up to 2^31. */
+#define AUDIO_DSP_MAX_SHIFT 31U
+
+/**
+ * @brief A gain as a Q31 fraction and a power-of-two range, the pair
+ *        arm_scale_q31() takes.
+ *
+ * The gain is @c scale_q31 / 2^31 * 2^@c shift: a shift of 0 is a plain Q31
+ * fraction in [-1, 1), and each step of the shift doubles the range while the
+ * fraction keeps its 31 bits of resolution. Build one from a Q15 gain with
+ * audio_dsp_gain_from_q15().
+ */
+struct audio_dsp_gain {
+	/** Fraction in Q31. */
+	int32_t scale_q31;
+	/** Left shift, 0 to ::AUDIO_DSP_MAX_SHIFT. */
+	uint8_t shift;
+};
+
+/**
+ * @brief The audio_dsp_gain that scales exactly as a Q15 gain does.
+ *
+ * audio_dsp_gain_q31() with the result produces what audio_dsp_gain_q15() with
+ * @p gain_q15 produces, bit for bit, for every int32_t gain: the smallest shift
+ * that holds the gain is picked, and the fraction is the gain moved up by the
+ * rest, so no bit of it is lost.
+ */
+void audio_dsp_gain_from_q15(int32_t gain_q15, struct audio_dsp_gain *out);
+
+/**
+ * @brief Scale @p count containers by a Q15 gain.
+ *
+ * dst[i] = sat32((src[i] * gain_q15) >> 15), with the product formed in 64 bits
+ * and the shift arithmetic, so attenuation never saturates and a gain above
+ * unity clips rather than wraps. @p dst may equal @p src.
+ */
+void audio_dsp_gain_q15(int32_t *dst, const int32_t *src, size_t count, int32_t gain_q15);
+
+/**
+ * @brief Scale @p count interleaved containers by one gain per channel.
+ *
+ * dst[i] = sat32((src[i] * g.scale_q31) >> (31 - g.shift)), where g is
+ * gains[i % channels], with the product formed in 64 bits and the shift
+ * arithmetic. Sample 0 is channel 0, so @p src starts on a sample set; @p count
+ * need not end on one. @p dst may equal @p src.
+ *
+ * The cost depends on the gains, not the result: gains sharing one shift are
+ * cheaper than a mix of ranges, and gains all in (-1, 1], which cannot clip,
+ * skip the clamp. The vector implementation takes channel counts that divide
+ * its four lanes or that they divide (1, 2, 4, 8, 16); any other count runs
+ * the scalar loop, with the same result.
+ */
+void audio_dsp_gain_q31(int32_t *dst, const int32_t *src, size_t count,
+			const struct audio_dsp_gain *gains, size_t channels);
+
+/**
+ * @brief Add @p count containers, scaled by a Q15 gain, into @p acc.
+ *
+ * acc[i] = sat32(acc[i] + sat32((src[i] * gain_q15) >> 15)). The scaled term is
+ * saturated on its own first, which is what a saturating 32-bit add of it does
+ * on a DSP extension, so every implementation rounds a clipping input the same
+ * way. The mix stays in range however many inputs are summed into @p acc.
+ */
+void audio_dsp_mac_q15(int32_t *acc, const int32_t *src, size_t count, int32_t gain_q15);
+
+/** @brief Most channels either side of a channel matrix. */
+#define AUDIO_DSP_MATRIX_MAX_CHANNELS 16U
+
+/**
+ * @brief Largest magnitude of one channel matrix gain, in Q15: +24 dB.
+ *
+ * Sixteen full-scale inputs at this gain still sum exactly in 64 bits.
+ */
+#define AUDIO_DSP_MATRIX_MAX_GAIN_Q15 (16 * AUDIO_DSP_UNITY_Q15)
+
+/** @brief How audio_dsp_matrix_q15() runs a matrix, as planned by prepare. */
+enum audio_dsp_matrix_kind {
+	/** Any matrix: a dot product per output. */
+	AUDIO_DSP_MATRIX_GENERAL,
+	/** Square, unity on the diagonal and 0 elsewhere: a copy. */
+	AUDIO_DSP_MATRIX_IDENTITY,
+	/**
+	 * Every output is one input at unity, or silence: a permutation, a
+	 * channel dropped or duplicated.
+	 */
+	AUDIO_DSP_MATRIX_ROUTE,
+	/** One input to every output at unity: mono to many. */
+	AUDIO_DSP_MATRIX_DUPLICATE,
+	/** Two inputs at half each to one output: stereo to mono. */
+	AUDIO_DSP_MATRIX_AVERAGE,
+};
+
+/** @brief Entry of audio_dsp_matrix.route for an output that is silent. */
+#define AUDIO_DSP_MATRIX_SILENT 0xffU
+
+/**
+ * @brief A channel matrix: how each output channel is made from the inputs of
+ *        the same sample set.
+ *
+ * Set the first three fields and call audio_dsp_matrix_prepare(); the rest is
+ * the plan it works out.
+ */
+struct audio_dsp_matrix {
+	/**
+	 * @c out_channels rows of @c in_channels Q15 gains, row major: output
+	 * o takes input i at coeffs_q15[o * in_channels + i].
+	 */
+	const int32_t *coeffs_q15;
+	/** Channels of a sample set in, 1 to ::AUDIO_DSP_MATRIX_MAX_CHANNELS. */
+	uint8_t in_channels;
+	/** Channels of a sample set out, 1 to ::AUDIO_DSP_MATRIX_MAX_CHANNELS. */
+	uint8_t out_channels;
+
+	/** The loop the matrix runs with. */
+	enum audio_dsp_matrix_kind kind;
+	/**
+	 * ::AUDIO_DSP_MATRIX_ROUTE: the input each output copies, or
+	 * ::AUDIO_DSP_MATRIX_SILENT.
+	 */
+	uint8_t route[AUDIO_DSP_MATRIX_MAX_CHANNELS];
+};
+
+/**
+ * @brief True if every one of @p count Q15 gains is within
+ *        ::AUDIO_DSP_MATRIX_MAX_GAIN_Q15 either way, so no output of a matrix
+ *        of them can overflow its accumulator.
+ */
+bool audio_dsp_matrix_is_bounded(const int32_t *coeffs_q15, size_t count);
+
+/**
+ * @brief Work out the loop @p m runs with, from its gains.
+ *
+ * A matrix that is a copy, a routing, a duplication of one channel or the
+ * average of two gets a loop of its own; the result is the same as the
+ * general one's, bit for bit. The channel counts must be in range and the
+ * gains bounded (audio_dsp_matrix_is_bounded()).
+ */
+void audio_dsp_matrix_prepare(struct audio_dsp_matrix *m);
+
+/**
+ * @brief Run @p sets interleaved sample sets through a channel matrix.
+ *
+ * dst[s * out + o] = sat32((sum over i of src[s * in + i] * c[o * in + i]) >> 15),
+ * where in and out are @p m's channel counts and c its gains, with the sum
+ * formed exactly in 64 bits and the shift arithmetic. A whole sample set is
+ * read before any output of it is written, and the sets run front to back
+ * when a set shrinks and back to front when it grows, so @p dst may equal
+ * @p src whichever way the channel count changes, provided it has room for
+ * @p sets sets of the wider side.
+ */
+void audio_dsp_matrix_q15(int32_t *dst, const int32_t *src, size_t sets,
+			  const struct audio_dsp_matrix *m);
+
+/**
+ * @brief Split @p sets interleaved sample sets into one run per channel.
+ *
+ * dst[c * plane + s] = src[s * channels + c]: channel c's @p sets samples
+ * start @p plane samples after channel c - 1's, and @p plane is at least
+ * @p sets. @p dst and @p src must not overlap.
+ */
+void audio_dsp_deinterleave(int32_t *dst, size_t plane, const int32_t *src, size_t sets,
+			    size_t channels);
+
+/**
+ * @brief Merge one run per channel into @p sets interleaved sample sets.
+ *
+ * dst[s * channels + c] = src[c * plane + s], the inverse of
+ * audio_dsp_deinterleave() for the same @p plane. @p dst and @p src must not
+ * overlap.
+ */
+void audio_dsp_interleave(int32_t *dst, const int32_t *src, size_t plane, size_t sets,
+			  size_t channels);
+
+/**
+ * @brief Fractional bits of a filter coefficient: Q4.28, a range of [-8, 8).
+ *
+ * The format of the biquad coefficients and the FIR taps alike.
+ */
+#define AUDIO_DSP_COEFF_FRAC_BITS 28
+
+/**
+ * @brief Largest sum of coefficient magnitudes one output may use, in Q4.28:
+ *        16.0.
+ *
+ * Below it the products of one output sum into 64 bits without overflowing,
+ * whatever the samples: each is less than 2^31 * 2^31 times its coefficient's
+ * share of 16. Every stable biquad has |a1| + |a2| < 3, which leaves 13 for its
+ * numerator; an FIR filter has the whole of it for its taps.
+ */
+#define AUDIO_DSP_COEFF_MAX_SUM (INT64_C(16) << AUDIO_DSP_COEFF_FRAC_BITS)
+
+/**
+ * @brief A filter coefficient in Q4.28, from a constant.
+ *
+ * For static tables: @p _x is a floating-point constant in [-8, 8), and the
+ * conversion is done by the compiler, so no floating point reaches the image.
+ */
+#define AUDIO_DSP_COEFF(_x)                                                                        \
+	((int32_t)((_x) * (double)(1 << AUDIO_DSP_COEFF_FRAC_BITS) + ((_x) < 0 ? -0.5 : 0.5)))
+
+/**
+ * @brief One second-order section, normalised so that a0 is 1.
+ *
+ * H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2), every coefficient
+ * in Q4.28: the signs of a1 and a2 are the ones the usual design formulas
+ * give, not negated as arm_biquad_cascade_df1_q31() wants them.
+ */
+struct audio_dsp_biquad {
+	int32_t b0;
+	int32_t b1;
+	int32_t b2;
+	int32_t a1;
+	int32_t a2;
+};
+
+/** @brief What one channel of one biquad remembers: two inputs, two outputs. */
+struct audio_dsp_biquad_history {
+	int32_t x1;
+	int32_t x2;
+	int32_t y1;
+	int32_t y2;
+};
+
+/**
+ * @brief True if @p stage is inside ::AUDIO_DSP_COEFF_MAX_SUM, the one
+ *        precondition audio_dsp_biquad_q31() has.
+ */
+bool audio_dsp_biquad_is_bounded(const struct audio_dsp_biquad *stage);
+
+/**
+ * @brief Run @p count interleaved containers through one biquad, in place.
+ *
+ * Direct form I, per channel c = i % channels with its own @p history[c]:
+ *
+ *   y = sat32((b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2 + 2^27) >> 28)
+ *
+ * with every product and the sum in 64 bits and the shift arithmetic, so the
+ * output is rounded to nearest once per sample and clips rather than wraps;
+ * x1, x2, y1 and y2 move along after each sample, the saturated y with them.
+ * Direct form I keeps all the state in the container's own width and has one
+ * rounding point, which is why a fixed-point cascade uses it rather than the
+ * transposed form II, whose state needs the accumulator's width.
+ *
+ * @p data starts on a sample set and @p count is whole sample sets. @p stage
+ * must satisfy audio_dsp_biquad_is_bounded(). A cascade is one call per stage,
+ * in order. Stereo runs a loop of its own with both channels' recurrences side
+ * by side.
+ */
+void audio_dsp_biquad_q31(int32_t *data, size_t count, const struct audio_dsp_biquad *stage,
+			  struct audio_dsp_biquad_history *history, size_t channels);
+
+/**
+ * @brief True if the magnitudes of @p tap_count Q4.28 @p taps sum to less than
+ *        ::AUDIO_DSP_COEFF_MAX_SUM, the one precondition the FIR kernels have.
+ */
+bool audio_dsp_fir_is_bounded(const int32_t *taps, size_t tap_count);
+
+/**
+ * @brief An FIR filter in direct form: its taps and a delay line per channel.
+ *
+ * The delay line is circular and holds every input twice, at pos and at
+ * pos + tap_count, so the last tap_count inputs of a channel are always one
+ * contiguous run starting at pos and the dot product never wraps. That costs a
+ * second store per input and nothing per tap.
+ */
+struct audio_dsp_fir {
+	/** Q4.28 taps, tap 0 applying to the newest input. */
+	const int32_t *taps;
+	/** 2 * @ref tap_count inputs per channel, channel after channel. */
+	int32_t *line;
+	/** Entries at @ref taps; at least 1. */
+	uint16_t tap_count;
+	/** Where the newest input is in every channel's line; all share it. */
+	uint16_t pos;
+};
+
+/**
+ * @brief Run @p count interleaved containers through an FIR filter, in place.
+ *
+ * Per channel c = i % channels, with x the channel's inputs and the ones
+ * before the first still in @p fir's delay line:
+ *
+ *   y[n] = sat32((taps[0] x[n] + ... + taps[N-1] x[n-N+1] + 2^27) >> 28)
+ *
+ * with every product and the sum in 64 bits, N being the tap count. A delay
+ * line of zeros and a pos of 0 start the filter from silence.
+ *
+ * @p data starts on a sample set and @p count is whole sample sets. The taps
+ * must satisfy audio_dsp_fir_is_bounded(). The frame is filtered one channel
+ * at a time, so a channel's delay line stays in cache for the whole of it.
+ */
+void audio_dsp_fir_q31(int32_t *data, size_t count, struct audio_dsp_fir *fir, size_t channels);
+
+/** @brief A complex value: the element of an FFT. */
+struct audio_dsp_complex {
+	int32_t re;
+	int32_t im;
+};
+
+/** @brief log2 of the longest FFT: 1024 points. */
+#define AUDIO_DSP_FFT_MAX_ORDER 10
+
+/**
+ * @brief In-place radix-2 FFT of 2^@p order points, in block floating point.
+ *
+ * Computes X[k] = sum of x[n] W^(nk) over n, W = exp(-2 pi j / 2^order), or
+ * W = exp(2 pi j / 2^order) with @p inverse and no 1 / 2^order, in bit-reversed
+ * input order internally and natural order out, with Q31 twiddles and each
+ * product rounded to nearest. A stage whose inputs have a part of 2^29 or more
+ * halves its outputs, which keeps every value's modulus within 2^30.5 - so the
+ * parts of @p data must be within +-2^30 on entry - and the return value is
+ * the number of stages that did: the result is X / 2^returned.
+ *
+ * Not bit-exact with a floating-point FFT, and not meant to be: every stage
+ * rounds, and a stage that halves drops a bit. A signal well below full scale
+ * keeps its precision, because only the stages that need the headroom take it.
+ */
+unsigned int audio_dsp_fft_q31(struct audio_dsp_complex *data, unsigned int order, bool inverse);
+
+/**
+ * @brief An FIR filter run by overlap-save: the same filter as
+ *        ::audio_dsp_fir, at a cost per sample that grows with log2 of the
+ *        tap count rather than with the tap count.
+ *
+ * Every block is the last tap_count - 1 inputs followed by up to
+ * 2^order - tap_count + 1 new ones, transformed, multiplied by the taps'
+ * transform, and transformed back; the new outputs are the points the circular
+ * convolution leaves unaliased. Two channels are filtered in one transform, one
+ * as the real part and one as the imaginary part: the taps are real, so the
+ * two never mix.
+ */
+struct audio_dsp_fir_fft {
+	/** Q4.28 taps, as for ::audio_dsp_fir. */
+	const int32_t *taps;
+	/** 2^@ref order points: the taps' transform, filled by prepare. */
+	struct audio_dsp_complex *spectrum;
+	/** 2^@ref order points of scratch. */
+	struct audio_dsp_complex *work;
+	/** 2 * (@ref tap_count - 1) inputs: channel 0's, then channel 1's. */
+	int32_t *history;
+	/** Entries at @ref taps; 2 .. 2^@ref order. */
+	uint16_t tap_count;
+	/** log2 of the transform length, at most ::AUDIO_DSP_FFT_MAX_ORDER. */
+	uint8_t order;
+	/** Power of two @ref spectrum is scaled by, set by prepare. */
+	int8_t spectrum_exp;
+};
+
+/**
+ * @brief Transform @p fir's taps and clear its history.
+ *
+ * O(N log N) in the transform length; the filter's start from silence.
+ */
+void audio_dsp_fir_fft_prepare(struct audio_dsp_fir_fft *fir);
+
+/**
+ * @brief Run @p count interleaved containers through an overlap-save FIR,
+ *        in place.
+ *
+ * The result is audio_dsp_fir_q31() with the same taps plus the transforms'
+ * rounding noise, not bit for bit: a few hundred LSBs at most on full-scale
+ * noise through 1024 points (about -135 dB), a few LSBs on a signal 48 dB
+ * down, which is what the DSP unit test holds it to. Each sample set is
+ * filtered as soon as it arrives, so the form adds no latency; a call shorter
+ * than a block still pays for a whole one. @p channels is 1 or 2; @p data
+ * starts on a sample set and @p count is whole sample sets. The taps must
+ * satisfy audio_dsp_fir_is_bounded().
+ */
+void audio_dsp_fir_fft_q31(int32_t *data, size_t count, struct audio_dsp_fir_fft *fir,
+			   size_t channels);
+
+/**
+ * @brief A sample-rate converter: one wing of a windowed-sinc prototype and
+ *        where the output stands between two input sample sets.
+ *
+ * The prototype h(u), u in input sample periods, is symmetric and spans
+ * +-@ref zero_crossings; @ref wing holds it at @ref phases points per period,
+ * which makes it a polyphase bank of @ref phases filters whose phase the
+ * kernel interpolates between for a ratio that does not land on one. Any pair
+ * of integer rates therefore runs off one table. Decimating, the prototype is
+ * stretched by the ratio so its cutoff follows the lower Nyquist, and scaled
+ * down by it so the gain stays 1.
+ *
+ * The fields after @ref phases are set by audio_dsp_resampler_prepare().
+ */
+struct audio_dsp_resampler {
+	/**
+	 * h(i / phases) for i = 0 .. zero_crossings * phases, Q4.28. The last
+	 * entry is 0, the wing having ended.
+	 */
+	const int32_t *wing;
+	/** 2 * ::AUDIO_DSP_RESAMPLER_REACH() entries of scratch. */
+	int32_t *coeffs;
+	/** Input periods the wing spans. */
+	uint16_t zero_crossings;
+	/** Points of @ref wing per input period. */
+	uint16_t phases;
+	/** Input sets either side of an output the prototype reaches. */
+	uint16_t reach;
+	/** Input rate over the rates' greatest common divisor. */
+	uint32_t in_rate;
+	/** Output rate over the rates' greatest common divisor. */
+	uint32_t out_rate;
+	/** Q16 wing index per input period: phases, stretched when decimating. */
+	uint32_t tap_step;
+	/** Q30 gain: 1, or the ratio when decimating. */
+	int32_t gain;
+	/** Where the output is past its input set, in 1 / @ref out_rate. */
+	uint32_t frac;
+	/** @ref frac as a Q16 wing index: the whole part... */
+	uint32_t phase;
+	/** ...and the remainder, in 1 / max(@ref in_rate, @ref out_rate). */
+	uint32_t phase_rem;
+};
+
+/**
+ * @brief Input sets either side of an output a @p zero_crossings prototype
+ *        reaches when decimating by at most @p max_ratio.
+ */
+#define AUDIO_DSP_RESAMPLER_REACH(zero_crossings, max_ratio) ((zero_crossings) * (max_ratio) + 1)
+
+/**
+ * @brief Set @p rs up to convert @p in_rate_hz to @p out_rate_hz, from the
+ *        first input set on.
+ *
+ * @p rs->reach is the input the conversion needs either side of an output,
+ * within AUDIO_DSP_RESAMPLER_REACH(zero_crossings, ceil(in / out)). Both
+ * rates are non-zero.
+ */
+void audio_dsp_resampler_prepare(struct audio_dsp_resampler *rs, uint32_t in_rate_hz,
+				 uint32_t out_rate_hz);
+
+/**
+ * @brief Convert interleaved input containers at @p in into output ones at
+ *        @p out, for as long as both last.
+ *
+ * The output at time t, t in input periods, n = floor(t) and frac = t - n,
+ * is per channel:
+ *
+ *   y(t) = sat32((sum over k of c(t - k) x[k] + 2^27) >> 28)
+ *
+ * in 64 bits, where c(u) is the wing at index |u| * tap_step (Q16), linearly
+ * interpolated between entries with the fraction truncated, and multiplied
+ * by the gain with rounding, 0 past the wing's end. The left wing's indices
+ * are phase + m * tap_step for input n - m, the right wing's
+ * tap_step - phase + m * tap_step for input n + 1 + m, with phase the Q16
+ * image of frac; the index steps of a stretched wing are rounded down.
+ *
+ * @p in starts @p rs->reach - 1 sets before the next output's n, and both
+ * counts are whole sample sets. The call stops when @p out is full or the
+ * next output would reach past the end of @p in; it returns the containers
+ * written and sets @p consumed to the ones at the front of @p in no later
+ * output needs, which the caller drops before the next call. Successive
+ * outputs are in_rate / out_rate input periods apart, so the first output of
+ * a prepared converter is at its first input set and there is no delay.
+ *
+ * The coefficients are worked out once per output and shared by the
+ * channels, each of which is then a dot product over its inputs.
+ */
+size_t audio_dsp_resample_q31(int32_t *out, size_t out_count, const int32_t *in,
+			      size_t in_count, size_t *consumed, struct audio_dsp_resampler *rs,
+			      size_t channels);
+
+/*
+ * The PCM kernels: the sample layouts of a WAVE payload - 8 bit unsigned,
+ * 16 bit, packed 24 bit and 32 bit signed, and 32 bit IEEE float - to and from
+ * the S32 container, little endian on every host. One kernel per layout and
+ * direction, so a node picks its loop once, at open(), and a frame costs one
+ * call.
+ *
+ * All of them are integer code, the float pair included: it works on the
+ * IEEE 754 bit pattern, so a file in float costs an image no floating point,
+ * and still produces what audio_dsp_f32_to_s32() and audio_dsp_s32_to_f32()
+ * do, bit for bit.
+ *
+ * An unpack runs back to front and a pack front to back, so each can convert a
+ * frame in place: @p dst may be @p src itself - the container is never
+ * narrower than the layout - but may not overlap it any other way.
+ */
+
+/** @brief One of the audio_dsp_unpack_*() kernels. */
+typedef void (*audio_dsp_unpack_fn)(int32_t *dst, const uint8_t *src, size_t count);
+
+/** @brief One of the audio_dsp_pack_*() kernels. */
+typedef void (*audio_dsp_pack_fn)(uint8_t *dst, const int32_t *src, size_t count);
+
+/** @brief Widen @p count unsigned 8-bit samples: dst[i] = (src[i] - 128) << 24. */
+void audio_dsp_unpack_u8(int32_t *dst, const uint8_t *src, size_t count);
+
+/** @brief Widen @p count 16-bit samples: dst[i] = src[i] << 16. */
+void audio_dsp_unpack_s16(int32_t *dst, const uint8_t *src, size_t count);
+
+/** @brief Widen @p count packed 24-bit samples, three bytes each: dst[i] = src[i] << 8. */
+void audio_dsp_unpack_s24(int32_t *dst, const uint8_t *src, size_t count);
+
+/** @brief Copy @p count 32-bit samples into containers: dst[i] = src[i]. */
+void audio_dsp_unpack_s32(int32_t *dst, const uint8_t *src, size_t count);
+
+/**
+ * @brief Convert @p count IEEE 754 single-precision samples to containers.
+ *
+ * The result audio_dsp_f32_to_s32() defines: dst[i] = sat32(round(src[i] *
+ * 2^31)), ties away from zero, and 0 for a NaN.
+ */
+void audio_dsp_unpack_f32(int32_t *dst, const uint8_t *src, size_t count);
+
+/**
+ * @brief Narrow @p count containers to unsigned 8-bit samples.
+ *
+ * dst[i] = (src[i] >> 24) + 128, the top of the container kept as the 16-bit
+ * one keeps it: truncated, the exact inverse of audio_dsp_unpack_u8().
+ */
+void audio_dsp_pack_u8(uint8_t *dst, const int32_t *src, size_t count);
+
+/** @brief Narrow @p count containers to 16-bit samples: dst[i] = src[i] >> 16. */
+void audio_dsp_pack_s16(uint8_t *dst, const int32_t *src, size_t count);
+
+/** @brief Narrow @p count containers to packed 24-bit samples: dst[i] = src[i] >> 8. */
+void audio_dsp_pack_s24(uint8_t *dst, const int32_t *src, size_t count);
+
+/** @brief Copy @p count containers out as 32-bit samples: dst[i] = src[i]. */
+void audio_dsp_pack_s32(uint8_t *dst, const int32_t *src, size_t count);
+
+/**
+ * @brief Convert @p count containers to IEEE 754 single-precision samples.
+ *
+ * The result audio_dsp_s32_to_f32() defines: dst[i] = src[i] / 2^31, rounded
+ * to the nearest float, ties to even.
+ */
+void audio_dsp_pack_f32(uint8_t *dst, const int32_t *src, size_t count);
+
+/*
+ * The floating-point kernels, built with CONFIG_AUDIO_PIPELINE_FLOAT only, so
+ * an image that never names F32 carries no floating point. They are defined by
+ * single-precision arithmetic in the order spelled out, which is not a promise
+ * of the same bits on every target: a compiler that fuses a multiply and an add
+ * rounds once where another rounds twice. The conversions are the exception,
+ * exact to their definition everywhere.
+ */
+
+/**
+ * @brief Convert @p count S32 containers to floats, full scale to full scale.
+ *
+ * dst[i] = src[i] / 2^31, rounded to the nearest float: exact for any
+ * container of 24 significant bits or fewer, every 16- and 24-bit sample
+ * widened by a source among them. @p dst may equal @p src.
+ */
+void audio_dsp_s32_to_f32(float *dst, const int32_t *src, size_t count);
+
+/**
+ * @brief Convert @p count floats to S32 containers, saturating.
+ *
+ * dst[i] = sat32(round(src[i] * 2^31)), rounded to nearest with ties away from
+ * zero, and 0 for a NaN. The inverse of audio_dsp_s32_to_f32() wherever that is
+ * exact. @p dst may equal @p src.
+ */
+void audio_dsp_f32_to_s32(int32_t *dst, const float *src, size_t count);
+
+/**
+ * @brief Scale @p count interleaved floats by one gain per channel.
+ *
+ * dst[i] = src[i] * gains[i % channels], with no clamp: a float has the
+ * headroom, and the float-to-s32 conversion saturates at the end of the
+ * stretch. @p src starts on a sample set. @p dst may equal @p src.
+ */
+void audio_dsp_gain_f32(float *dst, const float *src, size_t count, const float *gains,
+			size_t channels);
+
+/** @brief One second-order section in floats, as ::audio_dsp_biquad. */
+struct audio_dsp_biquad_f32 {
+	float b0;
+	float b1;
+	float b2;
+	float a1;
+	float a2;
+};
+
+/**
+ * @brief What one channel of one float biquad remembers: the transposed
+ *        form's two partial sums.
+ */
+struct audio_dsp_biquad_f32_history {
+	float s1;
+	float s2;
+};
+
+/**
+ * @brief @p stage's Q4.28 coefficients as floats, each rounded to the nearest
+ *        one: a float keeps 24 of a coefficient's up to 31 significant bits.
+ */
+void audio_dsp_biquad_to_f32(const struct audio_dsp_biquad *stage,
+			     struct audio_dsp_biquad_f32 *out);
+
+/**
+ * @brief Run @p count interleaved floats through one biquad, in place.
+ *
+ * Transposed direct form II, per channel c = i % channels with its own
+ * @p history[c]:
+ *
+ *   y = b0 x + s1,  s1 = b1 x - a1 y + s2,  s2 = b2 x - a2 y
+ *
+ * The form a floating-point cascade uses: two values of state rather than
+ * four, and a float's exponent makes the wide accumulator direct form I
+ * needs in fixed point unnecessary. @p data starts on a sample set and
+ * @p count is whole sample sets. Stereo runs a loop of its own, as
+ * audio_dsp_biquad_q31() does.
+ */
+void audio_dsp_biquad_f32(float *data, size_t count, const struct audio_dsp_biquad_f32 *stage,
+			  struct audio_dsp_biquad_f32_history *history, size_t channels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_AUDIO_DSP_H_ */
@@ -3,8 +3,38 @@
 
 #include <zephyr/types.h>
 
+/**
+ * @brief What one sample of a frame is (spec §5.2).
+ *
+ * S32 is the container every source makes and every sink takes. F32 exists
+ * between an s32-to-float and a float-to-s32 node, for the nodes that have a
+ * floating-point path; it takes the same 32 bits per sample.
+ */
 enum audio_sample_format {
+	/** Signed 32-bit container, full scale at INT32_MIN and INT32_MAX. */
 	AUDIO_SAMPLE_FORMAT_S32_LE,
+	/**
+	 * IEEE 754 single precision, full scale at -1.0 and 1.0. Values past
+	 * it are kept, not clipped, until the float-to-s32 node saturates.
+	 */
+	AUDIO_SAMPLE_FORMAT_F32_LE,
+};
+
+/**
+ * @brief How the samples of a frame are ordered (spec §5.2).
+ *
+ * Interleaved is the order every device and file uses, and the default.
+ * Planar gives each channel a run of its own, so a per-channel loop walks
+ * contiguous memory; it exists between a deinterleave and an interleave node.
+ */
+enum audio_frame_layout {
+	/** One sample set after the other: L0, R0, L1, R1, ... */
+	AUDIO_FRAME_LAYOUT_INTERLEAVED,
+	/**
+	 * One channel after the other, each at the start of an equal share of
+	 * the frame's capacity: L0, L1, ..., then R0, R1, ... from capacity / 2.
+	 */
+	AUDIO_FRAME_LAYOUT_PLANAR,
 };
 
 struct audio_stream_config {
@@ -12,6 +42,8 @@ struct audio_stream_config {
 	uint8_t channels;
 	uint8_t valid_bits_per_sample;
 	enum audio_sample_format format;
+	/** Left 0 by a format that does not name it: interleaved. */
+	enum audio_frame_layout layout;
 };
 
 #endif /* ZEPHYR_AUDIO_FORMAT_H_ */
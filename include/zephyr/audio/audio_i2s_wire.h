@@ -94,7 +94,9 @@ int audio_i2s_wire_format_get(uint8_t valid_bits_per_sample, struct audio_i2s_wi
  * @param count                 Number of samples in @p samples.
  * @param wire                  Block receiving the words. Must not be NULL and
  *                              needs no alignment: every word goes out byte
- *                              wise and little endian.
+ *                              wise and little endian. May be @p samples
+ *                              itself, to narrow a block in place; any other
+ *                              overlap is undefined.
  * @param len                   Capacity of @p wire in bytes. Bytes past the
  *                              words written are left untouched.
  *
@@ -118,7 +120,9 @@ int audio_i2s_wire_from_container(uint8_t valid_bits_per_sample, const int32_t *
  *                              NULL and needs no alignment.
  * @param len                   Valid bytes in @p wire.
  * @param samples               Receives the container samples. Must not be
- *                              NULL, and may not overlap @p wire.
+ *                              NULL. May be @p wire itself, to widen a block
+ *                              in place when it has room for the containers;
+ *                              any other overlap is undefined.
  * @param count                 Number of samples to produce.
  *
  * @retval 0        @p count samples were written to @p samples.
@@ -1,6 +1,7 @@
 #ifndef ZEPHYR_AUDIO_NODE_H_
 #define ZEPHYR_AUDIO_NODE_H_
 
+#include <zephyr/sys/util_macro.h>
 #include <zephyr/types.h>
 
 #include <zephyr/audio/audio_format.h>
@@ -12,14 +13,70 @@
  * Describes the storage and nothing else: how much of it a call filled is
  * reported once, through the @c out_size out-parameter of
  * ::audio_node_ops.process.
+ *
+ * Where a sample of the frame lies follows from the layout of the format the
+ * node was opened with (spec §5.2): audio_frame_channel_stride() apart from
+ * the same set's next channel, audio_frame_sample_stride() from the same
+ * channel's next set. A planar frame's channel runs each start at a share of
+ * @ref capacity, so a frame of fewer sets than it holds leaves a gap at the
+ * end of every run, and a node that pulls into storage of its own keeps that
+ * storage's capacity for reading it back.
  */
 struct audio_buffer_view {
-	/** Frame storage, owned by the pipeline. */
-	int32_t *data;
+	/**
+	 * Frame storage, owned by the pipeline - or by the node that lent it
+	 * for this frame through ::audio_node_ops.lend (spec §4.1.2).
+	 */
+	union {
+		int32_t *data;
+		/**
+		 * The same storage in a frame whose format is
+		 * ::AUDIO_SAMPLE_FORMAT_F32_LE: a float is as wide as a
+		 * container, so capacities and strides do not change.
+		 */
+		float *data_f32;
+	};
 	/** Samples @ref data can hold. */
 	size_t capacity;
 };
 
+/**
+ * @brief Samples from one channel of a sample set to the next in @p buf.
+ *
+ * 1 in an interleaved frame, the share of @c buf->capacity each channel has
+ * in a planar one.
+ */
+static inline size_t audio_frame_channel_stride(const struct audio_stream_config *fmt,
+						const struct audio_buffer_view *buf)
+{
+	return (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR) ? buf->capacity / fmt->channels : 1U;
+}
+
+/**
+ * @brief Samples from one sample set of a channel to the next in @p buf.
+ *
+ * The channel count in an interleaved frame, 1 in a planar one.
+ */
+static inline size_t audio_frame_sample_stride(const struct audio_stream_config *fmt,
+					       const struct audio_buffer_view *buf)
+{
+	(void)buf;
+
+	return (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR) ? 1U : fmt->channels;
+}
+
+/**
+ * @brief The bit of ::audio_node_ops.layouts that stands for @p _layout, an
+ *        ::audio_frame_layout.
+ */
+#define AUDIO_FRAME_LAYOUT_BIT(_layout) BIT(_layout)
+
+/**
+ * @brief The bit of ::audio_node_ops.formats that stands for @p _format, an
+ *        ::audio_sample_format.
+ */
+#define AUDIO_SAMPLE_FORMAT_BIT(_format) BIT(_format)
+
 enum audio_node_role {
 	AUDIO_NODE_ROLE_SOURCE,
 	AUDIO_NODE_ROLE_FILTER,
@@ -28,19 +85,131 @@ enum audio_node_role {
 
 struct audio_node;
 
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+#define AUDIO_PROFILE_BUCKETS CONFIG_AUDIO_PIPELINE_PROFILING_BUCKETS
+#else
+#define AUDIO_PROFILE_BUCKETS 1
+#endif
+
+/**
+ * @brief One distribution of cycle counts (spec §8.4).
+ *
+ * Counted in @c k_cycle_get_32() cycles since the counters were last reset.
+ * Bucket @c i of @ref histogram counts the samples that took at least
+ * @c 2^i and less than @c 2^(i+1) cycles - bucket 0 includes the ones that
+ * took none - and the last bucket everything longer.
+ */
+struct audio_profile_stats {
+	/** Samples taken. Every other field is 0 while this is. */
+	uint32_t count;
+	/** Fewest cycles one sample took. */
+	uint32_t min_cycles;
+	/** Mean over every sample, rounded down. */
+	uint32_t avg_cycles;
+	/** Most cycles one sample took. */
+	uint32_t max_cycles;
+	/** Samples per power-of-two bucket, see above. */
+	uint32_t histogram[AUDIO_PROFILE_BUCKETS];
+};
+
+/**
+ * @brief Where a node's process() time went (spec §8.4).
+ *
+ * Read with audio_node_get_stats() or, for a whole chain,
+ * audio_pipeline_get_stats().
+ */
+struct audio_node_stats {
+	/** The node these figures are for. */
+	const struct audio_node *node;
+	/**
+	 * Whole process() calls, including every pull the node made through
+	 * audio_node_pull() - for a sink, the whole frame.
+	 */
+	struct audio_profile_stats inclusive;
+	/**
+	 * The same calls without those pulls: the cycles the node spent on its
+	 * own work, which is the figure to compare against a frame budget.
+	 */
+	struct audio_profile_stats exclusive;
+};
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+/*
+ * One distribution as the subsystem accumulates it. Private to the subsystem;
+ * observe it through audio_node_get_stats() and audio_pipeline_get_stats().
+ */
+struct audio_profile_counters {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint32_t histogram[AUDIO_PROFILE_BUCKETS];
+};
+
+/* Profile of one node. */
+struct audio_node_profile {
+	struct audio_profile_counters inclusive;
+	struct audio_profile_counters exclusive;
+	/* Cycles the process() call in flight has spent in the nodes it
+	 * pulled. Written only by the thread running that call.
+	 */
+	uint32_t nested;
+};
+#endif /* CONFIG_AUDIO_PIPELINE_PROFILING */
+
 struct audio_node_ops {
 	int (*open)(struct audio_node *node);
 	int (*process)(struct audio_node *node, struct audio_buffer_view *buf,
 		       size_t *out_size);
 	int (*close)(struct audio_node *node);
+	/**
+	 * Optional: lend storage of the node's own as the next frame's buffer
+	 * (spec §4.1.2). NULL for every node that has none worth lending.
+	 *
+	 * Called by the pipeline, never by another node, once per frame and
+	 * immediately before it pulls that frame. A node that lends points
+	 * @c buf->data at storage holding at least @c buf->capacity samples,
+	 * leaves @c capacity alone and returns 0; the whole chain then produces
+	 * the frame in that storage, and the node recognises it when its own
+	 * process() is handed a buffer whose @c data is the storage it lent.
+	 * The storage stays the node's property and must stay valid until the
+	 * node is asked to lend again or is closed.
+	 *
+	 * @retval 0 the frame is produced in the lent storage
+	 * @retval -ENOTSUP nothing to lend for this frame; @p buf is untouched
+	 *         and the pipeline's own buffer is used
+	 * @retval -errno any other code fails the frame as process() would
+	 */
+	int (*lend)(struct audio_node *node, struct audio_buffer_view *buf);
+	/**
+	 * Optional: the frame layouts the node handles, as
+	 * AUDIO_FRAME_LAYOUT_BIT()s (spec §5.2). 0, which is what an ops table
+	 * that does not name the field has, stands for interleaved only.
+	 *
+	 * audio_node_open() refuses with @c -ENOTSUP to open a node with a
+	 * @ref audio_node.pipeline_format of any other layout, before the
+	 * node's own open() runs, so a node written for interleaved frames
+	 * never sees a planar one and needs no check of its own. A node that
+	 * names planar reads its frame through audio_frame_channel_stride()
+	 * and audio_frame_sample_stride(), or branches on the layout.
+	 */
+	uint8_t layouts;
+	/**
+	 * Optional: the sample formats the node handles, as
+	 * AUDIO_SAMPLE_FORMAT_BIT()s (spec §5.2). 0 stands for S32 only, and
+	 * audio_node_open() refuses any other the same way as a layout, so
+	 * only a node with a floating-point path names F32 and reads its
+	 * frame through @ref audio_buffer_view.data_f32.
+	 */
+	uint8_t formats;
 };
 
 /**
  * @brief One node of the chain.
  *
- * The three ops are the whole interface a node implements; everything the
- * pipeline has to tell a node travels on this object rather than through the
- * op signatures (spec §4.1).
+ * The three ops, and the optional lend, are the whole interface a node
+ * implements; everything the pipeline has to tell a node travels on this
+ * object rather than through the op signatures (spec §4.1).
  */
 struct audio_node {
 	enum audio_node_role role;
@@ -54,15 +223,52 @@ struct audio_node {
 	 * calls this node's open() and leaves it in place for as long as the
 	 * node is open. NULL until the node has been opened by a pipeline, and
 	 * read-only to the node: a node checks the format against what it can
-	 * deliver or accept and fails its open() when it cannot comply - v1 has
-	 * no resampler and no channel mapper, so a node can only match or
-	 * refuse, never adapt (spec §1.3/§5.2).
+	 * deliver or accept and fails its open() when it cannot comply. A node
+	 * matches or refuses, never adapts (spec §5.2); adapting is a converter
+	 * node's job, see @ref upstream_format.
+	 *
+	 * This is the format the node produces. It is the bound format for every
+	 * node below the first converter, counting from the sink, and the
+	 * converter's @ref upstream_format above it.
 	 *
 	 * Written only by audio_pipeline_start(), i.e. from the control thread,
 	 * and read only by open() on that same thread, so it needs no lock
 	 * (spec §3.3).
 	 */
 	const struct audio_stream_config *pipeline_format;
+	/**
+	 * Most samples one process() call on this node is handed, in total
+	 * interleaved samples across the channels of @ref pipeline_format
+	 * (spec §5.2).
+	 *
+	 * The pipeline's frame capacity below the first converter. Above a
+	 * converter it is the same stretch of time in the converter's
+	 * @ref upstream_format: the sample sets of the capacity below, scaled by
+	 * the ratio of the two rates and rounded up, times the channels above.
+	 * A converter hands its upstream no more than this, so a node sizing
+	 * scratch for one frame sizes it for its own segment. Installed and
+	 * owned like @ref pipeline_format; 0 on a node no walk has opened.
+	 */
+	size_t frame_capacity;
+	/**
+	 * Format a converter asks of the nodes upstream of it (spec §5.2).
+	 *
+	 * NULL for every node that consumes the format it produces, which is
+	 * every node but a converter such as the resampler. The walk clears it
+	 * before each open(); a converter points it at storage of its own from
+	 * there, derived from its @ref pipeline_format, and only when the two
+	 * differ. The walk then checks that the format describes a stream - a
+	 * rate, and a channel count one segment frame holds - and installs it,
+	 * with the segment's @ref frame_capacity, on every node above. Same
+	 * thread and same lifetime as @ref pipeline_format.
+	 */
+	const struct audio_stream_config *upstream_format;
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	/** Symbol name given to AUDIO_NODE_DEFINE(), for the profile dump. */
+	const char *name;
+	/* Cycle counters, see audio_node_get_stats(). */
+	struct audio_node_profile profile;
+#endif
 };
 
 int audio_node_open(struct audio_node *node);
@@ -70,6 +276,16 @@ int audio_node_process(struct audio_node *node, struct audio_buffer_view *buf,
 		       size_t *out_size);
 int audio_node_close(struct audio_node *node);
 
+/**
+ * @brief Ask @p node to lend the storage of the next frame (spec §4.1.2).
+ *
+ * @retval 0 @c buf->data now points at storage @p node lent
+ * @retval -ENOTSUP @p node has no lend op, or nothing to lend for this frame
+ * @retval -EINVAL if @p buf is NULL
+ * @retval -errno as reported by the node's lend op
+ */
+int audio_node_lend(struct audio_node *node, struct audio_buffer_view *buf);
+
 /**
  * @brief Read one frame from @p node's upstream.
  *
@@ -103,6 +319,44 @@ int audio_node_close(struct audio_node *node);
 int audio_node_pull(struct audio_node *node, struct audio_buffer_view *buf,
 		    size_t *out_size);
 
+/**
+ * @brief Read one frame from @p upstream on behalf of @p node.
+ *
+ * audio_node_pull() for a node with more than one upstream, such as a mixer:
+ * the same contract, with the upstream named by the caller instead of taken
+ * from @c node->upstream. A NULL @p upstream is the same wiring error as a
+ * missing @c upstream and reports @c -ENOTSUP.
+ *
+ * @retval 0 on success, end of stream included
+ * @retval -EINVAL if @p node, @p buf or @p out_size is NULL
+ * @retval -ENOTSUP if @p upstream is NULL
+ * @retval -errno as reported by @p upstream, never @c -EPIPE
+ */
+int audio_node_pull_from(struct audio_node *node, struct audio_node *upstream,
+			 struct audio_buffer_view *buf, size_t *out_size);
+
+/**
+ * @brief Read the cycle profile of @p node (spec §8.4).
+ *
+ * Safe from any thread while the node runs: the snapshot is taken under the
+ * same lock every process() call books itself under, so its fields agree with
+ * each other.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node or @p stats is NULL
+ * @retval -ENOTSUP without CONFIG_AUDIO_PIPELINE_PROFILING
+ */
+int audio_node_get_stats(const struct audio_node *node, struct audio_node_stats *stats);
+
+/**
+ * @brief Forget the cycle profile of @p node.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node is NULL
+ * @retval -ENOTSUP without CONFIG_AUDIO_PIPELINE_PROFILING
+ */
+int audio_node_reset_stats(struct audio_node *node);
+
 /**
  * @brief Statically define and wire an audio node.
  *
@@ -126,6 +380,8 @@ int audio_node_pull(struct audio_node *node, struct audio_buffer_view *buf,
 		.ops = (_ops),                                   \
 		.upstream = (_upstream),                         \
 		.state = (_state),                               \
+		IF_ENABLED(CONFIG_AUDIO_PIPELINE_PROFILING,      \
+			   (.name = #_name,))                    \
 	}
 
 /** @brief Declare a node defined with AUDIO_NODE_DEFINE() in another file. */
@@ -25,6 +25,7 @@
 #include <zephyr/toolchain.h>
 #include <zephyr/types.h>
 
+#include <zephyr/audio/audio_dsp.h>
 #include <zephyr/audio/audio_format.h>
 #include <zephyr/audio/audio_i2s_wire.h>
 #include <zephyr/audio/audio_node.h>
@@ -34,6 +35,15 @@
 #include <zephyr/fs/fs.h>
 #endif
 
+/* A file node that reads ahead or writes behind owns a thread, its stack and
+ * the semaphores that hand blocks between it and the pipeline thread.
+ */
+#if defined(CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD) || \
+	defined(CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND)
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#endif
+
 #if defined(CONFIG_AUDIO_PIPELINE_NODE_I2S_IN) || defined(CONFIG_AUDIO_PIPELINE_NODE_I2S_OUT)
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
@@ -42,13 +52,21 @@
 #endif
 
 /* The tone analyzer publishes a completed window to whichever thread asks for
- * it, which is the one seam in the node set that is not confined to the
- * pipeline thread, so its state carries a lock (spec §3.3).
+ * it, and the gain filter takes a new gain from whichever thread sets one;
+ * those are the two seams in the node set that are not confined to the
+ * pipeline thread, so their state carries a lock (spec §3.3). The gain
+ * filter's lock only orders the setters: the pipeline thread takes the gain
+ * through an atomic.
  */
-#ifdef CONFIG_AUDIO_PIPELINE_NODE_TONE_ANALYZER
+#if defined(CONFIG_AUDIO_PIPELINE_NODE_TONE_ANALYZER) || \
+	defined(CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER)
 #include <zephyr/spinlock.h>
 #endif
 
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER
+#include <zephyr/sys/atomic.h>
+#endif
+
 /**
  * @brief Stand in for the *_NODE_DEFINE() of a node that was not built.
  *
@@ -76,6 +94,256 @@
 	BUILD_ASSERT(0, _macro "() needs the node it defines: set CONFIG_"       \
 			_symbol "=y")
 
+/* -------------------------------------------------------------------------
+ * Biquad filter node
+ * -------------------------------------------------------------------------
+ */
+
+/** @brief Stages one biquad node can cascade. */
+#define AUDIO_BIQUAD_MAX_STAGES 8
+
+/**
+ * @brief Channels a biquad node keeps history for.
+ *
+ * The v1 channel range (spec §5.2); open() refuses a wider stream.
+ */
+#define AUDIO_BIQUAD_MAX_CHANNELS 2
+
+/**
+ * @brief One stage of a biquad node, from floating-point constants.
+ *
+ * H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2), normalised so that
+ * a0 is 1, with the signs the usual design formulas give. Each coefficient is
+ * converted to Q4.28 at compile time (see ::AUDIO_DSP_COEFF), so it must
+ * be in [-8, 8), and the magnitudes of one stage must sum to less than 16.
+ */
+#define AUDIO_BIQUAD_STAGE(_b0, _b1, _b2, _a1, _a2)                                                \
+	{                                                                                          \
+		.b0 = AUDIO_DSP_COEFF(_b0), .b1 = AUDIO_DSP_COEFF(_b1),                            \
+		.b2 = AUDIO_DSP_COEFF(_b2), .a1 = AUDIO_DSP_COEFF(_a1),                            \
+		.a2 = AUDIO_DSP_COEFF(_a2),                                                        \
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_BIQUAD
+
+/** @brief Per-instance state of the biquad filter node. */
+struct audio_biquad_state {
+	/** Stages in cascade order, owned by the definition macro. */
+	const struct audio_dsp_biquad *stages;
+	/** Entries at @ref stages. */
+	uint8_t stage_count;
+	/**
+	 * History of every stage and channel, owned by the definition macro:
+	 * @ref stage_count rows of ::AUDIO_BIQUAD_MAX_CHANNELS. Cleared by
+	 * open(), so every run starts from silence.
+	 */
+	struct audio_dsp_biquad_history (*history)[AUDIO_BIQUAD_MAX_CHANNELS];
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	/**
+	 * @ref stage_count stages in floats, owned by the definition macro
+	 * and filled by an open() with an F32 format.
+	 */
+	struct audio_dsp_biquad_f32 *stages_f32;
+	/** The float form's history, laid out as @ref history. */
+	struct audio_dsp_biquad_f32_history (*history_f32)[AUDIO_BIQUAD_MAX_CHANNELS];
+#endif
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+extern const struct audio_node_ops biquad_node_ops;
+
+/* The float form's storage, and the state fields that point at it, when the
+ * F32 format is built. Not for direct use.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+#define Z_AUDIO_BIQUAD_F32_STORAGE(_name)                                                          \
+	static struct audio_dsp_biquad_f32 _name##_stages_f32[ARRAY_SIZE(_name##_stages)];         \
+	static struct audio_dsp_biquad_f32_history                                                 \
+		_name##_history_f32[ARRAY_SIZE(_name##_stages)][AUDIO_BIQUAD_MAX_CHANNELS];
+#define Z_AUDIO_BIQUAD_F32_FIELDS(_name)                                                           \
+	.stages_f32 = _name##_stages_f32, .history_f32 = _name##_history_f32,
+#else
+#define Z_AUDIO_BIQUAD_F32_STORAGE(_name)
+#define Z_AUDIO_BIQUAD_F32_FIELDS(_name)
+#endif
+
+/**
+ * @brief Statically define a biquad filter node.
+ *
+ * File scope only. Runs every channel through the same cascade of
+ * second-order sections, each channel with a history of its own, in place
+ * and saturating (spec §10.9). Allocates the node, its ::audio_biquad_state,
+ * the stage table and the history, and with
+ * @kconfig{CONFIG_AUDIO_PIPELINE_FLOAT} their float forms as well.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_BIQUAD}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ * @param ...       One AUDIO_BIQUAD_STAGE() per stage, in cascade order, at
+ *                  most ::AUDIO_BIQUAD_MAX_STAGES, counted from the stage
+ *                  table for the same reason as the branches of a tee.
+ */
+#define AUDIO_BIQUAD_NODE_DEFINE(_name, _upstream, ...)                                            \
+	static const struct audio_dsp_biquad _name##_stages[] = {__VA_ARGS__};                     \
+	BUILD_ASSERT(ARRAY_SIZE(_name##_stages) <= AUDIO_BIQUAD_MAX_STAGES,                        \
+		     "AUDIO_BIQUAD_NODE_DEFINE() takes at most AUDIO_BIQUAD_MAX_STAGES stages");   \
+	static struct audio_dsp_biquad_history                                                     \
+		_name##_history[ARRAY_SIZE(_name##_stages)][AUDIO_BIQUAD_MAX_CHANNELS];            \
+	Z_AUDIO_BIQUAD_F32_STORAGE(_name)                                                          \
+	static struct audio_biquad_state _name##_state = {                                         \
+		.stages = _name##_stages,                                                          \
+		.stage_count = ARRAY_SIZE(_name##_stages),                                         \
+		.history = _name##_history,                                                        \
+		Z_AUDIO_BIQUAD_F32_FIELDS(_name)                                                   \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &biquad_node_ops, (_upstream),            \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_BIQUAD */
+
+#define AUDIO_BIQUAD_NODE_DEFINE(_name, _upstream, ...)                      \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                \
+			       "AUDIO_BIQUAD_NODE_DEFINE",                   \
+			       "AUDIO_PIPELINE_NODE_BIQUAD")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_BIQUAD */
+
+/* -------------------------------------------------------------------------
+ * Channel matrix filter node
+ * -------------------------------------------------------------------------
+ */
+
+/* Input a channel matrix keeps: one frame of sets of the wider input when it
+ * has more channels than it makes, since such a frame does not fit the one it
+ * is pulled for, and nothing otherwise. Not for direct use.
+ */
+#define Z_AUDIO_CHANNEL_MATRIX_INPUT_SAMPLES(_in_channels, _out_channels)                          \
+	(((_in_channels) > (_out_channels))                                                        \
+		 ? MAX(CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES / (_out_channels), 1) * (_in_channels)  \
+		 : 1)
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_CHANNEL_MATRIX
+
+/** @brief Per-instance state of the channel matrix node. */
+struct audio_channel_matrix_state {
+	/**
+	 * The gains and the channel counts, owned by the definition macro; the
+	 * plan is worked out by open().
+	 */
+	struct audio_dsp_matrix matrix;
+	/**
+	 * Input sample sets, interleaved, owned by the definition macro. Used
+	 * only when the matrix has more inputs than outputs.
+	 */
+	int32_t *input;
+	/** Samples @ref input holds. */
+	size_t input_capacity;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** The node's format with the input channel count: what upstream is opened with. */
+	struct audio_stream_config input_format;
+	/** True if the matrix is the identity and the node only pulls. */
+	bool passthrough;
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+extern const struct audio_node_ops channel_matrix_node_ops;
+
+/**
+ * @brief Statically define a channel matrix node.
+ *
+ * File scope only. Makes every output channel of a sample set from the input
+ * channels of the same set, each scaled by its own Q15 gain and summed with
+ * saturation (spec §10.12). The node is opened with @p _out_channels and asks
+ * every node upstream for @p _in_channels and otherwise the same format, so a
+ * mono file reader can feed a stereo I2S sink. The gains are a const table, so
+ * they stay in flash; a matrix that only copies, reorders, duplicates one
+ * channel or averages two runs without a multiply. Allocates the node, its
+ * ::audio_channel_matrix_state, the gain table and, for a matrix with more
+ * inputs than outputs, one frame of input.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_CHANNEL_MATRIX}.
+ *
+ * @param _name         Symbol name of the @ref audio_node instance.
+ * @param _upstream     Pointer to the upstream node.
+ * @param _in_channels  Channels upstream, 1 to
+ *                      @kconfig{CONFIG_AUDIO_PIPELINE_MAX_CHANNELS}.
+ * @param _out_channels Channels the node makes, in the same range.
+ * @param ...           @p _out_channels rows of @p _in_channels Q15 gains
+ *                      (::AUDIO_DSP_UNITY_Q15 is unity), row by row: the
+ *                      first row makes output channel 0 from inputs 0, 1, ...
+ *                      Each within ::AUDIO_DSP_MATRIX_MAX_GAIN_Q15 either way.
+ */
+#define AUDIO_CHANNEL_MATRIX_NODE_DEFINE(_name, _upstream, _in_channels, _out_channels, ...)       \
+	BUILD_ASSERT((_in_channels) >= 1 &&                                                        \
+			     (_in_channels) <= CONFIG_AUDIO_PIPELINE_MAX_CHANNELS &&               \
+			     (_out_channels) >= 1 &&                                               \
+			     (_out_channels) <= CONFIG_AUDIO_PIPELINE_MAX_CHANNELS,                \
+		     "AUDIO_CHANNEL_MATRIX_NODE_DEFINE(" #_name "): channel counts are 1 to "      \
+		     "CONFIG_AUDIO_PIPELINE_MAX_CHANNELS");                                        \
+	static const int32_t _name##_coeffs[] = {__VA_ARGS__};                                     \
+	BUILD_ASSERT(ARRAY_SIZE(_name##_coeffs) == (_in_channels) * (_out_channels),               \
+		     "AUDIO_CHANNEL_MATRIX_NODE_DEFINE(" #_name "): the matrix is out_channels "   \
+		     "rows of in_channels gains");                                                 \
+	static int32_t _name##_input[Z_AUDIO_CHANNEL_MATRIX_INPUT_SAMPLES(_in_channels,            \
+									  _out_channels)];         \
+	static struct audio_channel_matrix_state _name##_state = {                                 \
+		.matrix =                                                                          \
+			{                                                                          \
+				.coeffs_q15 = _name##_coeffs,                                      \
+				.in_channels = (_in_channels),                                     \
+				.out_channels = (_out_channels),                                   \
+			},                                                                         \
+		.input = _name##_input,                                                            \
+		.input_capacity = ARRAY_SIZE(_name##_input),                                       \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &channel_matrix_node_ops, (_upstream),    \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_CHANNEL_MATRIX */
+
+#define AUDIO_CHANNEL_MATRIX_NODE_DEFINE(_name, _upstream, _in_channels, _out_channels, ...) \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                                \
+			       "AUDIO_CHANNEL_MATRIX_NODE_DEFINE",                           \
+			       "AUDIO_PIPELINE_NODE_CHANNEL_MATRIX")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_CHANNEL_MATRIX */
+
+/* -------------------------------------------------------------------------
+ * File nodes: blocks of the read-ahead and write-behind rings
+ * -------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Unit of the read-ahead and write-behind transfers, in bytes.
+ *
+ * Every transfer starts at a multiple of it in the file and a block is a whole
+ * number of them, so a filesystem on a block device moves whole sectors
+ * between the ring and the medium instead of through its own sector buffer.
+ */
+#define AUDIO_FILE_SECTOR_BYTES 512
+
+/**
+ * @brief Alignment of a read-ahead or write-behind ring, in bytes.
+ *
+ * A cache line on the Cortex-M7, which is what a DMA-driven SD host needs to
+ * transfer to and from the ring directly.
+ */
+#define AUDIO_FILE_BLOCK_ALIGN 32
+
 /* -------------------------------------------------------------------------
  * File reader source node
  * -------------------------------------------------------------------------
@@ -83,12 +351,71 @@
 
 #ifdef CONFIG_AUDIO_PIPELINE_NODE_FILE_READER
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+
+/** @brief What one block of a file reader's read-ahead ring holds. */
+struct audio_file_reader_block {
+	/** Bytes at the start of the block that are not payload. */
+	uint32_t offset;
+	/** Payload bytes after @ref offset. */
+	uint32_t size;
+	/**
+	 * 0 for payload, @c -EPIPE for the end of it, or the errno the read
+	 * failed with. A block that is not payload is the last the I/O
+	 * thread fills.
+	 */
+	int status;
+};
+
+/**
+ * @brief How a reading-ahead file reader is keeping up.
+ *
+ * Read with audio_file_reader_get_stats(). Counted since the node was last
+ * opened.
+ */
+struct audio_file_reader_stats {
+	/** Blocks in the ring. */
+	uint8_t blocks;
+	/** Blocks read ahead and not yet started by the pipeline thread. */
+	uint8_t filled;
+	/**
+	 * Fewest blocks the pipeline thread has found read ahead when it
+	 * started one: how close the reader came to an underrun.
+	 */
+	uint8_t low_water;
+	/**
+	 * Times the pipeline thread needed a block the I/O thread had not
+	 * read yet, and waited for it.
+	 */
+	uint32_t underruns;
+};
+
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD */
+
 /** @brief Per-instance state of the file reader source node. */
 struct audio_file_reader_state {
 	/** Source file, owned by the definition macro. */
 	const char *path;
 	/** Set once the source has run out of data. */
 	bool eof;
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+	/**
+	 * Read-ahead ring of @ref blocks blocks of @ref block_bytes, owned by
+	 * AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(); NULL for a node that
+	 * reads on the pipeline thread.
+	 */
+	uint8_t *ring;
+	/** Bytes in one block of @ref ring. */
+	size_t block_bytes;
+	/** What each block of @ref ring holds, owned by the definition macro. */
+	struct audio_file_reader_block *block_info;
+	/** Stack of the I/O thread, owned by the definition macro. */
+	k_thread_stack_t *stack;
+	/** Bytes of @ref stack. */
+	size_t stack_size;
+	/** Blocks in @ref ring. */
+	uint8_t blocks;
+#endif
 
 	/*
 	 * Everything below belongs to the node implementation. It is only
@@ -109,8 +436,49 @@ struct audio_file_reader_state {
 	struct audio_stream_config fmt;
 	/** Payload bytes the parsed @c data chunk still promises. */
 	uint32_t bytes_left;
+	/**
+	 * Kernel that widens the payload into the frame, picked by open() for
+	 * the file's layout: 8, 16, 24 or 32 bit PCM, or 32 bit float.
+	 */
+	audio_dsp_unpack_fn unpack;
+	/** Bytes of one payload sample, 1 to 4. */
+	uint8_t sample_bytes;
 	/** True while @ref file holds an open handle. */
 	bool file_open;
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+	/*
+	 * Read-ahead. The I/O thread owns @ref file, @ref bytes_left,
+	 * @ref head and @ref skip from open() to close(); the pipeline thread
+	 * owns @ref tail and @ref tail_used. A block changes hands through
+	 * @ref full and @ref free only.
+	 */
+	/** The I/O thread, while @ref io_running. */
+	struct k_thread thread;
+	/** Blocks the I/O thread may fill. */
+	struct k_sem free;
+	/** Blocks the pipeline thread may drain. */
+	struct k_sem full;
+	/** Set by close() to stop the I/O thread. */
+	atomic_t stop;
+	/** See audio_file_reader_stats.underruns. */
+	atomic_t underruns;
+	/** See audio_file_reader_stats.low_water. */
+	atomic_t low_water;
+	/** Bytes before the payload in the first block read. */
+	uint32_t skip;
+	/** Bytes of the block at @ref tail already delivered. */
+	uint32_t tail_used;
+	/** Next block the I/O thread fills. */
+	uint8_t head;
+	/** Block the pipeline thread drains. */
+	uint8_t tail;
+	/** True while the pipeline thread holds the block at @ref tail. */
+	bool tail_taken;
+	/** True once the I/O thread has filled its last block. */
+	bool io_done;
+	/** True from the I/O thread's creation until it has been joined. */
+	bool io_running;
+#endif
 };
 
 extern const struct audio_node_ops file_reader_node_ops;
@@ -131,6 +499,81 @@ extern const struct audio_node_ops file_reader_node_ops;
 	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SOURCE, &file_reader_node_ops, NULL, \
 			  &_name##_state)
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+
+/**
+ * @brief Statically define a file reader source node that reads ahead.
+ *
+ * File scope only. Allocates the node, its ::audio_file_reader_state, a ring
+ * of @p _blocks blocks of @p _block_bytes and the stack of an I/O thread of
+ * its own. Needs @kconfig{CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD}.
+ *
+ * The node delivers exactly what AUDIO_FILE_READER_NODE_DEFINE() does, but
+ * the file is read by the I/O thread, at
+ * @kconfig{CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD_PRIO}, a block at a
+ * time into the ring, and the pipeline thread only copies and widens from it.
+ * open() fills the whole ring before it returns, so a run starts with
+ * @p _blocks blocks in hand; when the pipeline thread finds none ready it
+ * waits for the read and counts an underrun (audio_file_reader_get_stats()).
+ *
+ * @param _name        Symbol name of the @ref audio_node instance.
+ * @param _path        Path of the file the source reads from.
+ * @param _block_bytes Bytes per read, a multiple of
+ *                     ::AUDIO_FILE_SECTOR_BYTES.
+ * @param _blocks      Blocks in the ring, 2 to 255: the time the filesystem
+ *                     may stall without the pipeline noticing is
+ *                     @p _blocks - 1 blocks' worth of audio.
+ */
+#define AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(_name, _path, _block_bytes, _blocks)              \
+	BUILD_ASSERT((_block_bytes) > 0 && (_block_bytes) % AUDIO_FILE_SECTOR_BYTES == 0,          \
+		     "AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(" #_name "): block_bytes must be "  \
+		     "a whole number of AUDIO_FILE_SECTOR_BYTES");                                 \
+	BUILD_ASSERT((_blocks) >= 2 && (_blocks) <= UINT8_MAX,                                     \
+		     "AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(" #_name "): the ring needs 2 to "  \
+		     "255 blocks, one being read while another is drained");                      \
+	static uint8_t _name##_ring[(_blocks) * (_block_bytes)]                                    \
+		__aligned(AUDIO_FILE_BLOCK_ALIGN);                                                 \
+	static struct audio_file_reader_block _name##_block_info[(_blocks)];                       \
+	static K_THREAD_STACK_DEFINE(_name##_stack,                                                \
+				     CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD_STACK_SIZE);     \
+	static struct audio_file_reader_state _name##_state = {                                    \
+		.path = (_path),                                                                   \
+		.ring = _name##_ring,                                                              \
+		.block_bytes = (_block_bytes),                                                     \
+		.block_info = _name##_block_info,                                                  \
+		.stack = _name##_stack,                                                            \
+		.stack_size = K_THREAD_STACK_SIZEOF(_name##_stack),                                \
+		.blocks = (_blocks),                                                               \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SOURCE, &file_reader_node_ops, NULL,              \
+			  &_name##_state)
+
+/**
+ * @brief Read how a reading-ahead file reader is keeping up.
+ *
+ * Safe from any thread while the node runs: every figure is one word the
+ * pipeline or the I/O thread writes and this only reads.
+ *
+ * @param node  Node defined with AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE().
+ * @param stats Filled in on success.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node or @p stats is NULL, or @p node is not a file
+ *         reader
+ * @retval -ENOTSUP if @p node is a file reader that does not read ahead
+ */
+int audio_file_reader_get_stats(const struct audio_node *node,
+				struct audio_file_reader_stats *stats);
+
+#else /* CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD */
+
+#define AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(_name, _path, _block_bytes, _blocks)              \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SOURCE,                                      \
+			       "AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE",                         \
+			       "AUDIO_PIPELINE_FILE_READER_READ_AHEAD")
+
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD */
+
 #else /* CONFIG_AUDIO_PIPELINE_NODE_FILE_READER */
 
 #define AUDIO_FILE_READER_NODE_DEFINE(_name, _path)                          \
@@ -138,6 +581,11 @@ extern const struct audio_node_ops file_reader_node_ops;
 			       "AUDIO_FILE_READER_NODE_DEFINE",              \
 			       "AUDIO_PIPELINE_NODE_FILE_READER")
 
+#define AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(_name, _path, _block_bytes, _blocks)              \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SOURCE,                                      \
+			       "AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE",                         \
+			       "AUDIO_PIPELINE_NODE_FILE_READER")
+
 #endif /* CONFIG_AUDIO_PIPELINE_NODE_FILE_READER */
 
 /* -------------------------------------------------------------------------
@@ -155,10 +603,70 @@ extern const struct audio_node_ops file_reader_node_ops;
 
 #ifdef CONFIG_AUDIO_PIPELINE_NODE_FILE_WRITER
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+
+/**
+ * @brief How a writing-behind file writer is keeping up.
+ *
+ * Read with audio_file_writer_get_stats(). Counted since the node was last
+ * opened.
+ */
+struct audio_file_writer_stats {
+	/** Blocks in the ring. */
+	uint8_t blocks;
+	/** Blocks written out and not yet started by the pipeline thread. */
+	uint8_t free;
+	/**
+	 * Fewest blocks the pipeline thread has found free when it started
+	 * one: how close the writer came to an overrun.
+	 */
+	uint8_t low_water;
+	/**
+	 * Times the pipeline thread needed a block the I/O thread had not
+	 * written out yet, and waited for it.
+	 */
+	uint32_t overruns;
+	/** fs_write() calls the I/O thread has made for payload. */
+	uint32_t writes;
+};
+
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND */
+
 /** @brief Per-instance state of the file writer sink node. */
 struct audio_file_writer_state {
 	/** Destination file, owned by the definition macro. */
 	const char *path;
+	/**
+	 * Audio between two header checkpoints in milliseconds, 0 for none
+	 * (spec §10.2.2). Starts at
+	 * @kconfig{CONFIG_AUDIO_PIPELINE_FILE_WRITER_CHECKPOINT_MS} for a
+	 * writing-behind writer and at 0 for a plain one, which open() refuses
+	 * any other value for; change it with audio_file_writer_set_checkpoint().
+	 */
+	uint32_t checkpoint_ms;
+	/**
+	 * Write 32 bit IEEE float samples instead of PCM at the bound depth.
+	 * Starts false; change it with audio_file_writer_set_float().
+	 */
+	bool ieee_float;
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	/**
+	 * Write-behind ring of @ref blocks blocks of @ref block_bytes, owned
+	 * by AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(); NULL for a node
+	 * that writes on the pipeline thread.
+	 */
+	uint8_t *ring;
+	/** Bytes in one block of @ref ring. */
+	size_t block_bytes;
+	/** Bytes queued in each block of @ref ring, owned by the definition macro. */
+	uint32_t *block_fill;
+	/** Stack of the I/O thread, owned by the definition macro. */
+	k_thread_stack_t *stack;
+	/** Bytes of @ref stack. */
+	size_t stack_size;
+	/** Blocks in @ref ring. */
+	uint8_t blocks;
+#endif
 	/**
 	 * Format the sink wrote to disk, as a copy of the pipeline's bound
 	 * format (spec §10.2). Populated by open() from
@@ -169,8 +677,9 @@ struct audio_file_writer_state {
 	 *
 	 * The container field describes the *pipeline* side and is always
 	 * ::AUDIO_SAMPLE_FORMAT_S32_LE; @c valid_bits_per_sample is the on-disk
-	 * resolution and v1 supports 16 only (spec §5.2/§5.3), so open() refuses
-	 * anything else with @c -ENOTSUP.
+	 * resolution, 8, 16, 24 or 32 (spec §5.2/§5.3), so open() refuses
+	 * anything else with @c -ENOTSUP - unless the file is in float, which
+	 * holds any of them.
 	 */
 	struct audio_stream_config fmt;
 
@@ -184,14 +693,110 @@ struct audio_file_writer_state {
 	struct fs_file_t file;
 	/** Payload bytes appended to the @c data chunk so far. */
 	uint32_t data_bytes;
+	/** @ref checkpoint_ms as payload bytes of @ref fmt; 0 for none. */
+	uint32_t checkpoint_bytes;
+	/** @ref data_bytes the header on disk declares, as of the last patch. */
+	uint32_t checkpointed_bytes;
 	/** True while @ref file holds an open handle. */
 	bool file_open;
 	/** Set while the sizes on disk are older than @ref data_bytes. */
 	bool header_stale;
-	/** Scratch space for the S32 -> S16 conversion, never read by callers. */
-	uint8_t chunk[AUDIO_FILE_WRITER_CHUNK_SAMPLES * sizeof(int16_t)];
+	/** @ref ieee_float as of open(): the layout of the file being written. */
+	bool float_out;
+	/** Bytes of one payload sample, 1 to 4. */
+	uint8_t sample_bytes;
+	/** Kernel that narrows the container to the file's layout, picked by open(). */
+	audio_dsp_pack_fn pack;
+	/** Scratch space for the container -> file conversion, never read by callers. */
+	uint8_t chunk[AUDIO_FILE_WRITER_CHUNK_SAMPLES * sizeof(int32_t)];
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	/*
+	 * Write-behind. The I/O thread owns @ref file, @ref data_bytes and
+	 * @ref tail whenever a block is queued; the pipeline thread owns the
+	 * rest, and takes the file back by draining the ring. A block changes
+	 * hands through @ref full and @ref free only.
+	 */
+	/** The I/O thread, while @ref io_running. */
+	struct k_thread thread;
+	/** Blocks the pipeline thread may fill. */
+	struct k_sem free;
+	/** Blocks the I/O thread may write out. */
+	struct k_sem full;
+	/** Set by close() to stop the I/O thread. */
+	atomic_t stop;
+	/** First failed write not yet reported by process() or close(). */
+	atomic_t error;
+	/** See audio_file_writer_stats.overruns. */
+	atomic_t overruns;
+	/** See audio_file_writer_stats.low_water. */
+	atomic_t low_water;
+	/** See audio_file_writer_stats.writes. */
+	atomic_t writes;
+	/** Payload bytes queued, written out or not. */
+	uint32_t queued_bytes;
+	/** File offset the next queued byte lands at. */
+	uint32_t file_bytes;
+	/** Next block the pipeline thread fills. */
+	uint8_t head;
+	/** Next block the I/O thread writes out. */
+	uint8_t tail;
+	/** True while the pipeline thread holds the block at @ref head. */
+	bool head_taken;
+	/** Set by the I/O thread once a write failed: it writes no more. */
+	bool io_failed;
+	/** True from the I/O thread's creation until it has been joined. */
+	bool io_running;
+#endif
 };
 
+/**
+ * @brief Set how often a writing-behind file writer checkpoints its header.
+ *
+ * Checkpoints require write-behind: a writer defined with
+ * AUDIO_FILE_WRITER_NODE_DEFINE() takes only 0.
+ *
+ * Every @p interval_ms of audio written, the writer patches the RIFF and
+ * @c data sizes on disk to the payload so far and syncs the file, so a run
+ * cut short by a reset or a power loss leaves a file that plays up to the
+ * last checkpoint instead of an empty track (spec §10.2.2). The writer
+ * checkpoints on its I/O thread, after the block that crossed the interval,
+ * so only a node that writes behind takes one: a plain writer would have to
+ * make the seek, write and sync inside process().
+ *
+ * The interval is read by open(), so it applies from the next run; it
+ * outlives close().
+ *
+ * @param node        Node defined with one of the file writer macros.
+ * @param interval_ms Audio between checkpoints in milliseconds; 0 patches
+ *                    the header at end of stream and in close() only.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node is NULL or not a file writer
+ * @retval -ENOTSUP if @p interval_ms is not 0 and @p node does not write
+ *                  behind
+ */
+int audio_file_writer_set_checkpoint(const struct audio_node *node, uint32_t interval_ms);
+
+/**
+ * @brief Choose whether a file writer writes IEEE float or PCM.
+ *
+ * A float file holds every sample as a 32 bit IEEE 754 value in [-1, 1],
+ * the container divided by 2^31 (spec §10.2), whatever depth the pipeline is
+ * bound at; a PCM file holds the bound depth, which must then be 8, 16, 24 or
+ * 32 bit. Float keeps the top 24 bits of a sample exactly and the quiet end of
+ * a stream at more, which is what a capture meant for later processing wants.
+ *
+ * The choice is read by open(), so it applies from the next file; it
+ * outlives close().
+ *
+ * @param node       Node defined with one of the file writer macros.
+ * @param ieee_float True for @c WAVE_FORMAT_IEEE_FLOAT, false for PCM.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node is NULL or not a file writer
+ */
+int audio_file_writer_set_float(const struct audio_node *node, bool ieee_float);
+
 extern const struct audio_node_ops file_writer_node_ops;
 
 /**
@@ -211,6 +816,83 @@ extern const struct audio_node_ops file_writer_node_ops;
 	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SINK, &file_writer_node_ops, (_upstream), \
 			  &_name##_state)
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+
+/**
+ * @brief Statically define a file writer sink node that writes behind.
+ *
+ * File scope only. Allocates the node, its ::audio_file_writer_state, a ring
+ * of @p _blocks blocks of @p _block_bytes and the stack of an I/O thread of
+ * its own. Needs @kconfig{CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND}.
+ *
+ * The node writes exactly the file AUDIO_FILE_WRITER_NODE_DEFINE() does, but
+ * the pipeline thread only narrows into the ring, and the I/O thread, at
+ * @kconfig{CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND_PRIO}, writes it
+ * out a full block at a time, each ending on a multiple of @p _block_bytes in
+ * the file. When the pipeline thread finds no block free it waits for a write
+ * and counts an overrun (audio_file_writer_get_stats()).
+ *
+ * @param _name        Symbol name of the @ref audio_node instance.
+ * @param _upstream    Pointer to the upstream node.
+ * @param _path        Path of the file the sink writes to.
+ * @param _block_bytes Bytes per write, a multiple of
+ *                     ::AUDIO_FILE_SECTOR_BYTES.
+ * @param _blocks      Blocks in the ring, 2 to 255: the time the filesystem
+ *                     may stall without the pipeline noticing is
+ *                     @p _blocks - 1 blocks' worth of audio.
+ */
+#define AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(_name, _upstream, _path, _block_bytes,          \
+						   _blocks)                                        \
+	BUILD_ASSERT((_block_bytes) > 0 && (_block_bytes) % AUDIO_FILE_SECTOR_BYTES == 0,          \
+		     "AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(" #_name "): block_bytes must "   \
+		     "be a whole number of AUDIO_FILE_SECTOR_BYTES");                              \
+	BUILD_ASSERT((_blocks) >= 2 && (_blocks) <= UINT8_MAX,                                     \
+		     "AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(" #_name "): the ring needs 2 "   \
+		     "to 255 blocks, one being written while another is filled");                 \
+	static uint8_t _name##_ring[(_blocks) * (_block_bytes)] __aligned(AUDIO_FILE_BLOCK_ALIGN); \
+	static uint32_t _name##_block_fill[(_blocks)];                                             \
+	static K_THREAD_STACK_DEFINE(_name##_stack,                                                \
+				     CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND_STACK_SIZE);   \
+	static struct audio_file_writer_state _name##_state = {                                    \
+		.path = (_path),                                                                   \
+		.checkpoint_ms = CONFIG_AUDIO_PIPELINE_FILE_WRITER_CHECKPOINT_MS,                  \
+		.ring = _name##_ring,                                                              \
+		.block_bytes = (_block_bytes),                                                     \
+		.block_fill = _name##_block_fill,                                                  \
+		.stack = _name##_stack,                                                            \
+		.stack_size = K_THREAD_STACK_SIZEOF(_name##_stack),                                \
+		.blocks = (_blocks),                                                               \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SINK, &file_writer_node_ops, (_upstream),         \
+			  &_name##_state)
+
+/**
+ * @brief Read how a writing-behind file writer is keeping up.
+ *
+ * Safe from any thread while the node runs: every figure is one word the
+ * pipeline or the I/O thread writes and this only reads.
+ *
+ * @param node  Node defined with AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE().
+ * @param stats Filled in on success.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node or @p stats is NULL, or @p node is not a file
+ *         writer
+ * @retval -ENOTSUP if @p node is a file writer that does not write behind
+ */
+int audio_file_writer_get_stats(const struct audio_node *node,
+				struct audio_file_writer_stats *stats);
+
+#else /* CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND */
+
+#define AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(_name, _upstream, _path, _block_bytes,          \
+						   _blocks)                                        \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SINK,                                        \
+			       "AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE",                       \
+			       "AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND")
+
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND */
+
 #else /* CONFIG_AUDIO_PIPELINE_NODE_FILE_WRITER */
 
 #define AUDIO_FILE_WRITER_NODE_DEFINE(_name, _upstream, _path)               \
@@ -218,8 +900,230 @@ extern const struct audio_node_ops file_writer_node_ops;
 			       "AUDIO_FILE_WRITER_NODE_DEFINE",              \
 			       "AUDIO_PIPELINE_NODE_FILE_WRITER")
 
+#define AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(_name, _upstream, _path, _block_bytes,          \
+						   _blocks)                                        \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SINK,                                        \
+			       "AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE",                       \
+			       "AUDIO_PIPELINE_NODE_FILE_WRITER")
+
 #endif /* CONFIG_AUDIO_PIPELINE_NODE_FILE_WRITER */
 
+/* -------------------------------------------------------------------------
+ * FIR filter node
+ * -------------------------------------------------------------------------
+ */
+
+/** @brief Most taps an FIR node takes. */
+#define AUDIO_FIR_MAX_TAPS 1024
+
+/**
+ * @brief Channels an FIR node keeps a delay line for.
+ *
+ * The v1 channel range (spec §5.2); open() refuses a wider stream. It is also
+ * what the overlap-save form fits into one complex transform.
+ */
+#define AUDIO_FIR_MAX_CHANNELS 2
+
+/**
+ * @brief One tap of an FIR node, from a floating-point constant.
+ *
+ * Converted to Q4.28 at compile time (see ::AUDIO_DSP_COEFF), so it must be in
+ * [-8, 8), and the magnitudes of all the taps must sum to less than 16.
+ */
+#define AUDIO_FIR_TAP(_x) AUDIO_DSP_COEFF(_x)
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_FIR
+
+/** @brief Per-instance state of the FIR filter node. */
+struct audio_fir_state {
+	/**
+	 * Direct form: taps and delay lines, owned by the definition macro.
+	 * Used when @ref fft has an order of 0.
+	 */
+	struct audio_dsp_fir direct;
+	/**
+	 * Overlap-save: taps, transforms and history, owned by the definition
+	 * macro. Used when its order is not 0.
+	 */
+	struct audio_dsp_fir_fft fft;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+extern const struct audio_node_ops fir_node_ops;
+
+/* The tap count both definitions check; not for direct use. */
+#define Z_AUDIO_FIR_TAPS_CHECK(_taps, _macro)                                                      \
+	BUILD_ASSERT(ARRAY_SIZE(_taps) >= 1 && ARRAY_SIZE(_taps) <= AUDIO_FIR_MAX_TAPS,            \
+		     _macro "() takes 1 to AUDIO_FIR_MAX_TAPS taps")
+
+/**
+ * @brief Statically define an FIR filter node in direct form.
+ *
+ * File scope only. Runs every channel through the same taps, in place and
+ * saturating, with a circular delay line per channel; every output costs one
+ * multiply-add per tap (spec §10.10). Allocates the node, its
+ * ::audio_fir_state and the delay lines.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_FIR}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ * @param _taps     A const int32_t array of Q4.28 taps (AUDIO_FIR_TAP()), tap
+ *                  0 applying to the newest sample, 1 to
+ *                  ::AUDIO_FIR_MAX_TAPS of them. An array, not a pointer: the
+ *                  macro sizes the delay lines from it.
+ */
+#define AUDIO_FIR_NODE_DEFINE(_name, _upstream, _taps)                                             \
+	Z_AUDIO_FIR_TAPS_CHECK(_taps, "AUDIO_FIR_NODE_DEFINE");                                    \
+	static int32_t _name##_line[AUDIO_FIR_MAX_CHANNELS * 2 * ARRAY_SIZE(_taps)];               \
+	static struct audio_fir_state _name##_state = {                                            \
+		.direct =                                                                          \
+			{                                                                          \
+				.taps = (_taps),                                                   \
+				.line = _name##_line,                                              \
+				.tap_count = ARRAY_SIZE(_taps),                                    \
+			},                                                                         \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &fir_node_ops, (_upstream),               \
+			  &_name##_state)
+
+/**
+ * @brief Statically define an FIR filter node run by overlap-save.
+ *
+ * As AUDIO_FIR_NODE_DEFINE(), but each frame is filtered in blocks through an
+ * FFT of 2^@p _order points, which costs about the same per sample whatever
+ * the tap count (spec §10.10). It pays off past about a hundred taps, and only
+ * when a frame carries at least as many sample sets per channel as there are
+ * taps: every call transforms at least one whole block. The outputs match the
+ * direct form to within the transform's rounding, not bit for bit. Allocates
+ * the node, its ::audio_fir_state, the two transforms and the history.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_FIR}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ * @param _taps     As for AUDIO_FIR_NODE_DEFINE(), at least 2.
+ * @param _order    log2 of the transform length, up to
+ *                  ::AUDIO_DSP_FFT_MAX_ORDER. 2^@p _order must be at least the
+ *                  tap count; twice the tap count or more leaves blocks long
+ *                  enough for the transform to pay for itself.
+ */
+#define AUDIO_FIR_FFT_NODE_DEFINE(_name, _upstream, _taps, _order)                                 \
+	Z_AUDIO_FIR_TAPS_CHECK(_taps, "AUDIO_FIR_FFT_NODE_DEFINE");                                \
+	BUILD_ASSERT((_order) >= 1 && (_order) <= AUDIO_DSP_FFT_MAX_ORDER,                         \
+		     "AUDIO_FIR_FFT_NODE_DEFINE() takes an order up to AUDIO_DSP_FFT_MAX_ORDER");  \
+	BUILD_ASSERT(ARRAY_SIZE(_taps) >= 2 && ARRAY_SIZE(_taps) <= (1 << (_order)),               \
+		     "AUDIO_FIR_FFT_NODE_DEFINE() needs 2 to 2^order taps");                       \
+	static struct audio_dsp_complex _name##_spectrum[1 << (_order)];                           \
+	static struct audio_dsp_complex _name##_work[1 << (_order)];                               \
+	static int32_t _name##_history[AUDIO_FIR_MAX_CHANNELS * (ARRAY_SIZE(_taps) - 1)];          \
+	static struct audio_fir_state _name##_state = {                                            \
+		.fft =                                                                             \
+			{                                                                          \
+				.taps = (_taps),                                                   \
+				.spectrum = _name##_spectrum,                                      \
+				.work = _name##_work,                                              \
+				.history = _name##_history,                                        \
+				.tap_count = ARRAY_SIZE(_taps),                                    \
+				.order = (_order),                                                 \
+			},                                                                         \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &fir_node_ops, (_upstream),               \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_FIR */
+
+#define AUDIO_FIR_NODE_DEFINE(_name, _upstream, _taps)                       \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                \
+			       "AUDIO_FIR_NODE_DEFINE",                      \
+			       "AUDIO_PIPELINE_NODE_FIR")
+
+#define AUDIO_FIR_FFT_NODE_DEFINE(_name, _upstream, _taps, _order)           \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                \
+			       "AUDIO_FIR_FFT_NODE_DEFINE",                  \
+			       "AUDIO_PIPELINE_NODE_FIR")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_FIR */
+
+/* -------------------------------------------------------------------------
+ * S32-to-float and float-to-S32 filter nodes
+ * -------------------------------------------------------------------------
+ */
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_FLOAT_CONVERT
+
+/** @brief Per-instance state of an s32-to-float or a float-to-s32 node. */
+struct audio_float_convert_state {
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** The node's format in the other sample format: what upstream is opened with. */
+	struct audio_stream_config input_format;
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+/** Ops of the s32-to-float node: S32 above, F32 below. */
+extern const struct audio_node_ops s32_to_float_node_ops;
+/** Ops of the float-to-s32 node: F32 above, S32 below. */
+extern const struct audio_node_ops float_to_s32_node_ops;
+
+/**
+ * @brief Statically define an s32-to-float node.
+ *
+ * File scope only. Opened with an F32 format, it asks every node upstream for
+ * the same format in S32 and converts each frame it pulls in place, full scale
+ * to 1.0 (spec §10.14), so the nodes below it up to a float-to-s32 node can
+ * run their floating-point paths. Allocates the node and its
+ * ::audio_float_convert_state.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_FLOAT_CONVERT}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ */
+#define AUDIO_S32_TO_FLOAT_NODE_DEFINE(_name, _upstream)                                           \
+	static struct audio_float_convert_state _name##_state;                                     \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &s32_to_float_node_ops, (_upstream),      \
+			  &_name##_state)
+
+/**
+ * @brief Statically define a float-to-s32 node.
+ *
+ * File scope only. The inverse of AUDIO_S32_TO_FLOAT_NODE_DEFINE(): opened
+ * with an S32 format, it asks upstream for the same format in F32 and turns
+ * each frame it pulls back into containers, rounding to nearest and
+ * saturating, so a float stretch's headroom ends here.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_FLOAT_CONVERT}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ */
+#define AUDIO_FLOAT_TO_S32_NODE_DEFINE(_name, _upstream)                                           \
+	static struct audio_float_convert_state _name##_state;                                     \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &float_to_s32_node_ops, (_upstream),      \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_FLOAT_CONVERT */
+
+#define AUDIO_S32_TO_FLOAT_NODE_DEFINE(_name, _upstream)                                           \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER, "AUDIO_S32_TO_FLOAT_NODE_DEFINE",    \
+			       "AUDIO_PIPELINE_NODE_FLOAT_CONVERT")
+
+#define AUDIO_FLOAT_TO_S32_NODE_DEFINE(_name, _upstream)                                           \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER, "AUDIO_FLOAT_TO_S32_NODE_DEFINE",    \
+			       "AUDIO_PIPELINE_NODE_FLOAT_CONVERT")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_FLOAT_CONVERT */
+
 /* -------------------------------------------------------------------------
  * Gain filter node
  * -------------------------------------------------------------------------
@@ -228,31 +1132,248 @@ extern const struct audio_node_ops file_writer_node_ops;
 /** @brief Q15 unity gain: sample * AUDIO_GAIN_UNITY_Q15 >> 15 == sample. */
 #define AUDIO_GAIN_UNITY_Q15 32768
 
+/**
+ * @brief Per-channel gains one gain filter definition can name.
+ *
+ * The v1 channel range (spec §5.2), because a per-channel definition names
+ * exactly one gain per channel.
+ */
+#define AUDIO_GAIN_FILTER_MAX_CHANNELS 2
+
+/**
+ * @brief Curve a gain filter follows from its gain to a new one.
+ *
+ * See audio_gain_filter_set().
+ */
+enum audio_gain_ramp {
+	/** The gain moves by the same step every sample. */
+	AUDIO_GAIN_RAMP_LINEAR,
+	/**
+	 * The gain moves by the same fraction of the distance left every
+	 * sample, so a fade towards silence is a straight line in dB. It ends
+	 * within ::AUDIO_GAIN_RAMP_EXP_RESIDUAL_DB of the new gain and takes the
+	 * rest as its last step.
+	 */
+	AUDIO_GAIN_RAMP_EXPONENTIAL,
+};
+
+/**
+ * @brief Level below the distance it started from that an exponential ramp
+ *        reaches before its last step, in dB.
+ */
+#define AUDIO_GAIN_RAMP_EXP_RESIDUAL_DB 60
+
 #ifdef CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER
 
+/**
+ * @brief A gain handed from audio_gain_filter_set() to the pipeline thread.
+ *
+ * Internal to the node; one of three slots in ::audio_gain_filter_state.
+ */
+struct audio_gain_filter_request {
+	/** New gain in Q15, for every channel. */
+	int32_t gain_q15;
+	/** Samples per channel the ramp to it takes; 0 steps. */
+	uint32_t ramp_samples;
+	/** Curve of the ramp. */
+	enum audio_gain_ramp ramp;
+};
+
 /** @brief Per-instance state of the gain filter node. */
 struct audio_gain_filter_state {
-	/** Gain in Q15; 0 is treated as unity gain by open(). */
+	/**
+	 * Gain in Q15 applied to every channel, used when @ref gain_count is 0;
+	 * 0 is treated as unity gain by open(). The single gain needs no
+	 * pipeline format, so a node defined with
+	 * AUDIO_GAIN_FILTER_NODE_DEFINE() opens on its own.
+	 */
 	int32_t gain_q15;
+	/**
+	 * Gain of each channel, in channel order, owned by the definition
+	 * macro: Q15 (::AUDIO_GAIN_UNITY_Q15 is 1.0) or, with
+	 * @ref gain_is_q31, a Q31 fraction in [-1, 1). Taken as written, so 0
+	 * mutes its channel here.
+	 */
+	int32_t gain[AUDIO_GAIN_FILTER_MAX_CHANNELS];
+	/**
+	 * Entries of @ref gain the definition named; 0 for a node with a single
+	 * @ref gain_q15. Otherwise open() requires exactly the pipeline's
+	 * channel count, for the reason the tone generator does: a gain left
+	 * over or a channel without one is a wiring statement that no longer
+	 * matches the stream.
+	 */
+	uint8_t gain_count;
+	/** True if @ref gain holds Q31 fractions rather than Q15 gains. */
+	bool gain_is_q31;
+
+	/*
+	 * The handoff from audio_gain_filter_set(), and the only part of the
+	 * state another thread touches. It is a triple buffer: a setter fills
+	 * the slot it owns (@ref request_back) and swaps it into
+	 * @ref request_mid; the pipeline thread, once per frame, reads
+	 * @ref request_mid and swaps it with the slot it owns
+	 * (@ref request_front) only if it is marked new. Neither side ever
+	 * reads a slot the other is writing, and the pipeline thread takes no
+	 * lock. @ref set_lock only orders one setter against another. The
+	 * definition macros set the three indices apart.
+	 */
+
+	/** The three slots. */
+	struct audio_gain_filter_request request[3];
+	/** Index of the slot between the two sides, plus a "new" bit. */
+	atomic_t request_mid;
+	/** Index of the slot the setters fill, under @ref set_lock. */
+	uint8_t request_back;
+	/** Index of the slot the pipeline thread last took. */
+	uint8_t request_front;
+	/** Orders concurrent audio_gain_filter_set() calls. */
+	struct k_spinlock set_lock;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/**
+	 * Last gain taken from audio_gain_filter_set(), valid if @ref gain_set.
+	 * It outlives close(), so the next open() starts from it rather than
+	 * from the definition.
+	 */
+	int32_t set_gain_q15;
+	/** True once a gain was taken from audio_gain_filter_set(). */
+	bool gain_set;
+	/** The gains in the form the kernel takes (spec §5.4). */
+	struct audio_dsp_gain scale[AUDIO_GAIN_FILTER_MAX_CHANNELS];
+	/** Entries of @ref scale: 1 for a single gain, else the channel count. */
+	uint8_t scale_count;
+	/** True if every gain is exactly unity, so process() only pulls. */
+	bool unity;
+	/** Sample sets the ramp in progress still has to run; 0 when settled. */
+	uint32_t ramp_left;
+	/** Curve of the ramp in progress. */
+	enum audio_gain_ramp ramp;
+	/** Range shared by every gain of the ramp, as audio_dsp_gain.shift. */
+	uint8_t ramp_shift;
+	/** True if a gain on the ramp can clip a sample. */
+	bool ramp_clamp;
+	/** Exponential ramp: fraction of the distance left per sample, Q30. */
+	int32_t ramp_k_q30;
+	/**
+	 * Per entry of @ref scale: the current and the final gain as Q31
+	 * fractions of the @ref ramp_shift range, 30 more fractional bits
+	 * below them, and the linear ramp's step per sample set.
+	 */
+	int64_t ramp_level[AUDIO_GAIN_FILTER_MAX_CHANNELS];
+	int64_t ramp_target[AUDIO_GAIN_FILTER_MAX_CHANNELS];
+	int64_t ramp_step[AUDIO_GAIN_FILTER_MAX_CHANNELS];
 };
 
+/** @brief Initialiser of the setter handoff; not for direct use. */
+#define Z_AUDIO_GAIN_FILTER_REQUEST_INIT                                                           \
+	.request_mid = ATOMIC_INIT(1), .request_back = 0U, .request_front = 2U
+
+/**
+ * @brief Set a gain filter's gain, ramping to it.
+ *
+ * Every channel gets @p gain_q15, replacing the gains the definition named.
+ * The pipeline thread takes the newest gain set at the start of its next
+ * frame and moves to it over @p ramp_samples samples per channel, one step
+ * per sample set, so the change is heard as a fade rather than a click. A gain
+ * set during a ramp starts a new ramp from wherever the current one has got
+ * to. A ramp costs an add and a multiply per sample more than a settled gain
+ * and no division: the steps are worked out once when the gain is taken.
+ *
+ * Safe to call from any thread, an ISR included, in any pipeline state. The
+ * pipeline thread takes no lock for it: it reads one atomic per frame and
+ * exchanges it when there is a new gain. Gains set faster than frames are
+ * processed collapse into the newest.
+ *
+ * The gain set outlives the run: a gain set while the node is closed, or the
+ * last one set before close(), is where the next open() starts, as a step.
+ *
+ * @param node         Node defined with one of the gain filter macros.
+ * @param gain_q15     New gain in Q15 (::AUDIO_GAIN_UNITY_Q15 is 1.0), for
+ *                     every channel. 0 mutes.
+ * @param ramp_samples Length of the ramp in samples per channel; 0 changes
+ *                     the gain at the next frame boundary.
+ * @param ramp         Curve of the ramp.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node is NULL or not a gain filter, or @p ramp is not
+ *         an ::audio_gain_ramp
+ */
+int audio_gain_filter_set(const struct audio_node *node, int32_t gain_q15, uint32_t ramp_samples,
+			  enum audio_gain_ramp ramp);
+
 extern const struct audio_node_ops gain_filter_node_ops;
 
 /**
- * @brief Statically define a gain filter node.
+ * @brief Statically define a gain filter node.
+ *
+ * File scope only. Allocates the node and its ::audio_gain_filter_state.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER}.
+ *
+ * Every sample is scaled by the same gain, with saturation: a gain above unity
+ * clips a loud input at full scale rather than wrapping it around.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ * @param _gain_q15 Gain in Q15 (::AUDIO_GAIN_UNITY_Q15 is 1.0).
+ */
+#define AUDIO_GAIN_FILTER_NODE_DEFINE(_name, _upstream, _gain_q15)                           \
+	static struct audio_gain_filter_state _name##_state = {                              \
+		.gain_q15 = (_gain_q15),                                                     \
+		Z_AUDIO_GAIN_FILTER_REQUEST_INIT,                                            \
+	};                                                                                   \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &gain_filter_node_ops, (_upstream), \
+			  &_name##_state)
+
+/**
+ * @brief Statically define a gain filter node with a Q15 gain per channel.
+ *
+ * As AUDIO_GAIN_FILTER_NODE_DEFINE(), but the gains are variadic and there is
+ * one per channel, in channel order, exactly as in AUDIO_TONE_GEN_NODE_DEFINE():
+ * open() refuses a pipeline whose channel count says otherwise. A gain of 0
+ * mutes its channel.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ * @param ...       One Q15 gain per channel, at most
+ *                  ::AUDIO_GAIN_FILTER_MAX_CHANNELS of them.
+ */
+#define AUDIO_GAIN_FILTER_Q15_NODE_DEFINE(_name, _upstream, ...)                                   \
+	Z_AUDIO_GAIN_FILTER_CHANNELS_DEFINE(_name, _upstream, false,                               \
+					    "AUDIO_GAIN_FILTER_Q15_NODE_DEFINE", __VA_ARGS__)
+
+/**
+ * @brief Statically define a gain filter node with a Q31 gain per channel.
  *
- * File scope only. Allocates the node and its ::audio_gain_filter_state.
- * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER}.
+ * As AUDIO_GAIN_FILTER_Q15_NODE_DEFINE(), with each gain a Q31 fraction in
+ * [-1, 1): the resolution for attenuation - a trim of a fraction of a dB, a
+ * fade's last steps - that a Q15 gain rounds away.
  *
  * @param _name     Symbol name of the @ref audio_node instance.
  * @param _upstream Pointer to the upstream node.
- * @param _gain_q15 Gain in Q15 (::AUDIO_GAIN_UNITY_Q15 is 1.0).
+ * @param ...       One Q31 gain per channel, at most
+ *                  ::AUDIO_GAIN_FILTER_MAX_CHANNELS of them.
  */
-#define AUDIO_GAIN_FILTER_NODE_DEFINE(_name, _upstream, _gain_q15)                           \
-	static struct audio_gain_filter_state _name##_state = {                              \
-		.gain_q15 = (_gain_q15),                                                     \
-	};                                                                                   \
-	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &gain_filter_node_ops, (_upstream), \
+#define AUDIO_GAIN_FILTER_Q31_NODE_DEFINE(_name, _upstream, ...)                                   \
+	Z_AUDIO_GAIN_FILTER_CHANNELS_DEFINE(_name, _upstream, true,                                \
+					    "AUDIO_GAIN_FILTER_Q31_NODE_DEFINE", __VA_ARGS__)
+
+/* The two per-channel definitions; not for direct use. */
+#define Z_AUDIO_GAIN_FILTER_CHANNELS_DEFINE(_name, _upstream, _q31, _macro, ...)                   \
+	BUILD_ASSERT(NUM_VA_ARGS(__VA_ARGS__) >= 1 &&                                              \
+			     NUM_VA_ARGS(__VA_ARGS__) <= AUDIO_GAIN_FILTER_MAX_CHANNELS,           \
+		     _macro "() takes one gain per channel");                                      \
+	static struct audio_gain_filter_state _name##_state = {                                    \
+		.gain = {__VA_ARGS__},                                                             \
+		.gain_count = NUM_VA_ARGS(__VA_ARGS__),                                            \
+		.gain_is_q31 = (_q31),                                                             \
+		Z_AUDIO_GAIN_FILTER_REQUEST_INIT,                                                  \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &gain_filter_node_ops, (_upstream),       \
 			  &_name##_state)
 
 #else /* CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER */
@@ -262,6 +1383,16 @@ extern const struct audio_node_ops gain_filter_node_ops;
 			       "AUDIO_GAIN_FILTER_NODE_DEFINE",              \
 			       "AUDIO_PIPELINE_NODE_GAIN_FILTER")
 
+#define AUDIO_GAIN_FILTER_Q15_NODE_DEFINE(_name, _upstream, ...)             \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                \
+			       "AUDIO_GAIN_FILTER_Q15_NODE_DEFINE",          \
+			       "AUDIO_PIPELINE_NODE_GAIN_FILTER")
+
+#define AUDIO_GAIN_FILTER_Q31_NODE_DEFINE(_name, _upstream, ...)             \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                \
+			       "AUDIO_GAIN_FILTER_Q31_NODE_DEFINE",          \
+			       "AUDIO_PIPELINE_NODE_GAIN_FILTER")
+
 #endif /* CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER */
 
 /* -------------------------------------------------------------------------
@@ -327,6 +1458,34 @@ extern const struct audio_node_ops gain_filter_node_ops;
 #define AUDIO_I2S_BLOCK_BYTES(_frame_samples)                                                      \
 	ROUND_UP((size_t)(_frame_samples) * AUDIO_I2S_WIRE_MAX_WORD_BYTES, AUDIO_I2S_BLOCK_ALIGN)
 
+/**
+ * @brief Frame format both I2S nodes configure, and the channel counts it can
+ *        carry.
+ *
+ * A Philips I2S frame is two words, left and right, framed by the word select
+ * line; a mono stream cannot be carried in it without inventing the other word,
+ * and a wider one does not fit. With @kconfig{CONFIG_AUDIO_PIPELINE_I2S_TDM}
+ * the nodes configure a TDM frame instead - one short frame sync pulse and as
+ * many slots as the stream has channels, which is how multichannel codecs and
+ * microphone arrays are wired - up to the pipeline's channel ceiling,
+ * @kconfig{CONFIG_AUDIO_PIPELINE_MAX_CHANNELS}.
+ *
+ * A build-time choice rather than a run-time one because which frame a link
+ * carries is a property of the codec and the board, fixed in the same place
+ * the devicetree fixes the pins. Either way the samples travel interleaved,
+ * slot order being channel order, so the wire seam and the block sizing above
+ * stay the same.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_I2S_TDM
+#define AUDIO_I2S_DATA_FORMAT  I2S_FMT_DATA_FORMAT_PCM_SHORT
+#define AUDIO_I2S_MIN_CHANNELS 1U
+#define AUDIO_I2S_MAX_CHANNELS CONFIG_AUDIO_PIPELINE_MAX_CHANNELS
+#else
+#define AUDIO_I2S_DATA_FORMAT  I2S_FMT_DATA_FORMAT_I2S
+#define AUDIO_I2S_MIN_CHANNELS 2U
+#define AUDIO_I2S_MAX_CHANNELS 2U
+#endif
+
 /* -------------------------------------------------------------------------
  * I2S input source node
  * -------------------------------------------------------------------------
@@ -378,9 +1537,9 @@ struct audio_i2s_in_state {
 	/**
 	 * Block taken from @ref slab and not yet handed back, or NULL.
 	 *
-	 * A block holds whatever the driver was told to receive, which may be
-	 * more than one frame carries, so it is drained across several
-	 * process() calls and only then returned. It is the node's own property
+	 * A block holds one frame of wire words as the node is defined, but
+	 * a caller may pull smaller frames than that, so it is drained across
+	 * as many process() calls as it takes and only then returned. It is the node's own property
 	 * for as long as it is set here - i2s_read() passed ownership - which is
 	 * why close() and every error path release it explicitly.
 	 */
@@ -389,6 +1548,16 @@ struct audio_i2s_in_state {
 	size_t block_valid;
 	/** Bytes of @ref block already widened into frames. */
 	size_t block_used;
+	/**
+	 * Block lent to the pipeline as the storage of the frame being pulled,
+	 * or NULL (spec §4.1.2).
+	 *
+	 * It is also @ref block until process() has widened it in place, and
+	 * the chain keeps working in it after that, so it is not released with
+	 * @ref block: it stays the node's until the node is next asked to lend,
+	 * or is closed.
+	 */
+	void *lent;
 };
 
 extern const struct audio_node_ops i2s_in_node_ops;
@@ -495,6 +1664,16 @@ struct audio_i2s_out_state {
 	bool configured;
 	/** True while the transmit direction has been started and not stopped. */
 	bool started;
+	/**
+	 * Block taken from @ref slab and lent to the pipeline as the storage of
+	 * the frame being pulled, or NULL (spec §4.1.2).
+	 *
+	 * process() narrows the frame in place and queues this very block, so
+	 * the frame reaches the driver without a copy. A block still set here
+	 * when the node is next asked to lend, or is closed, never reached
+	 * process() and goes straight back to the slab.
+	 */
+	void *lent;
 };
 
 extern const struct audio_node_ops i2s_out_node_ops;
@@ -552,6 +1731,187 @@ extern const struct audio_node_ops i2s_out_node_ops;
 
 #endif /* CONFIG_AUDIO_PIPELINE_NODE_I2S_OUT */
 
+/* -------------------------------------------------------------------------
+ * Interleave and deinterleave filter nodes
+ * -------------------------------------------------------------------------
+ */
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_INTERLEAVE
+
+/** @brief Per-instance state of an interleave or a deinterleave node. */
+struct audio_interleave_state {
+	/** One frame of the other layout, owned by the definition macro. */
+	int32_t *scratch;
+	/** Samples @ref scratch holds. */
+	size_t scratch_capacity;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** The node's format in the other layout: what upstream is opened with. */
+	struct audio_stream_config input_format;
+	/** True for one channel, which is the same frame in either layout. */
+	bool passthrough;
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+/** Ops of the interleave node: planar above, interleaved below. */
+extern const struct audio_node_ops interleave_node_ops;
+/** Ops of the deinterleave node: interleaved above, planar below. */
+extern const struct audio_node_ops deinterleave_node_ops;
+
+/* Shared body of the two definitions. Not for direct use. */
+#define Z_AUDIO_INTERLEAVE_NODE_DEFINE(_name, _upstream, _ops)                                     \
+	static int32_t _name##_scratch[CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES];                       \
+	static struct audio_interleave_state _name##_state = {                                     \
+		.scratch = _name##_scratch,                                                        \
+		.scratch_capacity = ARRAY_SIZE(_name##_scratch),                                   \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, (_ops), (_upstream), &_name##_state)
+
+/**
+ * @brief Statically define a deinterleave node.
+ *
+ * File scope only. Opened with a planar format, it asks every node upstream
+ * for the same format interleaved, and splits each frame it pulls into one
+ * run per channel (spec §10.13), so the nodes below it up to an interleave
+ * node can be ones that declare planar frames. Allocates the node, its
+ * ::audio_interleave_state and one frame of scratch.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_INTERLEAVE}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ */
+#define AUDIO_DEINTERLEAVE_NODE_DEFINE(_name, _upstream)                                           \
+	Z_AUDIO_INTERLEAVE_NODE_DEFINE(_name, _upstream, &deinterleave_node_ops)
+
+/**
+ * @brief Statically define an interleave node.
+ *
+ * File scope only. The inverse of AUDIO_DEINTERLEAVE_NODE_DEFINE(): opened
+ * with an interleaved format, it asks upstream for the same format planar and
+ * merges the runs of each frame it pulls back into sample sets.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_INTERLEAVE}.
+ *
+ * @param _name     Symbol name of the @ref audio_node instance.
+ * @param _upstream Pointer to the upstream node.
+ */
+#define AUDIO_INTERLEAVE_NODE_DEFINE(_name, _upstream)                                             \
+	Z_AUDIO_INTERLEAVE_NODE_DEFINE(_name, _upstream, &interleave_node_ops)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_INTERLEAVE */
+
+#define AUDIO_DEINTERLEAVE_NODE_DEFINE(_name, _upstream)                                           \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER, "AUDIO_DEINTERLEAVE_NODE_DEFINE",    \
+			       "AUDIO_PIPELINE_NODE_INTERLEAVE")
+
+#define AUDIO_INTERLEAVE_NODE_DEFINE(_name, _upstream)                                             \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER, "AUDIO_INTERLEAVE_NODE_DEFINE",      \
+			       "AUDIO_PIPELINE_NODE_INTERLEAVE")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_INTERLEAVE */
+
+/* -------------------------------------------------------------------------
+ * Mixer node
+ * -------------------------------------------------------------------------
+ */
+
+/** @brief Inputs one mixer can sum. */
+#define AUDIO_MIXER_MAX_INPUTS 8
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_MIXER
+
+/**
+ * @brief One input of a mixer: a chain of its own, and the gain it is mixed at.
+ *
+ * Declared with AUDIO_MIXER_INPUT(), never by hand.
+ */
+struct audio_mixer_input {
+	/** Last node of the input chain; the mixer pulls it. */
+	struct audio_node *upstream;
+	/**
+	 * Gain in Q15 (::AUDIO_DSP_UNITY_Q15 is unity). Taken literally - 0
+	 * mutes the input - and applied with saturation, so a gain above unity
+	 * clips instead of wrapping.
+	 */
+	int32_t gain_q15;
+
+	/* The input reported end of stream in the current track. */
+	bool ended;
+};
+
+/** @brief Per-instance state of the mixer node. */
+struct audio_mixer_state {
+	/** Inputs, owned by the definition macro. */
+	struct audio_mixer_input *inputs;
+	/** Entries at @ref inputs. */
+	uint8_t input_count;
+	/** Frame every input but the first live one is pulled into. */
+	int32_t *scratch;
+	/** Samples @ref scratch can hold. */
+	size_t scratch_samples;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** True between a successful open() and close(). */
+	bool is_open;
+};
+
+extern const struct audio_node_ops mixer_node_ops;
+
+/** @brief A mixer input pulled from @p _upstream and mixed at @p _gain_q15. */
+#define AUDIO_MIXER_INPUT(_upstream, _gain_q15) {.upstream = (_upstream), .gain_q15 = (_gain_q15)}
+
+/**
+ * @brief Statically define a mixer node.
+ *
+ * File scope only. Sums its inputs, each scaled by its own gain, into one
+ * frame with saturation. To the chain it feeds, the mixer is where that chain
+ * starts: its own upstream is NULL, and it opens, pulls and closes the input
+ * chains itself, at its own format. An input that reaches end of stream before
+ * the others is mixed as silence; the mixer reports end of stream once every
+ * input has. Allocates the node, its ::audio_mixer_state, the input table and
+ * @p _frame_samples samples of scratch.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_MIXER}.
+ *
+ * @param _name          Symbol name of the @ref audio_node instance.
+ * @param _frame_samples Frame size of the pipeline the mixer runs in. With two
+ *                       or more inputs, open() refuses a larger frame with
+ *                       -EINVAL.
+ * @param ...            One AUDIO_MIXER_INPUT() per input, at most
+ *                       ::AUDIO_MIXER_MAX_INPUTS, counted from the input table
+ *                       for the same reason as the branches of a tee.
+ */
+#define AUDIO_MIXER_NODE_DEFINE(_name, _frame_samples, ...)                                  \
+	static struct audio_mixer_input _name##_inputs[] = {__VA_ARGS__};                    \
+	BUILD_ASSERT(ARRAY_SIZE(_name##_inputs) <= AUDIO_MIXER_MAX_INPUTS,                   \
+		     "AUDIO_MIXER_NODE_DEFINE() takes at most AUDIO_MIXER_MAX_INPUTS "        \
+		     "inputs");                                                              \
+	static int32_t _name##_scratch[(_frame_samples)];                                    \
+	static struct audio_mixer_state _name##_state = {                                    \
+		.inputs = _name##_inputs,                                                    \
+		.input_count = ARRAY_SIZE(_name##_inputs),                                   \
+		.scratch = _name##_scratch,                                                  \
+		.scratch_samples = (_frame_samples),                                         \
+	};                                                                                   \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SOURCE, &mixer_node_ops, NULL, &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_MIXER */
+
+#define AUDIO_MIXER_NODE_DEFINE(_name, _frame_samples, ...)                                  \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SOURCE, "AUDIO_MIXER_NODE_DEFINE",     \
+			       "AUDIO_PIPELINE_NODE_MIXER")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_MIXER */
+
 /* -------------------------------------------------------------------------
  * Null sink node
  * -------------------------------------------------------------------------
@@ -582,6 +1942,311 @@ extern const struct audio_node_ops null_sink_node_ops;
 
 #endif /* CONFIG_AUDIO_PIPELINE_NODE_NULL_SINK */
 
+/* -------------------------------------------------------------------------
+ * Resampler filter node
+ * -------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Channels a resampler converts.
+ *
+ * The v1 channel range (spec §5.2); open() refuses a wider stream.
+ */
+#define AUDIO_RESAMPLER_MAX_CHANNELS 2
+
+/**
+ * @brief Largest input-to-output rate ratio a resampler decimates by.
+ *
+ * 48 kHz to 8 kHz. The input the node keeps grows with the ratio, so the
+ * definition sizes it for this one; open() refuses a larger ratio. There is
+ * no such limit on interpolating.
+ */
+#define AUDIO_RESAMPLER_MAX_DECIMATION 6
+
+/* The three filters the build generates (scripts/gen-resampler-taps.py), as
+ * zero crossings and phases per input period; the generated tables check
+ * their sizes against these. Not for direct use.
+ */
+#define Z_AUDIO_RESAMPLER_FAST_ZERO_CROSSINGS     8
+#define Z_AUDIO_RESAMPLER_FAST_PHASES             64
+#define Z_AUDIO_RESAMPLER_BALANCED_ZERO_CROSSINGS 16
+#define Z_AUDIO_RESAMPLER_BALANCED_PHASES         128
+#define Z_AUDIO_RESAMPLER_BEST_ZERO_CROSSINGS     32
+#define Z_AUDIO_RESAMPLER_BEST_PHASES             256
+
+/* Entries of one quality's wing; not for direct use. */
+#define Z_AUDIO_RESAMPLER_WING_ENTRIES(_quality)                                                   \
+	(Z_AUDIO_RESAMPLER_##_quality##_ZERO_CROSSINGS * Z_AUDIO_RESAMPLER_##_quality##_PHASES + 1)
+
+/* Input sets either side of an output at one quality; not for direct use. */
+#define Z_AUDIO_RESAMPLER_REACH(_quality)                                                          \
+	AUDIO_DSP_RESAMPLER_REACH(Z_AUDIO_RESAMPLER_##_quality##_ZERO_CROSSINGS,                   \
+				  AUDIO_RESAMPLER_MAX_DECIMATION)
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_RESAMPLER
+
+/** @brief Per-instance state of the resampler node. */
+struct audio_resampler_state {
+	/**
+	 * The quality's wing, and scratch for the coefficients, owned by the
+	 * definition macro; the rest is set by open().
+	 */
+	struct audio_dsp_resampler kernel;
+	/** Input sample sets, interleaved, owned by the definition macro. */
+	int32_t *input;
+	/** Samples @ref input holds. */
+	size_t input_capacity;
+	/**
+	 * Rate of everything upstream of the node: the definition's, or the
+	 * last audio_resampler_set_input_rate().
+	 */
+	uint32_t input_rate_hz;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** The node's format at @ref input_rate_hz: what upstream is opened with. */
+	struct audio_stream_config input_format;
+	/** Samples in @ref input no output has moved past yet. */
+	size_t input_count;
+	/** Silent sets still to append past the end of the input. */
+	uint16_t flush_sets;
+	/** True once upstream has reported the end of the stream. */
+	bool eof;
+	/** True if both rates are the same and the node only pulls. */
+	bool passthrough;
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+/**
+ * @brief Set the rate a resampler converts from.
+ *
+ * Replaces the rate the definition named, from the next open() on: this is
+ * for a chain whose source rate is only known at run time, such as the rate of
+ * the next file to play. Call it between runs, from the thread that starts the
+ * pipeline.
+ *
+ * @param node    Node defined with AUDIO_RESAMPLER_NODE_DEFINE().
+ * @param rate_hz Rate of the stream upstream of @p node, in Hz.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node is NULL or not a resampler, or @p rate_hz is 0
+ * @retval -EBUSY if @p node is open
+ */
+int audio_resampler_set_input_rate(const struct audio_node *node, uint32_t rate_hz);
+
+extern const struct audio_node_ops resampler_node_ops;
+
+/* The three generated wings; not for direct use. */
+extern const int32_t z_audio_resampler_wing_FAST[];
+extern const int32_t z_audio_resampler_wing_BALANCED[];
+extern const int32_t z_audio_resampler_wing_BEST[];
+
+/**
+ * @brief Statically define a resampler node.
+ *
+ * File scope only. Converts the stream from @p _input_rate_hz to the rate the
+ * node is opened with - the pipeline's, when nothing else converts below it -
+ * and asks every node upstream for @p _input_rate_hz and otherwise the same
+ * format (spec §10.11). A 44.1 kHz file reader can then feed a 48 kHz I2S
+ * sink. The node pulls as many upstream frames as each of its own needs and
+ * keeps the input it has not used; it adds no delay, and at the end of the
+ * stream it plays out the last input before reporting the end itself.
+ * Allocates the node, its ::audio_resampler_state, the input it keeps and the
+ * coefficient scratch.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_RESAMPLER}.
+ *
+ * @param _name          Symbol name of the @ref audio_node instance.
+ * @param _upstream      Pointer to the upstream node.
+ * @param _input_rate_hz Rate of everything upstream, in Hz, until
+ *                       audio_resampler_set_input_rate() says otherwise.
+ * @param _quality       FAST, BALANCED or BEST: the filter, and with it the
+ *                       cost. Each step doubles the taps per output - 16, 32,
+ *                       64 when interpolating, times the ratio when
+ *                       decimating - and widens the flat passband, from 0.30
+ *                       to 0.35 to 0.42 of the lower rate, with images at -65,
+ *                       -84 and -103 dB. Only the wings that are used are
+ *                       linked, from 2 KiB for FAST to 32 KiB for BEST.
+ */
+#define AUDIO_RESAMPLER_NODE_DEFINE(_name, _upstream, _input_rate_hz, _quality)                    \
+	BUILD_ASSERT((_input_rate_hz) > 0, "AUDIO_RESAMPLER_NODE_DEFINE() needs an input rate");   \
+	static int32_t _name##_input[CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES +                         \
+				     2 * Z_AUDIO_RESAMPLER_REACH(_quality) *                       \
+					     AUDIO_RESAMPLER_MAX_CHANNELS];                        \
+	static int32_t _name##_coeffs[2 * Z_AUDIO_RESAMPLER_REACH(_quality)];                      \
+	static struct audio_resampler_state _name##_state = {                                      \
+		.kernel =                                                                          \
+			{                                                                          \
+				.wing = z_audio_resampler_wing_##_quality,                         \
+				.coeffs = _name##_coeffs,                                          \
+				.zero_crossings = Z_AUDIO_RESAMPLER_##_quality##_ZERO_CROSSINGS,   \
+				.phases = Z_AUDIO_RESAMPLER_##_quality##_PHASES,                   \
+			},                                                                         \
+		.input = _name##_input,                                                            \
+		.input_capacity = ARRAY_SIZE(_name##_input),                                       \
+		.input_rate_hz = (_input_rate_hz),                                                 \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &resampler_node_ops, (_upstream),         \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_RESAMPLER */
+
+#define AUDIO_RESAMPLER_NODE_DEFINE(_name, _upstream, _input_rate_hz, _quality) \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_FILTER,                   \
+			       "AUDIO_RESAMPLER_NODE_DEFINE",                   \
+			       "AUDIO_PIPELINE_NODE_RESAMPLER")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_RESAMPLER */
+
+/* -------------------------------------------------------------------------
+ * Tee sink node and its tap source
+ * -------------------------------------------------------------------------
+ */
+
+/** @brief Branches one tee can feed. */
+#define AUDIO_TEE_MAX_BRANCHES 4
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_TEE
+
+/**
+ * @brief One branch of a tee: a chain of its own, from a tap up to @ref sink.
+ *
+ * Declared with AUDIO_TEE_BRANCH() or AUDIO_TEE_BRANCH_WRITES(), never by hand.
+ */
+struct audio_tee_branch {
+	/** Sink of the branch chain; the top of that chain is a tap node. */
+	struct audio_node *sink;
+	/**
+	 * Some node of the branch modifies the samples it is handed, as the
+	 * gain filter does. A branch without it is trusted to only read them
+	 * (a tone analyzer, a null sink, a file writer) and is handed the
+	 * pulled frame itself; a branch with it gets a copy unless it is the
+	 * last writer, which runs after every other branch and may therefore
+	 * work on the original.
+	 */
+	bool writes;
+
+	/* Tap at the top of the chain, found by open(). */
+	struct audio_node *tap;
+};
+
+/** @brief Per-instance state of the tee sink node. */
+struct audio_tee_state {
+	/** Branches, owned by the definition macro. */
+	struct audio_tee_branch *branches;
+	/** Entries at @ref branches. */
+	uint8_t branch_count;
+	/** Copy-on-write space for the writing branches but the last one. */
+	int32_t *scratch;
+	/** Samples @ref scratch can hold. */
+	size_t scratch_samples;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** True between a successful open() and close(). */
+	bool is_open;
+	/** Frame the branches are currently being fed, and its size. */
+	const int32_t *frame;
+	size_t frame_size;
+	/** Index of the writing branch that works in place; -1 if none. */
+	int8_t last_writer;
+	/**
+	 * Frames copied into @ref scratch since open(). Stays 0 unless two or
+	 * more branches write. Written by the pipeline thread; read it while
+	 * the pipeline is not playing.
+	 */
+	uint32_t copied_frames;
+};
+
+/** @brief Per-instance state of a tee tap source node. */
+struct audio_tee_tap_state {
+	/* Tee feeding this tap, bound by that tee's open(). */
+	struct audio_tee_state *tee;
+	/* The current frame has been handed out. */
+	bool delivered;
+};
+
+extern const struct audio_node_ops tee_node_ops;
+extern const struct audio_node_ops tee_tap_node_ops;
+
+/** @brief A tee branch whose nodes only read the frame. */
+#define AUDIO_TEE_BRANCH(_sink) {.sink = (_sink), .writes = false}
+
+/** @brief A tee branch with a node that modifies the frame in place. */
+#define AUDIO_TEE_BRANCH_WRITES(_sink) {.sink = (_sink), .writes = true}
+
+/**
+ * @brief Statically define a tee tap, the source at the top of a branch.
+ *
+ * File scope only. A tap is bound to the tee whose branch it tops when that
+ * tee opens; until then, and if no tee reaches it, it fails every pull with
+ * @c -EBADF like any node that was not opened. Define the tap first, the branch nodes on it, and the tee
+ * last, as with any chain. Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_TEE}.
+ *
+ * @param _name Symbol name of the @ref audio_node instance.
+ */
+#define AUDIO_TEE_TAP_NODE_DEFINE(_name)                                                    \
+	static struct audio_tee_tap_state _name##_state;                                    \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SOURCE, &tee_tap_node_ops, NULL,           \
+			  &_name##_state)
+
+/**
+ * @brief Statically define a tee sink node.
+ *
+ * File scope only. The tee is the sink of the pipeline: it pulls one frame from
+ * @p _upstream and drives every branch with it, read-only branches first and in
+ * the order given, the writing ones after them. It opens and closes the branch
+ * chains along with itself. Allocates the node, its ::audio_tee_state, the
+ * branch table and @p _frame_samples samples of copy-on-write space, which is
+ * only touched when two or more branches write.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_TEE}.
+ *
+ * @param _name          Symbol name of the @ref audio_node instance.
+ * @param _upstream      Pointer to the upstream node.
+ * @param _frame_samples Frame size of the pipeline the tee runs in. With two or
+ *                       more writing branches, open() refuses a larger frame
+ *                       with -EINVAL.
+ * @param ...            One AUDIO_TEE_BRANCH() or AUDIO_TEE_BRANCH_WRITES()
+ *                       per branch, at most ::AUDIO_TEE_MAX_BRANCHES. Counted
+ *                       from the branch table rather than with NUM_VA_ARGS(),
+ *                       since every branch expands to a braced list with
+ *                       commas of its own.
+ */
+#define AUDIO_TEE_NODE_DEFINE(_name, _upstream, _frame_samples, ...)                        \
+	static struct audio_tee_branch _name##_branches[] = {__VA_ARGS__};                  \
+	BUILD_ASSERT(ARRAY_SIZE(_name##_branches) <= AUDIO_TEE_MAX_BRANCHES,                \
+		     "AUDIO_TEE_NODE_DEFINE() takes at most AUDIO_TEE_MAX_BRANCHES "         \
+		     "branches");                                                           \
+	static int32_t _name##_scratch[(_frame_samples)];                                   \
+	static struct audio_tee_state _name##_state = {                                     \
+		.branches = _name##_branches,                                               \
+		.branch_count = ARRAY_SIZE(_name##_branches),                               \
+		.scratch = _name##_scratch,                                                 \
+		.scratch_samples = (_frame_samples),                                        \
+	};                                                                                  \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SINK, &tee_node_ops, (_upstream),          \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_TEE */
+
+#define AUDIO_TEE_TAP_NODE_DEFINE(_name)                                                    \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SOURCE, "AUDIO_TEE_TAP_NODE_DEFINE",  \
+			       "AUDIO_PIPELINE_NODE_TEE")
+
+#define AUDIO_TEE_NODE_DEFINE(_name, _upstream, _frame_samples, ...)                        \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SINK, "AUDIO_TEE_NODE_DEFINE",        \
+			       "AUDIO_PIPELINE_NODE_TEE")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_TEE */
+
 /* -------------------------------------------------------------------------
  * Tone analyzer sink node
  * -------------------------------------------------------------------------
@@ -591,11 +2256,15 @@ extern const struct audio_node_ops null_sink_node_ops;
  * @brief Tones one tone analyzer definition can name, i.e. the channel range
  *        it can measure.
  *
- * The v1 channel range (spec §5.2), because a definition names exactly one
- * expected frequency per channel, the same pairing the tone generator makes at
- * the other end of the link.
+ * The pipeline's channel ceiling, @kconfig{CONFIG_AUDIO_PIPELINE_MAX_CHANNELS},
+ * because a definition names exactly one expected frequency per channel, the
+ * same pairing the tone generator makes at the other end of the link.
+ *
+ * Every tone is measured on every channel, so the Goertzel state and the
+ * results grow with the square of this; 16 costs about 4 KiB of state per
+ * node, the default of 2 what v1 did.
  */
-#define AUDIO_TONE_ANALYZER_MAX_TONES 2
+#define AUDIO_TONE_ANALYZER_MAX_TONES CONFIG_AUDIO_PIPELINE_MAX_CHANNELS
 
 /** @brief Channels one tone analyzer can measure - one expected tone each. */
 #define AUDIO_TONE_ANALYZER_MAX_CHANNELS AUDIO_TONE_ANALYZER_MAX_TONES
@@ -680,7 +2349,12 @@ enum audio_tone_analyzer_verdict {
 	AUDIO_TONE_ANALYZER_VERDICT_PASS,
 	/** At least one channel carries no signal at all. */
 	AUDIO_TONE_ANALYZER_VERDICT_SILENT,
-	/** Every channel carries another channel's expected tone. */
+	/**
+	 * Every expected tone arrived, each on exactly one channel, but not all
+	 * of them on their own: the channels are wired in another order. Two
+	 * channels trading places is the common case; any reordering is
+	 * reported the same way.
+	 */
 	AUDIO_TONE_ANALYZER_VERDICT_SWAPPED,
 	/** A tone arrived, but not one that was expected on that channel. */
 	AUDIO_TONE_ANALYZER_VERDICT_WRONG_FREQ,
@@ -786,6 +2460,12 @@ struct audio_tone_analyzer_state {
 	struct k_spinlock lock;
 	/** Last completed window, published under @ref lock. */
 	struct audio_tone_analyzer_result result;
+	/**
+	 * The window being judged, built here and copied to @ref result under
+	 * the lock. Kept in the state rather than on the pipeline thread's
+	 * stack because at 16 channels it is over a kilobyte.
+	 */
+	struct audio_tone_analyzer_result pending;
 	/** 2*cos(w) per expected tone in Q24, derived from the bound rate. */
 	int32_t coeff_q24[AUDIO_TONE_ANALYZER_MAX_TONES];
 	/** Goertzel state, one recurrence per channel and expected tone. */
@@ -901,10 +2581,10 @@ int audio_tone_analyzer_get_result(const struct audio_node *node,
 /**
  * @brief Tones one tone generator definition can name.
  *
- * The v1 channel range (spec §5.2), because a definition names exactly one
- * frequency per channel.
+ * The pipeline's channel ceiling, @kconfig{CONFIG_AUDIO_PIPELINE_MAX_CHANNELS},
+ * because a definition names exactly one frequency per channel.
  */
-#define AUDIO_TONE_GEN_MAX_TONES 2
+#define AUDIO_TONE_GEN_MAX_TONES CONFIG_AUDIO_PIPELINE_MAX_CHANNELS
 
 #ifdef CONFIG_AUDIO_PIPELINE_NODE_TONE_GEN
 
@@ -1001,4 +2681,118 @@ extern const struct audio_node_ops tone_gen_node_ops;
 
 #endif /* CONFIG_AUDIO_PIPELINE_NODE_TONE_GEN */
 
+/* -------------------------------------------------------------------------
+ * WAV memory source node
+ * -------------------------------------------------------------------------
+ */
+
+#ifdef CONFIG_AUDIO_PIPELINE_NODE_WAV_MEMORY
+
+/** @brief Per-instance state of the WAV memory source node. */
+struct audio_wav_memory_state {
+	/**
+	 * First byte of the RIFF/WAVE image, owned by the definition macro: a
+	 * @c const array, or the start of a blob the linker placed in flash.
+	 */
+	const uint8_t *image;
+	/** One past the last byte of @ref image. */
+	const uint8_t *image_end;
+	/**
+	 * First sample set of the payload played, as set by
+	 * audio_wav_memory_set_region(); 0 from the definition.
+	 */
+	uint32_t region_start;
+	/**
+	 * Sample sets played from @ref region_start, 0 for the rest of the
+	 * payload.
+	 */
+	uint32_t region_sets;
+	/** Set to play the region over and over instead of ending the stream. */
+	bool loop;
+	/**
+	 * The image's real format after a successful open(): its rate and
+	 * channel count, the canonical S32_LE container, and its depth as the
+	 * effective resolution (spec §5.2).
+	 */
+	struct audio_stream_config fmt;
+
+	/*
+	 * Everything below belongs to the node implementation. It is only
+	 * meaningful between a successful open() and the matching close(), and
+	 * an application must treat it as read-only.
+	 */
+
+	/** First byte of the payload in @ref image. */
+	const uint8_t *payload;
+	/** Sample set the region starts at. */
+	uint32_t first;
+	/** Sample set one past the region. */
+	uint32_t end;
+	/** Next sample set to play. */
+	uint32_t pos;
+	/** True between a successful open() and its close(). */
+	bool is_open;
+};
+
+extern const struct audio_node_ops wav_memory_node_ops;
+
+/**
+ * @brief Play part of a WAV memory source, or loop it.
+ *
+ * The region is counted in sample sets of the payload, from @p start_set
+ * for @p sets sets; @p sets 0 runs to the end of the payload. Without
+ * @p loop the stream ends with the region, with it the region starts over
+ * and the stream never ends. A sprite of several prompts in one image plays
+ * one of them this way.
+ *
+ * Read by open(), so it applies from the next run, and checked there against
+ * the image: a region past the payload, or an empty one to loop, is refused
+ * with @c -EINVAL. It outlives close().
+ *
+ * @param node      Node defined with AUDIO_WAV_MEMORY_NODE_DEFINE().
+ * @param start_set First sample set played.
+ * @param sets      Sample sets played, 0 for the rest of the payload.
+ * @param loop      Play the region over and over.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p node is NULL or not a WAV memory source
+ */
+int audio_wav_memory_set_region(const struct audio_node *node, uint32_t start_set, uint32_t sets,
+				bool loop);
+
+/**
+ * @brief Statically define a source node that plays a WAV image in memory.
+ *
+ * File scope only. Allocates the node and its ::audio_wav_memory_state.
+ * Needs @kconfig{CONFIG_AUDIO_PIPELINE_NODE_WAV_MEMORY}.
+ *
+ * open() parses the image's header once; process() widens straight from the
+ * payload where it lies, with no filesystem and no call per frame. The image
+ * is never written, so it can live in flash.
+ *
+ * The image is two addresses rather than an address and a length, because
+ * the length of a blob between two linker symbols is not a constant
+ * expression and its end is: pass @c clip and @c clip + sizeof(clip) for an
+ * array.
+ *
+ * @param _name      Symbol name of the @ref audio_node instance.
+ * @param _image     First byte of the RIFF/WAVE image.
+ * @param _image_end One past its last byte.
+ */
+#define AUDIO_WAV_MEMORY_NODE_DEFINE(_name, _image, _image_end)                                    \
+	static struct audio_wav_memory_state _name##_state = {                                     \
+		.image = (const uint8_t *)(_image),                                                \
+		.image_end = (const uint8_t *)(_image_end),                                        \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SOURCE, &wav_memory_node_ops, NULL,               \
+			  &_name##_state)
+
+#else /* CONFIG_AUDIO_PIPELINE_NODE_WAV_MEMORY */
+
+#define AUDIO_WAV_MEMORY_NODE_DEFINE(_name, _image, _image_end)                                    \
+	AUDIO_NODE_UNAVAILABLE(_name, AUDIO_NODE_ROLE_SOURCE, "AUDIO_WAV_MEMORY_NODE_DEFINE",      \
+			       "AUDIO_PIPELINE_NODE_WAV_MEMORY")
+
+#endif /* CONFIG_AUDIO_PIPELINE_NODE_WAV_MEMORY */
+
 #endif /* ZEPHYR_AUDIO_NODES_H_ */
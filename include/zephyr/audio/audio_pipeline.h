@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <zephyr/kernel.h>
 #include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/types.h>
 
@@ -20,6 +21,8 @@
 #include <zephyr/audio/audio_node.h>
 #include <zephyr/audio/audio_pipeline_events.h>
 
+struct audio_pipeline_executor;
+
 /**
  * @brief Static configuration of a pipeline instance.
  *
@@ -37,7 +40,312 @@ struct audio_pipeline_config {
 	uint16_t frame_samples;
 	audio_pipeline_event_callback_t event_cb;
 	void *event_user_data;
+
+	/* Release frames in real time instead of as fast as the chain allows
+	 * (spec §3.2). A paced worker emits one frame per frame period - the
+	 * produced sample sets divided by the bound sample rate - and sleeps on
+	 * a k_timer in between, so a chain whose sink does not block (file
+	 * writer, analyzer, null sink) still runs at the rate a hardware sink
+	 * would. Needs CONFIG_AUDIO_PIPELINE_PACED; without it a configuration
+	 * asking for pacing is invalid.
+	 */
+	bool paced;
+
+	/* Run on a shared worker pool instead of a thread of its own (spec
+	 * §3.4). audio_pipeline_start() registers the instance with this
+	 * executor rather than creating a thread, and the instance is paced
+	 * whether or not @c paced is set: its frame period is what the pool
+	 * orders dispatch by. Needs CONFIG_AUDIO_PIPELINE_EXECUTOR. NULL runs
+	 * the instance on its own worker thread as before.
+	 */
+	struct audio_pipeline_executor *executor;
+
+	/* Split the chain into two stages on two threads (spec §3.5). @c split
+	 * is the first node of the producer stage: it and everything upstream
+	 * of it are pulled by a producer thread into a ring of frames, while the
+	 * worker pulls the nodes between it and the sink out of that ring. A
+	 * sink blocked in i2s_write() or fs_write() then no longer holds up the
+	 * source and filters, and the throughput approaches that of the slower
+	 * stage instead of the sum of both.
+	 *
+	 * Must be strictly upstream of the sink, and the instance must have been
+	 * defined with a ring depth (AUDIO_PIPELINE_DEFINE()). Needs
+	 * CONFIG_AUDIO_PIPELINE_RING and cannot be combined with @c executor.
+	 * NULL runs the whole chain on one thread as before.
+	 */
+	struct audio_node *split;
+
+	/* Frames the worker pulls per wake-up (spec §3.1). Between two frames
+	 * of a batch it neither yields nor looks at the lifecycle state, so
+	 * with small frames the fixed cost of a loop pass is paid once per
+	 * batch instead of once per frame - at the price of a stop() taking
+	 * effect up to this many frames later. End of stream and a node error
+	 * still end a batch at once. 0 and 1 both mean one frame per pass.
+	 * Only for a worker of its own that is not paced: a paced worker
+	 * releases exactly one frame per frame period, and an instance on an
+	 * executor has no worker loop, so either with a batch is invalid.
+	 */
+	uint8_t batch_frames;
+
+	/* Processing load, in percent of real time, at which the pipeline
+	 * raises AUDIO_PIPELINE_EVENT_OVERLOAD (spec §8.5). The load of a
+	 * window of CONFIG_AUDIO_PIPELINE_LOAD_WINDOW frames is compared once
+	 * the window is full, and the event is raised again only after the load
+	 * has dropped CONFIG_AUDIO_PIPELINE_LOAD_HYSTERESIS points below this
+	 * value, so a load hovering at the threshold cannot flood the event
+	 * queue. Needs CONFIG_AUDIO_PIPELINE_LOAD_MONITOR; 0 raises no event,
+	 * and the load is measured either way.
+	 */
+	uint8_t overload_percent;
+};
+
+/**
+ * @brief Real-time pacing statistics of a paced pipeline.
+ *
+ * Read with audio_pipeline_get_pacing_stats(). Counted since
+ * audio_pipeline_init(), across every run of the instance.
+ */
+struct audio_pipeline_pacing_stats {
+	/** Frames the paced worker released. */
+	uint32_t frames;
+	/**
+	 * Frames that completed after the next frame was due, i.e. took longer
+	 * than one frame period from their release.
+	 */
+	uint32_t deadline_misses;
+	/** Worst completion time past a deadline, in microseconds. */
+	uint32_t max_lateness_us;
+};
+
+/**
+ * @brief What the worker loop of a pipeline costs around its frames.
+ *
+ * Read with audio_pipeline_get_worker_stats(). Counted since
+ * audio_pipeline_init(), across every run of the instance, and only by a
+ * worker with a @c batch_frames above 1: an unbatched worker reads no cycle
+ * counter in its loop and leaves every field 0.
+ */
+struct audio_pipeline_worker_stats {
+	/** Frames the worker pulled successfully. */
+	uint32_t frames;
+	/**
+	 * Loop passes made while playing, including one that ended at its
+	 * first pull on end of stream or an error.
+	 */
+	uint32_t batches;
+	/**
+	 * Average cycles per frame the worker spent outside the node chain
+	 * while playing: the state checks and the yield between batches. The
+	 * yield counts with whatever ran during it, so tune on an otherwise
+	 * idle system.
+	 */
+	uint32_t overhead_cycles;
+	/** @ref overhead_cycles in nanoseconds. */
+	uint32_t overhead_ns;
+};
+
+/**
+ * @brief Cycle profile of a pipeline's frames (spec §8.4).
+ *
+ * Read with audio_pipeline_get_stats(). Counted since the pipeline was last
+ * started or audio_pipeline_reset_stats() was called.
+ */
+struct audio_pipeline_stats {
+	/**
+	 * One sample per frame the sink was asked for: the lend and the sink's
+	 * whole process() call. On a two-stage run that is the consumer stage;
+	 * the producer stage is the split node's inclusive figure.
+	 */
+	struct audio_profile_stats frame;
+	/**
+	 * Cycles one full frame lasts at the bound format - the budget a frame
+	 * has to fit in for the chain to keep up in real time.
+	 */
+	uint32_t budget_cycles;
+	/** Frames whose sample in @ref frame exceeded @ref budget_cycles. */
+	uint32_t over_budget;
+};
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+/*
+ * Profile state of one instance. Private to the subsystem; observe it through
+ * audio_pipeline_get_stats().
+ */
+struct audio_pipeline_profile {
+	struct audio_profile_counters frame;
+	uint32_t budget_cycles;
+	uint32_t over_budget;
+	/* Entry in the list of started instances the shell dumps. */
+	sys_snode_t entry;
+	bool listed;
+};
+#endif
+
+/**
+ * @brief Real-time headroom of a pipeline (spec §8.5).
+ *
+ * Read with audio_pipeline_get_load_stats(). Every figure is the CPU time the
+ * thread pulling the frames actually ran for - time it spent blocked in a sink
+ * or waiting for the producer stage does not count - in percent of the time
+ * the frames last at the bound format. 100 is a chain that only just keeps up.
+ */
+struct audio_pipeline_load_stats {
+	/** Frames measured since the pipeline was started. */
+	uint32_t frames;
+	/** Load over the last complete window of frames. */
+	uint32_t load_percent;
+	/** Most loaded single frame of the last complete window. */
+	uint32_t worst_percent;
+	/** Most loaded single frame since the pipeline was started. */
+	uint32_t peak_percent;
+	/** AUDIO_PIPELINE_EVENT_OVERLOAD events raised since then. */
+	uint32_t overloads;
+};
+
+#ifdef CONFIG_AUDIO_PIPELINE_LOAD_MONITOR
+/*
+ * Load accounting of one instance. Private to the subsystem; observe it
+ * through audio_pipeline_get_load_stats().
+ */
+struct audio_pipeline_load {
+	/* The window being filled, and whether an overload is outstanding.
+	 * Thread that pulls the frames only.
+	 */
+	uint64_t busy;
+	uint64_t period;
+	uint32_t window_frames;
+	uint32_t window_worst;
+	bool overloaded;
+
+	/* Statistics, written by that thread and read by anyone. */
+	atomic_t frames;
+	atomic_t load_percent;
+	atomic_t worst_percent;
+	atomic_t peak_percent;
+	atomic_t overloads;
+};
+#endif
+
+/*
+ * Worker loop accounting of one instance. Private to the subsystem; observe it
+ * through audio_pipeline_get_worker_stats().
+ */
+struct audio_pipeline_worker_counters {
+	/* Worker thread only. */
+	uint64_t overhead_total;
+
+	/* Written by the worker and read by anyone. */
+	atomic_t frames;
+	atomic_t batches;
+	atomic_t overhead_per_frame;
+};
+
+#ifdef CONFIG_AUDIO_PIPELINE_PACED
+/*
+ * Pacing state of one instance. Private to the subsystem; observe it through
+ * audio_pipeline_get_pacing_stats().
+ */
+struct audio_pipeline_pacing {
+	/* One-shot, re-armed per frame at an absolute tick, and its expiry only
+	 * releases @c audio_pipeline.wake - so every wait the worker does, idle
+	 * or paced, is the same semaphore, and join() interrupts both alike.
+	 */
+	struct k_timer timer;
+
+	/* Release time of sample set 0 of the current run, and the sample sets
+	 * emitted since. Every deadline is computed from these two rather than
+	 * by adding a rounded period to the previous one, so the tick rounding
+	 * of a period that is not a whole number of ticks never accumulates
+	 * into drift. Worker thread only.
+	 */
+	int64_t anchor;
+	uint64_t sets;
+	bool anchored;
+
+	/* Statistics, written by the worker and read by anyone. */
+	atomic_t frames;
+	atomic_t deadline_misses;
+	atomic_t max_lateness_us;
+};
+#endif /* CONFIG_AUDIO_PIPELINE_PACED */
+
+#ifdef CONFIG_AUDIO_PIPELINE_RING
+/*
+ * One frame of the ring: what the producer stage made of it. Private to the
+ * subsystem.
+ */
+struct audio_pipeline_ring_slot {
+	/* Samples the producer stage delivered into the slot. */
+	size_t size;
+	/* 0 for a frame, -EPIPE for the end of stream, any other negative
+	 * value for the error the producer stage failed with. End and error
+	 * travel through the ring as slots of their own, so the consumer stage
+	 * meets them exactly where they happened in the stream.
+	 */
+	int status;
+};
+
+/*
+ * Two-stage state of one instance (spec §3.5). Private to the subsystem; the
+ * storage comes from AUDIO_PIPELINE_DEFINE() with a ring depth.
+ */
+struct audio_pipeline_ring {
+	/* Stands in for the split node in the consumer stage: the node below
+	 * the split pulls from this one, which hands out ring slots. Its
+	 * upstream is the split node, so opening and closing walk the whole
+	 * chain exactly as before.
+	 */
+	struct audio_node node;
+	/* The consumer node whose upstream the ring took over, so join() can
+	 * wire the chain back the way the application built it.
+	 */
+	struct audio_node *below;
+
+	/* Producer thread resources, allocated by the macro. It runs at the
+	 * priority of the worker.
+	 */
+	struct k_thread thread;
+	k_thread_stack_t *stack;
+	size_t stack_size;
+
+	/* @c depth slots. Frame i lives at @c frame_buf + i * @c stride of the
+	 * owning pipeline, so a slot is always a whole frame buffer.
+	 */
+	struct audio_pipeline_ring_slot *slots;
+	size_t depth;
+	size_t stride;
+
+	/* Next slot to fill, written by the producer thread only. Next slot to
+	 * consume, and how many slots the frame in flight holds and has pulled
+	 * through the ring node, written by the worker only.
+	 */
+	size_t head;
+	size_t tail;
+	size_t held;
+	size_t pulled;
+
+	/* Empty and filled slots. The producer sleeps on @c free when it is a
+	 * whole ring ahead, the worker on @c full when the producer stage is
+	 * behind.
+	 */
+	struct k_sem free;
+	struct k_sem full;
+	/* Released by play() and join() for a producer that is parked. */
+	struct k_sem producer_wake;
+
+	/* Held by the producer for every pull of its stage, and by the ring
+	 * node's open() and close(), so the chain is never closed under a
+	 * frame the producer is pulling. @c open is what the producer checks
+	 * under it.
+	 */
+	struct k_mutex stage_lock;
+	bool open;
+	/* Set by the producer after it queued an end of stream or an error:
+	 * it makes nothing past either until the next play().
+	 */
+	atomic_t ended;
 };
+#endif /* CONFIG_AUDIO_PIPELINE_RING */
 
 /**
  * @brief Pipeline instance.
@@ -96,6 +404,14 @@ struct audio_pipeline {
 	int32_t *frame_buf;
 	size_t frame_capacity;
 
+	/* Node asked to lend the storage of each frame instead of @p frame_buf
+	 * (spec §4.1.2): the sink if it can lend, otherwise the node at the
+	 * head of the chain if that one can, otherwise NULL. Chosen each time
+	 * the chain opens and cleared when it closes; always NULL on a
+	 * two-stage run, whose frames live in the ring (spec §3.5).
+	 */
+	struct audio_node *lender;
+
 	/* Event queue (see above): audio_pipeline_init() binds the ring buffer
 	 * below to this k_msgq, which is what audio_pipeline_get_event() reads.
 	 */
@@ -150,6 +466,40 @@ struct audio_pipeline {
 	 * and by the audio_pipeline_start() that creates the thread.
 	 */
 	atomic_t quit_request;
+
+	/* Worker loop accounting, see audio_pipeline_get_worker_stats(). */
+	struct audio_pipeline_worker_counters worker_stats;
+
+#ifdef CONFIG_AUDIO_PIPELINE_PACED
+	/* Used only when the configuration asks for @c paced. */
+	struct audio_pipeline_pacing pacing;
+#endif
+
+#ifdef CONFIG_AUDIO_PIPELINE_EXECUTOR
+	/* True while a pool worker of the configured executor is pulling a
+	 * frame of this instance. Guarded by the executor's lock; it is what
+	 * keeps a second worker off the instance and what audio_pipeline_join()
+	 * waits on before it unregisters it.
+	 */
+	bool dispatching;
+#endif
+
+#ifdef CONFIG_AUDIO_PIPELINE_RING
+	/* Used only when the configuration names a @c split node. */
+	struct audio_pipeline_ring ring;
+#endif
+
+#ifdef CONFIG_AUDIO_PIPELINE_LOAD_MONITOR
+	struct audio_pipeline_load load;
+#endif
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	/* Symbol name given to the definition macro, for the profile dump;
+	 * NULL for a hand-rolled instance.
+	 */
+	const char *name;
+	struct audio_pipeline_profile profile;
+#endif
 };
 
 /**
@@ -170,6 +520,14 @@ struct audio_pipeline {
  * (manifest §6/§8/§9, spec §6.2). The subsystem allocates nothing on top of
  * that and never calls @c k_malloc.
  *
+ * An optional fifth argument, the ring depth, turns the frame buffer into a
+ * ring of that many frames and adds a producer thread stack of
+ * @p _stack_size bytes (spec §3.5). Such an instance can run split in two
+ * stages - see @c audio_pipeline_config.split - and still runs as a single
+ * stage on a configuration without a split. A depth of 2 is double
+ * buffering; more absorbs a stage whose frame time varies. Needs
+ * CONFIG_AUDIO_PIPELINE_RING.
+ *
  * The instance still has to be bound to a configuration and a sink with
  * audio_pipeline_init(); pass a configuration whose @c frame_samples equals
  * @p _frame_samples, because init() clamps the frame capacity to the smaller
@@ -190,24 +548,87 @@ struct audio_pipeline {
  *                       all channels (not per channel).
  * @param _stack_size    Worker thread stack size in bytes.
  * @param _priority      Worker thread priority.
+ * @param ...            Optional ring depth in frames, >= 2.
+ */
+#define AUDIO_PIPELINE_DEFINE(_name, _frame_samples, _stack_size, _priority, ...)                 \
+	COND_CODE_1(IS_EMPTY(__VA_ARGS__),                                                         \
+		    (Z_AUDIO_PIPELINE_DEFINE(_name, _frame_samples, _stack_size, _priority, 1)),   \
+		    (Z_AUDIO_PIPELINE_DEFINE_RING(_name, _frame_samples, _stack_size, _priority,   \
+						  __VA_ARGS__)))
+
+/* Shared body of the definition macros: @p _frames whole frames of storage,
+ * plus whatever extra initialisers the variadic part carries.
  */
-#define AUDIO_PIPELINE_DEFINE(_name, _frame_samples, _stack_size, _priority)               \
-	static K_THREAD_STACK_DEFINE(_name##_stack, _stack_size);                          \
+#define Z_AUDIO_PIPELINE_DEFINE(_name, _frame_samples, _stack_size, _priority, _frames, ...)     \
+	static K_THREAD_STACK_DEFINE(_name##_stack, _stack_size);                                  \
+	static int32_t _name##_frame_buf[(_frames) * (_frame_samples)];                            \
+	static struct audio_pipeline_event                                                         \
+		_name##_event_slots[AUDIO_PIPELINE_EVENT_QUEUE_DEPTH];                             \
+	BUILD_ASSERT((_frame_samples) >= 2,                                                        \
+		     "AUDIO_PIPELINE_DEFINE(" #_name "): frame_samples is the TOTAL "              \
+		     "interleaved sample count and must hold at least one stereo "                 \
+		     "sample set (>= 2), like CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES");               \
+	struct audio_pipeline _name = {                                                            \
+		.stack = _name##_stack,                                                            \
+		.stack_size = K_THREAD_STACK_SIZEOF(_name##_stack),                                \
+		.priority = (_priority),                                                           \
+		.frame_buf = _name##_frame_buf,                                                    \
+		.frame_capacity = (_frame_samples),                                                \
+		.event_slots = _name##_event_slots,                                                \
+		.event_slot_count = ARRAY_SIZE(_name##_event_slots),                               \
+		IF_ENABLED(CONFIG_AUDIO_PIPELINE_PROFILING, (.name = #_name,))                     \
+		__VA_ARGS__                                                                        \
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_RING
+#define Z_AUDIO_PIPELINE_DEFINE_RING(_name, _frame_samples, _stack_size, _priority, _ring_depth)  \
+	BUILD_ASSERT((_ring_depth) >= 2,                                                           \
+		     "AUDIO_PIPELINE_DEFINE(" #_name "): a ring of fewer than two frames "         \
+		     "overlaps nothing; leave the depth out for a single frame buffer");           \
+	static K_THREAD_STACK_DEFINE(_name##_producer_stack, _stack_size);                         \
+	static struct audio_pipeline_ring_slot _name##_ring_slots[_ring_depth];                    \
+	Z_AUDIO_PIPELINE_DEFINE(_name, _frame_samples, _stack_size, _priority, _ring_depth,        \
+				.ring = {                                                          \
+					.stack = _name##_producer_stack,                           \
+					.stack_size =                                              \
+						K_THREAD_STACK_SIZEOF(_name##_producer_stack),     \
+					.slots = _name##_ring_slots,                               \
+					.depth = ARRAY_SIZE(_name##_ring_slots),                   \
+					.stride = (_frame_samples),                                \
+				})
+#else
+#define Z_AUDIO_PIPELINE_DEFINE_RING(_name, _frame_samples, _stack_size, _priority, _ring_depth)  \
+	Z_AUDIO_PIPELINE_DEFINE(_name, _frame_samples, _stack_size, _priority, 1);                \
+	BUILD_ASSERT(0, "AUDIO_PIPELINE_DEFINE(" #_name ") with a ring depth needs "               \
+			"CONFIG_AUDIO_PIPELINE_RING=y")
+#endif /* CONFIG_AUDIO_PIPELINE_RING */
+
+/**
+ * @brief Statically define a pipeline instance that runs on an executor.
+ *
+ * AUDIO_PIPELINE_DEFINE() without the worker thread stack: the instance is
+ * driven by the pool of the executor its configuration names, so it must be
+ * initialised with a configuration whose @c executor is set. Frame buffer and
+ * event queue storage are allocated exactly as AUDIO_PIPELINE_DEFINE() does.
+ *
+ * @param _name          Symbol name of the @ref audio_pipeline instance.
+ * @param _frame_samples Frame buffer size in total interleaved samples across
+ *                       all channels (not per channel).
+ */
+#define AUDIO_PIPELINE_DEFINE_POOLED(_name, _frame_samples)                                 \
 	static int32_t _name##_frame_buf[_frame_samples];                                  \
 	static struct audio_pipeline_event                                                 \
 		_name##_event_slots[AUDIO_PIPELINE_EVENT_QUEUE_DEPTH];                     \
 	BUILD_ASSERT(ARRAY_SIZE(_name##_frame_buf) >= 2,                                   \
-		     "AUDIO_PIPELINE_DEFINE(" #_name "): frame_samples is the TOTAL "      \
-		     "interleaved sample count and must hold at least one stereo "         \
+		     "AUDIO_PIPELINE_DEFINE_POOLED(" #_name "): frame_samples is the "     \
+		     "TOTAL interleaved sample count and must hold at least one stereo "   \
 		     "sample set (>= 2), like CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES");       \
 	struct audio_pipeline _name = {                                                    \
-		.stack = _name##_stack,                                                    \
-		.stack_size = K_THREAD_STACK_SIZEOF(_name##_stack),                        \
-		.priority = (_priority),                                                   \
 		.frame_buf = _name##_frame_buf,                                            \
 		.frame_capacity = ARRAY_SIZE(_name##_frame_buf),                           \
 		.event_slots = _name##_event_slots,                                        \
 		.event_slot_count = ARRAY_SIZE(_name##_event_slots),                       \
+		IF_ENABLED(CONFIG_AUDIO_PIPELINE_PROFILING, (.name = #_name,))             \
 	}
 
 /** @brief Declare a pipeline defined with AUDIO_PIPELINE_DEFINE() elsewhere. */
@@ -274,7 +695,11 @@ int audio_pipeline_init(struct audio_pipeline *pipeline,
  *
  * @param pipeline Initialised pipeline instance.
  * @param fmt      Format to copy in; @c sample_rate_hz and @c channels must be
- *                 non-zero, and @c channels must not exceed the frame capacity.
+ *                 non-zero, @c channels must not exceed the frame capacity,
+ *                 @c layout must be an ::audio_frame_layout and @c format an
+ *                 ::audio_sample_format. Every source and most other nodes
+ *                 take S32 only; F32 is for a stretch between the float
+ *                 converter nodes.
  *
  * @retval 0 on success
  * @retval -EINVAL on a NULL argument, on a pipeline that is not initialised, on
@@ -303,6 +728,10 @@ int audio_pipeline_set_format(struct audio_pipeline *pipeline,
  * thread is created. The worker starts out idle - use audio_pipeline_play()
  * to begin pulling frames.
  *
+ * A pipeline whose configuration names an executor gets no thread: it is
+ * registered with the executor's pool instead (spec §3.4), which is what
+ * "worker" means for it everywhere else in this API.
+ *
  * Idempotent: calling it on a started pipeline with an open chain returns 0.
  * After the error path closed the chain (spec §9.2) another start() reopens it
  * and reuses the existing thread.
@@ -316,6 +745,9 @@ int audio_pipeline_set_format(struct audio_pipeline *pipeline,
  * @retval -ENODATA if no format was bound with audio_pipeline_set_format()
  * @retval -EBUSY if another instance has taken over a built-in resource this
  *         one was joined out of
+ * @retval -ENOSPC if the configured executor has no free registration slot
+ * @retval -EINVAL also if the configured @c split node is not strictly upstream
+ *         of the sink
  * @retval -ELOOP if the upstream chain exceeds the supported depth
  * @retval -ENOTSUP if a node cannot deliver or accept the bound format
  * @retval <0 the first node open() error
@@ -385,14 +817,101 @@ bool audio_pipeline_is_running(const struct audio_pipeline *pipeline);
 /** @brief True while the worker thread is pulling frames. */
 bool audio_pipeline_is_playing(const struct audio_pipeline *pipeline);
 
+/**
+ * @brief Read the real-time pacing statistics of a paced pipeline.
+ *
+ * Safe from any thread while the pipeline runs. Each field is read on its own,
+ * so a snapshot taken mid-frame may count a frame whose miss is not in it yet.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL on a NULL argument or an uninitialised pipeline
+ * @retval -ENOTSUP if the pipeline is not configured as @c paced
+ */
+int audio_pipeline_get_pacing_stats(const struct audio_pipeline *pipeline,
+				    struct audio_pipeline_pacing_stats *stats);
+
+/**
+ * @brief Read what the worker loop of a pipeline costs around its frames.
+ *
+ * Meant for tuning @c batch_frames: the per-frame overhead falls as the batch
+ * grows, and the stop() latency grows with it. Only a batched worker
+ * measures; with @c batch_frames 0 or 1 every field stays 0. Safe from any
+ * thread while the pipeline runs; each field is read on its own.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL on a NULL argument or an uninitialised pipeline
+ * @retval -ENOTSUP if the pipeline runs on an executor, which has no worker
+ *         loop of its own
+ */
+int audio_pipeline_get_worker_stats(const struct audio_pipeline *pipeline,
+				    struct audio_pipeline_worker_stats *stats);
+
+/**
+ * @brief Read the real-time headroom of a pipeline.
+ *
+ * Meant for sizing @c frame_samples per deployment: the load of a chain falls
+ * as frames grow, because the fixed cost of a frame is paid less often, and the
+ * latency grows with it. Safe from any thread while the pipeline runs; each
+ * field is read on its own.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL on a NULL argument or an uninitialised pipeline
+ * @retval -ENOTSUP without CONFIG_AUDIO_PIPELINE_LOAD_MONITOR
+ */
+int audio_pipeline_get_load_stats(const struct audio_pipeline *pipeline,
+				  struct audio_pipeline_load_stats *stats);
+
+/**
+ * @brief Read the cycle profile of a pipeline and of the nodes in its chain.
+ *
+ * Meant for finding the node that blows the frame budget: compare each node's
+ * exclusive figure against @c budget_cycles. The chain is the one
+ * audio_pipeline_start() opens - the sink, then every node upstream of it -
+ * and @p nodes is filled in that order. Branches of a tee and inputs of a
+ * mixer are not on it; read those with audio_node_get_stats().
+ *
+ * Safe from any thread while the pipeline runs; each node is read on its own.
+ *
+ * @param pipeline   Pipeline to read.
+ * @param stats      Frame profile.
+ * @param nodes      Per-node profiles, or NULL for the frame profile only.
+ * @param node_count In: entries @p nodes holds. Out: nodes in the chain,
+ *                   which may be more than were written. Ignored with a NULL
+ *                   @p nodes.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL on a NULL argument or an uninitialised pipeline
+ * @retval -ENOTSUP without CONFIG_AUDIO_PIPELINE_PROFILING
+ */
+int audio_pipeline_get_stats(const struct audio_pipeline *pipeline,
+			     struct audio_pipeline_stats *stats, struct audio_node_stats *nodes,
+			     size_t *node_count);
+
+/**
+ * @brief Forget the cycle profile of a pipeline and of every node in its chain.
+ *
+ * audio_pipeline_start() does the same, so a profile always covers one run.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL on a NULL argument or an uninitialised pipeline
+ * @retval -ENOTSUP without CONFIG_AUDIO_PIPELINE_PROFILING
+ */
+int audio_pipeline_reset_stats(struct audio_pipeline *pipeline);
+
 /**
  * @brief Pull exactly one frame through the chain.
  *
  * Exposed for tests and for applications that want to drive the pipeline from
  * their own thread instead of using play()/stop().
  *
+ * On an instance split in two stages this pulls the consumer stage only, and
+ * waits for the producer thread to deliver the frame - which it does only while
+ * the pipeline is playing.
+ *
  * @retval 0 a frame was produced
  * @retval -EPIPE end of stream (the sink saw @c out_size == 0)
+ * @retval -ECANCELED audio_pipeline_join() ended the wait for the producer
+ *         stage; nothing reached the nodes
  * @retval <0 the node error that aborted the frame
  */
 int audio_pipeline_process_frame(struct audio_pipeline *pipeline);
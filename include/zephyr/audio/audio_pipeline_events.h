@@ -25,6 +25,12 @@ enum audio_pipeline_event_type {
 	AUDIO_PIPELINE_EVENT_EOF = 0,
 	AUDIO_PIPELINE_EVENT_ERROR,
 	AUDIO_PIPELINE_EVENT_RECONFIG,
+	/**
+	 * The processing load crossed @c audio_pipeline_config.overload_percent
+	 * (spec §8.5). Raised once per crossing, with @c err 0; read the figures
+	 * with audio_pipeline_get_load_stats().
+	 */
+	AUDIO_PIPELINE_EVENT_OVERLOAD,
 };
 
 struct audio_pipeline_event {
@@ -0,0 +1,123 @@
+/*
+ * Shared worker pool for many pipelines, dispatching frames earliest deadline
+ * first (CONFIG_AUDIO_PIPELINE_EXECUTOR).
+ *
+ * See audio_pipeline_spec_v2.md §3.4.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_AUDIO_PIPELINE_EXECUTOR_H_
+#define ZEPHYR_AUDIO_PIPELINE_EXECUTOR_H_
+
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/types.h>
+
+struct audio_pipeline;
+
+/**
+ * @brief A pool of worker threads shared by several pipelines.
+ *
+ * A pipeline whose configuration names an executor gets no thread of its own:
+ * audio_pipeline_start() registers it here instead, and whichever pool worker
+ * is free pulls its next frame when that frame is due. Of all frames that are
+ * due, the one with the earliest deadline goes first.
+ *
+ * Every registered pipeline is paced (spec §3.2.1): a frame is released one
+ * frame period after the previous one, on the timeline that play() anchors,
+ * and its deadline is the release of the frame after it. That timeline is what
+ * makes the deadlines comparable across pipelines running at different rates
+ * and frame sizes.
+ *
+ * One pipeline is never pulled by two workers at once, so the node contract -
+ * not reentrant, no internal locking (spec §3.3) - holds unchanged; successive
+ * frames of the same pipeline may simply run on different pool threads. A node
+ * that blocks inside process() holds its worker for as long, which is why
+ * blocking sinks are better left on a pipeline with a thread of its own.
+ *
+ * Define with AUDIO_PIPELINE_EXECUTOR_DEFINE() and start the pool with
+ * audio_pipeline_executor_init() before the first pipeline using it is started.
+ * Everything below is private to the subsystem.
+ */
+struct audio_pipeline_executor {
+	/* Pool threads and their stacks, allocated by the macro. */
+	struct k_thread *threads;
+	k_thread_stack_t *stacks;
+	size_t stack_stride;
+	size_t stack_size;
+	int priority;
+	uint8_t worker_count;
+
+	/* Registered pipelines; a NULL slot is free. */
+	struct audio_pipeline **slots;
+	uint8_t slot_count;
+
+	/* Guards @p slots and every registered pipeline's dispatch bookkeeping.
+	 * The condition variable is broadcast in two cases only: a play() of
+	 * an idle pipeline, which may make a frame due before any worker's
+	 * timed wait ends, and a frame completing on a pipeline with a quit
+	 * request, which the stop or close waiting out that frame needs to
+	 * hear. Any other completed frame wakes nobody: its worker picks the
+	 * next frame itself. Idle workers otherwise sleep until the earliest
+	 * release.
+	 */
+	struct k_mutex lock;
+	struct k_condvar work;
+
+	bool started;
+};
+
+/**
+ * @brief Statically define an executor and its worker pool.
+ *
+ * File scope only. Allocates @p _workers threads with a stack of
+ * @p _stack_size bytes each and room for @p _max_pipelines registered
+ * pipelines. The pipelines themselves bring no stack: define them with
+ * AUDIO_PIPELINE_DEFINE_POOLED().
+ *
+ * @param _name          Symbol name of the @ref audio_pipeline_executor.
+ * @param _workers       Pool threads, >= 1.
+ * @param _max_pipelines Pipelines that may be registered at the same time.
+ * @param _stack_size    Stack size of every pool thread, in bytes.
+ * @param _priority      Priority of every pool thread.
+ */
+#define AUDIO_PIPELINE_EXECUTOR_DEFINE(_name, _workers, _max_pipelines, _stack_size, _priority)   \
+	BUILD_ASSERT((_workers) >= 1 && (_workers) <= UINT8_MAX,                                   \
+		     "AUDIO_PIPELINE_EXECUTOR_DEFINE(" #_name "): needs 1..255 workers");          \
+	BUILD_ASSERT((_max_pipelines) >= 1 && (_max_pipelines) <= UINT8_MAX,                       \
+		     "AUDIO_PIPELINE_EXECUTOR_DEFINE(" #_name "): needs room for 1..255 "          \
+		     "pipelines");                                                                 \
+	static K_THREAD_STACK_ARRAY_DEFINE(_name##_stacks, _workers, _stack_size);                 \
+	static struct k_thread _name##_threads[_workers];                                          \
+	static struct audio_pipeline *_name##_slots[_max_pipelines];                               \
+	struct audio_pipeline_executor _name = {                                                   \
+		.threads = _name##_threads,                                                        \
+		.stacks = (k_thread_stack_t *)_name##_stacks,                                      \
+		.stack_stride = sizeof(_name##_stacks[0]),                                         \
+		.stack_size = K_THREAD_STACK_SIZEOF(_name##_stacks[0]),                            \
+		.priority = (_priority),                                                           \
+		.worker_count = (_workers),                                                        \
+		.slots = _name##_slots,                                                            \
+		.slot_count = (_max_pipelines),                                                    \
+	}
+
+/** @brief Declare an executor defined with AUDIO_PIPELINE_EXECUTOR_DEFINE() elsewhere. */
+#define AUDIO_PIPELINE_EXECUTOR_DECLARE(_name) extern struct audio_pipeline_executor _name
+
+/**
+ * @brief Start the worker pool of an executor.
+ *
+ * The workers idle until a registered pipeline has a frame due. The pool lives
+ * for the rest of the process; there is no counterpart that stops it, because
+ * pipelines come and go through audio_pipeline_start() and
+ * audio_pipeline_join() without ever needing it to.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL on a NULL argument
+ * @retval -EALREADY if the pool is already running
+ */
+int audio_pipeline_executor_init(struct audio_pipeline_executor *executor);
+
+#endif /* ZEPHYR_AUDIO_PIPELINE_EXECUTOR_H_ */
@@ -16,18 +16,48 @@
 extern "C" {
 #endif
 
-/** Format tag of uncompressed PCM (WAVE_FORMAT_PCM); the only tag accepted in v1. */
+/** Format tag of uncompressed PCM (WAVE_FORMAT_PCM). */
 #define AUDIO_WAV_FORMAT_PCM 0x0001U
 
+/**
+ * Format tag of 32 bit IEEE 754 float samples (WAVE_FORMAT_IEEE_FLOAT), full
+ * scale at +-1.0.
+ *
+ * Read at a depth of 32 bits only: 64 bit doubles are a format the S32
+ * container has no use for the precision of, and are refused with
+ * ``-ENOTSUP``.
+ */
+#define AUDIO_WAV_FORMAT_IEEE_FLOAT 0x0003U
+
+/**
+ * Format tag of WAVE_FORMAT_EXTENSIBLE, whose ``fmt `` chunk carries a channel
+ * mask and names the real format by a sub-format GUID.
+ *
+ * It is the form a file of more than two channels is expected to take - a
+ * 16 byte ``fmt `` has no room to say which channel is which - so this module
+ * reads it too, as long as the sub-format it names is PCM or IEEE float.
+ */
+#define AUDIO_WAV_FORMAT_EXTENSIBLE 0xFFFEU
+
 /**
  * Size of a canonical RIFF/WAVE header (RIFF + 16 byte fmt + data chunk header).
  *
- * This is exactly what ::audio_wav_write_header emits. Files carrying extra
- * chunks need a larger prefix to parse; ::AUDIO_WAV_HEADER_SCAN_SIZE is a safe
- * default for readers that buffer the header before seeking.
+ * This is exactly what ::audio_wav_write_header emits for
+ * ::AUDIO_WAV_FORMAT_PCM. Files carrying extra chunks need a larger prefix to
+ * parse; ::AUDIO_WAV_HEADER_SCAN_SIZE is a safe default for readers that buffer
+ * the header before seeking.
  */
 #define AUDIO_WAV_MIN_HEADER_SIZE 44U
 
+/**
+ * Size of the header ::audio_wav_write_header emits for
+ * ::AUDIO_WAV_FORMAT_EXTENSIBLE: the canonical one with a 40 byte ``fmt ``.
+ */
+#define AUDIO_WAV_EXTENSIBLE_HEADER_SIZE 68U
+
+/** Largest header ::audio_wav_write_header emits; sizes a writer's buffer. */
+#define AUDIO_WAV_MAX_HEADER_SIZE AUDIO_WAV_EXTENSIBLE_HEADER_SIZE
+
 /** Recommended prefix size a reader should buffer before parsing. */
 #define AUDIO_WAV_HEADER_SCAN_SIZE 256U
 
@@ -35,7 +65,9 @@ extern "C" {
  * Largest ``data`` payload a canonical header can describe.
  *
  * Both size fields are 32 bit and the RIFF one also counts the header bytes
- * that follow it, so the payload is capped below UINT32_MAX.
+ * that follow it, so the payload is capped below UINT32_MAX. An extensible
+ * header has 24 more of those bytes and caps it that much lower; see
+ * ::audio_wav_max_data_size.
  */
 #define AUDIO_WAV_MAX_DATA_SIZE (UINT32_MAX - (AUDIO_WAV_MIN_HEADER_SIZE - 8U))
 
@@ -52,8 +84,8 @@ extern "C" {
  *   ignored by a write because they follow from the fields above.
  *
  * The values describe the on-disk file, not the canonical pipeline format: a
- * source node is responsible for converting @ref bits_per_sample samples to
- * ``AUDIO_SAMPLE_FORMAT_S32_LE``.
+ * source node is responsible for converting the samples @ref subformat_tag and
+ * @ref bits_per_sample describe to ``AUDIO_SAMPLE_FORMAT_S32_LE``.
  */
 struct audio_wav_header {
 	/** Sampling frequency in Hz, e.g. 44100 or 48000. */
@@ -62,14 +94,43 @@ struct audio_wav_header {
 	uint32_t data_size;
 	/** Derived: byte offset of the first payload byte of the ``data`` chunk. */
 	uint32_t data_offset;
-	/** WAVE format tag; always ::AUDIO_WAV_FORMAT_PCM on a successful read. */
+	/**
+	 * WAVE format tag; ::AUDIO_WAV_FORMAT_PCM,
+	 * ::AUDIO_WAV_FORMAT_IEEE_FLOAT or ::AUDIO_WAV_FORMAT_EXTENSIBLE on a
+	 * successful read. It says which of the two ``fmt `` layouts describes
+	 * the payload; what the samples are is @ref subformat_tag.
+	 */
 	uint16_t format_tag;
+	/**
+	 * Format tag of the samples themselves: @ref format_tag for a plain
+	 * ``fmt ``, and the one the sub-format GUID names for
+	 * ::AUDIO_WAV_FORMAT_EXTENSIBLE - ::AUDIO_WAV_FORMAT_PCM or
+	 * ::AUDIO_WAV_FORMAT_IEEE_FLOAT on a successful read. A write puts it
+	 * in the GUID of an extensible header, 0 meaning PCM, and ignores it
+	 * otherwise.
+	 */
+	uint16_t subformat_tag;
 	/** Number of interleaved channels. */
 	uint16_t channels;
 	/** Bits per sample of the on-disk payload (8, 16, 24 or 32). */
 	uint16_t bits_per_sample;
 	/** Derived: bytes per frame (``channels * bits_per_sample / 8``). */
 	uint16_t block_align;
+	/**
+	 * Bits of each sample that carry signal, from the top, for
+	 * ::AUDIO_WAV_FORMAT_EXTENSIBLE: 20 bit audio in a 24 bit sample, say.
+	 * 0 on a write means all of @ref bits_per_sample, and a read reports
+	 * @ref bits_per_sample for a plain PCM header, which cannot say less.
+	 */
+	uint16_t valid_bits_per_sample;
+	/**
+	 * Speaker position of each channel for ::AUDIO_WAV_FORMAT_EXTENSIBLE,
+	 * as the SPEAKER_* bits of its ``dwChannelMask`` - channel 0 is the
+	 * lowest bit set. 0 says the channels are not speakers at all, which is
+	 * the honest answer for a microphone array. A plain PCM header carries
+	 * no mask and reads back 0.
+	 */
+	uint32_t channel_mask;
 };
 
 /**
@@ -86,25 +147,58 @@ struct audio_wav_header {
  * @param out  Receives the parsed format on success. Must not be NULL. Its
  *             contents are unspecified when the call fails.
  *
- * @retval 0        Header is a valid PCM WAVE header; @p out is populated.
+ * @retval 0        Header is a valid PCM or float WAVE header; @p out is
+ *                  populated.
  * @retval -EINVAL  Arguments are NULL, the buffer is truncated, the RIFF/WAVE
  *                  magic is wrong, a required chunk is missing, or a ``fmt ``
  *                  field is degenerate (zero sample rate or channel count, a
  *                  bit depth that is zero, not a multiple of eight or above
  *                  32, a frame that does not fit the 16 bit ``block_align``
- *                  field, or a ``block_align`` inconsistent with the two).
- * @retval -ENOTSUP Header is structurally valid but the format tag is not
- *                  ::AUDIO_WAV_FORMAT_PCM.
+ *                  field, a ``block_align`` inconsistent with the two, or an
+ *                  extensible valid bit count above the bit depth).
+ * @retval -ENOTSUP Header is structurally valid but describes neither PCM
+ *                  nor 32 bit float: the format tag is none of
+ *                  ::AUDIO_WAV_FORMAT_PCM, ::AUDIO_WAV_FORMAT_IEEE_FLOAT and
+ *                  ::AUDIO_WAV_FORMAT_EXTENSIBLE, or it is the last and its
+ *                  ``fmt `` names another sub-format or is too short to name
+ *                  one at all, or the samples are float of another depth.
  */
 int audio_wav_read_header(const uint8_t *data, size_t len, struct audio_wav_header *out);
 
 /**
- * Serialise a canonical RIFF/WAVE header into a byte buffer.
+ * Bytes ::audio_wav_write_header emits for @p hdr, i.e. the offset its payload
+ * starts at: ::AUDIO_WAV_EXTENSIBLE_HEADER_SIZE for
+ * ::AUDIO_WAV_FORMAT_EXTENSIBLE and ::AUDIO_WAV_MIN_HEADER_SIZE for every other
+ * tag.
  *
- * Writes exactly ::AUDIO_WAV_MIN_HEADER_SIZE bytes: the RIFF container, a 16
- * byte PCM ``fmt `` chunk and the ``data`` chunk header, with no payload. Every
- * field goes out little endian explicitly, so the same bytes are produced on a
- * big endian host.
+ * @param hdr Format about to be serialised. Must not be NULL.
+ */
+size_t audio_wav_header_size(const struct audio_wav_header *hdr);
+
+/**
+ * Largest ``data`` payload the header emitted for @p hdr can describe:
+ * ::AUDIO_WAV_MAX_DATA_SIZE less the bytes the header has beyond the canonical
+ * one.
+ *
+ * @param hdr Format about to be serialised. Must not be NULL.
+ */
+uint32_t audio_wav_max_data_size(const struct audio_wav_header *hdr);
+
+/**
+ * Serialise a RIFF/WAVE header into a byte buffer.
+ *
+ * Writes exactly audio_wav_header_size() bytes: the RIFF container, a ``fmt ``
+ * chunk and the ``data`` chunk header, with no payload. The ``fmt `` is the
+ * 16 byte one, or for ::AUDIO_WAV_FORMAT_EXTENSIBLE the 40 byte one with
+ * @ref audio_wav_header.valid_bits_per_sample,
+ * @ref audio_wav_header.channel_mask and the sub-format of
+ * @ref audio_wav_header.subformat_tag. Every field goes out little endian
+ * explicitly, so the same bytes are produced on a big endian host.
+ *
+ * A float header gets no ``fact`` chunk. Its one field is the count of sample
+ * sets, which the ``data`` size and ``block_align`` already give, and readers
+ * work it out from those; a writer that patches its sizes at end of stream
+ * would otherwise have a third field to keep in step.
  *
  * @ref audio_wav_header.data_size is written verbatim rather than checked
  * against anything the caller has on disk. A writer that only learns the
@@ -112,22 +206,24 @@ int audio_wav_read_header(const uint8_t *data, size_t len, struct audio_wav_head
  * again with the real size once the stream ends.
  *
  * Whatever this call accepts, ::audio_wav_read_header parses back - the one
- * exception being a @ref audio_wav_header.format_tag other than
- * ::AUDIO_WAV_FORMAT_PCM, which is emitted as asked and read back as
- * ``-ENOTSUP``.
+ * exception being a format the parser does not read - a foreign tag or
+ * sub-format, or float of a depth other than 32 bits - which is emitted as
+ * asked and read back as ``-ENOTSUP``.
  *
  * @param buf Buffer receiving the header. Must not be NULL.
- * @param len Capacity of @p buf; must be at least ::AUDIO_WAV_MIN_HEADER_SIZE.
+ * @param len Capacity of @p buf; must be at least audio_wav_header_size().
  * @param hdr Format to serialise. Must not be NULL. @ref
  *            audio_wav_header.data_offset and @ref audio_wav_header.block_align
- *            are ignored; both follow from the rest of the header.
+ *            are ignored; both follow from the rest of the header. So are the
+ *            valid bit count and the channel mask outside the extensible
+ *            layout, which has nowhere to put them.
  *
- * @retval 0       Header written; @p buf holds ::AUDIO_WAV_MIN_HEADER_SIZE bytes.
+ * @retval 0       Header written; @p buf holds audio_wav_header_size() bytes.
  * @retval -EINVAL Arguments are NULL, @p len is too small, or a format field is
  *                 degenerate - the same rules ::audio_wav_read_header enforces,
  *                 so a header this call emits is never one the parser rejects.
  * @retval -EFBIG  @ref audio_wav_header.data_size exceeds
- *                 ::AUDIO_WAV_MAX_DATA_SIZE, which the 32 bit RIFF size field
+ *                 audio_wav_max_data_size(), which the 32 bit RIFF size field
  *                 cannot describe.
  */
 int audio_wav_write_header(uint8_t *buf, size_t len, const struct audio_wav_header *hdr);
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# Compare two runs of the node benchmark (tests/benchmarks/audio_nodes).
+#
+# Each input is anything holding the benchmark's rows: the recording.csv
+# Twister writes next to the build, the handler.log of the run, or the console
+# output saved by hand. Rows are matched on node, variant, channels and frame
+# size; each pair is compared in cycles per sample where both runs have them,
+# in nanoseconds per sample otherwise.
+#
+# Usage:
+#   ./scripts/bench-compare.py BASELINE CURRENT [--threshold PERCENT]
+#
+# Example, one commit against the next:
+#   CI_TEST_PATH=tests/benchmarks ./scripts/ci-test.sh
+#   cp "$(find twister-out -name recording.csv -path '*benchmark.nodes/*')" base.csv
+#   git checkout <next>
+#   CI_TEST_PATH=tests/benchmarks ./scripts/ci-test.sh
+#   ./scripts/bench-compare.py base.csv \
+#       "$(find twister-out -name recording.csv -path '*benchmark.nodes/*')"
+#
+# The benchmark.nodes.generic_vector scenario records the same rows with the
+# generic vector kernels, so the scalar and the vector build compare the same
+# way, within one run:
+#   ./scripts/bench-compare.py \
+#       "$(find twister-out -name recording.csv -path '*benchmark.nodes/*')" \
+#       "$(find twister-out -name recording.csv -path '*generic_vector/*')"
+#
+# Exit status is 1 if any case got slower by more than the threshold (default
+# 10 %) or disappeared, so the script can gate a change; 0 otherwise.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import argparse
+import csv
+import sys
+
+FIELDS = ("node", "variant", "channels", "frame_samples", "samples", "ns",
+          "samples_per_sec", "cycles_per_sample")
+KEY = FIELDS[:4]
+
+
+def read_rows(path):
+    """Rows of one run, keyed by (node, variant, channels, frame_samples)."""
+    rows = {}
+
+    with open(path, newline="", errors="replace") as f:
+        lines = f.read().splitlines()
+
+    if lines and lines[0].split(",")[:len(KEY)] == list(KEY):
+        # recording.csv: Twister's header, then the recorded groups.
+        records = csv.DictReader(lines)
+    else:
+        # A console log: the rows follow a "BENCH," tag anywhere on the line.
+        records = []
+        for line in lines:
+            _, tag, rest = line.partition("BENCH,")
+            values = rest.strip().split(",") if tag else []
+            if len(values) == len(FIELDS) and values[2].isdigit():
+                records.append(dict(zip(FIELDS, values)))
+
+    for record in records:
+        key = tuple(record[k] for k in KEY)
+        samples = int(record["samples"])
+        rows[key] = {
+            "ns": int(record["ns"]) / samples if samples else 0.0,
+            "cycles": float(record["cycles_per_sample"]),
+        }
+
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare two runs of the audio node benchmark.")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent slower that counts as a regression")
+    args = parser.parse_args()
+
+    base = read_rows(args.baseline)
+    cur = read_rows(args.current)
+    if not base or not cur:
+        sys.exit("bench-compare: no benchmark rows in "
+                 + (args.baseline if not base else args.current))
+
+    regressions = 0
+    print(f"{'node':<16} {'variant':<20} {'ch':>2} {'frame':>5} "
+          f"{'unit':<6} {'before':>10} {'after':>10} {'change':>8}")
+
+    for key in sorted(base.keys() | cur.keys(),
+                      key=lambda k: (k[0], k[1], int(k[2]), int(k[3]))):
+        node, variant, channels, frame = key
+        if key not in cur:
+            print(f"{node:<16} {variant:<20} {channels:>2} {frame:>5} missing")
+            regressions += 1
+            continue
+        if key not in base:
+            print(f"{node:<16} {variant:<20} {channels:>2} {frame:>5} new")
+            continue
+
+        unit = "cyc" if base[key]["cycles"] and cur[key]["cycles"] else "ns"
+        metric = "cycles" if unit == "cyc" else "ns"
+        before = base[key][metric]
+        after = cur[key][metric]
+        change = (after - before) / before * 100.0 if before else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  faster"
+
+        print(f"{node:<16} {variant:<20} {channels:>2} {frame:>5} "
+              f"{unit:<6} {before:>10.2f} {after:>10.2f} {change:>+7.1f}%{flag}")
+
+    if regressions:
+        print(f"\n{regressions} case(s) slower by more than {args.threshold:g} % "
+              "or missing")
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+#
+# Generate the resampler node's filter tables (spec §10.11).
+#
+# The resampler runs off one wing of a Kaiser-windowed sinc, sampled at a fixed
+# number of phases per input period, for each of its three qualities. The
+# tables are a function of the four numbers per quality below and nothing
+# else, so they are generated at build time rather than checked in: the build
+# runs this script into its binary directory, and changing a quality is
+# changing its row here and the two matching macros in audio_nodes.h, which the
+# generated file checks itself against with BUILD_ASSERT().
+#
+# Usage:
+#   ./scripts/gen-resampler-taps.py OUTPUT.c
+#
+# The standard library only, so the build needs nothing Zephyr's own Python
+# requirements do not already bring.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import argparse
+import math
+import sys
+
+# name: (zero crossings, phases per period, cutoff as a fraction of the lower
+# Nyquist, Kaiser beta). Measured on the continuous response of each wing:
+#   FAST      flat to 0.30 fs, -1.4 dB at 0.35 fs, images -65 dB
+#   BALANCED  flat to 0.35 fs, -0.3 dB at 0.40 fs, images -84 dB
+#   BEST      flat to 0.42 fs,                     images -103 dB
+# where fs is the lower rate and the images are the ones from past 0.55 fs.
+QUALITIES = {
+    "FAST": (8, 64, 0.80, 6.0),
+    "BALANCED": (16, 128, 0.90, 8.0),
+    "BEST": (32, 256, 0.94, 10.0),
+}
+
+FRAC_BITS = 28
+PER_LINE = 6
+
+
+def bessel_i0(x):
+    """Modified Bessel function of the first kind, order 0, by its series."""
+    total = 1.0
+    term = 1.0
+    k = 1
+
+    while term > 1e-12 * total:
+        term *= (x / (2 * k)) ** 2
+        total += term
+        k += 1
+
+    return total
+
+
+def wing(zero_crossings, phases, cutoff, beta):
+    """h(i / phases) for i = 0 .. zero_crossings * phases, unity gain at DC."""
+    end = zero_crossings * phases
+    values = []
+
+    for i in range(end):
+        u = i / phases
+        x = cutoff * u
+        sinc = 1.0 if i == 0 else math.sin(math.pi * x) / (math.pi * x)
+        r = u / zero_crossings
+        window = bessel_i0(beta * math.sqrt(1.0 - r * r)) / bessel_i0(beta)
+        values.append(cutoff * sinc * window)
+
+    # The window's own edge is not quite 0; the wing's end is.
+    values.append(0.0)
+
+    # At phase 0 the taps sit on the integers, both wings sharing h(0).
+    dc = values[0] + 2.0 * sum(values[m * phases] for m in range(1, zero_crossings))
+
+    return [v / dc for v in values]
+
+
+def q28(value):
+    fixed = round(value * (1 << FRAC_BITS))
+    if not -(1 << 31) <= fixed < (1 << 31):
+        sys.exit(f"wing value {value} is outside Q4.28")
+
+    return fixed
+
+
+def emit(out, name, zero_crossings, phases, cutoff, beta):
+    values = [q28(v) for v in wing(zero_crossings, phases, cutoff, beta)]
+
+    # The kernel's accumulator has room for coefficients whose magnitudes sum
+    # to less than 16 (AUDIO_DSP_COEFF_MAX_SUM); a phase's taps stay near 2.
+    for phase in range(phases):
+        total = sum(abs(values[m * phases + phase]) for m in range(zero_crossings))
+        if 2 * total >= 16 << FRAC_BITS:
+            sys.exit(f"{name}: phase {phase} sums past the coefficient bound")
+
+    out.write(f"/* {zero_crossings} zero crossings, {phases} phases, cutoff {cutoff}, "
+              f"beta {beta}. */\n")
+    out.write(f"const int32_t z_audio_resampler_wing_{name}[{len(values)}] = {{\n")
+    for i in range(0, len(values), PER_LINE):
+        line = ", ".join(str(v) for v in values[i:i + PER_LINE])
+        out.write(f"\t{line},\n")
+    out.write("};\n")
+    out.write(f"BUILD_ASSERT(ARRAY_SIZE(z_audio_resampler_wing_{name}) ==\n"
+              f"\t     Z_AUDIO_RESAMPLER_WING_ENTRIES({name}),\n"
+              f"\t     \"audio_nodes.h disagrees with gen-resampler-taps.py on {name}\");\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the resampler node's filter tables.")
+    parser.add_argument("output", help="C file to write")
+    args = parser.parse_args()
+
+    with open(args.output, "w") as out:
+        out.write("/*\n"
+                  " * Generated by scripts/gen-resampler-taps.py; do not edit.\n"
+                  " *\n"
+                  " * SPDX-License-Identifier: Apache-2.0\n"
+                  " */\n\n"
+                  "#include <stdint.h>\n\n"
+                  "#include <zephyr/sys/util.h>\n"
+                  "#include <zephyr/toolchain.h>\n\n"
+                  "#include <zephyr/audio/audio_nodes.h>\n")
+        for name, params in QUALITIES.items():
+            out.write("\n")
+            emit(out, name, *params)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
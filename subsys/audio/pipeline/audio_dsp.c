@@ -0,0 +1,1664 @@
+/*
+ * Sample kernels (spec §5.4).
+ *
+ * Three implementations of the same arithmetic, picked at build time:
+ *
+ *  - Arm with the DSP extension (Cortex-M4/M7/M33/M55): the product is formed
+ *    with one SMULL and the accumulation is a QADD, so the saturation the mix
+ *    needs costs no compare or branch. The per-channel gain is the same SMULL
+ *    and a 64-bit shift; CMSIS-DSP's arm_scale_q31() would drop the low word
+ *    before the shift and round differently from the other two builds.
+ *  - GCC or Clang on a NEON target (Cortex-A, an AArch64 host running
+ *    native_sim): generic vector extensions, four 32-bit lanes. The 64-bit
+ *    product is built as a high and a low word from widening multiplies of
+ *    the even and the odd lanes, then corrected for sign, so every step after
+ *    the multiply is a 32-bit lane operation, which NEON has throughout. The
+ *    clamp is done with lane masks; C has no vector ternary.
+ *  - Anything else, native_sim on an x86 host included: the scalar loop, which
+ *    is also the reference the two others are tested against and the tail
+ *    loop behind the vector body. x86 is deliberately here: x86-64 multiplies
+ *    64 bits in one instruction and SSE2 and AVX2 have no 64-bit lane multiply,
+ *    arithmetic shift or compare, so every vector form measured on the node
+ *    benchmark, 64-bit lanes or the 32-bit ones above, ran slower than the
+ *    scalar loop once its shift and clamp were taken out where the gains allow.
+ *    CONFIG_AUDIO_PIPELINE_DSP_GENERIC_VECTOR builds the vector body there
+ *    anyway, to test it and to keep the comparison on the benchmark.
+ *
+ * The channel matrix is the same C on every target. A sample set is a handful
+ * of samples and every output of it reads all of them, so there is no run of
+ * like samples for lanes to take; what pays instead is not doing the dot
+ * product where the matrix says it is not needed. prepare() recognises the
+ * matrices a chain actually uses - a copy, a reordering, mono duplicated,
+ * stereo averaged - and each of those has a loop with no multiply at all.
+ *
+ * Interleaving and deinterleaving are copies, the same C everywhere: one pass
+ * over the interleaved side in order, the channel runs written or read a set
+ * at a time, with stereo's two runs named so the loop carries no index
+ * arithmetic.
+ *
+ * The biquad is a recurrence - each output needs the one before - so it has
+ * nothing for lanes to share and is the same C on every target; on Arm the
+ * compiler turns its 64-bit multiply-adds into SMLAL. What it gets instead is
+ * a loop per channel layout that keeps the coefficients and the history in
+ * registers for the whole frame, and for stereo, the two channels' independent
+ * recurrences in one loop, so one channel's multiplies fill the other's wait.
+ *
+ * The FIR kernels are the same C on every target too. The direct form is a
+ * dot product over a delay line laid out so it never wraps, which the
+ * compiler turns into SMLAL on Arm; the overlap-save form is a block-floating-
+ * point FFT with Q31 twiddles from a quarter-wave table, so a long filter costs
+ * O(log N) per sample without putting floating point into the image.
+ *
+ * The resampler is the same C everywhere as well. Its filter is a table of
+ * one wing of the prototype, and each output works out its coefficients from
+ * it once - an interpolation per tap - for all its channels to share, so what
+ * is per channel is again a plain dot product, with stereo in one loop.
+ *
+ * The PCM kernels, which the file nodes convert a WAVE payload with, are the
+ * same C everywhere: byte order explicit, 24-bit samples four at a time as
+ * three whole words, and float samples as integer bit patterns.
+ *
+ * The floating-point kernels are built with CONFIG_AUDIO_PIPELINE_FLOAT only,
+ * and say how they run on each target at the end of the file.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+#include <zephyr/audio/audio_dsp.h>
+
+#if !defined(__ARM_FEATURE_DSP) && defined(__BYTE_ORDER__) &&                                    \
+	__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ &&                                             \
+	(defined(__ARM_NEON) || defined(CONFIG_AUDIO_PIPELINE_DSP_GENERIC_VECTOR))
+#define AUDIO_DSP_VECTOR 1
+#define AUDIO_DSP_LANES  4U
+
+typedef int32_t dsp_v4i32 __attribute__((vector_size(AUDIO_DSP_LANES * sizeof(int32_t))));
+typedef uint32_t dsp_v4u32 __attribute__((vector_size(AUDIO_DSP_LANES * sizeof(int32_t))));
+typedef uint64_t dsp_v2u64 __attribute__((vector_size(AUDIO_DSP_LANES * sizeof(int32_t))));
+#endif
+
+static inline int32_t dsp_sat32(int64_t value)
+{
+	return (int32_t)CLAMP(value, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+}
+
+static inline int32_t dsp_scale(int32_t sample, int32_t gain_q15)
+{
+	return dsp_sat32(((int64_t)sample * gain_q15) >> 15);
+}
+
+static inline int32_t dsp_scale_q31(int32_t sample, const struct audio_dsp_gain *gain)
+{
+	return dsp_sat32(((int64_t)sample * gain->scale_q31) >> (31U - gain->shift));
+}
+
+static inline int32_t dsp_add_sat(int32_t a, int32_t b)
+{
+#if defined(__ARM_FEATURE_DSP)
+	int32_t sum;
+
+	__asm__("qadd %0, %1, %2" : "=r"(sum) : "r"(a), "r"(b));
+
+	return sum;
+#else
+	return dsp_sat32((int64_t)a + b);
+#endif
+}
+
+/* How audio_dsp_gain_q31() runs a set of gains, worked out once per call. */
+struct dsp_gain_plan {
+	/** Right shift the gains share, or -1 if their ranges differ. */
+	int rshift;
+	/** False if every gain is in (-1, 1], so no input can leave the range. */
+	bool clamp;
+};
+
+static struct dsp_gain_plan dsp_gain_plan(const struct audio_dsp_gain *gains, size_t channels)
+{
+	struct dsp_gain_plan plan = {
+		.rshift = 31 - (int)MIN(gains[0].shift, AUDIO_DSP_MAX_SHIFT),
+		.clamp = false,
+	};
+	int64_t value;
+	size_t c;
+
+	for (c = 0; c < channels; c++) {
+		if (gains[c].shift != gains[0].shift) {
+			plan.rshift = -1;
+		}
+
+		value = (int64_t)gains[c].scale_q31 * ((int64_t)1 << MIN(gains[c].shift, 31U));
+		if (value <= INT32_MIN || value > -(int64_t)INT32_MIN) {
+			plan.clamp = true;
+		}
+	}
+
+	return plan;
+}
+
+#ifdef AUDIO_DSP_VECTOR
+/*
+ * The helpers take their vectors by pointer: a vector passed by value changes
+ * ABI with the SIMD level, which GCC warns about even though every call here
+ * is inlined.
+ */
+static inline void dsp_v_load(dsp_v4i32 *value, const int32_t *src)
+{
+	/* memcpy, because a frame slice has no alignment guarantee beyond the
+	 * int32_t one; the compiler turns it into an unaligned load.
+	 */
+	memcpy(value, src, sizeof(*value));
+}
+
+static inline void dsp_v_store(int32_t *dst, const dsp_v4i32 *value)
+{
+	memcpy(dst, value, sizeof(*value));
+}
+
+/* Lane j of every vector of a frame takes gains[j % channels], for a channel
+ * count that divides the lane count.
+ */
+static inline void dsp_v_gains(dsp_v4i32 *scale, const struct audio_dsp_gain *gains,
+			       size_t channels)
+{
+	size_t lane;
+
+	for (lane = 0; lane < AUDIO_DSP_LANES; lane++) {
+		(*scale)[lane] = gains[lane % channels].scale_q31;
+	}
+}
+
+/*
+ * The signed 64-bit products x * g of four lanes, as high and low words. The
+ * unsigned products come from the even and the odd lanes in turn, each lane's
+ * 64 bits landing in one 64-bit half; the sign is put back on the high word
+ * afterwards, since a negative x or g adds 2^32 times the other to the
+ * unsigned product. The arithmetic is unsigned throughout so that its
+ * wrap-around is defined.
+ */
+static inline void dsp_v_mul(dsp_v4u32 *hi, dsp_v4u32 *lo, const dsp_v4i32 *x,
+			     const dsp_v4i32 *g)
+{
+	const dsp_v2u64 low = {UINT32_MAX, UINT32_MAX};
+	dsp_v2u64 even;
+	dsp_v2u64 odd;
+
+	even = ((dsp_v2u64)*x & low) * ((dsp_v2u64)*g & low);
+	odd = ((dsp_v2u64)*x >> 32) * ((dsp_v2u64)*g >> 32);
+
+	*lo = (dsp_v4u32)((even & low) | (odd << 32));
+	*hi = (dsp_v4u32)((even >> 32) | (odd & ~low));
+	*hi -= (dsp_v4u32)((*x >> 31) & *g);
+	*hi -= (dsp_v4u32)((*g >> 31) & *x);
+}
+
+/*
+ * dsp_scale_q31() of one vector, for a right shift of 1 to 31 shared by the
+ * lanes; gains of different ranges stay on the scalar loop. The result is
+ * bits rshift to rshift + 31 of the product; it fits when the bits above them
+ * are all copies of the sign, which is the test on the high word. @p clamp false skips the test for
+ * gains that cannot leave the range.
+ */
+static inline void dsp_v_scale_q31(dsp_v4i32 *value, const dsp_v4i32 *scale, int rshift,
+				   bool clamp)
+{
+	const dsp_v4i32 max = {INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX};
+	dsp_v4i32 top;
+	dsp_v4i32 fits;
+	dsp_v4u32 hi;
+	dsp_v4u32 lo;
+
+	dsp_v_mul(&hi, &lo, value, scale);
+	*value = (dsp_v4i32)((hi << (32 - rshift)) | (lo >> rshift));
+
+	if (clamp) {
+		top = (dsp_v4i32)hi >> (rshift - 1);
+		fits = top == (top >> 31);
+		*value = (*value & fits) | ((((dsp_v4i32)hi >> 31) ^ max) & ~fits);
+	}
+}
+
+static inline void dsp_v_add_sat(dsp_v4i32 *acc, const dsp_v4i32 *term)
+{
+	const dsp_v4i32 max = {INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX};
+	dsp_v4i32 sum = (dsp_v4i32)((dsp_v4u32)*acc + (dsp_v4u32)*term);
+	/* Overflow is both inputs having the sign the sum does not. */
+	dsp_v4i32 over = ((*acc ^ sum) & (*term ^ sum)) >> 31;
+
+	*acc = (sum & ~over) | (((*acc >> 31) ^ max) & over);
+}
+
+/* The vector body of audio_dsp_gain_q31(); returns the samples it covered. */
+static size_t dsp_v_gain_q31(int32_t *dst, const int32_t *src, size_t count,
+			     const struct audio_dsp_gain *gains, size_t channels,
+			     const struct dsp_gain_plan *plan)
+{
+	dsp_v4i32 scale;
+	dsp_v4i32 value;
+	size_t first = 0;
+	size_t i = 0;
+
+	if (plan->rshift < 1 ||
+	    (AUDIO_DSP_LANES % channels != 0U && channels % AUDIO_DSP_LANES != 0U)) {
+		return 0;
+	}
+
+	/* With a channel count that divides the lane count every vector starts
+	 * on channel 0 and one set of lane gains serves them all; otherwise a
+	 * vector is four consecutive channels of one sample set.
+	 */
+	dsp_v_gains(&scale, gains, MIN(channels, AUDIO_DSP_LANES));
+	for (; i + AUDIO_DSP_LANES <= count; i += AUDIO_DSP_LANES) {
+		if (channels > AUDIO_DSP_LANES) {
+			dsp_v_gains(&scale, &gains[first], AUDIO_DSP_LANES);
+			first += AUDIO_DSP_LANES;
+			if (first == channels) {
+				first = 0;
+			}
+		}
+
+		dsp_v_load(&value, &src[i]);
+		dsp_v_scale_q31(&value, &scale, plan->rshift, plan->clamp);
+		dsp_v_store(&dst[i], &value);
+	}
+
+	return i;
+}
+#endif /* AUDIO_DSP_VECTOR */
+
+/*
+ * The scalar loop of audio_dsp_gain_q31() for gains sharing one shift, from
+ * sample @p i on. It is always inlined so that each call, with its constant
+ * @p channels and @p clamp, becomes a loop of its own: the mono one keeps the
+ * gain in a register and the unclamped one is the plain multiply and shift,
+ * both as cheap as a single unsaturated gain.
+ */
+static ALWAYS_INLINE void dsp_gain_loop(int32_t *dst, const int32_t *src, size_t i, size_t count,
+					const struct audio_dsp_gain *gains, size_t channels,
+					int rshift, bool clamp)
+{
+	size_t c = i % channels;
+	int64_t value;
+
+	for (; i < count; i++) {
+		value = ((int64_t)src[i] * gains[c].scale_q31) >> rshift;
+		dst[i] = clamp ? dsp_sat32(value) : (int32_t)value;
+		if (++c == channels) {
+			c = 0;
+		}
+	}
+}
+
+void audio_dsp_gain_from_q15(int32_t gain_q15, struct audio_dsp_gain *out)
+{
+	uint8_t shift = 0;
+	int64_t scale;
+
+	/* x * g >> 15 == x * (g * 2^(16 - s)) >> (31 - s) for any s up to 16,
+	 * where the fraction is the gain itself; the smallest s whose fraction
+	 * fits 32 bits is the one picked.
+	 */
+	for (;;) {
+		scale = (int64_t)gain_q15 * ((int64_t)1 << (16U - shift));
+		if (scale >= INT32_MIN && scale <= INT32_MAX) {
+			break;
+		}
+		shift++;
+	}
+
+	out->scale_q31 = (int32_t)scale;
+	out->shift = shift;
+}
+
+void audio_dsp_gain_q15(int32_t *dst, const int32_t *src, size_t count, int32_t gain_q15)
+{
+	struct audio_dsp_gain gain;
+
+	/* The same arithmetic, bit for bit (see audio_dsp_gain_from_q15()). */
+	audio_dsp_gain_from_q15(gain_q15, &gain);
+	audio_dsp_gain_q31(dst, src, count, &gain, 1U);
+}
+
+void audio_dsp_gain_q31(int32_t *dst, const int32_t *src, size_t count,
+			const struct audio_dsp_gain *gains, size_t channels)
+{
+	struct dsp_gain_plan plan;
+	size_t i = 0;
+	size_t c;
+
+	if (channels == 0U) {
+		return;
+	}
+
+	plan = dsp_gain_plan(gains, channels);
+
+#ifdef AUDIO_DSP_VECTOR
+	i = dsp_v_gain_q31(dst, src, count, gains, channels, &plan);
+#endif
+
+	if (plan.rshift < 0) {
+		/* A channel counter rather than i % channels: a division per
+		 * sample is what the scalar loop on a core without vectors can
+		 * least afford.
+		 */
+		for (c = i % channels; i < count; i++) {
+			dst[i] = dsp_scale_q31(src[i], &gains[c]);
+			if (++c == channels) {
+				c = 0;
+			}
+		}
+	} else if (channels == 1U) {
+		if (plan.clamp) {
+			dsp_gain_loop(dst, src, i, count, gains, 1U, plan.rshift, true);
+		} else {
+			dsp_gain_loop(dst, src, i, count, gains, 1U, plan.rshift, false);
+		}
+	} else {
+		if (plan.clamp) {
+			dsp_gain_loop(dst, src, i, count, gains, channels, plan.rshift, true);
+		} else {
+			dsp_gain_loop(dst, src, i, count, gains, channels, plan.rshift, false);
+		}
+	}
+}
+
+void audio_dsp_mac_q15(int32_t *acc, const int32_t *src, size_t count, int32_t gain_q15)
+{
+	size_t i = 0;
+
+#ifdef AUDIO_DSP_VECTOR
+	struct audio_dsp_gain gain;
+	struct dsp_gain_plan plan;
+
+	audio_dsp_gain_from_q15(gain_q15, &gain);
+	plan = dsp_gain_plan(&gain, 1U);
+	if (plan.rshift >= 1) {
+		const dsp_v4i32 scale = {gain.scale_q31, gain.scale_q31, gain.scale_q31,
+					 gain.scale_q31};
+
+		for (; i + AUDIO_DSP_LANES <= count; i += AUDIO_DSP_LANES) {
+			dsp_v4i32 scaled;
+			dsp_v4i32 sum;
+
+			dsp_v_load(&scaled, &src[i]);
+			dsp_v_scale_q31(&scaled, &scale, plan.rshift, plan.clamp);
+			dsp_v_load(&sum, &acc[i]);
+			dsp_v_add_sat(&sum, &scaled);
+			dsp_v_store(&acc[i], &sum);
+		}
+	}
+#endif
+
+	/* A gain in (-1, 1] cannot clip the scaled term, which leaves the clamp
+	 * of the sum as the only one the loop pays for.
+	 */
+	if (gain_q15 > -AUDIO_DSP_UNITY_Q15 && gain_q15 <= AUDIO_DSP_UNITY_Q15) {
+		for (; i < count; i++) {
+			acc[i] = dsp_add_sat(acc[i], (int32_t)(((int64_t)src[i] * gain_q15) >> 15));
+		}
+	}
+
+	for (; i < count; i++) {
+		acc[i] = dsp_add_sat(acc[i], dsp_scale(src[i], gain_q15));
+	}
+}
+
+/* Widened first, so INT32_MIN has a magnitude too. */
+static inline int64_t dsp_magnitude(int32_t coeff)
+{
+	return coeff < 0 ? -(int64_t)coeff : (int64_t)coeff;
+}
+
+bool audio_dsp_matrix_is_bounded(const int32_t *coeffs_q15, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (dsp_magnitude(coeffs_q15[i]) > AUDIO_DSP_MATRIX_MAX_GAIN_Q15) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void audio_dsp_matrix_prepare(struct audio_dsp_matrix *m)
+{
+	const size_t in = m->in_channels;
+	const size_t out = m->out_channels;
+	bool route = true;
+	bool identity = in == out;
+	bool duplicate = in == 1U;
+	size_t o;
+	size_t i;
+
+	for (o = 0; o < out; o++) {
+		const int32_t *row = &m->coeffs_q15[o * in];
+
+		m->route[o] = AUDIO_DSP_MATRIX_SILENT;
+		for (i = 0; i < in; i++) {
+			if (row[i] == 0) {
+				continue;
+			}
+			if (row[i] != AUDIO_DSP_UNITY_Q15 || m->route[o] != AUDIO_DSP_MATRIX_SILENT) {
+				route = false;
+			}
+			m->route[o] = (uint8_t)i;
+		}
+
+		identity = identity && m->route[o] == o;
+		duplicate = duplicate && m->route[o] == 0U;
+	}
+
+	if (in == 2U && out == 1U && m->coeffs_q15[0] == AUDIO_DSP_UNITY_Q15 / 2 &&
+	    m->coeffs_q15[1] == AUDIO_DSP_UNITY_Q15 / 2) {
+		m->kind = AUDIO_DSP_MATRIX_AVERAGE;
+	} else if (!route) {
+		m->kind = AUDIO_DSP_MATRIX_GENERAL;
+	} else if (identity) {
+		m->kind = AUDIO_DSP_MATRIX_IDENTITY;
+	} else if (duplicate) {
+		m->kind = AUDIO_DSP_MATRIX_DUPLICATE;
+	} else {
+		m->kind = AUDIO_DSP_MATRIX_ROUTE;
+	}
+}
+
+/* One sample set through @p m, from @p set, which holds a copy of its inputs. */
+static ALWAYS_INLINE void dsp_matrix_set(int32_t *dst, const int32_t *set,
+					 const struct audio_dsp_matrix *m)
+{
+	const size_t in = m->in_channels;
+	const int32_t *row = m->coeffs_q15;
+	size_t o;
+	size_t i;
+
+	if (m->kind == AUDIO_DSP_MATRIX_ROUTE) {
+		for (o = 0; o < m->out_channels; o++) {
+			dst[o] = (m->route[o] == AUDIO_DSP_MATRIX_SILENT) ? 0 : set[m->route[o]];
+		}
+		return;
+	}
+
+	for (o = 0; o < m->out_channels; o++, row += in) {
+		int64_t acc = 0;
+
+		for (i = 0; i < in; i++) {
+			acc += (int64_t)set[i] * row[i];
+		}
+		dst[o] = dsp_sat32(acc >> 15);
+	}
+}
+
+void audio_dsp_matrix_q15(int32_t *dst, const int32_t *src, size_t sets,
+			  const struct audio_dsp_matrix *m)
+{
+	const size_t in = m->in_channels;
+	const size_t out = m->out_channels;
+	int32_t set[AUDIO_DSP_MATRIX_MAX_CHANNELS];
+	size_t s;
+	size_t o;
+
+	switch (m->kind) {
+	case AUDIO_DSP_MATRIX_IDENTITY:
+		if (dst != src) {
+			memmove(dst, src, sizeof(dst[0]) * sets * in);
+		}
+		return;
+	case AUDIO_DSP_MATRIX_AVERAGE:
+		/* (a * 2^14 + b * 2^14) >> 15, which cannot leave the range. */
+		for (s = 0; s < sets; s++) {
+			dst[s] = (int32_t)(((int64_t)src[2U * s] + src[2U * s + 1U]) >> 1);
+		}
+		return;
+	case AUDIO_DSP_MATRIX_DUPLICATE:
+		/* Back to front: each set grows over the inputs after it. */
+		for (s = sets; s-- > 0U;) {
+			const int32_t sample = src[s];
+
+			for (o = 0; o < out; o++) {
+				dst[s * out + o] = sample;
+			}
+		}
+		return;
+	default:
+		break;
+	}
+
+	/* A set's inputs are copied out before its outputs land on them, and
+	 * the order of the sets keeps every later input clear of the outputs
+	 * written before it.
+	 */
+	if (out <= in) {
+		for (s = 0; s < sets; s++) {
+			memcpy(set, &src[s * in], sizeof(set[0]) * in);
+			dsp_matrix_set(&dst[s * out], set, m);
+		}
+	} else {
+		for (s = sets; s-- > 0U;) {
+			memcpy(set, &src[s * in], sizeof(set[0]) * in);
+			dsp_matrix_set(&dst[s * out], set, m);
+		}
+	}
+}
+
+void audio_dsp_deinterleave(int32_t *dst, size_t plane, const int32_t *src, size_t sets,
+			    size_t channels)
+{
+	size_t s;
+	size_t c;
+
+	if (channels == 2U) {
+		int32_t *left = dst;
+		int32_t *right = dst + plane;
+
+		for (s = 0; s < sets; s++, src += 2) {
+			left[s] = src[0];
+			right[s] = src[1];
+		}
+		return;
+	}
+
+	for (s = 0; s < sets; s++) {
+		for (c = 0; c < channels; c++) {
+			dst[c * plane + s] = *src++;
+		}
+	}
+}
+
+void audio_dsp_interleave(int32_t *dst, const int32_t *src, size_t plane, size_t sets,
+			  size_t channels)
+{
+	size_t s;
+	size_t c;
+
+	if (channels == 2U) {
+		const int32_t *left = src;
+		const int32_t *right = src + plane;
+
+		for (s = 0; s < sets; s++, dst += 2) {
+			dst[0] = left[s];
+			dst[1] = right[s];
+		}
+		return;
+	}
+
+	for (s = 0; s < sets; s++) {
+		for (c = 0; c < channels; c++) {
+			*dst++ = src[c * plane + s];
+		}
+	}
+}
+
+bool audio_dsp_biquad_is_bounded(const struct audio_dsp_biquad *stage)
+{
+	int64_t sum = dsp_magnitude(stage->b0) + dsp_magnitude(stage->b1) +
+		      dsp_magnitude(stage->b2) + dsp_magnitude(stage->a1) +
+		      dsp_magnitude(stage->a2);
+
+	return sum < AUDIO_DSP_COEFF_MAX_SUM;
+}
+
+#define DSP_COEFF_ROUND (INT64_C(1) << (AUDIO_DSP_COEFF_FRAC_BITS - 1))
+
+/* One output of the recurrence; the caller moves the history along. */
+static ALWAYS_INLINE int32_t dsp_biquad_out(const struct audio_dsp_biquad *c, int32_t x,
+					    const struct audio_dsp_biquad_history *h)
+{
+	int64_t acc = DSP_COEFF_ROUND;
+
+	acc += (int64_t)c->b0 * x;
+	acc += (int64_t)c->b1 * h->x1;
+	acc += (int64_t)c->b2 * h->x2;
+	acc -= (int64_t)c->a1 * h->y1;
+	acc -= (int64_t)c->a2 * h->y2;
+
+	return dsp_sat32(acc >> AUDIO_DSP_COEFF_FRAC_BITS);
+}
+
+static ALWAYS_INLINE void dsp_biquad_push(struct audio_dsp_biquad_history *h, int32_t x, int32_t y)
+{
+	h->x2 = h->x1;
+	h->x1 = x;
+	h->y2 = h->y1;
+	h->y1 = y;
+}
+
+/* One channel, every @p stride samples. Coefficients and history are copied
+ * into locals so nothing in the loop can alias @p data.
+ */
+static void dsp_biquad_channel(int32_t *data, size_t sets, size_t stride,
+			       const struct audio_dsp_biquad *stage,
+			       struct audio_dsp_biquad_history *history)
+{
+	const struct audio_dsp_biquad c = *stage;
+	struct audio_dsp_biquad_history h = *history;
+	size_t i;
+
+	for (i = 0; i < sets; i++, data += stride) {
+		int32_t x = *data;
+		int32_t y = dsp_biquad_out(&c, x, &h);
+
+		dsp_biquad_push(&h, x, y);
+		*data = y;
+	}
+
+	*history = h;
+}
+
+/* Both channels of an interleaved stereo frame in one pass. */
+static void dsp_biquad_stereo(int32_t *data, size_t sets, const struct audio_dsp_biquad *stage,
+			      struct audio_dsp_biquad_history *history)
+{
+	const struct audio_dsp_biquad c = *stage;
+	struct audio_dsp_biquad_history left = history[0];
+	struct audio_dsp_biquad_history right = history[1];
+	size_t i;
+
+	for (i = 0; i < sets; i++, data += 2) {
+		int32_t xl = data[0];
+		int32_t xr = data[1];
+		int32_t yl = dsp_biquad_out(&c, xl, &left);
+		int32_t yr = dsp_biquad_out(&c, xr, &right);
+
+		dsp_biquad_push(&left, xl, yl);
+		dsp_biquad_push(&right, xr, yr);
+		data[0] = yl;
+		data[1] = yr;
+	}
+
+	history[0] = left;
+	history[1] = right;
+}
+
+void audio_dsp_biquad_q31(int32_t *data, size_t count, const struct audio_dsp_biquad *stage,
+			  struct audio_dsp_biquad_history *history, size_t channels)
+{
+	size_t c;
+
+	if (channels == 0U) {
+		return;
+	}
+
+	if (channels == 2U) {
+		dsp_biquad_stereo(data, count / 2U, stage, history);
+		return;
+	}
+
+	for (c = 0; c < channels; c++) {
+		dsp_biquad_channel(data + c, count / channels, channels, stage, &history[c]);
+	}
+}
+
+bool audio_dsp_fir_is_bounded(const int32_t *taps, size_t tap_count)
+{
+	int64_t sum = 0;
+	size_t k;
+
+	for (k = 0; k < tap_count; k++) {
+		sum += dsp_magnitude(taps[k]);
+		if (sum >= AUDIO_DSP_COEFF_MAX_SUM) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* One channel, every @p stride samples, through its delay line. */
+static void dsp_fir_channel(int32_t *data, size_t sets, size_t stride, const int32_t *taps,
+			    size_t tap_count, int32_t *line, size_t pos)
+{
+	size_t i;
+	size_t k;
+
+	for (i = 0; i < sets; i++, data += stride) {
+		const int32_t *x;
+		int64_t acc = DSP_COEFF_ROUND;
+
+		pos = (pos == 0U ? tap_count : pos) - 1U;
+		line[pos] = *data;
+		line[pos + tap_count] = *data;
+
+		x = &line[pos];
+		for (k = 0; k < tap_count; k++) {
+			acc += (int64_t)taps[k] * x[k];
+		}
+
+		*data = dsp_sat32(acc >> AUDIO_DSP_COEFF_FRAC_BITS);
+	}
+}
+
+void audio_dsp_fir_q31(int32_t *data, size_t count, struct audio_dsp_fir *fir, size_t channels)
+{
+	const size_t tap_count = fir->tap_count;
+	size_t sets;
+	size_t c;
+
+	if (channels == 0U) {
+		return;
+	}
+
+	sets = count / channels;
+	for (c = 0; c < channels; c++) {
+		dsp_fir_channel(data + c, sets, channels, fir->taps, tap_count,
+				&fir->line[c * 2U * tap_count], fir->pos);
+	}
+
+	/* Every channel's line moved back by one per sample set. */
+	fir->pos = (uint16_t)((fir->pos + tap_count - sets % tap_count) % tap_count);
+}
+
+#define DSP_FFT_MAX_POINTS (1U << AUDIO_DSP_FFT_MAX_ORDER)
+
+/*
+ * sin(2 pi i / DSP_FFT_MAX_POINTS) for the first quarter turn, in Q31, the
+ * endpoint included; a shorter transform reads every 2nd, 4th, ... entry. The
+ * other quarters follow by mirroring, as in the tone generator's table. The
+ * peak is INT32_MAX, one LSB short of 1.0, which Q31 cannot hold.
+ */
+static const int32_t dsp_fft_quarter_q31[DSP_FFT_MAX_POINTS / 4U + 1U] = {
+	0,          13176712,   26352928,   39528151,   52701887,   65873638,   79042909,
+	92209205,   105372028,  118530885,  131685278,  144834714,  157978697,  171116733,
+	184248325,  197372981,  210490206,  223599506,  236700388,  249792358,  262874923,
+	275947592,  289009871,  302061269,  315101295,  328129457,  341145265,  354148230,
+	367137861,  380113669,  393075166,  406021865,  418953276,  431868915,  444768294,
+	457650927,  470516330,  483364019,  496193509,  509004318,  521795963,  534567963,
+	547319836,  560051104,  572761285,  585449903,  598116479,  610760536,  623381598,
+	635979190,  648552838,  661102068,  673626408,  686125387,  698598533,  711045377,
+	723465451,  735858287,  748223418,  760560380,  772868706,  785147934,  797397602,
+	809617249,  821806413,  833964638,  846091463,  858186435,  870249095,  882278992,
+	894275671,  906238681,  918167572,  930061894,  941921200,  953745043,  965532978,
+	977284562,  988999351,  1000676905, 1012316784, 1023918550, 1035481766, 1047005996,
+	1058490808, 1069935768, 1081340445, 1092704411, 1104027237, 1115308496, 1126547765,
+	1137744621, 1148898640, 1160009405, 1171076495, 1182099496, 1193077991, 1204011567,
+	1214899813, 1225742318, 1236538675, 1247288478, 1257991320, 1268646800, 1279254516,
+	1289814068, 1300325060, 1310787095, 1321199781, 1331562723, 1341875533, 1352137822,
+	1362349204, 1372509294, 1382617710, 1392674072, 1402678000, 1412629117, 1422527051,
+	1432371426, 1442161874, 1451898025, 1461579514, 1471205974, 1480777044, 1490292364,
+	1499751576, 1509154322, 1518500250, 1527789007, 1537020244, 1546193612, 1555308768,
+	1564365367, 1573363068, 1582301533, 1591180426, 1599999411, 1608758157, 1617456335,
+	1626093616, 1634669676, 1643184191, 1651636841, 1660027308, 1668355276, 1676620432,
+	1684822463, 1692961062, 1701035922, 1709046739, 1716993211, 1724875040, 1732691928,
+	1740443581, 1748129707, 1755750017, 1763304224, 1770792044, 1778213194, 1785567396,
+	1792854372, 1800073849, 1807225553, 1814309216, 1821324572, 1828271356, 1835149306,
+	1841958164, 1848697674, 1855367581, 1861967634, 1868497586, 1874957189, 1881346202,
+	1887664383, 1893911494, 1900087301, 1906191570, 1912224073, 1918184581, 1924072871,
+	1929888720, 1935631910, 1941302225, 1946899451, 1952423377, 1957873796, 1963250501,
+	1968553292, 1973781967, 1978936331, 1984016189, 1989021350, 1993951625, 1998806829,
+	2003586779, 2008291295, 2012920201, 2017473321, 2021950484, 2026351522, 2030676269,
+	2034924562, 2039096241, 2043191150, 2047209133, 2051150040, 2055013723, 2058800036,
+	2062508835, 2066139983, 2069693342, 2073168777, 2076566160, 2079885360, 2083126254,
+	2086288720, 2089372638, 2092377892, 2095304370, 2098151960, 2100920556, 2103610054,
+	2106220352, 2108751352, 2111202959, 2113575080, 2115867626, 2118080511, 2120213651,
+	2122266967, 2124240380, 2126133817, 2127947206, 2129680480, 2131333572, 2132906420,
+	2134398966, 2135811153, 2137142927, 2138394240, 2139565043, 2140655293, 2141664948,
+	2142593971, 2143442326, 2144209982, 2144896910, 2145503083, 2146028480, 2146473080,
+	2146836866, 2147119825, 2147321946, 2147443222, 2147483647,
+};
+
+/*
+ * A stage whose inputs have a part this large halves its outputs. A butterfly
+ * at most doubles a modulus, so below it the outputs stay within
+ * 2 * sqrt(2) * 2^29 = 2^30.5; at or above it, halved, they stay within the
+ * inputs' modulus. Either way every part fits in 31 bits with room for the
+ * rounding.
+ */
+#define DSP_FFT_HEADROOM (1U << 29)
+
+/* A bound on |v| that costs no branch: |v| for v >= 0, |v| - 1 below. */
+static inline uint32_t dsp_fft_bits(int32_t v)
+{
+	return (uint32_t)(v ^ (v >> 31));
+}
+
+/* cos and sin of 2 pi @p i / DSP_FFT_MAX_POINTS, for i in [0, max / 2). */
+static inline void dsp_fft_twiddle(uint32_t i, int32_t *cos_q31, int32_t *sin_q31)
+{
+	const uint32_t quarter = DSP_FFT_MAX_POINTS / 4U;
+
+	if (i <= quarter) {
+		*cos_q31 = dsp_fft_quarter_q31[quarter - i];
+		*sin_q31 = dsp_fft_quarter_q31[i];
+	} else {
+		*cos_q31 = -dsp_fft_quarter_q31[i - quarter];
+		*sin_q31 = dsp_fft_quarter_q31[2U * quarter - i];
+	}
+}
+
+/* A Q31 product pair, rounded to nearest: (a * b + c * d) / 2^31. */
+static inline int32_t dsp_fft_mul(int32_t a, int32_t b, int32_t c, int32_t d)
+{
+	return (int32_t)(((int64_t)a * b + (int64_t)c * d + (INT64_C(1) << 30)) >> 31);
+}
+
+/* One butterfly output, halved and rounded to nearest when the stage scales. */
+static inline int32_t dsp_fft_out(int64_t sum, bool halve)
+{
+	return (int32_t)(halve ? (sum + 1) >> 1 : sum);
+}
+
+unsigned int audio_dsp_fft_q31(struct audio_dsp_complex *data, unsigned int order, bool inverse)
+{
+	const size_t points = (size_t)1 << order;
+	unsigned int scaled = 0U;
+	uint32_t bits = 0U;
+	size_t half;
+	size_t i;
+	size_t j;
+
+	/* Bit-reversed order, so the stages below run in place; the same pass
+	 * finds the bound the first stage scales by.
+	 */
+	for (i = 0, j = 0; i < points; i++) {
+		size_t mask = points >> 1;
+
+		if (i < j) {
+			struct audio_dsp_complex swap = data[i];
+
+			data[i] = data[j];
+			data[j] = swap;
+		}
+		bits |= dsp_fft_bits(data[i].re) | dsp_fft_bits(data[i].im);
+
+		while ((j & mask) != 0U) {
+			j ^= mask;
+			mask >>= 1;
+		}
+		j |= mask;
+	}
+
+	for (half = 1U; half < points; half <<= 1) {
+		const uint32_t stride = DSP_FFT_MAX_POINTS / (2U * half);
+		const bool halve = bits >= DSP_FFT_HEADROOM;
+		size_t k;
+
+		bits = 0U;
+		for (k = 0; k < half; k++) {
+			int32_t c;
+			int32_t s;
+
+			dsp_fft_twiddle(k * stride, &c, &s);
+			if (!inverse) {
+				s = -s;
+			}
+
+			for (j = k; j < points; j += 2U * half) {
+				struct audio_dsp_complex *a = &data[j];
+				struct audio_dsp_complex *b = &data[j + half];
+				int32_t t_re = b->re;
+				int32_t t_im = b->im;
+
+				/* W^0 is 1; Q31 would make it 1 - 2^-31. */
+				if (k != 0U) {
+					t_re = dsp_fft_mul(b->re, c, -b->im, s);
+					t_im = dsp_fft_mul(b->re, s, b->im, c);
+				}
+
+				b->re = dsp_fft_out((int64_t)a->re - t_re, halve);
+				b->im = dsp_fft_out((int64_t)a->im - t_im, halve);
+				a->re = dsp_fft_out((int64_t)a->re + t_re, halve);
+				a->im = dsp_fft_out((int64_t)a->im + t_im, halve);
+				bits |= dsp_fft_bits(a->re) | dsp_fft_bits(a->im) |
+					dsp_fft_bits(b->re) | dsp_fft_bits(b->im);
+			}
+		}
+
+		if (halve) {
+			scaled++;
+		}
+	}
+
+	return scaled;
+}
+
+/* Half a container, rounded to nearest: every part of a transform's input has
+ * to be within +-2^30.
+ */
+static inline int32_t dsp_fft_half(int32_t v)
+{
+	return (int32_t)(((int64_t)v + 1) >> 1);
+}
+
+/* q * 2^exp as a container, rounded to nearest and saturated. */
+static inline int32_t dsp_fft_scale(int32_t q, int exp)
+{
+	if (exp > 0) {
+		return dsp_sat32((int64_t)q * (INT64_C(1) << MIN(exp, 32)));
+	}
+	if (exp < 0) {
+		return exp < -32 ? 0 : (int32_t)(((int64_t)q + (INT64_C(1) << (-exp - 1))) >> -exp);
+	}
+
+	return q;
+}
+
+void audio_dsp_fir_fft_prepare(struct audio_dsp_fir_fft *fir)
+{
+	const size_t points = (size_t)1 << fir->order;
+	struct audio_dsp_complex *spectrum = fir->spectrum;
+	uint32_t bits = 0U;
+	int shift;
+	int exp;
+	size_t k;
+
+	for (k = 0; k < points; k++) {
+		spectrum[k].re = k < fir->tap_count ? dsp_fft_half(fir->taps[k]) : 0;
+		spectrum[k].im = 0;
+	}
+
+	/* Halved, and Q4.28: taps[k] = spectrum[k].re * 2^(1 - 28). */
+	exp = 1 - AUDIO_DSP_COEFF_FRAC_BITS + (int)audio_dsp_fft_q31(spectrum, fir->order, false);
+
+	/* Scaled so its largest part is in [2^29, 2^30): as precise as a Q31
+	 * transform gets, and small enough that a product with a block's
+	 * transform, also within 2^30.5, fits 64 bits and lands within 2^30.
+	 */
+	for (k = 0; k < points; k++) {
+		bits |= dsp_fft_bits(spectrum[k].re) | dsp_fft_bits(spectrum[k].im);
+	}
+	shift = bits == 0U ? 0 : 29 - (31 - __builtin_clz(bits));
+	for (k = 0; k < points; k++) {
+		spectrum[k].re = dsp_fft_scale(spectrum[k].re, shift);
+		spectrum[k].im = dsp_fft_scale(spectrum[k].im, shift);
+	}
+	fir->spectrum_exp = (int8_t)(exp - shift);
+
+	memset(fir->history, 0, sizeof(int32_t) * 2U * (fir->tap_count - 1U));
+}
+
+/* Up to 2^order - tap_count + 1 sample sets, one transform each way. */
+static void dsp_fir_fft_block(int32_t *data, size_t sets, struct audio_dsp_fir_fft *fir,
+			      size_t channels)
+{
+	const size_t points = (size_t)1 << fir->order;
+	const size_t keep = fir->tap_count - 1U;
+	const bool stereo = channels == 2U;
+	struct audio_dsp_complex *work = fir->work;
+	int32_t *left = fir->history;
+	int32_t *right = &fir->history[keep];
+	int exp;
+	size_t k;
+
+	/* The segment: the kept inputs, the new ones, then zeros. */
+	for (k = 0; k < keep; k++) {
+		work[k].re = dsp_fft_half(left[k]);
+		work[k].im = stereo ? dsp_fft_half(right[k]) : 0;
+	}
+	for (k = 0; k < sets; k++) {
+		work[keep + k].re = dsp_fft_half(data[k * channels]);
+		work[keep + k].im = stereo ? dsp_fft_half(data[k * channels + 1U]) : 0;
+	}
+	memset(&work[keep + sets], 0, sizeof(work[0]) * (points - keep - sets));
+
+	/* The next block keeps the last inputs of this segment. */
+	if (sets >= keep) {
+		for (k = 0; k < keep; k++) {
+			left[k] = data[(sets - keep + k) * channels];
+			right[k] = stereo ? data[(sets - keep + k) * channels + 1U] : 0;
+		}
+	} else {
+		memmove(left, &left[sets], sizeof(left[0]) * (keep - sets));
+		memmove(right, &right[sets], sizeof(right[0]) * (keep - sets));
+		for (k = 0; k < sets; k++) {
+			left[keep - sets + k] = data[k * channels];
+			right[keep - sets + k] = stereo ? data[k * channels + 1U] : 0;
+		}
+	}
+
+	exp = 1 + (int)audio_dsp_fft_q31(work, fir->order, false);
+
+	for (k = 0; k < points; k++) {
+		const struct audio_dsp_complex x = work[k];
+		const struct audio_dsp_complex h = fir->spectrum[k];
+
+		work[k].re = dsp_fft_mul(x.re, h.re, -x.im, h.im);
+		work[k].im = dsp_fft_mul(x.re, h.im, x.im, h.re);
+	}
+	exp += fir->spectrum_exp + 31;
+
+	/* The inverse leaves out its 1 / 2^order. */
+	exp += (int)audio_dsp_fft_q31(work, fir->order, true) - (int)fir->order;
+
+	for (k = 0; k < sets; k++) {
+		data[k * channels] = dsp_fft_scale(work[keep + k].re, exp);
+		if (stereo) {
+			data[k * channels + 1U] = dsp_fft_scale(work[keep + k].im, exp);
+		}
+	}
+}
+
+void audio_dsp_fir_fft_q31(int32_t *data, size_t count, struct audio_dsp_fir_fft *fir,
+			   size_t channels)
+{
+	const size_t block = ((size_t)1 << fir->order) - (fir->tap_count - 1U);
+	size_t sets;
+	size_t done;
+
+	if (channels == 0U || channels > 2U) {
+		return;
+	}
+
+	sets = count / channels;
+	for (done = 0; done < sets; done += block) {
+		dsp_fir_fft_block(&data[done * channels], MIN(block, sets - done), fir, channels);
+	}
+}
+
+static uint32_t dsp_gcd(uint32_t a, uint32_t b)
+{
+	while (b != 0U) {
+		uint32_t r = a % b;
+
+		a = b;
+		b = r;
+	}
+
+	return a;
+}
+
+void audio_dsp_resampler_prepare(struct audio_dsp_resampler *rs, uint32_t in_rate_hz,
+				 uint32_t out_rate_hz)
+{
+	const uint32_t gcd = dsp_gcd(in_rate_hz, out_rate_hz);
+	const uint64_t period = (uint64_t)rs->phases << 16;
+	const uint64_t span = (uint64_t)rs->zero_crossings * period;
+
+	rs->in_rate = in_rate_hz / gcd;
+	rs->out_rate = out_rate_hz / gcd;
+
+	/* One input period in wing units: the whole period, or the ratio of it
+	 * when decimating, which is what stretches the prototype.
+	 */
+	if (rs->in_rate > rs->out_rate) {
+		rs->tap_step = (uint32_t)(period * rs->out_rate / rs->in_rate);
+		rs->gain = (int32_t)((((uint64_t)rs->out_rate << 31) / rs->in_rate + 1U) >> 1);
+	} else {
+		rs->tap_step = (uint32_t)period;
+		rs->gain = INT32_C(1) << 30;
+	}
+	rs->reach = (uint16_t)((span + rs->tap_step - 1U) / rs->tap_step);
+
+	rs->frac = 0U;
+	rs->phase = 0U;
+	rs->phase_rem = 0U;
+}
+
+/* The wing at Q16 index @p pos, interpolated. */
+static inline int32_t dsp_resample_tap(const int32_t *wing, uint32_t pos)
+{
+	const uint32_t i = pos >> 16;
+	const int64_t delta = (int64_t)wing[i + 1U] - wing[i];
+
+	return wing[i] + (int32_t)((delta * (int64_t)(pos & 0xffffU)) >> 16);
+}
+
+/* @p h scaled by a Q30 gain, rounded to nearest. */
+static inline int32_t dsp_resample_gain(int32_t h, int32_t gain)
+{
+	return (int32_t)(((int64_t)h * gain + (INT64_C(1) << 29)) >> 30);
+}
+
+/* Both wings for the current phase into rs->coeffs, oldest input first.
+ * Returns how many there are, and the left wing's share in @p left.
+ */
+static size_t dsp_resample_coeffs(const struct audio_dsp_resampler *rs, size_t *left)
+{
+	const uint32_t end = ((uint32_t)rs->zero_crossings * rs->phases) << 16;
+	const uint32_t step = rs->tap_step;
+	int32_t *coeffs = rs->coeffs;
+	uint32_t pos;
+	size_t nl;
+	size_t nr;
+	size_t m;
+
+	pos = rs->phase;
+	nl = (end - pos + step - 1U) / step;
+	for (m = 0; m < nl; m++, pos += step) {
+		coeffs[nl - 1U - m] = dsp_resample_tap(rs->wing, pos);
+	}
+
+	pos = step - rs->phase;
+	nr = pos < end ? (end - pos + step - 1U) / step : 0U;
+	for (m = 0; m < nr; m++, pos += step) {
+		coeffs[nl + m] = dsp_resample_tap(rs->wing, pos);
+	}
+
+	/* A gain of 1 is a multiply per tap for nothing: it only applies when
+	 * decimating.
+	 */
+	if (rs->gain != (INT32_C(1) << 30)) {
+		for (m = 0; m < nl + nr; m++) {
+			coeffs[m] = dsp_resample_gain(coeffs[m], rs->gain);
+		}
+	}
+
+	*left = nl;
+
+	return nl + nr;
+}
+
+size_t audio_dsp_resample_q31(int32_t *out, size_t out_count, const int32_t *in,
+			      size_t in_count, size_t *consumed, struct audio_dsp_resampler *rs,
+			      size_t channels)
+{
+	const uint32_t denom = MAX(rs->in_rate, rs->out_rate);
+	const uint64_t period = (uint64_t)rs->phases << 16;
+	/* frac moves by in_rate per output and by -out_rate per input set; the
+	 * phase by the same in wing units, as a quotient and a remainder.
+	 */
+	const uint32_t advance = (uint32_t)(period * rs->in_rate / denom);
+	const uint32_t advance_rem = (uint32_t)(period * rs->in_rate % denom);
+	const uint32_t retreat = (uint32_t)(period * rs->out_rate / denom);
+	const uint32_t retreat_rem = (uint32_t)(period * rs->out_rate % denom);
+	size_t in_sets;
+	size_t out_sets;
+	size_t n = rs->reach - 1U;
+	size_t i;
+
+	if (channels == 0U) {
+		*consumed = 0;
+		return 0;
+	}
+
+	in_sets = in_count / channels;
+	out_sets = out_count / channels;
+
+	for (i = 0; i < out_sets && n + rs->reach < in_sets; i++) {
+		const int32_t *x;
+		size_t taps;
+		size_t left;
+		size_t c;
+		size_t k;
+
+		taps = dsp_resample_coeffs(rs, &left);
+		x = &in[(n + 1U - left) * channels];
+
+		if (channels == 2U) {
+			int64_t acc_l = DSP_COEFF_ROUND;
+			int64_t acc_r = DSP_COEFF_ROUND;
+
+			for (k = 0; k < taps; k++) {
+				acc_l += (int64_t)rs->coeffs[k] * x[2U * k];
+				acc_r += (int64_t)rs->coeffs[k] * x[2U * k + 1U];
+			}
+
+			out[2U * i] = dsp_sat32(acc_l >> AUDIO_DSP_COEFF_FRAC_BITS);
+			out[2U * i + 1U] = dsp_sat32(acc_r >> AUDIO_DSP_COEFF_FRAC_BITS);
+		} else {
+			for (c = 0; c < channels; c++) {
+				int64_t acc = DSP_COEFF_ROUND;
+
+				for (k = 0; k < taps; k++) {
+					acc += (int64_t)rs->coeffs[k] * x[k * channels + c];
+				}
+
+				out[i * channels + c] =
+					dsp_sat32(acc >> AUDIO_DSP_COEFF_FRAC_BITS);
+			}
+		}
+
+		rs->frac += rs->in_rate;
+		rs->phase += advance;
+		rs->phase_rem += advance_rem;
+		if (rs->phase_rem >= denom) {
+			rs->phase_rem -= denom;
+			rs->phase++;
+		}
+
+		while (rs->frac >= rs->out_rate) {
+			rs->frac -= rs->out_rate;
+			n++;
+			rs->phase -= retreat;
+			if (rs->phase_rem < retreat_rem) {
+				rs->phase_rem += denom;
+				rs->phase--;
+			}
+			rs->phase_rem -= retreat_rem;
+		}
+	}
+
+	*consumed = (n + 1U - rs->reach) * channels;
+
+	return i * channels;
+}
+
+/*
+ * The PCM kernels. Bytes go through sys_get_le*() and sys_put_le*() whatever
+ * the host, which a little-endian target compiles to plain loads and stores;
+ * 32-bit integer samples there are the container's own bytes already, and
+ * cost a copy at most.
+ *
+ * Packed 24-bit samples have no load of their own, and one at a time they are
+ * three byte loads and the shifts to join them. Four of them are three whole
+ * words, though, so the loop body moves four samples as three word loads or
+ * stores and a few shifts and masks, and the odd samples past the last group
+ * go one at a time.
+ *
+ * The float pair decodes and encodes the IEEE 754 single-precision layout in
+ * integer arithmetic - a 24-bit mantissa with its implicit bit, an exponent
+ * biased by 127 - so the rounding is written out rather than left to an FPU.
+ */
+
+/* Fraction bits of a float, its implicit leading bit, and the exponent of 1.0. */
+#define DSP_F32_MANT_BITS 23U
+#define DSP_F32_IMPLICIT  (1U << DSP_F32_MANT_BITS)
+#define DSP_F32_MANT_MASK (DSP_F32_IMPLICIT - 1U)
+#define DSP_F32_EXP_ONE   127U
+#define DSP_F32_EXP_MAX   0xffU
+
+static inline int32_t dsp_f32_bits_to_s32(uint32_t bits)
+{
+	const uint32_t exp = (bits >> DSP_F32_MANT_BITS) & DSP_F32_EXP_MAX;
+	const uint32_t mant = (bits & DSP_F32_MANT_MASK) | DSP_F32_IMPLICIT;
+	uint32_t mag;
+
+	/* |x| >= 1 scales to 2^31 or beyond: saturated, as are infinities. */
+	if (exp >= DSP_F32_EXP_ONE) {
+		if (exp == DSP_F32_EXP_MAX && (bits & DSP_F32_MANT_MASK) != 0U) {
+			return 0;
+		}
+		return (bits >> 31) != 0U ? INT32_MIN : INT32_MAX;
+	}
+
+	/* |x| * 2^31 is mant * 2^(exp - 119): at most 2^31 - 2^7 from above,
+	 * and below one half - rounded to 0 - once exp is under 95, denormals
+	 * included.
+	 */
+	if (exp >= DSP_F32_EXP_ONE - 8U) {
+		mag = mant << (exp - (DSP_F32_EXP_ONE - 8U));
+	} else if (exp >= DSP_F32_EXP_ONE - 32U) {
+		const uint32_t drop = (DSP_F32_EXP_ONE - 8U) - exp;
+
+		/* Adding half and truncating the magnitude: ties away from 0. */
+		mag = (mant + (1U << (drop - 1U))) >> drop;
+	} else {
+		mag = 0U;
+	}
+
+	return (bits >> 31) != 0U ? -(int32_t)mag : (int32_t)mag;
+}
+
+static inline uint32_t dsp_s32_to_f32_bits(int32_t sample)
+{
+	const uint32_t sign = (uint32_t)sample & 0x80000000U;
+	const uint32_t mag = sign != 0U ? 0U - (uint32_t)sample : (uint32_t)sample;
+	uint32_t top;
+	uint32_t mant;
+
+	if (mag == 0U) {
+		return 0U;
+	}
+
+	top = 31U - (uint32_t)__builtin_clz(mag);
+	if (top <= DSP_F32_MANT_BITS) {
+		mant = mag << (DSP_F32_MANT_BITS - top);
+	} else {
+		const uint32_t drop = top - DSP_F32_MANT_BITS;
+		const uint32_t rest = mag & ((1U << drop) - 1U);
+		const uint32_t half = 1U << (drop - 1U);
+
+		mant = mag >> drop;
+		if (rest > half || (rest == half && (mant & 1U) != 0U)) {
+			mant++;
+		}
+	}
+
+	/* mag / 2^31 has the exponent top - 31. A mantissa the rounding carried
+	 * to 2^24 carries into the exponent field by itself.
+	 */
+	return sign | (((top + DSP_F32_EXP_ONE - 31U) << DSP_F32_MANT_BITS) +
+		       (mant - DSP_F32_IMPLICIT));
+}
+
+void audio_dsp_unpack_u8(int32_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = count;
+
+	/* Flipping the top bit turns offset binary into two's complement. */
+	while (i-- > 0U) {
+		dst[i] = (int32_t)(((uint32_t)src[i] ^ 0x80U) << 24);
+	}
+}
+
+void audio_dsp_unpack_s16(int32_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = count;
+
+	while (i-- > 0U) {
+		dst[i] = (int32_t)((uint32_t)sys_get_le16(&src[2U * i]) << 16);
+	}
+}
+
+void audio_dsp_unpack_s24(int32_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = count;
+
+	/* Back to front, so the odd samples at the end come first. */
+	while (i % 4U != 0U) {
+		i--;
+		dst[i] = (int32_t)(sys_get_le24(&src[3U * i]) << 8);
+	}
+
+	while (i > 0U) {
+		const uint8_t *p;
+		uint32_t w0;
+		uint32_t w1;
+		uint32_t w2;
+
+		i -= 4U;
+		p = &src[3U * i];
+
+		/* All three words are read before the first container is
+		 * written over them.
+		 */
+		w0 = sys_get_le32(p);
+		w1 = sys_get_le32(p + 4U);
+		w2 = sys_get_le32(p + 8U);
+
+		dst[i] = (int32_t)(w0 << 8);
+		dst[i + 1U] = (int32_t)(((w0 >> 16) & 0xff00U) | (w1 << 16));
+		dst[i + 2U] = (int32_t)(((w1 >> 8) & 0xffff00U) | (w2 << 24));
+		dst[i + 3U] = (int32_t)(w2 & 0xffffff00U);
+	}
+}
+
+void audio_dsp_unpack_s32(int32_t *dst, const uint8_t *src, size_t count)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if ((const void *)dst != (const void *)src) {
+		memcpy(dst, src, count * sizeof(int32_t));
+	}
+#else
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		dst[i] = (int32_t)sys_get_le32(&src[4U * i]);
+	}
+#endif
+}
+
+void audio_dsp_unpack_f32(int32_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i;
+
+	/* Four bytes in, four out: front to back is as safe in place. */
+	for (i = 0; i < count; i++) {
+		dst[i] = dsp_f32_bits_to_s32(sys_get_le32(&src[4U * i]));
+	}
+}
+
+void audio_dsp_pack_u8(uint8_t *dst, const int32_t *src, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		dst[i] = (uint8_t)(((uint32_t)src[i] >> 24) ^ 0x80U);
+	}
+}
+
+void audio_dsp_pack_s16(uint8_t *dst, const int32_t *src, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		sys_put_le16((uint16_t)((uint32_t)src[i] >> 16), &dst[2U * i]);
+	}
+}
+
+void audio_dsp_pack_s24(uint8_t *dst, const int32_t *src, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i + 4U <= count; i += 4U) {
+		/* All four containers are read before the words go out over
+		 * them.
+		 */
+		const uint32_t c0 = (uint32_t)src[i];
+		const uint32_t c1 = (uint32_t)src[i + 1U];
+		const uint32_t c2 = (uint32_t)src[i + 2U];
+		const uint32_t c3 = (uint32_t)src[i + 3U];
+		uint8_t *p = &dst[3U * i];
+
+		sys_put_le32((c0 >> 8) | ((c1 << 16) & 0xff000000U), p);
+		sys_put_le32((c1 >> 16) | ((c2 << 8) & 0xffff0000U), p + 4U);
+		sys_put_le32((c2 >> 24) | (c3 & 0xffffff00U), p + 8U);
+	}
+
+	for (; i < count; i++) {
+		sys_put_le24((uint32_t)src[i] >> 8, &dst[3U * i]);
+	}
+}
+
+void audio_dsp_pack_s32(uint8_t *dst, const int32_t *src, size_t count)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if ((const void *)dst != (const void *)src) {
+		memcpy(dst, src, count * sizeof(int32_t));
+	}
+#else
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		sys_put_le32((uint32_t)src[i], &dst[4U * i]);
+	}
+#endif
+}
+
+void audio_dsp_pack_f32(uint8_t *dst, const int32_t *src, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		sys_put_le32(dsp_s32_to_f32_bits(src[i]), &dst[4U * i]);
+	}
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+/*
+ * The floating-point kernels. On a Cortex-M7 or M33 the FPU is a scalar one,
+ * so what the conversions get there is an instruction each rather than lanes:
+ * the compiler turns the scaled int-to-float into a VCVT and a multiply by a
+ * power of two, and an FPv5 FPU's VCVTA rounds to nearest with ties away,
+ * saturates and sends a NaN to 0 in one go, which is the definition exactly.
+ * Elsewhere the float-to-int is the portable loop below, with the clamp done
+ * before the conversion, where C leaves an out-of-range one undefined. A NEON
+ * target takes the int-to-float four lanes at a time.
+ *
+ * The gain and the biquad are the same C everywhere, the biquad's stereo
+ * channels side by side in one loop as for the Q31 one.
+ */
+
+/* 2^31: full scale of a container, as a float. Exact. */
+#define DSP_F32_FULL_SCALE 2147483648.0f
+
+#ifdef AUDIO_DSP_VECTOR
+typedef float dsp_v4f32 __attribute__((vector_size(AUDIO_DSP_LANES * sizeof(float))));
+#endif
+
+static inline int32_t dsp_f32_to_s32(float x)
+{
+	const float s = x * DSP_F32_FULL_SCALE;
+#if defined(__arm__) && defined(__ARM_FEATURE_DIRECTED_ROUNDING) && defined(__ARM_FP) &&        \
+	(__ARM_FP & 4)
+	int32_t out;
+	float bits;
+
+	__asm__("vcvta.s32.f32 %0, %1" : "=t"(bits) : "t"(s));
+	memcpy(&out, &bits, sizeof(out));
+
+	return out;
+#else
+	float rest;
+	int32_t t;
+
+	/* Written so that a NaN fails the first compare. */
+	if (!(s < DSP_F32_FULL_SCALE)) {
+		return (s == s) ? INT32_MAX : 0;
+	}
+	if (s <= -DSP_F32_FULL_SCALE) {
+		return INT32_MIN;
+	}
+
+	/* Truncated, then corrected: s - t is exact, t being s's integer part. */
+	t = (int32_t)s;
+	rest = s - (float)t;
+	if (rest >= 0.5f) {
+		t++;
+	} else if (rest <= -0.5f) {
+		t--;
+	}
+
+	return t;
+#endif
+}
+
+void audio_dsp_s32_to_f32(float *dst, const int32_t *src, size_t count)
+{
+	const float unit = 1.0f / DSP_F32_FULL_SCALE;
+	size_t i = 0;
+
+#ifdef AUDIO_DSP_VECTOR
+	for (; i + AUDIO_DSP_LANES <= count; i += AUDIO_DSP_LANES) {
+		dsp_v4i32 value;
+		dsp_v4f32 out;
+
+		dsp_v_load(&value, &src[i]);
+		out = __builtin_convertvector(value, dsp_v4f32) * unit;
+		memcpy(&dst[i], &out, sizeof(out));
+	}
+#endif
+
+	for (; i < count; i++) {
+		dst[i] = (float)src[i] * unit;
+	}
+}
+
+void audio_dsp_f32_to_s32(int32_t *dst, const float *src, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		dst[i] = dsp_f32_to_s32(src[i]);
+	}
+}
+
+void audio_dsp_gain_f32(float *dst, const float *src, size_t count, const float *gains,
+			size_t channels)
+{
+	size_t i = 0;
+	size_t c;
+
+	if (channels == 0U) {
+		return;
+	}
+
+	if (channels == 1U) {
+		const float gain = gains[0];
+
+		for (; i < count; i++) {
+			dst[i] = src[i] * gain;
+		}
+		return;
+	}
+
+	if (channels == 2U) {
+		const float left = gains[0];
+		const float right = gains[1];
+
+		for (; i + 2U <= count; i += 2U) {
+			dst[i] = src[i] * left;
+			dst[i + 1U] = src[i + 1U] * right;
+		}
+	}
+
+	for (c = i % channels; i < count; i++) {
+		dst[i] = src[i] * gains[c];
+		if (++c == channels) {
+			c = 0;
+		}
+	}
+}
+
+void audio_dsp_biquad_to_f32(const struct audio_dsp_biquad *stage,
+			     struct audio_dsp_biquad_f32 *out)
+{
+	const float unit = 1.0f / (float)(INT32_C(1) << AUDIO_DSP_COEFF_FRAC_BITS);
+
+	out->b0 = (float)stage->b0 * unit;
+	out->b1 = (float)stage->b1 * unit;
+	out->b2 = (float)stage->b2 * unit;
+	out->a1 = (float)stage->a1 * unit;
+	out->a2 = (float)stage->a2 * unit;
+}
+
+static ALWAYS_INLINE float dsp_biquad_f32_out(const struct audio_dsp_biquad_f32 *c, float x,
+					      struct audio_dsp_biquad_f32_history *h)
+{
+	const float y = c->b0 * x + h->s1;
+
+	h->s1 = c->b1 * x - c->a1 * y + h->s2;
+	h->s2 = c->b2 * x - c->a2 * y;
+
+	return y;
+}
+
+/* One channel, every @p stride samples, with everything in locals. */
+static void dsp_biquad_f32_channel(float *data, size_t sets, size_t stride,
+				   const struct audio_dsp_biquad_f32 *stage,
+				   struct audio_dsp_biquad_f32_history *history)
+{
+	const struct audio_dsp_biquad_f32 c = *stage;
+	struct audio_dsp_biquad_f32_history h = *history;
+	size_t i;
+
+	for (i = 0; i < sets; i++, data += stride) {
+		*data = dsp_biquad_f32_out(&c, *data, &h);
+	}
+
+	*history = h;
+}
+
+static void dsp_biquad_f32_stereo(float *data, size_t sets,
+				  const struct audio_dsp_biquad_f32 *stage,
+				  struct audio_dsp_biquad_f32_history *history)
+{
+	const struct audio_dsp_biquad_f32 c = *stage;
+	struct audio_dsp_biquad_f32_history left = history[0];
+	struct audio_dsp_biquad_f32_history right = history[1];
+	size_t i;
+
+	for (i = 0; i < sets; i++, data += 2) {
+		data[0] = dsp_biquad_f32_out(&c, data[0], &left);
+		data[1] = dsp_biquad_f32_out(&c, data[1], &right);
+	}
+
+	history[0] = left;
+	history[1] = right;
+}
+
+void audio_dsp_biquad_f32(float *data, size_t count, const struct audio_dsp_biquad_f32 *stage,
+			  struct audio_dsp_biquad_f32_history *history, size_t channels)
+{
+	size_t c;
+
+	if (channels == 0U) {
+		return;
+	}
+
+	if (channels == 2U) {
+		dsp_biquad_f32_stereo(data, count / 2U, stage, history);
+		return;
+	}
+
+	for (c = 0; c < channels; c++) {
+		dsp_biquad_f32_channel(data + c, count / channels, channels, stage, &history[c]);
+	}
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FLOAT */
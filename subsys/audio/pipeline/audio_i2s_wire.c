@@ -61,6 +61,9 @@ int audio_i2s_wire_from_container(uint8_t valid_bits_per_sample, const int32_t *
 		return -EINVAL;
 	}
 
+	/* Front to back, which is what lets @p wire be @p samples itself: word
+	 * i lands in bytes 2i and 2i + 1, inside samples already read.
+	 */
 	for (i = 0; i < count; i++) {
 		/* Shifted in the unsigned domain and stored as raw bytes, so the
 		 * conversion has no implementation defined behaviour at all: the
@@ -95,7 +98,11 @@ int audio_i2s_wire_to_container(uint8_t valid_bits_per_sample, const uint8_t *wi
 		return -EINVAL;
 	}
 
-	for (i = 0; i < count; i++) {
+	/* Back to front, the mirror of the narrowing above: sample i covers
+	 * words 2i and 2i + 1, which have been read by the time it is stored,
+	 * so @p samples may be @p wire itself.
+	 */
+	for (i = count; i-- > 0;) {
 		int16_t word = (int16_t)sys_get_le16(&wire[i * I2S_WIRE_BYTES_PER_WORD]);
 
 		/* Shifted as unsigned on purpose: left-shifting a negative
@@ -1,8 +1,11 @@
 #ifndef ZEPHYR_AUDIO_INTERNAL_H_
 #define ZEPHYR_AUDIO_INTERNAL_H_
 
+#include <errno.h>
+
 #include <zephyr/kernel.h>
 #include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
 
 #include <zephyr/audio/audio_pipeline.h>
 
@@ -73,6 +76,350 @@ audio_pipeline_state_get(const struct audio_pipeline *pipeline)
  */
 int audio_eof_safe_errno(int err);
 
+/*
+ * Open the chain from @p first upwards, sink first, installing @p format and
+ * @p frame_capacity on every node right before its open() (spec §5.2). Above a
+ * converter both are the segment's: the format it declared and the capacity
+ * derived from it. On failure everything opened so far is closed again and the
+ * error is returned.
+ *
+ * The pipeline opens its own chain with this, and a tee or mixer node each
+ * chain it drives, so all of them bind formats and unwind failures the same
+ * way.
+ */
+int audio_node_chain_open(struct audio_node *first, const struct audio_stream_config *format,
+			  size_t frame_capacity);
+
+/*
+ * Close the chain from @p first up to (excluding) @p end, walking upstream.
+ * Passing NULL as @p end closes the whole chain. Returns the first error but
+ * always visits every node, so a failing close() cannot leak the rest.
+ */
+int audio_node_chain_close(struct audio_node *first, struct audio_node *end);
+
+/*
+ * audio_pipeline_process_frame() with the produced sample count handed back,
+ * which the worker needs to pace the next frame. Same return values.
+ */
+int audio_pipeline_pull_frame(struct audio_pipeline *pipeline, size_t *produced);
+
+/*
+ * Real-time pacing (spec §3.2), implemented in audio_pipeline_pacing.c.
+ *
+ * The worker asks audio_pipeline_pace_release() before every frame: true means
+ * the frame is due and may be pulled; false means the pacing timer has been
+ * armed for the frame's release time and the worker should wait on
+ * @c audio_pipeline.wake and then ask again. audio_pipeline_pace_complete()
+ * accounts the sample sets a pulled frame produced, and
+ * audio_pipeline_pace_reset() forgets the run whenever the worker stops
+ * pulling, so the next play() starts a fresh timeline instead of bursting to
+ * catch up with the time it spent idle.
+ *
+ * Without CONFIG_AUDIO_PIPELINE_PACED every instance is unpaced and these
+ * compile away.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_PACED
+/* An instance on an executor is always paced: its frame period is what the
+ * executor orders dispatch by.
+ */
+static inline bool audio_pipeline_is_paced(const struct audio_pipeline *pipeline)
+{
+	return pipeline->config != NULL &&
+	       (pipeline->config->paced || pipeline->config->executor != NULL);
+}
+
+void audio_pipeline_pace_init(struct audio_pipeline *pipeline);
+void audio_pipeline_pace_reset(struct audio_pipeline *pipeline);
+void audio_pipeline_pace_cancel(struct audio_pipeline *pipeline);
+bool audio_pipeline_pace_release(struct audio_pipeline *pipeline);
+void audio_pipeline_pace_complete(struct audio_pipeline *pipeline, size_t produced);
+
+/*
+ * Release tick and deadline tick of @p pipeline's next frame, anchoring a new
+ * timeline at @p now if the current run has none yet. What the executor orders
+ * its dispatch by; audio_pipeline_pace_release() is built on it.
+ */
+void audio_pipeline_pace_window(struct audio_pipeline *pipeline, int64_t now, int64_t *release,
+				int64_t *deadline);
+#else
+static inline bool audio_pipeline_is_paced(const struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return false;
+}
+
+static inline void audio_pipeline_pace_init(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_pipeline_pace_reset(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_pipeline_pace_cancel(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline bool audio_pipeline_pace_release(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return true;
+}
+
+static inline void audio_pipeline_pace_complete(struct audio_pipeline *pipeline,
+						size_t produced)
+{
+	ARG_UNUSED(pipeline);
+	ARG_UNUSED(produced);
+}
+#endif /* CONFIG_AUDIO_PIPELINE_PACED */
+
+/*
+ * Pull one frame and react to it the way the worker does: end of stream stops
+ * the pulling and publishes EOF, a node error takes the chain down and
+ * publishes ERROR, and a frame of a paced instance is accounted on its
+ * timeline. Shared by the per-pipeline worker thread and the executor pool.
+ *
+ * A frame join() cancelled before it reached the nodes (-ECANCELED) is none of
+ * these and is passed through untouched.
+ *
+ * @return what audio_pipeline_process_frame() returned
+ */
+int audio_pipeline_run_frame(struct audio_pipeline *pipeline);
+
+/*
+ * Executor registration (spec §3.4), implemented in
+ * audio_pipeline_executor.c. attach() takes the place of creating a worker
+ * thread, detach() that of joining it - it waits for a frame in flight - and
+ * kick() that of releasing the idle semaphore.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_EXECUTOR
+static inline bool audio_pipeline_has_executor(const struct audio_pipeline *pipeline)
+{
+	return pipeline->config != NULL && pipeline->config->executor != NULL;
+}
+
+int audio_pipeline_executor_attach(struct audio_pipeline *pipeline);
+void audio_pipeline_executor_detach(struct audio_pipeline *pipeline);
+void audio_pipeline_executor_kick(struct audio_pipeline *pipeline);
+#else
+static inline bool audio_pipeline_has_executor(const struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return false;
+}
+
+static inline int audio_pipeline_executor_attach(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return -ENOTSUP;
+}
+
+static inline void audio_pipeline_executor_detach(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_pipeline_executor_kick(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+#endif /* CONFIG_AUDIO_PIPELINE_EXECUTOR */
+
+/*
+ * Two-stage pipelines (spec §3.5), implemented in audio_pipeline_ring.c.
+ *
+ * wire() puts the ring node between the split node and the consumer node below
+ * it before the chain is first opened, and unwire() restores the application's
+ * wiring once join() has closed it. start() creates the producer thread next to
+ * the worker, play() releases a parked producer, and join() ends the producer
+ * before the worker - it also frees a worker waiting on the ring.
+ *
+ * The worker brackets every consumer frame with acquire() and release():
+ * acquire() waits for the producer stage to fill the next slot and hands it out
+ * as the frame buffer, so the consumer stage works on the slot in place, and
+ * release() gives the slots the frame used back to the producer.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_RING
+static inline bool audio_pipeline_has_ring(const struct audio_pipeline *pipeline)
+{
+	return pipeline->config != NULL && pipeline->config->split != NULL;
+}
+
+/* True if the instance was defined with ring storage. */
+static inline bool audio_pipeline_ring_is_defined(const struct audio_pipeline *pipeline)
+{
+	return pipeline->ring.depth >= 2U;
+}
+
+int audio_pipeline_ring_wire(struct audio_pipeline *pipeline);
+void audio_pipeline_ring_unwire(struct audio_pipeline *pipeline);
+void audio_pipeline_ring_start(struct audio_pipeline *pipeline);
+void audio_pipeline_ring_play(struct audio_pipeline *pipeline);
+void audio_pipeline_ring_join(struct audio_pipeline *pipeline);
+
+/*
+ * @retval 0 @p data is the filled slot the frame is to be pulled into
+ * @retval -ECANCELED audio_pipeline_join() ended the wait
+ */
+int audio_pipeline_ring_acquire(struct audio_pipeline *pipeline, int32_t **data);
+void audio_pipeline_ring_release(struct audio_pipeline *pipeline);
+#else
+static inline bool audio_pipeline_has_ring(const struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return false;
+}
+
+static inline bool audio_pipeline_ring_is_defined(const struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return false;
+}
+
+static inline int audio_pipeline_ring_wire(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+	return -ENOTSUP;
+}
+
+static inline void audio_pipeline_ring_unwire(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_pipeline_ring_start(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_pipeline_ring_play(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_pipeline_ring_join(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline int audio_pipeline_ring_acquire(struct audio_pipeline *pipeline, int32_t **data)
+{
+	*data = pipeline->frame_buf;
+	return 0;
+}
+
+static inline void audio_pipeline_ring_release(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+#endif /* CONFIG_AUDIO_PIPELINE_RING */
+
+/*
+ * Real-time headroom (spec §8.5), implemented in audio_pipeline_load.c.
+ *
+ * audio_pipeline_run_frame() reads the run time of the thread pulling the
+ * frame with begin() before the pull and hands it to account() after, along
+ * with the samples the frame produced; reset() starts every run from nothing.
+ * A window that fills up publishes its load and raises the overload event
+ * when it crosses the configured threshold.
+ *
+ * Without CONFIG_AUDIO_PIPELINE_LOAD_MONITOR these compile away.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_LOAD_MONITOR
+void audio_pipeline_load_reset(struct audio_pipeline *pipeline);
+uint64_t audio_pipeline_load_begin(void);
+void audio_pipeline_load_account(struct audio_pipeline *pipeline, uint64_t begin,
+				 size_t produced);
+#else
+static inline void audio_pipeline_load_reset(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline uint64_t audio_pipeline_load_begin(void)
+{
+	return 0U;
+}
+
+static inline void audio_pipeline_load_account(struct audio_pipeline *pipeline, uint64_t begin,
+					       size_t produced)
+{
+	ARG_UNUSED(pipeline);
+	ARG_UNUSED(begin);
+	ARG_UNUSED(produced);
+}
+#endif /* CONFIG_AUDIO_PIPELINE_LOAD_MONITOR */
+
+/*
+ * audio_node_process() on behalf of @p caller, the node whose own process()
+ * call pulls @p node - NULL when the pipeline or the producer stage does.
+ *
+ * With CONFIG_AUDIO_PIPELINE_PROFILING the call is timed, and its cycles are
+ * booked as @p node's inclusive figure and charged to @p caller as nested, so
+ * that @p caller's exclusive figure leaves them out (spec §8.4). Without, it
+ * is audio_node_process(). audio_node_pull_from() goes through here, and so
+ * does any node that drives another chain's sink, such as the tee.
+ */
+int audio_node_process_nested(struct audio_node *caller, struct audio_node *node,
+			      struct audio_buffer_view *buf, size_t *out_size);
+
+/*
+ * Cycle profiling (spec §8.4), implemented in audio_pipeline_profile.c.
+ *
+ * node() and frame() book one process() call and one frame; the readers and
+ * resets behind audio_node_get_stats() and audio_pipeline_get_stats() take the
+ * same lock, so a snapshot never has a total ahead of its count. start()
+ * computes the frame budget, resets the profile of the freshly opened chain
+ * and lists the instance for the shell; join() takes it off the list again,
+ * because an instance may go out of scope once it is joined.
+ *
+ * Without CONFIG_AUDIO_PIPELINE_PROFILING these compile away.
+ */
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+void audio_profile_node(struct audio_node *node, uint32_t inclusive, uint32_t exclusive);
+void audio_profile_frame(struct audio_pipeline *pipeline, uint32_t cycles);
+void audio_profile_node_read(const struct audio_node *node, struct audio_node_stats *stats);
+void audio_profile_node_reset(struct audio_node *node);
+void audio_profile_frame_read(const struct audio_pipeline *pipeline,
+			      struct audio_pipeline_stats *stats);
+void audio_profile_frame_reset(struct audio_pipeline *pipeline);
+void audio_profile_start(struct audio_pipeline *pipeline);
+void audio_profile_join(struct audio_pipeline *pipeline);
+
+/* Call @p cb for every started pipeline, with the list locked. */
+void audio_profile_foreach(void (*cb)(struct audio_pipeline *pipeline, void *user), void *user);
+
+static inline uint32_t audio_profile_now(void)
+{
+	return k_cycle_get_32();
+}
+#else
+static inline void audio_profile_frame(struct audio_pipeline *pipeline, uint32_t cycles)
+{
+	ARG_UNUSED(pipeline);
+	ARG_UNUSED(cycles);
+}
+
+static inline void audio_profile_start(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline void audio_profile_join(struct audio_pipeline *pipeline)
+{
+	ARG_UNUSED(pipeline);
+}
+
+static inline uint32_t audio_profile_now(void)
+{
+	return 0U;
+}
+#endif /* CONFIG_AUDIO_PIPELINE_PROFILING */
+
 /*
  * Publish one event on the pipeline's queue and, if one is registered, to the
  * callback. Never blocks, so it is safe to call from the worker thread.
@@ -1,13 +1,17 @@
 /*
- * Node dispatch plus the one implementation of the pull contract every filter
- * and sink reads its upstream through (spec §4.1.1).
+ * Node dispatch, the one implementation of the pull contract every filter and
+ * sink reads its upstream through (spec §4.1.1), and the open/close walks over
+ * a chain that the pipeline and the tee node share.
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #include <errno.h>
+#include <stdint.h>
 
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
 
 #include <zephyr/audio/audio_node.h>
 
@@ -27,7 +31,45 @@ int audio_eof_safe_errno(int err)
 
 int audio_node_open(struct audio_node *node)
 {
-	if (!node || !node->ops || !node->ops->open) {
+	const struct audio_stream_config *fmt;
+	uint8_t formats;
+	uint8_t layouts;
+
+	if (!node || !node->ops) {
+		return 0;
+	}
+
+	/* The layouts a node handles are declared on its ops rather than
+	 * checked in its open(), so the nodes written before there was more
+	 * than one need no change to refuse a planar frame (spec §5.2).
+	 */
+	fmt = node->pipeline_format;
+	layouts = node->ops->layouts;
+	if (layouts == 0U) {
+		layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED);
+	}
+
+	if (fmt != NULL && (fmt->layout > AUDIO_FRAME_LAYOUT_PLANAR ||
+			    (layouts & AUDIO_FRAME_LAYOUT_BIT(fmt->layout)) == 0U)) {
+		LOG_ERR("the node does not handle frame layout %d", fmt->layout);
+		return -ENOTSUP;
+	}
+
+	/* Sample formats likewise: every node written before F32 existed
+	 * refuses it without knowing it exists.
+	 */
+	formats = node->ops->formats;
+	if (formats == 0U) {
+		formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE);
+	}
+
+	if (fmt != NULL && (fmt->format > AUDIO_SAMPLE_FORMAT_F32_LE ||
+			    (formats & AUDIO_SAMPLE_FORMAT_BIT(fmt->format)) == 0U)) {
+		LOG_ERR("the node does not handle sample format %d", fmt->format);
+		return -ENOTSUP;
+	}
+
+	if (!node->ops->open) {
 		return 0;
 	}
 
@@ -37,6 +79,18 @@ int audio_node_open(struct audio_node *node)
 int audio_node_process(struct audio_node *node, struct audio_buffer_view *buf,
 		       size_t *out_size)
 {
+	return audio_node_process_nested(NULL, node, buf, out_size);
+}
+
+int audio_node_process_nested(struct audio_node *caller, struct audio_node *node,
+			      struct audio_buffer_view *buf, size_t *out_size)
+{
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	uint32_t elapsed;
+	uint32_t start;
+#endif
+	int ret;
+
 	if (!node || !node->ops || !node->ops->process) {
 		return -ENOSYS;
 	}
@@ -45,7 +99,30 @@ int audio_node_process(struct audio_node *node, struct audio_buffer_view *buf,
 		return -EINVAL;
 	}
 
-	return node->ops->process(node, buf, out_size);
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	/* Every pull this call makes adds its cycles to @c nested on the way
+	 * back, so what is left after the subtraction is the node's own work.
+	 * A node is never re-entered - a chain is a tree - so one counter per
+	 * node is enough, and only the thread running the call touches it.
+	 */
+	node->profile.nested = 0U;
+	start = k_cycle_get_32();
+
+	ret = node->ops->process(node, buf, out_size);
+
+	elapsed = k_cycle_get_32() - start;
+	audio_profile_node(node, elapsed, elapsed - MIN(node->profile.nested, elapsed));
+
+	if (caller != NULL) {
+		caller->profile.nested += elapsed;
+	}
+#else
+	ARG_UNUSED(caller);
+
+	ret = node->ops->process(node, buf, out_size);
+#endif
+
+	return ret;
 }
 
 int audio_node_close(struct audio_node *node)
@@ -57,8 +134,31 @@ int audio_node_close(struct audio_node *node)
 	return node->ops->close(node);
 }
 
+int audio_node_lend(struct audio_node *node, struct audio_buffer_view *buf)
+{
+	if (!node || !node->ops || !node->ops->lend) {
+		return -ENOTSUP;
+	}
+
+	if (!buf) {
+		return -EINVAL;
+	}
+
+	return node->ops->lend(node, buf);
+}
+
 int audio_node_pull(struct audio_node *node, struct audio_buffer_view *buf,
 		    size_t *out_size)
+{
+	if (!node) {
+		return -EINVAL;
+	}
+
+	return audio_node_pull_from(node, node->upstream, buf, out_size);
+}
+
+int audio_node_pull_from(struct audio_node *node, struct audio_node *upstream,
+			 struct audio_buffer_view *buf, size_t *out_size)
 {
 	int ret;
 
@@ -71,7 +171,7 @@ int audio_node_pull(struct audio_node *node, struct audio_buffer_view *buf,
 	 */
 	*out_size = 0;
 
-	if (!node->upstream) {
+	if (!upstream) {
 		/* Spec §4.3/§4.4: a filter and a sink have an upstream. A
 		 * missing one is a wiring error, not an empty track.
 		 */
@@ -79,7 +179,7 @@ int audio_node_pull(struct audio_node *node, struct audio_buffer_view *buf,
 		return -ENOTSUP;
 	}
 
-	ret = audio_node_process(node->upstream, buf, out_size);
+	ret = audio_node_process_nested(node, upstream, buf, out_size);
 	if (ret < 0) {
 		*out_size = 0;
 		return audio_eof_safe_errno(ret);
@@ -87,3 +187,150 @@ int audio_node_pull(struct audio_node *node, struct audio_buffer_view *buf,
 
 	return 0;
 }
+
+int audio_node_get_stats(const struct audio_node *node, struct audio_node_stats *stats)
+{
+	if (!node || !stats) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	audio_profile_node_read(node, stats);
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int audio_node_reset_stats(struct audio_node *node)
+{
+	if (!node) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	audio_profile_node_reset(node);
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int audio_node_chain_close(struct audio_node *first, struct audio_node *end)
+{
+	struct audio_node *node = first;
+	unsigned int depth = 0;
+	int first_err = 0;
+	int ret;
+
+	while (node != NULL && node != end) {
+		if (++depth > AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
+			LOG_ERR("node chain deeper than %d, giving up on close",
+				AUDIO_PIPELINE_MAX_CHAIN_DEPTH);
+			return (first_err != 0) ? first_err : -ELOOP;
+		}
+
+		ret = audio_node_close(node);
+		if (ret < 0 && first_err == 0) {
+			first_err = ret;
+		}
+
+		node = node->upstream;
+	}
+
+	return first_err;
+}
+
+/*
+ * Derive the segment above converter @p node from the format it declared in
+ * open(), or refuse one no node could be opened with (spec §5.2).
+ *
+ * The segment's frame is the same stretch of time as the frame below: its
+ * sample sets scaled by the ratio of the two rates, rounded up so that one
+ * frame below never needs more than one frame above. A walk that was given no
+ * capacity, such as an open() driven by hand, derives none either.
+ */
+static int audio_node_segment(const struct audio_node *node, size_t *frame_capacity)
+{
+	const struct audio_stream_config *below = node->pipeline_format;
+	const struct audio_stream_config *above = node->upstream_format;
+	uint64_t sets;
+
+	if (above->sample_rate_hz == 0U || above->channels == 0U ||
+	    above->layout > AUDIO_FRAME_LAYOUT_PLANAR ||
+	    above->format > AUDIO_SAMPLE_FORMAT_F32_LE) {
+		LOG_ERR("a converter asked upstream for a format with no rate, no channels, "
+			"no layout or no sample format");
+		return -EINVAL;
+	}
+
+	if (below == NULL || below->sample_rate_hz == 0U || below->channels == 0U ||
+	    node->frame_capacity == 0U) {
+		*frame_capacity = 0U;
+		return 0;
+	}
+
+	sets = DIV_ROUND_UP((uint64_t)(node->frame_capacity / below->channels) *
+				    above->sample_rate_hz,
+			    below->sample_rate_hz);
+	if (sets == 0U || sets > SIZE_MAX / above->channels) {
+		LOG_ERR("a frame of %zu samples has no %u-channel counterpart at %u Hz",
+			node->frame_capacity, above->channels, above->sample_rate_hz);
+		return -EINVAL;
+	}
+
+	*frame_capacity = (size_t)sets * above->channels;
+
+	return 0;
+}
+
+int audio_node_chain_open(struct audio_node *first, const struct audio_stream_config *format,
+			  size_t frame_capacity)
+{
+	struct audio_node *node = first;
+	unsigned int depth = 0;
+	int ret;
+
+	while (node != NULL) {
+		if (++depth > AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
+			LOG_ERR("node chain deeper than %d, refusing to open",
+				AUDIO_PIPELINE_MAX_CHAIN_DEPTH);
+			(void)audio_node_chain_close(first, node);
+			return -ELOOP;
+		}
+
+		/* Top-down format binding (spec §5.2): every node is handed the
+		 * format of its segment immediately before it is opened, and the
+		 * node validates it in open(). Installing it here rather than
+		 * ahead of the walk keeps the two steps adjacent, so a node can
+		 * never be opened without one.
+		 */
+		node->pipeline_format = format;
+		node->frame_capacity = frame_capacity;
+		node->upstream_format = NULL;
+
+		ret = audio_node_open(node);
+		if (ret < 0) {
+			LOG_ERR("node open failed (%d)", ret);
+			(void)audio_node_chain_close(first, node);
+			return ret;
+		}
+
+		/* A converter has just said what it needs from above: from here
+		 * up, that is the segment, checked before any node in it opens.
+		 */
+		if (node->upstream_format != NULL) {
+			ret = audio_node_segment(node, &frame_capacity);
+			if (ret < 0) {
+				(void)audio_node_chain_close(first, node->upstream);
+				return ret;
+			}
+
+			format = node->upstream_format;
+		}
+
+		node = node->upstream;
+	}
+
+	return 0;
+}
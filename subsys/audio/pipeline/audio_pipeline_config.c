@@ -20,6 +20,38 @@ bool audio_pipeline_config_is_valid(const struct audio_pipeline_config *config)
 		return false;
 	}
 
+	/* Pacing is compiled in or not at all; a configuration asking for it in
+	 * an image built without it would otherwise run unpaced and never say.
+	 */
+	if (config->paced && !IS_ENABLED(CONFIG_AUDIO_PIPELINE_PACED)) {
+		return false;
+	}
+
+	if (config->executor != NULL && !IS_ENABLED(CONFIG_AUDIO_PIPELINE_EXECUTOR)) {
+		return false;
+	}
+
+	/* A pool worker runs one frame of an instance at a time and has no
+	 * second thread to give a producer stage, so the two do not combine.
+	 */
+	if (config->split != NULL &&
+	    (!IS_ENABLED(CONFIG_AUDIO_PIPELINE_RING) || config->executor != NULL)) {
+		return false;
+	}
+
+	/* A batch is a run of frames without a look at the clock or the state
+	 * in between, which is what neither a paced worker nor a pool worker
+	 * may do.
+	 */
+	if (config->batch_frames > 1U && (config->paced || config->executor != NULL)) {
+		return false;
+	}
+
+	/* A threshold nothing measures against would never raise its event. */
+	if (config->overload_percent != 0U && !IS_ENABLED(CONFIG_AUDIO_PIPELINE_LOAD_MONITOR)) {
+		return false;
+	}
+
 	/* The format is not part of the configuration: it is bound separately
 	 * with audio_pipeline_set_format(), which does its own validation, and
 	 * audio_pipeline_start() refuses a pipeline that has none (spec §5.2).
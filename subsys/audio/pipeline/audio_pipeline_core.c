@@ -266,14 +266,17 @@ static bool claimable_by(const struct audio_pipeline *owner,
  * missing ones.
  *
  * All three are checked before any of them is committed, so a refusal leaves
- * both the caller's instance and the current owner untouched.
+ * both the caller's instance and the current owner untouched. @p needs_stack is
+ * false for an instance run by an executor, which has no thread to put a stack
+ * under.
  *
  * @retval 0 on success, also when the pipeline brings all of its own storage
  * @retval -EBUSY if another instance holds one of the built-ins
  */
-static int pipeline_claim_defaults(struct audio_pipeline *pipeline)
+static int pipeline_claim_defaults(struct audio_pipeline *pipeline, bool needs_stack)
 {
-	bool wants_stack = pipeline->stack == NULL || pipeline->stack == default_pipeline_stack;
+	bool wants_stack = needs_stack && (pipeline->stack == NULL ||
+					   pipeline->stack == default_pipeline_stack);
 	bool wants_frame_buf =
 		pipeline->frame_buf == NULL || pipeline->frame_buf == default_frame_buf;
 	bool wants_event_slots =
@@ -316,8 +319,9 @@ static int pipeline_claim_defaults(struct audio_pipeline *pipeline)
 	 *
 	 * Thread resources come as a unit: either the caller supplied a stack
 	 * (and owns size and priority with it) or the subsystem defaults apply.
+	 * An instance on an executor needs neither.
 	 */
-	if (pipeline->stack == NULL) {
+	if (wants_stack && pipeline->stack == NULL) {
 		pipeline->stack = default_pipeline_stack;
 		pipeline->stack_size = K_THREAD_STACK_SIZEOF(default_pipeline_stack);
 		pipeline->priority = AUDIO_PIPELINE_PRIORITY;
@@ -385,36 +389,6 @@ static void pipeline_release_defaults(struct audio_pipeline *pipeline)
 	k_spin_unlock(&default_owner_lock, key);
 }
 
-/*
- * Close the chain from @p first up to (excluding) @p end, walking upstream.
- * Passing NULL as @p end closes the whole chain. Returns the first error but
- * always visits every node, so a failing close() cannot leak the rest.
- */
-static int pipeline_close_chain(struct audio_node *first, struct audio_node *end)
-{
-	struct audio_node *node = first;
-	unsigned int depth = 0;
-	int first_err = 0;
-	int ret;
-
-	while (node != NULL && node != end) {
-		if (++depth > AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
-			LOG_ERR("node chain deeper than %d, giving up on close",
-				AUDIO_PIPELINE_MAX_CHAIN_DEPTH);
-			return (first_err != 0) ? first_err : -ELOOP;
-		}
-
-		ret = audio_node_close(node);
-		if (ret < 0 && first_err == 0) {
-			first_err = ret;
-		}
-
-		node = node->upstream;
-	}
-
-	return first_err;
-}
-
 /*
  * Take the node chain down under a live worker thread and record it in the
  * state, at most once.
@@ -431,50 +405,125 @@ static int pipeline_close_nodes(struct audio_pipeline *pipeline)
 		return 0;
 	}
 
-	return pipeline_close_chain(pipeline->sink, NULL);
+	pipeline->lender = NULL;
+
+	return audio_node_chain_close(pipeline->sink, NULL);
 }
 
 /*
- * Open the chain sink first, then upstream, so a sink can hand resources to
- * the nodes feeding it. On failure everything opened so far is closed again.
+ * Pick the node that lends each frame its storage (spec §4.1.2).
+ *
+ * Only the two ends of a chain own storage worth lending - the block a sink
+ * hands its device, the block a source took from one - and the sink is asked
+ * first: a filter between the ends works in whatever buffer it is handed, so
+ * either end's block serves the whole chain, and the sink's goes to its device
+ * without a further pass. A two-stage run lends nothing: its frames already
+ * live in the ring, which is filled and drained in place.
  */
-static int pipeline_open_nodes(struct audio_pipeline *pipeline)
+static struct audio_node *pipeline_find_lender(struct audio_pipeline *pipeline)
 {
-	struct audio_node *node = pipeline->sink;
-	unsigned int depth = 0;
-	int ret;
+	struct audio_node *head = pipeline->sink;
 
-	while (node != NULL) {
-		if (++depth > AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
-			LOG_ERR("node chain deeper than %d, refusing to open",
-				AUDIO_PIPELINE_MAX_CHAIN_DEPTH);
-			(void)pipeline_close_chain(pipeline->sink, node);
-			return -ELOOP;
-		}
+	if (audio_pipeline_has_ring(pipeline)) {
+		return NULL;
+	}
 
-		/* Top-down format binding (spec §5.2): every node is handed the
-		 * pipeline's format immediately before it is opened, and the
-		 * node validates it in open(). Installing it here rather than
-		 * ahead of the walk keeps the two steps adjacent, so a node can
-		 * never be opened without one.
-		 */
-		node->pipeline_format = &pipeline->format;
+	if (pipeline->sink->ops != NULL && pipeline->sink->ops->lend != NULL) {
+		return pipeline->sink;
+	}
 
-		ret = audio_node_open(node);
-		if (ret < 0) {
-			LOG_ERR("node open failed (%d)", ret);
-			(void)pipeline_close_chain(pipeline->sink, node);
-			return ret;
+	/* Bounded: the chain was opened, so it is no deeper than
+	 * AUDIO_PIPELINE_MAX_CHAIN_DEPTH. A converter pulls its upstream into
+	 * storage of its own and not once per frame, so a block from above one
+	 * is never the frame.
+	 */
+	while (head->upstream != NULL) {
+		if (head->upstream_format != NULL) {
+			return NULL;
 		}
-
-		node = node->upstream;
+		head = head->upstream;
 	}
 
+	return (head->ops != NULL && head->ops->lend != NULL) ? head : NULL;
+}
+
+/*
+ * Open the chain sink first, then upstream, so a sink can hand resources to
+ * the nodes feeding it. On failure everything opened so far is closed again.
+ */
+static int pipeline_open_nodes(struct audio_pipeline *pipeline)
+{
 	/* Deliberately no state move here: audio_pipeline_start() makes it once
 	 * the worker thread exists too, so the state never claims an open chain
 	 * on a pipeline that has no thread to drive it.
 	 */
-	return 0;
+	int ret = audio_node_chain_open(pipeline->sink, &pipeline->format,
+					pipeline->frame_capacity);
+
+	if (ret == 0) {
+		pipeline->lender = pipeline_find_lender(pipeline);
+	}
+
+	return ret;
+}
+
+int audio_pipeline_run_frame(struct audio_pipeline *pipeline)
+{
+	uint64_t begin = audio_pipeline_load_begin();
+	size_t produced;
+	int ret;
+
+	ret = audio_pipeline_pull_frame(pipeline, &produced);
+	if (ret == -ECANCELED) {
+		/* join() freed the worker from its wait for the producer stage
+		 * of a two-stage instance; no node saw the frame.
+		 */
+		return ret;
+	}
+
+	if (ret == -EPIPE) {
+		/* EOF: stop pulling but keep the nodes open so the next play()
+		 * can run another track without a reopen. The move is refused if
+		 * audio_pipeline_stop() already left PLAYING, and the event is
+		 * published either way.
+		 */
+		(void)pipeline_transition(pipeline, PIPELINE_TRIGGER_EOF, NULL);
+		audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_EOF, 0);
+	} else if (ret < 0) {
+		/* First error wins: quiesce the chain before telling the
+		 * application, so the pipeline is fully stopped by the time the
+		 * ERROR event is observed.
+		 */
+		(void)pipeline_close_nodes(pipeline);
+		audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_ERROR, ret);
+	} else {
+		audio_pipeline_pace_complete(pipeline, produced);
+		audio_pipeline_load_account(pipeline, begin, produced);
+	}
+
+	return ret;
+}
+
+/*
+ * Book one pass of the worker loop: @p frames pulled successfully and
+ * @p overhead cycles spent around them. The average is published as it goes,
+ * so a reader never has to combine two counters that moved apart.
+ */
+static void pipeline_account_batch(struct audio_pipeline *pipeline, uint32_t frames,
+				   uint32_t overhead)
+{
+	struct audio_pipeline_worker_counters *counters = &pipeline->worker_stats;
+	atomic_val_t total;
+
+	atomic_inc(&counters->batches);
+	total = atomic_add(&counters->frames, (atomic_val_t)frames) + (atomic_val_t)frames;
+	counters->overhead_total += overhead;
+
+	if (total > 0) {
+		atomic_set(&counters->overhead_per_frame,
+			   (atomic_val_t)MIN(counters->overhead_total / (uint64_t)total,
+					     (uint64_t)UINT32_MAX));
+	}
 }
 
 /*
@@ -484,41 +533,80 @@ static int pipeline_open_nodes(struct audio_pipeline *pipeline)
 static void pipeline_thread(void *p1, void *p2, void *p3)
 {
 	struct audio_pipeline *pipeline = (struct audio_pipeline *)p1;
-	int ret;
+	uint32_t batch = MAX(pipeline->config->batch_frames, 1U);
+	/* The loop accounting is there to tune a batch, so an unbatched
+	 * worker - the default - skips it and pays no cycle reads per frame.
+	 */
+	bool measured = batch > 1U;
+	uint32_t resumed;
+	uint32_t start;
+	uint32_t end;
+	uint32_t now;
+	uint32_t n;
+	int ret = 0;
 
 	ARG_UNUSED(p2);
 	ARG_UNUSED(p3);
 
+	/* Overhead is counted from the moment the worker stops waiting: time
+	 * spent idle or waiting for a paced release is not a cost of the loop.
+	 */
+	resumed = measured ? k_cycle_get_32() : 0U;
+
 	while (!atomic_get(&pipeline->quit_request)) {
 		if (audio_pipeline_state_get(pipeline) != AUDIO_PIPELINE_STATE_PLAYING) {
 			/* Idle instead of spinning; play() and join() both
-			 * release the semaphore.
+			 * release the semaphore. A paced run ends here, so the
+			 * next play() starts a timeline of its own.
 			 */
+			audio_pipeline_pace_reset(pipeline);
 			(void)k_sem_take(&pipeline->wake, K_FOREVER);
+			resumed = measured ? k_cycle_get_32() : 0U;
 			continue;
 		}
 
-		ret = audio_pipeline_process_frame(pipeline);
-		if (ret == -EPIPE) {
-			/* EOF: stop pulling but keep the nodes open so the next
-			 * play() can run another track without a reopen. The
-			 * move is refused if audio_pipeline_stop() already left
-			 * PLAYING, and the event is published either way.
+		if (!audio_pipeline_pace_release(pipeline)) {
+			/* Paced and early: the pacing timer releases the same
+			 * semaphore at the frame's due time, and the state is
+			 * looked at again before the frame is pulled.
 			 */
-			(void)pipeline_transition(pipeline, PIPELINE_TRIGGER_EOF, NULL);
-			audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_EOF, 0);
-		} else if (ret < 0) {
-			/* First error wins: quiesce the chain before telling the
-			 * application, so the pipeline is fully stopped by the
-			 * time the ERROR event is observed.
-			 */
-			(void)pipeline_close_nodes(pipeline);
-			audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_ERROR, ret);
-		} else {
+			(void)k_sem_take(&pipeline->wake, K_FOREVER);
+			resumed = measured ? k_cycle_get_32() : 0U;
+			continue;
+		}
+
+		/* Neither the state nor the exit request is looked at inside
+		 * a batch; that is the whole saving. End of stream and errors
+		 * end it early, because run_frame() has already moved the
+		 * state for them.
+		 */
+		start = measured ? k_cycle_get_32() : 0U;
+		for (n = 0U; n < batch; n++) {
+			ret = audio_pipeline_run_frame(pipeline);
+			if (ret != 0) {
+				break;
+			}
+		}
+		end = measured ? k_cycle_get_32() : 0U;
+
+		/* A paced worker yields by waiting for its next release. */
+		if (ret == 0 && !audio_pipeline_is_paced(pipeline)) {
 			k_yield();
 		}
+
+		/* Everything but the frames themselves: the checks before the
+		 * batch and the yield after it. Unsigned differences, so a
+		 * wrap of the cycle counter costs nothing.
+		 */
+		if (measured) {
+			now = k_cycle_get_32();
+			pipeline_account_batch(pipeline, n, (start - resumed) + (now - end));
+			resumed = now;
+		}
 	}
 
+	audio_pipeline_pace_cancel(pipeline);
+
 	/* Deliberately no state move on the way out. The state the worker
 	 * leaves behind still says whether the node chain is open, and
 	 * audio_pipeline_join() - the only writer of quit_request, and parked
@@ -556,13 +644,19 @@ int audio_pipeline_init(struct audio_pipeline *pipeline,
 	/* Before the first write to the instance, so a pipeline refused the
 	 * built-ins is handed back untouched rather than half bound.
 	 */
-	ret = pipeline_claim_defaults(pipeline);
+	if (config->split != NULL && !audio_pipeline_ring_is_defined(pipeline)) {
+		LOG_ERR("a split configuration needs an instance defined with a ring depth");
+		return -EINVAL;
+	}
+
+	ret = pipeline_claim_defaults(pipeline, config->executor == NULL);
 	if (ret < 0) {
 		return ret;
 	}
 
 	pipeline->config = config;
 	pipeline->sink = sink;
+	pipeline->lender = NULL;
 
 	/* The configured frame size governs how much of the buffer is used. */
 	pipeline->frame_capacity = MIN(pipeline->frame_capacity, (size_t)config->frame_samples);
@@ -579,6 +673,15 @@ int audio_pipeline_init(struct audio_pipeline *pipeline,
 	atomic_clear(&pipeline->quit_request);
 	k_sem_init(&pipeline->wake, 0, 1);
 
+	pipeline->worker_stats.overhead_total = 0U;
+	atomic_clear(&pipeline->worker_stats.frames);
+	atomic_clear(&pipeline->worker_stats.batches);
+	atomic_clear(&pipeline->worker_stats.overhead_per_frame);
+
+	if (audio_pipeline_is_paced(pipeline)) {
+		audio_pipeline_pace_init(pipeline);
+	}
+
 	/* Last, so the instance only counts as initialised once everything it
 	 * needs is in place: this is the move that stops the lifecycle entry
 	 * points and audio_pipeline_get_event() returning -EINVAL.
@@ -599,8 +702,10 @@ int audio_pipeline_set_format(struct audio_pipeline *pipeline,
 	/* A format no node could ever satisfy is refused here rather than at the
 	 * first open(), where it would look like a node defect (spec §8.1).
 	 */
-	if (fmt->sample_rate_hz == 0U || fmt->channels == 0U) {
-		LOG_ERR("a pipeline format needs a sample rate and a channel count");
+	if (fmt->sample_rate_hz == 0U || fmt->channels == 0U ||
+	    fmt->layout > AUDIO_FRAME_LAYOUT_PLANAR || fmt->format > AUDIO_SAMPLE_FORMAT_F32_LE) {
+		LOG_ERR("a pipeline format needs a sample rate, a channel count, a layout and "
+			"a sample format");
 		return -EINVAL;
 	}
 
@@ -677,7 +782,7 @@ int audio_pipeline_start(struct audio_pipeline *pipeline)
 	 * event queue is one of the resources this pipeline no longer owns, and
 	 * publishing into it would corrupt the new owner's queue.
 	 */
-	ret = pipeline_claim_defaults(pipeline);
+	ret = pipeline_claim_defaults(pipeline, !audio_pipeline_has_executor(pipeline));
 	if (ret < 0) {
 		return ret;
 	}
@@ -702,17 +807,53 @@ int audio_pipeline_start(struct audio_pipeline *pipeline)
 		return 0;
 	}
 
+	create_thread = !pipeline_state_has_worker(state);
+	if (create_thread && audio_pipeline_has_executor(pipeline)) {
+		/* Registration is the executor's "thread", and it is the part
+		 * that can run out, so it goes first: a full pool refuses the
+		 * start before a single node has been opened. The registered
+		 * instance is not PLAYING yet, so no pool worker touches it.
+		 */
+		ret = audio_pipeline_executor_attach(pipeline);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (create_thread && audio_pipeline_has_ring(pipeline)) {
+		/* The ring goes in before the first open, so opening walks it
+		 * like any other node; a restart from CLOSED finds it in place.
+		 */
+		ret = audio_pipeline_ring_wire(pipeline);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
 	ret = pipeline_open_nodes(pipeline);
 	if (ret < 0) {
 		/* The state was not moved, so the instance is still where it
 		 * started: INIT with no thread, or CLOSED with the thread of the
 		 * run a node error ended.
 		 */
+		if (create_thread && audio_pipeline_has_executor(pipeline)) {
+			audio_pipeline_executor_detach(pipeline);
+		}
+
+		if (create_thread && audio_pipeline_has_ring(pipeline)) {
+			audio_pipeline_ring_unwire(pipeline);
+		}
+
 		audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_ERROR, ret);
 		return ret;
 	}
 
-	create_thread = !pipeline_state_has_worker(state);
+	/* A profile, and the load figures, cover one run of a freshly opened
+	 * chain.
+	 */
+	audio_profile_start(pipeline);
+	audio_pipeline_load_reset(pipeline);
+
 	if (create_thread) {
 		/* Both reset before the thread exists, so its first pass sees a
 		 * fresh wake semaphore and no exit request left by an earlier
@@ -728,11 +869,15 @@ int audio_pipeline_start(struct audio_pipeline *pipeline)
 	 */
 	(void)pipeline_transition(pipeline, PIPELINE_TRIGGER_START, NULL);
 
-	if (create_thread) {
+	if (create_thread && !audio_pipeline_has_executor(pipeline)) {
 		k_thread_create(&pipeline->thread, pipeline->stack, pipeline->stack_size,
 				pipeline_thread, pipeline, NULL, NULL, pipeline->priority, 0,
 				K_NO_WAIT);
 		k_thread_name_set(&pipeline->thread, "audio_pipeline");
+
+		if (audio_pipeline_has_ring(pipeline)) {
+			audio_pipeline_ring_start(pipeline);
+		}
 	}
 
 	return 0;
@@ -759,7 +904,18 @@ int audio_pipeline_play(struct audio_pipeline *pipeline)
 		 * playing must not be handed a spare count, or the next idle
 		 * wait returns at once.
 		 */
-		k_sem_give(&pipeline->wake);
+		if (audio_pipeline_has_executor(pipeline)) {
+			audio_pipeline_executor_kick(pipeline);
+		} else {
+			k_sem_give(&pipeline->wake);
+		}
+
+		/* The producer stage resumes too, also after it parked on the
+		 * end of the previous track.
+		 */
+		if (audio_pipeline_has_ring(pipeline)) {
+			audio_pipeline_ring_play(pipeline);
+		}
 	}
 
 	return 0;
@@ -805,9 +961,23 @@ int audio_pipeline_join(struct audio_pipeline *pipeline)
 		 * way through this last frame.
 		 */
 		atomic_set(&pipeline->quit_request, 1);
-		k_sem_give(&pipeline->wake);
 
-		(void)k_thread_join(&pipeline->thread, K_FOREVER);
+		/* Producer first: ending it also releases a worker that waits
+		 * for the frame it would have made.
+		 */
+		if (audio_pipeline_has_ring(pipeline)) {
+			audio_pipeline_ring_join(pipeline);
+		}
+
+		if (audio_pipeline_has_executor(pipeline)) {
+			/* No thread to join: wait out a frame a pool worker
+			 * may have in flight, then leave the pool.
+			 */
+			audio_pipeline_executor_detach(pipeline);
+		} else {
+			k_sem_give(&pipeline->wake);
+			(void)k_thread_join(&pipeline->thread, K_FOREVER);
+		}
 	}
 
 	/* The worker has returned, so nothing races this move. It does both
@@ -819,12 +989,19 @@ int audio_pipeline_join(struct audio_pipeline *pipeline)
 	(void)pipeline_transition(pipeline, PIPELINE_TRIGGER_JOIN, &from);
 
 	if (pipeline_state_has_open_chain(from)) {
-		ret = pipeline_close_chain(pipeline->sink, NULL);
+		ret = audio_node_chain_close(pipeline->sink, NULL);
 		if (ret < 0) {
 			audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_ERROR, ret);
 		}
 	}
 
+	audio_profile_join(pipeline);
+
+	/* Closed, so the chain goes back to the wiring the application built. */
+	if (audio_pipeline_has_ring(pipeline)) {
+		audio_pipeline_ring_unwire(pipeline);
+	}
+
 	/* Last, so the close error still reaches the event queue the instance was
 	 * running on. From here the built-ins are up for grabs again.
 	 */
@@ -844,12 +1021,149 @@ bool audio_pipeline_is_playing(const struct audio_pipeline *pipeline)
 	       audio_pipeline_state_get(pipeline) == AUDIO_PIPELINE_STATE_PLAYING;
 }
 
+int audio_pipeline_get_pacing_stats(const struct audio_pipeline *pipeline,
+				    struct audio_pipeline_pacing_stats *stats)
+{
+	if (!pipeline || !stats ||
+	    audio_pipeline_state_get(pipeline) == AUDIO_PIPELINE_STATE_UNINIT) {
+		return -EINVAL;
+	}
+
+	if (!audio_pipeline_is_paced(pipeline)) {
+		return -ENOTSUP;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_PACED
+	stats->frames = (uint32_t)atomic_get(&pipeline->pacing.frames);
+	stats->deadline_misses = (uint32_t)atomic_get(&pipeline->pacing.deadline_misses);
+	stats->max_lateness_us = (uint32_t)atomic_get(&pipeline->pacing.max_lateness_us);
+#endif
+
+	return 0;
+}
+
+int audio_pipeline_get_worker_stats(const struct audio_pipeline *pipeline,
+				    struct audio_pipeline_worker_stats *stats)
+{
+	if (!pipeline || !stats ||
+	    audio_pipeline_state_get(pipeline) == AUDIO_PIPELINE_STATE_UNINIT) {
+		return -EINVAL;
+	}
+
+	if (audio_pipeline_has_executor(pipeline)) {
+		return -ENOTSUP;
+	}
+
+	stats->frames = (uint32_t)atomic_get(&pipeline->worker_stats.frames);
+	stats->batches = (uint32_t)atomic_get(&pipeline->worker_stats.batches);
+	stats->overhead_cycles = (uint32_t)atomic_get(&pipeline->worker_stats.overhead_per_frame);
+	stats->overhead_ns = (uint32_t)MIN(k_cyc_to_ns_floor64(stats->overhead_cycles),
+					   (uint64_t)UINT32_MAX);
+
+	return 0;
+}
+
+int audio_pipeline_get_load_stats(const struct audio_pipeline *pipeline,
+				  struct audio_pipeline_load_stats *stats)
+{
+	if (!pipeline || !stats ||
+	    audio_pipeline_state_get(pipeline) == AUDIO_PIPELINE_STATE_UNINIT) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_LOAD_MONITOR
+	stats->frames = (uint32_t)atomic_get(&pipeline->load.frames);
+	stats->load_percent = (uint32_t)atomic_get(&pipeline->load.load_percent);
+	stats->worst_percent = (uint32_t)atomic_get(&pipeline->load.worst_percent);
+	stats->peak_percent = (uint32_t)atomic_get(&pipeline->load.peak_percent);
+	stats->overloads = (uint32_t)atomic_get(&pipeline->load.overloads);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int audio_pipeline_get_stats(const struct audio_pipeline *pipeline,
+			     struct audio_pipeline_stats *stats, struct audio_node_stats *nodes,
+			     size_t *node_count)
+{
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	const struct audio_node *node;
+	size_t count = 0;
+#endif
+
+	if (!pipeline || !stats || (nodes != NULL && node_count == NULL) ||
+	    audio_pipeline_state_get(pipeline) == AUDIO_PIPELINE_STATE_UNINIT) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	audio_profile_frame_read(pipeline, stats);
+
+	if (nodes == NULL) {
+		return 0;
+	}
+
+	/* The walk audio_node_chain_open() makes, ring node included. */
+	for (node = pipeline->sink; node != NULL && count < AUDIO_PIPELINE_MAX_CHAIN_DEPTH;
+	     node = node->upstream) {
+		if (count < *node_count) {
+			audio_profile_node_read(node, &nodes[count]);
+		}
+
+		count++;
+	}
+
+	*node_count = count;
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int audio_pipeline_reset_stats(struct audio_pipeline *pipeline)
+{
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	struct audio_node *node = pipeline != NULL ? pipeline->sink : NULL;
+	unsigned int depth = 0;
+#endif
+
+	if (!pipeline || audio_pipeline_state_get(pipeline) == AUDIO_PIPELINE_STATE_UNINIT) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	audio_profile_frame_reset(pipeline);
+
+	while (node != NULL && depth++ < AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
+		audio_profile_node_reset(node);
+		node = node->upstream;
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int audio_pipeline_process_frame(struct audio_pipeline *pipeline)
+{
+	size_t produced;
+
+	return audio_pipeline_pull_frame(pipeline, &produced);
+}
+
+int audio_pipeline_pull_frame(struct audio_pipeline *pipeline, size_t *produced)
 {
 	struct audio_buffer_view view;
-	size_t produced = 0;
+	uint32_t waited = 0U;
+	uint32_t start;
 	int ret;
 
+	*produced = 0;
+
 	if (!pipeline || !pipeline->sink || !pipeline->frame_buf) {
 		return -EINVAL;
 	}
@@ -861,7 +1175,43 @@ int audio_pipeline_process_frame(struct audio_pipeline *pipeline)
 	view.data = pipeline->frame_buf;
 	view.capacity = pipeline->frame_capacity;
 
-	ret = audio_node_process(pipeline->sink, &view, &produced);
+	/* The frame's cost runs from the lend to the sink's return, without
+	 * the wait for the producer stage of a two-stage run (spec §8.4).
+	 */
+	start = audio_profile_now();
+
+	if (pipeline->lender != NULL) {
+		/* Declining is not a failure: the frame is produced in the
+		 * pipeline's own buffer, as it would be without a lender.
+		 */
+		ret = audio_node_lend(pipeline->lender, &view);
+		if (ret == -ENOTSUP) {
+			view.data = pipeline->frame_buf;
+		} else if (ret < 0) {
+			return audio_eof_safe_errno(ret);
+		}
+
+		view.capacity = pipeline->frame_capacity;
+	}
+
+	if (audio_pipeline_has_ring(pipeline)) {
+		/* The consumer stage works in the slot the producer filled. */
+		waited = audio_profile_now();
+		ret = audio_pipeline_ring_acquire(pipeline, &view.data);
+		if (ret < 0) {
+			return ret;
+		}
+		waited = audio_profile_now() - waited;
+	}
+
+	ret = audio_node_process(pipeline->sink, &view, produced);
+
+	audio_profile_frame(pipeline, audio_profile_now() - start - waited);
+
+	if (audio_pipeline_has_ring(pipeline)) {
+		audio_pipeline_ring_release(pipeline);
+	}
+
 	if (ret < 0) {
 		/* Only an empty frame ends the stream, never a failing sink:
 		 * -EPIPE is this function's own EOF signal, so a sink reporting
@@ -870,7 +1220,7 @@ int audio_pipeline_process_frame(struct audio_pipeline *pipeline)
 		return audio_eof_safe_errno(ret);
 	}
 
-	if (produced == 0) {
+	if (*produced == 0) {
 		return -EPIPE;
 	}
 
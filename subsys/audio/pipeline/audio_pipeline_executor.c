@@ -0,0 +1,223 @@
+/*
+ * Shared worker pool: many pipelines, few threads, earliest deadline first
+ * (spec §3.4).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_executor.h>
+
+#include "audio_internal.h"
+
+LOG_MODULE_REGISTER(audio_pipeline_executor, LOG_LEVEL_INF);
+
+/*
+ * Pick the frame to pull next: of the registered instances that are playing,
+ * not already being pulled and not on their way out, the one whose frame is
+ * due with the earliest deadline.
+ *
+ * An instance that is not playing has its timeline forgotten here, exactly as
+ * the per-pipeline worker does when it goes idle, so the next play() starts a
+ * fresh one.
+ *
+ * Called with the executor lock held.
+ *
+ * @param next_release Receives the earliest release among instances that are
+ *                     playing but not due yet, or INT64_MAX if there is none.
+ *
+ * @return the instance to pull, or NULL if no frame is due
+ */
+static struct audio_pipeline *executor_pick(struct audio_pipeline_executor *executor,
+					    int64_t now, int64_t *next_release)
+{
+	struct audio_pipeline *best = NULL;
+	int64_t best_deadline = INT64_MAX;
+	int64_t release;
+	int64_t deadline;
+	size_t i;
+
+	*next_release = INT64_MAX;
+
+	for (i = 0; i < executor->slot_count; i++) {
+		struct audio_pipeline *pipeline = executor->slots[i];
+
+		if (pipeline == NULL || pipeline->dispatching ||
+		    atomic_get(&pipeline->quit_request)) {
+			continue;
+		}
+
+		if (audio_pipeline_state_get(pipeline) != AUDIO_PIPELINE_STATE_PLAYING) {
+			audio_pipeline_pace_reset(pipeline);
+			continue;
+		}
+
+		audio_pipeline_pace_window(pipeline, now, &release, &deadline);
+
+		if (release > now) {
+			*next_release = MIN(*next_release, release);
+			continue;
+		}
+
+		if (deadline < best_deadline) {
+			best = pipeline;
+			best_deadline = deadline;
+		}
+	}
+
+	return best;
+}
+
+static void executor_thread(void *p1, void *p2, void *p3)
+{
+	struct audio_pipeline_executor *executor = p1;
+	struct audio_pipeline *pipeline;
+	int64_t next_release;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	(void)k_mutex_lock(&executor->lock, K_FOREVER);
+
+	for (;;) {
+		pipeline = executor_pick(executor, k_uptime_ticks(), &next_release);
+		if (pipeline == NULL) {
+			/* Nothing due: sleep until the earliest release, or
+			 * until a play() makes another instance runnable.
+			 */
+			(void)k_condvar_wait(&executor->work, &executor->lock,
+					     next_release == INT64_MAX
+						     ? K_FOREVER
+						     : K_TIMEOUT_ABS_TICKS(next_release));
+			continue;
+		}
+
+		/* The frame runs without the lock, so the other workers keep
+		 * dispatching the other pipelines meanwhile. The flag keeps
+		 * them off this one.
+		 */
+		pipeline->dispatching = true;
+		(void)k_mutex_unlock(&executor->lock);
+
+		(void)audio_pipeline_run_frame(pipeline);
+
+		(void)k_mutex_lock(&executor->lock, K_FOREVER);
+		pipeline->dispatching = false;
+
+		/* No other worker needs telling: this one picks again right
+		 * away, and that covers the next release of this pipeline too.
+		 * Only a join() waiting for this very frame does - waking the
+		 * whole pool after every frame would cost the context switches
+		 * the pool is there to save.
+		 */
+		if (atomic_get(&pipeline->quit_request)) {
+			(void)k_condvar_broadcast(&executor->work);
+		}
+	}
+}
+
+int audio_pipeline_executor_init(struct audio_pipeline_executor *executor)
+{
+	uint8_t i;
+
+	if (!executor || !executor->threads || !executor->stacks || !executor->slots) {
+		return -EINVAL;
+	}
+
+	if (executor->started) {
+		return -EALREADY;
+	}
+
+	(void)k_mutex_init(&executor->lock);
+	(void)k_condvar_init(&executor->work);
+
+	for (i = 0; i < executor->slot_count; i++) {
+		executor->slots[i] = NULL;
+	}
+
+	executor->started = true;
+
+	for (i = 0; i < executor->worker_count; i++) {
+		k_thread_stack_t *stack =
+			(k_thread_stack_t *)((uint8_t *)executor->stacks +
+					     (size_t)i * executor->stack_stride);
+
+		k_thread_create(&executor->threads[i], stack, executor->stack_size,
+				executor_thread, executor, NULL, NULL, executor->priority, 0,
+				K_NO_WAIT);
+		k_thread_name_set(&executor->threads[i], "audio_executor");
+	}
+
+	return 0;
+}
+
+int audio_pipeline_executor_attach(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_executor *executor = pipeline->config->executor;
+	int ret = -ENOSPC;
+	size_t i;
+
+	if (!executor->started) {
+		LOG_ERR("executor not started; call audio_pipeline_executor_init() first");
+		return -EINVAL;
+	}
+
+	(void)k_mutex_lock(&executor->lock, K_FOREVER);
+
+	for (i = 0; i < executor->slot_count; i++) {
+		if (executor->slots[i] == NULL) {
+			pipeline->dispatching = false;
+			executor->slots[i] = pipeline;
+			ret = 0;
+			break;
+		}
+	}
+
+	(void)k_mutex_unlock(&executor->lock);
+
+	if (ret < 0) {
+		LOG_ERR("executor has no free slot for another pipeline");
+	}
+
+	return ret;
+}
+
+void audio_pipeline_executor_detach(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_executor *executor = pipeline->config->executor;
+	size_t i;
+
+	(void)k_mutex_lock(&executor->lock, K_FOREVER);
+
+	/* quit_request is already set, so no worker picks the instance again;
+	 * only a frame that was in flight before has to be waited out.
+	 */
+	while (pipeline->dispatching) {
+		(void)k_condvar_wait(&executor->work, &executor->lock, K_FOREVER);
+	}
+
+	for (i = 0; i < executor->slot_count; i++) {
+		if (executor->slots[i] == pipeline) {
+			executor->slots[i] = NULL;
+		}
+	}
+
+	(void)k_mutex_unlock(&executor->lock);
+}
+
+void audio_pipeline_executor_kick(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_executor *executor = pipeline->config->executor;
+
+	(void)k_mutex_lock(&executor->lock, K_FOREVER);
+	(void)k_condvar_broadcast(&executor->work);
+	(void)k_mutex_unlock(&executor->lock);
+}
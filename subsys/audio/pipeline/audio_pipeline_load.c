@@ -0,0 +1,120 @@
+/*
+ * Real-time headroom: the CPU time each frame took against the time it lasts,
+ * folded into a load per window of frames, and the overload event raised when
+ * that load crosses the configured threshold (spec §8.5).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_pipeline.h>
+
+#include "audio_internal.h"
+
+#define LOAD_WINDOW     CONFIG_AUDIO_PIPELINE_LOAD_WINDOW
+#define LOAD_HYSTERESIS CONFIG_AUDIO_PIPELINE_LOAD_HYSTERESIS
+
+/* @p busy in percent of @p period, saturated rather than wrapped. */
+static uint32_t load_percent(uint64_t busy, uint64_t period)
+{
+	if (period == 0U) {
+		return 0U;
+	}
+
+	return (uint32_t)MIN(busy * 100U / period, (uint64_t)UINT32_MAX);
+}
+
+void audio_pipeline_load_reset(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_load *load = &pipeline->load;
+
+	load->busy = 0U;
+	load->period = 0U;
+	load->window_frames = 0U;
+	load->window_worst = 0U;
+	load->overloaded = false;
+
+	atomic_clear(&load->frames);
+	atomic_clear(&load->load_percent);
+	atomic_clear(&load->worst_percent);
+	atomic_clear(&load->peak_percent);
+	atomic_clear(&load->overloads);
+}
+
+uint64_t audio_pipeline_load_begin(void)
+{
+	k_thread_runtime_stats_t stats;
+
+	/* Run time rather than wall time: a sink blocked in i2s_write() is
+	 * the pacing working, not load, and counting it would report every
+	 * hardware-paced chain as fully loaded.
+	 */
+	if (k_thread_runtime_stats_get(k_current_get(), &stats) != 0) {
+		return 0U;
+	}
+
+	return stats.execution_cycles;
+}
+
+/* Close the window: publish its figures and decide about the event. */
+static void load_window_close(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_load *load = &pipeline->load;
+	uint32_t threshold = pipeline->config->overload_percent;
+	uint32_t percent = load_percent(load->busy, load->period);
+
+	atomic_set(&load->load_percent, (atomic_val_t)percent);
+	atomic_set(&load->worst_percent, (atomic_val_t)load->window_worst);
+
+	load->busy = 0U;
+	load->period = 0U;
+	load->window_frames = 0U;
+	load->window_worst = 0U;
+
+	if (threshold == 0U) {
+		return;
+	}
+
+	if (!load->overloaded && percent >= threshold) {
+		load->overloaded = true;
+		atomic_inc(&load->overloads);
+		audio_pipeline_publish_event(pipeline, AUDIO_PIPELINE_EVENT_OVERLOAD, 0);
+	} else if (load->overloaded && percent + LOAD_HYSTERESIS < threshold) {
+		load->overloaded = false;
+	}
+}
+
+void audio_pipeline_load_account(struct audio_pipeline *pipeline, uint64_t begin,
+				 size_t produced)
+{
+	struct audio_pipeline_load *load = &pipeline->load;
+	const struct audio_stream_config *fmt = &pipeline->format;
+	uint64_t busy = audio_pipeline_load_begin() - begin;
+	uint64_t period;
+	uint32_t percent;
+
+	/* End of stream and failed frames last no time at all. */
+	if (produced == 0U || fmt->sample_rate_hz == 0U || fmt->channels == 0U) {
+		return;
+	}
+
+	period = (uint64_t)(produced / fmt->channels) * sys_clock_hw_cycles_per_sec() /
+		 fmt->sample_rate_hz;
+	percent = load_percent(busy, period);
+
+	load->busy += busy;
+	load->period += period;
+	load->window_worst = MAX(load->window_worst, percent);
+
+	atomic_inc(&load->frames);
+	if (percent > (uint32_t)atomic_get(&load->peak_percent)) {
+		atomic_set(&load->peak_percent, (atomic_val_t)percent);
+	}
+
+	if (++load->window_frames >= LOAD_WINDOW) {
+		load_window_close(pipeline);
+	}
+}
@@ -0,0 +1,156 @@
+/*
+ * Timer-paced worker mode: one frame per frame period, released from an
+ * absolute timeline rather than from the previous frame (spec §3.2).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/time_units.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_pipeline.h>
+
+#include "audio_internal.h"
+
+/* The worker waits on the same semaphore for a frame release as for play() and
+ * join(), so a paced worker never needs a second wait to be interruptible.
+ */
+static void pipeline_pace_expiry(struct k_timer *timer)
+{
+	struct audio_pipeline *pipeline =
+		CONTAINER_OF(timer, struct audio_pipeline, pacing.timer);
+
+	k_sem_give(&pipeline->wake);
+}
+
+/*
+ * Tick at which sample set @p sets of the current run is due.
+ *
+ * Rounded up, so a frame is never released before its samples are: the
+ * rounding error stays below one tick for every frame and, because it is
+ * computed from the anchor each time, never adds up across frames.
+ */
+static int64_t pipeline_pace_due(const struct audio_pipeline *pipeline, uint64_t sets)
+{
+	uint64_t rate = pipeline->format.sample_rate_hz;
+	uint64_t ticks = (sets * (uint64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC + rate - 1U) / rate;
+
+	return pipeline->pacing.anchor + (int64_t)ticks;
+}
+
+void audio_pipeline_pace_init(struct audio_pipeline *pipeline)
+{
+	k_timer_init(&pipeline->pacing.timer, pipeline_pace_expiry, NULL);
+	pipeline->pacing.anchored = false;
+	atomic_clear(&pipeline->pacing.frames);
+	atomic_clear(&pipeline->pacing.deadline_misses);
+	atomic_clear(&pipeline->pacing.max_lateness_us);
+}
+
+void audio_pipeline_pace_reset(struct audio_pipeline *pipeline)
+{
+	if (!audio_pipeline_is_paced(pipeline)) {
+		return;
+	}
+
+	pipeline->pacing.anchored = false;
+}
+
+void audio_pipeline_pace_cancel(struct audio_pipeline *pipeline)
+{
+	if (!audio_pipeline_is_paced(pipeline)) {
+		return;
+	}
+
+	k_timer_stop(&pipeline->pacing.timer);
+	pipeline->pacing.anchored = false;
+}
+
+void audio_pipeline_pace_window(struct audio_pipeline *pipeline, int64_t now, int64_t *release,
+				int64_t *deadline)
+{
+	struct audio_pipeline_pacing *pacing = &pipeline->pacing;
+	uint64_t frame_sets = pipeline->frame_capacity / pipeline->format.channels;
+
+	/* The first frame after play() is due at once and starts the timeline. */
+	if (!pacing->anchored) {
+		pacing->anchor = now;
+		pacing->sets = 0U;
+		pacing->anchored = true;
+	}
+
+	*release = pipeline_pace_due(pipeline, pacing->sets);
+	*deadline = pipeline_pace_due(pipeline, pacing->sets + frame_sets);
+}
+
+bool audio_pipeline_pace_release(struct audio_pipeline *pipeline)
+{
+	int64_t deadline;
+	int64_t now;
+	int64_t due;
+
+	if (!audio_pipeline_is_paced(pipeline)) {
+		return true;
+	}
+
+	now = k_uptime_ticks();
+
+	audio_pipeline_pace_window(pipeline, now, &due, &deadline);
+	if (now >= due) {
+		return true;
+	}
+
+	/* One-shot at an absolute tick: a periodic timer would release frames
+	 * at a rounded period and drift by the rounding every frame.
+	 */
+	k_timer_start(&pipeline->pacing.timer, K_TIMEOUT_ABS_TICKS(due), K_NO_WAIT);
+
+	return false;
+}
+
+void audio_pipeline_pace_complete(struct audio_pipeline *pipeline, size_t produced)
+{
+	struct audio_pipeline_pacing *pacing = &pipeline->pacing;
+	uint32_t lateness_us;
+	int64_t released;
+	int64_t now;
+	int64_t due;
+
+	if (!audio_pipeline_is_paced(pipeline)) {
+		return;
+	}
+
+	atomic_inc(&pacing->frames);
+
+	/* A frame's deadline is the release of the next one: that is when the
+	 * sink expects the samples it carried to be followed by more.
+	 */
+	released = pipeline_pace_due(pipeline, pacing->sets);
+	pacing->sets += produced / pipeline->format.channels;
+	due = pipeline_pace_due(pipeline, pacing->sets);
+	now = k_uptime_ticks();
+
+	if (now <= due) {
+		return;
+	}
+
+	atomic_inc(&pacing->deadline_misses);
+
+	lateness_us = (uint32_t)MIN(k_ticks_to_us_ceil64((uint64_t)(now - due)), UINT32_MAX);
+	if (lateness_us > (uint32_t)atomic_get(&pacing->max_lateness_us)) {
+		atomic_set(&pacing->max_lateness_us, (atomic_val_t)lateness_us);
+	}
+
+	/* A frame that is merely late is followed at once and the timeline
+	 * holds, so a single slow frame costs no long-term rate. A worker more
+	 * than a whole frame behind would instead burst through every frame it
+	 * missed, which is exactly what a real-time sink cannot take - so it
+	 * slips the timeline to now and carries on from there.
+	 */
+	if (now - due > due - released) {
+		pacing->anchor = now;
+		pacing->sets = 0U;
+	}
+}
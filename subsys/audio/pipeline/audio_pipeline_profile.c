@@ -0,0 +1,174 @@
+/*
+ * Cycle profiling: what every node's process() call and every frame cost, kept
+ * as min/avg/max and a power-of-two histogram, and the list of started
+ * pipelines the shell dumps (spec §8.4).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+
+#include "audio_internal.h"
+
+/* One lock for every counter set. A booking is a handful of adds, so a lock
+ * per node would buy nothing but size; what the lock is for is a reader never
+ * seeing a total that is ahead of its count, which a 64-bit total on a 32-bit
+ * core would otherwise allow.
+ */
+static struct k_spinlock profile_lock;
+
+/* Started pipelines, for the shell. A mutex, not the spinlock: the shell
+ * prints while it walks the list.
+ */
+static sys_slist_t profile_list = SYS_SLIST_STATIC_INIT(&profile_list);
+static K_MUTEX_DEFINE(profile_list_lock);
+
+static uint32_t profile_bucket(uint32_t cycles)
+{
+	/* floor(log2(cycles)), with 0 cycles in bucket 0 too. */
+	uint32_t bucket = 31U - (uint32_t)__builtin_clz(cycles | 1U);
+
+	return MIN(bucket, (uint32_t)(AUDIO_PROFILE_BUCKETS - 1));
+}
+
+static void profile_add(struct audio_profile_counters *counters, uint32_t cycles)
+{
+	if (counters->count == 0U || cycles < counters->min) {
+		counters->min = cycles;
+	}
+
+	counters->max = MAX(counters->max, cycles);
+	counters->total += cycles;
+	counters->count++;
+	counters->histogram[profile_bucket(cycles)]++;
+}
+
+static void profile_read(const struct audio_profile_counters *counters,
+			 struct audio_profile_stats *stats)
+{
+	stats->count = counters->count;
+	stats->min_cycles = counters->min;
+	stats->max_cycles = counters->max;
+	stats->avg_cycles = (counters->count == 0U)
+				    ? 0U
+				    : (uint32_t)(counters->total / counters->count);
+	memcpy(stats->histogram, counters->histogram, sizeof(stats->histogram));
+}
+
+void audio_profile_node(struct audio_node *node, uint32_t inclusive, uint32_t exclusive)
+{
+	k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+	profile_add(&node->profile.inclusive, inclusive);
+	profile_add(&node->profile.exclusive, exclusive);
+
+	k_spin_unlock(&profile_lock, key);
+}
+
+void audio_profile_frame(struct audio_pipeline *pipeline, uint32_t cycles)
+{
+	struct audio_pipeline_profile *profile = &pipeline->profile;
+	k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+	profile_add(&profile->frame, cycles);
+	if (profile->budget_cycles != 0U && cycles > profile->budget_cycles) {
+		profile->over_budget++;
+	}
+
+	k_spin_unlock(&profile_lock, key);
+}
+
+void audio_profile_node_read(const struct audio_node *node, struct audio_node_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+	stats->node = node;
+	profile_read(&node->profile.inclusive, &stats->inclusive);
+	profile_read(&node->profile.exclusive, &stats->exclusive);
+
+	k_spin_unlock(&profile_lock, key);
+}
+
+void audio_profile_node_reset(struct audio_node *node)
+{
+	k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+	memset(&node->profile.inclusive, 0, sizeof(node->profile.inclusive));
+	memset(&node->profile.exclusive, 0, sizeof(node->profile.exclusive));
+
+	k_spin_unlock(&profile_lock, key);
+}
+
+void audio_profile_frame_read(const struct audio_pipeline *pipeline,
+			      struct audio_pipeline_stats *stats)
+{
+	const struct audio_pipeline_profile *profile = &pipeline->profile;
+	k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+	profile_read(&profile->frame, &stats->frame);
+	stats->budget_cycles = profile->budget_cycles;
+	stats->over_budget = profile->over_budget;
+
+	k_spin_unlock(&profile_lock, key);
+}
+
+void audio_profile_frame_reset(struct audio_pipeline *pipeline)
+{
+	k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+	memset(&pipeline->profile.frame, 0, sizeof(pipeline->profile.frame));
+	pipeline->profile.over_budget = 0U;
+
+	k_spin_unlock(&profile_lock, key);
+}
+
+void audio_profile_start(struct audio_pipeline *pipeline)
+{
+	const struct audio_stream_config *fmt = &pipeline->format;
+	uint64_t budget = 0U;
+
+	/* One full frame's worth of sample sets, at the bound rate. */
+	if (fmt->sample_rate_hz != 0U && fmt->channels != 0U) {
+		budget = (uint64_t)(pipeline->frame_capacity / fmt->channels) *
+			 (uint64_t)sys_clock_hw_cycles_per_sec() / fmt->sample_rate_hz;
+	}
+
+	pipeline->profile.budget_cycles = (uint32_t)MIN(budget, (uint64_t)UINT32_MAX);
+	(void)audio_pipeline_reset_stats(pipeline);
+
+	(void)k_mutex_lock(&profile_list_lock, K_FOREVER);
+	if (!pipeline->profile.listed) {
+		sys_slist_append(&profile_list, &pipeline->profile.entry);
+		pipeline->profile.listed = true;
+	}
+	(void)k_mutex_unlock(&profile_list_lock);
+}
+
+void audio_profile_join(struct audio_pipeline *pipeline)
+{
+	(void)k_mutex_lock(&profile_list_lock, K_FOREVER);
+	if (pipeline->profile.listed) {
+		(void)sys_slist_find_and_remove(&profile_list, &pipeline->profile.entry);
+		pipeline->profile.listed = false;
+	}
+	(void)k_mutex_unlock(&profile_list_lock);
+}
+
+void audio_profile_foreach(void (*cb)(struct audio_pipeline *pipeline, void *user), void *user)
+{
+	struct audio_pipeline *pipeline;
+
+	(void)k_mutex_lock(&profile_list_lock, K_FOREVER);
+	SYS_SLIST_FOR_EACH_CONTAINER(&profile_list, pipeline, profile.entry) {
+		cb(pipeline, user);
+	}
+	(void)k_mutex_unlock(&profile_list_lock);
+}
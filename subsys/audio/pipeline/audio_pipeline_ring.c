@@ -0,0 +1,339 @@
+/*
+ * Two-stage pipelines: a producer thread fills a ring of frames from the split
+ * node upwards while the worker drains it through the rest of the chain, so a
+ * blocking sink overlaps the source and filters instead of serialising with
+ * them (spec §3.5).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+
+#include "audio_internal.h"
+
+LOG_MODULE_REGISTER(audio_pipeline_ring, LOG_LEVEL_INF);
+
+static int32_t *ring_slot_data(const struct audio_pipeline *pipeline, size_t slot)
+{
+	return pipeline->frame_buf + slot * pipeline->ring.stride;
+}
+
+/*
+ * Open runs before every node above the split, close before every node above
+ * it as well, because both walk from the sink. That is what makes the pair the
+ * place to fence the producer: after close() has taken the stage lock once, the
+ * producer has finished the pull it may have been in and pulls nothing more
+ * until the next open().
+ */
+static int ring_node_open(struct audio_node *node)
+{
+	struct audio_pipeline *pipeline = node->state;
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+	size_t i;
+
+	(void)k_mutex_lock(&ring->stage_lock, K_FOREVER);
+
+	/* A fresh ring per open: whatever a run that ended in an error left in
+	 * it belongs to a stream that is gone. Resetting @c free wakes a
+	 * producer that was a whole ring ahead; it takes a slot again below.
+	 */
+	k_sem_reset(&ring->full);
+	k_sem_reset(&ring->free);
+	for (i = 0; i < ring->depth; i++) {
+		k_sem_give(&ring->free);
+	}
+
+	ring->head = 0U;
+	ring->tail = 0U;
+	ring->held = 0U;
+	ring->pulled = 0U;
+	atomic_clear(&ring->ended);
+	ring->open = true;
+
+	(void)k_mutex_unlock(&ring->stage_lock);
+
+	return 0;
+}
+
+static int ring_node_close(struct audio_node *node)
+{
+	struct audio_pipeline *pipeline = node->state;
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	(void)k_mutex_lock(&ring->stage_lock, K_FOREVER);
+	ring->open = false;
+	(void)k_mutex_unlock(&ring->stage_lock);
+
+	return 0;
+}
+
+/*
+ * The source of the consumer stage. The first pull of a frame returns the slot
+ * audio_pipeline_ring_acquire() handed the worker - in place when the caller
+ * passed that slot down, which every node that filters in place does. A node
+ * that pulls more than once per frame gets the following slots copied into its
+ * buffer; all of them go back to the producer when the frame is done.
+ */
+static int ring_node_process(struct audio_node *node, struct audio_buffer_view *buf,
+			     size_t *out_size)
+{
+	struct audio_pipeline *pipeline = node->state;
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+	const struct audio_pipeline_ring_slot *slot;
+	int32_t *data;
+	size_t index;
+
+	*out_size = 0;
+
+	if (ring->pulled == ring->held) {
+		/* Every slot this frame holds has been delivered. Holding the
+		 * whole ring would leave the producer nowhere to write the one
+		 * asked for, so that is refused rather than waited for.
+		 */
+		if (ring->held >= ring->depth) {
+			LOG_ERR("consumer stage pulled more frames than the ring holds");
+			return -ENOBUFS;
+		}
+
+		if (audio_pipeline_ring_acquire(pipeline, &data) < 0) {
+			return -ECANCELED;
+		}
+	}
+
+	index = (ring->tail + ring->pulled) % ring->depth;
+	ring->pulled++;
+
+	slot = &ring->slots[index];
+	if (slot->status == -EPIPE) {
+		return 0;
+	}
+
+	if (slot->status < 0) {
+		return slot->status;
+	}
+
+	*out_size = MIN(slot->size, buf->capacity);
+
+	data = ring_slot_data(pipeline, index);
+	if (buf->data != data) {
+		memcpy(buf->data, data, *out_size * sizeof(int32_t));
+	}
+
+	return 0;
+}
+
+static const struct audio_node_ops ring_node_ops = {
+	.open = ring_node_open,
+	.process = ring_node_process,
+	.close = ring_node_close,
+};
+
+/* Pull the producer stage once into the head slot and queue the result. */
+static void ring_produce(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+	struct audio_pipeline_ring_slot *slot;
+	struct audio_buffer_view view;
+	size_t size = 0U;
+	int ret;
+
+	(void)k_mutex_lock(&ring->stage_lock, K_FOREVER);
+
+	if (!ring->open) {
+		/* The chain came down while this thread waited for the slot.
+		 * The state no longer says PLAYING, so the loop parks.
+		 */
+		(void)k_mutex_unlock(&ring->stage_lock);
+		k_sem_give(&ring->free);
+		return;
+	}
+
+	slot = &ring->slots[ring->head];
+	view.data = ring_slot_data(pipeline, ring->head);
+	view.capacity = pipeline->frame_capacity;
+
+	ret = audio_node_process(pipeline->config->split, &view, &size);
+
+	(void)k_mutex_unlock(&ring->stage_lock);
+
+	if (ret < 0) {
+		/* -EPIPE is the ring's own end marker, exactly as it is
+		 * audio_pipeline_process_frame()'s.
+		 */
+		slot->status = audio_eof_safe_errno(ret);
+		slot->size = 0U;
+	} else if (size == 0U) {
+		slot->status = -EPIPE;
+		slot->size = 0U;
+	} else {
+		slot->status = 0;
+		slot->size = size;
+	}
+
+	/* Before the slot is published: the worker reaching the end of the
+	 * stream is what lets the application play() the next track, and that
+	 * play() must find the producer parked, not about to park.
+	 */
+	if (slot->status != 0) {
+		atomic_set(&ring->ended, 1);
+	}
+
+	ring->head = (ring->head + 1U) % ring->depth;
+	k_sem_give(&ring->full);
+}
+
+/*
+ * Mirrors the worker: idles while the pipeline is not playing, and after it
+ * queued an end of stream or an error, until play() releases it; leaves only
+ * on join().
+ */
+static void ring_producer_thread(void *p1, void *p2, void *p3)
+{
+	struct audio_pipeline *pipeline = p1;
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!atomic_get(&pipeline->quit_request)) {
+		if (audio_pipeline_state_get(pipeline) != AUDIO_PIPELINE_STATE_PLAYING ||
+		    atomic_get(&ring->ended)) {
+			(void)k_sem_take(&ring->producer_wake, K_FOREVER);
+			continue;
+		}
+
+		/* A whole ring ahead of the worker. Fails when a reopen resets
+		 * the ring under the wait, which simply means "look again".
+		 */
+		if (k_sem_take(&ring->free, K_FOREVER) != 0) {
+			continue;
+		}
+
+		if (atomic_get(&pipeline->quit_request)) {
+			break;
+		}
+
+		ring_produce(pipeline);
+	}
+}
+
+int audio_pipeline_ring_wire(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+	struct audio_node *split = pipeline->config->split;
+	struct audio_node *node = pipeline->sink;
+	unsigned int depth = 0;
+
+	/* Find the consumer node that pulls from the split; the sink itself
+	 * cannot be the split, or the consumer stage would be empty.
+	 */
+	while (node != NULL && node->upstream != split) {
+		if (++depth > AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
+			node = NULL;
+			break;
+		}
+
+		node = node->upstream;
+	}
+
+	if (node == NULL) {
+		LOG_ERR("the split node is not upstream of the sink");
+		return -EINVAL;
+	}
+
+	ring->node.role = AUDIO_NODE_ROLE_SOURCE;
+	ring->node.ops = &ring_node_ops;
+	ring->node.upstream = split;
+	ring->node.state = pipeline;
+#ifdef CONFIG_AUDIO_PIPELINE_PROFILING
+	/* Its exclusive cycles are the consumer waiting on the producer. */
+	ring->node.name = "ring";
+#endif
+	ring->below = node;
+	node->upstream = &ring->node;
+
+	(void)k_mutex_init(&ring->stage_lock);
+	k_sem_init(&ring->free, ring->depth, ring->depth);
+	k_sem_init(&ring->full, 0, ring->depth);
+	k_sem_init(&ring->producer_wake, 0, 1);
+	ring->open = false;
+
+	return 0;
+}
+
+void audio_pipeline_ring_unwire(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	if (ring->below != NULL) {
+		ring->below->upstream = ring->node.upstream;
+		ring->below = NULL;
+	}
+}
+
+void audio_pipeline_ring_start(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	k_thread_create(&ring->thread, ring->stack, ring->stack_size, ring_producer_thread,
+			pipeline, NULL, NULL, pipeline->priority, 0, K_NO_WAIT);
+	k_thread_name_set(&ring->thread, "audio_producer");
+}
+
+void audio_pipeline_ring_play(struct audio_pipeline *pipeline)
+{
+	atomic_clear(&pipeline->ring.ended);
+	k_sem_give(&pipeline->ring.producer_wake);
+}
+
+void audio_pipeline_ring_join(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	/* quit_request is set. Every wait either thread can be in is released
+	 * once; the counts do not matter any more, the next open() resets them.
+	 */
+	k_sem_give(&ring->producer_wake);
+	k_sem_give(&ring->free);
+	k_sem_give(&ring->full);
+
+	(void)k_thread_join(&ring->thread, K_FOREVER);
+}
+
+int audio_pipeline_ring_acquire(struct audio_pipeline *pipeline, int32_t **data)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	(void)k_sem_take(&ring->full, K_FOREVER);
+
+	if (atomic_get(&pipeline->quit_request)) {
+		return -ECANCELED;
+	}
+
+	*data = ring_slot_data(pipeline, (ring->tail + ring->held) % ring->depth);
+	ring->held++;
+
+	return 0;
+}
+
+void audio_pipeline_ring_release(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_ring *ring = &pipeline->ring;
+
+	while (ring->held > 0U) {
+		ring->tail = (ring->tail + 1U) % ring->depth;
+		ring->held--;
+		k_sem_give(&ring->free);
+	}
+
+	ring->pulled = 0U;
+}
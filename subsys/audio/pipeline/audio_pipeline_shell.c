@@ -0,0 +1,147 @@
+/*
+ * Shell dump of the cycle profile: every started pipeline, its frame against
+ * the frame budget, and each node of its chain split into inclusive and
+ * exclusive cycles (spec §8.4).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/time_units.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+
+#include "audio_internal.h"
+
+#define UNNAMED "-"
+
+static void print_histogram(const struct shell *sh, const struct audio_profile_stats *stats)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(stats->histogram); i++) {
+		if (stats->histogram[i] == 0U) {
+			continue;
+		}
+
+		if (i == ARRAY_SIZE(stats->histogram) - 1U) {
+			shell_print(sh, "      >= %10u cyc: %u", 1U << i, stats->histogram[i]);
+		} else {
+			shell_print(sh, "      <  %10u cyc: %u", 2U << i, stats->histogram[i]);
+		}
+	}
+}
+
+/* What one dump prints, handed through audio_profile_foreach(). */
+struct dump_ctx {
+	const struct shell *sh;
+	bool histograms;
+};
+
+static void print_node(const struct dump_ctx *ctx, const struct audio_node *node)
+{
+	struct audio_node_stats stats;
+
+	if (audio_node_get_stats(node, &stats) < 0) {
+		return;
+	}
+
+	shell_print(ctx->sh, "  %-20s %8u %10u %10u %10u %10u",
+		    node->name != NULL ? node->name : UNNAMED, stats.inclusive.count,
+		    stats.inclusive.avg_cycles, stats.exclusive.min_cycles,
+		    stats.exclusive.avg_cycles, stats.exclusive.max_cycles);
+	if (ctx->histograms) {
+		print_histogram(ctx->sh, &stats.exclusive);
+	}
+}
+
+static void print_pipeline(struct audio_pipeline *pipeline, void *user)
+{
+	const struct dump_ctx *ctx = user;
+	struct audio_pipeline_stats stats;
+	const struct audio_node *node;
+	unsigned int depth = 0;
+
+	if (audio_pipeline_get_stats(pipeline, &stats, NULL, NULL) < 0) {
+		return;
+	}
+
+	shell_print(ctx->sh,
+		    "%s: %u frames, avg %u / max %u cyc of a %u cyc budget (%u us), %u over",
+		    pipeline->name != NULL ? pipeline->name : UNNAMED, stats.frame.count,
+		    stats.frame.avg_cycles, stats.frame.max_cycles, stats.budget_cycles,
+		    k_cyc_to_us_floor32(stats.budget_cycles), stats.over_budget);
+	if (ctx->histograms) {
+		print_histogram(ctx->sh, &stats.frame);
+	}
+
+	shell_print(ctx->sh, "  %-20s %8s %10s %10s %10s %10s", "node", "calls", "incl avg",
+		    "excl min", "excl avg", "excl max");
+
+	/* One node at a time rather than through audio_pipeline_get_stats(),
+	 * so a chain of any depth costs the shell stack one stats object.
+	 */
+	for (node = pipeline->sink; node != NULL && depth < AUDIO_PIPELINE_MAX_CHAIN_DEPTH;
+	     node = node->upstream, depth++) {
+		print_node(ctx, node);
+	}
+}
+
+static void reset_pipeline(struct audio_pipeline *pipeline, void *user)
+{
+	ARG_UNUSED(user);
+
+	(void)audio_pipeline_reset_stats(pipeline);
+}
+
+static int dump(const struct shell *sh, bool histograms)
+{
+	struct dump_ctx ctx = {
+		.sh = sh,
+		.histograms = histograms,
+	};
+
+	shell_print(sh, "cycle counter: %u Hz", sys_clock_hw_cycles_per_sec());
+	audio_profile_foreach(print_pipeline, &ctx);
+
+	return 0;
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	return dump(sh, false);
+}
+
+static int cmd_hist(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	return dump(sh, true);
+}
+
+static int cmd_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(sh);
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	audio_profile_foreach(reset_pipeline, NULL);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	audio_pipeline_cmds,
+	SHELL_CMD(stats, NULL, "Frame and per-node cycles of every started pipeline", cmd_stats),
+	SHELL_CMD(hist, NULL, "The same with the exclusive-cycle histograms", cmd_hist),
+	SHELL_CMD(reset, NULL, "Forget every profile", cmd_reset),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(audio_pipeline, &audio_pipeline_cmds, "Audio pipeline profile", NULL);
@@ -23,6 +23,9 @@
 #define CHUNK_HEADER_SIZE 8U
 /* Size of the PCM flavour of the "fmt " chunk body */
 #define FMT_CHUNK_MIN_SIZE 16U
+/* Size of the WAVE_FORMAT_EXTENSIBLE flavour, and of the extension in it */
+#define FMT_CHUNK_EXTENSIBLE_SIZE 40U
+#define FMT_EXTENSION_SIZE	  22U
 /* Highest bit depth the canonical S32_LE container can hold */
 #define MAX_BITS_PER_SAMPLE 32U
 
@@ -33,6 +36,11 @@
 #define FMT_OFF_BYTE_RATE	8U
 #define FMT_OFF_BLOCK_ALIGN	12U
 #define FMT_OFF_BITS_PER_SAMPLE 14U
+/* ... and of the extension WAVE_FORMAT_EXTENSIBLE appends to it */
+#define FMT_OFF_EXTENSION_SIZE	16U
+#define FMT_OFF_VALID_BITS	18U
+#define FMT_OFF_CHANNEL_MASK	20U
+#define FMT_OFF_SUBFORMAT	24U
 
 /*
  * Field offsets inside the canonical header the writer emits. The parser walks
@@ -45,11 +53,27 @@
 #define HDR_OFF_FMT_ID	  12U
 #define HDR_OFF_FMT_SIZE  16U
 #define HDR_OFF_FMT_BODY  20U
-#define HDR_OFF_DATA_ID	  36U
-#define HDR_OFF_DATA_SIZE 40U
 
-/* Header bytes counted by the RIFF size field: everything after it. */
-#define RIFF_SIZE_OVERHEAD (AUDIO_WAV_MIN_HEADER_SIZE - 8U)
+/* The "data" chunk header follows the "fmt " body, whichever size that is. */
+#define HDR_OFF_DATA_ID(fmt_size)   (HDR_OFF_FMT_BODY + (fmt_size))
+#define HDR_OFF_DATA_SIZE(fmt_size) (HDR_OFF_DATA_ID(fmt_size) + 4U)
+
+/* Bits of a float sample, the one depth the parser reads float at. */
+#define FLOAT_BITS_PER_SAMPLE 32U
+
+/*
+ * The GUID an extensible "fmt " names its sub-format by, less its first two
+ * bytes: those are the format tag of the sub-format - KSDATAFORMAT_SUBTYPE_PCM
+ * starts with WAVE_FORMAT_PCM, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT with
+ * WAVE_FORMAT_IEEE_FLOAT - and the other fourteen are the same for every one
+ * of them. A file that changes those names something else whatever its first
+ * two bytes say.
+ */
+#define SUBFORMAT_TAG_SIZE 2U
+static const uint8_t subformat_tail[14] = {
+	0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+	0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71,
+};
 
 static bool tag_matches(const uint8_t *data, const char *tag)
 {
@@ -88,6 +112,37 @@ static uint16_t block_align_of(uint16_t channels, uint16_t bits_per_sample)
 	return (uint16_t)(channels * (bits_per_sample / 8U));
 }
 
+static uint32_t fmt_size_of(uint16_t format_tag)
+{
+	return format_tag == AUDIO_WAV_FORMAT_EXTENSIBLE ? FMT_CHUNK_EXTENSIBLE_SIZE
+							 : FMT_CHUNK_MIN_SIZE;
+}
+
+/*
+ * The part of an extensible "fmt " past the PCM one. What sub-format it names
+ * is the first question - a header that cannot say is as unplayable here as
+ * one that names something else - so a short extension is -ENOTSUP, not
+ * -EINVAL.
+ */
+static int parse_fmt_extension(const uint8_t *body, uint32_t size, struct audio_wav_header *out)
+{
+	if (size < FMT_CHUNK_EXTENSIBLE_SIZE ||
+	    sys_get_le16(&body[FMT_OFF_EXTENSION_SIZE]) < FMT_EXTENSION_SIZE) {
+		return -ENOTSUP;
+	}
+
+	if (memcmp(&body[FMT_OFF_SUBFORMAT + SUBFORMAT_TAG_SIZE], subformat_tail,
+		   sizeof(subformat_tail)) != 0) {
+		return -ENOTSUP;
+	}
+
+	out->subformat_tag = sys_get_le16(&body[FMT_OFF_SUBFORMAT]);
+	out->valid_bits_per_sample = sys_get_le16(&body[FMT_OFF_VALID_BITS]);
+	out->channel_mask = sys_get_le32(&body[FMT_OFF_CHANNEL_MASK]);
+
+	return 0;
+}
+
 static int parse_fmt_chunk(const uint8_t *body, uint32_t size, struct audio_wav_header *out)
 {
 	if (size < FMT_CHUNK_MIN_SIZE) {
@@ -99,8 +154,28 @@ static int parse_fmt_chunk(const uint8_t *body, uint32_t size, struct audio_wav_
 	out->sample_rate_hz = sys_get_le32(&body[FMT_OFF_SAMPLE_RATE]);
 	out->block_align = sys_get_le16(&body[FMT_OFF_BLOCK_ALIGN]);
 	out->bits_per_sample = sys_get_le16(&body[FMT_OFF_BITS_PER_SAMPLE]);
+	out->subformat_tag = out->format_tag;
+	out->valid_bits_per_sample = 0U;
+	out->channel_mask = 0U;
 
-	if (out->format_tag != AUDIO_WAV_FORMAT_PCM) {
+	if (out->format_tag == AUDIO_WAV_FORMAT_EXTENSIBLE) {
+		int err = parse_fmt_extension(body, size, out);
+
+		if (err != 0) {
+			return err;
+		}
+	}
+
+	if (out->subformat_tag != AUDIO_WAV_FORMAT_PCM &&
+	    out->subformat_tag != AUDIO_WAV_FORMAT_IEEE_FLOAT) {
+		return -ENOTSUP;
+	}
+
+	/* Asked before the depth is judged usable, so a file of doubles is one
+	 * this module does not read rather than a corrupt one.
+	 */
+	if (out->subformat_tag == AUDIO_WAV_FORMAT_IEEE_FLOAT &&
+	    out->bits_per_sample != FLOAT_BITS_PER_SAMPLE) {
 		return -ENOTSUP;
 	}
 
@@ -112,6 +187,15 @@ static int parse_fmt_chunk(const uint8_t *body, uint32_t size, struct audio_wav_
 		return -EINVAL;
 	}
 
+	/* Writers that do not care leave the valid bit count at 0; it means the
+	 * whole sample, which is also all a plain PCM header can say.
+	 */
+	if (out->valid_bits_per_sample == 0U) {
+		out->valid_bits_per_sample = out->bits_per_sample;
+	} else if (out->valid_bits_per_sample > out->bits_per_sample) {
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
@@ -193,19 +277,32 @@ int audio_wav_read_header(const uint8_t *data, size_t len, struct audio_wav_head
 	return 0;
 }
 
+size_t audio_wav_header_size(const struct audio_wav_header *hdr)
+{
+	return AUDIO_WAV_MIN_HEADER_SIZE - FMT_CHUNK_MIN_SIZE + fmt_size_of(hdr->format_tag);
+}
+
+uint32_t audio_wav_max_data_size(const struct audio_wav_header *hdr)
+{
+	return AUDIO_WAV_MAX_DATA_SIZE -
+	       (uint32_t)(audio_wav_header_size(hdr) - AUDIO_WAV_MIN_HEADER_SIZE);
+}
+
 int audio_wav_write_header(uint8_t *buf, size_t len, const struct audio_wav_header *hdr)
 {
+	uint32_t fmt_size;
 	uint16_t block_align;
 
-	if (buf == NULL || hdr == NULL || len < AUDIO_WAV_MIN_HEADER_SIZE) {
+	if (buf == NULL || hdr == NULL || len < audio_wav_header_size(hdr)) {
 		return -EINVAL;
 	}
 
-	if (!format_is_usable(hdr->sample_rate_hz, hdr->channels, hdr->bits_per_sample)) {
+	if (!format_is_usable(hdr->sample_rate_hz, hdr->channels, hdr->bits_per_sample) ||
+	    hdr->valid_bits_per_sample > hdr->bits_per_sample) {
 		return -EINVAL;
 	}
 
-	if (hdr->data_size > AUDIO_WAV_MAX_DATA_SIZE) {
+	if (hdr->data_size > audio_wav_max_data_size(hdr)) {
 		/* The RIFF size field counts the payload plus the header bytes
 		 * behind it, so anything larger would wrap around and describe
 		 * an almost empty file.
@@ -213,17 +310,19 @@ int audio_wav_write_header(uint8_t *buf, size_t len, const struct audio_wav_head
 		return -EFBIG;
 	}
 
+	fmt_size = fmt_size_of(hdr->format_tag);
 	block_align = block_align_of(hdr->channels, hdr->bits_per_sample);
 
 	/* Everything goes out little endian explicitly, so a big endian host
 	 * produces the same file.
 	 */
 	memcpy(&buf[HDR_OFF_RIFF_ID], "RIFF", 4);
-	sys_put_le32(RIFF_SIZE_OVERHEAD + hdr->data_size, &buf[HDR_OFF_RIFF_SIZE]);
+	sys_put_le32((uint32_t)audio_wav_header_size(hdr) - 8U + hdr->data_size,
+		     &buf[HDR_OFF_RIFF_SIZE]);
 	memcpy(&buf[HDR_OFF_WAVE_ID], "WAVE", 4);
 
 	memcpy(&buf[HDR_OFF_FMT_ID], "fmt ", 4);
-	sys_put_le32(FMT_CHUNK_MIN_SIZE, &buf[HDR_OFF_FMT_SIZE]);
+	sys_put_le32(fmt_size, &buf[HDR_OFF_FMT_SIZE]);
 	sys_put_le16(hdr->format_tag, &buf[HDR_OFF_FMT_BODY + FMT_OFF_FORMAT_TAG]);
 	sys_put_le16(hdr->channels, &buf[HDR_OFF_FMT_BODY + FMT_OFF_CHANNELS]);
 	sys_put_le32(hdr->sample_rate_hz, &buf[HDR_OFF_FMT_BODY + FMT_OFF_SAMPLE_RATE]);
@@ -231,8 +330,22 @@ int audio_wav_write_header(uint8_t *buf, size_t len, const struct audio_wav_head
 	sys_put_le16(block_align, &buf[HDR_OFF_FMT_BODY + FMT_OFF_BLOCK_ALIGN]);
 	sys_put_le16(hdr->bits_per_sample, &buf[HDR_OFF_FMT_BODY + FMT_OFF_BITS_PER_SAMPLE]);
 
-	memcpy(&buf[HDR_OFF_DATA_ID], "data", 4);
-	sys_put_le32(hdr->data_size, &buf[HDR_OFF_DATA_SIZE]);
+	if (hdr->format_tag == AUDIO_WAV_FORMAT_EXTENSIBLE) {
+		uint8_t *ext = &buf[HDR_OFF_FMT_BODY];
+
+		sys_put_le16(FMT_EXTENSION_SIZE, &ext[FMT_OFF_EXTENSION_SIZE]);
+		sys_put_le16(hdr->valid_bits_per_sample != 0U ? hdr->valid_bits_per_sample
+							       : hdr->bits_per_sample,
+			     &ext[FMT_OFF_VALID_BITS]);
+		sys_put_le32(hdr->channel_mask, &ext[FMT_OFF_CHANNEL_MASK]);
+		sys_put_le16(hdr->subformat_tag != 0U ? hdr->subformat_tag : AUDIO_WAV_FORMAT_PCM,
+			     &ext[FMT_OFF_SUBFORMAT]);
+		memcpy(&ext[FMT_OFF_SUBFORMAT + SUBFORMAT_TAG_SIZE], subformat_tail,
+		       sizeof(subformat_tail));
+	}
+
+	memcpy(&buf[HDR_OFF_DATA_ID(fmt_size)], "data", 4);
+	sys_put_le32(hdr->data_size, &buf[HDR_OFF_DATA_SIZE(fmt_size)]);
 
 	return 0;
 }
@@ -0,0 +1,210 @@
+/*
+ * Biquad filter node.
+ *
+ * Runs every channel of the frame it pulls through a cascade of second-order
+ * IIR sections, in place (spec §10.9). The arithmetic is the shared biquad
+ * kernel's (spec §5.4): direct form I with Q4.28 coefficients and a 64-bit
+ * accumulator, one call per stage, so the node is the pull, the stages in
+ * order, and the bookkeeping of whose history is whose.
+ *
+ * The coefficients are constants of the definition and are shared by every
+ * channel; the history is per stage and per channel, because a channel's past
+ * is the only thing a recurrence may not share. open() clears it, so a run
+ * never starts with the tail of the previous one ringing out of it.
+ *
+ * Planar frames (spec §5.2) are taken as well: each channel's run goes through
+ * the kernel's one-channel loop on its own, contiguous, instead of every
+ * channel being picked out of the sample sets at a stride.
+ *
+ * With CONFIG_AUDIO_PIPELINE_FLOAT the node takes F32 frames too, between the
+ * float converter nodes (spec §10.14), and runs the float kernel, transposed
+ * direct form II, on the same stages: open() rounds them to floats once. The
+ * two forms keep separate history, so a run in either starts from silence.
+ *
+ * The one check that cannot be done at build time is the coefficient bound
+ * the kernel relies on: open() refuses a stage whose magnitudes sum to 16 or
+ * more, which is the point past which the accumulator could overflow.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+LOG_MODULE_REGISTER(audio_biquad, LOG_LEVEL_INF);
+
+static int biquad_open(struct audio_node *node)
+{
+	struct audio_biquad_state *state = (struct audio_biquad_state *)node->state;
+	const struct audio_stream_config *fmt;
+	uint8_t stage;
+
+	if (!state || !state->stages || !state->history || state->stage_count == 0U) {
+		return -EINVAL;
+	}
+
+	/* The history is per channel, so the node needs the bound format to
+	 * know how many there are (spec §5.2).
+	 */
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	if (fmt->channels == 0U || fmt->channels > AUDIO_BIQUAD_MAX_CHANNELS) {
+		LOG_ERR("%u channels, the node keeps history for 1..%u", fmt->channels,
+			AUDIO_BIQUAD_MAX_CHANNELS);
+		return -ENOTSUP;
+	}
+
+	for (stage = 0U; stage < state->stage_count; stage++) {
+		if (!audio_dsp_biquad_is_bounded(&state->stages[stage])) {
+			LOG_ERR("stage %u: coefficient magnitudes sum to 16 or more", stage);
+			return -EINVAL;
+		}
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	if (fmt->format == AUDIO_SAMPLE_FORMAT_F32_LE) {
+		if (!state->stages_f32 || !state->history_f32) {
+			return -EINVAL;
+		}
+
+		for (stage = 0U; stage < state->stage_count; stage++) {
+			audio_dsp_biquad_to_f32(&state->stages[stage], &state->stages_f32[stage]);
+		}
+		memset(state->history_f32, 0,
+		       sizeof(state->history_f32[0]) * state->stage_count);
+	}
+#endif
+
+	memset(state->history, 0, sizeof(state->history[0]) * state->stage_count);
+	state->is_open = true;
+
+	return 0;
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+/* process() on an F32 frame of @p count samples: the same walk, in floats. */
+static void biquad_process_f32(struct audio_biquad_state *state,
+			       const struct audio_stream_config *fmt,
+			       const struct audio_buffer_view *buf, size_t count)
+{
+	const size_t channels = fmt->channels;
+	size_t plane;
+	uint8_t stage;
+	size_t c;
+
+	if (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR && channels > 1U) {
+		plane = audio_frame_channel_stride(fmt, buf);
+		for (stage = 0U; stage < state->stage_count; stage++) {
+			for (c = 0; c < channels; c++) {
+				audio_dsp_biquad_f32(&buf->data_f32[c * plane], count / channels,
+						     &state->stages_f32[stage],
+						     &state->history_f32[stage][c], 1U);
+			}
+		}
+		return;
+	}
+
+	for (stage = 0U; stage < state->stage_count; stage++) {
+		audio_dsp_biquad_f32(buf->data_f32, count, &state->stages_f32[stage],
+				     state->history_f32[stage], channels);
+	}
+}
+#endif
+
+static int biquad_process(struct audio_node *node, struct audio_buffer_view *buf,
+			  size_t *out_size)
+{
+	struct audio_biquad_state *state;
+	const struct audio_stream_config *fmt;
+	size_t channels;
+	size_t plane;
+	size_t sets;
+	uint8_t stage;
+	size_t c;
+	int ret;
+
+	if (!node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_biquad_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open || !node->pipeline_format) {
+		LOG_ERR("process() on a closed biquad");
+		return -EBADF;
+	}
+
+	ret = audio_node_pull(node, buf, out_size);
+	if (ret < 0 || *out_size == 0) {
+		return ret;
+	}
+
+	/* A frame is whole sample sets (spec §5.2), so sample 0 is channel 0
+	 * and history[stage][c] follows channel c from frame to frame.
+	 */
+	fmt = node->pipeline_format;
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	if (fmt->format == AUDIO_SAMPLE_FORMAT_F32_LE) {
+		biquad_process_f32(state, fmt, buf, *out_size);
+		return 0;
+	}
+#endif
+
+	channels = fmt->channels;
+	if (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR && channels > 1U) {
+		plane = audio_frame_channel_stride(fmt, buf);
+		sets = *out_size / channels;
+		for (stage = 0U; stage < state->stage_count; stage++) {
+			for (c = 0; c < channels; c++) {
+				audio_dsp_biquad_q31(&buf->data[c * plane], sets,
+						     &state->stages[stage],
+						     &state->history[stage][c], 1U);
+			}
+		}
+		return 0;
+	}
+
+	for (stage = 0U; stage < state->stage_count; stage++) {
+		audio_dsp_biquad_q31(buf->data, *out_size, &state->stages[stage],
+				     state->history[stage], channels);
+	}
+
+	return 0;
+}
+
+static int biquad_close(struct audio_node *node)
+{
+	struct audio_biquad_state *state = (struct audio_biquad_state *)node->state;
+
+	if (state) {
+		state->is_open = false;
+	}
+
+	return 0;
+}
+
+const struct audio_node_ops biquad_node_ops = {
+	.open = biquad_open,
+	.process = biquad_process,
+	.close = biquad_close,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED) |
+		   AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	.formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE) |
+		   AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_F32_LE),
+#endif
+};
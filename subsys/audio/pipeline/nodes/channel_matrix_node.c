@@ -0,0 +1,215 @@
+/*
+ * Channel matrix node.
+ *
+ * Makes every output channel of a sample set from the input channels of the
+ * same set through a matrix of Q15 gains fixed by its definition (spec
+ * §10.12): mono duplicated for a stereo-only sink, stereo averaged for a
+ * speech path, a multichannel downmix, two channels swapped. When the counts
+ * differ it is the chain's converter, like the resampler: open() publishes
+ * its own format with the input channel count as audio_node.upstream_format,
+ * and the walk that opened it installs that on every node upstream (spec
+ * §5.2). The arithmetic is the shared matrix kernel's (spec §5.4), which has
+ * a loop of its own for the matrices that need no multiply.
+ *
+ * A set in and a set out take the same time, so a frame below is a frame of
+ * as many sets above, and the only question is where the input lands. With
+ * no more channels above than below it fits the frame it is pulled for, and
+ * the kernel widens it there, back to front. With more, it does not fit, so
+ * it is pulled into a frame of input of the node's own and narrowed from
+ * there into the frame below - one pull per frame whenever the pipeline's
+ * frame is the one the definition sized that input for.
+ *
+ * The gains are a const table of the definition; open() works out the plan
+ * the kernel runs with from them and refuses one past the accumulator's
+ * bound, the one check that cannot be made at build time.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+LOG_MODULE_REGISTER(audio_channel_matrix, LOG_LEVEL_INF);
+
+static int channel_matrix_open(struct audio_node *node)
+{
+	struct audio_channel_matrix_state *state = (struct audio_channel_matrix_state *)node->state;
+	struct audio_dsp_matrix *matrix;
+	const struct audio_stream_config *fmt;
+
+	if (!state || !state->matrix.coeffs_q15 || !state->input ||
+	    state->matrix.in_channels == 0U || state->matrix.out_channels == 0U ||
+	    state->matrix.in_channels > AUDIO_DSP_MATRIX_MAX_CHANNELS ||
+	    state->matrix.out_channels > AUDIO_DSP_MATRIX_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	matrix = &state->matrix;
+
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	/* The matrix makes exactly its own channel count; a stream of any
+	 * other below is a wiring statement that no longer holds.
+	 */
+	if (fmt->channels != matrix->out_channels) {
+		LOG_ERR("%u channels below, the matrix makes %u", fmt->channels,
+			matrix->out_channels);
+		return -ENOTSUP;
+	}
+
+	if (!audio_dsp_matrix_is_bounded(matrix->coeffs_q15,
+					 (size_t)matrix->in_channels * matrix->out_channels)) {
+		LOG_ERR("a gain is past %d either way", AUDIO_DSP_MATRIX_MAX_GAIN_Q15);
+		return -EINVAL;
+	}
+
+	audio_dsp_matrix_prepare(matrix);
+
+	/* The same count either side declares no segment of its own, so the
+	 * chain above runs on the format below, lending included.
+	 */
+	state->passthrough = matrix->kind == AUDIO_DSP_MATRIX_IDENTITY;
+	if (matrix->in_channels != matrix->out_channels) {
+		state->input_format = *fmt;
+		state->input_format.channels = matrix->in_channels;
+		node->upstream_format = &state->input_format;
+	}
+
+	state->is_open = true;
+
+	return 0;
+}
+
+/* Pull up to @p sets sets of @p in channels into @p data, and count them. */
+static int channel_matrix_pull(struct audio_node *node, int32_t *data, size_t sets, size_t in,
+			       size_t *got_sets)
+{
+	struct audio_buffer_view view = {
+		.data = data,
+		.capacity = sets * in,
+	};
+	size_t got;
+	int ret;
+
+	ret = audio_node_pull(node, &view, &got);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (got % in != 0U) {
+		LOG_ERR("upstream produced %zu samples, not whole %zu-channel sets", got, in);
+		return -EINVAL;
+	}
+
+	*got_sets = got / in;
+
+	return 0;
+}
+
+static int channel_matrix_process(struct audio_node *node, struct audio_buffer_view *buf,
+				  size_t *out_size)
+{
+	struct audio_channel_matrix_state *state;
+	const struct audio_dsp_matrix *matrix;
+	size_t in;
+	size_t out;
+	size_t sets;
+	size_t done = 0;
+	size_t got;
+	int ret;
+
+	if (!node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_channel_matrix_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open || !node->pipeline_format) {
+		LOG_ERR("process() on a closed channel matrix");
+		return -EBADF;
+	}
+
+	if (state->passthrough) {
+		return audio_node_pull(node, buf, out_size);
+	}
+
+	*out_size = 0;
+	matrix = &state->matrix;
+	in = matrix->in_channels;
+	out = matrix->out_channels;
+
+	sets = buf->capacity / out;
+	if (sets == 0U) {
+		LOG_ERR("a frame of %zu samples holds no %zu-channel set", buf->capacity, out);
+		return -EINVAL;
+	}
+
+	if (in <= out) {
+		/* The input fits the frame it is pulled for, at its front. */
+		ret = channel_matrix_pull(node, buf->data, sets, in, &got);
+		if (ret < 0) {
+			return ret;
+		}
+
+		audio_dsp_matrix_q15(buf->data, buf->data, got, matrix);
+		*out_size = got * out;
+
+		return 0;
+	}
+
+	/* A frame larger than the input the definition sized takes several
+	 * pulls; a short one means upstream has no more for now, or at all.
+	 */
+	while (done < sets) {
+		size_t want = MIN(sets - done, state->input_capacity / in);
+
+		ret = channel_matrix_pull(node, state->input, want, in, &got);
+		if (ret < 0) {
+			return ret;
+		}
+
+		audio_dsp_matrix_q15(&buf->data[done * out], state->input, got, matrix);
+		done += got;
+
+		if (got < want) {
+			break;
+		}
+	}
+
+	/* 0 only when upstream ended before the first set: the end of the
+	 * stream, passed on.
+	 */
+	*out_size = done * out;
+
+	return 0;
+}
+
+static int channel_matrix_close(struct audio_node *node)
+{
+	struct audio_channel_matrix_state *state = (struct audio_channel_matrix_state *)node->state;
+
+	if (state) {
+		state->is_open = false;
+	}
+
+	return 0;
+}
+
+const struct audio_node_ops channel_matrix_node_ops = {
+	.open = channel_matrix_open,
+	.process = channel_matrix_process,
+	.close = channel_matrix_close,
+};
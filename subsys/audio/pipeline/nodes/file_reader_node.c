@@ -2,14 +2,30 @@
  * File reader source node.
  *
  * open() opens the file through the Zephyr filesystem API, parses its
- * RIFF/WAVE header with the shared parser and seeks to the payload; process()
- * widens the 16 bit payload into the canonical S32_LE container and reports
- * end of data with out_size == 0; close() releases the handle
+ * RIFF/WAVE header with the shared parser - plain PCM or float, or
+ * WAVE_FORMAT_EXTENSIBLE as multichannel files carry it - and seeks to the
+ * payload; process() widens the payload into the canonical S32_LE container
+ * and reports end of data with out_size == 0; close() releases the handle
  * (manifest §2/§4/§7, spec §5.3/§10.1).
  *
+ * 8 bit unsigned, 16, packed 24 and 32 bit PCM and 32 bit IEEE float are all
+ * read. open() picks the DSP module's kernel for the file's layout once, and
+ * process() runs it over the whole frame in one call, in place: the samples
+ * are read into the front of the frame and widened back to front, so the node
+ * needs no scratch buffer at all (manifest §6).
+ *
  * All state lives in the per-instance ::audio_file_reader_state allocated by
  * AUDIO_FILE_READER_NODE_DEFINE(), so several readers can run side by side.
  *
+ * A node defined with AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE() moves the
+ * fs_read() calls off the pipeline thread (spec §10.1.1): an I/O thread of its
+ * own fills a ring of blocks from the file, and process() copies from the ring
+ * and widens, so the filesystem's latency is the ring's to absorb, not the
+ * frame's. Reads start on a sector boundary and are a whole block long: the
+ * first one starts below the payload and skips the header bytes it also
+ * reads. open() fills the whole ring before the thread starts, so a run
+ * begins with every block in hand and a first frame never waits for a read.
+ *
  * SPDX-License-Identifier: Apache-2.0
  */
 
@@ -17,10 +33,11 @@
 #include <string.h>
 
 #include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
-#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
 
+#include <zephyr/audio/audio_dsp.h>
 #include <zephyr/audio/audio_node.h>
 #include <zephyr/audio/audio_nodes.h>
 #include <zephyr/audio/audio_wav.h>
@@ -29,18 +46,249 @@
 
 LOG_MODULE_REGISTER(audio_file_reader, LOG_LEVEL_INF);
 
-/* v1 converts 16 bit PCM; the parser also accepts 8, 24 and 32 bit files. */
-#define FILE_READER_BITS_PER_SAMPLE 16U
-#define FILE_READER_BYTES_PER_SAMPLE (FILE_READER_BITS_PER_SAMPLE / 8U)
+/*
+ * The kernel that widens the payload @p wav describes (spec §5.3: the sample
+ * moved to the top of the container, s32 = s16 << 16 and so on; a float
+ * scaled by 2^31), or NULL for a layout the node does not read.
+ *
+ * Every one of them runs in place: sample i is read from byte offset
+ * i * bytes and written to 4 * i, never below it, so widening back to front
+ * never clobbers a sample that has not been read yet.
+ */
+static audio_dsp_unpack_fn file_reader_unpack_for(const struct audio_wav_header *wav)
+{
+	if (wav->subformat_tag == AUDIO_WAV_FORMAT_IEEE_FLOAT) {
+		/* The parser reads float at 32 bits only. */
+		return audio_dsp_unpack_f32;
+	}
+
+	switch (wav->bits_per_sample) {
+	case 8U:
+		return audio_dsp_unpack_u8;
+	case 16U:
+		return audio_dsp_unpack_s16;
+	case 24U:
+		return audio_dsp_unpack_s24;
+	case 32U:
+		return audio_dsp_unpack_s32;
+	default:
+		return NULL;
+	}
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+static uint8_t *file_reader_block(const struct audio_file_reader_state *state, uint8_t index)
+{
+	return &state->ring[(size_t)index * state->block_bytes];
+}
+
+/*
+ * Read the next block into the ring at @ref audio_file_reader_state.head and
+ * hand it to the pipeline thread. Runs on the I/O thread, or in open() before
+ * that exists. Returns false once the block handed over was the last one: the
+ * end of the payload, or a read that failed.
+ */
+static bool file_reader_fill(struct audio_file_reader_state *state)
+{
+	struct audio_file_reader_block *info = &state->block_info[state->head];
+	size_t want;
+	ssize_t read;
+
+	info->offset = state->skip;
+	info->size = 0U;
+	info->status = 0;
+
+	if (state->bytes_left == 0U) {
+		info->status = -EPIPE;
+	} else {
+		want = MIN(state->block_bytes, (size_t)state->skip + state->bytes_left);
+		read = fs_read(&state->file, file_reader_block(state, state->head), want);
+		if (read < 0) {
+			LOG_ERR("%s: read failed (%d)", state->path, (int)read);
+			info->status = audio_eof_safe_errno((int)read);
+		} else {
+			if ((size_t)read > state->skip) {
+				info->size = (uint32_t)((size_t)read - state->skip);
+				state->bytes_left -= info->size;
+			}
+
+			/* As on the pipeline thread: the header promised more
+			 * than the file holds, and the data simply ran out.
+			 */
+			if ((size_t)read < want) {
+				LOG_INF("%s: file ends %u bytes before the header promised",
+					state->path, state->bytes_left);
+				state->bytes_left = 0U;
+			}
+
+			if (info->size == 0U) {
+				info->status = -EPIPE;
+			}
+		}
+		state->skip = 0U;
+	}
+
+	state->io_done = info->status != 0;
+	state->head = (uint8_t)((state->head + 1U) % state->blocks);
+	k_sem_give(&state->full);
+
+	return !state->io_done;
+}
+
+/* Keeps one block ahead of the pipeline thread's last free one until the
+ * payload runs out or close() stops it.
+ */
+static void file_reader_io_thread(void *p1, void *p2, void *p3)
+{
+	struct audio_file_reader_state *state = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	do {
+		(void)k_sem_take(&state->free, K_FOREVER);
+		if (atomic_get(&state->stop)) {
+			return;
+		}
+	} while (file_reader_fill(state));
+}
+
+/* Fill the ring, then leave the rest of the file to the I/O thread. */
+static void file_reader_read_ahead_start(struct audio_file_reader_state *state)
+{
+	uint8_t i;
+
+	k_sem_init(&state->free, 0, state->blocks);
+	k_sem_init(&state->full, 0, state->blocks);
+	atomic_clear(&state->stop);
+	atomic_clear(&state->underruns);
+	atomic_set(&state->low_water, state->blocks);
+	state->head = 0U;
+	state->tail = 0U;
+	state->tail_used = 0U;
+	state->tail_taken = false;
+	state->io_done = false;
+
+	for (i = 0U; i < state->blocks; i++) {
+		if (!file_reader_fill(state)) {
+			/* The whole payload fits the ring: no thread needed. */
+			return;
+		}
+	}
+
+	(void)k_thread_create(&state->thread, state->stack, state->stack_size,
+			      file_reader_io_thread, state, NULL, NULL,
+			      CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD_PRIO, 0, K_NO_WAIT);
+	k_thread_name_set(&state->thread, "audio_read_ahead");
+	state->io_running = true;
+}
+
+/* Stop and join the I/O thread: after this the file is the caller's again. */
+static void file_reader_read_ahead_stop(struct audio_file_reader_state *state)
+{
+	if (!state->io_running) {
+		return;
+	}
+
+	/* A read in progress finishes first; a thread waiting for a block is
+	 * woken to find the flag.
+	 */
+	atomic_set(&state->stop, 1);
+	k_sem_give(&state->free);
+	(void)k_thread_join(&state->thread, K_FOREVER);
+	state->io_running = false;
+}
+
+/*
+ * process() for a node that reads ahead: whole sample sets copied out of the
+ * ring, as many as the frame holds, then widened in place. A block that ends
+ * the payload, or carries a failed read, stays where it is, so every later
+ * call reports it again.
+ */
+static int file_reader_process_ahead(struct audio_file_reader_state *state,
+				     struct audio_buffer_view *buf, size_t frame_bytes,
+				     size_t *out_size)
+{
+	uint8_t *dst = (uint8_t *)buf->data;
+	const size_t want = ROUND_DOWN(buf->capacity * state->sample_bytes, frame_bytes);
+	const struct audio_file_reader_block *info = NULL;
+	size_t copied = 0U;
+	size_t samples;
+
+	while (copied < want) {
+		size_t n;
+
+		if (!state->tail_taken) {
+			unsigned int ready = k_sem_count_get(&state->full);
+
+			if (ready < (unsigned int)atomic_get(&state->low_water)) {
+				atomic_set(&state->low_water, ready);
+			}
+
+			/* Nothing read ahead: the frame has to wait for the
+			 * filesystem after all. Waiting keeps the stream the
+			 * file; the count is what tells the ring was too small.
+			 */
+			if (k_sem_take(&state->full, K_NO_WAIT) != 0) {
+				atomic_inc(&state->underruns);
+				(void)k_sem_take(&state->full, K_FOREVER);
+			}
+			state->tail_taken = true;
+		}
+
+		info = &state->block_info[state->tail];
+		if (info->status != 0) {
+			break;
+		}
+
+		n = MIN(want - copied, (size_t)(info->size - state->tail_used));
+		memcpy(&dst[copied], file_reader_block(state, state->tail) + info->offset +
+					     state->tail_used,
+		       n);
+		copied += n;
+		state->tail_used += (uint32_t)n;
+
+		if (state->tail_used == info->size) {
+			state->tail = (uint8_t)((state->tail + 1U) % state->blocks);
+			state->tail_used = 0U;
+			state->tail_taken = false;
+			k_sem_give(&state->free);
+		}
+	}
+
+	/* A payload that stops mid sample frame has no usable tail. */
+	samples = ROUND_DOWN(copied, frame_bytes) / state->sample_bytes;
+
+	if (copied < want) {
+		if (info->status == -EPIPE) {
+			state->eof = true;
+		} else if (samples == 0U) {
+			return info->status;
+		}
+	}
+
+	if (samples == 0U) {
+		return 0;
+	}
+
+	state->unpack(buf->data, dst, samples);
+
+	*out_size = samples;
 
-/* Interleaving is pipeline-wide (spec §5.2); v1 is stereo, mono costs nothing. */
-#define FILE_READER_MAX_CHANNELS 2U
+	return 0;
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD */
 
 /* Drop the handle, leaving the node in a well-defined closed state. */
 static int file_reader_release(struct audio_file_reader_state *state)
 {
 	int ret = 0;
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+	/* The I/O thread reads the handle about to be closed. */
+	file_reader_read_ahead_stop(state);
+#endif
+
 	if (state->file_open) {
 		ret = fs_close(&state->file);
 		/* The handle is gone either way: a failing fs_close() must not
@@ -54,39 +302,13 @@ static int file_reader_release(struct audio_file_reader_state *state)
 	return audio_eof_safe_errno(ret);
 }
 
-/*
- * Widen @p samples little endian 16 bit samples sitting at the front of @p buf
- * into the S32_LE container the rest of the pipeline works with
- * (spec §5.3: s32 = s16 << 16).
- *
- * Done in place, back to front, so the node needs no scratch buffer at all
- * (manifest §6): sample i is read from byte offset 2*i and written to byte
- * offset 4*i, and 2*i <= 4*i for every i, so a write can never clobber a
- * sample that has not been read yet.
- */
-static void file_reader_widen_s16(int32_t *buf, size_t samples)
-{
-	const uint8_t *raw = (const uint8_t *)buf;
-	size_t i = samples;
-
-	while (i-- > 0U) {
-		int16_t sample = (int16_t)sys_get_le16(&raw[i * FILE_READER_BYTES_PER_SAMPLE]);
-
-		/* Shifted as unsigned on purpose: left-shifting a negative
-		 * signed value is not defined by the C standard, while the
-		 * two's complement result below is exactly what the spec asks
-		 * for (-1 -> 0xffff0000, -32768 -> INT32_MIN).
-		 */
-		buf[i] = (int32_t)((uint32_t)(int32_t)sample << 16);
-	}
-}
-
 static int file_reader_open(struct audio_node *node)
 {
 	uint8_t header[AUDIO_WAV_HEADER_SCAN_SIZE];
 	const struct audio_stream_config *want;
 	struct audio_file_reader_state *state;
 	struct audio_wav_header wav;
+	off_t payload;
 	ssize_t read;
 	int ret;
 
@@ -129,18 +351,20 @@ static int file_reader_open(struct audio_node *node)
 		goto err_close;
 	}
 
-	if (wav.bits_per_sample != FILE_READER_BITS_PER_SAMPLE) {
-		LOG_ERR("%s: %u bit PCM is not supported", state->path, wav.bits_per_sample);
+	state->unpack = file_reader_unpack_for(&wav);
+	if (state->unpack == NULL) {
+		LOG_ERR("%s: %u bit samples are not supported", state->path, wav.bits_per_sample);
 		ret = -ENOTSUP;
 		goto err_close;
 	}
+	state->sample_bytes = (uint8_t)(wav.bits_per_sample / 8U);
 
 	/* The parser already rejects a zero channel count; re-checking it here
 	 * keeps process() free of a division by zero no matter what.
 	 */
-	if (wav.channels == 0U || wav.channels > FILE_READER_MAX_CHANNELS) {
-		LOG_ERR("%s: %u channels are outside the v1 range of 1..%u", state->path,
-			wav.channels, FILE_READER_MAX_CHANNELS);
+	if (wav.channels == 0U || wav.channels > CONFIG_AUDIO_PIPELINE_MAX_CHANNELS) {
+		LOG_ERR("%s: %u channels are outside the range of 1..%u", state->path,
+			wav.channels, CONFIG_AUDIO_PIPELINE_MAX_CHANNELS);
 		ret = -ENOTSUP;
 		goto err_close;
 	}
@@ -154,11 +378,12 @@ static int file_reader_open(struct audio_node *node)
 	state->fmt.valid_bits_per_sample = (uint8_t)wav.bits_per_sample;
 	state->fmt.format = AUDIO_SAMPLE_FORMAT_S32_LE;
 
-	/* Nodes validate, they do not adapt (spec §5.2/§10.1): v1 has no
-	 * resampler and no channel mapper, so a file whose rate or channel count
-	 * disagrees with the pipeline can only be refused. Handing it over
-	 * anyway is what produces a track playing at the wrong speed under a
-	 * header that describes something else.
+	/* Nodes validate, they do not adapt (spec §5.2/§10.1): a file whose
+	 * rate or channel count disagrees with the format this node was handed
+	 * can only be refused. A different rate is a resampler's to convert,
+	 * below the reader, and then the format handed here is its input rate.
+	 * Handing a mismatch over anyway is what produces a track playing at the
+	 * wrong speed under a header that describes something else.
 	 *
 	 * A node opened outside a pipeline has no bound format to disagree with;
 	 * the pipeline itself never opens one without it, because
@@ -174,18 +399,38 @@ static int file_reader_open(struct audio_node *node)
 		goto err_close;
 	}
 
-	ret = fs_seek(&state->file, (off_t)wav.data_offset, FS_SEEK_SET);
+	payload = (off_t)wav.data_offset;
+	state->bytes_left = wav.data_size;
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+	/* Reading ahead starts at the sector the payload starts in, and whole
+	 * sample sets are all it ever reads: the rest is never delivered.
+	 */
+	if (state->ring) {
+		state->skip = wav.data_offset % AUDIO_FILE_SECTOR_BYTES;
+		payload -= (off_t)state->skip;
+		state->bytes_left = ROUND_DOWN(wav.data_size, (uint32_t)wav.block_align);
+	}
+#endif
+
+	ret = fs_seek(&state->file, payload, FS_SEEK_SET);
 	if (ret < 0) {
 		LOG_ERR("%s: seek to payload at %u failed (%d)", state->path, wav.data_offset, ret);
 		ret = audio_eof_safe_errno(ret);
 		goto err_close;
 	}
 
-	state->bytes_left = wav.data_size;
 	state->file_open = true;
 
-	LOG_INF("%s: %u Hz, %u ch, %u bit, %u payload bytes", state->path, wav.sample_rate_hz,
-		wav.channels, wav.bits_per_sample, wav.data_size);
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+	if (state->ring) {
+		file_reader_read_ahead_start(state);
+	}
+#endif
+
+	LOG_INF("%s: %u Hz, %u ch, %u bit%s, %u payload bytes", state->path, wav.sample_rate_hz,
+		wav.channels, wav.bits_per_sample,
+		wav.subformat_tag == AUDIO_WAV_FORMAT_IEEE_FLOAT ? " float" : "", wav.data_size);
 
 	return 0;
 
@@ -242,8 +487,15 @@ static int file_reader_process(struct audio_node *node, struct audio_buffer_view
 	/* An interleaved sample frame must never straddle two pipeline frames,
 	 * or every following frame would arrive with its channels swapped.
 	 */
-	frame_bytes = (size_t)state->fmt.channels * FILE_READER_BYTES_PER_SAMPLE;
-	bytes = ROUND_DOWN(buf->capacity * FILE_READER_BYTES_PER_SAMPLE, frame_bytes);
+	frame_bytes = (size_t)state->fmt.channels * state->sample_bytes;
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+	if (state->ring) {
+		return file_reader_process_ahead(state, buf, frame_bytes, out_size);
+	}
+#endif
+
+	bytes = ROUND_DOWN(buf->capacity * state->sample_bytes, frame_bytes);
 	bytes = MIN(bytes, ROUND_DOWN((size_t)state->bytes_left, frame_bytes));
 
 	if (bytes == 0U) {
@@ -271,13 +523,13 @@ static int file_reader_process(struct audio_node *node, struct audio_buffer_view
 	}
 
 	/* A payload that stops mid sample frame has no usable tail. */
-	samples = ROUND_DOWN((size_t)read, frame_bytes) / FILE_READER_BYTES_PER_SAMPLE;
+	samples = ROUND_DOWN((size_t)read, frame_bytes) / state->sample_bytes;
 	if (samples == 0U) {
 		state->eof = true;
 		return 0;
 	}
 
-	file_reader_widen_s16(buf->data, samples);
+	state->unpack(buf->data, (const uint8_t *)buf->data, samples);
 
 	*out_size = samples;
 
@@ -305,3 +557,27 @@ const struct audio_node_ops file_reader_node_ops = {
 	.process = file_reader_process,
 	.close = file_reader_close,
 };
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD
+int audio_file_reader_get_stats(const struct audio_node *node,
+				struct audio_file_reader_stats *stats)
+{
+	struct audio_file_reader_state *state;
+
+	if (!node || !stats || node->ops != &file_reader_node_ops || !node->state) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_file_reader_state *)node->state;
+	if (!state->ring) {
+		return -ENOTSUP;
+	}
+
+	stats->blocks = state->blocks;
+	stats->filled = (uint8_t)k_sem_count_get(&state->full);
+	stats->low_water = (uint8_t)atomic_get(&state->low_water);
+	stats->underruns = (uint32_t)atomic_get(&state->underruns);
+
+	return 0;
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_READER_READ_AHEAD */
@@ -2,13 +2,19 @@
  * File writer sink node.
  *
  * open() creates the output file through the Zephyr filesystem API and writes a
- * canonical 44 byte RIFF/WAVE header; process() pulls a frame from upstream,
- * narrows the canonical S32_LE container back to 16 bit PCM and appends it to
- * the data chunk; close() back-patches the two size fields so the file is a
- * valid WAV (manifest §2/§4/§7, spec §5.3/§10.2).
+ * RIFF/WAVE header - the canonical 44 byte one, or the 68 byte
+ * WAVE_FORMAT_EXTENSIBLE one for more than two channels; process() pulls a frame from upstream,
+ * narrows the canonical S32_LE container back to the file's sample layout and
+ * appends it to the data chunk; close() back-patches the two size fields so the
+ * file is a valid WAV (manifest §2/§4/§7, spec §5.3/§10.2).
+ *
+ * The layout is PCM at the bound depth - 8 bit unsigned, 16, packed 24 or
+ * 32 bit - or 32 bit IEEE float when the application asked for it with
+ * audio_file_writer_set_float(). open() picks the DSP module's kernel for it
+ * once, and every frame is narrowed by one call per chunk or ring block.
  *
  * Sizes are not known until the stream ends, so the header written by open()
- * declares an *empty* data chunk (RIFF size 36, data size 0) and the real sizes
+ * declares an *empty* data chunk (RIFF size 36 or 60, data size 0) and the real sizes
  * are patched in afterwards. The patch happens on end of stream as well as in
  * close(), so a file is valid as soon as the pipeline reports EOF. A run that
  * dies without either - a crash, a reset, a filesystem that stops accepting
@@ -16,19 +22,38 @@
  * a reader sees an empty track and stops immediately instead of replaying
  * whatever bytes happen to follow.
  *
+ * For a long recording an empty track is a lot to lose, so a writer that
+ * writes behind can also checkpoint the header (spec §10.2.2): every
+ * checkpoint_ms of audio written, its I/O thread runs the same in-place patch
+ * mid-stream, and a run that dies afterwards leaves a file that plays up to
+ * the last checkpoint. A plain writer refuses an interval: the seek, header
+ * write and sync of a checkpoint would land inside process(), on the pipeline
+ * thread's deadline.
+ *
  * All state lives in the per-instance ::audio_file_writer_state allocated by
  * AUDIO_FILE_WRITER_NODE_DEFINE(), so several writers can run side by side.
  *
+ * A node defined with AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE() moves the
+ * fs_write() calls off the pipeline thread (spec §10.2.1): process() narrows
+ * straight into a ring of blocks, and an I/O thread of its own writes each
+ * full block out in one call. A block ends where the file reaches a multiple
+ * of the block size, so the first one is short by the header and every write
+ * after it starts on a block boundary. The header is patched once the ring
+ * has drained, which is also when the file handle is the pipeline thread's
+ * again.
+ *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #include <errno.h>
+#include <string.h>
 
 #include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
-#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
 
+#include <zephyr/audio/audio_dsp.h>
 #include <zephyr/audio/audio_node.h>
 #include <zephyr/audio/audio_nodes.h>
 #include <zephyr/audio/audio_wav.h>
@@ -37,34 +62,102 @@
 
 LOG_MODULE_REGISTER(audio_file_writer, LOG_LEVEL_INF);
 
-/* v1 writes 16 bit PCM; the spec's 24 bit path is not built yet. */
-#define FILE_WRITER_BITS_PER_SAMPLE 16U
-#define FILE_WRITER_BYTES_PER_SAMPLE (FILE_WRITER_BITS_PER_SAMPLE / 8U)
-
-/* Interleaving is pipeline-wide (spec §5.2); v1 is stereo, mono costs nothing. */
-#define FILE_WRITER_MAX_CHANNELS 2U
+/*
+ * Widest stream a plain 16 byte "fmt " describes. Beyond it a file is expected
+ * to be WAVE_FORMAT_EXTENSIBLE, the only layout that can say which channel is
+ * which, and tools that meet a plain six channel header guess.
+ */
+#define FILE_WRITER_PLAIN_MAX_CHANNELS 2U
 
 /*
- * Serialise a canonical RIFF/WAVE header declaring @p data_bytes of payload
- * into the @p len bytes at @p header.
+ * The stream description both open() and the finalise path serialise, kept
+ * in one place because they have to describe the same stream.
  *
- * The byte layout belongs to the WAV module, which is also what the reader
- * parses with, so the two sides of a file round trip cannot drift apart. The
- * node only supplies the stream description - kept in one place here because
- * both open() and the finalise path have to describe the same stream.
+ * The extensible header goes out with a channel mask of 0: the pipeline knows
+ * how many channels it carries, not which speaker - if any - each one feeds,
+ * and "not speakers" is the mask's honest answer for a microphone array.
  */
-static int file_writer_build_header(const struct audio_file_writer_state *state,
-				    uint32_t data_bytes, uint8_t *header, size_t len)
+static void file_writer_describe(const struct audio_file_writer_state *state,
+				 uint32_t data_bytes, struct audio_wav_header *hdr)
 {
-	const struct audio_wav_header hdr = {
+	const uint16_t tag = state->float_out ? AUDIO_WAV_FORMAT_IEEE_FLOAT : AUDIO_WAV_FORMAT_PCM;
+
+	*hdr = (struct audio_wav_header){
 		.sample_rate_hz = state->fmt.sample_rate_hz,
 		.data_size = data_bytes,
-		.format_tag = AUDIO_WAV_FORMAT_PCM,
+		.format_tag = state->fmt.channels > FILE_WRITER_PLAIN_MAX_CHANNELS
+				      ? AUDIO_WAV_FORMAT_EXTENSIBLE
+				      : tag,
+		.subformat_tag = tag,
 		.channels = state->fmt.channels,
-		.bits_per_sample = FILE_WRITER_BITS_PER_SAMPLE,
+		.bits_per_sample = (uint16_t)(state->sample_bytes * 8U),
+		.channel_mask = 0U,
 	};
+}
+
+/*
+ * Pick the kernel that narrows the container to what the file holds
+ * (spec §5.3): 32 bit float when @ref audio_file_writer_state.ieee_float asks
+ * for it, whatever the depth, and PCM at the bound depth otherwise. A depth
+ * with no byte-sized layout of its own, such as 20 bit, is refused: padding it
+ * out is the application's call, not one the sink makes behind its back.
+ *
+ * Every PCM kernel keeps the top of the container and truncates the rest, the
+ * exact inverse of the reader's widening, so a file -> pipeline -> file round
+ * trip is bit identical at any depth.
+ */
+static int file_writer_pick_pack(struct audio_file_writer_state *state)
+{
+	state->float_out = state->ieee_float;
+	if (state->float_out) {
+		state->pack = audio_dsp_pack_f32;
+		state->sample_bytes = sizeof(uint32_t);
+		return 0;
+	}
+
+	switch (state->fmt.valid_bits_per_sample) {
+	case 8U:
+		state->pack = audio_dsp_pack_u8;
+		break;
+	case 16U:
+		state->pack = audio_dsp_pack_s16;
+		break;
+	case 24U:
+		state->pack = audio_dsp_pack_s24;
+		break;
+	case 32U:
+		state->pack = audio_dsp_pack_s32;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	state->sample_bytes = state->fmt.valid_bits_per_sample / 8U;
+
+	return 0;
+}
+
+/*
+ * Serialise a RIFF/WAVE header declaring @p data_bytes of payload into the
+ * @p len bytes at @p header, returning how many bytes it took.
+ *
+ * The byte layout belongs to the WAV module, which is also what the reader
+ * parses with, so the two sides of a file round trip cannot drift apart.
+ */
+static int file_writer_build_header(const struct audio_file_writer_state *state,
+				    uint32_t data_bytes, uint8_t *header, size_t len)
+{
+	struct audio_wav_header hdr;
+	int ret;
 
-	return audio_wav_write_header(header, len, &hdr);
+	file_writer_describe(state, data_bytes, &hdr);
+
+	ret = audio_wav_write_header(header, len, &hdr);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return (int)audio_wav_header_size(&hdr);
 }
 
 /* All or nothing: a filesystem that accepts only part of the buffer is out of
@@ -90,31 +183,36 @@ static int file_writer_write_all(struct audio_file_writer_state *state, const vo
 }
 
 /*
- * Patch the RIFF and data chunk sizes to match what has actually been written
- * and leave the position at the end of the file, so appending can continue.
- *
- * Cheap to call repeatedly: without new payload since the last patch there is
- * nothing to do.
+ * Rewrite the header in place with the sizes of what the filesystem has
+ * confirmed so far, push it out, and leave the position at the end of the
+ * file so appending can continue: one seek, one write, a sync and one seek
+ * back, whatever the payload size.
  */
-static int file_writer_finalize(struct audio_file_writer_state *state)
+static int file_writer_patch_header(struct audio_file_writer_state *state)
 {
-	uint8_t header[AUDIO_WAV_MIN_HEADER_SIZE];
+	uint8_t header[AUDIO_WAV_MAX_HEADER_SIZE];
+	size_t header_len;
+	uint32_t data_bytes;
 	int ret;
 
-	if (!state->file_open || !state->header_stale) {
-		return 0;
-	}
+	/* Whole sample sets only. A write-behind block ends where a block of
+	 * the file does, not where a set does, so a failed write can leave
+	 * part of a set confirmed; the plain writer never does.
+	 */
+	data_bytes = ROUND_DOWN(state->data_bytes,
+				(uint32_t)state->fmt.channels * state->sample_bytes);
 
-	ret = file_writer_build_header(state, state->data_bytes, header, sizeof(header));
+	ret = file_writer_build_header(state, data_bytes, header, sizeof(header));
 	if (ret < 0) {
 		/* open() already serialised this very format, so the only way
 		 * here is a payload the size fields cannot describe - which
 		 * process() refuses to produce.
 		 */
-		LOG_ERR("%s: %u payload bytes cannot be described (%d)", state->path,
-			state->data_bytes, ret);
+		LOG_ERR("%s: %u payload bytes cannot be described (%d)", state->path, data_bytes,
+			ret);
 		return ret;
 	}
+	header_len = (size_t)ret;
 
 	ret = fs_seek(&state->file, 0, FS_SEEK_SET);
 	if (ret < 0) {
@@ -122,7 +220,7 @@ static int file_writer_finalize(struct audio_file_writer_state *state)
 		return audio_eof_safe_errno(ret);
 	}
 
-	ret = file_writer_write_all(state, header, sizeof(header));
+	ret = file_writer_write_all(state, header, header_len);
 	if (ret < 0) {
 		return ret;
 	}
@@ -143,11 +241,238 @@ static int file_writer_finalize(struct audio_file_writer_state *state)
 		return audio_eof_safe_errno(ret);
 	}
 
-	state->header_stale = false;
+	state->checkpointed_bytes = state->data_bytes;
 
 	return 0;
 }
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+/*
+ * A checkpoint (spec §10.2.2): patch the header once another interval of
+ * payload has been confirmed since the last patch, so a run that dies before
+ * its end of stream leaves a file that plays up to here. Called by the I/O
+ * thread after a block, never in the middle of one and never on the pipeline
+ * thread.
+ */
+static int file_writer_checkpoint(struct audio_file_writer_state *state)
+{
+	if (state->checkpoint_bytes == 0U ||
+	    state->data_bytes - state->checkpointed_bytes < state->checkpoint_bytes) {
+		return 0;
+	}
+
+	return file_writer_patch_header(state);
+}
+
+static uint8_t *file_writer_block(const struct audio_file_writer_state *state, uint8_t index)
+{
+	return &state->ring[(size_t)index * state->block_bytes];
+}
+
+/* Writes out each block the pipeline thread queues until close() stops it. */
+static void file_writer_io_thread(void *p1, void *p2, void *p3)
+{
+	struct audio_file_writer_state *state = p1;
+	uint32_t len;
+	int ret;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (;;) {
+		(void)k_sem_take(&state->full, K_FOREVER);
+		if (atomic_get(&state->stop)) {
+			return;
+		}
+
+		/* After a failed write the blocks behind it only go back to
+		 * the pipeline thread: a file with a hole in its payload would
+		 * be worse than a short one.
+		 */
+		if (!state->io_failed) {
+			len = state->block_fill[state->tail];
+			atomic_inc(&state->writes);
+
+			ret = file_writer_write_all(state, file_writer_block(state, state->tail),
+						    len);
+			if (ret == 0) {
+				state->data_bytes += len;
+				/* Off the pipeline thread, like the write. */
+				ret = file_writer_checkpoint(state);
+			}
+			if (ret < 0) {
+				state->io_failed = true;
+				atomic_set(&state->error, ret);
+			}
+		}
+
+		state->tail = (uint8_t)((state->tail + 1U) % state->blocks);
+		k_sem_give(&state->free);
+	}
+}
+
+/* An empty ring, and a thread waiting for its first block. */
+static void file_writer_write_behind_start(struct audio_file_writer_state *state,
+					   size_t header_len)
+{
+	k_sem_init(&state->free, state->blocks, state->blocks);
+	k_sem_init(&state->full, 0, state->blocks);
+	atomic_clear(&state->stop);
+	atomic_clear(&state->error);
+	atomic_clear(&state->overruns);
+	atomic_clear(&state->writes);
+	atomic_set(&state->low_water, state->blocks);
+	state->queued_bytes = 0U;
+	state->file_bytes = (uint32_t)header_len;
+	state->head = 0U;
+	state->tail = 0U;
+	state->head_taken = false;
+	state->io_failed = false;
+
+	(void)k_thread_create(&state->thread, state->stack, state->stack_size,
+			      file_writer_io_thread, state, NULL, NULL,
+			      CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND_PRIO, 0, K_NO_WAIT);
+	k_thread_name_set(&state->thread, "audio_write_behind");
+	state->io_running = true;
+}
+
+/* Hand the block at @ref audio_file_writer_state.head to the I/O thread. */
+static void file_writer_submit(struct audio_file_writer_state *state)
+{
+	k_sem_give(&state->full);
+	state->head = (uint8_t)((state->head + 1U) % state->blocks);
+	state->head_taken = false;
+}
+
+/*
+ * Where the next queued byte goes: the block at
+ * @ref audio_file_writer_state.head, taken from the free ones first if the
+ * pipeline thread does not hold it yet.
+ */
+static uint8_t *file_writer_head(struct audio_file_writer_state *state)
+{
+	if (!state->head_taken) {
+		unsigned int ready = k_sem_count_get(&state->free);
+
+		if (ready < (unsigned int)atomic_get(&state->low_water)) {
+			atomic_set(&state->low_water, ready);
+		}
+
+		/* Every block still queued: the frame has to wait for the
+		 * filesystem after all. Waiting keeps the file the stream; the
+		 * count is what tells the ring was too small.
+		 */
+		if (k_sem_take(&state->free, K_NO_WAIT) != 0) {
+			atomic_inc(&state->overruns);
+			(void)k_sem_take(&state->free, K_FOREVER);
+		}
+		state->head_taken = true;
+		state->block_fill[state->head] = 0U;
+	}
+
+	return file_writer_block(state, state->head) + state->block_fill[state->head];
+}
+
+/* Count @p len bytes just put at file_writer_head(), queueing a block they fill. */
+static void file_writer_advance(struct audio_file_writer_state *state, size_t len)
+{
+	state->block_fill[state->head] += (uint32_t)len;
+	state->file_bytes += (uint32_t)len;
+	state->queued_bytes += (uint32_t)len;
+
+	if (state->file_bytes % state->block_bytes == 0U) {
+		file_writer_submit(state);
+	}
+}
+
+/*
+ * Queue what the block being filled holds and wait until the I/O thread has
+ * written out every block. Until the next block is queued, the file is the
+ * pipeline thread's again.
+ */
+static void file_writer_drain(struct audio_file_writer_state *state)
+{
+	uint8_t i;
+
+	if (state->head_taken) {
+		if (state->block_fill[state->head] > 0U) {
+			file_writer_submit(state);
+		} else {
+			k_sem_give(&state->free);
+			state->head_taken = false;
+		}
+	}
+
+	/* Every block free is every block written. */
+	for (i = 0U; i < state->blocks; i++) {
+		(void)k_sem_take(&state->free, K_FOREVER);
+	}
+	for (i = 0U; i < state->blocks; i++) {
+		k_sem_give(&state->free);
+	}
+}
+
+/* Stop and join the I/O thread of a drained ring. */
+static void file_writer_write_behind_stop(struct audio_file_writer_state *state)
+{
+	if (!state->io_running) {
+		return;
+	}
+
+	atomic_set(&state->stop, 1);
+	k_sem_give(&state->full);
+	(void)k_thread_join(&state->thread, K_FOREVER);
+	state->io_running = false;
+}
+
+/* A failed write, reported once: by the process() or close() after it. */
+static int file_writer_take_error(struct audio_file_writer_state *state)
+{
+	return (int)atomic_clear(&state->error);
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND */
+
+/*
+ * Patch the RIFF and data chunk sizes to match what has actually been written
+ * and leave the position at the end of the file, so appending can continue.
+ *
+ * Cheap to call repeatedly: without new payload since the last patch there is
+ * nothing to do.
+ */
+static int file_writer_finalize(struct audio_file_writer_state *state)
+{
+	int err = 0;
+	int ret;
+
+	if (!state->file_open) {
+		return 0;
+	}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	/* The header is the pipeline thread's to patch, so everything queued
+	 * goes to disk first. A write that failed on the way is reported here
+	 * unless process() already has.
+	 */
+	if (state->ring) {
+		file_writer_drain(state);
+		err = file_writer_take_error(state);
+	}
+#endif
+
+	if (!state->header_stale) {
+		return err;
+	}
+
+	ret = file_writer_patch_header(state);
+	if (ret < 0) {
+		return ret;
+	}
+
+	state->header_stale = false;
+
+	return err;
+}
+
 /*
  * Finalise and drop the handle, leaving the node in a well-defined closed
  * state. Reports the first failure but always releases the handle: a failing
@@ -161,6 +486,11 @@ static int file_writer_release(struct audio_file_writer_state *state)
 	if (state->file_open) {
 		ret = file_writer_finalize(state);
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+		/* Drained by the finalise: the thread is only waiting. */
+		file_writer_write_behind_stop(state);
+#endif
+
 		err = fs_close(&state->file);
 		if (ret == 0) {
 			ret = audio_eof_safe_errno(err);
@@ -175,43 +505,93 @@ static int file_writer_release(struct audio_file_writer_state *state)
 	return ret;
 }
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
 /*
- * Narrow @p count canonical S32_LE container samples to little endian 16 bit
- * PCM (spec §5.3: the inverse of the source's s32 = s16 << 16).
- *
- * The rule is a plain arithmetic shift down by 16, i.e. the top 16 bits of the
- * container are kept:
- *
- *  - Rounding is truncation towards negative infinity, not round to nearest.
- *    Round to nearest would need a +0x8000 bias that overflows int32_t just
- *    below INT32_MAX and pushes full-scale positive out of the int16 range,
- *    which is exactly the asymmetry that makes naive narrowing buggy. Plain
- *    truncation is also the exact inverse of the reader's widening, so a
- *    file -> pipeline -> file round trip is bit identical.
- *  - No clipping is needed, and none is possible: a 32 bit value shifted down
- *    by 16 always lands inside [-32768, 32767]. INT32_MIN becomes -32768 and
- *    INT32_MAX becomes 32767, where a naive (int16_t) cast of the low half
- *    would have produced 0 and -1.
- *
- * The shift runs in the unsigned domain and the result is stored as raw bytes,
- * so the conversion has no implementation defined behaviour at all: the two's
- * complement bit pattern of an arithmetic >> 16 is the top half of the
- * container, whatever the host does with signed shifts.
+ * process() for a node that writes behind: @p count samples narrowed straight
+ * into the ring, and every block that fills queued for the I/O thread. A block
+ * holds what takes the file to the next multiple of the block size, so the
+ * first one is short by the header and every later write starts on a
+ * boundary.
  */
-static void file_writer_narrow_s16(const int32_t *samples, size_t count, uint8_t *dst)
+static void file_writer_queue(struct audio_file_writer_state *state, const int32_t *samples,
+			      size_t count)
 {
-	size_t i;
+	const size_t bytes = state->sample_bytes;
+	uint8_t split[sizeof(int32_t)];
+	uint8_t *dst;
+	size_t room;
+	size_t n;
+
+	while (count > 0U) {
+		dst = file_writer_head(state);
+
+		/* Never 0: a block that reaches the boundary is queued. */
+		room = state->block_bytes - (state->file_bytes % state->block_bytes);
+		n = MIN(count, room / bytes);
+
+		if (n == 0U) {
+			/* Less room than a sample, which only a packed 24 bit
+			 * sample ever meets: blocks are sector multiples, and
+			 * the header and every other layout are whole 32 bit
+			 * words. The sample straddles the two blocks, so that
+			 * the write after this one still starts on a boundary.
+			 */
+			state->pack(split, samples, 1U);
+			memcpy(dst, split, room);
+			file_writer_advance(state, room);
+			memcpy(file_writer_head(state), &split[room], bytes - room);
+			file_writer_advance(state, bytes - room);
+			samples++;
+			count--;
+			continue;
+		}
 
-	for (i = 0; i < count; i++) {
-		sys_put_le16((uint16_t)((uint32_t)samples[i] >> 16),
-			     &dst[i * FILE_WRITER_BYTES_PER_SAMPLE]);
+		state->pack(dst, samples, n);
+		file_writer_advance(state, n * bytes);
+		samples += n;
+		count -= n;
 	}
+
+	state->header_stale = true;
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND */
+
+/* True for a node defined with AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(). */
+static bool file_writer_behind(const struct audio_file_writer_state *state)
+{
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	return state->ring != NULL;
+#else
+	ARG_UNUSED(state);
+	return false;
+#endif
+}
+
+/*
+ * @ref audio_file_writer_state.checkpoint_ms of the format just opened, as
+ * payload bytes: whole sample sets, at least one, so a checkpoint never
+ * declares part of a set.
+ */
+static uint32_t file_writer_checkpoint_bytes(const struct audio_file_writer_state *state)
+{
+	uint32_t set = (uint32_t)state->fmt.channels * state->sample_bytes;
+	uint64_t sets;
+
+	if (state->checkpoint_ms == 0U) {
+		return 0U;
+	}
+
+	sets = (uint64_t)state->checkpoint_ms * state->fmt.sample_rate_hz / 1000U;
+	sets = CLAMP(sets, 1U, UINT32_MAX / set);
+
+	return (uint32_t)sets * set;
 }
 
 static int file_writer_open(struct audio_node *node)
 {
-	uint8_t header[AUDIO_WAV_MIN_HEADER_SIZE];
+	uint8_t header[AUDIO_WAV_MAX_HEADER_SIZE];
 	struct audio_file_writer_state *state;
+	size_t header_len;
 	int ret;
 
 	if (!node) {
@@ -248,15 +628,24 @@ static int file_writer_open(struct audio_node *node)
 	/* The container handed to process() is canonical by definition. */
 	state->fmt.format = AUDIO_SAMPLE_FORMAT_S32_LE;
 
-	if (state->fmt.valid_bits_per_sample != FILE_WRITER_BITS_PER_SAMPLE) {
+	if (file_writer_pick_pack(state) < 0) {
 		LOG_ERR("%s: %u bit output is not supported", state->path,
 			state->fmt.valid_bits_per_sample);
 		return -ENOTSUP;
 	}
 
-	if (state->fmt.channels > FILE_WRITER_MAX_CHANNELS) {
-		LOG_ERR("%s: %u channels are outside the v1 range of 1..%u", state->path,
-			state->fmt.channels, FILE_WRITER_MAX_CHANNELS);
+	if (state->fmt.channels > CONFIG_AUDIO_PIPELINE_MAX_CHANNELS) {
+		LOG_ERR("%s: %u channels are outside the range of 1..%u", state->path,
+			state->fmt.channels, CONFIG_AUDIO_PIPELINE_MAX_CHANNELS);
+		return -ENOTSUP;
+	}
+
+	/* A checkpoint is a seek, a header write and a sync (spec §10.2.2): only
+	 * an I/O thread of the node's own can make one mid-stream. Checked here
+	 * too for a state initialised by hand, before anything is created.
+	 */
+	if (state->checkpoint_ms != 0U && !file_writer_behind(state)) {
+		LOG_ERR("%s: a header checkpoint needs a writer that writes behind", state->path);
 		return -ENOTSUP;
 	}
 
@@ -270,6 +659,7 @@ static int file_writer_open(struct audio_node *node)
 			state->fmt.sample_rate_hz, state->fmt.channels, ret);
 		return ret;
 	}
+	header_len = (size_t)ret;
 
 	fs_file_t_init(&state->file);
 
@@ -286,16 +676,24 @@ static int file_writer_open(struct audio_node *node)
 	state->file_open = true;
 	state->data_bytes = 0;
 	state->header_stale = false;
+	state->checkpoint_bytes = file_writer_checkpoint_bytes(state);
+	state->checkpointed_bytes = 0;
 
-	ret = file_writer_write_all(state, header, sizeof(header));
+	ret = file_writer_write_all(state, header, header_len);
 	if (ret < 0) {
 		(void)fs_close(&state->file);
 		state->file_open = false;
 		return ret;
 	}
 
-	LOG_INF("%s: %u Hz, %u ch, %u bit", state->path, state->fmt.sample_rate_hz,
-		state->fmt.channels, FILE_WRITER_BITS_PER_SAMPLE);
+	LOG_INF("%s: %u Hz, %u ch, %u bit%s", state->path, state->fmt.sample_rate_hz,
+		state->fmt.channels, state->sample_bytes * 8U, state->float_out ? " float" : "");
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	if (state->ring) {
+		file_writer_write_behind_start(state, header_len);
+	}
+#endif
 
 	return 0;
 }
@@ -304,7 +702,9 @@ static int file_writer_process(struct audio_node *node, struct audio_buffer_view
 			       size_t *out_size)
 {
 	struct audio_file_writer_state *state;
+	struct audio_wav_header hdr;
 	size_t produced = 0;
+	uint32_t payload;
 	size_t offset;
 	size_t bytes;
 	int ret;
@@ -350,22 +750,48 @@ static int file_writer_process(struct audio_node *node, struct audio_buffer_view
 		return -EINVAL;
 	}
 
-	bytes = produced * FILE_WRITER_BYTES_PER_SAMPLE;
-	if (bytes > (size_t)AUDIO_WAV_MAX_DATA_SIZE - state->data_bytes) {
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	/* The write of an earlier frame failed; this one goes nowhere. */
+	if (state->ring) {
+		ret = file_writer_take_error(state);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+#endif
+
+	/* What the file will hold: queued bytes count, written or not. */
+	payload = state->data_bytes;
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	if (state->ring) {
+		payload = state->queued_bytes;
+	}
+#endif
+
+	bytes = produced * state->sample_bytes;
+	file_writer_describe(state, payload, &hdr);
+	if (bytes > (size_t)audio_wav_max_data_size(&hdr) - payload) {
 		/* Both size fields are 32 bit, so this is as much as a WAV file
-		 * can describe.
+		 * with this header can describe.
 		 */
 		LOG_ERR("%s: data chunk would exceed the 32 bit size field", state->path);
 		return -EFBIG;
 	}
 
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+	if (state->ring) {
+		file_writer_queue(state, buf->data, produced);
+		*out_size = produced;
+		return 0;
+	}
+#endif
+
 	for (offset = 0; offset < produced; offset += AUDIO_FILE_WRITER_CHUNK_SAMPLES) {
 		size_t chunk = MIN((size_t)AUDIO_FILE_WRITER_CHUNK_SAMPLES, produced - offset);
 
-		file_writer_narrow_s16(&buf->data[offset], chunk, state->chunk);
+		state->pack(state->chunk, &buf->data[offset], chunk);
 
-		ret = file_writer_write_all(state, state->chunk,
-					    chunk * FILE_WRITER_BYTES_PER_SAMPLE);
+		ret = file_writer_write_all(state, state->chunk, chunk * state->sample_bytes);
 		if (ret < 0) {
 			/* data_bytes only counts what the filesystem confirmed,
 			 * so the header stays truthful about the payload even
@@ -374,7 +800,7 @@ static int file_writer_process(struct audio_node *node, struct audio_buffer_view
 			return ret;
 		}
 
-		state->data_bytes += (uint32_t)(chunk * FILE_WRITER_BYTES_PER_SAMPLE);
+		state->data_bytes += (uint32_t)(chunk * state->sample_bytes);
 		state->header_stale = true;
 	}
 
@@ -407,3 +833,63 @@ const struct audio_node_ops file_writer_node_ops = {
 	.process = file_writer_process,
 	.close = file_writer_close,
 };
+
+int audio_file_writer_set_checkpoint(const struct audio_node *node, uint32_t interval_ms)
+{
+	struct audio_file_writer_state *state;
+
+	if (!node || node->ops != &file_writer_node_ops || !node->state) {
+		return -EINVAL;
+	}
+
+	/* The pipeline thread never makes a checkpoint (spec §10.2.2). */
+	state = (struct audio_file_writer_state *)node->state;
+	if (interval_ms != 0U && !file_writer_behind(state)) {
+		return -ENOTSUP;
+	}
+
+	/* Read by open() only, so a run keeps the interval it started with. */
+	state->checkpoint_ms = interval_ms;
+
+	return 0;
+}
+
+int audio_file_writer_set_float(const struct audio_node *node, bool ieee_float)
+{
+	struct audio_file_writer_state *state;
+
+	if (!node || node->ops != &file_writer_node_ops || !node->state) {
+		return -EINVAL;
+	}
+
+	/* Read by open() only, so a file keeps the layout it was started in. */
+	state = (struct audio_file_writer_state *)node->state;
+	state->ieee_float = ieee_float;
+
+	return 0;
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND
+int audio_file_writer_get_stats(const struct audio_node *node,
+				struct audio_file_writer_stats *stats)
+{
+	struct audio_file_writer_state *state;
+
+	if (!node || !stats || node->ops != &file_writer_node_ops || !node->state) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_file_writer_state *)node->state;
+	if (!state->ring) {
+		return -ENOTSUP;
+	}
+
+	stats->blocks = state->blocks;
+	stats->free = (uint8_t)k_sem_count_get(&state->free);
+	stats->low_water = (uint8_t)atomic_get(&state->low_water);
+	stats->overruns = (uint32_t)atomic_get(&state->overruns);
+	stats->writes = (uint32_t)atomic_get(&state->writes);
+
+	return 0;
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FILE_WRITER_WRITE_BEHIND */
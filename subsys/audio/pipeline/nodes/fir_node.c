@@ -0,0 +1,162 @@
+/*
+ * FIR filter node.
+ *
+ * Runs every channel of the frame it pulls through one set of taps, in place
+ * (spec §10.10). The arithmetic is one of two shared kernels (spec §5.4),
+ * picked by the definition macro:
+ *
+ *  - direct form: a multiply-add per tap per output against a circular delay
+ *    line per channel, exact to the kernel's definition. The cheaper of the
+ *    two up to about a hundred taps.
+ *  - overlap-save: the frame in blocks through an FFT and back, at a cost per
+ *    sample that hardly grows with the tap count, and within the transforms'
+ *    rounding of the direct form.
+ *
+ * Either way the node is the pull, one kernel call for the whole frame, and
+ * the bookkeeping of the state the macro allocated. Nothing is allocated here
+ * (spec §11.1): the delay lines, the transforms and the history are sized by
+ * the definition from its tap array.
+ *
+ * The one check that cannot be done at build time is the tap bound the
+ * kernels rely on: open() refuses taps whose magnitudes sum to 16 or more, the
+ * point past which the accumulator could overflow.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+LOG_MODULE_REGISTER(audio_fir, LOG_LEVEL_INF);
+
+static bool fir_is_fft(const struct audio_fir_state *state)
+{
+	return state->fft.order != 0U;
+}
+
+static int fir_open(struct audio_node *node)
+{
+	struct audio_fir_state *state = (struct audio_fir_state *)node->state;
+	const struct audio_stream_config *fmt;
+	const int32_t *taps;
+	size_t tap_count;
+
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (fir_is_fft(state)) {
+		taps = state->fft.taps;
+		tap_count = state->fft.tap_count;
+		if (!state->fft.spectrum || !state->fft.work || !state->fft.history ||
+		    tap_count < 2U || tap_count > (1U << state->fft.order)) {
+			return -EINVAL;
+		}
+	} else {
+		taps = state->direct.taps;
+		tap_count = state->direct.tap_count;
+		if (!state->direct.line) {
+			return -EINVAL;
+		}
+	}
+
+	if (!taps || tap_count == 0U) {
+		return -EINVAL;
+	}
+
+	/* The delay lines are per channel, so the node needs the bound format
+	 * to know how many are in use (spec §5.2).
+	 */
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	if (fmt->channels == 0U || fmt->channels > AUDIO_FIR_MAX_CHANNELS) {
+		LOG_ERR("%u channels, the node keeps delay lines for 1..%u", fmt->channels,
+			AUDIO_FIR_MAX_CHANNELS);
+		return -ENOTSUP;
+	}
+
+	if (!audio_dsp_fir_is_bounded(taps, tap_count)) {
+		LOG_ERR("tap magnitudes sum to 16 or more");
+		return -EINVAL;
+	}
+
+	/* Both forms start from silence, so a run never begins with the tail
+	 * of the previous one.
+	 */
+	if (fir_is_fft(state)) {
+		audio_dsp_fir_fft_prepare(&state->fft);
+	} else {
+		memset(state->direct.line, 0,
+		       sizeof(state->direct.line[0]) * AUDIO_FIR_MAX_CHANNELS * 2U * tap_count);
+		state->direct.pos = 0U;
+	}
+	state->is_open = true;
+
+	return 0;
+}
+
+static int fir_process(struct audio_node *node, struct audio_buffer_view *buf, size_t *out_size)
+{
+	struct audio_fir_state *state;
+	size_t channels;
+	int ret;
+
+	if (!node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_fir_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open || !node->pipeline_format) {
+		LOG_ERR("process() on a closed FIR filter");
+		return -EBADF;
+	}
+
+	ret = audio_node_pull(node, buf, out_size);
+	if (ret < 0 || *out_size == 0) {
+		return ret;
+	}
+
+	/* A frame is whole sample sets (spec §5.2), so sample 0 is channel 0
+	 * and each delay line follows its channel from frame to frame.
+	 */
+	channels = node->pipeline_format->channels;
+	if (fir_is_fft(state)) {
+		audio_dsp_fir_fft_q31(buf->data, *out_size, &state->fft, channels);
+	} else {
+		audio_dsp_fir_q31(buf->data, *out_size, &state->direct, channels);
+	}
+
+	return 0;
+}
+
+static int fir_close(struct audio_node *node)
+{
+	struct audio_fir_state *state = (struct audio_fir_state *)node->state;
+
+	if (state) {
+		state->is_open = false;
+	}
+
+	return 0;
+}
+
+const struct audio_node_ops fir_node_ops = {
+	.open = fir_open,
+	.process = fir_process,
+	.close = fir_close,
+};
@@ -0,0 +1,147 @@
+/*
+ * S32-to-float and float-to-S32 nodes.
+ *
+ * The two ends of a floating-point stretch of a chain (spec §10.14). An
+ * s32-to-float node is opened with an F32 format and turns the containers it
+ * pulls into floats of full scale 1.0; a float-to-s32 node is opened with an
+ * S32 format and turns floats back into containers, rounding to nearest and
+ * saturating. The sample format is all that changes, so each is a converter
+ * like the interleave nodes (spec §5.2): open() publishes its own format in
+ * the other sample format as audio_node.upstream_format, and the walk opens
+ * the nodes above with it, on a frame of the same capacity.
+ *
+ * Which format a node is opened with is declared on its ops and checked by
+ * audio_node_open() before open() runs, so the two ops tables below are the
+ * whole difference between the nodes. A float is as wide as a container, so a
+ * frame is converted where it was pulled, with the conversion kernels (spec
+ * §5.4), and neither node needs storage of its own. Either layout will do: a
+ * planar frame is converted one channel's run at a time, which skips the gap
+ * a short frame leaves at the end of each.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+LOG_MODULE_REGISTER(audio_float_convert, LOG_LEVEL_INF);
+
+static int float_convert_open(struct audio_node *node)
+{
+	struct audio_float_convert_state *state =
+		(struct audio_float_convert_state *)node->state;
+	const struct audio_stream_config *fmt;
+
+	if (!state) {
+		return -EINVAL;
+	}
+
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	/* The sample format is the ops' to check (audio_node_open()); upstream
+	 * gets the other one.
+	 */
+	state->input_format = *fmt;
+	state->input_format.format = (fmt->format == AUDIO_SAMPLE_FORMAT_F32_LE)
+					     ? AUDIO_SAMPLE_FORMAT_S32_LE
+					     : AUDIO_SAMPLE_FORMAT_F32_LE;
+	node->upstream_format = &state->input_format;
+
+	state->is_open = true;
+
+	return 0;
+}
+
+/* Convert @p count samples at @p data to the node's own sample format. */
+static void float_convert_run(const struct audio_stream_config *fmt, int32_t *data, size_t count)
+{
+	if (fmt->format == AUDIO_SAMPLE_FORMAT_F32_LE) {
+		audio_dsp_s32_to_f32((float *)data, data, count);
+	} else {
+		audio_dsp_f32_to_s32(data, (const float *)data, count);
+	}
+}
+
+static int float_convert_process(struct audio_node *node, struct audio_buffer_view *buf,
+				 size_t *out_size)
+{
+	struct audio_float_convert_state *state;
+	const struct audio_stream_config *fmt;
+	size_t plane;
+	size_t sets;
+	size_t c;
+	int ret;
+
+	if (!node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_float_convert_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open || !node->pipeline_format) {
+		LOG_ERR("process() on a closed float converter");
+		return -EBADF;
+	}
+
+	ret = audio_node_pull(node, buf, out_size);
+	if (ret < 0 || *out_size == 0) {
+		return ret;
+	}
+
+	fmt = node->pipeline_format;
+	if (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR && fmt->channels > 1U) {
+		plane = audio_frame_channel_stride(fmt, buf);
+		sets = *out_size / fmt->channels;
+		for (c = 0; c < fmt->channels; c++) {
+			float_convert_run(fmt, &buf->data[c * plane], sets);
+		}
+		return 0;
+	}
+
+	float_convert_run(fmt, buf->data, *out_size);
+
+	return 0;
+}
+
+static int float_convert_close(struct audio_node *node)
+{
+	struct audio_float_convert_state *state =
+		(struct audio_float_convert_state *)node->state;
+
+	if (state) {
+		state->is_open = false;
+	}
+
+	return 0;
+}
+
+const struct audio_node_ops s32_to_float_node_ops = {
+	.open = float_convert_open,
+	.process = float_convert_process,
+	.close = float_convert_close,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED) |
+		   AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+	.formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_F32_LE),
+};
+
+const struct audio_node_ops float_to_s32_node_ops = {
+	.open = float_convert_open,
+	.process = float_convert_process,
+	.close = float_convert_close,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED) |
+		   AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+	.formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE),
+};
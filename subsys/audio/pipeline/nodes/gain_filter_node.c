@@ -1,21 +1,383 @@
+/*
+ * Gain filter node.
+ *
+ * Scales every sample of the frame it pulls, in place, by one gain or by one
+ * gain per channel, with saturation into the S32 container. The arithmetic is
+ * the shared gain kernel's (spec §5.4): open() turns the definition's Q15 or
+ * Q31 gains into the kernel's form once, and process() is the pull plus one
+ * kernel call, so the node runs whichever implementation the target builds and
+ * produces the same samples on all of them.
+ *
+ * audio_gain_filter_set() changes the gain while the pipeline runs. The new
+ * gain crosses to the pipeline thread through a triple buffer (see
+ * ::audio_gain_filter_state), which process() checks with one atomic read per
+ * frame, and is reached by a ramp. Everything a ramp needs per sample is
+ * worked out when the gain is taken, so the per-sample work is an add, or a
+ * shift and a multiply, on top of the gain itself; there is no division and
+ * no lock on the hot path.
+ *
+ * A ramp runs on the gains as Q31 fractions of one range shared by every
+ * channel and both ends, with 30 more fractional bits below them, so a fade
+ * over a few seconds still moves on every sample. A Q15 gain needs at most a
+ * range of 2^16, so the shared range holds both ends of any ramp between Q15
+ * gains exactly; a Q31 gain the definition named loses nothing either, its
+ * range being the smallest.
+ *
+ * With CONFIG_AUDIO_PIPELINE_FLOAT an F32 frame (spec §10.14) takes the same
+ * gains and the same ramp, each gain rounded to a float as it is applied, and
+ * nothing is clamped: a float has the headroom, and the float-to-s32 node
+ * saturates at the end of the stretch.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
 #include <errno.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
 
+#include <zephyr/audio/audio_dsp.h>
 #include <zephyr/audio/audio_node.h>
 #include <zephyr/audio/audio_nodes.h>
 
+LOG_MODULE_REGISTER(audio_gain_filter, LOG_LEVEL_INF);
+
+/* Marks the slot in request_mid as one the pipeline thread has not taken. */
+#define GAIN_REQUEST_NEW  BIT(2)
+#define GAIN_REQUEST_SLOT (GAIN_REQUEST_NEW - 1)
+
+/* Fractional bits a ramp keeps below a Q31 gain, and one unit of the gain. */
+#define GAIN_RAMP_FRAC 30
+#define GAIN_RAMP_UNIT (INT64_C(1) << GAIN_RAMP_FRAC)
+
+/*
+ * ln(10^(60/20)) in Q30, rounded up. An exponential ramp over n samples moves
+ * this / n of the distance left each sample, and (1 - x/n)^n <= e^-x, so n
+ * samples leave at most a thousandth of it: the -60 dB the header promises.
+ */
+#define GAIN_RAMP_EXP_RATE_Q30 INT64_C(7417145753)
+BUILD_ASSERT(AUDIO_GAIN_RAMP_EXP_RESIDUAL_DB == 60, "GAIN_RAMP_EXP_RATE_Q30 is ln(1000)");
+
+/* A Q31 gain as the kernel takes it: the fraction itself, no range. */
+static void gain_filter_from_q31(int32_t gain_q31, struct audio_dsp_gain *out)
+{
+	out->scale_q31 = gain_q31;
+	out->shift = 0U;
+}
+
+/* Every gain now @p gain_q15, with nothing left to ramp. */
+static void gain_filter_settle(struct audio_gain_filter_state *state, int32_t gain_q15)
+{
+	uint8_t c;
+
+	for (c = 0U; c < state->scale_count; c++) {
+		audio_dsp_gain_from_q15(gain_q15, &state->scale[c]);
+	}
+	state->unity = gain_q15 == AUDIO_GAIN_UNITY_Q15;
+	state->ramp_left = 0U;
+}
+
+/*
+ * Start the ramp to @p req from wherever the gains are now, which is the middle
+ * of another ramp if one is running. All the arithmetic a ramp needs per sample
+ * is done here, once.
+ */
+static void gain_filter_start_ramp(struct audio_gain_filter_state *state,
+				   const struct audio_gain_filter_request *req)
+{
+	struct audio_dsp_gain from[AUDIO_GAIN_FILTER_MAX_CHANNELS];
+	struct audio_dsp_gain to;
+	int64_t highest;
+	int64_t lowest;
+	int64_t full;
+	uint8_t shift;
+	uint8_t c;
+
+	state->set_gain_q15 = req->gain_q15;
+	state->gain_set = true;
+
+	if (req->ramp_samples == 0U) {
+		gain_filter_settle(state, req->gain_q15);
+		return;
+	}
+
+	audio_dsp_gain_from_q15(req->gain_q15, &to);
+	shift = to.shift;
+	for (c = 0U; c < state->scale_count; c++) {
+		if (state->ramp_left > 0U) {
+			from[c].scale_q31 = (int32_t)(state->ramp_level[c] >> GAIN_RAMP_FRAC);
+			from[c].shift = state->ramp_shift;
+		} else {
+			from[c] = state->scale[c];
+		}
+		shift = MAX(shift, from[c].shift);
+	}
+
+	/* Neither curve leaves the span between its two ends, except that an
+	 * exponential step down rounds down and may pass the end by less than
+	 * one unit of the gain. If the span, widened by that unit below, stays
+	 * in (-1, 1], no sample can clip and the ramp skips its clamp, as the
+	 * gain kernel does.
+	 */
+	full = INT64_C(1) << (31U - shift);
+	lowest = full;
+	highest = -full;
+	for (c = 0U; c < state->scale_count; c++) {
+		int64_t target = to.scale_q31 >> (shift - to.shift);
+		int64_t level = from[c].scale_q31 >> (shift - from[c].shift);
+
+		lowest = MIN(lowest, MIN(level, target));
+		highest = MAX(highest, MAX(level, target));
+
+		state->ramp_level[c] = level * GAIN_RAMP_UNIT;
+		state->ramp_target[c] = target * GAIN_RAMP_UNIT;
+		state->ramp_step[c] =
+			(target - level) * GAIN_RAMP_UNIT / (int64_t)req->ramp_samples;
+	}
+	state->ramp_clamp = highest > full || lowest - 1 <= -full;
+
+	state->ramp = req->ramp;
+	state->ramp_shift = shift;
+	state->ramp_k_q30 = (int32_t)MIN((GAIN_RAMP_EXP_RATE_Q30 + req->ramp_samples - 1) /
+						 req->ramp_samples,
+					 GAIN_RAMP_UNIT);
+	state->ramp_left = req->ramp_samples;
+	state->unity = false;
+}
+
+/* Take the newest gain audio_gain_filter_set() handed over, if any. */
+static void gain_filter_take_request(struct audio_gain_filter_state *state)
+{
+	atomic_val_t mid;
+
+	if ((atomic_get(&state->request_mid) & GAIN_REQUEST_NEW) == 0) {
+		return;
+	}
+
+	mid = atomic_set(&state->request_mid, (atomic_val_t)state->request_front);
+	state->request_front = (uint8_t)(mid & GAIN_REQUEST_SLOT);
+
+	gain_filter_start_ramp(state, &state->request[state->request_front]);
+}
+
+/*
+ * open(): a gain set since the last run, or before it, replaces the
+ * definition's gains. Nothing has been played yet, so there is nothing to ramp
+ * from.
+ */
+static void gain_filter_take_set_gain(struct audio_gain_filter_state *state)
+{
+	gain_filter_take_request(state);
+
+	if (state->gain_set) {
+		gain_filter_settle(state, state->set_gain_q15);
+	}
+}
+
+/*
+ * One gain's ramp over @p sets sample sets from @p data, which points at the
+ * first channel the gain applies to: @p span channels from there in every set
+ * of @p stride samples. The gain moves one step per sample set, before the set
+ * is scaled. Always inlined with @p exponential and @p clamp constant, so each
+ * case gets a loop of its own with the ramp in registers.
+ */
+static ALWAYS_INLINE void gain_filter_ramp_one(struct audio_gain_filter_state *state, uint8_t c,
+					       int32_t *data, size_t sets, size_t stride,
+					       size_t span, bool exponential, bool clamp)
+{
+	const unsigned int rshift = 31U - state->ramp_shift;
+	const int64_t target = state->ramp_target[c];
+	const int64_t step = state->ramp_step[c];
+	const int64_t k_q30 = state->ramp_k_q30;
+	int64_t level = state->ramp_level[c];
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < sets; i++, data += stride) {
+		int32_t gain;
+
+		if (exponential) {
+			level += ((target - level) >> GAIN_RAMP_FRAC) * k_q30;
+		} else {
+			level += step;
+		}
+		gain = (int32_t)(level >> GAIN_RAMP_FRAC);
+
+		for (j = 0; j < span; j++) {
+			int64_t sample = ((int64_t)data[j] * gain) >> rshift;
+
+			if (clamp) {
+				sample = CLAMP(sample, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+			}
+			data[j] = (int32_t)sample;
+		}
+	}
+
+	state->ramp_level[c] = level;
+}
+
+/*
+ * Run the ramp over the first @p sets sample sets of @p data, @p stride samples
+ * each: one ramp per gain, so a single gain for every channel moves them all
+ * together.
+ */
+static void gain_filter_ramp(struct audio_gain_filter_state *state, int32_t *data, size_t sets,
+			     size_t stride)
+{
+	const size_t span = (state->scale_count == 1U) ? stride : 1U;
+	const bool exponential = state->ramp == AUDIO_GAIN_RAMP_EXPONENTIAL;
+	uint8_t c;
+
+	for (c = 0U; c < state->scale_count; c++) {
+		if (exponential && state->ramp_clamp) {
+			gain_filter_ramp_one(state, c, data + c, sets, stride, span, true, true);
+		} else if (exponential) {
+			gain_filter_ramp_one(state, c, data + c, sets, stride, span, true, false);
+		} else if (state->ramp_clamp) {
+			gain_filter_ramp_one(state, c, data + c, sets, stride, span, false, true);
+		} else {
+			gain_filter_ramp_one(state, c, data + c, sets, stride, span, false, false);
+		}
+	}
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+/* A gain in the kernel's form as the float it stands for. */
+static float gain_filter_to_f32(int32_t scale_q31, uint8_t shift)
+{
+	return (float)scale_q31 / (float)(UINT32_C(1) << (31U - shift));
+}
+
+/*
+ * gain_filter_ramp() on an F32 frame: the same level, stepped the same way,
+ * each gain it gives taken as a float.
+ */
+static void gain_filter_ramp_f32(struct audio_gain_filter_state *state, float *data, size_t sets,
+				 size_t stride)
+{
+	const size_t span = (state->scale_count == 1U) ? stride : 1U;
+	const bool exponential = state->ramp == AUDIO_GAIN_RAMP_EXPONENTIAL;
+	const int64_t k_q30 = state->ramp_k_q30;
+	uint8_t c;
+
+	for (c = 0U; c < state->scale_count; c++) {
+		const int64_t target = state->ramp_target[c];
+		const int64_t step = state->ramp_step[c];
+		int64_t level = state->ramp_level[c];
+		float *set = data + c;
+		size_t i;
+		size_t j;
+
+		for (i = 0; i < sets; i++, set += stride) {
+			float gain;
+
+			if (exponential) {
+				level += ((target - level) >> GAIN_RAMP_FRAC) * k_q30;
+			} else {
+				level += step;
+			}
+			gain = gain_filter_to_f32((int32_t)(level >> GAIN_RAMP_FRAC),
+						  state->ramp_shift);
+
+			for (j = 0; j < span; j++) {
+				set[j] *= gain;
+			}
+		}
+
+		state->ramp_level[c] = level;
+	}
+}
+
+/* process() on an F32 frame of @p samples, already pulled. */
+static void gain_filter_process_f32(const struct audio_node *node,
+				    struct audio_gain_filter_state *state, float *data,
+				    size_t samples)
+{
+	float gains[AUDIO_GAIN_FILTER_MAX_CHANNELS];
+	size_t channels = node->pipeline_format->channels;
+	size_t sets;
+	uint8_t c;
+
+	if (state->ramp_left > 0U) {
+		sets = MIN(samples / channels, state->ramp_left - 1U);
+		gain_filter_ramp_f32(state, data, sets, channels);
+		state->ramp_left -= sets;
+		data += sets * channels;
+		samples -= sets * channels;
+		if (samples > 0U) {
+			gain_filter_settle(state, state->set_gain_q15);
+		}
+	}
+
+	if (samples == 0U || state->unity) {
+		return;
+	}
+
+	for (c = 0U; c < state->scale_count; c++) {
+		gains[c] = gain_filter_to_f32(state->scale[c].scale_q31, state->scale[c].shift);
+	}
+	audio_dsp_gain_f32(data, data, samples, gains, state->scale_count);
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FLOAT */
+
 static int gain_filter_open(struct audio_node *node)
 {
 	struct audio_gain_filter_state *state = (struct audio_gain_filter_state *)node->state;
+	const struct audio_stream_config *fmt;
+	uint8_t c;
 
 	if (!state) {
 		return -EINVAL;
 	}
 
-	if (state->gain_q15 == 0) {
-		state->gain_q15 = AUDIO_GAIN_UNITY_Q15;
+	fmt = node->pipeline_format;
+	state->ramp_left = 0U;
+
+	if (state->gain_count == 0U) {
+		if (state->gain_q15 == 0) {
+			state->gain_q15 = AUDIO_GAIN_UNITY_Q15;
+		}
+
+		audio_dsp_gain_from_q15(state->gain_q15, &state->scale[0]);
+		state->scale_count = 1U;
+		state->unity = state->gain_q15 == AUDIO_GAIN_UNITY_Q15;
+
+		gain_filter_take_set_gain(state);
+
+		return 0;
+	}
+
+	/* One gain per channel, exactly (spec §5.2: nodes validate, they never
+	 * adapt), which takes the bound format to check against.
+	 */
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	if (state->gain_count != fmt->channels) {
+		LOG_ERR("%u gains do not match the pipeline's %u channels", state->gain_count,
+			fmt->channels);
+		return -ENOTSUP;
 	}
 
+	/* A Q31 fraction stops short of 1.0, so only a Q15 set can be unity. */
+	state->unity = !state->gain_is_q31;
+	for (c = 0U; c < state->gain_count; c++) {
+		if (state->gain_is_q31) {
+			gain_filter_from_q31(state->gain[c], &state->scale[c]);
+		} else {
+			audio_dsp_gain_from_q15(state->gain[c], &state->scale[c]);
+			state->unity = state->unity && state->gain[c] == AUDIO_GAIN_UNITY_Q15;
+		}
+	}
+	state->scale_count = state->gain_count;
+
+	gain_filter_take_set_gain(state);
+
 	return 0;
 }
 
@@ -23,7 +385,10 @@ static int gain_filter_process(struct audio_node *node, struct audio_buffer_view
 			       size_t *out_size)
 {
 	struct audio_gain_filter_state *state = (struct audio_gain_filter_state *)node->state;
-	size_t i;
+	int32_t *data;
+	size_t channels;
+	size_t samples;
+	size_t sets;
 	int ret;
 
 	if (!state || !node || !buf || !out_size) {
@@ -35,12 +400,42 @@ static int gain_filter_process(struct audio_node *node, struct audio_buffer_view
 		return ret;
 	}
 
-	for (i = 0; i < *out_size; i++) {
-		int64_t sample = buf->data[i];
+	gain_filter_take_request(state);
 
-		sample *= state->gain_q15;
-		sample >>= 15;
-		buf->data[i] = (int32_t)sample;
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	if (node->pipeline_format &&
+	    node->pipeline_format->format == AUDIO_SAMPLE_FORMAT_F32_LE) {
+		gain_filter_process_f32(node, state, buf->data_f32, *out_size);
+		return 0;
+	}
+#endif
+
+	/* A frame is whole sample sets (spec §5.2), so its first sample is
+	 * channel 0 and the kernel's channel count lines up with the stream's.
+	 */
+	data = buf->data;
+	samples = *out_size;
+	if (state->ramp_left > 0U) {
+		/* The ramp's last sample set is the new gain exactly, which the
+		 * settled gain below gives without the steps' rounding.
+		 */
+		/* The stride of a sample set is the pipeline's channel count
+		 * (spec §5.2); a single-gain filter run without a format, as
+		 * it may be opened, treats the frame as mono.
+		 */
+		channels = node->pipeline_format ? node->pipeline_format->channels : 1U;
+		sets = MIN(samples / channels, state->ramp_left - 1U);
+		gain_filter_ramp(state, data, sets, channels);
+		state->ramp_left -= sets;
+		data += sets * channels;
+		samples -= sets * channels;
+		if (samples > 0U) {
+			gain_filter_settle(state, state->set_gain_q15);
+		}
+	}
+
+	if (samples > 0U && !state->unity) {
+		audio_dsp_gain_q31(data, data, samples, state->scale, state->scale_count);
 	}
 
 	return 0;
@@ -52,8 +447,49 @@ static int gain_filter_close(struct audio_node *node)
 	return 0;
 }
 
+int audio_gain_filter_set(const struct audio_node *node, int32_t gain_q15, uint32_t ramp_samples,
+			  enum audio_gain_ramp ramp)
+{
+	struct audio_gain_filter_state *state;
+	struct audio_gain_filter_request *req;
+	k_spinlock_key_t key;
+	atomic_val_t mid;
+
+	if (!node || node->ops != &gain_filter_node_ops ||
+	    (ramp != AUDIO_GAIN_RAMP_LINEAR && ramp != AUDIO_GAIN_RAMP_EXPONENTIAL)) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_gain_filter_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&state->set_lock);
+
+	req = &state->request[state->request_back];
+	req->gain_q15 = gain_q15;
+	req->ramp_samples = ramp_samples;
+	req->ramp = ramp;
+
+	/* Publish the filled slot and take back whichever one was waiting: an
+	 * untaken gain is simply replaced by this newer one.
+	 */
+	mid = atomic_set(&state->request_mid, (atomic_val_t)(state->request_back |
+							     GAIN_REQUEST_NEW));
+	state->request_back = (uint8_t)(mid & GAIN_REQUEST_SLOT);
+
+	k_spin_unlock(&state->set_lock, key);
+
+	return 0;
+}
+
 const struct audio_node_ops gain_filter_node_ops = {
 	.open = gain_filter_open,
 	.process = gain_filter_process,
 	.close = gain_filter_close,
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	.formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE) |
+		   AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_F32_LE),
+#endif
 };
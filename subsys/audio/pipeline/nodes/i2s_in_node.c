@@ -2,11 +2,11 @@
  * I2S input source node.
  *
  * open() configures the receive direction of a Zephyr I2S device from the
- * pipeline's bound format and leaves it stopped; process() takes a received
- * block from the driver, widens it into the canonical container through the
- * shared wire seam and hands the samples to the chain; close() drops the stream
- * and returns every block the node still holds (manifest §2/§4/§6/§7,
- * spec §4.2/§5.3/§10.5).
+ * pipeline's bound format and leaves it stopped; lend() offers the next
+ * received block as the frame's storage; process() widens a received block into
+ * the canonical container through the shared wire seam and hands the samples to
+ * the chain; close() drops the stream and returns every block the node still
+ * holds (manifest §2/§4/§6/§7, spec §4.1.2/§4.2/§5.3/§10.5).
  *
  * A LIVE INPUT NEVER ENDS
  * -----------------------
@@ -19,19 +19,29 @@
  * broken wire as a clean end of stream, which is the one failure this node must
  * not invent.
  *
- * WHY THE BLOCK IS COPIED, AND WHY IT IS ALWAYS GIVEN BACK
- * -------------------------------------------------------
+ * WHY THE BLOCK IS LENT, AND WHY IT IS ALWAYS GIVEN BACK
+ * -----------------------------------------------------
  * The Zephyr I2S API is mem_slab based: i2s_read() hands over ownership of a
- * block the driver filled, and the caller has to free it back to the slab. The
- * pipeline's frame buffer is borrowed storage owned by the pipeline (spec §4.1),
- * so the two ownership models cannot be bridged by passing the driver's block up
- * the chain - the copy at this boundary is the seam between them.
+ * block the driver filled, and the caller has to free it back to the slab.
+ *
+ * Rather than copy the block into the pipeline's frame buffer, the node lends
+ * the block itself as the frame's storage (spec §4.1.2). The driver is asked
+ * for one frame of wire words per block, and the block is sized for one frame
+ * of the widest word, so the words widen into containers where they lie - back
+ * to front, each container landing on words already read - and the chain then
+ * works in the block. Because the chain is still using it after process()
+ * returns, a lent block is released when the node is next asked to lend, or is
+ * closed, and not when it has been read.
+ *
+ * The copy remains for what lending does not cover: a caller that pulls into
+ * storage of its own - a two-stage run, a node with a scratch frame - or a
+ * frame smaller than the block, which is then drained across several frames.
  *
  * A block that is not returned is invisible until the slab runs dry, at which
  * point capture stops for a reason that looks nothing like a leak. There is
  * therefore exactly one place a block is released, i2s_in_block_release(), and
  * every path that can lose interest in a block - a drained block, a conversion
- * failure, close() - goes through it.
+ * failure, the end of a lent frame, close() - goes through it.
  *
  * WHY BLOCKING IS CORRECT HERE
  * ----------------------------
@@ -64,15 +74,6 @@
 
 LOG_MODULE_REGISTER(audio_i2s_in, LOG_LEVEL_INF);
 
-/*
- * The Philips I2S frame carries two words by definition, and the drivers behind
- * this API say so too: they ignore i2s_config.channels for that standard and
- * always clock two words per frame. A mono pipeline would therefore be accepted
- * and then filled at half the rate it describes, so it is refused instead
- * (spec §5.2: which formats a node accepts is a property of that node).
- */
-#define I2S_IN_CHANNELS 2U
-
 /* Blocking is the pacing mechanism; see the file comment. */
 #define I2S_IN_QUEUE_TIMEOUT SYS_FOREVER_MS
 
@@ -84,15 +85,33 @@ LOG_MODULE_REGISTER(audio_i2s_in, LOG_LEVEL_INF);
  */
 static void i2s_in_block_release(struct audio_i2s_in_state *state)
 {
-	if (state->block) {
+	/* A lent block is the chain's storage until the frame is over, so here
+	 * it is only let go of; i2s_in_lent_release() frees it.
+	 */
+	if (state->block && state->block != state->lent) {
 		k_mem_slab_free(state->slab, state->block);
-		state->block = NULL;
 	}
 
+	state->block = NULL;
 	state->block_valid = 0U;
 	state->block_used = 0U;
 }
 
+/* Free the block lent for the previous frame, now that the frame is over. */
+static void i2s_in_lent_release(struct audio_i2s_in_state *state)
+{
+	if (state->lent) {
+		if (state->block == state->lent) {
+			state->block = NULL;
+			state->block_valid = 0U;
+			state->block_used = 0U;
+		}
+
+		k_mem_slab_free(state->slab, state->lent);
+		state->lent = NULL;
+	}
+}
+
 /*
  * Stop the receive direction and return everything to the slab, leaving the
  * node in a well-defined closed state.
@@ -128,6 +147,7 @@ static int i2s_in_release(struct audio_i2s_in_state *state)
 	state->started = false;
 
 	i2s_in_block_release(state);
+	i2s_in_lent_release(state);
 
 	return audio_eof_safe_errno(ret);
 }
@@ -280,9 +300,20 @@ static int i2s_in_open(struct audio_node *node)
 		return -EINVAL;
 	}
 
-	if (fmt->channels != I2S_IN_CHANNELS) {
-		LOG_ERR("%s: %u channels cannot be carried by an I2S frame of %u words",
-			state->dev->name, fmt->channels, I2S_IN_CHANNELS);
+	/*
+	 * The Philips I2S frame carries two words by definition, and the drivers
+	 * behind this API say so too: they ignore i2s_config.channels for that
+	 * standard and always clock two words per frame. A mono pipeline would
+	 * therefore be accepted and then filled at half the rate it describes, so
+	 * it is refused instead (spec §5.2: which formats a node accepts is a
+	 * property of that node). A TDM frame has a slot per channel and takes any
+	 * count up to the ceiling; the range for the frame this build carries is
+	 * AUDIO_I2S_MIN/MAX_CHANNELS.
+	 */
+	if (fmt->channels < AUDIO_I2S_MIN_CHANNELS || fmt->channels > AUDIO_I2S_MAX_CHANNELS) {
+		LOG_ERR("%s: %u channels cannot be carried by a frame of %u..%u words",
+			state->dev->name, fmt->channels, AUDIO_I2S_MIN_CHANNELS,
+			AUDIO_I2S_MAX_CHANNELS);
 		return -ENOTSUP;
 	}
 
@@ -310,20 +341,23 @@ static int i2s_in_open(struct audio_node *node)
 
 	cfg.word_size = wire.word_bits;
 	cfg.channels = fmt->channels;
-	cfg.format = I2S_FMT_DATA_FORMAT_I2S;
+	cfg.format = AUDIO_I2S_DATA_FORMAT;
 	cfg.options = AUDIO_I2S_IN_RX_OPTIONS;
 	cfg.frame_clk_freq = fmt->sample_rate_hz;
 	cfg.mem_slab = state->slab;
 	/*
-	 * Whole interleaved sample sets only, which is what keeps the channels
-	 * of one block from shifting into the next. The blocks are sized for the
-	 * widest word the container can ever produce, so at a narrower depth the
-	 * slab block is larger than the driver is asked to fill; the surplus
-	 * stays unused rather than becoming half a sample set. With the depths
-	 * v1 carries this rounds nothing off - it is the invariant that is
-	 * stated here, not an adjustment.
+	 * One frame of wire words per block, in whole interleaved sample sets.
+	 * The slab block is sized for a frame of the widest word the container
+	 * can ever produce, so at a narrower depth the driver fills only its
+	 * front; the rest is the room the words need to widen in place when the
+	 * block is lent (spec §4.1.2). The rounding is what keeps the channels
+	 * of one block from shifting into the next; with the depths v1 carries
+	 * it rounds nothing off - it is the invariant that is stated here, not
+	 * an adjustment.
 	 */
-	cfg.block_size = ROUND_DOWN(state->block_bytes, sample_set_bytes);
+	cfg.block_size = ROUND_DOWN(state->block_bytes / AUDIO_I2S_WIRE_MAX_WORD_BYTES *
+					    wire.word_bytes,
+				    sample_set_bytes);
 	cfg.timeout = I2S_IN_QUEUE_TIMEOUT;
 
 	ret = i2s_configure(state->dev, I2S_DIR_RX, &cfg);
@@ -345,6 +379,62 @@ static int i2s_in_open(struct audio_node *node)
 	return 0;
 }
 
+/*
+ * Samples a freshly fetched block carries that widen inside the block itself,
+ * or 0 if it cannot be lent: it carries no whole sample set, or more than a
+ * frame of @p capacity holds, or more than fit the block once widened.
+ */
+static size_t i2s_in_lendable_samples(const struct audio_i2s_in_state *state,
+				      const struct audio_stream_config *fmt,
+				      const struct audio_i2s_wire_format *wire, size_t capacity)
+{
+	size_t samples = ROUND_DOWN(state->block_valid / wire->word_bytes, fmt->channels);
+
+	if (samples > capacity || samples > state->block_bytes / sizeof(int32_t)) {
+		return 0U;
+	}
+
+	return samples;
+}
+
+/* Widen the lent block in place and hand all of it to the chain as one frame. */
+static int i2s_in_widen_lent(struct audio_i2s_in_state *state,
+			     const struct audio_stream_config *fmt,
+			     const struct audio_i2s_wire_format *wire, size_t capacity,
+			     size_t *out_size)
+{
+	size_t samples = i2s_in_lendable_samples(state, fmt, wire, capacity);
+	int ret;
+
+	if (samples == 0U) {
+		/* lend() checked the block against the frame it was asked for,
+		 * so the frame shrank in between. Reported, never an empty
+		 * frame, and never copied: the block is the destination too.
+		 */
+		LOG_ERR("%s: a frame of %zu samples no longer holds the lent block",
+			state->dev->name, capacity);
+		i2s_in_block_release(state);
+		return -EINVAL;
+	}
+
+	ret = audio_i2s_wire_to_container(fmt->valid_bits_per_sample, state->block,
+					  state->block_valid, state->block, samples);
+	if (ret < 0) {
+		LOG_ERR("%s: %zu wire words do not widen in place (%d)", state->dev->name,
+			samples, ret);
+		i2s_in_block_release(state);
+		return ret;
+	}
+
+	/* The words are gone, so the block is done as a source of audio; as
+	 * the chain's storage it stays lent until the frame is over.
+	 */
+	i2s_in_block_release(state);
+	*out_size = samples;
+
+	return 0;
+}
+
 static int i2s_in_process(struct audio_node *node, struct audio_buffer_view *buf, size_t *out_size)
 {
 	const struct audio_stream_config *fmt;
@@ -396,6 +486,13 @@ static int i2s_in_process(struct audio_node *node, struct audio_buffer_view *buf
 		return -EINVAL;
 	}
 
+	if (state->block && state->block == state->lent && state->lent == buf->data) {
+		/* The block lend() lent, pulled into as lent: widened where it
+		 * lies, and the frame needs no copy.
+		 */
+		return i2s_in_widen_lent(state, fmt, &wire, buf->capacity, out_size);
+	}
+
 	if (!state->block) {
 		ret = i2s_in_fetch(state);
 		if (ret < 0) {
@@ -458,6 +555,72 @@ static int i2s_in_process(struct audio_node *node, struct audio_buffer_view *buf
 	return 0;
 }
 
+/*
+ * Lend the next received block as the frame's storage (spec §4.1.2). The read
+ * happens here rather than in process(), which moves the wait for the codec to
+ * the start of the frame without changing how long it is.
+ */
+static int i2s_in_lend(struct audio_node *node, struct audio_buffer_view *buf)
+{
+	const struct audio_stream_config *fmt;
+	struct audio_i2s_in_state *state;
+	struct audio_i2s_wire_format wire;
+	int ret;
+
+	if (!node || !buf) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_i2s_in_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->configured) {
+		return -EBADF;
+	}
+
+	/* Asked again, so the previous frame is over and its block with it. */
+	i2s_in_lent_release(state);
+
+	/* A block still being drained goes on by copy until it is empty. */
+	if (state->block) {
+		return -ENOTSUP;
+	}
+
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		return -EINVAL;
+	}
+
+	ret = audio_i2s_wire_format_get(fmt->valid_bits_per_sample, &wire);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The lent storage must hold the whole frame the pipeline asks for. */
+	if (buf->capacity > state->block_bytes / sizeof(int32_t)) {
+		return -ENOTSUP;
+	}
+
+	ret = i2s_in_fetch(state);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* A block that does not widen in place stays with the node, and
+	 * process() copies it out - or reports it, if it is unusable.
+	 */
+	if (i2s_in_lendable_samples(state, fmt, &wire, buf->capacity) == 0U) {
+		return -ENOTSUP;
+	}
+
+	state->lent = state->block;
+	buf->data = state->lent;
+
+	return 0;
+}
+
 static int i2s_in_close(struct audio_node *node)
 {
 	struct audio_i2s_in_state *state;
@@ -478,4 +641,5 @@ const struct audio_node_ops i2s_in_node_ops = {
 	.open = i2s_in_open,
 	.process = i2s_in_process,
 	.close = i2s_in_close,
+	.lend = i2s_in_lend,
 };
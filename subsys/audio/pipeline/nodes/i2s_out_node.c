@@ -2,19 +2,30 @@
  * I2S output sink node.
  *
  * open() configures the transmit direction of a Zephyr I2S device from the
- * pipeline's bound format and leaves it stopped; process() pulls a frame,
- * narrows it into transfer blocks through the shared wire seam and hands them
- * to the driver; close() drops the stream and returns every queued block
- * (manifest §2/§4/§6, spec §4.4/§5.3).
+ * pipeline's bound format and leaves it stopped; lend() offers a transfer block
+ * as the next frame's storage; process() pulls a frame, narrows it into
+ * transfer blocks through the shared wire seam and hands them to the driver;
+ * close() drops the stream and returns every queued block (manifest §2/§4/§6,
+ * spec §4.1.2/§4.4/§5.3).
  *
- * WHY THE FRAME IS COPIED
- * -----------------------
+ * WHY THE FRAME IS LENT, AND WHEN IT IS STILL COPIED
+ * -------------------------------------------------
  * The Zephyr I2S API is mem_slab based: the caller allocates a block, fills it
  * and i2s_write() takes ownership of it until the transfer completes. The
- * pipeline hands a node a *borrowed* frame buffer it does not own and reuses for
- * the next frame (spec §4.1), so the two ownership models cannot be bridged by
- * passing the pipeline's buffer down - the copy at this boundary is the seam
- * between them, not an oversight.
+ * pipeline's own frame buffer is borrowed storage it reuses for the next frame
+ * (spec §4.1), so it can never be handed to the driver.
+ *
+ * The node therefore lends the pipeline a slab block instead (spec §4.1.2): the
+ * whole chain produces the frame in it, process() narrows the containers to
+ * wire words in place - front to back, each word landing inside a container
+ * already read - and queues that same block. The one pass over the frame left
+ * at this boundary is the narrowing, which the wire format needs anyway.
+ *
+ * The block is sized for the widest word, so it holds a frame of containers
+ * whenever it holds the frame at all. The pipeline's buffer and the copy into a
+ * fresh block remain the path for everything lending does not cover: a frame
+ * larger than one block, a two-stage run whose frames live in the ring, and a
+ * sink that is not the pipeline's, such as a tee branch.
  *
  * WHY BLOCKING IS CORRECT HERE
  * ----------------------------
@@ -48,18 +59,27 @@
 
 LOG_MODULE_REGISTER(audio_i2s_out, LOG_LEVEL_INF);
 
-/*
- * The Philips I2S frame carries two words by definition, and the drivers behind
- * this API say so too: they ignore i2s_config.channels for that standard and
- * always clock two words per frame. A mono pipeline would therefore be accepted
- * and then transmitted at half the rate it describes, so it is refused instead
- * (spec §5.2: which formats a node accepts is a property of that node).
- */
-#define I2S_OUT_CHANNELS 2U
-
 /* Blocking is the pacing mechanism; see the file comment. */
 #define I2S_OUT_QUEUE_TIMEOUT SYS_FOREVER_MS
 
+/* Give @p block back to the slab; NULL is no block and is ignored. */
+static void i2s_out_block_free(struct audio_i2s_out_state *state, void *block)
+{
+	if (block) {
+		k_mem_slab_free(state->slab, block);
+	}
+}
+
+/*
+ * Return a lent block that never reached process() to the slab. Idempotent, so
+ * lend() and close() call it without first working out whether one is out.
+ */
+static void i2s_out_lent_reclaim(struct audio_i2s_out_state *state)
+{
+	i2s_out_block_free(state, state->lent);
+	state->lent = NULL;
+}
+
 /*
  * Stop the transmit direction and give every block the driver still holds back
  * to the slab, leaving the node in a well-defined closed state.
@@ -89,6 +109,8 @@ static int i2s_out_release(struct audio_i2s_out_state *state)
 
 	state->started = false;
 
+	i2s_out_lent_reclaim(state);
+
 	return audio_eof_safe_errno(ret);
 }
 
@@ -209,6 +231,31 @@ static int i2s_out_send(struct audio_i2s_out_state *state, uint8_t valid_bits_pe
 	return i2s_out_submit(state, block, count * word_bytes);
 }
 
+/*
+ * Queue the lent block the chain produced @p count container samples in. The
+ * containers are narrowed where they are, so the frame reaches the driver
+ * without a copy; the block is freed if it cannot be queued.
+ */
+static int i2s_out_send_lent(struct audio_i2s_out_state *state, uint8_t valid_bits_per_sample,
+			     void *block, size_t count, size_t word_bytes)
+{
+	int ret;
+
+	ret = audio_i2s_wire_from_container(valid_bits_per_sample, block, count, block,
+					    state->block_bytes);
+	if (ret < 0) {
+		/* lend() only lent a block that holds the whole frame as
+		 * containers, and wire words are never wider than those.
+		 */
+		LOG_ERR("%s: %zu samples do not narrow in a %zu byte block (%d)",
+			state->dev->name, count, state->block_bytes, ret);
+		k_mem_slab_free(state->slab, block);
+		return ret;
+	}
+
+	return i2s_out_submit(state, block, count * word_bytes);
+}
+
 static int i2s_out_open(struct audio_node *node)
 {
 	const struct audio_stream_config *fmt;
@@ -248,9 +295,20 @@ static int i2s_out_open(struct audio_node *node)
 		return -EINVAL;
 	}
 
-	if (fmt->channels != I2S_OUT_CHANNELS) {
-		LOG_ERR("%s: %u channels cannot be carried by an I2S frame of %u words",
-			state->dev->name, fmt->channels, I2S_OUT_CHANNELS);
+	/*
+	 * The Philips I2S frame carries two words by definition, and the drivers
+	 * behind this API say so too: they ignore i2s_config.channels for that
+	 * standard and always clock two words per frame. A mono pipeline would
+	 * therefore be accepted and then transmitted at half the rate it
+	 * describes, so it is refused instead (spec §5.2: which formats a node
+	 * accepts is a property of that node). A TDM frame has a slot per channel
+	 * and takes any count up to the ceiling; the range for the frame this
+	 * build carries is AUDIO_I2S_MIN/MAX_CHANNELS.
+	 */
+	if (fmt->channels < AUDIO_I2S_MIN_CHANNELS || fmt->channels > AUDIO_I2S_MAX_CHANNELS) {
+		LOG_ERR("%s: %u channels cannot be carried by a frame of %u..%u words",
+			state->dev->name, fmt->channels, AUDIO_I2S_MIN_CHANNELS,
+			AUDIO_I2S_MAX_CHANNELS);
 		return -ENOTSUP;
 	}
 
@@ -276,7 +334,7 @@ static int i2s_out_open(struct audio_node *node)
 
 	cfg.word_size = wire.word_bits;
 	cfg.channels = fmt->channels;
-	cfg.format = I2S_FMT_DATA_FORMAT_I2S;
+	cfg.format = AUDIO_I2S_DATA_FORMAT;
 	cfg.options = AUDIO_I2S_OUT_TX_OPTIONS;
 	cfg.frame_clk_freq = fmt->sample_rate_hz;
 	cfg.mem_slab = state->slab;
@@ -310,6 +368,7 @@ static int i2s_out_process(struct audio_node *node, struct audio_buffer_view *bu
 	size_t produced = 0;
 	size_t block_samples;
 	size_t offset;
+	void *lent = NULL;
 	int ret;
 
 	if (!node || !buf || !buf->data || !out_size) {
@@ -344,8 +403,17 @@ static int i2s_out_process(struct audio_node *node, struct audio_buffer_view *bu
 		return ret;
 	}
 
+	/* Taken off the node before the pull, so from here on the lent block
+	 * is this call's to queue or to free, whatever the chain reports.
+	 */
+	if (state->lent != NULL && buf->data == state->lent) {
+		lent = state->lent;
+		state->lent = NULL;
+	}
+
 	ret = audio_node_pull(node, buf, &produced);
 	if (ret < 0) {
+		i2s_out_block_free(state, lent);
 		return ret;
 	}
 
@@ -354,6 +422,7 @@ static int i2s_out_process(struct audio_node *node, struct audio_buffer_view *bu
 		 * blocks already queued play out on their own and close() drops
 		 * whatever the wire has not consumed.
 		 */
+		i2s_out_block_free(state, lent);
 		return 0;
 	}
 
@@ -363,9 +432,22 @@ static int i2s_out_process(struct audio_node *node, struct audio_buffer_view *bu
 	if ((produced % fmt->channels) != 0U) {
 		LOG_ERR("%s: %zu samples do not fill whole %u channel sample sets",
 			state->dev->name, produced, fmt->channels);
+		i2s_out_block_free(state, lent);
 		return -EINVAL;
 	}
 
+	if (lent != NULL) {
+		ret = i2s_out_send_lent(state, fmt->valid_bits_per_sample, lent, produced,
+					wire.word_bytes);
+		if (ret < 0) {
+			return ret;
+		}
+
+		*out_size = produced;
+
+		return 0;
+	}
+
 	/* Blocks are sized from the frame capacity, so one block normally
 	 * carries the whole frame. A pipeline handing over a larger frame than
 	 * the definition site promised is still transmitted correctly, in
@@ -400,6 +482,54 @@ static int i2s_out_process(struct audio_node *node, struct audio_buffer_view *bu
 	return 0;
 }
 
+/*
+ * Lend the next transfer block as the frame's storage (spec §4.1.2). It blocks
+ * for a free block exactly as the copying path would, only before the chain
+ * runs rather than after it, so the pacing against the wire is unchanged.
+ */
+static int i2s_out_lend(struct audio_node *node, struct audio_buffer_view *buf)
+{
+	struct audio_i2s_out_state *state;
+	void *block;
+	int ret;
+
+	if (!node || !buf) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_i2s_out_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->configured) {
+		return -EBADF;
+	}
+
+	/* A block lent for a frame that never reached process() carries
+	 * nothing, and goes back before the next one is taken.
+	 */
+	i2s_out_lent_reclaim(state);
+
+	/* A frame larger than the definition site promised is sent in several
+	 * blocks, and that is only possible from the pipeline's buffer.
+	 */
+	if (buf->capacity > state->block_bytes / sizeof(int32_t)) {
+		return -ENOTSUP;
+	}
+
+	ret = k_mem_slab_alloc(state->slab, &block, K_FOREVER);
+	if (ret < 0) {
+		LOG_ERR("%s: no transfer block available (%d)", state->dev->name, ret);
+		return audio_eof_safe_errno(ret);
+	}
+
+	state->lent = block;
+	buf->data = block;
+
+	return 0;
+}
+
 static int i2s_out_close(struct audio_node *node)
 {
 	struct audio_i2s_out_state *state;
@@ -420,4 +550,5 @@ const struct audio_node_ops i2s_out_node_ops = {
 	.open = i2s_out_open,
 	.process = i2s_out_process,
 	.close = i2s_out_close,
+	.lend = i2s_out_lend,
 };
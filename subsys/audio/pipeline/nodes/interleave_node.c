@@ -0,0 +1,188 @@
+/*
+ * Interleave and deinterleave nodes.
+ *
+ * The two ends of a planar stretch of a chain (spec §10.13). A deinterleave
+ * node is opened with a planar format and splits every frame it pulls from an
+ * interleaved upstream into one run per channel; an interleave node is opened
+ * with an interleaved format and merges the runs of a planar upstream back into
+ * sample sets. Either way the layout is all that changes, so each is a
+ * converter like the resampler (spec §5.2): open() publishes its own format in
+ * the other layout as audio_node.upstream_format, and the walk opens the nodes
+ * above with it, on a frame of the same capacity.
+ *
+ * Which layout a node is opened with is declared on its ops and checked by
+ * audio_node_open() before open() runs, so the two ops tables below are the
+ * whole difference between the nodes, and open() only has the format to check.
+ *
+ * Transposing a frame in place is a cycle walk with a division per sample, so
+ * the frame is pulled into a frame of scratch instead and copied across in one
+ * pass (spec §5.4). A frame larger than the scratch - above a converter that
+ * makes more sets than it takes - takes several pulls; one channel is the same
+ * frame in either layout, and only pulls.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+LOG_MODULE_REGISTER(audio_interleave, LOG_LEVEL_INF);
+
+static int interleave_open(struct audio_node *node)
+{
+	struct audio_interleave_state *state = (struct audio_interleave_state *)node->state;
+	const struct audio_stream_config *fmt;
+
+	if (!state || !state->scratch || state->scratch_capacity == 0U) {
+		return -EINVAL;
+	}
+
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	if (fmt->channels == 0U || fmt->channels > state->scratch_capacity) {
+		LOG_ERR("%u channels, the scratch holds a set of 1..%zu", fmt->channels,
+			state->scratch_capacity);
+		return -ENOTSUP;
+	}
+
+	/* The layout is the ops' to check (audio_node_open()); upstream gets
+	 * the other one, even for one channel, or an interleaved-only source
+	 * above a deinterleave node would refuse its own format.
+	 */
+	state->input_format = *fmt;
+	state->input_format.layout = (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR)
+					     ? AUDIO_FRAME_LAYOUT_INTERLEAVED
+					     : AUDIO_FRAME_LAYOUT_PLANAR;
+	node->upstream_format = &state->input_format;
+
+	state->passthrough = fmt->channels == 1U;
+	state->is_open = true;
+
+	return 0;
+}
+
+static int interleave_process(struct audio_node *node, struct audio_buffer_view *buf,
+			      size_t *out_size)
+{
+	struct audio_interleave_state *state;
+	struct audio_buffer_view view;
+	bool planar_out;
+	size_t channels;
+	size_t plane;
+	size_t sets;
+	size_t done = 0;
+	int ret;
+
+	if (!node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_interleave_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open || !node->pipeline_format) {
+		LOG_ERR("process() on a closed interleave node");
+		return -EBADF;
+	}
+
+	if (state->passthrough) {
+		return audio_node_pull(node, buf, out_size);
+	}
+
+	*out_size = 0;
+	channels = node->pipeline_format->channels;
+	planar_out = node->pipeline_format->layout == AUDIO_FRAME_LAYOUT_PLANAR;
+
+	sets = buf->capacity / channels;
+	if (sets == 0U) {
+		LOG_ERR("a frame of %zu samples holds no %zu-channel set", buf->capacity, channels);
+		return -EINVAL;
+	}
+
+	plane = audio_frame_channel_stride(node->pipeline_format, buf);
+
+	while (done < sets) {
+		size_t want = MIN(sets - done, state->scratch_capacity / channels);
+		size_t got;
+
+		/* The scratch is a frame of exactly @p want sets, so a planar
+		 * one has its runs @p want apart.
+		 */
+		view.data = state->scratch;
+		view.capacity = want * channels;
+
+		ret = audio_node_pull(node, &view, &got);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (got % channels != 0U) {
+			LOG_ERR("upstream produced %zu samples, not whole %zu-channel sets", got,
+				channels);
+			return -EINVAL;
+		}
+
+		got /= channels;
+		if (planar_out) {
+			audio_dsp_deinterleave(&buf->data[done], plane, state->scratch, got,
+					       channels);
+		} else {
+			audio_dsp_interleave(&buf->data[done * channels], state->scratch, want, got,
+					     channels);
+		}
+		done += got;
+
+		/* Upstream has no more for now, or at all. */
+		if (got < want) {
+			break;
+		}
+	}
+
+	*out_size = done * channels;
+
+	return 0;
+}
+
+static int interleave_close(struct audio_node *node)
+{
+	struct audio_interleave_state *state = (struct audio_interleave_state *)node->state;
+
+	if (state) {
+		state->is_open = false;
+	}
+
+	return 0;
+}
+
+/* The copies move 32 bits a sample whatever they mean, so floats move too. */
+#define INTERLEAVE_FORMATS                                                                         \
+	(AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE) |                                     \
+	 AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_F32_LE))
+
+const struct audio_node_ops interleave_node_ops = {
+	.open = interleave_open,
+	.process = interleave_process,
+	.close = interleave_close,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED),
+	.formats = INTERLEAVE_FORMATS,
+};
+
+const struct audio_node_ops deinterleave_node_ops = {
+	.open = interleave_open,
+	.process = interleave_process,
+	.close = interleave_close,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+	.formats = INTERLEAVE_FORMATS,
+};
@@ -0,0 +1,203 @@
+/*
+ * Mixer node.
+ *
+ * Sums several input chains into one frame, each at its own Q15 gain, with
+ * saturation into the S32 container (spec §4.6). A node still has a single
+ * upstream pointer, so the inputs are a table of their own: the mixer pulls
+ * each of them through audio_node_pull_from(), which keeps the pull contract -
+ * the -EPIPE remap and the wiring check - identical to every other node's.
+ *
+ * Memory: one scratch frame, not one per input. The first input that delivers
+ * samples is pulled straight into the output frame and scaled in place; every
+ * later one is pulled into the scratch frame and accumulated into the output
+ * before the next is pulled. That is the same sum as pulling every input into
+ * a frame of its own first, in the same order, for 1/N of the RAM.
+ *
+ * End of stream: an input that ends before the others is dropped from the mix,
+ * which is the same as mixing it as silence, and is not pulled again for the
+ * rest of the track. The mixer ends the track once every input has ended, and
+ * forgets the ends as it does, so the next play() pulls every input again.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+#include "../audio_internal.h"
+
+LOG_MODULE_REGISTER(audio_mixer, LOG_LEVEL_INF);
+
+static int mixer_close_inputs(struct audio_mixer_state *state, uint8_t count)
+{
+	int first_err = 0;
+	int ret;
+	uint8_t i;
+
+	for (i = 0; i < count; i++) {
+		ret = audio_node_chain_close(state->inputs[i].upstream, NULL);
+		if (ret < 0 && first_err == 0) {
+			first_err = ret;
+		}
+	}
+
+	return first_err;
+}
+
+static int mixer_open(struct audio_node *node)
+{
+	struct audio_mixer_state *state = (struct audio_mixer_state *)node->state;
+	uint8_t i;
+	int ret;
+
+	if (!state || !state->inputs || state->input_count == 0U) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < state->input_count; i++) {
+		if (state->inputs[i].upstream == NULL) {
+			LOG_ERR("mixer input %u has no upstream", i);
+			return -ENOTSUP;
+		}
+	}
+
+	/* Every input after the first is pulled into the scratch frame, so a
+	 * segment frame larger than that is refused here, before the stream
+	 * starts, rather than by the first process() that mixes two inputs.
+	 * A mixer opened by hand knows no capacity yet; process() still checks
+	 * the frame it is handed.
+	 */
+	if (state->input_count > 1U && node->frame_capacity > state->scratch_samples) {
+		LOG_ERR("frame of %zu samples does not fit the mixer scratch of %zu",
+			node->frame_capacity, state->scratch_samples);
+		return -EINVAL;
+	}
+
+	/* The inputs run at the mixer's format and frame capacity: it sums
+	 * samples and converts none of them.
+	 */
+	for (i = 0; i < state->input_count; i++) {
+		state->inputs[i].ended = false;
+
+		ret = audio_node_chain_open(state->inputs[i].upstream, node->pipeline_format,
+					    node->frame_capacity);
+		if (ret < 0) {
+			(void)mixer_close_inputs(state, i);
+			return ret;
+		}
+	}
+
+	state->is_open = true;
+
+	return 0;
+}
+
+static int mixer_process(struct audio_node *node, struct audio_buffer_view *buf, size_t *out_size)
+{
+	struct audio_mixer_state *state = (struct audio_mixer_state *)node->state;
+	struct audio_buffer_view view;
+	size_t filled = 0U;
+	size_t size;
+	bool first = true;
+	uint8_t i;
+	int ret;
+
+	if (!state || !node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	*out_size = 0;
+
+	if (!state->is_open) {
+		return -EBADF;
+	}
+
+	if (state->input_count > 1U && buf->capacity > state->scratch_samples) {
+		LOG_ERR("frame of %zu samples does not fit the mixer scratch of %zu",
+			buf->capacity, state->scratch_samples);
+		return -ENOBUFS;
+	}
+
+	for (i = 0; i < state->input_count; i++) {
+		struct audio_mixer_input *input = &state->inputs[i];
+
+		if (input->ended) {
+			continue;
+		}
+
+		if (first) {
+			view = *buf;
+		} else {
+			view.data = state->scratch;
+			view.capacity = MIN(buf->capacity, state->scratch_samples);
+		}
+
+		ret = audio_node_pull_from(node, input->upstream, &view, &size);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (size == 0U) {
+			input->ended = true;
+			continue;
+		}
+
+		if (first) {
+			if (input->gain_q15 != AUDIO_DSP_UNITY_Q15) {
+				audio_dsp_gain_q15(buf->data, buf->data, size, input->gain_q15);
+			}
+
+			filled = size;
+			first = false;
+			continue;
+		}
+
+		/* Past the end of what the inputs so far delivered the output
+		 * holds nothing yet: there the input is stored, not added.
+		 */
+		audio_dsp_mac_q15(buf->data, state->scratch, MIN(size, filled), input->gain_q15);
+		if (size > filled) {
+			audio_dsp_gain_q15(&buf->data[filled], &state->scratch[filled], size - filled,
+					   input->gain_q15);
+			filled = size;
+		}
+	}
+
+	if (filled == 0U) {
+		/* Every input has ended: end the track, and start the next one
+		 * with all of them live again.
+		 */
+		for (i = 0; i < state->input_count; i++) {
+			state->inputs[i].ended = false;
+		}
+	}
+
+	*out_size = filled;
+
+	return 0;
+}
+
+static int mixer_close(struct audio_node *node)
+{
+	struct audio_mixer_state *state = (struct audio_mixer_state *)node->state;
+
+	if (!state || !state->is_open) {
+		return 0;
+	}
+
+	state->is_open = false;
+
+	return mixer_close_inputs(state, state->input_count);
+}
+
+const struct audio_node_ops mixer_node_ops = {
+	.open = mixer_open,
+	.process = mixer_process,
+	.close = mixer_close,
+};
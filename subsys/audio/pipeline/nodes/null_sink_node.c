@@ -31,4 +31,9 @@ const struct audio_node_ops null_sink_node_ops = {
 	.open = null_sink_open,
 	.process = null_sink_process,
 	.close = null_sink_close,
+	/* It never looks at a sample, so any layout or format will do. */
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED) |
+		   AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+	.formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE) |
+		   AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_F32_LE),
 };
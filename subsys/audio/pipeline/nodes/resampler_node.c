@@ -0,0 +1,242 @@
+/*
+ * Resampler node.
+ *
+ * Converts the stream from the rate its definition names to the rate it is
+ * opened with (spec §10.11), so a chain can join two rate domains: a 44.1 kHz
+ * file in front of a 48 kHz I2S sink, a 48 kHz microphone in front of a 16 kHz
+ * speech recogniser. It is the chain's converter: open() derives the format it
+ * needs from above - its own with the input rate - and publishes it as
+ * audio_node.upstream_format, which the walk that opened it installs on every
+ * node upstream (spec §5.2). The arithmetic is the shared resampling kernel's
+ * (spec §5.4), a windowed sinc in Q4.28 from a table the build generated.
+ *
+ * The node is the one place in the chain where a frame out is not a frame in,
+ * so it keeps the input itself: the sets an output still reaches are kept at
+ * the front of a static buffer, each pull lands behind them, and the kernel
+ * runs over the lot until the frame is full. How many pulls a frame takes is
+ * the ratio's business - none for some frames when interpolating, several for
+ * every frame when decimating - which is what the pull contract leaves to the
+ * node (spec §4.1.1).
+ *
+ * The kernel puts each output at its own time, so the node adds no delay; what
+ * it costs instead is that the first output waits for the input it reaches
+ * ahead of that time. Before the first input the stream is silence, and after
+ * the last one it is silence too: the node plays out its last outputs against
+ * silent sets it appends once upstream has ended, then reports the end itself.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+LOG_MODULE_REGISTER(audio_resampler, LOG_LEVEL_INF);
+
+int audio_resampler_set_input_rate(const struct audio_node *node, uint32_t rate_hz)
+{
+	struct audio_resampler_state *state;
+
+	if (!node || node->ops != &resampler_node_ops || !node->state || rate_hz == 0U) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_resampler_state *)node->state;
+	if (state->is_open) {
+		return -EBUSY;
+	}
+
+	state->input_rate_hz = rate_hz;
+
+	return 0;
+}
+
+static int resampler_open(struct audio_node *node)
+{
+	struct audio_resampler_state *state = (struct audio_resampler_state *)node->state;
+	const struct audio_stream_config *fmt;
+	size_t primed;
+
+	if (!state || !state->input || !state->kernel.wing || !state->kernel.coeffs ||
+	    state->input_rate_hz == 0U) {
+		return -EINVAL;
+	}
+
+	fmt = node->pipeline_format;
+	if (!fmt) {
+		LOG_ERR("no pipeline format installed");
+		return -EINVAL;
+	}
+
+	if (fmt->channels == 0U || fmt->channels > AUDIO_RESAMPLER_MAX_CHANNELS) {
+		LOG_ERR("%u channels, the node converts 1..%u", fmt->channels,
+			AUDIO_RESAMPLER_MAX_CHANNELS);
+		return -ENOTSUP;
+	}
+
+	/* The input the node keeps was sized for this ratio at most. */
+	if (fmt->sample_rate_hz == 0U ||
+	    state->input_rate_hz >
+		    (uint64_t)fmt->sample_rate_hz * AUDIO_RESAMPLER_MAX_DECIMATION) {
+		LOG_ERR("%u Hz to %u Hz decimates by more than %d", state->input_rate_hz,
+			fmt->sample_rate_hz, AUDIO_RESAMPLER_MAX_DECIMATION);
+		return -ENOTSUP;
+	}
+
+	/* Equal rates convert nothing, so the node declares no segment of its
+	 * own and the chain above runs on the format below, lending included.
+	 */
+	state->passthrough = state->input_rate_hz == fmt->sample_rate_hz;
+	if (!state->passthrough) {
+		state->input_format = *fmt;
+		state->input_format.sample_rate_hz = state->input_rate_hz;
+		node->upstream_format = &state->input_format;
+	}
+
+	state->eof = false;
+	state->input_count = 0;
+	state->flush_sets = 0U;
+
+	if (!state->passthrough) {
+		audio_dsp_resampler_prepare(&state->kernel, state->input_rate_hz,
+					    fmt->sample_rate_hz);
+
+		/* The first output is at the first input, and reaches that
+		 * far back into the silence before it.
+		 */
+		primed = (size_t)(state->kernel.reach - 1U) * fmt->channels;
+		memset(state->input, 0, sizeof(state->input[0]) * primed);
+		state->input_count = primed;
+		state->flush_sets = state->kernel.reach;
+	}
+
+	state->is_open = true;
+
+	return 0;
+}
+
+/* Append up to one pull's worth of input behind what the node keeps: a frame
+ * of the segment above, or of this one when no walk sized that.
+ */
+static int resampler_fill(struct audio_node *node, struct audio_resampler_state *state,
+			  size_t channels, size_t frame)
+{
+	struct audio_buffer_view view;
+	size_t free = state->input_capacity - state->input_count;
+	size_t got;
+	int ret;
+
+	if (node->upstream != NULL && node->upstream->frame_capacity != 0U) {
+		frame = node->upstream->frame_capacity;
+	}
+
+	view.data = &state->input[state->input_count];
+	view.capacity = MIN(free, frame) / channels * channels;
+
+	if (!state->eof) {
+		ret = audio_node_pull(node, &view, &got);
+		if (ret < 0) {
+			return ret;
+		}
+		if (got > 0) {
+			state->input_count += got;
+			return 0;
+		}
+
+		state->eof = true;
+	}
+
+	/* Past the end, silence, for as far as the last outputs reach. */
+	got = MIN((size_t)state->flush_sets, view.capacity / channels);
+	memset(view.data, 0, sizeof(view.data[0]) * got * channels);
+	state->input_count += got * channels;
+	state->flush_sets -= (uint16_t)got;
+
+	return 0;
+}
+
+static int resampler_process(struct audio_node *node, struct audio_buffer_view *buf,
+			     size_t *out_size)
+{
+	struct audio_resampler_state *state;
+	size_t channels;
+	size_t capacity;
+	size_t produced = 0;
+	int ret;
+
+	if (!node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_resampler_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open || !node->pipeline_format) {
+		LOG_ERR("process() on a closed resampler");
+		return -EBADF;
+	}
+
+	if (state->passthrough) {
+		return audio_node_pull(node, buf, out_size);
+	}
+
+	*out_size = 0;
+	channels = node->pipeline_format->channels;
+	capacity = buf->capacity / channels * channels;
+
+	for (;;) {
+		size_t consumed;
+
+		produced += audio_dsp_resample_q31(&buf->data[produced], capacity - produced,
+						   state->input, state->input_count, &consumed,
+						   &state->kernel, channels);
+
+		/* What no output reaches any more goes; the rest, usually not
+		 * much more than the reach, moves up to the front.
+		 */
+		state->input_count -= consumed;
+		memmove(state->input, &state->input[consumed],
+			sizeof(state->input[0]) * state->input_count);
+
+		if (produced == capacity || (state->eof && state->flush_sets == 0U)) {
+			break;
+		}
+
+		ret = resampler_fill(node, state, channels, capacity);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	/* 0 only once the input and the silence after it are used up: the end
+	 * of the stream, passed on.
+	 */
+	*out_size = produced;
+
+	return 0;
+}
+
+static int resampler_close(struct audio_node *node)
+{
+	struct audio_resampler_state *state = (struct audio_resampler_state *)node->state;
+
+	if (state) {
+		state->is_open = false;
+	}
+
+	return 0;
+}
+
+const struct audio_node_ops resampler_node_ops = {
+	.open = resampler_open,
+	.process = resampler_process,
+	.close = resampler_close,
+};
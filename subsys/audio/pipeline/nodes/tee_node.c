@@ -0,0 +1,283 @@
+/*
+ * Tee sink node and its tap source.
+ *
+ * The tee pulls one frame from its upstream and feeds it to several branch
+ * chains, so recording a stream and analysing it no longer means running the
+ * source twice (spec §4.5). Each branch is a chain of its own, topped by a tap:
+ * the tee hands the branch sink a buffer view and calls its process(), and the
+ * pull that arrives at the tap is answered with the frame the tee holds.
+ *
+ * The frame is shared, not copied, wherever that is safe. A tap that is handed
+ * the pulled frame itself has nothing to copy - the same in-place trick the
+ * ring node of a two-stage pipeline plays - and every read-only branch is
+ * handed exactly that. Read-only branches run first, so the frame is still
+ * intact for each of them; writing branches run after them, and all but the
+ * last one get a copy in the scratch buffer. The last writer needs none: no
+ * branch reads the frame after it.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+#include "../audio_internal.h"
+
+LOG_MODULE_REGISTER(audio_tee, LOG_LEVEL_INF);
+
+/* Top of the chain ending at @p sink, or NULL if the chain has none in reach. */
+static struct audio_node *tee_find_tap(struct audio_node *sink)
+{
+	struct audio_node *node = sink;
+	unsigned int depth = 0;
+
+	while (node != NULL && node->upstream != NULL) {
+		if (++depth > AUDIO_PIPELINE_MAX_CHAIN_DEPTH) {
+			return NULL;
+		}
+
+		node = node->upstream;
+	}
+
+	return node;
+}
+
+static int tee_close_branches(struct audio_tee_state *state, uint8_t count)
+{
+	int first_err = 0;
+	int ret;
+	uint8_t i;
+
+	for (i = 0; i < count; i++) {
+		struct audio_tee_branch *branch = &state->branches[i];
+
+		ret = audio_node_chain_close(branch->sink, NULL);
+		if (ret < 0 && first_err == 0) {
+			first_err = ret;
+		}
+
+		((struct audio_tee_tap_state *)branch->tap->state)->tee = NULL;
+	}
+
+	return first_err;
+}
+
+static int tee_open(struct audio_node *node)
+{
+	struct audio_tee_state *state = (struct audio_tee_state *)node->state;
+	uint8_t writers = 0U;
+	uint8_t i;
+	int ret;
+
+	if (!state || !state->branches || state->branch_count == 0U) {
+		return -EINVAL;
+	}
+
+	state->last_writer = -1;
+	state->frame = NULL;
+	state->frame_size = 0U;
+	state->copied_frames = 0U;
+
+	/* Bind every tap before any branch opens: a branch that fails to open
+	 * must leave no tap pointing at this tee.
+	 */
+	for (i = 0; i < state->branch_count; i++) {
+		struct audio_tee_branch *branch = &state->branches[i];
+		struct audio_node *tap = tee_find_tap(branch->sink);
+
+		if (tap == NULL || tap->ops != &tee_tap_node_ops || tap->state == NULL) {
+			LOG_ERR("tee branch %u is not topped by a tap", i);
+			return -EINVAL;
+		}
+
+		branch->tap = tap;
+		if (branch->writes) {
+			state->last_writer = (int8_t)i;
+			writers++;
+		}
+	}
+
+	/* Every writer but the last works on a copy in the scratch buffer, so
+	 * with two or more a segment frame larger than that is refused here,
+	 * before the stream starts, rather than by the first frame that is
+	 * copied. A tee opened by hand knows no capacity yet; the copy still
+	 * checks the frame it holds.
+	 */
+	if (writers > 1U && node->frame_capacity > state->scratch_samples) {
+		LOG_ERR("frame of %zu samples does not fit the tee scratch of %zu",
+			node->frame_capacity, state->scratch_samples);
+		return -EINVAL;
+	}
+
+	/* The branches run at the tee's format and frame capacity: the tee
+	 * passes frames on and changes nothing about them.
+	 */
+	for (i = 0; i < state->branch_count; i++) {
+		struct audio_tee_branch *branch = &state->branches[i];
+
+		((struct audio_tee_tap_state *)branch->tap->state)->tee = state;
+
+		ret = audio_node_chain_open(branch->sink, node->pipeline_format,
+					    node->frame_capacity);
+		if (ret < 0) {
+			((struct audio_tee_tap_state *)branch->tap->state)->tee = NULL;
+			(void)tee_close_branches(state, i);
+			return ret;
+		}
+	}
+
+	state->is_open = true;
+
+	return 0;
+}
+
+/* Drive @p branch once with the frame the tee holds. */
+static int tee_feed(struct audio_node *node, uint8_t index, struct audio_buffer_view *buf)
+{
+	struct audio_tee_state *state = (struct audio_tee_state *)node->state;
+	struct audio_tee_branch *branch = &state->branches[index];
+	struct audio_buffer_view view = *buf;
+	size_t branch_size;
+	int ret;
+
+	if (branch->writes && (int8_t)index != state->last_writer) {
+		if (state->frame_size > state->scratch_samples) {
+			LOG_ERR("frame of %zu samples does not fit the tee scratch of %zu",
+				state->frame_size, state->scratch_samples);
+			return -ENOBUFS;
+		}
+
+		view.data = state->scratch;
+		view.capacity = state->scratch_samples;
+	}
+
+	((struct audio_tee_tap_state *)branch->tap->state)->delivered = false;
+
+	/* On the tee's behalf, so a profile books the branch to the branch
+	 * rather than to the tee's own work.
+	 */
+	ret = audio_node_process_nested(node, branch->sink, &view, &branch_size);
+
+	return audio_eof_safe_errno(ret);
+}
+
+static int tee_process(struct audio_node *node, struct audio_buffer_view *buf, size_t *out_size)
+{
+	struct audio_tee_state *state = (struct audio_tee_state *)node->state;
+	uint8_t i;
+	int ret;
+
+	if (!state || !node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	if (!state->is_open) {
+		*out_size = 0;
+		return -EBADF;
+	}
+
+	ret = audio_node_pull(node, buf, out_size);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* End of stream is fed through as well, so every branch sink sees it
+	 * exactly as it would as the sink of a pipeline.
+	 */
+	state->frame = buf->data;
+	state->frame_size = *out_size;
+
+	for (i = 0; i < state->branch_count; i++) {
+		if (!state->branches[i].writes) {
+			ret = tee_feed(node, i, buf);
+			if (ret < 0) {
+				goto fail;
+			}
+		}
+	}
+
+	for (i = 0; i < state->branch_count; i++) {
+		if (state->branches[i].writes) {
+			ret = tee_feed(node, i, buf);
+			if (ret < 0) {
+				goto fail;
+			}
+		}
+	}
+
+	return 0;
+
+fail:
+	*out_size = 0;
+	return ret;
+}
+
+static int tee_close(struct audio_node *node)
+{
+	struct audio_tee_state *state = (struct audio_tee_state *)node->state;
+
+	if (!state || !state->is_open) {
+		return 0;
+	}
+
+	state->is_open = false;
+	state->frame = NULL;
+	state->frame_size = 0U;
+
+	return tee_close_branches(state, state->branch_count);
+}
+
+const struct audio_node_ops tee_node_ops = {
+	.open = tee_open,
+	.process = tee_process,
+	.close = tee_close,
+};
+
+/*
+ * One frame per feed: a branch node that pulls again within the same feed is
+ * told the stream ended, as a node pulling past a short source would be.
+ */
+static int tee_tap_process(struct audio_node *node, struct audio_buffer_view *buf,
+			   size_t *out_size)
+{
+	struct audio_tee_tap_state *tap = (struct audio_tee_tap_state *)node->state;
+	struct audio_tee_state *tee;
+
+	if (!tap || !node || !buf || !out_size) {
+		return -EINVAL;
+	}
+
+	*out_size = 0;
+
+	tee = tap->tee;
+	if (tee == NULL) {
+		/* No open tee reaches this tap, so as far as the chain is
+		 * concerned it was never opened.
+		 */
+		return -EBADF;
+	}
+
+	if (tap->delivered) {
+		return 0;
+	}
+
+	tap->delivered = true;
+	*out_size = MIN(tee->frame_size, buf->capacity);
+
+	if (buf->data != tee->frame && *out_size > 0U) {
+		memcpy(buf->data, tee->frame, *out_size * sizeof(int32_t));
+		tee->copied_frames++;
+	}
+
+	return 0;
+}
+
+const struct audio_node_ops tee_tap_node_ops = {
+	.process = tee_tap_process,
+};
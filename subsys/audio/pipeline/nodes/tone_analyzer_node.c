@@ -41,6 +41,15 @@
  * is an in-band *fraction*: an absolute magnitude cannot tell a correct tone
  * from a louder wrong one, and a fraction can.
  *
+ * The pairs are what a swap verdict costs, so the work per sample set grows
+ * with the square of the channel count and nothing can make it linear. What
+ * the node does make linear is everything around the arithmetic: whole sample
+ * sets are folded one recurrence at a time - a channel's tone runs down the
+ * frame with its two states and its coefficient in registers, then the next -
+ * rather than sample by sample with every state reloaded from the node for
+ * every sample of every set. At sixteen channels a set touches 256 recurrences,
+ * and that reload is what the block order takes out of the inner loop.
+ *
  * Sizing the accumulators
  * -----------------------
  * The recurrence is a marginally stable resonator and its state is much larger
@@ -415,6 +424,79 @@ static void tone_analyzer_reset_window(struct audio_tone_analyzer_state *state)
 	state->channel_pos = 0U;
 }
 
+/*
+ * @p sets whole interleaved sample sets at @p data into the window, one
+ * recurrence at a time.
+ *
+ * Exactly what tone_analyzer_sample() does set by set, in another order: no
+ * accumulator depends on another channel's or another tone's, so running each
+ * one down the block on its own yields the same integers - and keeps the
+ * handful it touches in registers rather than the node's whole state in flight.
+ */
+static void tone_analyzer_fold(struct audio_tone_analyzer_state *state, const int32_t *data,
+			       size_t sets, uint8_t channels, uint8_t tones)
+{
+	uint8_t channel;
+	uint8_t tone;
+	size_t n;
+
+	for (channel = 0U; channel < channels; channel++) {
+		const int32_t *in = &data[channel];
+		int64_t energy = state->energy[channel];
+		int64_t xx = state->fit_xx[channel];
+		int64_t yy = state->fit_yy[channel];
+		int64_t xy = state->fit_xy[channel];
+		int32_t prev1 = state->prev1[channel];
+		int32_t prev2 = state->prev2[channel];
+		uint8_t history = state->history[channel];
+
+		for (tone = 0U; tone < tones; tone++) {
+			const int64_t coeff = state->coeff_q24[tone];
+			int64_t s1 = state->s1[channel][tone];
+			int64_t s2 = state->s2[channel][tone];
+
+			for (n = 0U; n < sets; n++) {
+				int64_t x = in[n * channels] >> AUDIO_TONE_ANALYZER_INPUT_SHIFT;
+				int64_t s0 = x + ((coeff * s1) >> TONE_ANALYZER_COEFF_SHIFT) - s2;
+
+				s2 = s1;
+				s1 = s0;
+			}
+
+			state->s1[channel][tone] = s1;
+			state->s2[channel][tone] = s2;
+		}
+
+		for (n = 0U; n < sets; n++) {
+			int32_t x = in[n * channels] >> AUDIO_TONE_ANALYZER_INPUT_SHIFT;
+
+			energy += (int64_t)x * x;
+
+			if (history >= 2U) {
+				int64_t centre = prev1;
+				int64_t neighbours = (int64_t)prev2 + x;
+
+				xx += centre * centre;
+				yy += neighbours * neighbours;
+				xy += centre * neighbours;
+			} else {
+				history++;
+			}
+
+			prev2 = prev1;
+			prev1 = x;
+		}
+
+		state->energy[channel] = energy;
+		state->fit_xx[channel] = xx;
+		state->fit_yy[channel] = yy;
+		state->fit_xy[channel] = xy;
+		state->prev1[channel] = prev1;
+		state->prev2[channel] = prev2;
+		state->history[channel] = history;
+	}
+}
+
 /* One sample of one channel into every accumulator that channel owns. */
 static void tone_analyzer_sample(struct audio_tone_analyzer_state *state, uint8_t channel,
 				 uint8_t tones, int32_t x)
@@ -465,8 +547,9 @@ static void tone_analyzer_sample(struct audio_tone_analyzer_state *state, uint8_
  *  - Then any silent channel, because a channel carrying nothing is a
  *    different fault from a channel carrying the wrong thing, and it is the
  *    one to fix first.
- *  - Then the swap: every channel carrying its neighbour's tone. v1 runs 1 or
- *    2 channels (spec §5.2), so the rotation is the only permutation there is.
+ *  - Then the swap: every channel carrying one of the expected tones, and no
+ *    tone turning up on two of them, so the tones arrived as a reordering of
+ *    the channels. A pass having been ruled out, it is not the identity.
  *  - Then noise before a wrong frequency, because "there is no tone in this"
  *    is the stronger statement of the two.
  */
@@ -477,6 +560,7 @@ tone_analyzer_decide(const struct audio_tone_analyzer_result *window, uint8_t ch
 	bool swapped = channels > 1U;
 	bool any_silent = false;
 	bool any_noise = false;
+	uint32_t claimed = 0U;
 	uint8_t channel;
 
 	for (channel = 0U; channel < channels; channel++) {
@@ -486,9 +570,16 @@ tone_analyzer_decide(const struct audio_tone_analyzer_result *window, uint8_t ch
 			pass = false;
 		}
 
-		if (channels > 1U &&
-		    ch->in_band_q15[(channel + 1U) % channels] < AUDIO_TONE_ANALYZER_PASS_Q15) {
+		/* A present tone is over half the channel's energy, so it is
+		 * also the strongest one there; a tone claimed twice is two
+		 * wires carrying the same signal, which is not a reordering.
+		 */
+		if (ch->strongest < 0 ||
+		    ch->in_band_q15[ch->strongest] < AUDIO_TONE_ANALYZER_PASS_Q15 ||
+		    (claimed & BIT(ch->strongest)) != 0U) {
 			swapped = false;
+		} else {
+			claimed |= BIT(ch->strongest);
 		}
 
 		if (ch->silent) {
@@ -521,19 +612,20 @@ tone_analyzer_decide(const struct audio_tone_analyzer_result *window, uint8_t ch
 static void tone_analyzer_finish(struct audio_tone_analyzer_state *state, uint8_t channels,
 				 uint8_t tones)
 {
-	struct audio_tone_analyzer_result window = {
-		.windows = state->result.windows + 1U,
-		.window_samples = state->window_samples,
-		.channels = channels,
-		.tones = tones,
-	};
+	struct audio_tone_analyzer_result *window = &state->pending;
 	enum audio_tone_analyzer_verdict previous = state->result.verdict;
 	k_spinlock_key_t key;
 	uint8_t channel;
 	uint8_t tone;
 
+	memset(window, 0, sizeof(*window));
+	window->windows = state->result.windows + 1U;
+	window->window_samples = state->window_samples;
+	window->channels = channels;
+	window->tones = tones;
+
 	for (channel = 0U; channel < channels; channel++) {
-		struct audio_tone_analyzer_channel_result *ch = &window.channel[channel];
+		struct audio_tone_analyzer_channel_result *ch = &window->channel[channel];
 		int64_t energy = state->energy[channel];
 
 		ch->rms = (int32_t)tone_analyzer_isqrt(
@@ -560,28 +652,57 @@ static void tone_analyzer_finish(struct audio_tone_analyzer_state *state, uint8_
 		}
 	}
 
-	window.verdict = tone_analyzer_decide(&window, channels);
+	window->verdict = tone_analyzer_decide(window, channels);
 
 	/* The only state this node publishes outside the pipeline thread, and
 	 * the only place it is written (spec §3.3). A whole window at a time, so
 	 * a reader never sees one channel of this window beside one of the last.
 	 */
 	key = k_spin_lock(&state->lock);
-	state->result = window;
+	state->result = *window;
 	k_spin_unlock(&state->lock, key);
 
 	/* Logged on a change only: a verdict per window is one every few
 	 * milliseconds, and a log that scrolls is a log nobody reads. Nothing
 	 * depends on this line - the result is a value.
 	 */
-	if (window.verdict != previous) {
-		LOG_INF("window %u: %s", window.windows,
-			tone_analyzer_verdict_name[window.verdict]);
+	if (window->verdict != previous) {
+		LOG_INF("window %u: %s", window->windows,
+			tone_analyzer_verdict_name[window->verdict]);
 	}
 
 	tone_analyzer_reset_window(state);
 }
 
+/*
+ * One interleaved sample into the window: the channel it belongs to, then the
+ * set and the window it may complete.
+ */
+static void tone_analyzer_step(struct audio_tone_analyzer_state *state, int32_t sample,
+			       uint8_t channels, uint8_t tones)
+{
+	uint8_t channel = state->channel_pos;
+
+	/* spec §5.3's convention, the file writer's narrowing verbatim. Both
+	 * sides of every ratio this node reports are narrowed alike, so nothing
+	 * a verdict depends on is in the bits below.
+	 */
+	tone_analyzer_sample(state, channel, tones, sample >> AUDIO_TONE_ANALYZER_INPUT_SHIFT);
+
+	channel++;
+	if (channel < channels) {
+		state->channel_pos = channel;
+		return;
+	}
+
+	state->channel_pos = 0U;
+	state->filled++;
+
+	if (state->filled >= state->window_samples) {
+		tone_analyzer_finish(state, channels, tones);
+	}
+}
+
 /* -------------------------------------------------------------------------
  * Node operations
  * -------------------------------------------------------------------------
@@ -702,9 +823,11 @@ static int tone_analyzer_process(struct audio_node *node, struct audio_buffer_vi
 				 size_t *out_size)
 {
 	struct audio_tone_analyzer_state *state;
+	const int32_t *data;
 	uint8_t channels;
 	uint8_t tones;
-	size_t i;
+	size_t count;
+	size_t i = 0U;
 	int ret;
 
 	if (!node || !buf || !buf->data || !out_size) {
@@ -748,35 +871,39 @@ static int tone_analyzer_process(struct audio_node *node, struct audio_buffer_vi
 	 */
 	channels = node->pipeline_format->channels;
 	tones = state->tone_count;
+	data = buf->data;
+	count = *out_size;
 
-	for (i = 0U; i < *out_size; i++) {
-		uint8_t channel = state->channel_pos;
-
-		/* spec §5.3's convention, the file writer's narrowing verbatim.
-		 * Both sides of every ratio this node reports are narrowed
-		 * alike, so nothing a verdict depends on is in the bits below.
-		 */
-		tone_analyzer_sample(state, channel, tones,
-				     buf->data[i] >> AUDIO_TONE_ANALYZER_INPUT_SHIFT);
+	/* The interleave position is carried across frames, so a frame that
+	 * ends mid sample set - which nothing forbids - does not transpose
+	 * every channel of the frames that follow. A set an earlier frame
+	 * began is finished sample by sample...
+	 */
+	while (i < count && state->channel_pos != 0U) {
+		tone_analyzer_step(state, data[i++], channels, tones);
+	}
 
-		/* The interleave position is carried across frames, so a frame
-		 * that ends mid sample set - which nothing forbids - does not
-		 * transpose every channel of the frames that follow.
-		 */
-		channel++;
-		if (channel < channels) {
-			state->channel_pos = channel;
-			continue;
-		}
+	/* ...the whole sets after it are folded a block at a time, each block
+	 * ending where the frame or the window does...
+	 */
+	while (count - i >= channels) {
+		size_t sets = MIN((count - i) / channels,
+				  (size_t)(state->window_samples - state->filled));
 
-		state->channel_pos = 0U;
-		state->filled++;
+		tone_analyzer_fold(state, &data[i], sets, channels, tones);
+		i += sets * channels;
+		state->filled += (uint32_t)sets;
 
 		if (state->filled >= state->window_samples) {
 			tone_analyzer_finish(state, channels, tones);
 		}
 	}
 
+	/* ...and what is left begins a set the next frame finishes. */
+	while (i < count) {
+		tone_analyzer_step(state, data[i++], channels, tones);
+	}
+
 	return 0;
 }
 
@@ -111,7 +111,7 @@ static int32_t tone_gen_sine_q15(uint32_t phase)
 }
 
 /*
- * One container sample for tone @p tone at its current phase.
+ * One container sample of a tone at @p phase, scaled by @p amplitude_q15.
  *
  * The Q15 table value is scaled by the configured amplitude and then shifted up
  * by 16, which is the file reader's s32 = s16 << 16 convention (spec §5.3): the
@@ -125,9 +125,9 @@ static int32_t tone_gen_sine_q15(uint32_t phase)
  * left-shifting a negative signed value is not defined by the C standard, while
  * the two's complement result is exactly what the convention asks for.
  */
-static int32_t tone_gen_sample(const struct audio_tone_gen_state *state, uint8_t tone)
+static int32_t tone_gen_sample(uint32_t phase, int32_t amplitude_q15)
 {
-	int32_t value = (tone_gen_sine_q15(state->phase[tone]) * state->amplitude_q15) >> 15;
+	int32_t value = (tone_gen_sine_q15(phase) * amplitude_q15) >> 15;
 
 	return (int32_t)((uint32_t)value << 16);
 }
@@ -197,8 +197,9 @@ static int tone_gen_open(struct audio_node *node)
 	 * adapt). More tones than channels would mean dropping one, and the
 	 * dropped one is what tells a swapped pair of wires apart downstream;
 	 * fewer would leave a channel with no frequency at all. The definition
-	 * names at most AUDIO_TONE_GEN_MAX_TONES, so this also rules out a
-	 * channel count process() could not divide a frame by - zero included.
+	 * names at most AUDIO_TONE_GEN_MAX_TONES, the pipeline's channel
+	 * ceiling, so this also rules out a channel count process() could not
+	 * divide a frame by - zero included.
 	 */
 	if (state->tone_count != fmt->channels) {
 		LOG_ERR("%u tones do not match the pipeline's %u channels", state->tone_count,
@@ -251,7 +252,6 @@ static int tone_gen_process(struct audio_node *node, struct audio_buffer_view *b
 	struct audio_tone_gen_state *state;
 	size_t channels;
 	size_t samples;
-	size_t i;
 	uint8_t tone;
 
 	if (!node || !buf || !buf->data || !out_size) {
@@ -313,11 +313,26 @@ static int tone_gen_process(struct audio_node *node, struct audio_buffer_view *b
 		samples = MIN(samples, left);
 	}
 
-	for (i = 0U; i < samples; i += channels) {
-		for (tone = 0U; tone < channels; tone++) {
-			buf->data[i + tone] = tone_gen_sample(state, tone);
-			state->phase[tone] += state->phase_step[tone];
+	/* One channel at a time, striding through the frame: the channel's
+	 * accumulator and increment stay in registers for the whole frame
+	 * instead of being reloaded for every sample of every set, so the cost
+	 * per sample is the same at sixteen channels as at one. The writes
+	 * still land in order within each cache line the frame spans, and the
+	 * samples are the same ones the set-by-set order produced.
+	 */
+	for (tone = 0U; tone < channels; tone++) {
+		const uint32_t step = state->phase_step[tone];
+		const int32_t amplitude_q15 = state->amplitude_q15;
+		uint32_t phase = state->phase[tone];
+		int32_t *out = &buf->data[tone];
+		size_t i;
+
+		for (i = 0U; i < samples; i += channels) {
+			out[i] = tone_gen_sample(phase, amplitude_q15);
+			phase += step;
 		}
+
+		state->phase[tone] = phase;
 	}
 
 	state->produced += (uint32_t)samples;
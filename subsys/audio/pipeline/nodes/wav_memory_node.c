@@ -0,0 +1,252 @@
+/*
+ * WAV memory source node.
+ *
+ * Plays a RIFF/WAVE image that is already in the address space - a const
+ * array, or a blob the linker placed in flash - without a filesystem
+ * (spec §10.15). open() parses the header once with the shared parser, as the
+ * file reader does, and checks the image the same way; process() widens 16 bit
+ * PCM straight from the payload into the frame. Nothing is read into a buffer
+ * first and nothing is called per frame but the widening, so a short prompt
+ * costs what its samples cost.
+ *
+ * A region of the payload, in sample sets, can be played instead of the whole
+ * of it, and looped. A looping source never reports end of stream: it is
+ * stopped by the application, like an endless tone generator.
+ *
+ * The image is only ever read, and read a byte at a time where it matters: a
+ * payload in flash starts wherever its header ends, which need not be a
+ * 16 bit boundary.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_wav.h>
+
+LOG_MODULE_REGISTER(audio_wav_memory, LOG_LEVEL_INF);
+
+/* v1 converts 16 bit PCM; the file reader has a kernel per layout. */
+#define WAV_MEMORY_BITS_PER_SAMPLE 16U
+#define WAV_MEMORY_BYTES_PER_SAMPLE (WAV_MEMORY_BITS_PER_SAMPLE / 8U)
+
+/*
+ * Widen @p count little endian 16 bit samples at @p src into the S32_LE
+ * container (spec §5.3: s32 = s16 << 16). The source is not the frame, so
+ * unlike the file reader's this runs front to back.
+ */
+static void wav_memory_widen_s16(int32_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		int16_t sample = (int16_t)sys_get_le16(&src[i * WAV_MEMORY_BYTES_PER_SAMPLE]);
+
+		dst[i] = (int32_t)((uint32_t)(int32_t)sample << 16);
+	}
+}
+
+static int wav_memory_open(struct audio_node *node)
+{
+	const struct audio_stream_config *want;
+	struct audio_wav_memory_state *state;
+	struct audio_wav_header wav;
+	size_t image_len;
+	size_t set_bytes;
+	uint32_t sets;
+	int ret;
+
+	if (!node) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_wav_memory_state *)node->state;
+	if (!state || !state->image || state->image_end < state->image) {
+		return -EINVAL;
+	}
+
+	state->is_open = false;
+	memset(&state->fmt, 0, sizeof(state->fmt));
+
+	image_len = (size_t)(state->image_end - state->image);
+
+	ret = audio_wav_read_header(state->image, image_len, &wav);
+	if (ret < 0) {
+		LOG_ERR("%p: not a usable WAVE image (%d)", (const void *)state->image, ret);
+		return ret;
+	}
+
+	if (wav.bits_per_sample != WAV_MEMORY_BITS_PER_SAMPLE) {
+		LOG_ERR("%p: %u bit PCM is not supported", (const void *)state->image,
+			wav.bits_per_sample);
+		return -ENOTSUP;
+	}
+
+	if (wav.channels == 0U || wav.channels > CONFIG_AUDIO_PIPELINE_MAX_CHANNELS) {
+		LOG_ERR("%p: %u channels are outside the range of 1..%u",
+			(const void *)state->image, wav.channels,
+			CONFIG_AUDIO_PIPELINE_MAX_CHANNELS);
+		return -ENOTSUP;
+	}
+
+	/* Validated against the bound format like a file (spec §5.2/§10.1):
+	 * a clip at another rate is a resampler's to convert, below this node.
+	 */
+	want = node->pipeline_format;
+	if (want != NULL && (wav.sample_rate_hz != want->sample_rate_hz ||
+			     wav.channels != want->channels)) {
+		LOG_ERR("%p: %u Hz, %u ch does not match the pipeline's %u Hz, %u ch",
+			(const void *)state->image, wav.sample_rate_hz, wav.channels,
+			want->sample_rate_hz, want->channels);
+		return -ENOTSUP;
+	}
+
+	/* An image cut short plays what it holds, as a file shorter than its
+	 * header promised does; a payload that stops mid set has no usable
+	 * tail.
+	 */
+	set_bytes = (size_t)wav.channels * WAV_MEMORY_BYTES_PER_SAMPLE;
+	sets = (uint32_t)(MIN((size_t)wav.data_size, image_len - wav.data_offset) / set_bytes);
+
+	if (state->region_start > sets ||
+	    (state->region_sets != 0U && state->region_sets > sets - state->region_start)) {
+		LOG_ERR("%p: region of %u sets at %u is outside the %u of the payload",
+			(const void *)state->image, state->region_sets, state->region_start,
+			sets);
+		return -EINVAL;
+	}
+
+	state->first = state->region_start;
+	state->end = state->region_sets != 0U ? state->region_start + state->region_sets : sets;
+
+	/* Looping nothing would spin process() forever. */
+	if (state->loop && state->end == state->first) {
+		LOG_ERR("%p: nothing to loop", (const void *)state->image);
+		return -EINVAL;
+	}
+
+	state->fmt.sample_rate_hz = wav.sample_rate_hz;
+	state->fmt.channels = (uint8_t)wav.channels;
+	state->fmt.valid_bits_per_sample = (uint8_t)wav.bits_per_sample;
+	state->fmt.format = AUDIO_SAMPLE_FORMAT_S32_LE;
+
+	state->payload = state->image + wav.data_offset;
+	state->pos = state->first;
+	state->is_open = true;
+
+	LOG_INF("%p: %u Hz, %u ch, %u bit, sets %u..%u of %u%s", (const void *)state->image,
+		wav.sample_rate_hz, wav.channels, wav.bits_per_sample, state->first, state->end,
+		sets, state->loop ? ", looped" : "");
+
+	return 0;
+}
+
+static int wav_memory_process(struct audio_node *node, struct audio_buffer_view *buf,
+			      size_t *out_size)
+{
+	struct audio_wav_memory_state *state;
+	size_t channels;
+	size_t sets;
+	size_t done = 0;
+
+	if (!node || !buf || !buf->data || !out_size) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_wav_memory_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	*out_size = 0;
+
+	if (!state->is_open) {
+		LOG_ERR("process() on a closed WAV memory source");
+		return -EBADF;
+	}
+
+	/* As for the file reader: a frame that cannot hold one set is a caller
+	 * error, and reporting EOF for it would truncate the clip.
+	 */
+	channels = state->fmt.channels;
+	sets = buf->capacity / channels;
+	if (sets == 0U) {
+		LOG_ERR("buffer of %zu samples is too small for %zu channels", buf->capacity,
+			channels);
+		return -EINVAL;
+	}
+
+	while (done < sets) {
+		size_t n;
+
+		if (state->pos == state->end) {
+			if (!state->loop) {
+				break;
+			}
+			state->pos = state->first;
+		}
+
+		n = MIN(sets - done, (size_t)(state->end - state->pos));
+		wav_memory_widen_s16(&buf->data[done * channels],
+				     &state->payload[(size_t)state->pos * channels *
+						     WAV_MEMORY_BYTES_PER_SAMPLE],
+				     n * channels);
+		state->pos += (uint32_t)n;
+		done += n;
+	}
+
+	/* 0 once the region is played out, and from then on (manifest §7). */
+	*out_size = done * channels;
+
+	return 0;
+}
+
+static int wav_memory_close(struct audio_node *node)
+{
+	struct audio_wav_memory_state *state;
+
+	if (!node) {
+		return -EINVAL;
+	}
+
+	state = (struct audio_wav_memory_state *)node->state;
+	if (!state) {
+		return -EINVAL;
+	}
+
+	state->is_open = false;
+	memset(&state->fmt, 0, sizeof(state->fmt));
+
+	return 0;
+}
+
+const struct audio_node_ops wav_memory_node_ops = {
+	.open = wav_memory_open,
+	.process = wav_memory_process,
+	.close = wav_memory_close,
+};
+
+int audio_wav_memory_set_region(const struct audio_node *node, uint32_t start_set, uint32_t sets,
+				bool loop)
+{
+	struct audio_wav_memory_state *state;
+
+	if (!node || node->ops != &wav_memory_node_ops || !node->state) {
+		return -EINVAL;
+	}
+
+	/* Read by open() only, so a run keeps the region it started with. */
+	state = (struct audio_wav_memory_state *)node->state;
+	state->region_start = start_set;
+	state->region_sets = sets;
+	state->loop = loop;
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * Shared plumbing of the node benchmark: the clock, the result row and the
+ * matrix every case runs over.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_BENCH_H_
+#define AUDIO_BENCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/audio/audio_format.h>
+
+/*
+ * Samples one case pushes through per repetition, interleaved across all
+ * channels like every sample count in the subsystem. A multiple of every
+ * frame size in the matrix, so no case ends on a partial frame.
+ */
+#define BENCH_SAMPLES 16384U
+
+/*
+ * Repetitions per case; the fastest one is reported. The minimum is what the
+ * code costs, everything above it is the host scheduling something else, and
+ * it is the figure that stays put between two runs of the same commit.
+ */
+#define BENCH_REPEATS 5U
+
+/* Total samples per frame the cases run at; the pipeline's range is 2..1024. */
+#define BENCH_FRAME_SIZES 32U, 128U, 512U, 1024U
+
+/* The v1 channel range. */
+#define BENCH_MAX_CHANNELS 2U
+
+#define BENCH_RATE_HZ 48000U
+
+/** A point on the clock: nanoseconds, and host or CPU cycles where known. */
+struct bench_stamp {
+	uint64_t ns;
+	uint64_t cycles;
+};
+
+/** What one case measured, over its fastest repetition. */
+struct bench_result {
+	/** Samples (or, for a per-call case, calls) the repetition covered. */
+	uint64_t samples;
+	/** Elapsed time of the repetition. */
+	struct bench_stamp elapsed;
+};
+
+void bench_clock_now(struct bench_stamp *stamp);
+
+/** @brief Time elapsed since @p start, a stamp from bench_clock_now(). */
+void bench_clock_since(const struct bench_stamp *start, struct bench_stamp *elapsed);
+
+/** @brief Keep the faster of @p best and @p run in @p best. */
+void bench_keep_best(struct bench_result *best, const struct bench_result *run);
+
+/**
+ * @brief Print one result row.
+ *
+ * @param node          What was measured.
+ * @param variant       Which configuration of it, e.g. "process" or "s16".
+ * @param channels      Channel count, 0 where channels do not apply.
+ * @param frame_samples Samples per call, 0 for a per-call case.
+ */
+void bench_report(const char *node, const char *variant, unsigned int channels,
+		  unsigned int frame_samples, const struct bench_result *result);
+
+/** @brief The format every node case binds, at @p channels. */
+void bench_format(struct audio_stream_config *fmt, uint8_t channels);
+
+/* Frame storage the cases run in, one frame of the largest size. */
+extern int32_t bench_frame[];
+
+int bench_codecs_run(void);
+int bench_dsp_run(void);
+int bench_nodes_run(void);
+
+#endif /* AUDIO_BENCH_H_ */
@@ -0,0 +1,77 @@
+/*
+ * The benchmark clock and the result rows.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/time_units.h>
+
+#include "bench.h"
+
+#ifdef CONFIG_ARCH_POSIX
+/* bench_clock_host.c, on the host side of the simulator. */
+uint64_t audio_bench_host_ns(void);
+uint64_t audio_bench_host_cycles(void);
+#endif
+
+void bench_clock_now(struct bench_stamp *stamp)
+{
+#ifdef CONFIG_ARCH_POSIX
+	stamp->cycles = audio_bench_host_cycles();
+	stamp->ns = audio_bench_host_ns();
+#else
+	/* A repetition is milliseconds long, so the 32 bit counter cannot
+	 * wrap twice inside one and bench_clock_since() stays exact.
+	 */
+	stamp->cycles = k_cycle_get_32();
+	stamp->ns = 0U;
+#endif
+}
+
+void bench_clock_since(const struct bench_stamp *start, struct bench_stamp *elapsed)
+{
+	struct bench_stamp now;
+
+	bench_clock_now(&now);
+
+#ifdef CONFIG_ARCH_POSIX
+	elapsed->ns = now.ns - start->ns;
+	elapsed->cycles = now.cycles - start->cycles;
+#else
+	elapsed->cycles = (uint32_t)now.cycles - (uint32_t)start->cycles;
+	elapsed->ns = k_cyc_to_ns_floor64(elapsed->cycles);
+#endif
+}
+
+void bench_keep_best(struct bench_result *best, const struct bench_result *run)
+{
+	if (best->samples == 0U || run->elapsed.ns < best->elapsed.ns) {
+		*best = *run;
+	}
+}
+
+void bench_report(const char *node, const char *variant, unsigned int channels,
+		  unsigned int frame_samples, const struct bench_result *result)
+{
+	uint64_t ns = MAX(result->elapsed.ns, 1U);
+	uint64_t per_sec = result->samples * 1000000000ULL / ns;
+	/* Hundredths, printed as a fixed-point decimal: printk has no %f. */
+	uint64_t cyc_x100 = (result->samples == 0U)
+				    ? 0U
+				    : result->elapsed.cycles * 100U / result->samples;
+
+	printk("BENCH,%s,%s,%u,%u,%llu,%llu,%llu,%llu.%02u\n", node, variant, channels,
+	       frame_samples, (unsigned long long)result->samples, (unsigned long long)ns,
+	       (unsigned long long)per_sec, (unsigned long long)(cyc_x100 / 100U),
+	       (unsigned int)(cyc_x100 % 100U));
+}
+
+void bench_format(struct audio_stream_config *fmt, uint8_t channels)
+{
+	fmt->sample_rate_hz = BENCH_RATE_HZ;
+	fmt->channels = channels;
+	fmt->valid_bits_per_sample = 16U;
+	fmt->format = AUDIO_SAMPLE_FORMAT_S32_LE;
+}
@@ -0,0 +1,238 @@
+/*
+ * The shared codecs: the I2S wire converters both I2S nodes run every frame
+ * through (spec §10.5), the PCM kernels the file reader and writer convert a
+ * payload with, one per layout and direction (spec §5.3), and the WAV header
+ * parser the file reader opens with (spec §10.3).
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_i2s_wire.h>
+#include <zephyr/audio/audio_wav.h>
+
+#include "bench.h"
+
+/* Parses per repetition of a header case. */
+#define BENCH_WAV_CALLS 4096U
+
+/* Bytes of the chunk the second header case puts ahead of "data". */
+#define BENCH_WAV_LIST_BYTES 26U
+
+static const uint32_t frame_sizes[] = {BENCH_FRAME_SIZES};
+
+/* Depths to try; the ones the wire module does not carry are skipped. */
+static const uint8_t wire_depths[] = {16U, 24U, 32U};
+
+static uint8_t wire_block[1024U * AUDIO_I2S_WIRE_MAX_WORD_BYTES];
+
+/* The payload layouts of a WAVE file, as the file nodes pick them. */
+static const struct {
+	const char *name;
+	audio_dsp_unpack_fn unpack;
+	audio_dsp_pack_fn pack;
+} pcm_layouts[] = {
+	{"u8", audio_dsp_unpack_u8, audio_dsp_pack_u8},
+	{"s16", audio_dsp_unpack_s16, audio_dsp_pack_s16},
+	{"s24", audio_dsp_unpack_s24, audio_dsp_pack_s24},
+	{"s32", audio_dsp_unpack_s32, audio_dsp_pack_s32},
+	{"f32", audio_dsp_unpack_f32, audio_dsp_pack_f32},
+};
+
+static uint8_t pcm_block[1024U * sizeof(int32_t)];
+
+static int bench_wire(uint8_t depth, bool to_container, uint32_t frame)
+{
+	struct bench_result best = {0};
+	struct bench_result run;
+	struct bench_stamp start;
+	uint32_t rep;
+	uint32_t i;
+	char variant[24];
+	int ret = 0;
+
+	for (rep = 0; rep < BENCH_REPEATS; rep++) {
+		bench_clock_now(&start);
+		for (i = 0; i < BENCH_SAMPLES; i += frame) {
+			ret = to_container
+				      ? audio_i2s_wire_to_container(depth, wire_block,
+								    sizeof(wire_block), bench_frame,
+								    frame)
+				      : audio_i2s_wire_from_container(depth, bench_frame, frame,
+								      wire_block,
+								      sizeof(wire_block));
+			if (ret < 0) {
+				return ret;
+			}
+		}
+		bench_clock_since(&start, &run.elapsed);
+		run.samples = BENCH_SAMPLES;
+		bench_keep_best(&best, &run);
+	}
+
+	snprintk(variant, sizeof(variant), "%s_s%u", to_container ? "to_container" : "from_container",
+		 depth);
+	bench_report("i2s_wire", variant, 0U, frame, &best);
+
+	return 0;
+}
+
+/*
+ * One kernel over a frame of @p frame samples, out of the file's bytes into
+ * the container or back. The payload is the frame narrowed once up front, so
+ * the float kernels see samples of every magnitude rather than zeros.
+ */
+static void bench_pcm(size_t layout, bool unpack, uint32_t frame)
+{
+	struct bench_result best = {0};
+	struct bench_result run;
+	struct bench_stamp start;
+	uint32_t rep;
+	uint32_t i;
+	char variant[24];
+
+	pcm_layouts[layout].pack(pcm_block, bench_frame, frame);
+
+	for (rep = 0; rep < BENCH_REPEATS; rep++) {
+		bench_clock_now(&start);
+		for (i = 0; i < BENCH_SAMPLES; i += frame) {
+			if (unpack) {
+				pcm_layouts[layout].unpack(bench_frame, pcm_block, frame);
+			} else {
+				pcm_layouts[layout].pack(pcm_block, bench_frame, frame);
+			}
+		}
+		bench_clock_since(&start, &run.elapsed);
+		run.samples = BENCH_SAMPLES;
+		bench_keep_best(&best, &run);
+	}
+
+	snprintk(variant, sizeof(variant), "%s_%s", unpack ? "unpack" : "pack",
+		 pcm_layouts[layout].name);
+	bench_report("pcm", variant, 0U, frame, &best);
+}
+
+/* The canonical 44 byte header the file writer produces. */
+static int wav_canonical(uint8_t *buf, size_t len)
+{
+	const struct audio_wav_header hdr = {
+		.sample_rate_hz = BENCH_RATE_HZ,
+		.data_size = BENCH_SAMPLES * sizeof(int16_t),
+		.format_tag = AUDIO_WAV_FORMAT_PCM,
+		.channels = 2U,
+		.bits_per_sample = 16U,
+	};
+
+	return audio_wav_write_header(buf, len, &hdr);
+}
+
+/* The same with a LIST chunk before "data", as most editors write it, so the
+ * parser has to walk past a chunk it does not know.
+ */
+static int wav_with_list(uint8_t *buf, size_t len)
+{
+	const size_t data_at = AUDIO_WAV_MIN_HEADER_SIZE - 8U;
+	int ret;
+
+	if (len < AUDIO_WAV_MIN_HEADER_SIZE + 8U + BENCH_WAV_LIST_BYTES) {
+		return -ENOMEM;
+	}
+
+	ret = wav_canonical(buf, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	memmove(&buf[data_at + 8U + BENCH_WAV_LIST_BYTES], &buf[data_at], 8U);
+	memcpy(&buf[data_at], "LIST", 4);
+	sys_put_le32(BENCH_WAV_LIST_BYTES, &buf[data_at + 4U]);
+	memset(&buf[data_at + 8U], 'x', BENCH_WAV_LIST_BYTES);
+	sys_put_le32(sys_get_le32(&buf[4]) + 8U + BENCH_WAV_LIST_BYTES, &buf[4]);
+
+	return 0;
+}
+
+static int bench_wav(const char *variant, int (*build)(uint8_t *buf, size_t len))
+{
+	uint8_t header[AUDIO_WAV_HEADER_SCAN_SIZE] = {0};
+	struct audio_wav_header parsed;
+	struct bench_result best = {0};
+	struct bench_result run;
+	struct bench_stamp start;
+	uint32_t rep;
+	uint32_t i;
+	int ret;
+
+	ret = build(header, sizeof(header));
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (rep = 0; rep < BENCH_REPEATS; rep++) {
+		bench_clock_now(&start);
+		for (i = 0; i < BENCH_WAV_CALLS; i++) {
+			ret = audio_wav_read_header(header, sizeof(header), &parsed);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+		bench_clock_since(&start, &run.elapsed);
+		run.samples = BENCH_WAV_CALLS;
+		bench_keep_best(&best, &run);
+	}
+
+	bench_report("wav_read_header", variant, 0U, 0U, &best);
+
+	return 0;
+}
+
+int bench_codecs_run(void)
+{
+	struct audio_i2s_wire_format fmt;
+	size_t d;
+	size_t f;
+	int ret;
+
+	for (d = 0; d < ARRAY_SIZE(wire_depths); d++) {
+		if (audio_i2s_wire_format_get(wire_depths[d], &fmt) == -ENOTSUP) {
+			continue;
+		}
+
+		for (f = 0; f < ARRAY_SIZE(frame_sizes); f++) {
+			ret = bench_wire(wire_depths[d], false, frame_sizes[f]);
+			if (ret == 0) {
+				ret = bench_wire(wire_depths[d], true, frame_sizes[f]);
+			}
+			if (ret < 0) {
+				printk("i2s_wire s%u, %u samples: %d\n", wire_depths[d],
+				       frame_sizes[f], ret);
+				return ret;
+			}
+		}
+	}
+
+	for (d = 0; d < ARRAY_SIZE(pcm_layouts); d++) {
+		for (f = 0; f < ARRAY_SIZE(frame_sizes); f++) {
+			bench_pcm(d, false, frame_sizes[f]);
+			bench_pcm(d, true, frame_sizes[f]);
+		}
+	}
+
+	ret = bench_wav("canonical", wav_canonical);
+	if (ret == 0) {
+		ret = bench_wav("list_chunk", wav_with_list);
+	}
+	if (ret < 0) {
+		printk("wav_read_header: %d\n", ret);
+	}
+
+	return ret;
+}
@@ -0,0 +1,258 @@
+/*
+ * The shared sample kernels (spec §5.4), on their own: the gain filter and the
+ * mixer are a pull plus one of these, so a change to a kernel shows here
+ * without the pull and the feed node around it.
+ *
+ * The "unsaturated" row is the loop the gain filter ran before it moved onto
+ * the kernels - one Q15 gain, no clamp - kept as the yardstick the kernel rows
+ * of the same run are read against: what saturation and a gain per channel
+ * cost on this target, or save where the vector body runs.
+ *
+ * The generic_vector scenario builds the same rows with the vector body on a
+ * target that runs the scalar loop by default, so bench-compare.py between
+ * the two scenarios shows what that default is worth there.
+ *
+ * With CONFIG_AUDIO_PIPELINE_FLOAT the float kernels have rows of their own
+ * next to the Q31 ones they replace in a float stretch (spec §10.14), and the
+ * two conversions that bound such a stretch have rows too: a stretch of n
+ * float nodes beats the Q31 chain when n times the difference in kernel rows
+ * pays for one of each conversion.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_dsp.h>
+
+#include "bench.h"
+
+enum bench_kernel {
+	BENCH_UNSATURATED,
+	BENCH_GAIN_Q15,
+	BENCH_GAIN_Q15_CLIP,
+	BENCH_GAIN_Q31,
+	BENCH_MAC_Q15,
+	BENCH_BIQUAD,
+	BENCH_FIR_SHORT,
+	BENCH_FIR_LONG,
+	BENCH_FIR_LONG_FFT,
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	BENCH_GAIN_F32,
+	BENCH_BIQUAD_F32,
+	BENCH_S32_TO_F32,
+	BENCH_F32_TO_S32,
+#endif
+};
+
+static const uint32_t frame_sizes[] = {BENCH_FRAME_SIZES};
+
+/* Half and a quarter: the gains cannot clip, so the kernel skips its clamp. */
+static const struct audio_dsp_gain channel_gains[BENCH_MAX_CHANNELS] = {
+	{.scale_q31 = 1 << 30, .shift = 0U},
+	{.scale_q31 = 1 << 29, .shift = 0U},
+};
+
+static int32_t mac_acc[1024];
+
+/* A second-order low-pass; its recurrence is the cost, not its response. */
+static const struct audio_dsp_biquad lowpass = {
+	AUDIO_DSP_COEFF(0.0200833656), AUDIO_DSP_COEFF(0.0401667311),
+	AUDIO_DSP_COEFF(0.0200833656), AUDIO_DSP_COEFF(-1.5610180758),
+	AUDIO_DSP_COEFF(0.6413515381),
+};
+
+static struct audio_dsp_biquad_history biquad_history[BENCH_MAX_CHANNELS];
+
+/*
+ * FIR rows: a short filter in direct form, and a long one both ways, which is
+ * where overlap-save has to win to be worth having. The taps' values do not
+ * change the cost, so they are left as zeros; the kernels run every tap.
+ */
+#define BENCH_FIR_SHORT_TAPS 32U
+#define BENCH_FIR_LONG_TAPS  256U
+#define BENCH_FIR_FFT_ORDER  9U
+
+static const int32_t fir_taps[BENCH_FIR_LONG_TAPS];
+static int32_t fir_line[BENCH_MAX_CHANNELS * 2U * BENCH_FIR_LONG_TAPS];
+static struct audio_dsp_complex fir_spectrum[1U << BENCH_FIR_FFT_ORDER];
+static struct audio_dsp_complex fir_work[1U << BENCH_FIR_FFT_ORDER];
+static int32_t fir_history[BENCH_MAX_CHANNELS * (BENCH_FIR_LONG_TAPS - 1U)];
+
+static struct audio_dsp_fir fir_short = {
+	.taps = fir_taps,
+	.line = fir_line,
+	.tap_count = BENCH_FIR_SHORT_TAPS,
+};
+
+static struct audio_dsp_fir fir_long = {
+	.taps = fir_taps,
+	.line = fir_line,
+	.tap_count = BENCH_FIR_LONG_TAPS,
+};
+
+static struct audio_dsp_fir_fft fir_long_fft = {
+	.taps = fir_taps,
+	.spectrum = fir_spectrum,
+	.work = fir_work,
+	.history = fir_history,
+	.tap_count = BENCH_FIR_LONG_TAPS,
+	.order = BENCH_FIR_FFT_ORDER,
+};
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+/*
+ * The float rows run on a frame of their own, held at a quarter of full scale:
+ * the low-pass passes it unchanged and a gain of unity either way keeps it, so
+ * however often a frame is filtered it never sinks into denormals, which would
+ * time the FPU's slow path rather than the kernel. The integer rows above have
+ * no such path and leave their frame to decay.
+ */
+#define BENCH_F32_LEVEL 0.25f
+
+static float bench_frame_f32[1024];
+static float conv_f32[1024];
+
+static const float channel_gains_f32[BENCH_MAX_CHANNELS] = {1.0f, -1.0f};
+
+static struct audio_dsp_biquad_f32 lowpass_f32;
+static struct audio_dsp_biquad_f32_history biquad_history_f32[BENCH_MAX_CHANNELS];
+
+static void bench_f32_fill(void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(bench_frame_f32); i++) {
+		bench_frame_f32[i] = BENCH_F32_LEVEL;
+	}
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FLOAT */
+
+/* The gain filter's loop before the kernels; noinline so it is measured as
+ * the compiler built it for the node, not folded into the timing loop.
+ */
+static __noinline void bench_unsaturated(int32_t *buf, size_t count, int32_t gain_q15)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		int64_t sample = buf[i];
+
+		sample *= gain_q15;
+		sample >>= 15;
+		buf[i] = (int32_t)sample;
+	}
+}
+
+static void bench_kernel_call(enum bench_kernel kernel, uint8_t channels, uint32_t frame)
+{
+	switch (kernel) {
+	case BENCH_UNSATURATED:
+		bench_unsaturated(bench_frame, frame, AUDIO_DSP_UNITY_Q15 / 2);
+		break;
+	case BENCH_GAIN_Q15:
+		audio_dsp_gain_q15(bench_frame, bench_frame, frame, AUDIO_DSP_UNITY_Q15 / 2);
+		break;
+	case BENCH_GAIN_Q15_CLIP:
+		audio_dsp_gain_q15(bench_frame, bench_frame, frame, AUDIO_DSP_UNITY_Q15 * 2);
+		break;
+	case BENCH_GAIN_Q31:
+		audio_dsp_gain_q31(bench_frame, bench_frame, frame, channel_gains, channels);
+		break;
+	case BENCH_MAC_Q15:
+		audio_dsp_mac_q15(mac_acc, bench_frame, frame, AUDIO_DSP_UNITY_Q15 / 2);
+		break;
+	case BENCH_BIQUAD:
+		audio_dsp_biquad_q31(bench_frame, frame, &lowpass, biquad_history, channels);
+		break;
+	case BENCH_FIR_SHORT:
+		audio_dsp_fir_q31(bench_frame, frame, &fir_short, channels);
+		break;
+	case BENCH_FIR_LONG:
+		audio_dsp_fir_q31(bench_frame, frame, &fir_long, channels);
+		break;
+	case BENCH_FIR_LONG_FFT:
+		audio_dsp_fir_fft_q31(bench_frame, frame, &fir_long_fft, channels);
+		break;
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	case BENCH_GAIN_F32:
+		audio_dsp_gain_f32(bench_frame_f32, bench_frame_f32, frame, channel_gains_f32,
+				   channels);
+		break;
+	case BENCH_BIQUAD_F32:
+		audio_dsp_biquad_f32(bench_frame_f32, frame, &lowpass_f32, biquad_history_f32,
+				     channels);
+		break;
+	case BENCH_S32_TO_F32:
+		audio_dsp_s32_to_f32(conv_f32, bench_frame, frame);
+		break;
+	case BENCH_F32_TO_S32:
+		audio_dsp_f32_to_s32(bench_frame, bench_frame_f32, frame);
+		break;
+#endif
+	}
+}
+
+static void bench_kernel(enum bench_kernel kernel, const char *variant, uint8_t channels,
+			 uint32_t frame)
+{
+	struct bench_result best = {0};
+	struct bench_result run;
+	struct bench_stamp start;
+	uint32_t rep;
+	uint32_t i;
+
+	for (rep = 0; rep < BENCH_REPEATS; rep++) {
+		bench_clock_now(&start);
+		for (i = 0; i < BENCH_SAMPLES; i += frame) {
+			bench_kernel_call(kernel, channels, frame);
+		}
+		bench_clock_since(&start, &run.elapsed);
+		run.samples = BENCH_SAMPLES;
+		bench_keep_best(&best, &run);
+	}
+
+	bench_report("audio_dsp", variant, channels, frame, &best);
+}
+
+int bench_dsp_run(void)
+{
+	uint8_t channels;
+	size_t f;
+
+	audio_dsp_fir_fft_prepare(&fir_long_fft);
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	audio_dsp_biquad_to_f32(&lowpass, &lowpass_f32);
+	bench_f32_fill();
+#endif
+
+	for (f = 0; f < ARRAY_SIZE(frame_sizes); f++) {
+		const uint32_t frame = frame_sizes[f];
+
+		/* One gain for the whole frame: channels do not apply. */
+		bench_kernel(BENCH_UNSATURATED, "unsaturated", 0U, frame);
+		bench_kernel(BENCH_GAIN_Q15, "gain_q15", 0U, frame);
+		bench_kernel(BENCH_GAIN_Q15_CLIP, "gain_q15_clip", 0U, frame);
+		bench_kernel(BENCH_MAC_Q15, "mac_q15", 0U, frame);
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+		bench_kernel(BENCH_S32_TO_F32, "s32_to_f32", 0U, frame);
+		bench_kernel(BENCH_F32_TO_S32, "f32_to_s32", 0U, frame);
+#endif
+
+		for (channels = 1U; channels <= BENCH_MAX_CHANNELS; channels++) {
+			bench_kernel(BENCH_GAIN_Q31, "gain_q31", channels, frame);
+			bench_kernel(BENCH_BIQUAD, "biquad", channels, frame);
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+			bench_kernel(BENCH_GAIN_F32, "gain_f32", channels, frame);
+			bench_kernel(BENCH_BIQUAD_F32, "biquad_f32", channels, frame);
+#endif
+			bench_kernel(BENCH_FIR_SHORT, "fir_32", channels, frame);
+			bench_kernel(BENCH_FIR_LONG, "fir_256", channels, frame);
+			bench_kernel(BENCH_FIR_LONG_FFT, "fir_fft_256", channels, frame);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,299 @@
+/*
+ * The shipped nodes, driven one frame at a time the way the pipeline thread
+ * drives a sink: the format installed, the chain opened, process() in a loop,
+ * the chain closed. Only the process() loop is timed.
+ *
+ * Filters and sinks pull from a feed node that hands out the frame it was
+ * given untouched, so their rows carry the cost of one near-empty pull on top
+ * of their own; the feed's own row is that cost.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+#include "bench.h"
+
+#define BENCH_MOUNT_POINT "/ram"
+#define BENCH_WAV_PATH    BENCH_MOUNT_POINT "/bench.wav"
+
+/* Bins of 50 Hz at 48 kHz, which 1 kHz and 3 kHz fall on exactly. */
+#define BENCH_WINDOW_SAMPLES 960U
+
+static const uint32_t frame_sizes[] = {BENCH_FRAME_SIZES};
+
+static struct fs_mount_t bench_mnt = {
+	.type = FS_EXT2,
+	.mnt_point = BENCH_MOUNT_POINT,
+	/* Disk name of the ramdisk0 node in app.overlay; the zeroed disk is
+	 * formatted on the first mount.
+	 */
+	.storage_dev = (void *)"RAM",
+};
+
+static int feed_process(struct audio_node *node, struct audio_buffer_view *buf,
+			size_t *out_size)
+{
+	uint8_t channels = node->pipeline_format->channels;
+
+	*out_size = buf->capacity - buf->capacity % channels;
+
+	return 0;
+}
+
+static const struct audio_node_ops feed_ops = {
+	.process = feed_process,
+};
+
+AUDIO_NODE_DEFINE(bench_feed, AUDIO_NODE_ROLE_SOURCE, &feed_ops, NULL, NULL);
+
+AUDIO_TONE_GEN_NODE_DEFINE(bench_tone_1ch, AUDIO_TONE_GEN_FULL_SCALE_Q15 / 2, 0, 1000U);
+AUDIO_TONE_GEN_NODE_DEFINE(bench_tone_2ch, AUDIO_TONE_GEN_FULL_SCALE_Q15 / 2, 0, 1000U, 3000U);
+
+AUDIO_GAIN_FILTER_NODE_DEFINE(bench_gain, &bench_feed, AUDIO_GAIN_UNITY_Q15 / 2);
+/* A gain set outlives the run, so the ramping rows have a filter of their own. */
+AUDIO_GAIN_FILTER_NODE_DEFINE(bench_ramp, &bench_feed, AUDIO_GAIN_UNITY_Q15 / 2);
+
+/* A fourth-order Butterworth low-pass at fs/8: two stages, the common case. */
+AUDIO_BIQUAD_NODE_DEFINE(bench_biquad, &bench_feed,
+			 AUDIO_BIQUAD_STAGE(0.088579, 0.177159, 0.088579, -0.855398, 0.209715),
+			 AUDIO_BIQUAD_STAGE(0.115258, 0.230516, 0.115258, -1.113030, 0.574062));
+
+/* The same 256 taps in both forms; against the kernel rows in bench_dsp.c
+ * these show what the pull adds, and against each other, at which frame size
+ * overlap-save starts to pay.
+ */
+static const int32_t bench_fir_taps[256];
+AUDIO_FIR_NODE_DEFINE(bench_fir, &bench_feed, bench_fir_taps);
+AUDIO_FIR_FFT_NODE_DEFINE(bench_fir_fft, &bench_feed, bench_fir_taps, 9);
+
+/* 44.1 kHz up to the 48 kHz the rows run at, at each quality, and 144 kHz down
+ * by 3, where every output costs three times the taps. The feed is endless,
+ * so the rows count outputs, several pulls per frame when decimating.
+ */
+AUDIO_RESAMPLER_NODE_DEFINE(bench_resample_fast, &bench_feed, 44100U, FAST);
+AUDIO_RESAMPLER_NODE_DEFINE(bench_resample_balanced, &bench_feed, 44100U, BALANCED);
+AUDIO_RESAMPLER_NODE_DEFINE(bench_resample_best, &bench_feed, 44100U, BEST);
+AUDIO_RESAMPLER_NODE_DEFINE(bench_resample_down, &bench_feed, 144000U, BALANCED);
+
+AUDIO_TONE_ANALYZER_NODE_DEFINE(bench_analyzer_1ch, &bench_feed, BENCH_WINDOW_SAMPLES, 1000U);
+AUDIO_TONE_ANALYZER_NODE_DEFINE(bench_analyzer_2ch, &bench_feed, BENCH_WINDOW_SAMPLES, 1000U,
+				3000U);
+
+AUDIO_FILE_WRITER_NODE_DEFINE(bench_writer, &bench_feed, BENCH_WAV_PATH);
+AUDIO_FILE_READER_NODE_DEFINE(bench_reader, BENCH_WAV_PATH);
+
+static int chain_open(struct audio_node *node, const struct audio_stream_config *fmt)
+{
+	int ret;
+
+	node->pipeline_format = fmt;
+	if (node->upstream != NULL) {
+		node->upstream->pipeline_format = fmt;
+		ret = audio_node_open(node->upstream);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return audio_node_open(node);
+}
+
+static int chain_close(struct audio_node *node)
+{
+	int ret = audio_node_close(node);
+
+	if (node->upstream != NULL) {
+		(void)audio_node_close(node->upstream);
+	}
+
+	return ret;
+}
+
+/*
+ * Gain filter rows with a ramp running through every timed frame: one as long
+ * as the run, set once the chain is open.
+ */
+static void bench_gain_ramp_linear(struct audio_node *node, uint8_t channels)
+{
+	(void)audio_gain_filter_set(node, AUDIO_GAIN_UNITY_Q15 / 4, BENCH_SAMPLES / channels,
+				    AUDIO_GAIN_RAMP_LINEAR);
+}
+
+static void bench_gain_ramp_exp(struct audio_node *node, uint8_t channels)
+{
+	(void)audio_gain_filter_set(node, AUDIO_GAIN_UNITY_Q15 / 4, BENCH_SAMPLES / channels,
+				    AUDIO_GAIN_RAMP_EXPONENTIAL);
+}
+
+/*
+ * One node at one frame size: BENCH_REPEATS runs of BENCH_SAMPLES samples, or
+ * up to the end of the stream for a source that has one. @p opened, if given,
+ * runs after each open and before the clock starts.
+ */
+static int bench_node(const char *name, const char *variant, struct audio_node *node,
+		      uint8_t channels, uint32_t frame,
+		      void (*opened)(struct audio_node *node, uint8_t channels))
+{
+	struct audio_stream_config fmt;
+	struct bench_result best = {0};
+	struct bench_result run;
+	struct bench_stamp start;
+	struct audio_buffer_view buf;
+	size_t out_size;
+	uint32_t rep;
+	int ret;
+
+	bench_format(&fmt, channels);
+
+	for (rep = 0; rep < BENCH_REPEATS; rep++) {
+		ret = chain_open(node, &fmt);
+		if (ret < 0) {
+			(void)chain_close(node);
+			return ret;
+		}
+
+		if (opened != NULL) {
+			opened(node, channels);
+		}
+
+		run.samples = 0U;
+		bench_clock_now(&start);
+		while (run.samples < BENCH_SAMPLES) {
+			buf.data = bench_frame;
+			buf.capacity = frame;
+
+			ret = audio_node_process(node, &buf, &out_size);
+			if (ret < 0 || out_size == 0U) {
+				break;
+			}
+
+			run.samples += out_size;
+		}
+		bench_clock_since(&start, &run.elapsed);
+
+		if (ret < 0) {
+			(void)chain_close(node);
+			return ret;
+		}
+
+		ret = chain_close(node);
+		if (ret < 0) {
+			return ret;
+		}
+
+		bench_keep_best(&best, &run);
+	}
+
+	if (best.samples != BENCH_SAMPLES) {
+		/* Only the reader can stop short, and only on a file the writer
+		 * case did not fill.
+		 */
+		printk("%s: %llu of %u samples\n", name, (unsigned long long)best.samples,
+		       BENCH_SAMPLES);
+		return -EIO;
+	}
+
+	bench_report(name, variant, channels, frame, &best);
+
+	return 0;
+}
+
+int bench_nodes_run(void)
+{
+	static struct audio_node *const tone_gen[] = {&bench_tone_1ch, &bench_tone_2ch};
+	static struct audio_node *const analyzer[] = {&bench_analyzer_1ch, &bench_analyzer_2ch};
+	uint8_t channels;
+	size_t f;
+	int ret;
+
+	ret = fs_mount(&bench_mnt);
+	if (ret < 0) {
+		printk("mounting %s failed: %d\n", BENCH_MOUNT_POINT, ret);
+		return ret;
+	}
+
+	for (channels = 1U; channels <= BENCH_MAX_CHANNELS; channels++) {
+		for (f = 0; f < ARRAY_SIZE(frame_sizes); f++) {
+			const uint32_t frame = frame_sizes[f];
+
+			ret = bench_node("feed", "process", &bench_feed, channels, frame, NULL);
+			if (ret == 0) {
+				ret = bench_node("tone_gen", "process", tone_gen[channels - 1U],
+						 channels, frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("gain_filter", "process", &bench_gain, channels,
+						 frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("gain_filter", "ramp_linear", &bench_ramp,
+						 channels, frame, bench_gain_ramp_linear);
+			}
+			if (ret == 0) {
+				ret = bench_node("gain_filter", "ramp_exp", &bench_ramp, channels,
+						 frame, bench_gain_ramp_exp);
+			}
+			if (ret == 0) {
+				ret = bench_node("biquad", "process", &bench_biquad, channels,
+						 frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("fir", "direct_256", &bench_fir, channels, frame,
+						 NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("fir", "fft_256", &bench_fir_fft, channels, frame,
+						 NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("resampler", "44k1_fast", &bench_resample_fast,
+						 channels, frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("resampler", "44k1_balanced",
+						 &bench_resample_balanced, channels, frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("resampler", "44k1_best", &bench_resample_best,
+						 channels, frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("resampler", "144k_balanced", &bench_resample_down,
+						 channels, frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("tone_analyzer", "process",
+						 analyzer[channels - 1U], channels, frame, NULL);
+			}
+			/* The reader reads back what the writer just wrote, so the
+			 * file always matches the format being measured.
+			 */
+			if (ret == 0) {
+				ret = bench_node("file_writer", "process", &bench_writer, channels,
+						 frame, NULL);
+			}
+			if (ret == 0) {
+				ret = bench_node("file_reader", "process", &bench_reader, channels,
+						 frame, NULL);
+			}
+			if (ret < 0) {
+				printk("%u ch, %u samples: %d\n", channels, frame, ret);
+				goto out;
+			}
+		}
+	}
+
+out:
+	(void)fs_unmount(&bench_mnt);
+
+	return ret;
+}
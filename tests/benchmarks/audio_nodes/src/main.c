@@ -0,0 +1,52 @@
+/*
+ * Throughput of every shipped node and of the codecs they share, over frame
+ * sizes and channel counts, as one CSV row per case:
+ *
+ *   BENCH,<node>,<variant>,<channels>,<frame_samples>,<samples>,<ns>,
+ *         <samples_per_sec>,<cycles_per_sample>
+ *
+ * Twister records the rows into recording.csv (see testcase.yaml), and
+ * scripts/bench-compare.py diffs two of those between commits. A case that
+ * fails ends the run before "BENCH DONE", which fails the Twister run with it.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "bench.h"
+
+int32_t bench_frame[1024];
+
+int main(void)
+{
+	size_t i;
+	int ret;
+
+	/* Start from something other than silence; the sources overwrite it. */
+	for (i = 0; i < ARRAY_SIZE(bench_frame); i++) {
+		bench_frame[i] = (int32_t)(i * 2654435761U);
+	}
+
+	printk("BENCH,node,variant,channels,frame_samples,samples,ns,samples_per_sec,"
+	       "cycles_per_sample\n");
+
+	ret = bench_codecs_run();
+	if (ret == 0) {
+		ret = bench_dsp_run();
+	}
+	if (ret == 0) {
+		ret = bench_nodes_run();
+	}
+
+	if (ret < 0) {
+		printk("BENCH FAILED: %d\n", ret);
+		return 0;
+	}
+
+	printk("BENCH DONE\n");
+
+	return 0;
+}
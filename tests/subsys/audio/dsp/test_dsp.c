@@ -0,0 +1,1284 @@
+/*
+ * Unit test for the sample kernels the nodes share.
+ *
+ * Whatever implementation the target builds - the scalar loops on native_sim,
+ * the vector body on a NEON host, QADD on an Arm core with the DSP extension -
+ * has to produce exactly what the kernel's declaration defines. The reference
+ * below is that definition spelled out one sample at a time, and the lengths
+ * are chosen so every case runs both a vector body and a scalar tail.
+ *
+ * The overlap-save FIR approximates another kernel: it is held to the direct
+ * form's output within the bound its declaration states. The float biquad is
+ * held to the Q31 one the same way, since float arithmetic promises no bits;
+ * the float conversions, which do, are exact to their definition, and the
+ * integer-only float PCM kernels are held to those, bit for bit. The
+ * resampler is held to its definition through a run of calls the way the
+ * node makes them, so its position has to carry across every seam.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_dsp.h>
+
+/* Not a multiple of any lane count, so the tail loop always runs. */
+#define DSP_SAMPLES 23
+
+static int32_t ref_sat32(int64_t value)
+{
+	return (int32_t)CLAMP(value, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+}
+
+static int32_t ref_scale(int32_t sample, int32_t gain_q15)
+{
+	return ref_sat32(((int64_t)sample * gain_q15) >> 15);
+}
+
+/* Full scale both ways, values next to it, and ordinary ones in between. */
+static void fill(int32_t *buf, uint32_t seed)
+{
+	static const int32_t edges[] = {INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1, 0, -1};
+	size_t i;
+
+	for (i = 0; i < DSP_SAMPLES; i++) {
+		seed = seed * 1664525U + 1013904223U;
+		buf[i] = (i % 4U == 0U) ? edges[(i / 4U) % ARRAY_SIZE(edges)] : (int32_t)seed;
+	}
+}
+
+static int32_t ref_scale_q31(int32_t sample, const struct audio_dsp_gain *gain)
+{
+	return ref_sat32(((int64_t)sample * gain->scale_q31) >> (31U - gain->shift));
+}
+
+static const int32_t gains[] = {
+	0,
+	AUDIO_DSP_UNITY_Q15,
+	AUDIO_DSP_UNITY_Q15 / 2,
+	-AUDIO_DSP_UNITY_Q15,
+	AUDIO_DSP_UNITY_Q15 * 3,
+	12345,
+};
+
+ZTEST_SUITE(audio_dsp, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_dsp, test_gain_matches_its_definition)
+{
+	int32_t src[DSP_SAMPLES];
+	int32_t dst[DSP_SAMPLES];
+	size_t g;
+	size_t i;
+
+	for (g = 0; g < ARRAY_SIZE(gains); g++) {
+		fill(src, (uint32_t)g);
+		audio_dsp_gain_q15(dst, src, DSP_SAMPLES, gains[g]);
+
+		for (i = 0; i < DSP_SAMPLES; i++) {
+			zassert_equal(dst[i], ref_scale(src[i], gains[g]),
+				      "gain %d, sample %zu: %d", gains[g], i, dst[i]);
+		}
+	}
+}
+
+/*
+ * Per-channel gain sets, one per way the kernel plans a call: one range and
+ * no clipping possible, one range with clipping, and ranges that differ.
+ */
+static const struct audio_dsp_gain gain_sets[][8] = {
+	{
+		{INT32_MAX, 0U}, {INT32_MIN + 1, 0U}, {1 << 30, 0U}, {0, 0U},
+		{-(1 << 29), 0U}, {12345678, 0U}, {-1, 0U}, {1, 0U},
+	},
+	{
+		{INT32_MIN, 0U}, {INT32_MAX, 0U}, {-(1 << 30), 0U}, {1 << 30, 0U},
+		{INT32_MIN, 0U}, {7, 0U}, {-7, 0U}, {INT32_MAX / 3, 0U},
+	},
+	{
+		{1 << 30, 1U}, {-(1 << 30), 1U}, {INT32_MAX, 1U}, {0, 1U},
+		{INT32_MIN, 1U}, {1 << 29, 1U}, {123456789, 1U}, {-987654321, 1U},
+	},
+	{
+		{1 << 30, 4U}, {INT32_MAX, 0U}, {-(1 << 30), 16U}, {1 << 30, 31U},
+		{INT32_MIN, 31U}, {5, 2U}, {-5, 8U}, {INT32_MAX, 30U},
+	},
+};
+
+ZTEST(audio_dsp, test_gain_q31_matches_its_definition_per_channel)
+{
+	static const size_t channel_counts[] = {1U, 2U, 3U, 4U, 8U};
+	int32_t src[DSP_SAMPLES];
+	int32_t dst[DSP_SAMPLES];
+	size_t set;
+	size_t ch;
+	size_t i;
+
+	for (set = 0; set < ARRAY_SIZE(gain_sets); set++) {
+		for (ch = 0; ch < ARRAY_SIZE(channel_counts); ch++) {
+			const size_t channels = channel_counts[ch];
+
+			fill(src, (uint32_t)(set * 16U + ch));
+			audio_dsp_gain_q31(dst, src, DSP_SAMPLES, gain_sets[set], channels);
+
+			for (i = 0; i < DSP_SAMPLES; i++) {
+				int32_t expected =
+					ref_scale_q31(src[i], &gain_sets[set][i % channels]);
+
+				zassert_equal(dst[i], expected,
+					      "set %zu, %zu ch, sample %zu: %d, expected %d", set,
+					      channels, i, dst[i], expected);
+			}
+		}
+	}
+}
+
+ZTEST(audio_dsp, test_gain_from_q15_is_exact)
+{
+	static const int32_t wide[] = {INT32_MAX, INT32_MIN, -1, 1, 65536 * 3 + 1};
+	struct audio_dsp_gain gain;
+	int32_t src[DSP_SAMPLES];
+	int32_t dst[DSP_SAMPLES];
+	int32_t q15;
+	size_t g;
+	size_t i;
+
+	for (g = 0; g < ARRAY_SIZE(gains) + ARRAY_SIZE(wide); g++) {
+		q15 = (g < ARRAY_SIZE(gains)) ? gains[g] : wide[g - ARRAY_SIZE(gains)];
+		audio_dsp_gain_from_q15(q15, &gain);
+		zassert_true(gain.shift <= AUDIO_DSP_MAX_SHIFT, "gain %d: shift %u", q15,
+			     gain.shift);
+
+		fill(src, 300U + g);
+		audio_dsp_gain_q31(dst, src, DSP_SAMPLES, &gain, 1U);
+
+		for (i = 0; i < DSP_SAMPLES; i++) {
+			zassert_equal(dst[i], ref_scale(src[i], q15), "gain %d, sample %zu: %d",
+				      q15, i, dst[i]);
+		}
+	}
+}
+
+ZTEST(audio_dsp, test_gain_works_in_place)
+{
+	int32_t buf[DSP_SAMPLES];
+	int32_t src[DSP_SAMPLES];
+	size_t i;
+
+	fill(src, 7U);
+	memcpy(buf, src, sizeof(buf));
+	audio_dsp_gain_q15(buf, buf, DSP_SAMPLES, AUDIO_DSP_UNITY_Q15 / 4);
+
+	for (i = 0; i < DSP_SAMPLES; i++) {
+		zassert_equal(buf[i], ref_scale(src[i], AUDIO_DSP_UNITY_Q15 / 4));
+	}
+}
+
+ZTEST(audio_dsp, test_mac_saturates_instead_of_wrapping)
+{
+	int32_t acc[DSP_SAMPLES];
+	int32_t start[DSP_SAMPLES];
+	int32_t src[DSP_SAMPLES];
+	size_t g;
+	size_t i;
+
+	for (g = 0; g < ARRAY_SIZE(gains); g++) {
+		fill(start, 100U + g);
+		fill(src, 200U + g);
+		memcpy(acc, start, sizeof(acc));
+		audio_dsp_mac_q15(acc, src, DSP_SAMPLES, gains[g]);
+
+		for (i = 0; i < DSP_SAMPLES; i++) {
+			int32_t expected = ref_sat32((int64_t)start[i] + ref_scale(src[i], gains[g]));
+
+			zassert_equal(acc[i], expected, "gain %d, sample %zu: %d, expected %d",
+				      gains[g], i, acc[i], expected);
+		}
+	}
+
+	/* The case a wrapping add gets most wrong: two loud inputs. */
+	acc[0] = INT32_MAX - 10;
+	src[0] = INT32_MAX;
+	audio_dsp_mac_q15(acc, src, 1U, AUDIO_DSP_UNITY_Q15);
+	zassert_equal(acc[0], INT32_MAX, "a positive overflow wrapped to %d", acc[0]);
+
+	acc[0] = INT32_MIN + 10;
+	src[0] = INT32_MIN;
+	audio_dsp_mac_q15(acc, src, 1U, AUDIO_DSP_UNITY_Q15);
+	zassert_equal(acc[0], INT32_MIN, "a negative overflow wrapped to %d", acc[0]);
+}
+
+/* Odd, so neither direction of the in-place loops lines up with anything. */
+#define MATRIX_SETS 7U
+
+/* The channel matrix as its declaration defines it, one output at a time. */
+static void ref_matrix(int32_t *dst, const int32_t *src, size_t sets, const int32_t *coeffs,
+		       size_t in, size_t out)
+{
+	size_t s;
+	size_t o;
+	size_t i;
+
+	for (s = 0; s < sets; s++) {
+		for (o = 0; o < out; o++) {
+			int64_t acc = 0;
+
+			for (i = 0; i < in; i++) {
+				acc += (int64_t)src[s * in + i] * coeffs[o * in + i];
+			}
+			dst[s * out + o] = ref_sat32(acc >> 15);
+		}
+	}
+}
+
+#define U AUDIO_DSP_UNITY_Q15
+
+static const int32_t mx_identity[] = {U, 0, 0, U};
+static const int32_t mx_swap[] = {0, U, U, 0};
+static const int32_t mx_upmix[] = {U, U};
+static const int32_t mx_average[] = {U / 2, U / 2};
+static const int32_t mx_average_not[] = {U / 2, U / 2 + 1};
+/* Left, silence, right: a routing with a silent output. */
+static const int32_t mx_spread[] = {U, 0, 0, 0, 0, U};
+/* Three to two with gains that cut, boost past unity and invert. */
+static const int32_t mx_general[] = {
+	U, U / 2, -U / 3, -U, U * 3, AUDIO_DSP_MATRIX_MAX_GAIN_Q15,
+};
+/* Sixteen full-scale inputs at the largest gain: the accumulator's bound. */
+static int32_t mx_wide[AUDIO_DSP_MATRIX_MAX_CHANNELS];
+
+static const struct {
+	const int32_t *coeffs;
+	uint8_t in;
+	uint8_t out;
+	enum audio_dsp_matrix_kind kind;
+} matrices[] = {
+	{mx_identity, 2, 2, AUDIO_DSP_MATRIX_IDENTITY},
+	{mx_swap, 2, 2, AUDIO_DSP_MATRIX_ROUTE},
+	{mx_upmix, 1, 2, AUDIO_DSP_MATRIX_DUPLICATE},
+	{mx_average, 2, 1, AUDIO_DSP_MATRIX_AVERAGE},
+	{mx_average_not, 2, 1, AUDIO_DSP_MATRIX_GENERAL},
+	{mx_spread, 2, 3, AUDIO_DSP_MATRIX_ROUTE},
+	{mx_general, 3, 2, AUDIO_DSP_MATRIX_GENERAL},
+	{mx_wide, AUDIO_DSP_MATRIX_MAX_CHANNELS, 1, AUDIO_DSP_MATRIX_GENERAL},
+};
+
+#undef U
+
+ZTEST(audio_dsp, test_matrix_matches_its_definition)
+{
+	int32_t src[MATRIX_SETS * AUDIO_DSP_MATRIX_MAX_CHANNELS];
+	int32_t dst[MATRIX_SETS * AUDIO_DSP_MATRIX_MAX_CHANNELS];
+	int32_t want[MATRIX_SETS * AUDIO_DSP_MATRIX_MAX_CHANNELS];
+	size_t m;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(mx_wide); i++) {
+		mx_wide[i] = (i % 2U == 0U) ? AUDIO_DSP_MATRIX_MAX_GAIN_Q15
+					    : -AUDIO_DSP_MATRIX_MAX_GAIN_Q15;
+	}
+
+	for (m = 0; m < ARRAY_SIZE(matrices); m++) {
+		struct audio_dsp_matrix mx = {
+			.coeffs_q15 = matrices[m].coeffs,
+			.in_channels = matrices[m].in,
+			.out_channels = matrices[m].out,
+		};
+		size_t in_count = MATRIX_SETS * mx.in_channels;
+		size_t out_count = MATRIX_SETS * mx.out_channels;
+
+		zassert_true(audio_dsp_matrix_is_bounded(mx.coeffs_q15,
+							 (size_t)mx.in_channels * mx.out_channels));
+		audio_dsp_matrix_prepare(&mx);
+		zassert_equal(mx.kind, matrices[m].kind, "matrix %zu planned as %d", m, mx.kind);
+
+		for (i = 0; i < in_count; i++) {
+			src[i] = (i % 3U == 0U) ? ((i & 4U) ? INT32_MIN : INT32_MAX)
+						: (int32_t)(0x9e3779b9U * (uint32_t)(i + m));
+		}
+		ref_matrix(want, src, MATRIX_SETS, mx.coeffs_q15, mx.in_channels,
+			   mx.out_channels);
+
+		audio_dsp_matrix_q15(dst, src, MATRIX_SETS, &mx);
+		for (i = 0; i < out_count; i++) {
+			zassert_equal(dst[i], want[i], "matrix %zu, sample %zu: %d, expected %d", m,
+				      i, dst[i], want[i]);
+		}
+
+		/* In place, whichever way the set changes size. */
+		memcpy(dst, src, sizeof(src[0]) * in_count);
+		audio_dsp_matrix_q15(dst, dst, MATRIX_SETS, &mx);
+		for (i = 0; i < out_count; i++) {
+			zassert_equal(dst[i], want[i], "matrix %zu in place, sample %zu: %d, "
+				      "expected %d", m, i, dst[i], want[i]);
+		}
+	}
+}
+
+ZTEST(audio_dsp, test_matrix_bound_is_on_each_gain)
+{
+	const int32_t at_bound[] = {AUDIO_DSP_MATRIX_MAX_GAIN_Q15, -AUDIO_DSP_MATRIX_MAX_GAIN_Q15};
+	const int32_t past_up[] = {0, AUDIO_DSP_MATRIX_MAX_GAIN_Q15 + 1};
+	const int32_t past_down[] = {-AUDIO_DSP_MATRIX_MAX_GAIN_Q15 - 1, 0};
+	const int32_t most_negative[] = {INT32_MIN};
+
+	zassert_true(audio_dsp_matrix_is_bounded(at_bound, ARRAY_SIZE(at_bound)));
+	zassert_false(audio_dsp_matrix_is_bounded(past_up, ARRAY_SIZE(past_up)));
+	zassert_false(audio_dsp_matrix_is_bounded(past_down, ARRAY_SIZE(past_down)));
+	zassert_false(audio_dsp_matrix_is_bounded(most_negative, ARRAY_SIZE(most_negative)));
+}
+
+ZTEST(audio_dsp, test_interleave_matches_its_definition)
+{
+	/* Stereo's loop of its own, and the general one either side of it;
+	 * the plane longer than the sets, as a short frame leaves it.
+	 */
+	static const size_t channel_counts[] = {1U, 2U, 3U, 8U};
+	const size_t plane = DSP_SAMPLES + 2U;
+	int32_t src[8 * DSP_SAMPLES];
+	int32_t planes[8 * (DSP_SAMPLES + 2U)];
+	int32_t back[8 * DSP_SAMPLES];
+	size_t n;
+	size_t s;
+	size_t c;
+
+	fill(src, 7U);
+	fill(&src[DSP_SAMPLES], 8U);
+	for (n = 2U; n < 8U; n++) {
+		memcpy(&src[n * DSP_SAMPLES], src, sizeof(src[0]) * DSP_SAMPLES);
+	}
+
+	for (n = 0; n < ARRAY_SIZE(channel_counts); n++) {
+		const size_t channels = channel_counts[n];
+		const size_t sets = DSP_SAMPLES;
+
+		memset(planes, 0x5a, sizeof(planes));
+		audio_dsp_deinterleave(planes, plane, src, sets, channels);
+		for (c = 0; c < channels; c++) {
+			for (s = 0; s < sets; s++) {
+				zassert_equal(planes[c * plane + s], src[s * channels + c],
+					      "%zu channels, channel %zu, set %zu", channels, c, s);
+			}
+			/* The rest of each plane is left alone. */
+			zassert_equal(planes[c * plane + sets], 0x5a5a5a5a);
+		}
+
+		memset(back, 0, sizeof(back));
+		audio_dsp_interleave(back, planes, plane, sets, channels);
+		zassert_mem_equal(back, src, sizeof(src[0]) * sets * channels, "%zu channels",
+				  channels);
+	}
+}
+
+/* The biquad as its declaration defines it, one sample at a time. */
+static void ref_biquad(int32_t *data, size_t count, const struct audio_dsp_biquad *c,
+		       struct audio_dsp_biquad_history *history, size_t channels)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		struct audio_dsp_biquad_history *h = &history[i % channels];
+		int64_t acc = ((int64_t)c->b0 * data[i] + (int64_t)c->b1 * h->x1 +
+			       (int64_t)c->b2 * h->x2 - (int64_t)c->a1 * h->y1 -
+			       (int64_t)c->a2 * h->y2 + (INT64_C(1) << 27)) >>
+			      28;
+		int32_t y = ref_sat32(acc);
+
+		h->x2 = h->x1;
+		h->x1 = data[i];
+		h->y2 = h->y1;
+		h->y1 = y;
+		data[i] = y;
+	}
+}
+
+/*
+ * A low-pass, a DC-blocking high-pass with its poles next to z = 1, a peaking
+ * boost, and a stage whose gain is well above unity, so the clamp and the
+ * saturated history are exercised.
+ */
+static const struct audio_dsp_biquad biquads[] = {
+	{AUDIO_DSP_COEFF(0.0200833656), AUDIO_DSP_COEFF(0.0401667311),
+	 AUDIO_DSP_COEFF(0.0200833656), AUDIO_DSP_COEFF(-1.5610180758),
+	 AUDIO_DSP_COEFF(0.6413515381)},
+	{AUDIO_DSP_COEFF(0.9981509), AUDIO_DSP_COEFF(-1.9963018),
+	 AUDIO_DSP_COEFF(0.9981509), AUDIO_DSP_COEFF(-1.9962983),
+	 AUDIO_DSP_COEFF(0.9963052)},
+	{AUDIO_DSP_COEFF(1.1410), AUDIO_DSP_COEFF(-1.6490),
+	 AUDIO_DSP_COEFF(0.6151), AUDIO_DSP_COEFF(-1.6490),
+	 AUDIO_DSP_COEFF(0.7561)},
+	{AUDIO_DSP_COEFF(7.5), AUDIO_DSP_COEFF(-3.0), AUDIO_DSP_COEFF(1.0),
+	 AUDIO_DSP_COEFF(-1.0), AUDIO_DSP_COEFF(0.25)},
+};
+
+ZTEST(audio_dsp, test_biquad_matches_its_definition)
+{
+	static const size_t channel_counts[] = {1U, 2U, 3U};
+	struct audio_dsp_biquad_history want_history[3];
+	struct audio_dsp_biquad_history history[3];
+	int32_t data[DSP_SAMPLES * 3];
+	int32_t want[DSP_SAMPLES * 3];
+	size_t split;
+	size_t b;
+	size_t ch;
+	size_t i;
+
+	for (b = 0; b < ARRAY_SIZE(biquads); b++) {
+		zassert_true(audio_dsp_biquad_is_bounded(&biquads[b]), "biquad %zu", b);
+
+		for (ch = 0; ch < ARRAY_SIZE(channel_counts); ch++) {
+			const size_t channels = channel_counts[ch];
+			const size_t count = DSP_SAMPLES * channels;
+
+			fill(data, 400U + b);
+			fill(&data[DSP_SAMPLES], 500U + b);
+			fill(&data[DSP_SAMPLES * 2U], 600U + b);
+			memcpy(want, data, sizeof(data));
+			memset(history, 0, sizeof(history));
+			memset(want_history, 0, sizeof(want_history));
+
+			/* Two calls, so the history has to carry the recurrence
+			 * over the seam exactly as it would across frames.
+			 */
+			split = (DSP_SAMPLES / 2U) * channels;
+			audio_dsp_biquad_q31(data, split, &biquads[b], history, channels);
+			audio_dsp_biquad_q31(&data[split], count - split, &biquads[b], history,
+					     channels);
+			ref_biquad(want, count, &biquads[b], want_history, channels);
+
+			for (i = 0; i < count; i++) {
+				zassert_equal(data[i], want[i],
+					      "biquad %zu, %zu ch, sample %zu: %d, expected %d", b,
+					      channels, i, data[i], want[i]);
+			}
+			zassert_mem_equal(history, want_history, sizeof(history));
+		}
+	}
+}
+
+ZTEST(audio_dsp, test_biquad_bound_is_on_the_magnitudes)
+{
+	const struct audio_dsp_biquad at_bound = {
+		.b0 = INT32_MAX, .b1 = INT32_MIN + 1, .b2 = 0, .a1 = 0, .a2 = 2,
+	};
+	const struct audio_dsp_biquad below = {
+		.b0 = INT32_MAX, .b1 = INT32_MIN + 1, .b2 = 0, .a1 = 0, .a2 = 1,
+	};
+
+	/* Two magnitudes one LSB short of 8 each: two more LSBs reach 16
+	 * exactly, whatever the signs, and one stays below it.
+	 */
+	zassert_false(audio_dsp_biquad_is_bounded(&at_bound));
+	zassert_true(audio_dsp_biquad_is_bounded(&below));
+}
+
+/* The FIR as its declaration defines it, with the inputs before the run in
+ * @p past[channel][k], newest first, kept up to date.
+ */
+#define REF_FIR_MAX_TAPS 16
+
+static void ref_fir(int32_t *data, size_t count, const int32_t *taps, size_t tap_count,
+		    int32_t past[][REF_FIR_MAX_TAPS], size_t channels)
+{
+	size_t i;
+	size_t k;
+
+	for (i = 0; i < count; i++) {
+		int32_t *x = past[i % channels];
+		int64_t acc = INT64_C(1) << 27;
+
+		memmove(&x[1], &x[0], sizeof(x[0]) * (REF_FIR_MAX_TAPS - 1U));
+		x[0] = data[i];
+		for (k = 0; k < tap_count; k++) {
+			acc += (int64_t)taps[k] * x[k];
+		}
+		data[i] = ref_sat32(acc >> 28);
+	}
+}
+
+/* A pure delay, a smoothing average, a filter with gain well above unity so
+ * the clamp runs, and taps at the ends of the Q4.28 range.
+ */
+static const int32_t fir_delay[] = {0, 0, AUDIO_DSP_COEFF(1.0)};
+static const int32_t fir_average[] = {
+	AUDIO_DSP_COEFF(0.2), AUDIO_DSP_COEFF(0.2), AUDIO_DSP_COEFF(0.2),
+	AUDIO_DSP_COEFF(0.2), AUDIO_DSP_COEFF(0.2),
+};
+static const int32_t fir_boost[] = {
+	AUDIO_DSP_COEFF(3.0), AUDIO_DSP_COEFF(-2.5), AUDIO_DSP_COEFF(1.25), AUDIO_DSP_COEFF(-0.5),
+	AUDIO_DSP_COEFF(0.125), AUDIO_DSP_COEFF(0.0), AUDIO_DSP_COEFF(-0.0625),
+};
+static const int32_t fir_edges[] = {INT32_MIN, INT32_MAX - 1};
+
+ZTEST(audio_dsp, test_fir_matches_its_definition)
+{
+	static const struct {
+		const int32_t *taps;
+		size_t tap_count;
+	} filters[] = {
+		{fir_delay, ARRAY_SIZE(fir_delay)},
+		{fir_average, ARRAY_SIZE(fir_average)},
+		{fir_boost, ARRAY_SIZE(fir_boost)},
+		{fir_edges, ARRAY_SIZE(fir_edges)},
+	};
+	static const size_t channel_counts[] = {1U, 2U, 3U};
+	int32_t past[3][REF_FIR_MAX_TAPS];
+	int32_t line[3 * 2 * REF_FIR_MAX_TAPS];
+	int32_t data[DSP_SAMPLES * 3];
+	int32_t want[DSP_SAMPLES * 3];
+	size_t f;
+	size_t ch;
+	size_t i;
+
+	for (f = 0; f < ARRAY_SIZE(filters); f++) {
+		zassert_true(audio_dsp_fir_is_bounded(filters[f].taps, filters[f].tap_count),
+			     "filter %zu", f);
+
+		for (ch = 0; ch < ARRAY_SIZE(channel_counts); ch++) {
+			const size_t channels = channel_counts[ch];
+			const size_t count = DSP_SAMPLES * channels;
+			struct audio_dsp_fir fir = {
+				.taps = filters[f].taps,
+				.line = line,
+				.tap_count = (uint16_t)filters[f].tap_count,
+			};
+			size_t split = (DSP_SAMPLES / 3U) * channels;
+
+			fill(data, 700U + f);
+			fill(&data[DSP_SAMPLES], 800U + f);
+			fill(&data[DSP_SAMPLES * 2U], 900U + f);
+			memcpy(want, data, sizeof(data));
+			memset(line, 0, sizeof(line));
+			memset(past, 0, sizeof(past));
+
+			/* Three calls, so the delay line has to carry across two
+			 * seams, one of them with the position wrapped.
+			 */
+			audio_dsp_fir_q31(data, split, &fir, channels);
+			audio_dsp_fir_q31(&data[split], split, &fir, channels);
+			audio_dsp_fir_q31(&data[2U * split], count - 2U * split, &fir, channels);
+			ref_fir(want, count, filters[f].taps, filters[f].tap_count, past, channels);
+
+			for (i = 0; i < count; i++) {
+				zassert_equal(data[i], want[i],
+					      "filter %zu, %zu ch, sample %zu: %d, expected %d", f,
+					      channels, i, data[i], want[i]);
+			}
+		}
+	}
+}
+
+ZTEST(audio_dsp, test_fir_bound_is_on_the_magnitudes)
+{
+	static const int32_t at_bound[] = {INT32_MIN, INT32_MIN};
+	static const int32_t below[] = {INT32_MIN, INT32_MAX};
+
+	/* Two taps of -8 reach 16 exactly; -8 and just under 8 do not. */
+	zassert_false(audio_dsp_fir_is_bounded(at_bound, ARRAY_SIZE(at_bound)));
+	zassert_true(audio_dsp_fir_is_bounded(below, ARRAY_SIZE(below)));
+}
+
+#define FFT_ORDER	 9
+#define FFT_TAPS	 200
+#define FFT_SETS	 1100
+
+static int32_t fft_taps[FFT_TAPS];
+static struct audio_dsp_complex fft_spectrum[1 << FFT_ORDER];
+static struct audio_dsp_complex fft_work[1 << FFT_ORDER];
+static int32_t fft_history[2 * (FFT_TAPS - 1)];
+static int32_t fft_line[2 * 2 * FFT_TAPS];
+static int32_t fft_data[2 * FFT_SETS];
+static int32_t fft_want[2 * FFT_SETS];
+
+/* Pseudo-random samples, full scale or @p shift bits below it. */
+static void fill_long(int32_t *buf, size_t count, uint32_t seed, unsigned int shift)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		seed = seed * 1664525U + 1013904223U;
+		buf[i] = (int32_t)seed >> shift;
+	}
+}
+
+ZTEST(audio_dsp, test_fir_fft_tracks_the_direct_form)
+{
+	/* Calls shorter than a block, longer than one, and of one sample set. */
+	static const size_t calls[] = {64U, 700U, 1U, 250U, 85U};
+	static const struct {
+		unsigned int shift;
+		int32_t tolerance;
+	} levels[] = {
+		/* Full-scale noise, and the same 48 dB down. */
+		{0U, 512},
+		{8U, 4},
+	};
+	size_t channels;
+	size_t l;
+	size_t c;
+	size_t i;
+
+	/* Small pseudo-random taps, so the response is flat-ish and every
+	 * bin of the transform is in use. The sum stays under 4.
+	 */
+	fill_long(fft_taps, FFT_TAPS, 11U, 9U);
+	zassert_true(audio_dsp_fir_is_bounded(fft_taps, FFT_TAPS));
+
+	for (channels = 1U; channels <= 2U; channels++) {
+		for (l = 0; l < ARRAY_SIZE(levels); l++) {
+			struct audio_dsp_fir direct = {
+				.taps = fft_taps,
+				.line = fft_line,
+				.tap_count = FFT_TAPS,
+			};
+			struct audio_dsp_fir_fft fft = {
+				.taps = fft_taps,
+				.spectrum = fft_spectrum,
+				.work = fft_work,
+				.history = fft_history,
+				.tap_count = FFT_TAPS,
+				.order = FFT_ORDER,
+			};
+			size_t done = 0;
+
+			fill_long(fft_data, channels * FFT_SETS, 1000U + l, levels[l].shift);
+			memcpy(fft_want, fft_data, sizeof(fft_want));
+			memset(fft_line, 0, sizeof(fft_line));
+			audio_dsp_fir_q31(fft_want, channels * FFT_SETS, &direct, channels);
+
+			audio_dsp_fir_fft_prepare(&fft);
+			for (c = 0; c < ARRAY_SIZE(calls); c++) {
+				audio_dsp_fir_fft_q31(&fft_data[done * channels],
+						      calls[c] * channels, &fft, channels);
+				done += calls[c];
+			}
+			zassert_equal(done, FFT_SETS);
+
+			for (i = 0; i < channels * FFT_SETS; i++) {
+				zassert_within(fft_data[i], fft_want[i], levels[l].tolerance,
+					       "%zu ch, level %zu, sample %zu: %d, direct %d",
+					       channels, l, i, fft_data[i], fft_want[i]);
+			}
+		}
+	}
+}
+
+ZTEST(audio_dsp, test_fft_inverse_undoes_forward)
+{
+	struct audio_dsp_complex data[1 << FFT_ORDER];
+	struct audio_dsp_complex orig[1 << FFT_ORDER];
+	unsigned int scaled;
+	size_t i;
+
+	fill_long((int32_t *)orig, 2U << FFT_ORDER, 77U, 1U);
+	memcpy(data, orig, sizeof(data));
+
+	/* Forward then inverse is 2^order times the input, less the halvings
+	 * the two transforms report.
+	 */
+	scaled = audio_dsp_fft_q31(data, FFT_ORDER, false);
+	scaled += audio_dsp_fft_q31(data, FFT_ORDER, true);
+	zassert_true(scaled <= 2U * FFT_ORDER);
+
+	for (i = 0; i < ARRAY_SIZE(data); i++) {
+		int64_t re = (int64_t)data[i].re * (INT64_C(1) << scaled) >> FFT_ORDER;
+		int64_t im = (int64_t)data[i].im * (INT64_C(1) << scaled) >> FFT_ORDER;
+
+		zassert_within(re, orig[i].re, 1 << 10, "point %zu re", i);
+		zassert_within(im, orig[i].im, 1 << 10, "point %zu im", i);
+	}
+}
+
+/* A small wing: 4 zero crossings of 8 phases, with steps between the
+ * entries of both signs so the interpolation has something to do. It ends
+ * at 0, as a generated one does, and no phase sums past 8.
+ */
+#define RS_ZERO_CROSSINGS 4
+#define RS_PHASES	  8
+#define RS_MAX_RATIO	  6
+#define RS_REACH	  AUDIO_DSP_RESAMPLER_REACH(RS_ZERO_CROSSINGS, RS_MAX_RATIO)
+#define RS_SETS		  150
+#define RS_KEPT_SETS	  128
+
+static int32_t rs_wing[RS_ZERO_CROSSINGS * RS_PHASES + 1];
+static int32_t rs_coeffs[2 * RS_REACH];
+static int32_t rs_src[3 * RS_SETS];
+static int32_t rs_kept[3 * RS_KEPT_SETS];
+/* Room for one output set more than the most any rate pair makes. */
+static int32_t rs_out[3 * (RS_SETS * RS_MAX_RATIO + 1)];
+static int32_t rs_want[3 * (RS_SETS * RS_MAX_RATIO + 1)];
+
+static void rs_make_wing(void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(rs_wing); i++) {
+		int32_t shape = (int32_t)(ARRAY_SIZE(rs_wing) - 1U - i);
+
+		rs_wing[i] = shape * (i % 3U == 0U ? 8 : -5) * (1 << 20);
+	}
+}
+
+/* The wing at Q16 index @p pos as the declaration defines it, gain applied. */
+static int64_t ref_resample_tap(uint64_t pos, int32_t gain)
+{
+	const uint64_t end = (uint64_t)RS_ZERO_CROSSINGS * RS_PHASES << 16;
+	const size_t i = (size_t)(pos >> 16);
+	int64_t h;
+
+	if (pos >= end) {
+		return 0;
+	}
+
+	h = (int64_t)rs_wing[i + 1U] - rs_wing[i];
+	h = rs_wing[i] + ((h * (int64_t)(pos & 0xffffU)) >> 16);
+
+	return (h * gain + (INT64_C(1) << 29)) >> 30;
+}
+
+/* Output @p j of @p src (@p sets long, silence either side), straight from
+ * the definition, for a converter @p rs has prepared.
+ */
+static void ref_resample(int32_t *out, size_t j, const int32_t *src, size_t sets,
+			 const struct audio_dsp_resampler *rs, size_t channels)
+{
+	const uint64_t period = (uint64_t)RS_PHASES << 16;
+	const uint64_t t = (uint64_t)j * rs->in_rate;
+	const int64_t n = (int64_t)(t / rs->out_rate);
+	const uint64_t frac = t % rs->out_rate;
+	const uint64_t phase = frac * period / MAX(rs->in_rate, rs->out_rate);
+	size_t c;
+	int64_t m;
+
+	for (c = 0; c < channels; c++) {
+		int64_t acc = INT64_C(1) << 27;
+
+		for (m = 0; m < RS_REACH; m++) {
+			int64_t left = n - m;
+			int64_t right = n + 1 + m;
+
+			if (left >= 0 && left < (int64_t)sets) {
+				acc += ref_resample_tap(phase + (uint64_t)m * rs->tap_step,
+							rs->gain) *
+				       src[left * channels + c];
+			}
+			if (right < (int64_t)sets) {
+				acc += ref_resample_tap(rs->tap_step - phase +
+								(uint64_t)m * rs->tap_step,
+							rs->gain) *
+				       src[right * channels + c];
+			}
+		}
+		out[c] = ref_sat32(acc >> 28);
+	}
+}
+
+ZTEST(audio_dsp, test_resampler_matches_its_definition)
+{
+	static const uint32_t rates[][2] = {
+		{3U, 4U}, {4U, 3U}, {44100U, 48000U}, {48000U, 44100U},
+		{48000U, 8000U}, {8000U, 48000U},
+	};
+	/* Calls for one output set, for several, and for more than a pull
+	 * brings; pulls of one set and of many.
+	 */
+	static const size_t calls[] = {7U, 1U, 30U, 12U};
+	static const size_t pulls[] = {5U, 17U, 1U, 40U};
+	size_t r;
+	size_t channels;
+	size_t j;
+
+	rs_make_wing();
+
+	for (r = 0; r < ARRAY_SIZE(rates); r++) {
+		for (channels = 1U; channels <= 3U; channels++) {
+			struct audio_dsp_resampler rs = {
+				.wing = rs_wing,
+				.coeffs = rs_coeffs,
+				.zero_crossings = RS_ZERO_CROSSINGS,
+				.phases = RS_PHASES,
+			};
+			const size_t cap = ARRAY_SIZE(rs_out) / channels * channels;
+			size_t kept;
+			size_t fed = 0;
+			size_t flush;
+			size_t done = 0;
+			size_t expected;
+			size_t call;
+
+			fill_long(rs_src, RS_SETS * channels, 2000U + r, 0U);
+			audio_dsp_resampler_prepare(&rs, rates[r][0], rates[r][1]);
+			zassert_true(rs.reach <= RS_REACH, "reach %u", rs.reach);
+
+			/* Driven the way the node drives it: silence in front,
+			 * the input in pulls, silence behind, what is consumed
+			 * dropped after every call.
+			 */
+			kept = (rs.reach - 1U) * channels;
+			memset(rs_kept, 0, sizeof(rs_kept[0]) * kept);
+			flush = rs.reach;
+
+			for (call = 0;; call++) {
+				const size_t ask = MIN(calls[call % ARRAY_SIZE(calls)] * channels,
+						       cap - done);
+				size_t room;
+				size_t got;
+				size_t consumed;
+
+				got = audio_dsp_resample_q31(&rs_out[done], ask, rs_kept, kept,
+							     &consumed, &rs, channels);
+				done += got;
+				kept -= consumed;
+				memmove(rs_kept, &rs_kept[consumed], sizeof(rs_kept[0]) * kept);
+
+				if (done == cap || (fed == RS_SETS && flush == 0U && got < ask)) {
+					break;
+				}
+
+				room = (ARRAY_SIZE(rs_kept) - kept) / channels;
+				if (fed < RS_SETS) {
+					size_t pull = MIN(MIN(pulls[call % ARRAY_SIZE(pulls)],
+							      RS_SETS - fed), room);
+
+					memcpy(&rs_kept[kept], &rs_src[fed * channels],
+					       sizeof(rs_kept[0]) * pull * channels);
+					kept += pull * channels;
+					fed += pull;
+				} else {
+					size_t zeros = MIN(flush, room);
+
+					zeros *= channels;
+					memset(&rs_kept[kept], 0, sizeof(rs_kept[0]) * zeros);
+					kept += zeros;
+					flush -= zeros / channels;
+				}
+			}
+
+			/* Every output whose time falls within the input. */
+			expected = DIV_ROUND_UP((uint64_t)RS_SETS * rs.out_rate, rs.in_rate);
+			zassert_equal(done, expected * channels, "%u to %u, %zu ch: %zu sets",
+				      rates[r][0], rates[r][1], channels, done / channels);
+
+			for (j = 0; j < expected; j++) {
+				ref_resample(&rs_want[j * channels], j, rs_src, RS_SETS, &rs,
+					     channels);
+			}
+			for (j = 0; j < done; j++) {
+				zassert_equal(rs_out[j], rs_want[j],
+					      "%u to %u, %zu ch, sample %zu: %d, expected %d",
+					      rates[r][0], rates[r][1], channels, j, rs_out[j],
+					      rs_want[j]);
+			}
+		}
+	}
+}
+
+/* The PCM layouts the kernels cover, with the bits of a container each keeps. */
+static const struct {
+	const char *name;
+	audio_dsp_unpack_fn unpack;
+	audio_dsp_pack_fn pack;
+	size_t bytes;
+	unsigned int bits;
+} pcm_layouts[] = {
+	{"u8", audio_dsp_unpack_u8, audio_dsp_pack_u8, 1U, 8U},
+	{"s16", audio_dsp_unpack_s16, audio_dsp_pack_s16, 2U, 16U},
+	{"s24", audio_dsp_unpack_s24, audio_dsp_pack_s24, 3U, 24U},
+	{"s32", audio_dsp_unpack_s32, audio_dsp_pack_s32, 4U, 32U},
+};
+
+/* A container narrowed as the pack declarations define it, byte by byte. */
+static void ref_pack(size_t layout, int32_t sample, uint8_t *out)
+{
+	const size_t bytes = pcm_layouts[layout].bytes;
+	int32_t value = sample >> (32U - pcm_layouts[layout].bits);
+	size_t b;
+
+	if (bytes == 1U) {
+		value += 128;
+	}
+	for (b = 0; b < bytes; b++) {
+		out[b] = (uint8_t)((uint32_t)value >> (8U * b));
+	}
+}
+
+/* A sample widened as the unpack declarations define it. */
+static int32_t ref_unpack(size_t layout, const uint8_t *in)
+{
+	const size_t bytes = pcm_layouts[layout].bytes;
+	uint32_t value = 0U;
+	size_t b;
+
+	for (b = 0; b < bytes; b++) {
+		value |= (uint32_t)in[b] << (8U * b);
+	}
+	if (bytes == 1U) {
+		return ((int32_t)value - 128) * (1 << 24);
+	}
+
+	return (int32_t)(value << (32U - pcm_layouts[layout].bits));
+}
+
+ZTEST(audio_dsp, test_pcm_kernels_match_their_definition)
+{
+	uint8_t packed[DSP_SAMPLES * sizeof(int32_t) + 1U];
+	int32_t frame[DSP_SAMPLES];
+	int32_t src[DSP_SAMPLES];
+	int32_t out[DSP_SAMPLES];
+	uint8_t want[4];
+	size_t l;
+	size_t i;
+
+	for (l = 0; l < ARRAY_SIZE(pcm_layouts); l++) {
+		const size_t bytes = pcm_layouts[l].bytes;
+		const uint32_t kept = UINT32_MAX << (32U - pcm_layouts[l].bits);
+
+		fill(src, 800U + (uint32_t)l);
+
+		memset(packed, 0xa5, sizeof(packed));
+		pcm_layouts[l].pack(packed, src, DSP_SAMPLES);
+		for (i = 0; i < DSP_SAMPLES; i++) {
+			ref_pack(l, src[i], want);
+			zassert_mem_equal(&packed[i * bytes], want, bytes, "%s: sample %zu: %d",
+					  pcm_layouts[l].name, i, src[i]);
+		}
+		zassert_equal(packed[DSP_SAMPLES * bytes], 0xa5U, "%s: packed past the end",
+			      pcm_layouts[l].name);
+
+		/* Every container narrowing keeps comes back as it was. */
+		pcm_layouts[l].unpack(out, packed, DSP_SAMPLES);
+		for (i = 0; i < DSP_SAMPLES; i++) {
+			zassert_equal(out[i], ref_unpack(l, &packed[i * bytes]),
+				      "%s: sample %zu", pcm_layouts[l].name, i);
+			zassert_equal(out[i], (int32_t)((uint32_t)src[i] & kept),
+				      "%s: sample %zu did not survive", pcm_layouts[l].name, i);
+		}
+
+		/* In place both ways, as the file nodes run them. */
+		memcpy(frame, src, sizeof(src));
+		pcm_layouts[l].pack((uint8_t *)frame, frame, DSP_SAMPLES);
+		zassert_mem_equal(frame, packed, DSP_SAMPLES * bytes, "%s: packed in place",
+				  pcm_layouts[l].name);
+		pcm_layouts[l].unpack(frame, (const uint8_t *)frame, DSP_SAMPLES);
+		zassert_mem_equal(frame, out, sizeof(out), "%s: unpacked in place",
+				  pcm_layouts[l].name);
+	}
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+/*
+ * The conversions as their declarations define them, in double, where every
+ * container and every float is exact and so is x * 2^31 + 0.5.
+ */
+static float ref_s32_to_f32(int32_t sample)
+{
+	return (float)((double)sample / 2147483648.0);
+}
+
+static int32_t ref_f32_to_s32(float x)
+{
+	double scaled = (double)x * 2147483648.0;
+
+	if (x != x) {
+		return 0;
+	}
+	if (scaled >= 2147483648.0) {
+		return INT32_MAX;
+	}
+	if (scaled <= -2147483648.0) {
+		return INT32_MIN;
+	}
+
+	return (int32_t)(scaled >= 0.0 ? (int64_t)(scaled + 0.5) : -(int64_t)(-scaled + 0.5));
+}
+
+ZTEST(audio_dsp, test_float_conversions_match_their_definition)
+{
+	static const float edges[] = {
+		1.0f, -1.0f, 2.0f, -2.0f, 0.25f, -0.0f,
+		/* Half an LSB either way, and one and a half: ties go away from 0. */
+		0x1p-32f, -0x1p-32f, 0x1.8p-31f, -0x1.8p-31f, 0x1.fep-33f,
+		/* The largest float below 1.0, which is INT32_MAX - 127. */
+		0x1.fffffep-1f,
+	};
+	int32_t src[DSP_SAMPLES];
+	int32_t back[DSP_SAMPLES];
+	float mid[DSP_SAMPLES];
+	int32_t out;
+	size_t i;
+
+	fill(src, 700U);
+	audio_dsp_s32_to_f32(mid, src, DSP_SAMPLES);
+	for (i = 0; i < DSP_SAMPLES; i++) {
+		zassert_equal(mid[i], ref_s32_to_f32(src[i]), "sample %zu: %d", i, src[i]);
+	}
+
+	audio_dsp_f32_to_s32(back, mid, DSP_SAMPLES);
+	for (i = 0; i < DSP_SAMPLES; i++) {
+		zassert_equal(back[i], ref_f32_to_s32(mid[i]), "sample %zu: %d", i, src[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(edges); i++) {
+		audio_dsp_f32_to_s32(&out, &edges[i], 1U);
+		zassert_equal(out, ref_f32_to_s32(edges[i]), "edge %zu: %d", i, out);
+	}
+
+	mid[0] = __builtin_nanf("");
+	mid[1] = __builtin_inff();
+	mid[2] = -__builtin_inff();
+	audio_dsp_f32_to_s32(back, mid, 3U);
+	zassert_equal(back[0], 0, "a NaN is silence");
+	zassert_equal(back[1], INT32_MAX);
+	zassert_equal(back[2], INT32_MIN);
+
+	/* Every 24-bit sample a source widens survives the round trip, in place. */
+	for (i = 0; i < DSP_SAMPLES; i++) {
+		src[i] = (int32_t)((uint32_t)src[i] & ~0xffU);
+	}
+	src[0] = INT32_MIN;
+	src[1] = (int32_t)(0x7fffffU << 8);
+	memcpy(back, src, sizeof(src));
+	audio_dsp_s32_to_f32((float *)back, back, DSP_SAMPLES);
+	audio_dsp_f32_to_s32(back, (float *)back, DSP_SAMPLES);
+	zassert_mem_equal(back, src, sizeof(src));
+}
+
+/*
+ * The float PCM kernels never touch a float, and are held to the conversions
+ * that do: the same containers out of every bit pattern, the same bits out of
+ * every container.
+ */
+ZTEST(audio_dsp, test_pcm_float_kernels_match_the_conversions)
+{
+	static const uint32_t edges[] = {
+		/* Zero, one, and the largest float below one, both signs. */
+		0x00000000U, 0x80000000U, 0x3f800000U, 0xbf800000U, 0x3f7fffffU, 0xbf7fffffU,
+		/* Infinities, NaNs, denormals, and far past full scale. */
+		0x7f800000U, 0xff800000U, 0x7fc00000U, 0xffc00001U, 0x7f800001U, 0x00000001U,
+		0x807fffffU, 0x4b000000U,
+		/* Half an LSB either way, one and a half, and just under half. */
+		0x2f800000U, 0xaf800000U, 0x30400000U, 0xb0400000U, 0x2f7fffffU,
+	};
+	static const int32_t sample_edges[] = {INT32_MIN, INT32_MAX, 0, -1, 1};
+	uint8_t bytes[4];
+	uint32_t seed = 900U;
+	int32_t want;
+	int32_t got;
+	float value;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(edges) + 4096U; i++) {
+		uint32_t bits;
+
+		if (i < ARRAY_SIZE(edges)) {
+			bits = edges[i];
+		} else {
+			seed = seed * 1664525U + 1013904223U;
+			bits = seed;
+			/* Half of them near full scale, where the rounding is. */
+			if ((i & 1U) != 0U) {
+				bits = (bits & 0x807fffffU) | ((90U + (seed >> 27)) << 23);
+			}
+		}
+
+		memcpy(&value, &bits, sizeof(value));
+		audio_dsp_f32_to_s32(&want, &value, 1U);
+		sys_put_le32(bits, bytes);
+		audio_dsp_unpack_f32(&got, bytes, 1U);
+		zassert_equal(got, want, "0x%08x: %d, expected %d", bits, got, want);
+	}
+
+	for (i = 0; i < 4096U; i++) {
+		int32_t sample;
+		uint32_t bits;
+
+		seed = seed * 1664525U + 1013904223U;
+		/* Every magnitude, not just the ones near full scale. */
+		sample = i < ARRAY_SIZE(sample_edges) ? sample_edges[i]
+						      : (int32_t)seed >> (seed % 31U);
+
+		audio_dsp_s32_to_f32(&value, &sample, 1U);
+		memcpy(&bits, &value, sizeof(bits));
+		audio_dsp_pack_f32(bytes, &sample, 1U);
+		zassert_equal(sys_get_le32(bytes), bits, "%d: 0x%08x, expected 0x%08x", sample,
+			      sys_get_le32(bytes), bits);
+	}
+}
+
+ZTEST(audio_dsp, test_float_gain_matches_its_definition)
+{
+	static const float f32_gains[] = {0.5f, -1.25f, 3.0f};
+	float data[DSP_SAMPLES * 3];
+	float src[DSP_SAMPLES * 3];
+	int32_t raw[DSP_SAMPLES];
+	size_t channels;
+	size_t i;
+
+	fill(raw, 800U);
+	for (i = 0; i < ARRAY_SIZE(src); i++) {
+		src[i] = ref_s32_to_f32(raw[i % DSP_SAMPLES]) * (float)(i % 5U);
+	}
+
+	for (channels = 1U; channels <= ARRAY_SIZE(f32_gains); channels++) {
+		const size_t count = DSP_SAMPLES * channels;
+
+		memcpy(data, src, sizeof(src));
+		audio_dsp_gain_f32(data, data, count, f32_gains, channels);
+		for (i = 0; i < count; i++) {
+			zassert_equal(data[i], src[i] * f32_gains[i % channels],
+				      "%zu ch, sample %zu", channels, i);
+		}
+	}
+}
+
+/*
+ * The float biquad is held to the Q31 one on the stages that do not clip:
+ * within the float's own rounding, a few dozen LSBs of a container on an
+ * input 24 dB down, where both forms are far from either's noise floor.
+ */
+#define BIQUAD_F32_TOLERANCE 256
+
+ZTEST(audio_dsp, test_float_biquad_tracks_the_q31_one)
+{
+	static const size_t stages[] = {0U, 2U};
+	struct audio_dsp_biquad_f32_history f32_history[2];
+	struct audio_dsp_biquad_f32_history whole_history[2];
+	struct audio_dsp_biquad_history history[2];
+	struct audio_dsp_biquad_f32 stage;
+	int32_t want[DSP_SAMPLES * 2];
+	float whole[DSP_SAMPLES * 2];
+	float data[DSP_SAMPLES * 2];
+	int32_t got[DSP_SAMPLES * 2];
+	size_t channels;
+	size_t split;
+	size_t b;
+	size_t i;
+
+	for (b = 0; b < ARRAY_SIZE(stages); b++) {
+		audio_dsp_biquad_to_f32(&biquads[stages[b]], &stage);
+
+		for (channels = 1U; channels <= 2U; channels++) {
+			const size_t count = DSP_SAMPLES * channels;
+
+			fill(want, 900U + b);
+			fill(&want[DSP_SAMPLES], 950U + b);
+			for (i = 0; i < count; i++) {
+				want[i] >>= 4;
+			}
+			audio_dsp_s32_to_f32(data, want, count);
+			memcpy(whole, data, sizeof(data));
+			memset(history, 0, sizeof(history));
+			memset(f32_history, 0, sizeof(f32_history));
+			memset(whole_history, 0, sizeof(whole_history));
+
+			audio_dsp_biquad_q31(want, count, &biquads[stages[b]], history, channels);
+
+			/* The same samples in one call and in two: the history has to
+			 * carry the recurrence over the seam exactly.
+			 */
+			split = (DSP_SAMPLES / 2U) * channels;
+			audio_dsp_biquad_f32(data, split, &stage, f32_history, channels);
+			audio_dsp_biquad_f32(&data[split], count - split, &stage, f32_history,
+					     channels);
+			audio_dsp_biquad_f32(whole, count, &stage, whole_history, channels);
+			zassert_mem_equal(data, whole, count * sizeof(data[0]));
+			zassert_mem_equal(f32_history, whole_history, sizeof(f32_history));
+
+			audio_dsp_f32_to_s32(got, data, count);
+			for (i = 0; i < count; i++) {
+				int64_t err = (int64_t)got[i] - want[i];
+
+				zassert_true(err >= -BIQUAD_F32_TOLERANCE &&
+						     err <= BIQUAD_F32_TOLERANCE,
+					     "stage %zu, %zu ch, sample %zu: %d, Q31 gives %d",
+					     stages[b], channels, i, got[i], want[i]);
+			}
+		}
+	}
+}
+#endif /* CONFIG_AUDIO_PIPELINE_FLOAT */
+
+ZTEST(audio_dsp, test_zero_samples_touch_nothing)
+{
+	int32_t acc[1] = {42};
+	int32_t src[1] = {INT32_MAX};
+
+	audio_dsp_mac_q15(acc, src, 0U, AUDIO_DSP_UNITY_Q15);
+	audio_dsp_gain_q15(acc, src, 0U, AUDIO_DSP_UNITY_Q15);
+	audio_dsp_gain_q31(acc, src, 0U, gain_sets[0], 1U);
+	audio_dsp_gain_q31(acc, src, 1U, gain_sets[0], 0U);
+	zassert_equal(acc[0], 42);
+
+	{
+		struct audio_dsp_matrix mx = {
+			.coeffs_q15 = mx_general,
+			.in_channels = 3U,
+			.out_channels = 2U,
+		};
+
+		audio_dsp_matrix_prepare(&mx);
+		audio_dsp_matrix_q15(acc, src, 0U, &mx);
+		zassert_equal(acc[0], 42);
+	}
+
+	audio_dsp_deinterleave(acc, 1U, src, 0U, 1U);
+	audio_dsp_interleave(acc, src, 1U, 0U, 2U);
+	zassert_equal(acc[0], 42);
+
+	for (size_t l = 0; l < ARRAY_SIZE(pcm_layouts); l++) {
+		pcm_layouts[l].unpack(acc, (const uint8_t *)src, 0U);
+		pcm_layouts[l].pack((uint8_t *)acc, src, 0U);
+	}
+	audio_dsp_unpack_f32(acc, (const uint8_t *)src, 0U);
+	audio_dsp_pack_f32((uint8_t *)acc, src, 0U);
+	zassert_equal(acc[0], 42);
+
+#ifdef CONFIG_AUDIO_PIPELINE_FLOAT
+	audio_dsp_s32_to_f32((float *)acc, src, 0U);
+	audio_dsp_f32_to_s32(acc, (const float *)src, 0U);
+	audio_dsp_gain_f32((float *)acc, (const float *)src, 0U, (const float *)src, 1U);
+	zassert_equal(acc[0], 42);
+#endif
+
+	{
+		struct audio_dsp_biquad_history history = {0};
+
+		audio_dsp_biquad_q31(acc, 0U, &biquads[0], &history, 1U);
+		zassert_equal(acc[0], 42);
+		zassert_equal(history.y1, 0);
+	}
+
+	{
+		int32_t line[2 * ARRAY_SIZE(fir_average)] = {0};
+		struct audio_dsp_fir fir = {
+			.taps = fir_average,
+			.line = line,
+			.tap_count = ARRAY_SIZE(fir_average),
+		};
+
+		audio_dsp_fir_q31(acc, 0U, &fir, 1U);
+		zassert_equal(acc[0], 42);
+		zassert_equal(fir.pos, 0U);
+	}
+
+	{
+		struct audio_dsp_resampler rs = {
+			.wing = rs_wing,
+			.coeffs = rs_coeffs,
+			.zero_crossings = RS_ZERO_CROSSINGS,
+			.phases = RS_PHASES,
+		};
+		size_t consumed = 1;
+
+		audio_dsp_resampler_prepare(&rs, 44100U, 48000U);
+		zassert_equal(audio_dsp_resample_q31(acc, 1U, src, 0U, &consumed, &rs, 1U), 0U);
+		zassert_equal(audio_dsp_resample_q31(acc, 0U, src, 1U, &consumed, &rs, 1U), 0U);
+		zassert_equal(acc[0], 42);
+		zassert_equal(consumed, 0U);
+		zassert_equal(rs.frac, 0U);
+	}
+}
@@ -47,12 +47,16 @@
 /*
  * Deliberately not CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES, and deliberately
  * smaller: the block arithmetic must follow the capacity this pipeline was
- * defined with, and a block that holds more than one frame is what makes the
- * draining case below meaningful.
+ * defined with.
  */
 #define FRAME_SAMPLES 32
 #define RX_BLOCKS     2
 
+/* A frame smaller than the one the node was defined for, so one block outlasts
+ * it - which is what makes the draining case below meaningful.
+ */
+#define DRAIN_FRAME_SAMPLES (FRAME_SAMPLES / 4)
+
 #define SAMPLE_RATE_HZ 48000U
 #define CHANNELS       2U
 #define VALID_BITS     16U
@@ -60,14 +64,18 @@
 /* A depth the container describes but the wire seam does not carry. */
 #define UNSUPPORTED_BITS 24U
 
-/* Bytes one block holds, and the words that fit into it at the bound depth. */
-#define BLOCK_BYTES AUDIO_I2S_BLOCK_BYTES(FRAME_SAMPLES)
-#define BLOCK_WORDS (BLOCK_BYTES / (VALID_BITS / 8U))
+/* Bytes one block holds, the bytes of it the driver is asked to fill - one
+ * frame of wire words, leaving the room they need to widen in place - and the
+ * words that makes at the bound depth.
+ */
+#define BLOCK_BYTES    AUDIO_I2S_BLOCK_BYTES(FRAME_SAMPLES)
+#define RX_BLOCK_BYTES (FRAME_SAMPLES * (VALID_BITS / 8U))
+#define BLOCK_WORDS    (RX_BLOCK_BYTES / (VALID_BITS / 8U))
 
-/* Frames it takes to drain one block, which has to be more than one for the
- * draining case to say anything.
+/* Small frames it takes to drain one block, which has to be more than one for
+ * the draining case to say anything.
  */
-#define FRAMES_PER_BLOCK (BLOCK_WORDS / FRAME_SAMPLES)
+#define FRAMES_PER_BLOCK (BLOCK_WORDS / DRAIN_FRAME_SAMPLES)
 
 /* ---------------------------------------------------------------------------
  * Build-time assertions
@@ -88,6 +96,8 @@ BUILD_ASSERT(BLOCK_BYTES != AUDIO_I2S_BLOCK_BYTES(CONFIG_AUDIO_PIPELINE_FRAME_SA
 	     "the block size must not come from CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES");
 BUILD_ASSERT(FRAMES_PER_BLOCK >= 2,
 	     "the draining case needs a block that outlasts a single frame");
+BUILD_ASSERT(BLOCK_WORDS == FRAME_SAMPLES,
+	     "a block must carry exactly the frame it widens into in place");
 
 /* ---------------------------------------------------------------------------
  * The nodes under test
@@ -122,11 +132,11 @@ static int open_source(struct audio_node *node, struct audio_stream_config *fmt,
 	return audio_node_open(node);
 }
 
-static int pull_frame(struct audio_node *node, size_t *out_size)
+static int pull_frame_of(struct audio_node *node, size_t capacity, size_t *out_size)
 {
 	struct audio_buffer_view view = {
 		.data = frame_storage,
-		.capacity = ARRAY_SIZE(frame_storage),
+		.capacity = capacity,
 	};
 
 	/* Deliberately not cleared here: reporting no samples is the pipeline's
@@ -136,6 +146,11 @@ static int pull_frame(struct audio_node *node, size_t *out_size)
 	return audio_node_process(node, &view, out_size);
 }
 
+static int pull_frame(struct audio_node *node, size_t *out_size)
+{
+	return pull_frame_of(node, ARRAY_SIZE(frame_storage), out_size);
+}
+
 /* The container sample a wire word of @p word must widen to (spec §5.3). */
 static int32_t widened(uint16_t word)
 {
@@ -150,6 +165,12 @@ static int32_t widened(uint16_t word)
 struct capture_state {
 	uint32_t frames;
 	size_t last_size;
+	/* Storage the most recent frame was produced in. */
+	const int32_t *last_data;
+	/* First sample of the most recent frame. */
+	int32_t last_first;
+	/* Receive blocks out of the slab while the most recent frame ran. */
+	uint32_t blocks_out;
 };
 
 static struct capture_state capture_state_inst;
@@ -175,6 +196,9 @@ static int capture_process(struct audio_node *node, struct audio_buffer_view *bu
 
 	state->frames++;
 	state->last_size = *out_size;
+	state->last_data = buf->data;
+	state->last_first = buf->data[0];
+	state->blocks_out = RX_BLOCKS - k_mem_slab_num_free_get(&i2s_in_a_slab);
 
 	return 0;
 }
@@ -307,9 +331,14 @@ ZTEST(audio_i2s_in_node, test_i2s_in_configures_the_device_as_a_clock_target)
 	zassert_equal(cfg->frame_clk_freq, SAMPLE_RATE_HZ);
 	zassert_equal(cfg->channels, CHANNELS);
 	zassert_equal(cfg->word_size, VALID_BITS);
+#ifdef CONFIG_AUDIO_PIPELINE_I2S_TDM
+	zassert_equal(cfg->format, I2S_FMT_DATA_FORMAT_PCM_SHORT);
+#else
 	zassert_equal(cfg->format, I2S_FMT_DATA_FORMAT_I2S);
+#endif
 	zassert_equal(cfg->mem_slab, &i2s_in_a_slab, "the node must receive into its own slab");
-	zassert_equal(cfg->block_size, BLOCK_BYTES);
+	zassert_equal(cfg->block_size, RX_BLOCK_BYTES,
+		      "the driver must fill one frame of words, leaving room to widen them");
 	zassert_equal(cfg->timeout, SYS_FOREVER_MS,
 		      "the blocking read is the pacing mechanism, not a bug");
 
@@ -360,11 +389,39 @@ ZTEST(audio_i2s_in_node, test_i2s_in_open_refuses_an_unsupported_depth)
 
 ZTEST(audio_i2s_in_node, test_i2s_in_open_refuses_a_channel_count_the_frame_cannot_carry)
 {
+#ifdef CONFIG_AUDIO_PIPELINE_I2S_TDM
+	zassert_equal(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ,
+				  CONFIG_AUDIO_PIPELINE_MAX_CHANNELS + 1U, VALID_BITS),
+		      -ENOTSUP, "a TDM frame has no slot beyond the channel ceiling");
+#else
 	zassert_equal(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ, 1U, VALID_BITS), -ENOTSUP,
 		      "an I2S frame carries two words, so mono must be refused");
+#endif
 	zassert_equal(fake_i2s_data_get(dev_a)->configures, 0U);
 }
 
+#ifdef CONFIG_AUDIO_PIPELINE_I2S_TDM
+ZTEST(audio_i2s_in_node, test_i2s_in_carries_a_slot_per_channel_in_tdm)
+{
+	const struct i2s_config *cfg;
+
+	/* A TDM frame is as wide as the stream, from one slot to the ceiling,
+	 * and the driver is told how many slots that is.
+	 */
+	zassert_ok(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ,
+			       CONFIG_AUDIO_PIPELINE_MAX_CHANNELS, VALID_BITS));
+	cfg = i2s_config_get(dev_a, I2S_DIR_RX);
+	zassert_equal(cfg->channels, CONFIG_AUDIO_PIPELINE_MAX_CHANNELS);
+	zassert_equal(cfg->format, I2S_FMT_DATA_FORMAT_PCM_SHORT);
+	zassert_ok(audio_node_close(&i2s_in_a));
+
+	zassert_ok(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ, 1U, VALID_BITS),
+		   "a TDM frame of one slot is a mono stream, not an error");
+	zassert_equal(i2s_config_get(dev_a, I2S_DIR_RX)->channels, 1U);
+	zassert_ok(audio_node_close(&i2s_in_a));
+}
+#endif
+
 ZTEST(audio_i2s_in_node, test_i2s_in_open_fails_when_the_device_cannot_be_configured)
 {
 	size_t produced = 0;
@@ -468,12 +525,12 @@ ZTEST(audio_i2s_in_node, test_i2s_in_drains_one_block_across_several_frames)
 
 	zassert_ok(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ, CHANNELS, VALID_BITS));
 
-	/* A block holds more than one frame, and the surplus is delivered
+	/* A block holds more than a small frame, and the surplus is delivered
 	 * rather than dropped: FRAMES_PER_BLOCK frames come out of one read.
 	 */
 	for (frame = 0U; frame < FRAMES_PER_BLOCK; frame++) {
-		zassert_ok(pull_frame(&i2s_in_a, &produced));
-		zassert_equal(produced, FRAME_SAMPLES, "frame %u came up short", frame);
+		zassert_ok(pull_frame_of(&i2s_in_a, DRAIN_FRAME_SAMPLES, &produced));
+		zassert_equal(produced, DRAIN_FRAME_SAMPLES, "frame %u came up short", frame);
 		zassert_equal(fake_i2s_data_get(dev_a)->reads, 1U,
 			      "frame %u went back to the driver instead of draining the block",
 			      frame);
@@ -483,15 +540,120 @@ ZTEST(audio_i2s_in_node, test_i2s_in_drains_one_block_across_several_frames)
 	zassert_equal(k_mem_slab_num_free_get(&i2s_in_a_slab), RX_BLOCKS,
 		      "the drained block was not returned to the slab");
 
-	zassert_ok(pull_frame(&i2s_in_a, &produced));
+	zassert_ok(pull_frame_of(&i2s_in_a, DRAIN_FRAME_SAMPLES, &produced));
 	zassert_equal(fake_i2s_data_get(dev_a)->reads, 2U, "a drained block must be refilled");
 	/* Word numbering continues, so nothing was lost between the blocks. */
-	zassert_equal(frame_storage[0], widened((uint16_t)(FRAMES_PER_BLOCK * FRAME_SAMPLES)),
+	zassert_equal(frame_storage[0], widened((uint16_t)BLOCK_WORDS),
 		      "samples went missing at the block boundary");
 
 	zassert_ok(audio_node_close(&i2s_in_a));
 }
 
+/* ---------------------------------------------------------------------------
+ * Lending the block (spec §4.1.2)
+ * ---------------------------------------------------------------------------
+ */
+
+ZTEST(audio_i2s_in_node, test_i2s_in_lends_a_block_that_widens_in_place)
+{
+	struct audio_buffer_view view = {
+		.data = frame_storage,
+		.capacity = FRAME_SAMPLES,
+	};
+	size_t produced = 0;
+	size_t i;
+
+	zassert_ok(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ, CHANNELS, VALID_BITS));
+
+	zassert_ok(audio_node_lend(&i2s_in_a, &view));
+	zassert_not_equal(view.data, frame_storage, "the node lent nothing");
+	zassert_equal(view.capacity, FRAME_SAMPLES, "lending must not change the capacity");
+
+	zassert_ok(audio_node_process(&i2s_in_a, &view, &produced));
+	zassert_equal(produced, FRAME_SAMPLES);
+
+	for (i = 0; i < produced; i++) {
+		zassert_equal(view.data[i], widened((uint16_t)i),
+			      "sample %zu is 0x%08x after widening in place", i,
+			      (unsigned int)view.data[i]);
+	}
+
+	/* The chain is still working in the block, so it is still out. */
+	zassert_equal(k_mem_slab_num_free_get(&i2s_in_a_slab), RX_BLOCKS - 1,
+		      "a lent block went back while the frame was in it");
+
+	/* The next lend ends the frame: one block back, the next one out. */
+	view.data = frame_storage;
+	zassert_ok(audio_node_lend(&i2s_in_a, &view));
+	zassert_equal(fake_i2s_data_get(dev_a)->reads, 2U);
+	zassert_equal(k_mem_slab_num_free_get(&i2s_in_a_slab), RX_BLOCKS - 1,
+		      "the previous frame's block was not released");
+
+	/* And close() returns a lent block no frame was produced in. */
+	zassert_ok(audio_node_close(&i2s_in_a));
+	zassert_equal(k_mem_slab_num_free_get(&i2s_in_a_slab), RX_BLOCKS,
+		      "close() left a lent block outstanding");
+}
+
+ZTEST(audio_i2s_in_node, test_i2s_in_copies_a_lent_block_into_other_storage)
+{
+	struct audio_buffer_view view = {
+		.data = frame_storage,
+		.capacity = FRAME_SAMPLES,
+	};
+	size_t produced = 0;
+	size_t i;
+
+	zassert_ok(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ, CHANNELS, VALID_BITS));
+	zassert_ok(audio_node_lend(&i2s_in_a, &view));
+
+	/* A node between the ends pulled into a scratch frame of its own: the
+	 * words are copied out, and the lent block is left intact for it.
+	 */
+	zassert_ok(pull_frame(&i2s_in_a, &produced));
+	zassert_equal(produced, FRAME_SAMPLES);
+
+	for (i = 0; i < produced; i++) {
+		zassert_equal(frame_storage[i], widened((uint16_t)i));
+	}
+
+	zassert_equal(k_mem_slab_num_free_get(&i2s_in_a_slab), RX_BLOCKS - 1,
+		      "the lent block went back while it was still the frame's storage");
+
+	zassert_ok(audio_node_close(&i2s_in_a));
+}
+
+ZTEST(audio_i2s_in_node, test_i2s_in_lends_its_blocks_to_the_pipeline)
+{
+	uint32_t frame;
+
+	format_a.sample_rate_hz = SAMPLE_RATE_HZ;
+	format_a.channels = CHANNELS;
+	format_a.valid_bits_per_sample = VALID_BITS;
+	format_a.format = AUDIO_SAMPLE_FORMAT_S32_LE;
+
+	zassert_ok(audio_pipeline_init(&test_pipeline, &test_config, &capture_sink));
+	zassert_ok(audio_pipeline_set_format(&test_pipeline, &format_a));
+	zassert_ok(audio_pipeline_start(&test_pipeline));
+
+	for (frame = 0U; frame < 2U * RX_BLOCKS; frame++) {
+		zassert_equal(audio_pipeline_process_frame(&test_pipeline), 0);
+
+		/* The sink saw the frame in the received block, not in the
+		 * pipeline's buffer, and exactly one block was out for it.
+		 */
+		zassert_not_equal(capture_state_inst.last_data, test_pipeline.frame_buf,
+				  "frame %u was copied into the pipeline's buffer", frame);
+		zassert_equal(capture_state_inst.blocks_out, 1U);
+		zassert_equal(capture_state_inst.last_size, FRAME_SAMPLES);
+		zassert_equal(capture_state_inst.last_first,
+			      widened((uint16_t)(frame * FRAME_SAMPLES)),
+			      "frame %u does not start where the previous one ended", frame);
+	}
+
+	zassert_ok(audio_pipeline_join(&test_pipeline));
+}
+
 /* ---------------------------------------------------------------------------
  * Failure is never end of stream
  * ---------------------------------------------------------------------------
@@ -552,7 +714,7 @@ ZTEST(audio_i2s_in_node, test_i2s_in_failing_reads_return_every_block)
 	 * slab that has already handed a block out and taken it back.
 	 */
 	for (i = 0U; i < FRAMES_PER_BLOCK; i++) {
-		zassert_ok(pull_frame(&i2s_in_a, &produced));
+		zassert_ok(pull_frame_of(&i2s_in_a, DRAIN_FRAME_SAMPLES, &produced));
 	}
 
 	fake_i2s_data_get(dev_a)->read_ret = -EAGAIN;
@@ -643,11 +805,11 @@ ZTEST(audio_i2s_in_node, test_i2s_in_close_returns_an_outstanding_block)
 
 	zassert_ok(open_source(&i2s_in_a, &format_a, SAMPLE_RATE_HZ, CHANNELS, VALID_BITS));
 
-	/* One frame out of a block that holds several, so the node is still
-	 * holding it when close() runs. i2s_read() passed ownership, so the
-	 * driver's DROP cannot return this one - the node has to.
+	/* One small frame out of a block that holds several, so the node is
+	 * still holding it when close() runs. i2s_read() passed ownership, so
+	 * the driver's DROP cannot return this one - the node has to.
 	 */
-	zassert_ok(pull_frame(&i2s_in_a, &produced));
+	zassert_ok(pull_frame_of(&i2s_in_a, DRAIN_FRAME_SAMPLES, &produced));
 	zassert_equal(k_mem_slab_num_free_get(&i2s_in_a_slab), RX_BLOCKS - 1,
 		      "the node should still be draining a block");
 
@@ -120,6 +120,36 @@ ZTEST(audio_i2s_wire, test_i2s_wire_round_trips_the_wire_representation)
 	zassert_mem_equal(again, back, sizeof(back), "the container form is not stable");
 }
 
+ZTEST(audio_i2s_wire, test_i2s_wire_converts_a_block_in_place)
+{
+	int32_t block[ARRAY_SIZE(container_samples)];
+	uint8_t *wire = (uint8_t *)block;
+	size_t i;
+
+	/* The I2S nodes hand the chain their own slab block (spec §4.1.2), so
+	 * the sink narrows the frame where the chain left it and the source
+	 * widens the received words where the driver put them.
+	 */
+	memcpy(block, container_samples, sizeof(block));
+	zassert_ok(audio_i2s_wire_from_container(WIRE_BITS, block, ARRAY_SIZE(block), wire,
+						 sizeof(block)));
+
+	for (i = 0; i < ARRAY_SIZE(expected_words); i++) {
+		zassert_equal(sys_get_le16(&wire[i * sizeof(uint16_t)]), expected_words[i],
+			      "sample %zu narrowed in place to 0x%04x", i,
+			      sys_get_le16(&wire[i * sizeof(uint16_t)]));
+	}
+
+	zassert_ok(audio_i2s_wire_to_container(WIRE_BITS, wire,
+					       ARRAY_SIZE(expected_words) * sizeof(uint16_t),
+					       block, ARRAY_SIZE(block)));
+
+	for (i = 0; i < ARRAY_SIZE(block); i++) {
+		zassert_equal(block[i], (int32_t)((uint32_t)expected_words[i] << 16),
+			      "word %zu widened in place to 0x%08x", i, (unsigned int)block[i]);
+	}
+}
+
 ZTEST(audio_i2s_wire, test_i2s_wire_leaves_the_rest_of_the_block_untouched)
 {
 	uint8_t wire[8];
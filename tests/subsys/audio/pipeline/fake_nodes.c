@@ -170,6 +170,14 @@ static int fake_sink_process(struct audio_node *node, struct audio_buffer_view *
 		return state->process_ret;
 	}
 
+	if (state->busy_us != 0U) {
+		k_busy_wait(state->busy_us);
+	}
+
+	if (state->sleep_us != 0U) {
+		(void)k_usleep((int32_t)state->sleep_us);
+	}
+
 	/* Through the one pull helper, exactly like a shipped node: a fake that
 	 * called the upstream op itself could pass a chain the real nodes reject.
 	 */
@@ -211,6 +219,100 @@ const struct audio_node_ops audio_fake_sink_ops = {
 	.close = fake_sink_close,
 };
 
+/* -------------------------------------------------------------------------
+ * Sample set source
+ * ----------------------------------------------------------------------
+ */
+
+static int fake_sets_source_open(struct audio_node *node)
+{
+	struct audio_fake_sets_source *state = node->state;
+
+	atomic_set(&state->sets_done, 0);
+
+	return 0;
+}
+
+static int fake_sets_source_process(struct audio_node *node, struct audio_buffer_view *buf,
+				    size_t *out_size)
+{
+	struct audio_fake_sets_source *state = node->state;
+	const struct audio_stream_config *fmt = node->pipeline_format;
+	size_t channels = state->channels;
+	bool planar = fmt != NULL && fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR;
+	size_t channel_stride;
+	size_t sample_stride;
+	size_t done;
+	size_t n = 0;
+	size_t c;
+
+	if (channels == 0U) {
+		zassert_not_null(fmt, "a sample set source with no channel count and no format");
+		channels = fmt->channels;
+	}
+	zassert_true(channels <= CONFIG_AUDIO_PIPELINE_MAX_CHANNELS, "%zu channels", channels);
+
+	/* The layout the strides of audio_node.h describe, for the channel count
+	 * of the script rather than of the format.
+	 */
+	channel_stride = planar ? buf->capacity / channels : 1U;
+	sample_stride = planar ? 1U : channels;
+
+	done = (size_t)atomic_get(&state->sets_done);
+	while (n < buf->capacity / channels && (state->sets == AUDIO_FAKE_ENDLESS ||
+						  done + n < state->sets)) {
+		for (c = 0; c < channels; c++) {
+			buf->data[c * channel_stride + n * sample_stride] =
+				state->base[c] + state->step * (int32_t)(done + n);
+		}
+		n++;
+	}
+	atomic_add(&state->sets_done, (atomic_val_t)n);
+	*out_size = n * channels;
+
+	return 0;
+}
+
+const struct audio_node_ops audio_fake_sets_source_ops = {
+	.open = fake_sets_source_open,
+	.process = fake_sets_source_process,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED) |
+		   AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+};
+
+/* -------------------------------------------------------------------------
+ * Recording sink
+ * ----------------------------------------------------------------------
+ */
+
+static int fake_record_sink_process(struct audio_node *node, struct audio_buffer_view *buf,
+				    size_t *out_size)
+{
+	struct audio_fake_record_sink *state = node->state;
+	size_t recorded;
+	int ret;
+
+	ret = audio_node_pull(node, buf, out_size);
+	if (ret < 0 || *out_size == 0U) {
+		return ret;
+	}
+
+	recorded = (size_t)atomic_get(&state->recorded);
+	if (*out_size > state->capacity - recorded) {
+		atomic_inc(&state->dropped_frames);
+		return 0;
+	}
+
+	memcpy(&state->samples[recorded], buf->data, *out_size * sizeof(buf->data[0]));
+	atomic_add(&state->recorded, (atomic_val_t)*out_size);
+
+	return 0;
+}
+
+const struct audio_node_ops audio_fake_record_sink_ops = {
+	.process = fake_record_sink_process,
+};
+
 /* -------------------------------------------------------------------------
  * Helpers
  * ----------------------------------------------------------------------
@@ -232,6 +334,90 @@ void audio_fake_source_rewind(struct audio_fake_source *src)
 	atomic_set(&src->samples_done, 0);
 }
 
+void audio_fake_sets_source_reset(struct audio_fake_sets_source *src)
+{
+	memset(src, 0, sizeof(*src));
+}
+
+void audio_fake_sets_source_stereo(struct audio_fake_sets_source *src, int32_t left,
+				   int32_t right, size_t sets)
+{
+	audio_fake_sets_source_reset(src);
+	src->base[0] = left;
+	src->base[1] = right;
+	src->channels = 2U;
+	src->sets = sets;
+}
+
+void audio_fake_record_sink_reset(struct audio_fake_record_sink *sink)
+{
+	atomic_set(&sink->recorded, 0);
+	atomic_set(&sink->dropped_frames, 0);
+}
+
+/* Open @p node at @p fmt by hand, then give its upstream what a chain walk
+ * would: the format @p node published, or @p fmt. Returns the former.
+ */
+static const struct audio_stream_config *open_by_hand(struct audio_node *node,
+						      const struct audio_stream_config *fmt)
+{
+	node->pipeline_format = fmt;
+	node->upstream_format = NULL;
+
+	zassert_equal(audio_node_open(node), 0, "open failed");
+	if (node->upstream != NULL) {
+		node->upstream->pipeline_format =
+			node->upstream_format != NULL ? node->upstream_format : fmt;
+	}
+
+	return node->upstream_format;
+}
+
+void audio_fake_open_over_source(struct audio_node *node, const struct audio_stream_config *fmt)
+{
+	zassert_not_null(open_by_hand(node, fmt), "no format published upstream");
+}
+
+size_t audio_fake_run_to_eof(struct audio_node *node, const struct audio_stream_config *fmt,
+			     size_t frame, int32_t *out, size_t cap)
+{
+	static int32_t planar[AUDIO_FAKE_PLANAR_FRAME_MAX];
+	bool gather = fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR;
+	struct audio_buffer_view view;
+	size_t out_size;
+	size_t done = 0;
+	size_t sets;
+	size_t s;
+	size_t c;
+
+	zassert_true(!gather || frame <= ARRAY_SIZE(planar), "a planar frame of %zu samples",
+		     frame);
+
+	(void)open_by_hand(node, fmt);
+	do {
+		/* A planar frame lands in storage of its own and comes back as
+		 * sets, so every caller reads one shape whatever the layout.
+		 */
+		view.data = gather ? planar : &out[done];
+		view.capacity = MIN(frame, cap - done);
+		zassert_true(view.capacity > 0U, "more samples out than %zu", cap);
+		zassert_equal(audio_node_process(node, &view, &out_size), 0, "process failed");
+		zassert_equal(out_size % fmt->channels, 0U, "a frame of part of a sample set");
+
+		sets = out_size / fmt->channels;
+		for (s = 0; gather && s < sets; s++) {
+			for (c = 0; c < fmt->channels; c++) {
+				out[done + s * fmt->channels + c] =
+					planar[c * audio_frame_channel_stride(fmt, &view) + s];
+			}
+		}
+		done += out_size;
+	} while (out_size != 0U);
+	zassert_equal(audio_node_close(node), 0, "close failed");
+
+	return done / fmt->channels;
+}
+
 size_t audio_test_read_file(const char *path, void *buf, size_t cap)
 {
 	struct fs_file_t file;
@@ -1,6 +1,7 @@
 /*
  * Shared fake nodes for the pipeline test suites: one scripted source, one
- * counting sink and a file read-back helper.
+ * per-channel sample set source, one counting sink, one recording sink, and
+ * the helpers that drive a node by hand or read a file back.
  *
  * Every suite used to carry its own near-identical copies of these; they live
  * here now so a new test needs no node implementation of its own for the two
@@ -38,6 +39,12 @@
  */
 #define AUDIO_FAKE_SEM_TIMEOUT K_MSEC(500)
 
+/**
+ * Largest frame audio_fake_run_to_eof() pulls planar, in samples: a planar
+ * frame is gathered back into sample sets from storage of the helper's own.
+ */
+#define AUDIO_FAKE_PLANAR_FRAME_MAX (4 * CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES)
+
 /**
  * @brief State of the shared scripted source (::audio_fake_source_ops).
  *
@@ -133,6 +140,17 @@ struct audio_fake_sink {
 	int32_t expect_pattern;
 	/** Frame capacity every call must be handed; 0 disables the check. */
 	size_t expect_capacity;
+	/**
+	 * Microseconds process() spends busy before it pulls, modelling a node
+	 * that is slower than real time. 0 disables.
+	 */
+	uint32_t busy_us;
+	/**
+	 * Microseconds process() sleeps before it pulls, modelling a sink that
+	 * blocks on its device - the CPU is free meanwhile, unlike with
+	 * @ref busy_us. 0 disables.
+	 */
+	uint32_t sleep_us;
 	/** Given once per consumed frame; NULL disables. */
 	struct k_sem *frame_sem;
 	/**
@@ -169,12 +187,67 @@ struct audio_fake_sink {
 	atomic_ptr_t worker;
 };
 
+/**
+ * @brief State of the shared sample set source (::audio_fake_sets_source_ops).
+ *
+ * Gives @ref sets sample sets, then the end. Channel c of set s is
+ * @ref base[c] plus s times @ref step, so with a step a set out of order shows
+ * as well as a channel out of place, and without one every frame is the same
+ * per-channel pattern. A planar @c pipeline_format gets each channel as a run,
+ * anything else - no format included - interleaved sets.
+ */
+struct audio_fake_sets_source {
+	/* --- Script: set by the test thread before the run. --------------- */
+
+	/** Value of every channel in the first set. */
+	int32_t base[CONFIG_AUDIO_PIPELINE_MAX_CHANNELS];
+	/** What every channel gains from one set to the next. */
+	int32_t step;
+	/** Channels per set; 0 takes the count of the node's @c pipeline_format. */
+	size_t channels;
+	/** Sets to give before the end; ::AUDIO_FAKE_ENDLESS never ends. */
+	size_t sets;
+
+	/* --- Bookkeeping: written by whichever thread drives the chain. --- */
+
+	/** Sets handed out since the last open() or reset. */
+	atomic_t sets_done;
+};
+
+/**
+ * @brief State of the shared recording sink (::audio_fake_record_sink_ops).
+ *
+ * Pulls like the counting sink and keeps every sample it is given, as long as
+ * they fit @ref capacity. Interleaved only, like any node that names no layout.
+ */
+struct audio_fake_record_sink {
+	/* --- Script: set by the test thread before the run. --------------- */
+
+	/** Where the samples go. */
+	int32_t *samples;
+	/** Room at @ref samples, in samples. */
+	size_t capacity;
+
+	/* --- Bookkeeping: written by whichever thread drives the chain. --- */
+
+	/** Samples kept at @ref samples since the last reset. */
+	atomic_t recorded;
+	/** Frames that did not fit what was left of @ref capacity. */
+	atomic_t dropped_frames;
+};
+
 /** Ops of the scripted source; drives ::audio_fake_source. */
 extern const struct audio_node_ops audio_fake_source_ops;
 
 /** Ops of the counting sink/filter; drives ::audio_fake_sink. */
 extern const struct audio_node_ops audio_fake_sink_ops;
 
+/** Ops of the sample set source; drives ::audio_fake_sets_source. */
+extern const struct audio_node_ops audio_fake_sets_source_ops;
+
+/** Ops of the recording sink; drives ::audio_fake_record_sink. */
+extern const struct audio_node_ops audio_fake_record_sink_ops;
+
 /** @brief Statically define a scripted source and its @c <name>_state. */
 #define AUDIO_FAKE_SOURCE_DEFINE(_name)                                                            \
 	static struct audio_fake_source _name##_state;                                             \
@@ -193,6 +266,25 @@ extern const struct audio_node_ops audio_fake_sink_ops;
 	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_FILTER, &audio_fake_sink_ops, (_upstream),        \
 			  &_name##_state)
 
+/** @brief Statically define a sample set source and its @c <name>_state. */
+#define AUDIO_FAKE_SETS_SOURCE_DEFINE(_name)                                                       \
+	static struct audio_fake_sets_source _name##_state;                                        \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SOURCE, &audio_fake_sets_source_ops, NULL,        \
+			  &_name##_state)
+
+/**
+ * @brief Statically define a recording sink and its @c <name>_state, keeping
+ *        up to @p _capacity samples in @c <name>_samples.
+ */
+#define AUDIO_FAKE_RECORD_SINK_DEFINE(_name, _upstream, _capacity)                                 \
+	static int32_t _name##_samples[_capacity];                                                 \
+	static struct audio_fake_record_sink _name##_state = {                                     \
+		.samples = _name##_samples,                                                        \
+		.capacity = (_capacity),                                                           \
+	};                                                                                         \
+	AUDIO_NODE_DEFINE(_name, AUDIO_NODE_ROLE_SINK, &audio_fake_record_sink_ops, (_upstream),   \
+			  &_name##_state)
+
 /** @brief Clear both the script and the counters of @p src. */
 void audio_fake_source_reset(struct audio_fake_source *src);
 
@@ -207,6 +299,54 @@ void audio_fake_sink_reset(struct audio_fake_sink *sink);
  */
 void audio_fake_source_rewind(struct audio_fake_source *src);
 
+/** @brief Clear the script and the counter of @p src. */
+void audio_fake_sets_source_reset(struct audio_fake_sets_source *src);
+
+/**
+ * @brief Script @p src, from reset, for @p sets stereo sets that all carry
+ *        @p left and @p right.
+ */
+void audio_fake_sets_source_stereo(struct audio_fake_sets_source *src, int32_t left,
+				   int32_t right, size_t sets);
+
+/** @brief Forget what @p sink recorded, keeping where it records to. */
+void audio_fake_record_sink_reset(struct audio_fake_record_sink *sink);
+
+/**
+ * @brief Open @p node by hand at @p fmt, and hand its upstream the format it
+ *        published there, the way a chain walk would.
+ *
+ * Fails the calling test if the open fails or @p node, a converter, published
+ * no format of its own for the node above.
+ */
+void audio_fake_open_over_source(struct audio_node *node, const struct audio_stream_config *fmt);
+
+/**
+ * @brief Open @p node at @p fmt, pull it in frames of @p frame samples up to the
+ *        end of the stream, and close it.
+ *
+ * The upstream node gets the format @p node published for it, or @p fmt when
+ * it published none. Every frame lands at @p out, interleaved whatever the
+ * layout of @p fmt, so a test reads channel c of set s at
+ * @c out[s * channels + c]. Fails the calling test on a failed open(),
+ * process() or close(), on a frame of part of a sample set, and on more
+ * samples than @p cap. A planar @p frame may not exceed
+ * ::AUDIO_FAKE_PLANAR_FRAME_MAX.
+ *
+ * @return Number of sample sets out.
+ */
+size_t audio_fake_run_to_eof(struct audio_node *node, const struct audio_stream_config *fmt,
+			     size_t frame, int32_t *out, size_t cap);
+
+/**
+ * @brief The S32 container sample a 16-bit PCM @p sample reads back as: the
+ *        sample shifted up by 16 (spec §5.3).
+ */
+static inline int32_t audio_test_s16_to_s32(int16_t sample)
+{
+	return (int32_t)((uint32_t)(int32_t)sample << 16);
+}
+
 /**
  * @brief Read @p path in full into @p buf.
  *
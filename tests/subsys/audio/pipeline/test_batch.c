@@ -0,0 +1,189 @@
+/*
+ * Batched worker passes (spec §3.1, audio_pipeline_config.batch_frames).
+ *
+ * The worker pulls up to batch_frames frames per loop pass and looks at the
+ * state only between passes. These cases count the passes a batched stream
+ * takes, check that an unbatched worker measures nothing, that end of stream
+ * and a node error still end a batch at once, and that a configuration a batch
+ * cannot apply to is refused.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define BATCH_FRAME_SAMPLES 32
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SOURCE_DEFINE(batch_source);
+AUDIO_FAKE_SINK_DEFINE(batch_sink, &batch_source);
+
+AUDIO_PIPELINE_DEFINE(batch_pipeline, BATCH_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config unbatched_config = {
+	.frame_samples = BATCH_FRAME_SAMPLES,
+};
+
+static const struct audio_pipeline_config batch_of_8_config = {
+	.frame_samples = BATCH_FRAME_SAMPLES,
+	.batch_frames = 8U,
+};
+
+static const struct audio_pipeline_config paced_batch_config = {
+	.frame_samples = BATCH_FRAME_SAMPLES,
+	.batch_frames = 8U,
+	.paced = true,
+};
+
+static const struct audio_stream_config batch_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void batch_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&batch_source_state);
+	audio_fake_sink_reset(&batch_sink_state);
+}
+
+static void batch_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&batch_pipeline);
+}
+
+/* Run @p config until the first event and return it. */
+static struct audio_pipeline_event run_until_event(const struct audio_pipeline_config *config)
+{
+	struct audio_pipeline_event event = {0};
+
+	zassert_equal(audio_pipeline_init(&batch_pipeline, config, &batch_sink), 0, "init failed");
+	zassert_equal(audio_pipeline_set_format(&batch_pipeline, &batch_format), 0);
+	zassert_equal(audio_pipeline_start(&batch_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&batch_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&batch_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+
+	return event;
+}
+
+ZTEST(audio_pipeline_batch, test_unbatched_worker_measures_nothing)
+{
+	struct audio_pipeline_worker_stats stats;
+	struct audio_pipeline_event event;
+
+	batch_source_state.frames_total = 32U;
+
+	event = run_until_event(&unbatched_config);
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF);
+	zassert_equal(atomic_get(&batch_sink_state.frames_seen), 32, "frames lost");
+
+	/* No cycle reads in the default loop, so nothing to report. */
+	zassert_equal(audio_pipeline_join(&batch_pipeline), 0);
+	zassert_equal(audio_pipeline_get_worker_stats(&batch_pipeline, &stats), 0);
+	zassert_equal(stats.frames, 0U, "%u frames counted", stats.frames);
+	zassert_equal(stats.batches, 0U, "%u passes counted", stats.batches);
+	zassert_equal(stats.overhead_cycles, 0U, "%u cycles counted", stats.overhead_cycles);
+}
+
+ZTEST(audio_pipeline_batch, test_batch_pulls_eight_frames_per_pass)
+{
+	struct audio_pipeline_worker_stats stats;
+	struct audio_pipeline_event event;
+
+	batch_source_state.frames_total = 32U;
+
+	event = run_until_event(&batch_of_8_config);
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF);
+	zassert_equal(atomic_get(&batch_sink_state.frames_seen), 32, "frames lost");
+
+	zassert_equal(audio_pipeline_join(&batch_pipeline), 0);
+	zassert_equal(audio_pipeline_get_worker_stats(&batch_pipeline, &stats), 0);
+	zassert_equal(stats.frames, 32U, "%u frames counted", stats.frames);
+	/* Four full batches, and a fifth that ends on its first pull. */
+	zassert_equal(stats.batches, 5U, "%u passes for 32 frames in batches of 8",
+		      stats.batches);
+	zassert_true(stats.overhead_ns == 0U || stats.overhead_cycles != 0U,
+		     "nanoseconds without cycles");
+}
+
+ZTEST(audio_pipeline_batch, test_error_ends_the_batch)
+{
+	struct audio_pipeline_worker_stats stats;
+	struct audio_pipeline_event event;
+
+	batch_source_state.frames_total = AUDIO_FAKE_ENDLESS;
+	batch_source_state.fail_at_frame = 3U;
+	batch_source_state.process_ret = -EIO;
+
+	event = run_until_event(&batch_of_8_config);
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_ERROR);
+	zassert_equal(event.err, -EIO);
+
+	/* No pull after the failing one, although the batch had room left. */
+	zassert_equal(atomic_get(&batch_sink_state.frames_seen), 2);
+	zassert_equal(atomic_get(&batch_source_state.close_calls), 1);
+
+	zassert_equal(audio_pipeline_join(&batch_pipeline), 0);
+	zassert_equal(audio_pipeline_get_worker_stats(&batch_pipeline, &stats), 0);
+	zassert_equal(stats.batches, 1U, "the failed batch went on (%u passes)", stats.batches);
+}
+
+ZTEST(audio_pipeline_batch, test_stop_takes_effect_at_the_next_pass)
+{
+	atomic_val_t frames;
+
+	batch_source_state.frames_total = AUDIO_FAKE_ENDLESS;
+	batch_sink_state.sleep_us = 500U;
+
+	zassert_equal(audio_pipeline_init(&batch_pipeline, &batch_of_8_config, &batch_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&batch_pipeline, &batch_format), 0);
+	zassert_equal(audio_pipeline_start(&batch_pipeline), 0);
+	zassert_equal(audio_pipeline_play(&batch_pipeline), 0);
+
+	k_msleep(10);
+	zassert_equal(audio_pipeline_stop(&batch_pipeline), 0);
+	/* At most the rest of the batch in flight, 8 frames of 0.5 ms. */
+	k_msleep(10);
+	frames = atomic_get(&batch_sink_state.frames_seen);
+
+	k_msleep(20);
+	zassert_equal(atomic_get(&batch_sink_state.frames_seen), frames,
+		      "the worker kept pulling after its batch");
+	zassert_equal(frames % 8, 0, "a stop() ended a batch mid-way (%ld frames)",
+		      (long)frames);
+}
+
+ZTEST(audio_pipeline_batch, test_batch_needs_an_unpaced_worker)
+{
+	struct audio_pipeline_worker_stats stats;
+
+	zassert_false(audio_pipeline_config_is_valid(&paced_batch_config),
+		      "a paced configuration accepted a batch");
+	zassert_equal(audio_pipeline_init(&batch_pipeline, &paced_batch_config, &batch_sink),
+		      -EINVAL);
+
+	zassert_equal(audio_pipeline_get_worker_stats(NULL, &stats), -EINVAL);
+	zassert_equal(audio_pipeline_get_worker_stats(&batch_pipeline, NULL), -EINVAL);
+}
+
+ZTEST_SUITE(audio_pipeline_batch, NULL, NULL, batch_before, batch_after, NULL);
@@ -0,0 +1,286 @@
+/*
+ * Channel matrix node (CONFIG_AUDIO_PIPELINE_NODE_CHANNEL_MATRIX).
+ *
+ * The node-level cases sit each matrix on a source that makes a given number
+ * of sample sets of a given channel count, every channel of a set a value of
+ * its own, and then ends; they drive it the way the pipeline thread does, up
+ * to the end it reports. The kernel is held to its definition, fast paths
+ * included, by the DSP suite, so the cases here are about the node's part:
+ * the frame widened in place, the frame narrowed from the node's own input in
+ * as many pulls as it takes, the identity that only passes frames on, and the
+ * checks open() and process() make.
+ *
+ * One case runs a whole pipeline, for what only a chain walk shows: the nodes
+ * above the matrix are opened with its input channel count and a frame of as
+ * many sets as the one below.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define CM_FRAME_SAMPLES 22
+#define CM_SETS		 300
+#define CM_UNITY	 AUDIO_DSP_UNITY_Q15
+/* Room for the widest output, 300 stereo sets, and for the frame that finds
+ * the end.
+ */
+#define CM_OUT_SAMPLES	 (2 * CM_SETS + 2 * CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES)
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+/* Channel c of set s is the base of c plus s, so a set out of order shows as
+ * well as a channel out of place.
+ */
+AUDIO_FAKE_SETS_SOURCE_DEFINE(cm_source);
+
+AUDIO_CHANNEL_MATRIX_NODE_DEFINE(cm_upmix, &cm_source, 1, 2, CM_UNITY, CM_UNITY);
+AUDIO_CHANNEL_MATRIX_NODE_DEFINE(cm_average, &cm_source, 2, 1, CM_UNITY / 2, CM_UNITY / 2);
+AUDIO_CHANNEL_MATRIX_NODE_DEFINE(cm_swap, &cm_source, 2, 2, 0, CM_UNITY, CM_UNITY, 0);
+AUDIO_CHANNEL_MATRIX_NODE_DEFINE(cm_identity, &cm_source, 2, 2, CM_UNITY, 0, 0, CM_UNITY);
+/* Left at a quarter less right at a half: no fast path. */
+AUDIO_CHANNEL_MATRIX_NODE_DEFINE(cm_mix, &cm_source, 2, 1, CM_UNITY / 4, -CM_UNITY / 2);
+
+static const struct audio_stream_config mono = {
+	.sample_rate_hz = 48000U,
+	.channels = 1U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config stereo = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static int32_t cm_out[CM_OUT_SAMPLES];
+
+/* Script the source for CM_SETS sets of @p in channels from @p left and
+ * @p right.
+ */
+static void script_sets(size_t in, int32_t left, int32_t right)
+{
+	audio_fake_sets_source_reset(&cm_source_state);
+	cm_source_state.base[0] = left;
+	cm_source_state.base[1] = right;
+	cm_source_state.step = 1;
+	cm_source_state.channels = in;
+	cm_source_state.sets = CM_SETS;
+}
+
+/* CM_SETS sets of @p in channels from @p left / @p right through @p node,
+ * opened at @p fmt, in frames of @p frame samples up to the end of the
+ * stream, into cm_out. Returns the sets out.
+ */
+static size_t run_sets(struct audio_node *node, const struct audio_stream_config *fmt,
+		       size_t in, int32_t left, int32_t right, size_t frame)
+{
+	size_t sets;
+
+	script_sets(in, left, right);
+	sets = audio_fake_run_to_eof(node, fmt, frame, cm_out, CM_OUT_SAMPLES);
+	zassert_equal(atomic_get(&cm_source_state.sets_done), CM_SETS, "%d sets pulled",
+		      (int)atomic_get(&cm_source_state.sets_done));
+
+	return sets;
+}
+
+ZTEST_SUITE(audio_pipeline_channel_matrix, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_pipeline_channel_matrix, test_mono_is_duplicated)
+{
+	size_t i;
+
+	zassert_equal(run_sets(&cm_upmix, &stereo, 1U, 1000, 0, CM_FRAME_SAMPLES), CM_SETS);
+	for (i = 0; i < CM_SETS; i++) {
+		zassert_equal(cm_out[2U * i], 1000 + (int32_t)i, "left %zu: %d", i,
+			      cm_out[2U * i]);
+		zassert_equal(cm_out[2U * i + 1U], 1000 + (int32_t)i, "right %zu: %d", i,
+			      cm_out[2U * i + 1U]);
+	}
+
+	/* A frame of an odd count has no room for a last half set. */
+	zassert_equal(run_sets(&cm_upmix, &stereo, 1U, 1000, 0, 7U), CM_SETS);
+}
+
+ZTEST(audio_pipeline_channel_matrix, test_stereo_is_averaged)
+{
+	size_t frames[] = {
+		CM_FRAME_SAMPLES,
+		/* More sets than the node's input holds: several pulls a
+		 * frame.
+		 */
+		2U * CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES + 3U,
+	};
+	size_t f;
+	size_t i;
+
+	for (f = 0; f < ARRAY_SIZE(frames); f++) {
+		zassert_equal(run_sets(&cm_average, &mono, 2U, INT32_MAX - CM_SETS,
+				       INT32_MAX - CM_SETS, frames[f]),
+			      CM_SETS);
+		for (i = 0; i < CM_SETS; i++) {
+			/* The mean of two full-scale values, not their
+			 * wrapped sum.
+			 */
+			zassert_equal(cm_out[i], INT32_MAX - CM_SETS + (int32_t)i,
+				      "frame %zu, set %zu: %d", frames[f], i, cm_out[i]);
+		}
+	}
+}
+
+ZTEST(audio_pipeline_channel_matrix, test_general_matrix_mixes)
+{
+	size_t i;
+
+	zassert_equal(run_sets(&cm_mix, &mono, 2U, 4000, 2000, CM_FRAME_SAMPLES), CM_SETS);
+	for (i = 0; i < CM_SETS; i++) {
+		int32_t left = 4000 + (int32_t)i;
+		int32_t right = 2000 + (int32_t)i;
+		int64_t acc = (int64_t)left * (CM_UNITY / 4) - (int64_t)right * (CM_UNITY / 2);
+
+		zassert_equal(cm_out[i], (int32_t)(acc >> 15), "set %zu: %d", i, cm_out[i]);
+	}
+}
+
+ZTEST(audio_pipeline_channel_matrix, test_same_count_keeps_the_format)
+{
+	size_t i;
+
+	zassert_equal(run_sets(&cm_swap, &stereo, 2U, 100, -100, CM_FRAME_SAMPLES), CM_SETS);
+	for (i = 0; i < CM_SETS; i++) {
+		zassert_equal(cm_out[2U * i], -100 + (int32_t)i, "left %zu: %d", i,
+			      cm_out[2U * i]);
+		zassert_equal(cm_out[2U * i + 1U], 100 + (int32_t)i, "right %zu: %d", i,
+			      cm_out[2U * i + 1U]);
+	}
+
+	/* No segment of its own, so nothing for the chain walk to install. */
+	zassert_is_null(cm_swap.upstream_format);
+
+	zassert_equal(run_sets(&cm_identity, &stereo, 2U, 100, -100, CM_FRAME_SAMPLES),
+		      CM_SETS);
+	for (i = 0; i < CM_SETS; i++) {
+		zassert_equal(cm_out[2U * i], 100 + (int32_t)i);
+		zassert_equal(cm_out[2U * i + 1U], -100 + (int32_t)i);
+	}
+	zassert_is_null(cm_identity.upstream_format);
+}
+
+ZTEST(audio_pipeline_channel_matrix, test_open_publishes_the_input_format)
+{
+	zassert_equal(run_sets(&cm_upmix, &stereo, 1U, 0, 0, CM_FRAME_SAMPLES), CM_SETS);
+	zassert_not_null(cm_upmix.upstream_format);
+	zassert_equal(cm_upmix.upstream_format->channels, 1U);
+	zassert_equal(cm_upmix.upstream_format->sample_rate_hz, stereo.sample_rate_hz);
+	zassert_equal(cm_upmix.upstream_format->format, stereo.format);
+}
+
+ZTEST(audio_pipeline_channel_matrix, test_open_checks_the_format)
+{
+	cm_upmix.pipeline_format = &mono;
+	zassert_equal(audio_node_open(&cm_upmix), -ENOTSUP,
+		      "opened for a channel count the matrix does not make");
+
+	cm_average.pipeline_format = &stereo;
+	zassert_equal(audio_node_open(&cm_average), -ENOTSUP,
+		      "opened for a channel count the matrix does not make");
+
+	cm_upmix.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&cm_upmix), -EINVAL, "opened without a format");
+}
+
+ZTEST(audio_pipeline_channel_matrix, test_process_checks_the_frame)
+{
+	int32_t buf[CM_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t out_size;
+
+	cm_upmix.pipeline_format = &stereo;
+	zassert_equal(audio_node_process(&cm_upmix, &view, &out_size), -EBADF,
+		      "process() ran on a closed channel matrix");
+
+	script_sets(1U, 0, 0);
+	zassert_equal(audio_node_open(&cm_upmix), 0);
+	view.capacity = 1U;
+	zassert_equal(audio_node_process(&cm_upmix, &view, &out_size), -EINVAL,
+		      "a frame of no whole set was filled");
+	zassert_equal(audio_node_close(&cm_upmix), 0);
+}
+
+/* source (mono) -> matrix -> sink (stereo), run by a pipeline. */
+#define CM_PIPELINE_FRAME_SAMPLES 32
+#define CM_PIPELINE_SETS	  100
+
+AUDIO_FAKE_SOURCE_DEFINE(cm_fake_source);
+AUDIO_CHANNEL_MATRIX_NODE_DEFINE(cm_chain_converter, &cm_fake_source, 1, 2, CM_UNITY, CM_UNITY);
+AUDIO_FAKE_SINK_DEFINE(cm_fake_sink, &cm_chain_converter);
+
+AUDIO_PIPELINE_DEFINE(cm_pipeline, CM_PIPELINE_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config cm_config = {
+	.frame_samples = CM_PIPELINE_FRAME_SAMPLES,
+};
+
+static const int32_t cm_samples[CM_PIPELINE_SETS];
+
+ZTEST(audio_pipeline_channel_matrix, test_upstream_is_opened_at_the_input_channels)
+{
+	const struct audio_stream_config *above;
+	const struct audio_stream_config *below;
+	struct audio_pipeline_event event;
+
+	audio_fake_source_reset(&cm_fake_source_state);
+	audio_fake_sink_reset(&cm_fake_sink_state);
+	cm_fake_source_state.samples = cm_samples;
+	cm_fake_source_state.sample_count = ARRAY_SIZE(cm_samples);
+
+	zassert_equal(audio_pipeline_init(&cm_pipeline, &cm_config, &cm_fake_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&cm_pipeline, &stereo), 0);
+	zassert_equal(audio_pipeline_start(&cm_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&cm_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&cm_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "event %d", event.type);
+	(void)audio_pipeline_join(&cm_pipeline);
+
+	/* The same format either side, but for the channel count. */
+	above = atomic_ptr_get(&cm_fake_source_state.seen_format);
+	below = atomic_ptr_get(&cm_fake_sink_state.seen_format);
+	zassert_not_null(above);
+	zassert_not_null(below);
+	zassert_equal(above->channels, 1U, "upstream opened with %u channels", above->channels);
+	zassert_equal(above->sample_rate_hz, 48000U);
+	zassert_equal(below->channels, 2U, "downstream opened with %u channels",
+		      below->channels);
+
+	/* A frame of 16 stereo sets below is 16 mono samples above. */
+	zassert_equal(cm_fake_sink.frame_capacity, CM_PIPELINE_FRAME_SAMPLES);
+	zassert_equal(cm_fake_source.frame_capacity, CM_PIPELINE_FRAME_SAMPLES / 2U,
+		      "segment frame of %zu samples", cm_fake_source.frame_capacity);
+
+	/* Every input sample was pulled, and each made a set. */
+	zassert_equal(atomic_get(&cm_fake_source_state.samples_done), ARRAY_SIZE(cm_samples));
+	zassert_equal(atomic_get(&cm_fake_sink_state.frames_seen),
+		      DIV_ROUND_UP(CM_PIPELINE_SETS * 2U, CM_PIPELINE_FRAME_SAMPLES));
+}
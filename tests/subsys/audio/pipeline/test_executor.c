@@ -0,0 +1,264 @@
+/*
+ * Shared worker pool (spec §3.4, CONFIG_AUDIO_PIPELINE_EXECUTOR).
+ *
+ * Three pooled pipelines at different frame periods share one executor thread.
+ * The cases check that every frame of every stream is pulled by the pool rather
+ * than by a thread of the pipeline's own, that one worker keeps all three on
+ * their real-time deadlines, and that registration and join() behave like the
+ * thread creation and thread join they replace.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+#include <zephyr/audio/audio_pipeline_executor.h>
+
+#include "fake_nodes.h"
+
+#define POOL_FRAME_SAMPLES 64
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_PIPELINE_EXECUTOR_DEFINE(test_executor, 1, 3, 2048, 5);
+
+/* Never initialised, to cover a start() against a pool that is not running. */
+AUDIO_PIPELINE_EXECUTOR_DEFINE(idle_executor, 1, 1, 1024, 5);
+
+AUDIO_FAKE_SOURCE_DEFINE(pool_source_a);
+AUDIO_FAKE_SINK_DEFINE(pool_sink_a, &pool_source_a);
+AUDIO_FAKE_SOURCE_DEFINE(pool_source_b);
+AUDIO_FAKE_SINK_DEFINE(pool_sink_b, &pool_source_b);
+AUDIO_FAKE_SOURCE_DEFINE(pool_source_c);
+AUDIO_FAKE_SINK_DEFINE(pool_sink_c, &pool_source_c);
+AUDIO_FAKE_SOURCE_DEFINE(pool_source_d);
+AUDIO_FAKE_SINK_DEFINE(pool_sink_d, &pool_source_d);
+
+AUDIO_PIPELINE_DEFINE_POOLED(pool_pipeline_a, POOL_FRAME_SAMPLES);
+AUDIO_PIPELINE_DEFINE_POOLED(pool_pipeline_b, POOL_FRAME_SAMPLES);
+AUDIO_PIPELINE_DEFINE_POOLED(pool_pipeline_c, POOL_FRAME_SAMPLES);
+AUDIO_PIPELINE_DEFINE_POOLED(pool_pipeline_d, POOL_FRAME_SAMPLES);
+
+static const struct audio_pipeline_config pool_config = {
+	.frame_samples = POOL_FRAME_SAMPLES,
+	.executor = &test_executor,
+};
+
+static const struct audio_pipeline_config idle_config = {
+	.frame_samples = POOL_FRAME_SAMPLES,
+	.executor = &idle_executor,
+};
+
+/* 32 stereo pairs per frame: 4 ms at 8 kHz, 2 ms at 16 kHz. */
+static const struct audio_stream_config format_8k = {
+	.sample_rate_hz = 8000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config format_16k = {
+	.sample_rate_hz = 16000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+/* 64 mono samples at 8 kHz: 8 ms. */
+static const struct audio_stream_config format_8k_mono = {
+	.sample_rate_hz = 8000U,
+	.channels = 1U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void *pool_setup(void)
+{
+	zassert_equal(audio_pipeline_executor_init(&test_executor), 0, "executor init failed");
+	zassert_equal(audio_pipeline_executor_init(&test_executor), -EALREADY,
+		      "a running pool was started twice");
+
+	return NULL;
+}
+
+static void pool_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&pool_source_a_state);
+	audio_fake_sink_reset(&pool_sink_a_state);
+	audio_fake_source_reset(&pool_source_b_state);
+	audio_fake_sink_reset(&pool_sink_b_state);
+	audio_fake_source_reset(&pool_source_c_state);
+	audio_fake_sink_reset(&pool_sink_c_state);
+	audio_fake_source_reset(&pool_source_d_state);
+	audio_fake_sink_reset(&pool_sink_d_state);
+}
+
+static void pool_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&pool_pipeline_a);
+	(void)audio_pipeline_join(&pool_pipeline_b);
+	(void)audio_pipeline_join(&pool_pipeline_c);
+	(void)audio_pipeline_join(&pool_pipeline_d);
+}
+
+static void start_pooled(struct audio_pipeline *pipeline, struct audio_node *sink,
+			 const struct audio_stream_config *fmt)
+{
+	zassert_equal(audio_pipeline_init(pipeline, &pool_config, sink), 0, "init failed");
+	zassert_equal(audio_pipeline_set_format(pipeline, fmt), 0, "set_format failed");
+	zassert_equal(audio_pipeline_start(pipeline), 0, "start failed");
+	zassert_true(audio_pipeline_is_running(pipeline),
+		     "a registered pipeline does not report a worker");
+}
+
+static void expect_eof(struct audio_pipeline *pipeline)
+{
+	struct audio_pipeline_event event;
+	int ret;
+
+	ret = audio_pipeline_get_event(pipeline, &event, TEST_EVENT_TIMEOUT);
+	zassert_equal(ret, 0, "no event before the timeout (%d)", ret);
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "expected EOF, got %d", event.type);
+}
+
+static void expect_on_time(struct audio_pipeline *pipeline, uint32_t frames)
+{
+	struct audio_pipeline_pacing_stats stats;
+
+	zassert_equal(audio_pipeline_get_pacing_stats(pipeline, &stats), 0,
+		      "a pooled pipeline is not paced");
+	zassert_equal(stats.frames, frames, "%u of %u frames dispatched", stats.frames, frames);
+	zassert_equal(stats.deadline_misses, 0U, "%u deadlines missed", stats.deadline_misses);
+}
+
+ZTEST(audio_pipeline_executor, test_one_worker_serves_three_streams)
+{
+	int64_t start;
+	int64_t elapsed;
+
+	/* Every stream lasts 80 ms at its own frame period. */
+	pool_source_a_state.frames_total = 20U;
+	pool_source_b_state.frames_total = 40U;
+	pool_source_c_state.frames_total = 10U;
+
+	start_pooled(&pool_pipeline_a, &pool_sink_a, &format_8k);
+	start_pooled(&pool_pipeline_b, &pool_sink_b, &format_16k);
+	start_pooled(&pool_pipeline_c, &pool_sink_c, &format_8k_mono);
+
+	start = k_uptime_get();
+	zassert_equal(audio_pipeline_play(&pool_pipeline_a), 0);
+	zassert_equal(audio_pipeline_play(&pool_pipeline_b), 0);
+	zassert_equal(audio_pipeline_play(&pool_pipeline_c), 0);
+
+	expect_eof(&pool_pipeline_a);
+	expect_eof(&pool_pipeline_b);
+	expect_eof(&pool_pipeline_c);
+	elapsed = k_uptime_get() - start;
+
+	zassert_true(elapsed >= 79 && elapsed <= 90,
+		     "three 80 ms streams on one worker took %lld ms", elapsed);
+
+	zassert_equal(atomic_get(&pool_sink_a_state.frames_seen), 20, "stream A lost frames");
+	zassert_equal(atomic_get(&pool_sink_b_state.frames_seen), 40, "stream B lost frames");
+	zassert_equal(atomic_get(&pool_sink_c_state.frames_seen), 10, "stream C lost frames");
+
+	expect_on_time(&pool_pipeline_a, 20U);
+	expect_on_time(&pool_pipeline_b, 40U);
+	expect_on_time(&pool_pipeline_c, 10U);
+
+	/* Every frame of every stream ran on the pool thread. */
+	zassert_equal_ptr(atomic_ptr_get(&pool_sink_a_state.worker), &test_executor_threads[0]);
+	zassert_equal_ptr(atomic_ptr_get(&pool_sink_b_state.worker), &test_executor_threads[0]);
+	zassert_equal_ptr(atomic_ptr_get(&pool_sink_c_state.worker), &test_executor_threads[0]);
+}
+
+ZTEST(audio_pipeline_executor, test_full_pool_refuses_start_before_open)
+{
+	pool_source_a_state.frames_total = AUDIO_FAKE_ENDLESS;
+
+	start_pooled(&pool_pipeline_a, &pool_sink_a, &format_8k);
+	start_pooled(&pool_pipeline_b, &pool_sink_b, &format_8k);
+	start_pooled(&pool_pipeline_c, &pool_sink_c, &format_8k);
+
+	zassert_equal(audio_pipeline_init(&pool_pipeline_d, &pool_config, &pool_sink_d), 0);
+	zassert_equal(audio_pipeline_set_format(&pool_pipeline_d, &format_8k), 0);
+	zassert_equal(audio_pipeline_start(&pool_pipeline_d), -ENOSPC,
+		      "a fourth pipeline was registered with a three-slot pool");
+	zassert_equal(atomic_get(&pool_sink_d_state.open_calls), 0,
+		      "a refused registration still opened the chain");
+	zassert_false(audio_pipeline_is_running(&pool_pipeline_d));
+
+	/* A joined pipeline frees its slot for the next one. */
+	zassert_equal(audio_pipeline_join(&pool_pipeline_c), 0);
+	zassert_equal(audio_pipeline_start(&pool_pipeline_d), 0,
+		      "the slot a join() freed was not reusable");
+}
+
+ZTEST(audio_pipeline_executor, test_join_waits_out_the_frame_in_flight)
+{
+	pool_source_a_state.frames_total = AUDIO_FAKE_ENDLESS;
+
+	start_pooled(&pool_pipeline_a, &pool_sink_a, &format_8k);
+	zassert_equal(audio_pipeline_play(&pool_pipeline_a), 0);
+
+	k_msleep(20);
+	zassert_true(atomic_get(&pool_sink_a_state.frames_seen) > 0, "nothing was dispatched");
+
+	zassert_equal(audio_pipeline_join(&pool_pipeline_a), 0, "join failed");
+	zassert_false(audio_pipeline_is_running(&pool_pipeline_a));
+	zassert_equal(atomic_get(&pool_sink_a_state.close_calls), 1,
+		      "join did not close the chain exactly once");
+
+	/* Nothing reaches the nodes of a joined pipeline any more. */
+	k_msleep(20);
+	zassert_equal(atomic_get(&pool_source_a_state.close_calls), 1);
+}
+
+ZTEST(audio_pipeline_executor, test_stopped_stream_leaves_the_pool_to_others)
+{
+	atomic_val_t frames;
+
+	pool_source_a_state.frames_total = AUDIO_FAKE_ENDLESS;
+	pool_source_b_state.frames_total = 10U;
+
+	start_pooled(&pool_pipeline_a, &pool_sink_a, &format_8k);
+	start_pooled(&pool_pipeline_b, &pool_sink_b, &format_8k);
+
+	zassert_equal(audio_pipeline_play(&pool_pipeline_a), 0);
+	k_msleep(10);
+	zassert_equal(audio_pipeline_stop(&pool_pipeline_a), 0);
+	k_msleep(10);
+	frames = atomic_get(&pool_sink_a_state.frames_seen);
+
+	zassert_equal(audio_pipeline_play(&pool_pipeline_b), 0);
+	expect_eof(&pool_pipeline_b);
+	expect_on_time(&pool_pipeline_b, 10U);
+
+	zassert_equal(atomic_get(&pool_sink_a_state.frames_seen), frames,
+		      "a stopped pipeline was still dispatched");
+}
+
+ZTEST(audio_pipeline_executor, test_pool_must_be_running)
+{
+	zassert_equal(audio_pipeline_init(&pool_pipeline_a, &idle_config, &pool_sink_a), 0);
+	zassert_equal(audio_pipeline_set_format(&pool_pipeline_a, &format_8k), 0);
+	zassert_equal(audio_pipeline_start(&pool_pipeline_a), -EINVAL,
+		      "a pipeline was registered with a pool nobody started");
+	zassert_equal(atomic_get(&pool_sink_a_state.open_calls), 0);
+}
+
+ZTEST_SUITE(audio_pipeline_executor, NULL, pool_setup, pool_before, pool_after, NULL);
@@ -0,0 +1,427 @@
+/*
+ * File reader and writer at every sample layout they convert (spec §5.3,
+ * §10.1/§10.2): 8 bit unsigned, 16, packed 24 and 32 bit PCM and 32 bit IEEE
+ * float, widened and narrowed against a reference worked out here byte by
+ * byte, a 24 bit capture round tripped through both nodes, and packed 24 bit
+ * samples that straddle the blocks of a writer that writes behind.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+#include <zephyr/fs/fs.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_wav.h>
+
+#include "fake_nodes.h"
+#include "wav_fixture.h"
+
+/* Whole sets of two and of eight channels, and no divisor of a sector at any layout. */
+#define DEPTH_FRAME_SAMPLES 40
+
+/* Three sectors and a bit of packed 24 bit stereo, so samples straddle blocks. */
+#define DEPTH_LONG_SAMPLES 1000U
+
+AUDIO_FILE_READER_NODE_DEFINE(depth_reader, AUDIO_TEST_PATH("d_in.wav"));
+
+AUDIO_FAKE_SOURCE_DEFINE(depth_source);
+AUDIO_FILE_WRITER_NODE_DEFINE(depth_out, &depth_source, AUDIO_TEST_PATH("d_out.wav"));
+
+AUDIO_FAKE_SOURCE_DEFINE(behind_source);
+/* One sector per block: every block boundary lands mid sample at 24 bit. */
+AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(depth_behind, &behind_source,
+					   AUDIO_TEST_PATH("d_behind.wav"),
+					   AUDIO_FILE_SECTOR_BYTES, 2);
+
+/*
+ * Containers with dirt below every depth, both signed extremes and values on
+ * either side of a byte boundary: where narrowing rounds instead of truncating,
+ * or a packed sample picks up its neighbour's byte, these show it.
+ */
+static const int32_t pcm_containers[] = {
+	0,          -1,          1,          INT32_MAX,   INT32_MIN,   0x12345678,
+	-0x12345678, 0x00ff8001, -256,        0x7fffff00,  (int32_t)0x80000100, 0x00800000,
+};
+
+/*
+ * Float samples whose container is exact in both directions, as IEEE 754 bit
+ * patterns so the suite needs no floating point: 1.0 is where INT32_MAX
+ * rounds to and saturates back from, and 2^-31 is one LSB.
+ */
+static const struct {
+	uint32_t bits;
+	int32_t container;
+} float_pairs[] = {
+	{0x00000000U, 0},         {0x3f000000U, 0x40000000}, {0xbf000000U, -0x40000000},
+	{0xbf800000U, INT32_MIN}, {0x3f800000U, INT32_MAX},  {0x3e800000U, 0x20000000},
+	{0x30000000U, 1},         {0xb0000000U, -1},
+};
+
+static int32_t long_samples[DEPTH_LONG_SAMPLES];
+static uint8_t file_buf[AUDIO_WAV_MAX_HEADER_SIZE + DEPTH_LONG_SAMPLES * 4U + 64];
+static uint8_t other_buf[sizeof(file_buf)];
+
+static struct audio_stream_config depth_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+/* The top @p bits of @p v as a WAVE payload stores them, little endian. */
+static void encode_pcm(uint16_t bits, int32_t v, uint8_t *dst)
+{
+	uint32_t u = (uint32_t)v;
+
+	switch (bits) {
+	case 8U:
+		/* Unsigned: the offset binary of the top byte. */
+		dst[0] = (uint8_t)((u >> 24) ^ 0x80U);
+		break;
+	case 16U:
+		sys_put_le16((uint16_t)(u >> 16), dst);
+		break;
+	case 24U:
+		sys_put_le24(u >> 8, dst);
+		break;
+	default:
+		sys_put_le32(u, dst);
+		break;
+	}
+}
+
+/* The container a reader gives back for @p v stored at @p bits. */
+static int32_t kept_bits(uint16_t bits, int32_t v)
+{
+	return bits >= 32U ? v : (int32_t)((uint32_t)v & ~(UINT32_MAX >> bits));
+}
+
+static void depth_before(void *fixture)
+{
+	size_t i;
+
+	ARG_UNUSED(fixture);
+
+	zassert_equal(audio_test_fs_mount(), 0, "fixture filesystem did not mount");
+
+	for (i = 0; i < ARRAY_SIZE(long_samples); i++) {
+		long_samples[i] = (int32_t)(i * 0x01234567U);
+	}
+
+	audio_fake_source_reset(&depth_source_state);
+	audio_fake_source_reset(&behind_source_state);
+	depth_out.pipeline_format = &depth_format;
+	depth_behind.pipeline_format = &depth_format;
+	depth_format.valid_bits_per_sample = 16U;
+
+	zassert_equal(audio_file_writer_set_float(&depth_out, false), 0, "setter failed");
+	zassert_equal(audio_file_writer_set_float(&depth_behind, false), 0, "setter failed");
+}
+
+/*
+ * Read the whole of depth_reader's file in frames of DEPTH_FRAME_SAMPLES into
+ * @p out, returning the samples read.
+ */
+static size_t read_to_eof(int32_t *out, size_t cap)
+{
+	int32_t buf[DEPTH_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t total = 0;
+	size_t produced;
+
+	zassert_equal(audio_node_open(&depth_reader), 0, "open failed");
+	do {
+		zassert_equal(audio_node_process(&depth_reader, &view, &produced), 0,
+			      "process failed");
+		zassert_true(total + produced <= cap, "read more than the file holds");
+		memcpy(&out[total], buf, produced * sizeof(int32_t));
+		total += produced;
+	} while (produced != 0U);
+	zassert_equal(audio_node_close(&depth_reader), 0, "close failed");
+
+	return total;
+}
+
+/* Push @p count samples through @p writer to EOF and read the file back. */
+static size_t write_to_eof(struct audio_node *writer, struct audio_fake_source *src,
+			   const int32_t *samples, size_t count, const char *path, uint8_t *file)
+{
+	int32_t buf[DEPTH_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t produced;
+
+	src->samples = samples;
+	src->sample_count = count;
+	audio_fake_source_rewind(src);
+
+	zassert_equal(audio_node_open(writer), 0, "open failed");
+	do {
+		zassert_equal(audio_node_process(writer, &view, &produced), 0, "process failed");
+	} while (produced != 0U);
+	zassert_equal(audio_node_close(writer), 0, "close failed");
+
+	return audio_test_read_file(path, file, sizeof(file_buf));
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_reader_widens_every_layout)
+{
+	static const uint16_t depths[] = {8U, 16U, 24U, 32U};
+	struct audio_file_reader_state *state = depth_reader.state;
+	uint8_t payload[ARRAY_SIZE(pcm_containers) * 4U];
+	int32_t got[ARRAY_SIZE(pcm_containers)];
+	size_t d;
+	size_t i;
+
+	for (d = 0; d < ARRAY_SIZE(depths); d++) {
+		const size_t bytes = depths[d] / 8U;
+		struct audio_test_wav_spec spec = {
+			.bits_per_sample = depths[d],
+			.payload = payload,
+			.payload_len = ARRAY_SIZE(pcm_containers) * bytes,
+		};
+
+		for (i = 0; i < ARRAY_SIZE(pcm_containers); i++) {
+			encode_pcm(depths[d], pcm_containers[i], &payload[i * bytes]);
+		}
+		zassert_equal(audio_test_write_wav(AUDIO_TEST_PATH("d_in.wav"), &spec), 0,
+			      "could not write the fixture");
+
+		/* The resolution it reports is the file's. */
+		zassert_equal(audio_node_open(&depth_reader), 0, "open failed");
+		zassert_equal(state->fmt.valid_bits_per_sample, depths[d], "%u bit: reports %u",
+			      depths[d], state->fmt.valid_bits_per_sample);
+		zassert_equal(audio_node_close(&depth_reader), 0, "close failed");
+
+		zassert_equal(read_to_eof(got, ARRAY_SIZE(got)), ARRAY_SIZE(pcm_containers),
+			      "%u bit: wrong sample count", depths[d]);
+		for (i = 0; i < ARRAY_SIZE(pcm_containers); i++) {
+			zassert_equal(got[i], kept_bits(depths[d], pcm_containers[i]),
+				      "%u bit: sample %zu is 0x%08x", depths[d], i,
+				      (uint32_t)got[i]);
+		}
+	}
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_reader_widens_float)
+{
+	struct audio_file_reader_state *state = depth_reader.state;
+	uint8_t payload[ARRAY_SIZE(float_pairs) * 4U];
+	int32_t got[ARRAY_SIZE(float_pairs)];
+	struct audio_test_wav_spec spec = {
+		.format_tag = AUDIO_WAV_FORMAT_IEEE_FLOAT,
+		.bits_per_sample = 32U,
+		.payload = payload,
+		.payload_len = sizeof(payload),
+	};
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(float_pairs); i++) {
+		sys_put_le32(float_pairs[i].bits, &payload[i * 4U]);
+	}
+	zassert_equal(audio_test_write_wav(AUDIO_TEST_PATH("d_in.wav"), &spec), 0,
+		      "could not write the fixture");
+
+	zassert_equal(read_to_eof(got, ARRAY_SIZE(got)), ARRAY_SIZE(float_pairs),
+		      "wrong sample count");
+	for (i = 0; i < ARRAY_SIZE(float_pairs); i++) {
+		zassert_equal(got[i], float_pairs[i].container, "float 0x%08x read as 0x%08x",
+			      float_pairs[i].bits, (uint32_t)got[i]);
+	}
+
+	zassert_equal(audio_node_open(&depth_reader), 0, "open failed");
+	zassert_equal(state->fmt.valid_bits_per_sample, 32U, "wrong depth");
+	zassert_equal(audio_node_close(&depth_reader), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_writer_narrows_every_layout)
+{
+	static const uint16_t depths[] = {8U, 16U, 24U, 32U};
+	uint8_t expected[4];
+	struct audio_wav_header wav;
+	size_t len;
+	size_t d;
+	size_t i;
+
+	for (d = 0; d < ARRAY_SIZE(depths); d++) {
+		const size_t bytes = depths[d] / 8U;
+
+		depth_format.valid_bits_per_sample = (uint8_t)depths[d];
+		len = write_to_eof(&depth_out, &depth_source_state, pcm_containers,
+				   ARRAY_SIZE(pcm_containers), AUDIO_TEST_PATH("d_out.wav"),
+				   file_buf);
+
+		zassert_equal(audio_wav_read_header(file_buf, len, &wav), 0,
+			      "%u bit: header rejected", depths[d]);
+		zassert_equal(wav.format_tag, AUDIO_WAV_FORMAT_PCM, "%u bit: not PCM", depths[d]);
+		zassert_equal(wav.bits_per_sample, depths[d], "%u bit: header says %u",
+			      depths[d], wav.bits_per_sample);
+		zassert_equal(wav.data_size, ARRAY_SIZE(pcm_containers) * bytes,
+			      "%u bit: data chunk claims %u bytes", depths[d], wav.data_size);
+		zassert_equal(len, wav.data_offset + wav.data_size, "%u bit: file is %zu bytes",
+			      depths[d], len);
+
+		for (i = 0; i < ARRAY_SIZE(pcm_containers); i++) {
+			encode_pcm(depths[d], pcm_containers[i], expected);
+			zassert_mem_equal(&file_buf[wav.data_offset + i * bytes], expected, bytes,
+					  "%u bit: sample %zu is wrong", depths[d], i);
+		}
+	}
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_writer_writes_float_when_asked)
+{
+	int32_t containers[ARRAY_SIZE(float_pairs)];
+	struct audio_wav_header wav;
+	size_t len;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(float_pairs); i++) {
+		containers[i] = float_pairs[i].container;
+	}
+
+	/* Any bound depth: float holds all of them. */
+	depth_format.valid_bits_per_sample = 20U;
+	zassert_equal(audio_file_writer_set_float(&depth_out, true), 0, "setter failed");
+
+	len = write_to_eof(&depth_out, &depth_source_state, containers, ARRAY_SIZE(containers),
+			   AUDIO_TEST_PATH("d_out.wav"), file_buf);
+	zassert_equal(audio_wav_read_header(file_buf, len, &wav), 0, "header rejected");
+	zassert_equal(wav.format_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "not IEEE float");
+	zassert_equal(wav.bits_per_sample, 32U, "header says %u bit", wav.bits_per_sample);
+	zassert_equal(wav.data_size, sizeof(containers), "data chunk claims %u bytes",
+		      wav.data_size);
+
+	for (i = 0; i < ARRAY_SIZE(float_pairs); i++) {
+		zassert_equal(sys_get_le32(&file_buf[wav.data_offset + i * 4U]),
+			      float_pairs[i].bits, "0x%08x written as 0x%08x",
+			      (uint32_t)containers[i],
+			      sys_get_le32(&file_buf[wav.data_offset + i * 4U]));
+	}
+
+	/* The same file from the reader: the pairs are exact both ways. */
+	memcpy(other_buf, file_buf, len);
+	zassert_equal(audio_test_write_raw(AUDIO_TEST_PATH("d_in.wav"), other_buf, len), 0,
+		      "could not copy the file");
+	zassert_equal(read_to_eof(containers, ARRAY_SIZE(containers)), ARRAY_SIZE(float_pairs),
+		      "wrong sample count");
+	for (i = 0; i < ARRAY_SIZE(float_pairs); i++) {
+		zassert_equal(containers[i], float_pairs[i].container, "sample %zu changed", i);
+	}
+
+	/* More than two channels: float goes into the extensible GUID. */
+	depth_format.channels = 8U;
+	len = write_to_eof(&depth_out, &depth_source_state, long_samples, 64U,
+			   AUDIO_TEST_PATH("d_out.wav"), file_buf);
+	depth_format.channels = 2U;
+	zassert_equal(audio_wav_read_header(file_buf, len, &wav), 0, "header rejected");
+	zassert_equal(wav.format_tag, AUDIO_WAV_FORMAT_EXTENSIBLE, "not extensible");
+	zassert_equal(wav.subformat_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "not IEEE float");
+	zassert_equal(wav.data_size, 64U * 4U, "data chunk claims %u bytes", wav.data_size);
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_float_choice_applies_from_the_next_file)
+{
+	struct audio_file_writer_state *state = depth_out.state;
+	struct audio_wav_header wav;
+	size_t len;
+
+	depth_source_state.samples = long_samples;
+	depth_source_state.sample_count = 64U;
+	audio_fake_source_rewind(&depth_source_state);
+
+	/* Changed mid-file, it leaves the file being written alone. */
+	zassert_equal(audio_node_open(&depth_out), 0, "open failed");
+	zassert_equal(audio_file_writer_set_float(&depth_out, true), 0, "setter failed");
+	zassert_equal(audio_node_close(&depth_out), 0, "close failed");
+
+	len = audio_test_read_file(AUDIO_TEST_PATH("d_out.wav"), file_buf, sizeof(file_buf));
+	zassert_equal(audio_wav_read_header(file_buf, len, &wav), 0, "header rejected");
+	zassert_equal(wav.format_tag, AUDIO_WAV_FORMAT_PCM, "the open file turned float");
+	zassert_equal(wav.bits_per_sample, 16U, "the open file changed depth");
+
+	/* And outlives close(), into the next one. */
+	zassert_true(state->ieee_float, "close() reset the choice");
+	len = write_to_eof(&depth_out, &depth_source_state, long_samples, 64U,
+			   AUDIO_TEST_PATH("d_out.wav"), file_buf);
+	zassert_equal(audio_wav_read_header(file_buf, len, &wav), 0, "header rejected");
+	zassert_equal(wav.format_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "the next file is not float");
+
+	zassert_equal(audio_file_writer_set_float(NULL, true), -EINVAL, "NULL node accepted");
+	zassert_equal(audio_file_writer_set_float(&depth_reader, true), -EINVAL,
+		      "a reader has no output format");
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_24_bit_round_trips_through_both_nodes)
+{
+	static int32_t got[DEPTH_LONG_SAMPLES];
+	size_t len;
+	size_t i;
+
+	depth_format.valid_bits_per_sample = 24U;
+	len = write_to_eof(&depth_out, &depth_source_state, long_samples, DEPTH_LONG_SAMPLES,
+			   AUDIO_TEST_PATH("d_out.wav"), file_buf);
+	zassert_equal(len, AUDIO_WAV_MIN_HEADER_SIZE + DEPTH_LONG_SAMPLES * 3U,
+		      "file is %zu bytes", len);
+
+	zassert_equal(audio_test_write_raw(AUDIO_TEST_PATH("d_in.wav"), file_buf, len), 0,
+		      "could not copy the file");
+	zassert_equal(read_to_eof(got, ARRAY_SIZE(got)), DEPTH_LONG_SAMPLES,
+		      "wrong sample count");
+	for (i = 0; i < DEPTH_LONG_SAMPLES; i++) {
+		zassert_equal(got[i], kept_bits(24U, long_samples[i]), "sample %zu is 0x%08x", i,
+			      (uint32_t)got[i]);
+	}
+}
+
+ZTEST(audio_pipeline_file_pcm_depths, test_write_behind_splits_24_bit_samples)
+{
+	struct audio_file_writer_stats stats;
+	size_t plain_len;
+	size_t behind_len;
+
+	/* 512 is not a multiple of 3: from the second block on, a sample
+	 * straddles every boundary, and the file must still be the plain
+	 * writer's byte for byte.
+	 */
+	depth_format.valid_bits_per_sample = 24U;
+	plain_len = write_to_eof(&depth_out, &depth_source_state, long_samples,
+				 DEPTH_LONG_SAMPLES, AUDIO_TEST_PATH("d_out.wav"), file_buf);
+	behind_len = write_to_eof(&depth_behind, &behind_source_state, long_samples,
+				  DEPTH_LONG_SAMPLES, AUDIO_TEST_PATH("d_behind.wav"), other_buf);
+
+	zassert_equal(behind_len, plain_len, "%zu bytes written behind, %zu plain", behind_len,
+		      plain_len);
+	zassert_mem_equal(other_buf, file_buf, plain_len, "the files differ");
+
+	zassert_equal(audio_file_writer_get_stats(&depth_behind, &stats), 0, "stats failed");
+	zassert_equal(stats.writes, DIV_ROUND_UP(plain_len, AUDIO_FILE_SECTOR_BYTES),
+		      "%u writes", stats.writes);
+
+	/* Float through the ring as well: four bytes never straddle. */
+	zassert_equal(audio_file_writer_set_float(&depth_out, true), 0, "setter failed");
+	zassert_equal(audio_file_writer_set_float(&depth_behind, true), 0, "setter failed");
+	plain_len = write_to_eof(&depth_out, &depth_source_state, long_samples,
+				 DEPTH_LONG_SAMPLES, AUDIO_TEST_PATH("d_out.wav"), file_buf);
+	behind_len = write_to_eof(&depth_behind, &behind_source_state, long_samples,
+				  DEPTH_LONG_SAMPLES, AUDIO_TEST_PATH("d_behind.wav"), other_buf);
+	zassert_equal(behind_len, plain_len, "%zu bytes written behind, %zu plain", behind_len,
+		      plain_len);
+	zassert_mem_equal(other_buf, file_buf, plain_len, "the float files differ");
+}
+
+ZTEST_SUITE(audio_pipeline_file_pcm_depths, NULL, NULL, depth_before, NULL, NULL);
@@ -21,7 +21,9 @@
 #include <zephyr/audio/audio_nodes.h>
 #include <zephyr/audio/audio_pipeline.h>
 #include <zephyr/audio/audio_pipeline_events.h>
+#include <zephyr/audio/audio_wav.h>
 
+#include "fake_nodes.h"
 #include "wav_fixture.h"
 
 /* One node per fixture file, all defined through the public macro so the test
@@ -31,7 +33,7 @@ AUDIO_FILE_READER_NODE_DEFINE(pcm_reader, AUDIO_TEST_PATH("pcm.wav"));
 AUDIO_FILE_READER_NODE_DEFINE(missing_reader, AUDIO_TEST_PATH("nope.wav"));
 AUDIO_FILE_READER_NODE_DEFINE(garbage_reader, AUDIO_TEST_PATH("garbage.wav"));
 AUDIO_FILE_READER_NODE_DEFINE(adpcm_reader, AUDIO_TEST_PATH("adpcm.wav"));
-AUDIO_FILE_READER_NODE_DEFINE(eight_bit_reader, AUDIO_TEST_PATH("u8.wav"));
+AUDIO_FILE_READER_NODE_DEFINE(double_reader, AUDIO_TEST_PATH("f64.wav"));
 AUDIO_FILE_READER_NODE_DEFINE(lying_reader, AUDIO_TEST_PATH("lying.wav"));
 AUDIO_FILE_READER_NODE_DEFINE(long_reader, AUDIO_TEST_PATH("long.wav"));
 AUDIO_FILE_READER_NODE_DEFINE(chain_reader, AUDIO_TEST_PATH("chain.wav"));
@@ -76,12 +78,6 @@ static const int16_t known_samples[] = {
 	0, -1, 1, 32767, -32768, 0x1234, -0x1234, -256, 255, 0x7ffe, -0x7fff, 4,
 };
 
-/* spec §5.3: the container value is the 16 bit sample shifted up by 16. */
-static int32_t expected_s32(int16_t sample)
-{
-	return (int32_t)((uint32_t)(int32_t)sample << 16);
-}
-
 static void reader_before(void *fixture)
 {
 	ARG_UNUSED(fixture);
@@ -133,18 +129,31 @@ ZTEST(audio_pipeline_file_reader, test_source_rejects_non_pcm)
 
 ZTEST(audio_pipeline_file_reader, test_source_rejects_unsupported_depth)
 {
-	static const uint8_t payload[8] = {0};
-	struct audio_test_wav_spec spec = {
-		.bits_per_sample = 8U,
-		.payload = payload,
-		.payload_len = sizeof(payload),
+	/* Every PCM depth the WAV module parses is read (spec §10.1), so the
+	 * one left to refuse is double precision float - which the WAV module
+	 * will not serialise either, so the header is a 32 bit float one
+	 * widened by hand.
+	 */
+	const struct audio_wav_header hdr = {
+		.sample_rate_hz = 48000U,
+		.data_size = 16U,
+		.format_tag = AUDIO_WAV_FORMAT_IEEE_FLOAT,
+		.channels = 1U,
+		.bits_per_sample = 32U,
 	};
+	uint8_t file[AUDIO_WAV_MIN_HEADER_SIZE + 16U] = {0};
 
-	zassert_equal(audio_test_write_wav(AUDIO_TEST_PATH("u8.wav"), &spec), 0,
+	zassert_equal(audio_wav_write_header(file, sizeof(file), &hdr), 0,
+		      "the WAV module refused the test header");
+	sys_put_le32(48000U * 8U, &file[28]); /* byte rate */
+	sys_put_le16(8U, &file[32]);          /* block align */
+	sys_put_le16(64U, &file[34]);         /* bits per sample */
+
+	zassert_equal(audio_test_write_raw(AUDIO_TEST_PATH("f64.wav"), file, sizeof(file)), 0,
 		      "could not write the fixture");
 
-	zassert_equal(audio_node_open(&eight_bit_reader), -ENOTSUP,
-		      "v1 converts 16 bit PCM only");
+	zassert_equal(audio_node_open(&double_reader), -ENOTSUP,
+		      "64 bit float must be rejected with -ENOTSUP");
 }
 
 ZTEST(audio_pipeline_file_reader, test_source_publishes_parsed_format)
@@ -170,6 +179,51 @@ ZTEST(audio_pipeline_file_reader, test_source_publishes_parsed_format)
 	zassert_equal(audio_node_close(&pcm_reader), 0, "close failed");
 }
 
+ZTEST(audio_pipeline_file_reader, test_source_reads_an_extensible_multichannel_file)
+{
+	/* Two sample sets of eight channels, each sample naming its slot, in
+	 * the layout writers use past stereo.
+	 */
+	static const int16_t octo_samples[] = {
+		0x0100, 0x0101, 0x0102, 0x0103, 0x0104, 0x0105, 0x0106, 0x0107,
+		-0x0200, -0x0201, -0x0202, -0x0203, -0x0204, -0x0205, -0x0206, -0x0207,
+	};
+	struct audio_file_reader_state *state = pcm_reader.state;
+	struct audio_test_wav_spec spec = {
+		.format_tag = AUDIO_WAV_FORMAT_EXTENSIBLE,
+		.channels = 8U,
+		.payload = octo_samples,
+		.payload_len = sizeof(octo_samples),
+	};
+	int32_t buf[ARRAY_SIZE(octo_samples)];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t produced = 0;
+	size_t i;
+
+	zassert_equal(audio_test_write_wav(AUDIO_TEST_PATH("pcm.wav"), &spec), 0,
+		      "could not write the fixture");
+	zassert_equal(audio_node_open(&pcm_reader), 0, "an extensible PCM file was refused");
+
+	zassert_equal(state->fmt.channels, 8U, "channel count not taken from the header");
+	zassert_equal(state->fmt.valid_bits_per_sample, 16U, "valid_bits_per_sample is wrong");
+
+	zassert_equal(audio_node_process(&pcm_reader, &view, &produced), 0, "process failed");
+	zassert_equal(produced, ARRAY_SIZE(octo_samples), "wrong sample count");
+
+	/* The payload starts at byte 68, not 44: a reader that assumed the
+	 * canonical header would be reading the "data" chunk header as audio.
+	 */
+	for (i = 0; i < ARRAY_SIZE(octo_samples); i++) {
+		zassert_equal(buf[i], audio_test_s16_to_s32(octo_samples[i]),
+			      "sample %zu left its slot", i);
+	}
+
+	zassert_equal(audio_node_close(&pcm_reader), 0, "close failed");
+}
+
 /* -------------------------------------------------------------------------
  * open(): the file must match the format the pipeline bound (spec §5.2/§10.1)
  * ----------------------------------------------------------------------
@@ -217,9 +271,9 @@ ZTEST(audio_pipeline_file_reader, test_source_rejects_a_rate_the_pipeline_did_no
 	zassert_equal(audio_test_write_wav(AUDIO_TEST_PATH("rate.wav"), &spec), 0,
 		      "could not write the fixture");
 
-	/* v1 has no resampler (spec §1.3), so the reader can only refuse: playing
-	 * a 44.1 kHz track out of a 48 kHz pipeline is the silent mislabelling
-	 * the bound format exists to prevent.
+	/* With no resampler below it the reader can only refuse: playing a
+	 * 44.1 kHz track out of a 48 kHz pipeline is the silent mislabelling the
+	 * bound format exists to prevent.
 	 */
 	assert_start_refuses(&rate_sink, -ENOTSUP);
 
@@ -231,7 +285,7 @@ ZTEST(audio_pipeline_file_reader, test_source_rejects_a_channel_count_the_pipeli
 {
 	struct audio_test_wav_spec spec = {
 		/* Mono, while the pipeline below is bound to stereo. Both counts
-		 * are inside the reader's own 1..2 range, so only the comparison
+		 * are inside the reader's own range, so only the comparison
 		 * against the bound format can catch this.
 		 */
 		.channels = 1U,
@@ -274,9 +328,10 @@ ZTEST(audio_pipeline_file_reader, test_source_converts_s16_to_s32)
 	zassert_equal(produced, ARRAY_SIZE(known_samples), "wrong sample count");
 
 	for (i = 0; i < ARRAY_SIZE(known_samples); i++) {
-		zassert_equal(buf[i], expected_s32(known_samples[i]),
+		zassert_equal(buf[i], audio_test_s16_to_s32(known_samples[i]),
 			      "sample %zu: %d -> 0x%08x, expected 0x%08x", i, known_samples[i],
-			      (unsigned int)buf[i], (unsigned int)expected_s32(known_samples[i]));
+			      (unsigned int)buf[i],
+			      (unsigned int)audio_test_s16_to_s32(known_samples[i]));
 	}
 
 	/* Beyond out_size the reader must not have touched the buffer. */
@@ -337,13 +392,14 @@ ZTEST(audio_pipeline_file_reader, test_source_delivers_partial_final_frame)
 	zassert_equal(audio_node_process(&long_reader, &view, &produced), 0, "process failed");
 	zassert_equal(produced, ARRAY_SIZE(buf), "first frame must be full");
 	for (i = 0; i < produced; i++) {
-		zassert_equal(buf[i], expected_s32(known_samples[i]), "frame 0 sample %zu", i);
+		zassert_equal(buf[i], audio_test_s16_to_s32(known_samples[i]),
+			      "frame 0 sample %zu", i);
 	}
 
 	zassert_equal(audio_node_process(&long_reader, &view, &produced), 0, "process failed");
 	zassert_equal(produced, total - ARRAY_SIZE(buf), "partial final frame is wrong");
 	for (i = 0; i < produced; i++) {
-		zassert_equal(buf[i], expected_s32(known_samples[ARRAY_SIZE(buf) + i]),
+		zassert_equal(buf[i], audio_test_s16_to_s32(known_samples[ARRAY_SIZE(buf) + i]),
 			      "frame 1 sample %zu", i);
 	}
 
@@ -458,7 +514,7 @@ ZTEST(audio_pipeline_file_reader, test_source_close_releases_handle_and_allows_r
 			      "process failed in round %u", i);
 		zassert_equal(produced, ARRAY_SIZE(buf), "round %u produced %zu samples", i,
 			      produced);
-		zassert_equal(buf[0], expected_s32(known_samples[0]),
+		zassert_equal(buf[0], audio_test_s16_to_s32(known_samples[0]),
 			      "round %u did not restart at the first sample", i);
 
 		zassert_equal(audio_node_close(&pcm_reader), 0, "close failed in round %u", i);
@@ -0,0 +1,226 @@
+/*
+ * Reading-ahead file reader (spec §10.1.1): the same samples as the plain
+ * reader out of a ring an I/O thread fills, across block boundaries, from a
+ * payload that does not start on a sector, up to the same EOF - and the stats
+ * that say how the ring kept up.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_wav.h>
+
+#include "fake_nodes.h"
+#include "wav_fixture.h"
+
+/* The smallest ring there is: two blocks of one sector, so a file of a few
+ * sectors keeps the I/O thread busy for the whole run.
+ */
+AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(small_ahead, AUDIO_TEST_PATH("ahead.wav"),
+					 AUDIO_FILE_SECTOR_BYTES, 2);
+/* A ring that holds every fixture whole: open() reads it all. */
+AUDIO_FILE_READER_READ_AHEAD_NODE_DEFINE(large_ahead, AUDIO_TEST_PATH("ahead.wav"),
+					 4 * AUDIO_FILE_SECTOR_BYTES, 4);
+AUDIO_FILE_READER_NODE_DEFINE(plain_reader, AUDIO_TEST_PATH("ahead.wav"));
+AUDIO_GAIN_FILTER_NODE_DEFINE(ahead_gain, &plain_reader, AUDIO_GAIN_UNITY_Q15);
+
+/* Three sectors of file with its header, as large as the fixture writes. */
+#define AHEAD_SAMPLES 500
+
+/* Not a divisor of anything above, so frames straddle blocks. */
+#define AHEAD_FRAME_SAMPLES 38
+
+static int16_t ahead_payload[AHEAD_SAMPLES];
+static uint8_t ahead_bytes[AHEAD_SAMPLES * sizeof(int16_t)];
+
+static void ahead_before(void *fixture)
+{
+	size_t i;
+
+	ARG_UNUSED(fixture);
+
+	zassert_equal(audio_test_fs_mount(), 0, "fixture filesystem did not mount");
+
+	for (i = 0; i < ARRAY_SIZE(ahead_payload); i++) {
+		ahead_payload[i] = (int16_t)(i * 241U) - 30000;
+		sys_put_le16((uint16_t)ahead_payload[i], &ahead_bytes[i * sizeof(int16_t)]);
+	}
+}
+
+/* The first @p samples of ahead_payload under a header the fixture writes. */
+static void write_ahead_fixture(uint16_t format_tag, size_t samples, uint32_t declared)
+{
+	struct audio_test_wav_spec spec = {
+		.format_tag = format_tag,
+		.declared_data_size = declared,
+		.payload = ahead_bytes,
+		.payload_len = samples * sizeof(int16_t),
+	};
+
+	zassert_equal(audio_test_write_wav(AUDIO_TEST_PATH("ahead.wav"), &spec), 0,
+		      "could not write the fixture");
+}
+
+/* Pull @p node to EOF in frames of @p capacity samples, checking every sample
+ * against the first @p count of ahead_payload.
+ */
+static void assert_reads_payload(struct audio_node *node, size_t capacity, size_t count)
+{
+	int32_t buf[AHEAD_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = capacity,
+	};
+	size_t produced;
+	size_t total = 0;
+	size_t i;
+
+	zassert_true(capacity <= ARRAY_SIZE(buf), "frame larger than the test buffer");
+
+	do {
+		zassert_equal(audio_node_process(node, &view, &produced), 0,
+			      "process failed after %zu samples", total);
+		zassert_true(total + produced <= count, "read past the payload");
+		for (i = 0; i < produced; i++) {
+			zassert_equal(buf[i], audio_test_s16_to_s32(ahead_payload[total + i]),
+				      "sample %zu is wrong", total + i);
+		}
+		total += produced;
+	} while (produced != 0U);
+
+	zassert_equal(total, count, "%zu samples read, %zu expected", total, count);
+
+	/* And it stays at EOF. */
+	zassert_equal(audio_node_process(node, &view, &produced), 0, "EOF must return 0");
+	zassert_equal(produced, 0U, "reader restarted after EOF");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_matches_the_plain_reader)
+{
+	write_ahead_fixture(0U, AHEAD_SAMPLES, 0U);
+
+	zassert_equal(audio_node_open(&plain_reader), 0, "open failed");
+	assert_reads_payload(&plain_reader, AHEAD_FRAME_SAMPLES, AHEAD_SAMPLES);
+	zassert_equal(audio_node_close(&plain_reader), 0, "close failed");
+
+	/* Every block boundary falls inside a frame, and the first block starts
+	 * 44 bytes before the payload does.
+	 */
+	zassert_equal(audio_node_open(&small_ahead), 0, "open failed");
+	assert_reads_payload(&small_ahead, AHEAD_FRAME_SAMPLES, AHEAD_SAMPLES);
+	zassert_equal(audio_node_close(&small_ahead), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_skips_an_extensible_header)
+{
+	/* The payload starts at byte 68 this time. */
+	write_ahead_fixture(AUDIO_WAV_FORMAT_EXTENSIBLE, AHEAD_SAMPLES, 0U);
+
+	zassert_equal(audio_node_open(&small_ahead), 0, "open failed");
+	assert_reads_payload(&small_ahead, AHEAD_FRAME_SAMPLES, AHEAD_SAMPLES);
+	zassert_equal(audio_node_close(&small_ahead), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_drops_a_partial_final_set)
+{
+	/* Stereo, and one sample short of a whole last set. */
+	write_ahead_fixture(0U, 11U, 0U);
+
+	zassert_equal(audio_node_open(&large_ahead), 0, "open failed");
+	assert_reads_payload(&large_ahead, 8U, 10U);
+	zassert_equal(audio_node_close(&large_ahead), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_treats_short_read_as_eof)
+{
+	/* The header promises 4 KiB, the file carries 10 samples. */
+	write_ahead_fixture(0U, 10U, 4096U);
+
+	zassert_equal(audio_node_open(&small_ahead), 0, "open failed");
+	assert_reads_payload(&small_ahead, 4U, 10U);
+	zassert_equal(audio_node_close(&small_ahead), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_fills_the_ring_in_open)
+{
+	struct audio_file_reader_stats stats;
+
+	write_ahead_fixture(0U, AHEAD_SAMPLES, 0U);
+
+	/* Payload and end marker fit the ring, so open() read it all. */
+	zassert_equal(audio_node_open(&large_ahead), 0, "open failed");
+	zassert_equal(audio_file_reader_get_stats(&large_ahead, &stats), 0, "stats failed");
+	zassert_equal(stats.blocks, 4U, "wrong block count");
+	zassert_true(stats.filled >= 2U, "open() left the ring empty");
+	zassert_equal(stats.low_water, 4U, "low water before the first block");
+	zassert_equal(stats.underruns, 0U, "an underrun before any process()");
+
+	assert_reads_payload(&large_ahead, AHEAD_FRAME_SAMPLES, AHEAD_SAMPLES);
+
+	/* Nothing was ever waited for. */
+	zassert_equal(audio_file_reader_get_stats(&large_ahead, &stats), 0, "stats failed");
+	zassert_equal(stats.underruns, 0U, "a ring holding the file underran");
+	zassert_true(stats.low_water >= 1U, "a ring holding the file ran dry");
+
+	zassert_equal(audio_node_close(&large_ahead), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_close_stops_the_io_thread)
+{
+	int32_t buf[AHEAD_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	struct audio_file_reader_state *state = small_ahead.state;
+	size_t produced;
+	unsigned int i;
+
+	write_ahead_fixture(0U, AHEAD_SAMPLES, 0U);
+
+	/* Closed mid-file with the I/O thread running, and reopened: every
+	 * round has to start at the first sample on a fresh thread.
+	 */
+	for (i = 0; i < 16U; i++) {
+		zassert_equal(audio_node_open(&small_ahead), 0, "open failed in round %u", i);
+		zassert_true(state->io_running, "no I/O thread in round %u", i);
+
+		zassert_equal(audio_node_process(&small_ahead, &view, &produced), 0,
+			      "process failed in round %u", i);
+		zassert_equal(produced, ARRAY_SIZE(buf), "round %u produced %zu samples", i,
+			      produced);
+		zassert_equal(buf[0], audio_test_s16_to_s32(ahead_payload[0]),
+			      "round %u did not restart at the first sample", i);
+
+		zassert_equal(audio_node_close(&small_ahead), 0, "close failed in round %u", i);
+		zassert_false(state->io_running, "close() left the I/O thread running");
+	}
+
+	zassert_equal(audio_node_process(&small_ahead, &view, &produced), -EBADF,
+		      "process() after close() must fail");
+}
+
+ZTEST(audio_pipeline_file_reader_read_ahead, test_read_ahead_stats_reject_other_nodes)
+{
+	struct audio_file_reader_stats stats;
+
+	zassert_equal(audio_file_reader_get_stats(NULL, &stats), -EINVAL, "NULL node accepted");
+	zassert_equal(audio_file_reader_get_stats(&small_ahead, NULL), -EINVAL,
+		      "NULL stats accepted");
+	zassert_equal(audio_file_reader_get_stats(&ahead_gain, &stats), -EINVAL,
+		      "a gain node has no read-ahead stats");
+	zassert_equal(audio_file_reader_get_stats(&plain_reader, &stats), -ENOTSUP,
+		      "a reader without a ring has no read-ahead stats");
+}
+
+ZTEST_SUITE(audio_pipeline_file_reader_read_ahead, NULL, NULL, ahead_before, NULL, NULL);
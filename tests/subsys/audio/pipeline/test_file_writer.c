@@ -29,6 +29,9 @@
 
 /* Canonical header: RIFF/WAVE + 16 byte "fmt " + "data" chunk header. */
 #define WRITER_HEADER_SIZE AUDIO_WAV_MIN_HEADER_SIZE
+/* The 40 byte WAVE_FORMAT_EXTENSIBLE "fmt " a file of more channels gets. */
+#define WRITER_WIDE_HEADER_SIZE AUDIO_WAV_EXTENSIBLE_HEADER_SIZE
+#define WRITER_WIDE_CHANNELS    8U
 /*
  * Offset of the RIFF size field. The one field no reader in this subsystem
  * looks at, so the suite has to reach for it by hand - checking it through the
@@ -54,6 +57,7 @@ AUDIO_FAKE_SOURCE_DEFINE(eof_source);
 AUDIO_FAKE_SOURCE_DEFINE(abort_source);
 AUDIO_FAKE_SOURCE_DEFINE(reopen_source);
 AUDIO_FAKE_SOURCE_DEFINE(odd_source);
+AUDIO_FAKE_SOURCE_DEFINE(wide_source);
 
 AUDIO_FILE_WRITER_NODE_DEFINE(hdr_writer, &hdr_source, AUDIO_TEST_PATH("w_hdr.wav"));
 AUDIO_FILE_WRITER_NODE_DEFINE(conv_writer, &conv_source, AUDIO_TEST_PATH("w_conv.wav"));
@@ -64,6 +68,7 @@ AUDIO_FILE_WRITER_NODE_DEFINE(reopen_writer, &reopen_source, AUDIO_TEST_PATH("w_
 AUDIO_FILE_WRITER_NODE_DEFINE(odd_writer, &odd_source, AUDIO_TEST_PATH("w_odd.wav"));
 AUDIO_FILE_WRITER_NODE_DEFINE(depth_writer, &hdr_source, AUDIO_TEST_PATH("w_depth.wav"));
 AUDIO_FILE_WRITER_NODE_DEFINE(chan_writer, &hdr_source, AUDIO_TEST_PATH("w_chan.wav"));
+AUDIO_FILE_WRITER_NODE_DEFINE(wide_writer, &wide_source, AUDIO_TEST_PATH("w_wide.wav"));
 /* A directory that does not exist: the filesystem has to reject open(). */
 AUDIO_FILE_WRITER_NODE_DEFINE(nodir_writer, &hdr_source, AUDIO_TEST_PATH("nodir/w.wav"));
 /* No upstream at all: a wiring error the pull has to reject. */
@@ -129,31 +134,38 @@ static uint8_t file_buf[512];
 static void assert_valid_wav(const char *path, uint32_t rate, uint16_t channels,
 			     uint32_t data_bytes)
 {
+	/* Past stereo the sink has to say which channel is which, and only the
+	 * extensible layout can.
+	 */
+	bool wide = channels > 2U;
+	uint32_t header_size = wide ? WRITER_WIDE_HEADER_SIZE : WRITER_HEADER_SIZE;
 	struct audio_wav_header wav;
 	size_t len = audio_test_read_file(path, file_buf, sizeof(file_buf));
 	uint32_t riff_size;
 	int ret;
 
-	zassert_equal(len, WRITER_HEADER_SIZE + data_bytes,
-		      "%s: file is %zu bytes, expected %u", path, len,
-		      WRITER_HEADER_SIZE + data_bytes);
+	zassert_equal(len, header_size + data_bytes, "%s: file is %zu bytes, expected %u", path,
+		      len, header_size + data_bytes);
 
 	ret = audio_wav_read_header(file_buf, len, &wav);
 	zassert_equal(ret, 0, "%s: the sink produced a header the parser rejects (%d)", path, ret);
 
-	zassert_equal(wav.format_tag, AUDIO_WAV_FORMAT_PCM, "%s: not tagged as PCM", path);
+	zassert_equal(wav.format_tag, wide ? AUDIO_WAV_FORMAT_EXTENSIBLE : AUDIO_WAV_FORMAT_PCM,
+		      "%s: tagged 0x%04x for %u channels", path, wav.format_tag, channels);
 	zassert_equal(wav.sample_rate_hz, rate, "%s: wrong sample rate", path);
 	zassert_equal(wav.channels, channels, "%s: wrong channel count", path);
-	zassert_equal(wav.bits_per_sample, 16U, "%s: v1 writes 16 bit PCM", path);
+	zassert_equal(wav.bits_per_sample, 16U, "%s: a 16 bit format written at %u bit", path,
+		      wav.bits_per_sample);
 	zassert_equal(wav.block_align, (uint16_t)(channels * 2U), "%s: wrong block align", path);
-	zassert_equal(wav.data_offset, WRITER_HEADER_SIZE, "%s: payload is not at byte 44", path);
+	zassert_equal(wav.data_offset, header_size, "%s: payload is not at byte %u", path,
+		      header_size);
 	zassert_equal(wav.data_size, data_bytes, "%s: data chunk claims %u of %u bytes", path,
 		      wav.data_size, data_bytes);
 
 	/* The parser ignores the RIFF size, so check it by hand. */
 	riff_size = sys_get_le32(&file_buf[WRITER_RIFF_SIZE_OFFSET]);
-	zassert_equal(riff_size, 36U + data_bytes, "%s: RIFF size is %u, expected %u", path,
-		      riff_size, 36U + data_bytes);
+	zassert_equal(riff_size, header_size - 8U + data_bytes, "%s: RIFF size is %u, expected %u",
+		      path, riff_size, header_size - 8U + data_bytes);
 }
 
 /** The 16 bit sample at payload index @p i of the file last read back. */
@@ -171,6 +183,7 @@ static struct audio_node *const direct_writers[] = {
 	&hdr_writer,    &conv_writer,   &fmt_writer,    &eof_writer,
 	&abort_writer,  &reopen_writer, &odd_writer,    &depth_writer,
 	&chan_writer,   &nodir_writer,  &orphan_writer, &unopened_writer,
+	&wide_writer,
 };
 
 static const struct audio_stream_config writer_format = {
@@ -278,10 +291,11 @@ ZTEST(audio_pipeline_file_writer, test_sink_rejects_unsupported_depth)
 	static const struct audio_stream_config deep_format = {
 		.sample_rate_hz = WRITER_RATE,
 		.channels = WRITER_CHANNELS,
-		/* v1 narrows to 16 bit only; the spec's 24 bit path is not
-		 * built, so a bound format asking for it has to fail loudly.
+		/* 8, 16, 24 and 32 bit have a PCM layout of their own; 20 bit
+		 * would need padding the sink does not guess at, so a bound
+		 * format asking for it has to fail loudly.
 		 */
-		.valid_bits_per_sample = 24U,
+		.valid_bits_per_sample = 20U,
 		.format = AUDIO_SAMPLE_FORMAT_S32_LE,
 	};
 	struct audio_file_writer_state *state = depth_writer.state;
@@ -290,7 +304,7 @@ ZTEST(audio_pipeline_file_writer, test_sink_rejects_unsupported_depth)
 	depth_writer.pipeline_format = &deep_format;
 
 	ret = audio_node_open(&depth_writer);
-	zassert_equal(ret, -ENOTSUP, "a 24 bit sink must be rejected with -ENOTSUP, got %d", ret);
+	zassert_equal(ret, -ENOTSUP, "a 20 bit sink must be rejected with -ENOTSUP, got %d", ret);
 	zassert_false(state->file_open, "a failed open() must not leave a handle");
 
 	/* Refused before the file is created (spec §10.2), so an unsupported
@@ -303,7 +317,7 @@ ZTEST(audio_pipeline_file_writer, test_sink_rejects_unsupported_channels)
 {
 	static const struct audio_stream_config wide_format = {
 		.sample_rate_hz = WRITER_RATE,
-		.channels = 3U,
+		.channels = CONFIG_AUDIO_PIPELINE_MAX_CHANNELS + 1,
 		.valid_bits_per_sample = 16U,
 		.format = AUDIO_SAMPLE_FORMAT_S32_LE,
 	};
@@ -313,12 +327,61 @@ ZTEST(audio_pipeline_file_writer, test_sink_rejects_unsupported_channels)
 	chan_writer.pipeline_format = &wide_format;
 
 	ret = audio_node_open(&chan_writer);
-	zassert_equal(ret, -ENOTSUP, "v1 writes 1 or 2 channels, got %d for 3", ret);
+	zassert_equal(ret, -ENOTSUP, "the sink writes 1..%d channels, got %d for one more",
+		      CONFIG_AUDIO_PIPELINE_MAX_CHANNELS, ret);
 	zassert_false(state->file_open, "a failed open() must not leave a handle");
 
 	assert_no_file(AUDIO_TEST_PATH("w_chan.wav"));
 }
 
+ZTEST(audio_pipeline_file_writer, test_sink_writes_an_extensible_header_past_stereo)
+{
+	static const struct audio_stream_config octo_format = {
+		.sample_rate_hz = WRITER_RATE,
+		.channels = WRITER_WIDE_CHANNELS,
+		.valid_bits_per_sample = 16U,
+		.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+	};
+	/* Two sample sets; every channel's sample names its slot. */
+	static const int32_t wide_in[2U * WRITER_WIDE_CHANNELS] = {
+		0x00000000, 0x00010000, 0x00020000, 0x00030000, 0x00040000, 0x00050000,
+		0x00060000, 0x00070000, 0x00100000, 0x00110000, 0x00120000, 0x00130000,
+		0x00140000, 0x00150000, 0x00160000, 0x00170000,
+	};
+	int32_t buf[WRITER_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	struct audio_wav_header wav;
+	size_t produced = 0;
+	size_t i;
+
+	wide_source_state.samples = wide_in;
+	wide_source_state.sample_count = ARRAY_SIZE(wide_in);
+	wide_source_state.chunk = 0;
+	wide_writer.pipeline_format = &octo_format;
+
+	zassert_equal(audio_node_open(&wide_writer), 0, "open failed for %u channels",
+		      WRITER_WIDE_CHANNELS);
+	zassert_equal(audio_node_process(&wide_writer, &view, &produced), 0, "process failed");
+	zassert_equal(audio_node_close(&wide_writer), 0, "close failed");
+
+	assert_valid_wav(AUDIO_TEST_PATH("w_wide.wav"), WRITER_RATE, WRITER_WIDE_CHANNELS,
+			 (uint32_t)(ARRAY_SIZE(wide_in) * sizeof(int16_t)));
+
+	/* The pipeline carries channels, not speakers, so the mask says so. */
+	zassert_equal(audio_wav_read_header(file_buf, sizeof(file_buf), &wav), 0, "reparse failed");
+	zassert_equal(wav.channel_mask, 0U, "the sink invented speaker positions");
+	zassert_equal(wav.valid_bits_per_sample, 16U, "wrong valid bit count");
+
+	for (i = 0; i < ARRAY_SIZE(wide_in); i++) {
+		zassert_equal(sys_get_le16(&file_buf[WRITER_WIDE_HEADER_SIZE + i * 2U]),
+			      (uint16_t)((uint32_t)wide_in[i] >> 16), "sample %zu left its slot",
+			      i);
+	}
+}
+
 ZTEST(audio_pipeline_file_writer, test_sink_requires_a_bound_format)
 {
 	struct audio_file_writer_state *state = depth_writer.state;
@@ -0,0 +1,246 @@
+/*
+ * Header checkpoints of the file writer (spec §10.2.2): sizes patched on disk
+ * mid-stream, every interval of audio, by a writing-behind writer on its I/O
+ * thread - so a file read while the node is still open plays up to the last
+ * checkpoint, and the final patch is unchanged. A plain writer, which would
+ * have to checkpoint inside process(), refuses an interval.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_wav.h>
+
+#include "fake_nodes.h"
+#include "wav_fixture.h"
+
+#define CHECKPOINT_SAMPLES 1000U
+
+/* Twenty stereo sets: 80 bytes of payload a frame. */
+#define CHECKPOINT_FRAME_SAMPLES 40
+#define CHECKPOINT_FRAME_BYTES (CHECKPOINT_FRAME_SAMPLES * sizeof(int16_t))
+
+/* 1 ms of 48 kHz stereo: 48 sets, 192 bytes, so every block crosses it. */
+#define CHECKPOINT_MS 1U
+
+/* The first block and one whole one; a frame more starts the third. */
+#define CHECKPOINT_BLOCKS_PAYLOAD (2U * AUDIO_FILE_SECTOR_BYTES - AUDIO_WAV_MIN_HEADER_SIZE)
+#define CHECKPOINT_BLOCKS_FRAMES (CHECKPOINT_BLOCKS_PAYLOAD / CHECKPOINT_FRAME_BYTES + 1U)
+
+/* Offset of the RIFF chunk size in either header. */
+#define CHECKPOINT_RIFF_SIZE_OFFSET 4U
+
+AUDIO_FAKE_SOURCE_DEFINE(checkpoint_source);
+AUDIO_FAKE_SOURCE_DEFINE(checkpoint_behind_source);
+
+AUDIO_FILE_WRITER_NODE_DEFINE(checkpoint_writer, &checkpoint_source,
+			      AUDIO_TEST_PATH("cp_plain.wav"));
+/* Two blocks of one sector: the first holds 468 bytes of payload. */
+AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(checkpoint_behind, &checkpoint_behind_source,
+					   AUDIO_TEST_PATH("cp_behind.wav"),
+					   AUDIO_FILE_SECTOR_BYTES, 2);
+AUDIO_GAIN_FILTER_NODE_DEFINE(checkpoint_gain, &checkpoint_source, AUDIO_GAIN_UNITY_Q15);
+
+static int32_t checkpoint_samples[CHECKPOINT_SAMPLES];
+static uint8_t checkpoint_buf[AUDIO_WAV_MAX_HEADER_SIZE + CHECKPOINT_SAMPLES * sizeof(int16_t)];
+
+static const struct audio_stream_config checkpoint_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void checkpoint_before(void *fixture)
+{
+	struct audio_fake_source *sources[] = {
+		&checkpoint_source_state,
+		&checkpoint_behind_source_state,
+	};
+	size_t i;
+
+	ARG_UNUSED(fixture);
+
+	zassert_equal(audio_test_fs_mount(), 0, "fixture filesystem did not mount");
+
+	for (i = 0; i < ARRAY_SIZE(checkpoint_samples); i++) {
+		checkpoint_samples[i] = (int32_t)(i * 0x00010001U);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sources); i++) {
+		audio_fake_source_reset(sources[i]);
+		sources[i]->samples = checkpoint_samples;
+		sources[i]->sample_count = CHECKPOINT_SAMPLES;
+	}
+
+	checkpoint_writer.pipeline_format = &checkpoint_format;
+	checkpoint_behind.pipeline_format = &checkpoint_format;
+
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_writer, 0U), 0,
+		      "could not clear the interval");
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_behind, 0U), 0,
+		      "could not clear the interval");
+}
+
+/*
+ * Read @p path back while its writer may still be open, check that its header
+ * parses and that both sizes agree, and return the payload it declares. The
+ * file itself holds @p file_payload bytes after the header.
+ */
+static uint32_t declared_payload(const char *path, size_t file_payload)
+{
+	struct audio_wav_header wav;
+	uint32_t riff_size;
+	size_t len;
+
+	len = audio_test_read_file(path, checkpoint_buf, sizeof(checkpoint_buf));
+	zassert_equal(len, AUDIO_WAV_MIN_HEADER_SIZE + file_payload, "%s: file is %zu bytes",
+		      path, len);
+	zassert_equal(audio_wav_read_header(checkpoint_buf, len, &wav), 0,
+		      "%s: a checkpointed header must parse", path);
+
+	riff_size = sys_get_le32(&checkpoint_buf[CHECKPOINT_RIFF_SIZE_OFFSET]);
+	zassert_equal(riff_size, AUDIO_WAV_MIN_HEADER_SIZE - 8U + wav.data_size,
+		      "%s: RIFF size %u disagrees with data size %u", path, riff_size,
+		      wav.data_size);
+
+	return wav.data_size;
+}
+
+/*
+ * Feed @ref CHECKPOINT_BLOCKS_FRAMES frames to the writing-behind writer and
+ * wait until its I/O thread has written, and checkpointed if it is going to,
+ * both full blocks: only the one being filled is then not free.
+ */
+static void fill_two_blocks(void)
+{
+	int32_t buf[CHECKPOINT_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	struct audio_file_writer_stats stats;
+	size_t produced;
+	unsigned int f;
+	int i;
+
+	for (f = 0U; f < CHECKPOINT_BLOCKS_FRAMES; f++) {
+		zassert_equal(audio_node_process(&checkpoint_behind, &view, &produced), 0,
+			      "process failed");
+	}
+
+	for (i = 0; i < 1000; i++) {
+		zassert_equal(audio_file_writer_get_stats(&checkpoint_behind, &stats), 0,
+			      "stats failed");
+		if (stats.writes == 2U && stats.free == 1U) {
+			break;
+		}
+		k_msleep(1);
+	}
+	zassert_equal(stats.writes, 2U, "%u blocks written", stats.writes);
+	zassert_equal(stats.free, 1U, "the I/O thread is still busy");
+}
+
+ZTEST(audio_pipeline_file_writer_checkpoint, test_checkpoint_none_leaves_the_placeholder)
+{
+	int32_t buf[CHECKPOINT_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t produced;
+	unsigned int f;
+
+	zassert_equal(audio_node_open(&checkpoint_writer), 0, "open failed");
+	for (f = 1U; f <= 10U; f++) {
+		zassert_equal(audio_node_process(&checkpoint_writer, &view, &produced), 0,
+			      "process failed");
+	}
+
+	/* Without an interval only EOF and close() patch. */
+	zassert_equal(declared_payload(AUDIO_TEST_PATH("cp_plain.wav"),
+				       10U * CHECKPOINT_FRAME_BYTES),
+		      0U, "a header patched without an interval");
+
+	zassert_equal(audio_node_close(&checkpoint_writer), 0, "close failed");
+	zassert_equal(declared_payload(AUDIO_TEST_PATH("cp_plain.wav"),
+				       10U * CHECKPOINT_FRAME_BYTES),
+		      10U * CHECKPOINT_FRAME_BYTES, "close() did not patch");
+}
+
+ZTEST(audio_pipeline_file_writer_checkpoint, test_checkpoint_refused_by_a_plain_writer)
+{
+	/* Its seek, write and sync would all land inside process(). */
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_writer, CHECKPOINT_MS),
+		      -ENOTSUP, "a plain writer took an interval");
+	zassert_equal(checkpoint_writer_state.checkpoint_ms, 0U, "the refusal set the interval");
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_writer, 0U), 0,
+		      "0 must always be accepted");
+
+	/* Nor does open() run with one a state was given by hand. */
+	checkpoint_writer_state.checkpoint_ms = CHECKPOINT_MS;
+	zassert_equal(audio_node_open(&checkpoint_writer), -ENOTSUP,
+		      "a plain writer opened with an interval");
+	checkpoint_writer_state.checkpoint_ms = 0U;
+}
+
+ZTEST(audio_pipeline_file_writer_checkpoint, test_checkpoint_applies_from_the_next_open)
+{
+	zassert_equal(audio_node_open(&checkpoint_behind), 0, "open failed");
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_behind, CHECKPOINT_MS), 0,
+		      "could not set the interval");
+
+	/* A run keeps the interval it was opened with. */
+	fill_two_blocks();
+	zassert_equal(declared_payload(AUDIO_TEST_PATH("cp_behind.wav"), CHECKPOINT_BLOCKS_PAYLOAD),
+		      0U, "a new interval changed a running writer");
+	zassert_equal(audio_node_close(&checkpoint_behind), 0, "close failed");
+
+	/* And the next run has it. */
+	audio_fake_source_rewind(&checkpoint_behind_source_state);
+	zassert_equal(audio_node_open(&checkpoint_behind), 0, "reopen failed");
+	fill_two_blocks();
+	zassert_equal(declared_payload(AUDIO_TEST_PATH("cp_behind.wav"), CHECKPOINT_BLOCKS_PAYLOAD),
+		      CHECKPOINT_BLOCKS_PAYLOAD, "the interval did not outlive close()");
+	zassert_equal(audio_node_close(&checkpoint_behind), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_writer_checkpoint, test_checkpoint_behind_on_the_io_thread)
+{
+	const uint32_t frames_payload = CHECKPOINT_BLOCKS_FRAMES * CHECKPOINT_FRAME_BYTES;
+
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_behind, CHECKPOINT_MS), 0,
+		      "could not set the interval");
+	zassert_equal(audio_node_open(&checkpoint_behind), 0, "open failed");
+
+	/* Every block crosses an interval this short, so the header has the
+	 * second one already; the third is still in the ring.
+	 */
+	fill_two_blocks();
+	zassert_equal(declared_payload(AUDIO_TEST_PATH("cp_behind.wav"), CHECKPOINT_BLOCKS_PAYLOAD),
+		      CHECKPOINT_BLOCKS_PAYLOAD, "the I/O thread did not checkpoint");
+
+	zassert_equal(audio_node_close(&checkpoint_behind), 0, "close failed");
+	zassert_equal(declared_payload(AUDIO_TEST_PATH("cp_behind.wav"), frames_payload),
+		      frames_payload, "close() did not patch");
+}
+
+ZTEST(audio_pipeline_file_writer_checkpoint, test_checkpoint_rejects_other_nodes)
+{
+	zassert_equal(audio_file_writer_set_checkpoint(NULL, CHECKPOINT_MS), -EINVAL,
+		      "NULL node accepted");
+	zassert_equal(audio_file_writer_set_checkpoint(&checkpoint_gain, CHECKPOINT_MS), -EINVAL,
+		      "a gain node has no header to checkpoint");
+}
+
+ZTEST_SUITE(audio_pipeline_file_writer_checkpoint, NULL, NULL, checkpoint_before, NULL, NULL);
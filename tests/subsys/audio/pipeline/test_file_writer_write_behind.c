@@ -0,0 +1,337 @@
+/*
+ * Writing-behind file writer (spec §10.2.1): the same file as the plain writer
+ * out of a ring an I/O thread writes, a block at a time and on block
+ * boundaries after either header size, a header patched at EOF and in close(),
+ * a failed write reported - and the stats that say how the ring kept up.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/fs/fs.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_wav.h>
+
+#include "fake_nodes.h"
+#include "wav_fixture.h"
+
+/* A thousand samples: four sectors of file, whichever header it starts with. */
+#define BEHIND_SAMPLES 1000U
+#define BEHIND_PAYLOAD (BEHIND_SAMPLES * sizeof(int16_t))
+
+/* Whole sets of two and of eight channels, and no divisor of a block. */
+#define BEHIND_FRAME_SAMPLES 40
+
+AUDIO_FAKE_SOURCE_DEFINE(plain_source);
+AUDIO_FAKE_SOURCE_DEFINE(behind_source);
+AUDIO_FAKE_SOURCE_DEFINE(large_source);
+
+AUDIO_FILE_WRITER_NODE_DEFINE(plain_writer, &plain_source, AUDIO_TEST_PATH("wb_plain.wav"));
+/* The smallest ring there is: two blocks of one sector. */
+AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(small_behind, &behind_source,
+					   AUDIO_TEST_PATH("wb_small.wav"),
+					   AUDIO_FILE_SECTOR_BYTES, 2);
+/* A ring that holds every file below whole. */
+AUDIO_FILE_WRITER_WRITE_BEHIND_NODE_DEFINE(large_behind, &large_source,
+					   AUDIO_TEST_PATH("wb_large.wav"),
+					   4 * AUDIO_FILE_SECTOR_BYTES, 4);
+
+static int32_t behind_samples[BEHIND_SAMPLES];
+
+static uint8_t plain_buf[AUDIO_WAV_MAX_HEADER_SIZE + BEHIND_PAYLOAD + 64];
+static uint8_t behind_buf[sizeof(plain_buf)];
+
+static const struct audio_stream_config stereo_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config octo_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 8U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void behind_before(void *fixture)
+{
+	struct audio_fake_source *sources[] = {
+		&plain_source_state,
+		&behind_source_state,
+		&large_source_state,
+	};
+	size_t i;
+
+	ARG_UNUSED(fixture);
+
+	zassert_equal(audio_test_fs_mount(), 0, "fixture filesystem did not mount");
+
+	/* Dirt in the low half too, which narrowing has to drop. */
+	for (i = 0; i < ARRAY_SIZE(behind_samples); i++) {
+		behind_samples[i] = (int32_t)(i * 0x01234567U);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sources); i++) {
+		audio_fake_source_reset(sources[i]);
+		sources[i]->samples = behind_samples;
+		sources[i]->sample_count = BEHIND_SAMPLES;
+	}
+
+	plain_writer.pipeline_format = &stereo_format;
+	small_behind.pipeline_format = &stereo_format;
+	large_behind.pipeline_format = &stereo_format;
+}
+
+/*
+ * Open @p writer, push its source through it to EOF in frames of
+ * BEHIND_FRAME_SAMPLES and close it, checking every step succeeded.
+ */
+static void write_to_eof(struct audio_node *writer, struct audio_fake_source *src)
+{
+	int32_t buf[BEHIND_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t produced;
+
+	/* Only the sink is opened here, so rewind the script by hand. */
+	audio_fake_source_rewind(src);
+
+	zassert_equal(audio_node_open(writer), 0, "open failed");
+	do {
+		zassert_equal(audio_node_process(writer, &view, &produced), 0, "process failed");
+	} while (produced != 0U);
+	zassert_equal(audio_node_close(writer), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_matches_the_plain_writer)
+{
+	size_t plain_len;
+	size_t behind_len;
+
+	write_to_eof(&plain_writer, &plain_source_state);
+	write_to_eof(&small_behind, &behind_source_state);
+
+	plain_len = audio_test_read_file(AUDIO_TEST_PATH("wb_plain.wav"), plain_buf,
+					 sizeof(plain_buf));
+	behind_len = audio_test_read_file(AUDIO_TEST_PATH("wb_small.wav"), behind_buf,
+					  sizeof(behind_buf));
+
+	zassert_equal(plain_len, AUDIO_WAV_MIN_HEADER_SIZE + BEHIND_PAYLOAD,
+		      "the plain writer wrote %zu bytes", plain_len);
+	zassert_equal(behind_len, plain_len, "%zu bytes written behind, %zu plain", behind_len,
+		      plain_len);
+	zassert_mem_equal(behind_buf, plain_buf, plain_len, "the files differ");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_writes_whole_blocks)
+{
+	struct audio_file_writer_stats stats;
+
+	write_to_eof(&small_behind, &behind_source_state);
+
+	/* 468 bytes to reach the first boundary, two whole blocks, and the
+	 * rest: four writes where the plain writer makes one per chunk.
+	 */
+	zassert_equal(audio_file_writer_get_stats(&small_behind, &stats), 0, "stats failed");
+	zassert_equal(stats.writes,
+		      DIV_ROUND_UP(AUDIO_WAV_MIN_HEADER_SIZE + BEHIND_PAYLOAD,
+				   AUDIO_FILE_SECTOR_BYTES),
+		      "%u writes", stats.writes);
+	zassert_equal(stats.blocks, 2U, "wrong block count");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_aligns_after_an_extensible_header)
+{
+	struct audio_file_writer_stats stats;
+	struct audio_wav_header wav;
+	size_t len;
+
+	/* Eight channels: a 68 byte header, so the first block is 444 bytes. */
+	small_behind.pipeline_format = &octo_format;
+	plain_writer.pipeline_format = &octo_format;
+
+	write_to_eof(&plain_writer, &plain_source_state);
+	write_to_eof(&small_behind, &behind_source_state);
+
+	zassert_equal(audio_file_writer_get_stats(&small_behind, &stats), 0, "stats failed");
+	zassert_equal(stats.writes,
+		      DIV_ROUND_UP(AUDIO_WAV_EXTENSIBLE_HEADER_SIZE + BEHIND_PAYLOAD,
+				   AUDIO_FILE_SECTOR_BYTES),
+		      "%u writes", stats.writes);
+
+	len = audio_test_read_file(AUDIO_TEST_PATH("wb_small.wav"), behind_buf,
+				   sizeof(behind_buf));
+	zassert_equal(audio_wav_read_header(behind_buf, len, &wav), 0, "header rejected");
+	zassert_equal(wav.channels, 8U, "wrong channel count");
+	zassert_equal(wav.data_offset, AUDIO_WAV_EXTENSIBLE_HEADER_SIZE, "payload moved");
+	zassert_equal(wav.data_size, BEHIND_PAYLOAD, "data chunk claims %u bytes",
+		      wav.data_size);
+
+	zassert_equal(audio_test_read_file(AUDIO_TEST_PATH("wb_plain.wav"), plain_buf,
+					   sizeof(plain_buf)),
+		      len, "the plain writer wrote a different length");
+	zassert_mem_equal(behind_buf, plain_buf, len, "the files differ");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_patches_the_header_at_eof)
+{
+	int32_t buf[BEHIND_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	struct audio_wav_header wav;
+	size_t produced;
+	size_t len;
+
+	audio_fake_source_rewind(&behind_source_state);
+	zassert_equal(audio_node_open(&small_behind), 0, "open failed");
+	do {
+		zassert_equal(audio_node_process(&small_behind, &view, &produced), 0,
+			      "process failed");
+	} while (produced != 0U);
+
+	/* Still open: EOF alone has to leave the whole payload on disk and the
+	 * sizes describing it, as the plain writer does.
+	 */
+	len = audio_test_read_file(AUDIO_TEST_PATH("wb_small.wav"), behind_buf,
+				   sizeof(behind_buf));
+	zassert_equal(len, AUDIO_WAV_MIN_HEADER_SIZE + BEHIND_PAYLOAD, "file is %zu bytes", len);
+	zassert_equal(audio_wav_read_header(behind_buf, len, &wav), 0, "header rejected");
+	zassert_equal(wav.data_size, BEHIND_PAYLOAD, "data chunk claims %u bytes",
+		      wav.data_size);
+
+	zassert_equal(audio_node_close(&small_behind), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_reports_a_failed_write)
+{
+	int32_t buf[BEHIND_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	struct audio_file_writer_state *state = small_behind.state;
+	struct audio_wav_header wav;
+	size_t produced;
+	size_t len;
+	int ret;
+
+	audio_fake_source_rewind(&behind_source_state);
+	zassert_equal(audio_node_open(&small_behind), 0, "open failed");
+
+	/* Nothing is queued yet, so the I/O thread is only waiting: pull the
+	 * handle out from under it, and every write it makes fails.
+	 */
+	zassert_equal(fs_close(&state->file), 0, "could not close the handle behind the node");
+
+	/* The failure surfaces on a later frame, or at the latest when EOF
+	 * drains the ring - never as EOF itself.
+	 */
+	do {
+		ret = audio_node_process(&small_behind, &view, &produced);
+	} while (ret == 0 && produced != 0U);
+	zassert_true(ret < 0, "a failed write must surface as a negative return");
+	zassert_not_equal(ret, -EPIPE, "a write error must not look like EOF");
+
+	(void)audio_node_close(&small_behind);
+	zassert_false(state->file_open, "close() must release the handle regardless");
+	zassert_false(state->io_running, "close() left the I/O thread running");
+
+	/* The placeholder open() wrote: an empty track, not a bogus length. */
+	len = audio_test_read_file(AUDIO_TEST_PATH("wb_small.wav"), behind_buf,
+				   sizeof(behind_buf));
+	zassert_equal(audio_wav_read_header(behind_buf, len, &wav), 0,
+		      "even an unfinalised file must carry a parsable header");
+	zassert_equal(wav.data_size, 0U, "an unfinalised file must not claim payload");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_close_stops_the_io_thread)
+{
+	int32_t buf[BEHIND_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	struct audio_file_writer_state *state = small_behind.state;
+	struct audio_wav_header wav;
+	size_t produced;
+	size_t len;
+	unsigned int round;
+	unsigned int f;
+
+	/* Closed mid-stream with a block queued, and reopened: every round has
+	 * to leave a file of exactly its own frames.
+	 */
+	for (round = 1U; round <= 16U; round++) {
+		audio_fake_source_rewind(&behind_source_state);
+
+		zassert_equal(audio_node_open(&small_behind), 0, "open failed in round %u",
+			      round);
+		zassert_true(state->io_running, "no I/O thread in round %u", round);
+
+		for (f = 0U; f < round; f++) {
+			zassert_equal(audio_node_process(&small_behind, &view, &produced), 0,
+				      "process failed in round %u", round);
+		}
+
+		zassert_equal(audio_node_close(&small_behind), 0, "close failed in round %u",
+			      round);
+		zassert_false(state->io_running, "close() left the I/O thread running");
+
+		len = audio_test_read_file(AUDIO_TEST_PATH("wb_small.wav"), behind_buf,
+					   sizeof(behind_buf));
+		zassert_equal(audio_wav_read_header(behind_buf, len, &wav), 0,
+			      "round %u: header rejected", round);
+		zassert_equal(wav.data_size, round * BEHIND_FRAME_SAMPLES * sizeof(int16_t),
+			      "round %u: data chunk claims %u bytes", round, wav.data_size);
+		zassert_equal(len, AUDIO_WAV_MIN_HEADER_SIZE + wav.data_size,
+			      "round %u: file is %zu bytes", round, len);
+	}
+
+	zassert_equal(audio_node_process(&small_behind, &view, &produced), -EBADF,
+		      "process() after close() must fail");
+}
+
+ZTEST(audio_pipeline_file_writer_write_behind, test_write_behind_stats)
+{
+	struct audio_file_writer_stats stats;
+
+	audio_fake_source_rewind(&large_source_state);
+	zassert_equal(audio_node_open(&large_behind), 0, "open failed");
+	zassert_equal(audio_file_writer_get_stats(&large_behind, &stats), 0, "stats failed");
+	zassert_equal(stats.blocks, 4U, "wrong block count");
+	zassert_equal(stats.free, 4U, "a ring with nothing queued is not empty");
+	zassert_equal(stats.overruns, 0U, "an overrun before any process()");
+	zassert_equal(stats.writes, 0U, "a write before any process()");
+	zassert_equal(audio_node_close(&large_behind), 0, "close failed");
+
+	/* A file the ring holds whole never waits for a block. */
+	write_to_eof(&large_behind, &large_source_state);
+	zassert_equal(audio_file_writer_get_stats(&large_behind, &stats), 0, "stats failed");
+	zassert_equal(stats.overruns, 0U, "a ring holding the file overran");
+	zassert_true(stats.low_water >= 1U, "a ring holding the file ran out of blocks");
+
+	zassert_equal(audio_file_writer_get_stats(NULL, &stats), -EINVAL, "NULL node accepted");
+	zassert_equal(audio_file_writer_get_stats(&large_behind, NULL), -EINVAL,
+		      "NULL stats accepted");
+	zassert_equal(audio_file_writer_get_stats(&large_source, &stats), -EINVAL,
+		      "a fake source has no write-behind stats");
+	zassert_equal(audio_file_writer_get_stats(&plain_writer, &stats), -ENOTSUP,
+		      "a writer without a ring has no write-behind stats");
+}
+
+ZTEST_SUITE(audio_pipeline_file_writer_write_behind, NULL, NULL, behind_before, NULL, NULL);
@@ -0,0 +1,209 @@
+/*
+ * FIR filter node (CONFIG_AUDIO_PIPELINE_NODE_FIR).
+ *
+ * Each filter sits on a stereo source that counts up on the left and down on
+ * the right, and is driven the way the pipeline thread drives it. The kernels
+ * are held to their definitions by the DSP suite, so the cases here are about
+ * the node's part: each channel's delay line kept apart and carried from frame
+ * to frame, the overlap-save form tracking the direct one through frames much
+ * shorter than its blocks, the state cleared by open(), and the checks open()
+ * and process() make.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+#define FIR_FRAME_SAMPLES 22
+#define FIR_FRAMES	  12
+#define FIR_RUN_SAMPLES	  (FIR_FRAME_SAMPLES * FIR_FRAMES)
+
+/* Sample set n is (n + 1) * step on the left and its negation on the right. */
+struct count_source_state {
+	int32_t step;
+	int32_t next;
+};
+
+static int count_source_process(struct audio_node *node, struct audio_buffer_view *buf,
+				size_t *out_size)
+{
+	struct count_source_state *state = node->state;
+	size_t i;
+
+	for (i = 0; i + 2U <= buf->capacity; i += 2U) {
+		state->next += state->step;
+		buf->data[i] = state->next;
+		buf->data[i + 1U] = -state->next;
+	}
+	*out_size = i;
+
+	return 0;
+}
+
+static const struct audio_node_ops count_source_ops = {
+	.process = count_source_process,
+};
+
+static struct count_source_state count_state;
+AUDIO_NODE_DEFINE(fir_count_source, AUDIO_NODE_ROLE_SOURCE, &count_source_ops, NULL,
+		  &count_state);
+
+static const int32_t delay_two[] = {AUDIO_FIR_TAP(0.0), AUDIO_FIR_TAP(0.0), AUDIO_FIR_TAP(1.0)};
+
+/* A 64-tap low-pass shape: a triangle, normalised to unity gain at DC. */
+#define T(_k) AUDIO_FIR_TAP((_k) / 1056.0)
+static const int32_t triangle[] = {
+	T(1),  T(2),  T(3),  T(4),  T(5),  T(6),  T(7),  T(8),  T(9),  T(10), T(11),
+	T(12), T(13), T(14), T(15), T(16), T(17), T(18), T(19), T(20), T(21), T(22),
+	T(23), T(24), T(25), T(26), T(27), T(28), T(29), T(30), T(31), T(32), T(32),
+	T(31), T(30), T(29), T(28), T(27), T(26), T(25), T(24), T(23), T(22), T(21),
+	T(20), T(19), T(18), T(17), T(16), T(15), T(14), T(13), T(12), T(11), T(10),
+	T(9),  T(8),  T(7),  T(6),  T(5),  T(4),  T(3),  T(2),  T(1),
+};
+#undef T
+
+/* Every tap in range, but together past the bound. */
+static const int32_t unbounded[] = {AUDIO_FIR_TAP(7.5), AUDIO_FIR_TAP(-7.5), AUDIO_FIR_TAP(1.0)};
+
+AUDIO_FIR_NODE_DEFINE(fir_delay, &fir_count_source, delay_two);
+AUDIO_FIR_NODE_DEFINE(fir_triangle, &fir_count_source, triangle);
+/* Blocks of 65 sample sets, each frame carrying 11: most calls are partial. */
+AUDIO_FIR_FFT_NODE_DEFINE(fir_triangle_fft, &fir_count_source, triangle, 7);
+AUDIO_FIR_NODE_DEFINE(fir_unbounded, &fir_count_source, unbounded);
+
+static const struct audio_stream_config stereo = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config three_channels = {
+	.sample_rate_hz = 48000U,
+	.channels = 3U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+/* FIR_FRAMES frames of the counting source, stepping by @p step, through
+ * @p filter, opened once, into @p out.
+ */
+static void run_frames(struct audio_node *filter, int32_t step, int32_t *out)
+{
+	struct audio_buffer_view view;
+	size_t out_size;
+	size_t f;
+
+	count_state.step = step;
+	count_state.next = 0;
+	filter->pipeline_format = &stereo;
+
+	zassert_equal(audio_node_open(filter), 0, "open failed");
+	for (f = 0; f < FIR_FRAMES; f++) {
+		view.data = &out[f * FIR_FRAME_SAMPLES];
+		view.capacity = FIR_FRAME_SAMPLES;
+		zassert_equal(audio_node_process(filter, &view, &out_size), 0, "process failed");
+		zassert_equal(out_size, FIR_FRAME_SAMPLES, "wrong frame size");
+	}
+	zassert_equal(audio_node_close(filter), 0, "close failed");
+}
+
+ZTEST_SUITE(audio_pipeline_fir, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_pipeline_fir, test_each_channel_has_its_own_delay_line)
+{
+	int32_t out[FIR_RUN_SAMPLES];
+	size_t i;
+
+	/* Two sample sets late on both channels, across every frame seam,
+	 * with silence from before the run in front.
+	 */
+	run_frames(&fir_delay, 1000, out);
+	for (i = 0; i < FIR_RUN_SAMPLES / 2U; i++) {
+		int32_t want = i < 2U ? 0 : (int32_t)(i - 1U) * 1000;
+
+		zassert_equal(out[2U * i], want, "left %zu: %d, expected %d", i, out[2U * i],
+			      want);
+		zassert_equal(out[2U * i + 1U], -want, "right %zu: %d, expected %d", i,
+			      out[2U * i + 1U], -want);
+	}
+}
+
+ZTEST(audio_pipeline_fir, test_overlap_save_tracks_the_direct_form)
+{
+	int32_t direct[FIR_RUN_SAMPLES];
+	int32_t fft[FIR_RUN_SAMPLES];
+	size_t i;
+
+	/* A ramp up to a quarter of full scale: no sample near the clamp,
+	 * and a low-pass passes it with the filter's delay. Near the top of
+	 * the ramp the transforms' rounding comes to some 64 LSBs, well
+	 * inside what the kernel's declaration allows at this level.
+	 */
+	run_frames(&fir_triangle, INT32_MAX / 4 / (FIR_RUN_SAMPLES / 2), direct);
+	run_frames(&fir_triangle_fft, INT32_MAX / 4 / (FIR_RUN_SAMPLES / 2), fft);
+
+	for (i = 0; i < FIR_RUN_SAMPLES; i++) {
+		zassert_within(fft[i], direct[i], 128, "sample %zu: %d, direct %d", i, fft[i],
+			       direct[i]);
+	}
+	zassert_true(direct[FIR_RUN_SAMPLES - 2] > 0, "the ramp did not pass");
+}
+
+ZTEST(audio_pipeline_fir, test_open_starts_from_silence)
+{
+	int32_t first[FIR_RUN_SAMPLES];
+	int32_t again[FIR_RUN_SAMPLES];
+
+	/* The second run would start from the first one's tail if open() left
+	 * the delay lines or the history alone.
+	 */
+	run_frames(&fir_triangle, 100000, first);
+	run_frames(&fir_triangle, 100000, again);
+	zassert_mem_equal(first, again, sizeof(first));
+
+	run_frames(&fir_triangle_fft, 100000, first);
+	run_frames(&fir_triangle_fft, 100000, again);
+	zassert_mem_equal(first, again, sizeof(first));
+}
+
+ZTEST(audio_pipeline_fir, test_open_checks_the_format_and_the_taps)
+{
+	fir_unbounded.pipeline_format = &stereo;
+	zassert_equal(audio_node_open(&fir_unbounded), -EINVAL,
+		      "taps past the coefficient bound opened");
+
+	fir_triangle.pipeline_format = &three_channels;
+	zassert_equal(audio_node_open(&fir_triangle), -ENOTSUP,
+		      "opened with more channels than it keeps delay lines for");
+
+	fir_triangle_fft.pipeline_format = &three_channels;
+	zassert_equal(audio_node_open(&fir_triangle_fft), -ENOTSUP,
+		      "overlap-save opened with more channels than one transform holds");
+
+	fir_triangle.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&fir_triangle), -EINVAL, "opened without a format");
+}
+
+ZTEST(audio_pipeline_fir, test_process_before_open_is_refused)
+{
+	int32_t buf[FIR_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t out_size;
+
+	fir_delay.pipeline_format = &stereo;
+	zassert_equal(audio_node_process(&fir_delay, &view, &out_size), -EBADF,
+		      "process() ran on a closed filter");
+}
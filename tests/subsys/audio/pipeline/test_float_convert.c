@@ -0,0 +1,338 @@
+/*
+ * S32-to-float and float-to-S32 nodes (CONFIG_AUDIO_PIPELINE_NODE_FLOAT_CONVERT),
+ * and the sample formats a node declares.
+ *
+ * The node-level cases sit each converter on a source that fills every frame
+ * from a table, in whichever sample format and layout it is opened with, and
+ * drive it the way the pipeline thread does. The conversions are held to
+ * their definition by the DSP suite, so the cases here are about the nodes'
+ * part: the format published upstream, where a planar frame is converted, and
+ * the checks the core and open() make.
+ *
+ * The pipeline case runs an S32 source through a float gain and a float
+ * biquad to an S32 sink, on samples that every step keeps exact, so the float
+ * paths of both filter nodes are checked sample for sample.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define FC_FRAME_SAMPLES 8
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+/* What the source writes: @ref count 32-bit words, once, then the end. A
+ * planar frame gets them one channel's run after the other.
+ */
+struct words_source_state {
+	const int32_t *words;
+	size_t count;
+	bool done;
+};
+
+static int words_source_process(struct audio_node *node, struct audio_buffer_view *buf,
+				size_t *out_size)
+{
+	struct words_source_state *state = node->state;
+	const struct audio_stream_config *fmt = node->pipeline_format;
+	size_t sets = state->count / fmt->channels;
+	size_t c;
+
+	*out_size = 0;
+	if (state->done) {
+		return 0;
+	}
+
+	if (fmt->layout == AUDIO_FRAME_LAYOUT_PLANAR) {
+		for (c = 0; c < fmt->channels; c++) {
+			memcpy(&buf->data[c * audio_frame_channel_stride(fmt, buf)],
+			       &state->words[c * sets], sets * sizeof(int32_t));
+		}
+	} else {
+		memcpy(buf->data, state->words, state->count * sizeof(int32_t));
+	}
+	*out_size = state->count;
+	state->done = true;
+
+	return 0;
+}
+
+static const struct audio_node_ops words_source_ops = {
+	.process = words_source_process,
+	.layouts = AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_INTERLEAVED) |
+		   AUDIO_FRAME_LAYOUT_BIT(AUDIO_FRAME_LAYOUT_PLANAR),
+	.formats = AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_S32_LE) |
+		   AUDIO_SAMPLE_FORMAT_BIT(AUDIO_SAMPLE_FORMAT_F32_LE),
+};
+
+static struct words_source_state words_state;
+AUDIO_NODE_DEFINE(fc_source, AUDIO_NODE_ROLE_SOURCE, &words_source_ops, NULL, &words_state);
+
+AUDIO_S32_TO_FLOAT_NODE_DEFINE(fc_to_float, &fc_source);
+AUDIO_FLOAT_TO_S32_NODE_DEFINE(fc_to_s32, &fc_source);
+/* Declares no sample formats, so S32 only. */
+AUDIO_FAKE_SINK_DEFINE(fc_plain_sink, &fc_source);
+
+static const struct audio_stream_config stereo_s32 = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 24U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config stereo_f32 = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 24U,
+	.format = AUDIO_SAMPLE_FORMAT_F32_LE,
+};
+
+static const struct audio_stream_config stereo_f32_planar = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 24U,
+	.format = AUDIO_SAMPLE_FORMAT_F32_LE,
+	.layout = AUDIO_FRAME_LAYOUT_PLANAR,
+};
+
+/* Open @p node at @p fmt over the source, with @p count @p words to give. */
+static void open_with_words(struct audio_node *node, const struct audio_stream_config *fmt,
+			    const void *words, size_t count)
+{
+	words_state.words = words;
+	words_state.count = count;
+	words_state.done = false;
+	audio_fake_open_over_source(node, fmt);
+}
+
+ZTEST_SUITE(audio_pipeline_float_convert, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_pipeline_float_convert, test_s32_to_float_scales_full_scale_to_one)
+{
+	static const int32_t words[] = {INT32_MIN, 0x40000000, -0x100, 0x7fffff00};
+	static const float want[] = {-1.0f, 0.5f, -0x1p-23f, 0x1.fffffep-1f};
+	float out[FC_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data_f32 = out,
+		.capacity = ARRAY_SIZE(out),
+	};
+	size_t out_size;
+	size_t i;
+
+	open_with_words(&fc_to_float, &stereo_f32, words, ARRAY_SIZE(words));
+	zassert_equal(fc_to_float.upstream_format->format, AUDIO_SAMPLE_FORMAT_S32_LE);
+	zassert_equal(fc_to_float.upstream_format->channels, 2U);
+
+	zassert_equal(audio_node_process(&fc_to_float, &view, &out_size), 0);
+	zassert_equal(out_size, ARRAY_SIZE(words));
+	for (i = 0; i < ARRAY_SIZE(want); i++) {
+		zassert_equal(out[i], want[i], "sample %zu", i);
+	}
+
+	/* The end passes through. */
+	zassert_equal(audio_node_process(&fc_to_float, &view, &out_size), 0);
+	zassert_equal(out_size, 0U);
+	zassert_equal(audio_node_close(&fc_to_float), 0);
+}
+
+ZTEST(audio_pipeline_float_convert, test_float_to_s32_rounds_and_saturates)
+{
+	static const float words[] = {1.5f, -2.0f, 0.25f, 0x1.8p-31f, -0x1p-32f, 0.0f};
+	static const int32_t want[] = {INT32_MAX, INT32_MIN, 0x20000000, 2, -1, 0};
+	int32_t out[FC_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = out,
+		.capacity = ARRAY_SIZE(out),
+	};
+	size_t out_size;
+	size_t i;
+
+	open_with_words(&fc_to_s32, &stereo_s32, words, ARRAY_SIZE(words));
+	zassert_equal(fc_to_s32.upstream_format->format, AUDIO_SAMPLE_FORMAT_F32_LE);
+
+	zassert_equal(audio_node_process(&fc_to_s32, &view, &out_size), 0);
+	zassert_equal(out_size, ARRAY_SIZE(words));
+	for (i = 0; i < ARRAY_SIZE(want); i++) {
+		zassert_equal(out[i], want[i], "sample %zu: %d", i, out[i]);
+	}
+	zassert_equal(audio_node_close(&fc_to_s32), 0);
+}
+
+ZTEST(audio_pipeline_float_convert, test_planar_frame_converts_each_run)
+{
+	/* Three sets of two channels in a frame of four sets: each run ends in
+	 * a gap the source never wrote and the node must not touch.
+	 */
+	static const int32_t words[] = {0x100, 0x200, 0x300, -0x100, -0x200, -0x300};
+	const int32_t gap = 0x7f7f7f7f;
+	union {
+		int32_t s32[FC_FRAME_SAMPLES];
+		float f32[FC_FRAME_SAMPLES];
+	} out;
+	struct audio_buffer_view view = {
+		.data = out.s32,
+		.capacity = ARRAY_SIZE(out.s32),
+	};
+	size_t out_size;
+	size_t s;
+
+	out.s32[3] = gap;
+	out.s32[7] = gap;
+	open_with_words(&fc_to_float, &stereo_f32_planar, words, ARRAY_SIZE(words));
+	zassert_equal(fc_to_float.upstream_format->layout, AUDIO_FRAME_LAYOUT_PLANAR);
+
+	zassert_equal(audio_node_process(&fc_to_float, &view, &out_size), 0);
+	zassert_equal(out_size, ARRAY_SIZE(words));
+	for (s = 0; s < 3U; s++) {
+		zassert_equal(out.f32[s], (float)words[s] / 2147483648.0f, "left %zu", s);
+		zassert_equal(out.f32[4U + s], (float)words[3U + s] / 2147483648.0f,
+			      "right %zu", s);
+	}
+	zassert_equal(out.s32[3], gap, "the left run's gap was converted");
+	zassert_equal(out.s32[7], gap, "the right run's gap was converted");
+	zassert_equal(audio_node_close(&fc_to_float), 0);
+}
+
+ZTEST(audio_pipeline_float_convert, test_open_refuses_an_undeclared_format)
+{
+	audio_fake_sink_reset(&fc_plain_sink_state);
+
+	/* Refused by the core, before the node's own open() runs. */
+	fc_plain_sink.pipeline_format = &stereo_f32;
+	zassert_equal(audio_node_open(&fc_plain_sink), -ENOTSUP,
+		      "an S32-only node was opened with floats");
+	zassert_equal(atomic_get(&fc_plain_sink_state.open_calls), 0);
+
+	fc_to_float.pipeline_format = &stereo_s32;
+	zassert_equal(audio_node_open(&fc_to_float), -ENOTSUP,
+		      "an s32-to-float node was opened with S32");
+	fc_to_s32.pipeline_format = &stereo_f32;
+	zassert_equal(audio_node_open(&fc_to_s32), -ENOTSUP,
+		      "a float-to-s32 node was opened with F32");
+}
+
+ZTEST(audio_pipeline_float_convert, test_open_and_process_check_the_state)
+{
+	int32_t buf[FC_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t out_size;
+
+	fc_to_s32.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&fc_to_s32), -EINVAL, "opened without a format");
+
+	fc_to_s32.pipeline_format = &stereo_s32;
+	zassert_equal(audio_node_process(&fc_to_s32, &view, &out_size), -EBADF,
+		      "process() ran on a closed float converter");
+}
+
+/* source -> s32-to-float -> gain (half) -> biquad (one set of delay) ->
+ * float-to-s32 -> sink, at 48 kHz stereo, run by a pipeline. Every sample is
+ * a 24-bit value, so halving and delaying it in floats is exact and the sink
+ * can be held to the S32 result bit for bit.
+ */
+#define FC_PIPELINE_FRAME_SAMPLES 32
+#define FC_PIPELINE_SETS	  100
+
+/* Channel @p c of set @p s: distinct, 24 significant bits, even. */
+#define FC_VALUE(_c, _s) ((int32_t)(((_s) * 2 + 2) * 256) * ((_c) ? -1 : 1))
+
+AUDIO_FAKE_SOURCE_DEFINE(fc_fake_source);
+AUDIO_S32_TO_FLOAT_NODE_DEFINE(fc_chain_to_float, &fc_fake_source);
+AUDIO_GAIN_FILTER_NODE_DEFINE(fc_chain_half, &fc_chain_to_float, AUDIO_GAIN_UNITY_Q15 / 2);
+AUDIO_BIQUAD_NODE_DEFINE(fc_chain_delay, &fc_chain_half,
+			 AUDIO_BIQUAD_STAGE(0.0, 1.0, 0.0, 0.0, 0.0));
+AUDIO_FLOAT_TO_S32_NODE_DEFINE(fc_chain_to_s32, &fc_chain_delay);
+
+/* The sink the chain ends in: S32 only, and keeps what it is given. */
+AUDIO_FAKE_RECORD_SINK_DEFINE(fc_record_sink, &fc_chain_to_s32,
+			      2 * FC_PIPELINE_SETS + FC_PIPELINE_FRAME_SAMPLES);
+
+AUDIO_PIPELINE_DEFINE(fc_pipeline, FC_PIPELINE_FRAME_SAMPLES, 2048, 5);
+AUDIO_PIPELINE_DEFINE(fc_plain_pipeline, FC_PIPELINE_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config fc_config = {
+	.frame_samples = FC_PIPELINE_FRAME_SAMPLES,
+};
+
+static int32_t fc_samples[2 * FC_PIPELINE_SETS];
+
+ZTEST(audio_pipeline_float_convert, test_float_stretch_runs_in_a_pipeline)
+{
+	const int32_t *recorded = fc_record_sink_samples;
+	const struct audio_stream_config *above;
+	struct audio_pipeline_event event;
+	size_t s;
+
+	for (s = 0; s < FC_PIPELINE_SETS; s++) {
+		fc_samples[2U * s] = FC_VALUE(0, s);
+		fc_samples[2U * s + 1U] = FC_VALUE(1, s);
+	}
+
+	audio_fake_source_reset(&fc_fake_source_state);
+	fc_fake_source_state.samples = fc_samples;
+	fc_fake_source_state.sample_count = ARRAY_SIZE(fc_samples);
+	audio_fake_record_sink_reset(&fc_record_sink_state);
+
+	zassert_equal(audio_pipeline_init(&fc_pipeline, &fc_config, &fc_record_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&fc_pipeline, &stereo_s32), 0);
+	zassert_equal(audio_pipeline_start(&fc_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&fc_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&fc_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "event %d", event.type);
+	(void)audio_pipeline_join(&fc_pipeline);
+
+	/* S32 at both ends, F32 between the converters. */
+	above = atomic_ptr_get(&fc_fake_source_state.seen_format);
+	zassert_not_null(above);
+	zassert_equal(above->format, AUDIO_SAMPLE_FORMAT_S32_LE);
+	zassert_equal(fc_chain_half.pipeline_format->format, AUDIO_SAMPLE_FORMAT_F32_LE);
+	zassert_equal(fc_chain_delay.pipeline_format->format, AUDIO_SAMPLE_FORMAT_F32_LE);
+
+	/* Every set, halved and one set late. */
+	zassert_equal(atomic_get(&fc_record_sink_state.recorded), ARRAY_SIZE(fc_samples));
+	zassert_equal(recorded[0], 0);
+	zassert_equal(recorded[1], 0);
+	for (s = 1; s < FC_PIPELINE_SETS; s++) {
+		zassert_equal(recorded[2U * s], FC_VALUE(0, s - 1U) / 2, "left %zu: %d", s,
+			      recorded[2U * s]);
+		zassert_equal(recorded[2U * s + 1U], FC_VALUE(1, s - 1U) / 2, "right %zu: %d",
+			      s, recorded[2U * s + 1U]);
+	}
+}
+
+ZTEST(audio_pipeline_float_convert, test_format_names_a_sample_format)
+{
+	struct audio_stream_config bad = stereo_s32;
+
+	audio_fake_sink_reset(&fc_plain_sink_state);
+	zassert_equal(audio_pipeline_init(&fc_plain_pipeline, &fc_config, &fc_plain_sink), 0);
+
+	bad.format = (enum audio_sample_format)(AUDIO_SAMPLE_FORMAT_F32_LE + 1);
+	zassert_equal(audio_pipeline_set_format(&fc_plain_pipeline, &bad), -EINVAL);
+
+	/* Floats all the way to a sink that only takes containers. */
+	bad.format = AUDIO_SAMPLE_FORMAT_F32_LE;
+	zassert_equal(audio_pipeline_set_format(&fc_plain_pipeline, &bad), 0);
+	zassert_equal(audio_pipeline_start(&fc_plain_pipeline), -ENOTSUP,
+		      "a chain started with a sample format its sink does not take");
+	zassert_equal(atomic_get(&fc_plain_sink_state.open_calls), 0);
+}
@@ -10,6 +10,12 @@
  * more channels than the frame has samples cannot describe one interleaved
  * sample set, and audio_pipeline_set_format() refuses it.
  *
+ * Above a converter the chain is a segment of its own (spec §5.2): the format
+ * the converter declared, and a frame holding the same stretch of time in it.
+ * A converter of the suite's own, which halves the rate and the channel count,
+ * pins that capacity and the check a declared format is put through before
+ * anything above it opens.
+ *
  * SPDX-License-Identifier: Apache-2.0
  */
 
@@ -24,6 +30,7 @@
 #include <zephyr/audio/audio_format.h>
 #include <zephyr/audio/audio_node.h>
 #include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
 
 #include "fake_nodes.h"
 
@@ -40,6 +47,75 @@
  */
 #define MINIMAL_FRAME_SAMPLES 2
 
+/* Mono at half the rate: the 8 stereo sets of a frame below take 4 sets of one
+ * sample above.
+ */
+#define SEGMENT_FRAME_SAMPLES 4
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+/* Asks upstream for half the rate on channels_above channels, and spreads
+ * every sample it pulls over two sets of two channels.
+ */
+struct segment_converter {
+	uint8_t channels_above;
+	struct audio_stream_config above;
+	int32_t scratch[SIZING_FRAME_SAMPLES];
+};
+
+static int segment_converter_open(struct audio_node *node)
+{
+	struct segment_converter *conv = node->state;
+
+	conv->above = *node->pipeline_format;
+	conv->above.sample_rate_hz /= 2U;
+	conv->above.channels = conv->channels_above;
+	node->upstream_format = &conv->above;
+
+	return 0;
+}
+
+static int segment_converter_process(struct audio_node *node, struct audio_buffer_view *buf,
+				     size_t *out_size)
+{
+	struct segment_converter *conv = node->state;
+	struct audio_buffer_view view = {
+		.data = conv->scratch,
+		.capacity = MIN(node->upstream->frame_capacity, ARRAY_SIZE(conv->scratch)),
+	};
+	size_t got;
+	size_t i;
+	int ret;
+
+	ret = audio_node_pull(node, &view, &got);
+	if (ret < 0) {
+		return ret;
+	}
+
+	got = MIN(got, buf->capacity / 4U);
+	for (i = 0; i < 4U * got; i++) {
+		buf->data[i] = conv->scratch[i / 4U];
+	}
+	*out_size = 4U * got;
+
+	return 0;
+}
+
+static const struct audio_node_ops segment_converter_ops = {
+	.open = segment_converter_open,
+	.process = segment_converter_process,
+};
+
+static struct segment_converter converter_state;
+
+AUDIO_FAKE_SOURCE_DEFINE(segment_source);
+static struct audio_fake_sink segment_filter_state;
+AUDIO_NODE_DEFINE(segment_filter, AUDIO_NODE_ROLE_FILTER, &audio_fake_sink_ops, &segment_source,
+		  &segment_filter_state);
+AUDIO_NODE_DEFINE(segment_converter, AUDIO_NODE_ROLE_FILTER, &segment_converter_ops,
+		  &segment_filter, &converter_state);
+AUDIO_FAKE_SINK_DEFINE(segment_sink, &segment_converter);
+
 AUDIO_FAKE_SOURCE_DEFINE(sizing_source);
 AUDIO_FAKE_SINK_DEFINE(sizing_sink, &sizing_source);
 
@@ -85,6 +161,10 @@ static void frame_sizing_before(void *fixture)
 	audio_fake_sink_reset(&sizing_sink_state);
 	audio_fake_source_reset(&minimal_source_state);
 	audio_fake_sink_reset(&minimal_sink_state);
+	audio_fake_source_reset(&segment_source_state);
+	audio_fake_sink_reset(&segment_filter_state);
+	audio_fake_sink_reset(&segment_sink_state);
+	converter_state.channels_above = 1U;
 }
 
 static void frame_sizing_after(void *fixture)
@@ -177,4 +257,69 @@ ZTEST(audio_pipeline_frame_sizing, test_pipeline_set_format_rejects_more_channel
 		      "wrong frame capacity");
 }
 
+ZTEST(audio_pipeline_frame_sizing, test_a_converter_sizes_the_frame_of_the_segment_above)
+{
+	const struct audio_stream_config *above;
+	struct audio_pipeline_event event;
+
+	segment_source_state.frames_total = 2U;
+	segment_source_state.pattern = 0x5a5a5a5a;
+	segment_filter_state.expect_capacity = SEGMENT_FRAME_SAMPLES;
+	segment_sink_state.expect_capacity = SIZING_FRAME_SAMPLES;
+	segment_sink_state.check_pattern = true;
+	segment_sink_state.expect_pattern = 0x5a5a5a5a;
+
+	zassert_equal(audio_pipeline_init(&sizing_pipeline, &sizing_config, &segment_sink), 0,
+		      "init failed");
+	zassert_equal(audio_pipeline_set_format(&sizing_pipeline, &stereo_format), 0,
+		      "binding the stereo format failed");
+	zassert_equal(audio_pipeline_start(&sizing_pipeline), 0, "start failed");
+
+	/* Bound at start(), before a single frame has run. */
+	zassert_equal(segment_sink.frame_capacity, (size_t)SIZING_FRAME_SAMPLES);
+	zassert_equal(segment_filter.frame_capacity, (size_t)SEGMENT_FRAME_SAMPLES,
+		      "the segment above got a frame of %zu samples",
+		      segment_filter.frame_capacity);
+	zassert_equal(segment_source.frame_capacity, (size_t)SEGMENT_FRAME_SAMPLES);
+
+	above = atomic_ptr_get(&segment_source_state.seen_format);
+	zassert_not_null(above, "the source was opened without a format");
+	zassert_equal(above->channels, 1U, "%u channels above the converter", above->channels);
+	zassert_equal(above->sample_rate_hz, 24000U, "%u Hz above the converter",
+		      above->sample_rate_hz);
+
+	zassert_equal(audio_pipeline_play(&sizing_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&sizing_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "event %d", event.type);
+
+	zassert_equal(atomic_get(&segment_sink_state.frames_seen), 2);
+	zassert_equal(atomic_get(&segment_filter_state.wrong_capacity), 0,
+		      "the segment above ran on another capacity");
+	zassert_equal(atomic_get(&segment_sink_state.wrong_capacity), 0);
+	zassert_equal(atomic_get(&segment_sink_state.corrupt_frames), 0);
+}
+
+ZTEST(audio_pipeline_frame_sizing, test_a_converter_declaring_no_stream_fails_the_start)
+{
+	converter_state.channels_above = 0U;
+
+	zassert_equal(audio_pipeline_init(&sizing_pipeline, &sizing_config, &segment_sink), 0,
+		      "init failed");
+	zassert_equal(audio_pipeline_set_format(&sizing_pipeline, &stereo_format), 0,
+		      "binding the stereo format failed");
+
+	/* Refused where a bound format would have been, at start() ... */
+	zassert_equal(audio_pipeline_start(&sizing_pipeline), -EINVAL,
+		      "a format with no channels was installed above the converter");
+
+	/* ... before anything above the converter opened, and with the chain
+	 * below it closed again.
+	 */
+	zassert_equal(atomic_get(&segment_filter_state.open_calls), 0);
+	zassert_equal(atomic_get(&segment_source_state.open_calls), 0);
+	zassert_equal(atomic_get(&segment_sink_state.open_calls), 1);
+	zassert_equal(atomic_get(&segment_sink_state.close_calls), 1);
+}
+
 ZTEST_SUITE(audio_pipeline_frame_sizing, NULL, NULL, frame_sizing_before, frame_sizing_after, NULL);
@@ -0,0 +1,342 @@
+/*
+ * Gain filter node (CONFIG_AUDIO_PIPELINE_NODE_GAIN_FILTER).
+ *
+ * Each filter sits on a stereo source that repeats one left and one right
+ * value, and is driven the way the pipeline thread drives it: the format
+ * installed, open(), process(), close(). The cases cover per-channel Q15 and
+ * Q31 gains, saturation above unity, the channel count check, and gains set
+ * with audio_gain_filter_set() while it runs - the ramps' shape, their
+ * continuity across frames, and a gain set on top of a ramp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+
+#include "fake_nodes.h"
+
+#define GAIN_FRAME_SAMPLES 22
+
+AUDIO_FAKE_SETS_SOURCE_DEFINE(lr_source);
+
+AUDIO_GAIN_FILTER_NODE_DEFINE(gain_x4, &lr_source, AUDIO_GAIN_UNITY_Q15 * 4);
+AUDIO_GAIN_FILTER_NODE_DEFINE(gain_default, &lr_source, 0);
+AUDIO_GAIN_FILTER_Q15_NODE_DEFINE(gain_lr_q15, &lr_source, AUDIO_GAIN_UNITY_Q15 / 2,
+				  AUDIO_GAIN_UNITY_Q15 * 2);
+AUDIO_GAIN_FILTER_Q15_NODE_DEFINE(gain_mute_right, &lr_source, AUDIO_GAIN_UNITY_Q15, 0);
+AUDIO_GAIN_FILTER_Q31_NODE_DEFINE(gain_lr_q31, &lr_source, INT32_MAX, -(1 << 29));
+AUDIO_GAIN_FILTER_Q15_NODE_DEFINE(gain_preset, &lr_source, AUDIO_GAIN_UNITY_Q15, 0);
+
+static const struct audio_stream_config stereo = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config mono = {
+	.sample_rate_hz = 48000U,
+	.channels = 1U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+/* One frame of @p left / @p right through @p filter; every sample set of it
+ * must come out as @p want_left / @p want_right.
+ */
+static void expect_frame(struct audio_node *filter, int32_t left, int32_t right,
+			 int32_t want_left, int32_t want_right)
+{
+	int32_t buf[GAIN_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t out_size;
+	size_t i;
+
+	audio_fake_sets_source_stereo(&lr_source_state, left, right, AUDIO_FAKE_ENDLESS);
+	filter->pipeline_format = &stereo;
+
+	zassert_equal(audio_node_open(filter), 0, "open failed");
+	zassert_equal(audio_node_process(filter, &view, &out_size), 0, "process failed");
+	zassert_equal(out_size, GAIN_FRAME_SAMPLES, "wrong frame size");
+
+	for (i = 0; i < out_size; i += 2U) {
+		zassert_equal(buf[i], want_left, "left %zu: %d, expected %d", i, buf[i], want_left);
+		zassert_equal(buf[i + 1U], want_right, "right %zu: %d, expected %d", i, buf[i + 1U],
+			      want_right);
+	}
+
+	zassert_equal(audio_node_close(filter), 0, "close failed");
+}
+
+ZTEST_SUITE(audio_pipeline_gain_filter, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_pipeline_gain_filter, test_each_channel_gets_its_own_q15_gain)
+{
+	expect_frame(&gain_lr_q15, 1000, -1000, 500, -2000);
+	expect_frame(&gain_lr_q15, -3, 7, -2, 14);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_each_channel_gets_its_own_q31_gain)
+{
+	const int32_t left = 0x12345678;
+	const int32_t right = -0x0FEDCBA9;
+
+	expect_frame(&gain_lr_q31, left, right, (int32_t)(((int64_t)left * INT32_MAX) >> 31),
+		     (int32_t)(((int64_t)right * -(1 << 29)) >> 31));
+}
+
+ZTEST(audio_pipeline_gain_filter, test_gain_above_unity_clips_instead_of_wrapping)
+{
+	/* Four times a quarter of full scale and a bit is past full scale both
+	 * ways; the old store back wrapped these to the opposite sign.
+	 */
+	expect_frame(&gain_x4, INT32_MAX / 4 + 1000, INT32_MIN / 4 - 1000, INT32_MAX, INT32_MIN);
+	expect_frame(&gain_lr_q15, INT32_MIN, INT32_MAX, INT32_MIN / 2, INT32_MAX);
+	expect_frame(&gain_x4, 1000, -1000, 4000, -4000);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_single_zero_is_unity_but_a_channel_zero_mutes)
+{
+	expect_frame(&gain_default, INT32_MAX, INT32_MIN, INT32_MAX, INT32_MIN);
+	expect_frame(&gain_mute_right, 1234, 5678, 1234, 0);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_gain_count_must_match_the_channels)
+{
+	gain_lr_q15.pipeline_format = &mono;
+	zassert_equal(audio_node_open(&gain_lr_q15), -ENOTSUP,
+		      "two gains opened on a mono stream");
+
+	gain_lr_q31.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&gain_lr_q31), -EINVAL,
+		      "a per-channel filter opened without a format");
+
+	/* One gain for every channel needs no format to open. */
+	gain_x4.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&gain_x4), 0, "a single gain needs no format");
+	zassert_equal(audio_node_close(&gain_x4), 0);
+}
+
+/* A gain set by the test while the filter runs, before frame @p at_frame. */
+struct gain_step {
+	size_t at_frame;
+	int32_t gain_q15;
+	uint32_t ramp_samples;
+	enum audio_gain_ramp ramp;
+};
+
+/* @p frames frames of @p left / @p right through @p filter, opened once, into
+ * @p out, with @p steps set between them.
+ */
+static void run_frames(struct audio_node *filter, int32_t left, int32_t right, int32_t *out,
+		       size_t frames, const struct gain_step *steps, size_t step_count)
+{
+	struct audio_buffer_view view;
+	size_t out_size;
+	size_t f;
+	size_t s;
+
+	audio_fake_sets_source_stereo(&lr_source_state, left, right, AUDIO_FAKE_ENDLESS);
+	filter->pipeline_format = &stereo;
+
+	zassert_equal(audio_node_open(filter), 0, "open failed");
+	for (f = 0; f < frames; f++) {
+		for (s = 0; s < step_count; s++) {
+			if (steps[s].at_frame == f) {
+				zassert_equal(audio_gain_filter_set(filter, steps[s].gain_q15,
+								    steps[s].ramp_samples,
+								    steps[s].ramp),
+					      0, "set failed");
+			}
+		}
+
+		view.data = &out[f * GAIN_FRAME_SAMPLES];
+		view.capacity = GAIN_FRAME_SAMPLES;
+		zassert_equal(audio_node_process(filter, &view, &out_size), 0, "process failed");
+		zassert_equal(out_size, GAIN_FRAME_SAMPLES, "wrong frame size");
+	}
+	zassert_equal(audio_node_close(filter), 0, "close failed");
+}
+
+/* Sample sets per frame, and a ramp that spans three frames without ending on
+ * a frame boundary.
+ */
+#define GAIN_FRAME_SETS (GAIN_FRAME_SAMPLES / 2)
+#define GAIN_RAMP_SETS  (GAIN_FRAME_SETS * 2 + 5)
+#define GAIN_RUN_FRAMES 4
+
+ZTEST(audio_pipeline_gain_filter, test_set_without_a_ramp_steps_at_the_next_frame)
+{
+	static const struct gain_step steps[] = {
+		{1, AUDIO_GAIN_UNITY_Q15 / 4, 0U, AUDIO_GAIN_RAMP_LINEAR},
+	};
+	int32_t out[GAIN_FRAME_SAMPLES * 2];
+	size_t i;
+
+	run_frames(&gain_x4, 1000, -1000, out, 2, steps, ARRAY_SIZE(steps));
+
+	for (i = 0; i < GAIN_FRAME_SAMPLES; i += 2U) {
+		zassert_equal(out[i], 4000);
+		zassert_equal(out[GAIN_FRAME_SAMPLES + i], 250);
+		zassert_equal(out[GAIN_FRAME_SAMPLES + i + 1U], -250);
+	}
+
+	/* Put the definition's gain back for the other cases. */
+	zassert_equal(audio_gain_filter_set(&gain_x4, AUDIO_GAIN_UNITY_Q15 * 4, 0U,
+					    AUDIO_GAIN_RAMP_LINEAR),
+		      0);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_linear_ramp_is_smooth_across_frames)
+{
+	static const struct gain_step steps[] = {
+		{1, 0, GAIN_RAMP_SETS, AUDIO_GAIN_RAMP_LINEAR},
+	};
+	const int32_t level = 1 << 24;
+	int32_t out[GAIN_FRAME_SAMPLES * GAIN_RUN_FRAMES];
+	int32_t want;
+	size_t set;
+
+	run_frames(&gain_default, level, -level, out, GAIN_RUN_FRAMES, steps, ARRAY_SIZE(steps));
+
+	zassert_equal(out[GAIN_FRAME_SAMPLES - 2U], level, "the ramp started early");
+
+	/* Set n of the ramp is scaled by 1 - n / GAIN_RAMP_SETS, give or take the
+	 * step's rounding, and both channels follow the one gain.
+	 */
+	for (set = 1; set <= GAIN_RAMP_SETS; set++) {
+		const size_t i = GAIN_FRAME_SAMPLES + (set - 1U) * 2U;
+
+		want = (int32_t)((int64_t)level * (GAIN_RAMP_SETS - set) / GAIN_RAMP_SETS);
+		zassert_within(out[i], want, 2, "set %zu: %d, expected %d", set, out[i], want);
+		zassert_within(out[i + 1U], -out[i], 1, "set %zu: channels differ", set);
+		zassert_true(out[i] <= out[i - 2U], "set %zu went back up", set);
+	}
+
+	/* It ends exactly on the new gain, and stays there. */
+	for (set = GAIN_RAMP_SETS; set < GAIN_FRAME_SETS * (GAIN_RUN_FRAMES - 1U); set++) {
+		zassert_equal(out[GAIN_FRAME_SAMPLES + set * 2U - 2U], 0, "set %zu not muted",
+			      set);
+	}
+
+	zassert_equal(audio_gain_filter_set(&gain_default, AUDIO_GAIN_UNITY_Q15, 0U,
+					    AUDIO_GAIN_RAMP_LINEAR),
+		      0);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_exponential_ramp_falls_in_db)
+{
+	static const struct gain_step steps[] = {
+		{1, 0, GAIN_RAMP_SETS, AUDIO_GAIN_RAMP_EXPONENTIAL},
+	};
+	const int32_t level = 1 << 24;
+	int32_t out[GAIN_FRAME_SAMPLES * GAIN_RUN_FRAMES];
+	const int32_t *ramp = &out[GAIN_FRAME_SAMPLES];
+	size_t set;
+
+	run_frames(&gain_default, level, level, out, GAIN_RUN_FRAMES, steps, ARRAY_SIZE(steps));
+
+	/* Every step takes the same fraction off, so the gain after sets 1 and 11
+	 * multiplies to what it is after set 6, squared.
+	 */
+	for (set = 1; set < GAIN_RAMP_SETS; set++) {
+		zassert_true(ramp[set * 2U] <= ramp[set * 2U - 2U], "set %zu went back up", set);
+	}
+	zassert_within((int64_t)ramp[0] * ramp[20], (int64_t)ramp[10] * ramp[10],
+		       (int64_t)ramp[10] * ramp[10] / 1000);
+
+	/* Past -60 dB before the last set, which lands exactly on the new gain. */
+	zassert_true(ramp[(GAIN_RAMP_SETS - 2U) * 2U] <= level / 1000, "%d left",
+		     ramp[(GAIN_RAMP_SETS - 2U) * 2U]);
+	zassert_equal(ramp[(GAIN_RAMP_SETS - 1U) * 2U], 0);
+
+	zassert_equal(audio_gain_filter_set(&gain_default, AUDIO_GAIN_UNITY_Q15, 0U,
+					    AUDIO_GAIN_RAMP_LINEAR),
+		      0);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_a_new_gain_mid_ramp_starts_where_the_ramp_is)
+{
+	static const struct gain_step steps[] = {
+		{0, 0, GAIN_FRAME_SETS * 4U, AUDIO_GAIN_RAMP_LINEAR},
+		{1, AUDIO_GAIN_UNITY_Q15, GAIN_FRAME_SETS, AUDIO_GAIN_RAMP_LINEAR},
+	};
+	const int32_t level = 1 << 24;
+	int32_t out[GAIN_FRAME_SAMPLES * 3];
+	size_t i;
+
+	run_frames(&gain_default, level, level, out, 3, steps, ARRAY_SIZE(steps));
+
+	/* Down a quarter of the way in the first frame, back up in the second:
+	 * no jump bigger than a step of either ramp anywhere.
+	 */
+	zassert_within(out[GAIN_FRAME_SAMPLES - 2U], level - level / 4, 2);
+	for (i = 2U; i < ARRAY_SIZE(out); i += 2U) {
+		zassert_within(out[i], out[i - 2U], level / GAIN_FRAME_SETS,
+			       "sample %zu jumped from %d to %d", i, out[i - 2U], out[i]);
+	}
+	zassert_equal(out[GAIN_FRAME_SAMPLES * 2 - 2], level);
+	zassert_equal(out[ARRAY_SIZE(out) - 1U], level);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_a_ramp_above_unity_clips_instead_of_wrapping)
+{
+	static const struct gain_step steps[] = {
+		{0, AUDIO_GAIN_UNITY_Q15 / 4, GAIN_FRAME_SETS * 2U, AUDIO_GAIN_RAMP_EXPONENTIAL},
+	};
+	int32_t out[GAIN_FRAME_SAMPLES * 2];
+	size_t i;
+
+	/* From four times to a quarter: full scale until the gain is back under
+	 * unity, never the opposite sign, and a quarter at the end.
+	 */
+	run_frames(&gain_x4, INT32_MAX / 2, INT32_MIN / 2, out, 2, steps, ARRAY_SIZE(steps));
+
+	zassert_equal(out[0], INT32_MAX);
+	zassert_equal(out[1], INT32_MIN);
+	for (i = 2U; i < ARRAY_SIZE(out); i += 2U) {
+		zassert_true(out[i] > 0 && out[i] <= out[i - 2U], "left %zu: %d", i, out[i]);
+		zassert_true(out[i + 1U] < 0, "right %zu: %d", i + 1U, out[i + 1U]);
+	}
+	zassert_equal(out[ARRAY_SIZE(out) - 2U], INT32_MAX / 8);
+	zassert_equal(out[ARRAY_SIZE(out) - 1U], INT32_MIN / 8);
+
+	zassert_equal(audio_gain_filter_set(&gain_x4, AUDIO_GAIN_UNITY_Q15 * 4, 0U,
+					    AUDIO_GAIN_RAMP_LINEAR),
+		      0);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_a_gain_set_while_closed_applies_at_open)
+{
+	/* Replaces both of the definition's per-channel gains, and is not lost
+	 * at close().
+	 */
+	zassert_equal(audio_gain_filter_set(&gain_preset, AUDIO_GAIN_UNITY_Q15 / 2, 1000U,
+					    AUDIO_GAIN_RAMP_EXPONENTIAL),
+		      0);
+	expect_frame(&gain_preset, 1000, 2000, 500, 1000);
+	expect_frame(&gain_preset, 1000, 2000, 500, 1000);
+}
+
+ZTEST(audio_pipeline_gain_filter, test_set_refuses_what_is_not_a_gain_filter)
+{
+	zassert_equal(audio_gain_filter_set(NULL, AUDIO_GAIN_UNITY_Q15, 0U,
+					    AUDIO_GAIN_RAMP_LINEAR),
+		      -EINVAL);
+	zassert_equal(audio_gain_filter_set(&lr_source, AUDIO_GAIN_UNITY_Q15, 0U,
+					    AUDIO_GAIN_RAMP_LINEAR),
+		      -EINVAL);
+	zassert_equal(audio_gain_filter_set(&gain_x4, AUDIO_GAIN_UNITY_Q15, 0U,
+					    (enum audio_gain_ramp)2),
+		      -EINVAL);
+}
@@ -0,0 +1,299 @@
+/*
+ * Interleave and deinterleave nodes (CONFIG_AUDIO_PIPELINE_NODE_INTERLEAVE),
+ * and the frame layouts a node declares.
+ *
+ * The node-level cases sit each converter on a source that makes a given
+ * number of sample sets, every channel of a set a value of its own, in
+ * whichever layout it is opened with, and then ends; they drive it the way
+ * the pipeline thread does, up to the end it reports. The kernels are held to
+ * their definition by the DSP suite, so the cases here are about the nodes'
+ * part: where each sample of a frame lands, the format published upstream,
+ * frames larger than the scratch, and the checks open() and process() make.
+ *
+ * The rest is about the declaration: audio_node_open() refuses a layout a
+ * node's ops do not name before the node sees it, and a whole pipeline runs
+ * an interleaved source through a planar biquad to an interleaved sink.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define IL_FRAME_SAMPLES 22
+#define IL_SETS		 300
+#define IL_CHANNELS	 3
+/* Room for every set, and for a frame past the end. */
+#define IL_OUT_SAMPLES	 (IL_CHANNELS * IL_SETS + 2 * CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES)
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+/* The value of channel @p c of set @p s, unique for every pair. */
+#define IL_VALUE(_c, _s) ((int32_t)((_c) * 100000 + (_s)))
+
+/* IL_VALUE()s in the layout of the format the source was opened with. */
+AUDIO_FAKE_SETS_SOURCE_DEFINE(il_source);
+
+AUDIO_DEINTERLEAVE_NODE_DEFINE(il_split, &il_source);
+AUDIO_INTERLEAVE_NODE_DEFINE(il_merge, &il_source);
+/* Declares no layouts, so interleaved only. */
+AUDIO_FAKE_SINK_DEFINE(il_plain_sink, &il_source);
+
+static const struct audio_stream_config three_interleaved = {
+	.sample_rate_hz = 48000U,
+	.channels = IL_CHANNELS,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config three_planar = {
+	.sample_rate_hz = 48000U,
+	.channels = IL_CHANNELS,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+	.layout = AUDIO_FRAME_LAYOUT_PLANAR,
+};
+
+static const struct audio_stream_config mono_planar = {
+	.sample_rate_hz = 48000U,
+	.channels = 1U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+	.layout = AUDIO_FRAME_LAYOUT_PLANAR,
+};
+
+static int32_t il_out[IL_OUT_SAMPLES];
+
+/* Script the source for IL_SETS sets of IL_VALUE()s, as many channels as
+ * the format it is opened with.
+ */
+static void script_sets(void)
+{
+	size_t c;
+
+	audio_fake_sets_source_reset(&il_source_state);
+	for (c = 0; c < ARRAY_SIZE(il_source_state.base); c++) {
+		il_source_state.base[c] = IL_VALUE(c, 0);
+	}
+	il_source_state.step = 1;
+	il_source_state.sets = IL_SETS;
+}
+
+/* Frames of @p frame samples from @p node, opened over the source at @p fmt,
+ * up to the end of the stream, each set checked against IL_VALUE(). Returns
+ * the sets out.
+ */
+static size_t run_sets(struct audio_node *node, const struct audio_stream_config *fmt,
+		       size_t frame)
+{
+	size_t sets;
+	size_t s;
+	size_t c;
+
+	script_sets();
+	sets = audio_fake_run_to_eof(node, fmt, frame, il_out, ARRAY_SIZE(il_out));
+	for (s = 0; s < sets; s++) {
+		for (c = 0; c < fmt->channels; c++) {
+			zassert_equal(il_out[s * fmt->channels + c], IL_VALUE(c, s),
+				      "set %zu, channel %zu: %d", s, c,
+				      il_out[s * fmt->channels + c]);
+		}
+	}
+	zassert_equal(atomic_get(&il_source_state.sets_done), IL_SETS, "%d sets pulled",
+		      (int)atomic_get(&il_source_state.sets_done));
+
+	return sets;
+}
+
+ZTEST_SUITE(audio_pipeline_interleave, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_pipeline_interleave, test_deinterleave_gives_each_channel_a_run)
+{
+	zassert_equal(run_sets(&il_split, &three_planar, IL_FRAME_SAMPLES), IL_SETS);
+	zassert_equal(il_split.upstream_format->layout, AUDIO_FRAME_LAYOUT_INTERLEAVED);
+	zassert_equal(il_split.upstream_format->channels, IL_CHANNELS);
+
+	/* A frame of more sets than the scratch holds takes several pulls. */
+	zassert_equal(run_sets(&il_split, &three_planar,
+			       2U * CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES + IL_CHANNELS),
+		      IL_SETS);
+}
+
+ZTEST(audio_pipeline_interleave, test_interleave_merges_the_runs)
+{
+	zassert_equal(run_sets(&il_merge, &three_interleaved, IL_FRAME_SAMPLES), IL_SETS);
+	zassert_equal(il_merge.upstream_format->layout, AUDIO_FRAME_LAYOUT_PLANAR);
+
+	zassert_equal(run_sets(&il_merge, &three_interleaved,
+			       2U * CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES + IL_CHANNELS),
+		      IL_SETS);
+}
+
+ZTEST(audio_pipeline_interleave, test_one_channel_only_changes_the_format)
+{
+	zassert_equal(run_sets(&il_split, &mono_planar, IL_FRAME_SAMPLES), IL_SETS);
+
+	/* Still published: an interleaved-only source has to be asked for
+	 * interleaved frames, whatever they look like.
+	 */
+	zassert_equal(il_split.upstream_format->layout, AUDIO_FRAME_LAYOUT_INTERLEAVED);
+}
+
+ZTEST(audio_pipeline_interleave, test_open_refuses_an_undeclared_layout)
+{
+	audio_fake_sink_reset(&il_plain_sink_state);
+
+	/* Refused by the core, before the node's own open() runs. */
+	il_plain_sink.pipeline_format = &three_planar;
+	zassert_equal(audio_node_open(&il_plain_sink), -ENOTSUP,
+		      "an interleaved-only node was opened planar");
+	zassert_equal(atomic_get(&il_plain_sink_state.open_calls), 0);
+
+	il_split.pipeline_format = &three_interleaved;
+	zassert_equal(audio_node_open(&il_split), -ENOTSUP,
+		      "a deinterleave node was opened interleaved");
+	il_merge.pipeline_format = &three_planar;
+	zassert_equal(audio_node_open(&il_merge), -ENOTSUP,
+		      "an interleave node was opened planar");
+
+	il_plain_sink.pipeline_format = &three_interleaved;
+	zassert_equal(audio_node_open(&il_plain_sink), 0);
+	zassert_equal(atomic_get(&il_plain_sink_state.open_calls), 1);
+	zassert_equal(audio_node_close(&il_plain_sink), 0);
+}
+
+ZTEST(audio_pipeline_interleave, test_open_and_process_check_the_frame)
+{
+	int32_t buf[IL_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t out_size;
+
+	il_split.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&il_split), -EINVAL, "opened without a format");
+
+	il_split.pipeline_format = &three_planar;
+	zassert_equal(audio_node_process(&il_split, &view, &out_size), -EBADF,
+		      "process() ran on a closed deinterleave node");
+
+	script_sets();
+	audio_fake_open_over_source(&il_split, &three_planar);
+	view.capacity = IL_CHANNELS - 1U;
+	zassert_equal(audio_node_process(&il_split, &view, &out_size), -EINVAL,
+		      "a frame of no whole set was filled");
+	zassert_equal(audio_node_close(&il_split), 0);
+}
+
+/* source -> deinterleave -> biquad (planar) -> interleave -> sink, all at
+ * 48 kHz stereo, run by a pipeline. The biquad delays each channel by one
+ * sample set, so a run that mixed the channels up would show in the output.
+ */
+#define IL_PIPELINE_FRAME_SAMPLES 32
+#define IL_PIPELINE_SETS	  100
+
+AUDIO_FAKE_SOURCE_DEFINE(il_fake_source);
+AUDIO_DEINTERLEAVE_NODE_DEFINE(il_chain_split, &il_fake_source);
+AUDIO_BIQUAD_NODE_DEFINE(il_chain_delay, &il_chain_split,
+			 AUDIO_BIQUAD_STAGE(0.0, 1.0, 0.0, 0.0, 0.0));
+AUDIO_INTERLEAVE_NODE_DEFINE(il_chain_merge, &il_chain_delay);
+
+/* The sink the chain ends in: interleaved only, and keeps what it is given. */
+AUDIO_FAKE_RECORD_SINK_DEFINE(il_record_sink, &il_chain_merge,
+			      2 * IL_PIPELINE_SETS + IL_PIPELINE_FRAME_SAMPLES);
+
+AUDIO_PIPELINE_DEFINE(il_pipeline, IL_PIPELINE_FRAME_SAMPLES, 2048, 5);
+AUDIO_PIPELINE_DEFINE(il_plain_pipeline, IL_PIPELINE_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config il_config = {
+	.frame_samples = IL_PIPELINE_FRAME_SAMPLES,
+};
+
+static const struct audio_stream_config stereo = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static int32_t il_samples[2 * IL_PIPELINE_SETS];
+
+ZTEST(audio_pipeline_interleave, test_planar_stretch_runs_in_a_pipeline)
+{
+	const int32_t *recorded = il_record_sink_samples;
+	const struct audio_stream_config *above;
+	struct audio_pipeline_event event;
+	size_t s;
+
+	for (s = 0; s < IL_PIPELINE_SETS; s++) {
+		il_samples[2U * s] = IL_VALUE(0, s + 1U);
+		il_samples[2U * s + 1U] = IL_VALUE(1, s + 1U);
+	}
+
+	audio_fake_source_reset(&il_fake_source_state);
+	il_fake_source_state.samples = il_samples;
+	il_fake_source_state.sample_count = ARRAY_SIZE(il_samples);
+	audio_fake_record_sink_reset(&il_record_sink_state);
+
+	zassert_equal(audio_pipeline_init(&il_pipeline, &il_config, &il_record_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&il_pipeline, &stereo), 0);
+	zassert_equal(audio_pipeline_start(&il_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&il_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&il_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "event %d", event.type);
+	(void)audio_pipeline_join(&il_pipeline);
+
+	/* Interleaved at both ends, planar between the converters, one frame
+	 * size throughout.
+	 */
+	above = atomic_ptr_get(&il_fake_source_state.seen_format);
+	zassert_not_null(above);
+	zassert_equal(above->layout, AUDIO_FRAME_LAYOUT_INTERLEAVED);
+	zassert_equal(il_chain_delay.pipeline_format->layout, AUDIO_FRAME_LAYOUT_PLANAR);
+	zassert_equal(il_fake_source.frame_capacity, IL_PIPELINE_FRAME_SAMPLES);
+
+	/* Every set, each channel one set late: set s carries s. */
+	zassert_equal(atomic_get(&il_record_sink_state.recorded), ARRAY_SIZE(il_samples));
+	zassert_equal(recorded[0], 0);
+	zassert_equal(recorded[1], 0);
+	for (s = 1; s < IL_PIPELINE_SETS; s++) {
+		zassert_equal(recorded[2U * s], IL_VALUE(0, s), "left %zu: %d", s,
+			      recorded[2U * s]);
+		zassert_equal(recorded[2U * s + 1U], IL_VALUE(1, s), "right %zu: %d", s,
+			      recorded[2U * s + 1U]);
+	}
+}
+
+ZTEST(audio_pipeline_interleave, test_format_names_a_layout)
+{
+	struct audio_stream_config bad = stereo;
+
+	audio_fake_sink_reset(&il_plain_sink_state);
+	zassert_equal(audio_pipeline_init(&il_plain_pipeline, &il_config, &il_plain_sink), 0);
+
+	bad.layout = (enum audio_frame_layout)(AUDIO_FRAME_LAYOUT_PLANAR + 1);
+	zassert_equal(audio_pipeline_set_format(&il_plain_pipeline, &bad), -EINVAL);
+
+	/* Planar all the way to a sink that only takes interleaved frames. */
+	bad.layout = AUDIO_FRAME_LAYOUT_PLANAR;
+	zassert_equal(audio_pipeline_set_format(&il_plain_pipeline, &bad), 0);
+	zassert_equal(audio_pipeline_start(&il_plain_pipeline), -ENOTSUP,
+		      "a chain started with a layout its sink does not take");
+	zassert_equal(atomic_get(&il_plain_sink_state.open_calls), 0);
+}
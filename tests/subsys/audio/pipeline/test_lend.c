@@ -0,0 +1,270 @@
+/*
+ * Frame storage lent by a node (spec §4.1.2).
+ *
+ * source -> filter -> sink, where the source and one of two sinks carry a lend
+ * op on top of the shared fakes. Each lender hands out a frame of its own, so
+ * the buffer the filter and the sink were handed says whose storage the chain
+ * ran in. The cases cover which end is asked, a source above a rate converter,
+ * a lender that declines, one that fails, and a two-stage run, which lends
+ * nothing.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define LEND_FRAME_SAMPLES 32
+#define LEND_PATTERN       0x0badf00d
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+/* What one lender hands out, and how often it was asked. */
+struct lend_script {
+	int32_t storage[LEND_FRAME_SAMPLES];
+	/* Returned by lend(); 0 lends @ref storage. */
+	int ret;
+	atomic_t lends;
+};
+
+static struct lend_script source_script;
+static struct lend_script sink_script;
+
+static int script_lend(struct lend_script *script, struct audio_buffer_view *buf)
+{
+	atomic_inc(&script->lends);
+
+	if (script->ret == 0) {
+		buf->data = script->storage;
+	}
+
+	return script->ret;
+}
+
+static int lending_source_open(struct audio_node *node)
+{
+	return audio_fake_source_ops.open(node);
+}
+
+static int lending_source_process(struct audio_node *node, struct audio_buffer_view *buf,
+				  size_t *out_size)
+{
+	return audio_fake_source_ops.process(node, buf, out_size);
+}
+
+static int lending_source_close(struct audio_node *node)
+{
+	return audio_fake_source_ops.close(node);
+}
+
+static int lending_source_lend(struct audio_node *node, struct audio_buffer_view *buf)
+{
+	ARG_UNUSED(node);
+
+	return script_lend(&source_script, buf);
+}
+
+static const struct audio_node_ops lending_source_ops = {
+	.open = lending_source_open,
+	.process = lending_source_process,
+	.close = lending_source_close,
+	.lend = lending_source_lend,
+};
+
+static int lending_sink_open(struct audio_node *node)
+{
+	return audio_fake_sink_ops.open(node);
+}
+
+static int lending_sink_process(struct audio_node *node, struct audio_buffer_view *buf,
+				size_t *out_size)
+{
+	return audio_fake_sink_ops.process(node, buf, out_size);
+}
+
+static int lending_sink_close(struct audio_node *node)
+{
+	return audio_fake_sink_ops.close(node);
+}
+
+static int lending_sink_lend(struct audio_node *node, struct audio_buffer_view *buf)
+{
+	ARG_UNUSED(node);
+
+	return script_lend(&sink_script, buf);
+}
+
+static const struct audio_node_ops lending_sink_ops = {
+	.open = lending_sink_open,
+	.process = lending_sink_process,
+	.close = lending_sink_close,
+	.lend = lending_sink_lend,
+};
+
+static struct audio_fake_source lend_source_state;
+AUDIO_NODE_DEFINE(lend_source, AUDIO_NODE_ROLE_SOURCE, &lending_source_ops, NULL,
+		  &lend_source_state);
+
+AUDIO_FAKE_FILTER_DEFINE(lend_filter, &lend_source);
+
+static struct audio_fake_sink lend_sink_state;
+AUDIO_NODE_DEFINE(lend_sink, AUDIO_NODE_ROLE_SINK, &lending_sink_ops, &lend_filter,
+		  &lend_sink_state);
+
+/* The same chain ending in a sink that has nothing to lend. */
+AUDIO_FAKE_SINK_DEFINE(plain_sink, &lend_filter);
+
+/* The lending source above a rate converter, which pulls into storage of its
+ * own.
+ */
+AUDIO_RESAMPLER_NODE_DEFINE(lend_converter, &lend_source, 44100U, FAST);
+AUDIO_FAKE_SINK_DEFINE(converted_sink, &lend_converter);
+
+AUDIO_PIPELINE_DEFINE(lend_pipeline, LEND_FRAME_SAMPLES, 2048, 5, 2);
+
+static const struct audio_pipeline_config lend_config = {
+	.frame_samples = LEND_FRAME_SAMPLES,
+};
+
+static const struct audio_pipeline_config lend_split_config = {
+	.frame_samples = LEND_FRAME_SAMPLES,
+	.split = &lend_filter,
+};
+
+static const struct audio_stream_config lend_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void lend_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&lend_source_state);
+	audio_fake_sink_reset(&lend_filter_state);
+	audio_fake_sink_reset(&lend_sink_state);
+	audio_fake_sink_reset(&plain_sink_state);
+	audio_fake_sink_reset(&converted_sink_state);
+
+	memset(&source_script, 0, sizeof(source_script));
+	memset(&sink_script, 0, sizeof(sink_script));
+
+	lend_source_state.frames_total = 3U;
+	lend_source_state.pattern = LEND_PATTERN;
+	lend_sink_state.check_pattern = true;
+	lend_sink_state.expect_pattern = LEND_PATTERN;
+	lend_sink_state.expect_capacity = LEND_FRAME_SAMPLES;
+	plain_sink_state.check_pattern = true;
+	plain_sink_state.expect_pattern = LEND_PATTERN;
+}
+
+static void lend_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&lend_pipeline);
+}
+
+static void run_until(const struct audio_pipeline_config *config, struct audio_node *sink,
+		      enum audio_pipeline_event_type type, int err)
+{
+	struct audio_pipeline_event event;
+
+	zassert_equal(audio_pipeline_init(&lend_pipeline, config, sink), 0);
+	zassert_equal(audio_pipeline_set_format(&lend_pipeline, &lend_format), 0);
+	zassert_equal(audio_pipeline_start(&lend_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&lend_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&lend_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, type, "expected event %d, got %d", type, event.type);
+	zassert_equal(event.err, err, "expected error %d, got %d", err, event.err);
+}
+
+ZTEST(audio_pipeline_lend, test_the_sink_lends_the_frame_storage)
+{
+	run_until(&lend_config, &lend_sink, AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	/* Every node worked in the sink's storage, the pipeline's stayed idle. */
+	zassert_equal(atomic_ptr_get(&lend_sink_state.seen_buf), sink_script.storage);
+	zassert_equal(atomic_ptr_get(&lend_filter_state.seen_buf), sink_script.storage);
+	zassert_equal(atomic_get(&lend_sink_state.frames_seen), 3);
+	zassert_equal(atomic_get(&lend_sink_state.corrupt_frames), 0);
+	zassert_equal(atomic_get(&lend_sink_state.wrong_capacity), 0, "lending moved the capacity");
+
+	/* Asked once per frame, the one that found the end included; the
+	 * source, which could lend too, was not asked at all.
+	 */
+	zassert_equal(atomic_get(&sink_script.lends), 4);
+	zassert_equal(atomic_get(&source_script.lends), 0, "the sink is asked first");
+}
+
+ZTEST(audio_pipeline_lend, test_the_source_lends_when_the_sink_cannot)
+{
+	run_until(&lend_config, &plain_sink, AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	zassert_equal(atomic_ptr_get(&plain_sink_state.seen_buf), source_script.storage);
+	zassert_equal(atomic_get(&plain_sink_state.frames_seen), 3);
+	zassert_equal(atomic_get(&plain_sink_state.corrupt_frames), 0);
+	zassert_equal(atomic_get(&source_script.lends), 4);
+}
+
+ZTEST(audio_pipeline_lend, test_a_source_above_a_converter_is_not_asked)
+{
+	run_until(&lend_config, &converted_sink, AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	/* The frames the sink saw are the converter's, not the source's. */
+	zassert_equal(atomic_ptr_get(&converted_sink_state.seen_buf), lend_pipeline.frame_buf);
+	zassert_true(atomic_get(&converted_sink_state.frames_seen) > 0);
+	zassert_equal(atomic_get(&source_script.lends), 0);
+}
+
+ZTEST(audio_pipeline_lend, test_a_declined_lend_uses_the_pipeline_buffer)
+{
+	sink_script.ret = -ENOTSUP;
+
+	run_until(&lend_config, &lend_sink, AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	zassert_equal(atomic_ptr_get(&lend_sink_state.seen_buf), lend_pipeline.frame_buf);
+	zassert_equal(atomic_get(&lend_sink_state.frames_seen), 3, "declining is not a failure");
+	zassert_equal(atomic_get(&sink_script.lends), 4, "a lender is asked again every frame");
+}
+
+ZTEST(audio_pipeline_lend, test_a_failing_lend_fails_the_frame)
+{
+	sink_script.ret = -EIO;
+
+	run_until(&lend_config, &lend_sink, AUDIO_PIPELINE_EVENT_ERROR, -EIO);
+
+	zassert_equal(atomic_get(&lend_sink_state.frames_seen), 0, "the frame was pulled anyway");
+	zassert_equal(atomic_get(&lend_source_state.frames_done), 0);
+	zassert_equal(atomic_get(&lend_sink_state.close_calls), 1);
+	zassert_equal(atomic_get(&lend_source_state.close_calls), 1);
+}
+
+ZTEST(audio_pipeline_lend, test_a_two_stage_run_lends_nothing)
+{
+	run_until(&lend_split_config, &lend_sink, AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	/* The frames live in the ring, filled and drained in place. */
+	zassert_equal(atomic_get(&lend_sink_state.frames_seen), 3);
+	zassert_equal(atomic_get(&lend_sink_state.corrupt_frames), 0);
+	zassert_equal(atomic_get(&sink_script.lends), 0);
+	zassert_equal(atomic_get(&source_script.lends), 0);
+}
+
+ZTEST_SUITE(audio_pipeline_lend, NULL, NULL, lend_before, lend_after, NULL);
@@ -0,0 +1,164 @@
+/*
+ * Real-time headroom (spec §8.5, CONFIG_AUDIO_PIPELINE_LOAD_MONITOR).
+ *
+ * source -> busy filter -> sink, where the filter busy-waits a set time on
+ * every frame it passes on, against the 333 us a 32 sample stereo frame lasts
+ * at 48 kHz. prj.conf closes a window every four frames, so a track of eight
+ * covers two of them: enough to see that a load held above the threshold is
+ * reported once, not once per window.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define LOAD_FRAME_SAMPLES 32
+#define LOAD_FRAMES        (2 * CONFIG_AUDIO_PIPELINE_LOAD_WINDOW)
+
+/* ~30 % and ~75 % of the frame period, either side of the threshold. */
+#define LOAD_LIGHT_US 100U
+#define LOAD_HEAVY_US 250U
+
+#define LOAD_THRESHOLD 50U
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+static uint32_t busy_us;
+
+AUDIO_FAKE_SOURCE_DEFINE(load_source);
+
+static int busy_process(struct audio_node *node, struct audio_buffer_view *buf,
+			size_t *out_size)
+{
+	int ret = audio_node_pull(node, buf, out_size);
+
+	if (ret == 0 && *out_size > 0) {
+		k_busy_wait(busy_us);
+	}
+
+	return ret;
+}
+
+static const struct audio_node_ops busy_ops = {
+	.process = busy_process,
+};
+
+AUDIO_NODE_DEFINE(load_busy, AUDIO_NODE_ROLE_FILTER, &busy_ops, &load_source, NULL);
+
+AUDIO_FAKE_SINK_DEFINE(load_sink, &load_busy);
+
+AUDIO_PIPELINE_DEFINE(load_pipeline, LOAD_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config load_config = {
+	.frame_samples = LOAD_FRAME_SAMPLES,
+	.overload_percent = LOAD_THRESHOLD,
+};
+
+static const struct audio_pipeline_config load_quiet_config = {
+	.frame_samples = LOAD_FRAME_SAMPLES,
+};
+
+static const struct audio_stream_config load_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void load_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&load_source_state);
+	audio_fake_sink_reset(&load_sink_state);
+
+	load_source_state.frames_total = LOAD_FRAMES;
+}
+
+static void load_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&load_pipeline);
+}
+
+static void start_load(const struct audio_pipeline_config *config, uint32_t us)
+{
+	busy_us = us;
+
+	zassert_equal(audio_pipeline_init(&load_pipeline, config, &load_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&load_pipeline, &load_format), 0);
+	zassert_equal(audio_pipeline_start(&load_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&load_pipeline), 0, "play failed");
+}
+
+static void expect_event(enum audio_pipeline_event_type type)
+{
+	struct audio_pipeline_event event;
+
+	zassert_equal(audio_pipeline_get_event(&load_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, type, "expected event %d, got %d", type, event.type);
+	zassert_equal(event.err, 0);
+}
+
+ZTEST(audio_pipeline_load, test_a_light_chain_stays_quiet)
+{
+	struct audio_pipeline_load_stats stats;
+
+	start_load(&load_config, LOAD_LIGHT_US);
+	expect_event(AUDIO_PIPELINE_EVENT_EOF);
+
+	zassert_equal(audio_pipeline_get_load_stats(&load_pipeline, &stats), 0);
+	zassert_equal(stats.frames, LOAD_FRAMES, "the empty frame at the end was counted");
+	zassert_true(stats.load_percent >= 25U && stats.load_percent < LOAD_THRESHOLD,
+		     "load %u %%", stats.load_percent);
+	zassert_true(stats.worst_percent >= stats.load_percent);
+	zassert_true(stats.peak_percent >= stats.worst_percent);
+	zassert_equal(stats.overloads, 0);
+}
+
+ZTEST(audio_pipeline_load, test_an_overload_is_raised_once)
+{
+	struct audio_pipeline_load_stats stats;
+
+	start_load(&load_config, LOAD_HEAVY_US);
+
+	/* Both windows are over the threshold; only the first says so. */
+	expect_event(AUDIO_PIPELINE_EVENT_OVERLOAD);
+	expect_event(AUDIO_PIPELINE_EVENT_EOF);
+
+	zassert_equal(audio_pipeline_get_load_stats(&load_pipeline, &stats), 0);
+	zassert_true(stats.load_percent >= LOAD_THRESHOLD, "load %u %%", stats.load_percent);
+	zassert_true(stats.peak_percent < 100U, "the busy wait overran the frame");
+	zassert_equal(stats.overloads, 1);
+}
+
+ZTEST(audio_pipeline_load, test_no_threshold_only_measures)
+{
+	struct audio_pipeline_load_stats stats;
+
+	start_load(&load_quiet_config, LOAD_HEAVY_US);
+	expect_event(AUDIO_PIPELINE_EVENT_EOF);
+
+	zassert_equal(audio_pipeline_get_load_stats(&load_pipeline, &stats), 0);
+	zassert_equal(stats.frames, LOAD_FRAMES);
+	zassert_true(stats.load_percent >= LOAD_THRESHOLD);
+	zassert_equal(stats.overloads, 0);
+
+	zassert_equal(audio_pipeline_get_load_stats(&load_pipeline, NULL), -EINVAL);
+	zassert_equal(audio_pipeline_get_load_stats(NULL, &stats), -EINVAL);
+}
+
+ZTEST_SUITE(audio_pipeline_load, NULL, NULL, load_before, load_after, NULL);
@@ -0,0 +1,203 @@
+/*
+ * Mixer node (spec §4.6, CONFIG_AUDIO_PIPELINE_NODE_MIXER).
+ *
+ * Two scripted sources into one mixer into the counting sink. Each source
+ * stamps a constant into its frames, so the mix of a frame is a constant too
+ * and the sink can check it sample by sample. The cases cover the gains, the
+ * saturation, inputs that end at different times, errors and open failures
+ * on one input, and a frame the scratch cannot hold.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_dsp.h>
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define MIX_FRAME_SAMPLES 32
+#define MIX_PATTERN_A     0x01000000
+#define MIX_PATTERN_B     0x03000000
+/* A at unity plus B at half gain. */
+#define MIX_PATTERN_AB    (MIX_PATTERN_A + MIX_PATTERN_B / 2)
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SOURCE_DEFINE(mix_source_a);
+AUDIO_FAKE_SOURCE_DEFINE(mix_source_b);
+
+AUDIO_MIXER_NODE_DEFINE(mixer, MIX_FRAME_SAMPLES,
+			AUDIO_MIXER_INPUT(&mix_source_a, AUDIO_DSP_UNITY_Q15),
+			AUDIO_MIXER_INPUT(&mix_source_b, AUDIO_DSP_UNITY_Q15 / 2));
+
+AUDIO_FAKE_SINK_DEFINE(mix_sink, &mixer);
+
+/* Scratch for half the pipeline's frame: the second input has nowhere to go. */
+AUDIO_MIXER_NODE_DEFINE(small_mixer, MIX_FRAME_SAMPLES / 2,
+			AUDIO_MIXER_INPUT(&mix_source_a, AUDIO_DSP_UNITY_Q15),
+			AUDIO_MIXER_INPUT(&mix_source_b, AUDIO_DSP_UNITY_Q15 / 2));
+
+AUDIO_FAKE_SINK_DEFINE(small_mix_sink, &small_mixer);
+
+AUDIO_PIPELINE_DEFINE(mix_pipeline, MIX_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config mix_config = {
+	.frame_samples = MIX_FRAME_SAMPLES,
+};
+
+static const struct audio_stream_config mix_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void mix_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&mix_source_a_state);
+	audio_fake_source_reset(&mix_source_b_state);
+	audio_fake_sink_reset(&mix_sink_state);
+
+	mix_source_a_state.pattern = MIX_PATTERN_A;
+	mix_source_b_state.pattern = MIX_PATTERN_B;
+	mix_sink_state.check_pattern = true;
+	mix_sink_state.expect_pattern = MIX_PATTERN_AB;
+	mix_sink_state.expect_capacity = MIX_FRAME_SAMPLES;
+}
+
+static void mix_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&mix_pipeline);
+}
+
+static int start_mix(void)
+{
+	zassert_equal(audio_pipeline_init(&mix_pipeline, &mix_config, &mix_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&mix_pipeline, &mix_format), 0);
+
+	return audio_pipeline_start(&mix_pipeline);
+}
+
+static void play_until(enum audio_pipeline_event_type type, int err)
+{
+	struct audio_pipeline_event event;
+
+	zassert_equal(audio_pipeline_play(&mix_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&mix_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, type, "expected event %d, got %d", type, event.type);
+	zassert_equal(event.err, err, "expected error %d, got %d", err, event.err);
+}
+
+ZTEST(audio_pipeline_mixer, test_inputs_are_summed_at_their_gains)
+{
+	mix_source_a_state.frames_total = 5U;
+	mix_source_b_state.frames_total = 5U;
+
+	zassert_equal(start_mix(), 0, "start failed");
+	play_until(AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	zassert_equal(atomic_get(&mix_sink_state.frames_seen), 5);
+	zassert_equal(atomic_get(&mix_sink_state.corrupt_frames), 0, "a frame was mixed wrong");
+	zassert_equal(atomic_get(&mix_sink_state.wrong_capacity), 0);
+
+	/* The mixer opened both input chains, at the pipeline's format. */
+	zassert_equal(atomic_get(&mix_source_a_state.open_calls), 1);
+	zassert_equal(atomic_get(&mix_source_b_state.open_calls), 1);
+	zassert_not_null(atomic_ptr_get(&mix_source_b_state.seen_format));
+}
+
+ZTEST(audio_pipeline_mixer, test_sum_saturates)
+{
+	mix_source_a_state.frames_total = 2U;
+	mix_source_b_state.frames_total = 2U;
+	mix_source_a_state.pattern = INT32_MAX - 1;
+	mix_source_b_state.pattern = INT32_MAX;
+	mix_sink_state.expect_pattern = INT32_MAX;
+
+	zassert_equal(start_mix(), 0, "start failed");
+	play_until(AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	zassert_equal(atomic_get(&mix_sink_state.frames_seen), 2);
+	zassert_equal(atomic_get(&mix_sink_state.corrupt_frames), 0, "the sum wrapped");
+}
+
+ZTEST(audio_pipeline_mixer, test_an_ended_input_does_not_stall_the_mix)
+{
+	mix_source_a_state.frames_total = 3U;
+	mix_source_b_state.frames_total = 8U;
+
+	zassert_equal(start_mix(), 0, "start failed");
+	play_until(AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	/* Eight frames: three of A + B, then five of B alone. */
+	zassert_equal(atomic_get(&mix_sink_state.frames_seen), 8, "the mix ended with A");
+	zassert_equal(atomic_get(&mix_sink_state.corrupt_frames), 5);
+	zassert_equal(atomic_get(&mix_sink_state.eof_seen), 1);
+
+	/* The next track starts with both inputs live again. */
+	audio_fake_source_rewind(&mix_source_a_state);
+	audio_fake_source_rewind(&mix_source_b_state);
+	mix_source_b_state.frames_total = 3U;
+	play_until(AUDIO_PIPELINE_EVENT_EOF, 0);
+	zassert_equal(atomic_get(&mix_sink_state.frames_seen), 11);
+	zassert_equal(atomic_get(&mix_sink_state.corrupt_frames), 5, "input A was left out");
+}
+
+ZTEST(audio_pipeline_mixer, test_input_error_fails_the_mix)
+{
+	mix_source_a_state.frames_total = AUDIO_FAKE_ENDLESS;
+	mix_source_b_state.frames_total = AUDIO_FAKE_ENDLESS;
+	mix_source_b_state.fail_at_frame = 3U;
+	mix_source_b_state.process_ret = -EIO;
+
+	zassert_equal(start_mix(), 0, "start failed");
+	play_until(AUDIO_PIPELINE_EVENT_ERROR, -EIO);
+
+	zassert_equal(atomic_get(&mix_sink_state.frames_seen), 2);
+	zassert_equal(atomic_get(&mix_source_a_state.close_calls), 1);
+	zassert_equal(atomic_get(&mix_source_b_state.close_calls), 1);
+}
+
+ZTEST(audio_pipeline_mixer, test_input_open_failure_unwinds)
+{
+	mix_source_b_state.open_ret = -EIO;
+
+	zassert_equal(start_mix(), -EIO, "an input failed to open unnoticed");
+	zassert_equal(atomic_get(&mix_source_a_state.open_calls), 1);
+	zassert_equal(atomic_get(&mix_source_a_state.close_calls), 1, "input A was left open");
+	zassert_false(audio_pipeline_is_running(&mix_pipeline));
+}
+
+ZTEST(audio_pipeline_mixer, test_open_refuses_a_frame_larger_than_the_scratch)
+{
+	audio_fake_sink_reset(&small_mix_sink_state);
+
+	zassert_equal(audio_pipeline_init(&mix_pipeline, &mix_config, &small_mix_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&mix_pipeline, &mix_format), 0);
+
+	/* Refused at the start, not as -ENOBUFS once the stream runs. */
+	zassert_equal(audio_pipeline_start(&mix_pipeline), -EINVAL,
+		      "a frame larger than the scratch was accepted");
+	zassert_equal(atomic_get(&mix_source_a_state.open_calls), 0, "an input was opened");
+	zassert_equal(atomic_get(&small_mix_sink_state.close_calls), 1, "the sink was left open");
+	zassert_false(audio_pipeline_is_running(&mix_pipeline));
+}
+
+ZTEST_SUITE(audio_pipeline_mixer, NULL, NULL, mix_before, mix_after, NULL);
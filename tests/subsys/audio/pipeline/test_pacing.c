@@ -0,0 +1,206 @@
+/*
+ * Timer-paced worker mode (spec §3.2, CONFIG_AUDIO_PIPELINE_PACED).
+ *
+ * A fake source feeding a fake sink never blocks, so an unpaced worker runs the
+ * whole stream in one burst. These cases run the same chain paced and check the
+ * wall-clock length of the stream against the length of the audio it carried,
+ * that a frame period which is not a whole number of ticks does not drift, and
+ * that a sink slower than real time is counted as missing its deadlines.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define PACED_FRAME_SAMPLES 64
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SOURCE_DEFINE(paced_source);
+AUDIO_FAKE_SINK_DEFINE(paced_sink, &paced_source);
+
+AUDIO_PIPELINE_DEFINE(paced_pipeline, PACED_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config paced_config = {
+	.frame_samples = PACED_FRAME_SAMPLES,
+	.paced = true,
+};
+
+static const struct audio_pipeline_config unpaced_config = {
+	.frame_samples = PACED_FRAME_SAMPLES,
+};
+
+/* 64 total samples of stereo at 8 kHz is 32 sample pairs: 4 ms per frame, a
+ * whole number of ticks at every common tick rate.
+ */
+static const struct audio_stream_config format_8k = {
+	.sample_rate_hz = 8000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+/* 32 sample pairs at 48 kHz is 666.7 us per frame, which no tick rate divides:
+ * a timer re-armed by a rounded period would drift by the rounding every frame.
+ */
+static const struct audio_stream_config format_48k = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void paced_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&paced_source_state);
+	audio_fake_sink_reset(&paced_sink_state);
+}
+
+static void paced_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_stop(&paced_pipeline);
+	(void)audio_pipeline_join(&paced_pipeline);
+}
+
+/* Start @p config at @p fmt, play to end of stream, return the elapsed ms. */
+static int64_t run_to_eof(const struct audio_pipeline_config *config,
+			  const struct audio_stream_config *fmt)
+{
+	struct audio_pipeline_event event;
+	int64_t start;
+	int ret;
+
+	zassert_equal(audio_pipeline_init(&paced_pipeline, config, &paced_sink), 0,
+		      "init failed");
+	zassert_equal(audio_pipeline_set_format(&paced_pipeline, fmt), 0,
+		      "binding the format failed");
+	zassert_equal(audio_pipeline_start(&paced_pipeline), 0, "start failed");
+
+	start = k_uptime_get();
+	zassert_equal(audio_pipeline_play(&paced_pipeline), 0, "play failed");
+
+	ret = audio_pipeline_get_event(&paced_pipeline, &event, TEST_EVENT_TIMEOUT);
+	zassert_equal(ret, 0, "no event before the timeout (%d)", ret);
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "expected EOF, got %d", event.type);
+
+	return k_uptime_get() - start;
+}
+
+ZTEST(audio_pipeline_pacing, test_paced_stream_takes_its_own_duration)
+{
+	struct audio_pipeline_pacing_stats stats;
+	int64_t elapsed;
+
+	/* 25 frames of 4 ms: the end of stream is due 100 ms after play(). */
+	paced_source_state.frames_total = 25U;
+
+	elapsed = run_to_eof(&paced_config, &format_8k);
+
+	zassert_true(elapsed >= 99 && elapsed <= 110,
+		     "25 paced 4 ms frames took %lld ms, not ~100 ms", elapsed);
+	zassert_equal(atomic_get(&paced_sink_state.frames_seen), 25, "frames lost");
+
+	zassert_equal(audio_pipeline_get_pacing_stats(&paced_pipeline, &stats), 0,
+		      "stats refused on a paced pipeline");
+	zassert_equal(stats.frames, 25U, "paced frame count %u", stats.frames);
+	zassert_equal(stats.deadline_misses, 0U, "an idle chain missed %u deadlines",
+		      stats.deadline_misses);
+}
+
+ZTEST(audio_pipeline_pacing, test_fractional_period_does_not_drift)
+{
+	int64_t elapsed;
+
+	/* 120 frames of 666.7 us are 80 ms of audio. Rounding the period to a
+	 * whole tick once and adding it up would be off by up to a tick per
+	 * frame - several milliseconds over this run.
+	 */
+	paced_source_state.frames_total = 120U;
+
+	elapsed = run_to_eof(&paced_config, &format_48k);
+
+	zassert_true(elapsed >= 79 && elapsed <= 82,
+		     "120 paced frames of 80 ms audio took %lld ms", elapsed);
+}
+
+ZTEST(audio_pipeline_pacing, test_slow_sink_misses_deadlines)
+{
+	struct audio_pipeline_pacing_stats stats;
+
+	/* Every frame costs 6 ms against a 4 ms period. */
+	paced_source_state.frames_total = 10U;
+	paced_sink_state.busy_us = 6000U;
+
+	(void)run_to_eof(&paced_config, &format_8k);
+
+	zassert_equal(audio_pipeline_get_pacing_stats(&paced_pipeline, &stats), 0,
+		      "stats refused on a paced pipeline");
+	zassert_equal(stats.frames, 10U, "paced frame count %u", stats.frames);
+	zassert_equal(stats.deadline_misses, 10U, "%u of 10 slow frames counted as late",
+		      stats.deadline_misses);
+	zassert_true(stats.max_lateness_us >= 1000U, "worst lateness of %u us is too small",
+		     stats.max_lateness_us);
+}
+
+ZTEST(audio_pipeline_pacing, test_stop_and_play_restart_the_timeline)
+{
+	struct audio_pipeline_event event;
+	int64_t start;
+
+	paced_source_state.frames_total = 20U;
+
+	zassert_equal(audio_pipeline_init(&paced_pipeline, &paced_config, &paced_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&paced_pipeline, &format_8k), 0);
+	zassert_equal(audio_pipeline_start(&paced_pipeline), 0);
+	zassert_equal(audio_pipeline_play(&paced_pipeline), 0);
+
+	k_msleep(20);
+	zassert_equal(audio_pipeline_stop(&paced_pipeline), 0);
+	/* An idle gap far longer than the rest of the stream. */
+	k_msleep(200);
+
+	/* A worker that kept the old timeline would burst through the frames
+	 * it "owes" for the gap and reach end of stream at once.
+	 */
+	start = k_uptime_get();
+	zassert_equal(audio_pipeline_play(&paced_pipeline), 0);
+	zassert_equal(audio_pipeline_get_event(&paced_pipeline, &event, TEST_EVENT_TIMEOUT), 0);
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF);
+	zassert_true(k_uptime_get() - start >= 40,
+		     "the frames left after the gap were not paced");
+	zassert_equal(atomic_get(&paced_sink_state.frames_seen), 20, "frames lost");
+}
+
+ZTEST(audio_pipeline_pacing, test_unpaced_pipeline_has_no_pacing_stats)
+{
+	struct audio_pipeline_pacing_stats stats;
+	struct audio_pipeline uninitialised = {0};
+
+	paced_source_state.frames_total = 4U;
+	(void)run_to_eof(&unpaced_config, &format_8k);
+
+	zassert_equal(audio_pipeline_get_pacing_stats(&paced_pipeline, &stats), -ENOTSUP,
+		      "an unpaced pipeline reported pacing statistics");
+	zassert_equal(audio_pipeline_get_pacing_stats(&paced_pipeline, NULL), -EINVAL);
+	zassert_equal(audio_pipeline_get_pacing_stats(NULL, &stats), -EINVAL);
+	zassert_equal(audio_pipeline_get_pacing_stats(&uninitialised, &stats), -EINVAL);
+}
+
+ZTEST_SUITE(audio_pipeline_pacing, NULL, NULL, paced_before, paced_after, NULL);
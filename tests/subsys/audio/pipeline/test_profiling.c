@@ -0,0 +1,226 @@
+/*
+ * Cycle profiling (spec §8.4, CONFIG_AUDIO_PIPELINE_PROFILING).
+ *
+ * source -> busy filter -> sink, where the filter busy-waits a fixed time on
+ * every frame it passes on. On native_sim the cycle counter only moves while
+ * something waits, so the filter's own work is the whole frame: the cases
+ * check that its exclusive figure carries that time and the nodes around it
+ * do not, that the frame is held against its budget, and that a profile
+ * covers one run.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/time_units.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define PROF_FRAME_SAMPLES 32
+#define PROF_FRAMES        4
+#define PROF_RATE_HZ       48000U
+#define PROF_CHANNELS      2U
+
+/* Longer than the 333 us a 32 sample stereo frame lasts at 48 kHz. */
+#define PROF_BUSY_US 500U
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SOURCE_DEFINE(prof_source);
+
+static int busy_process(struct audio_node *node, struct audio_buffer_view *buf,
+			size_t *out_size)
+{
+	int ret = audio_node_pull(node, buf, out_size);
+
+	if (ret == 0 && *out_size > 0) {
+		k_busy_wait(PROF_BUSY_US);
+	}
+
+	return ret;
+}
+
+static const struct audio_node_ops busy_ops = {
+	.process = busy_process,
+};
+
+AUDIO_NODE_DEFINE(prof_busy, AUDIO_NODE_ROLE_FILTER, &busy_ops, &prof_source, NULL);
+
+AUDIO_FAKE_SINK_DEFINE(prof_sink, &prof_busy);
+
+AUDIO_PIPELINE_DEFINE(prof_pipeline, PROF_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config prof_config = {
+	.frame_samples = PROF_FRAME_SAMPLES,
+};
+
+static const struct audio_stream_config prof_format = {
+	.sample_rate_hz = PROF_RATE_HZ,
+	.channels = PROF_CHANNELS,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void prof_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&prof_source_state);
+	audio_fake_sink_reset(&prof_sink_state);
+
+	prof_source_state.frames_total = PROF_FRAMES;
+}
+
+static void prof_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&prof_pipeline);
+}
+
+static void start_prof(void)
+{
+	zassert_equal(audio_pipeline_init(&prof_pipeline, &prof_config, &prof_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&prof_pipeline, &prof_format), 0);
+	zassert_equal(audio_pipeline_start(&prof_pipeline), 0, "start failed");
+}
+
+static void play_to_eof(void)
+{
+	struct audio_pipeline_event event;
+
+	zassert_equal(audio_pipeline_play(&prof_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&prof_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "expected EOF, got %d", event.type);
+}
+
+/* Every distribution is internally consistent, whatever it measured. */
+static void check_distribution(const struct audio_profile_stats *stats)
+{
+	uint32_t total = 0;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(stats->histogram); i++) {
+		total += stats->histogram[i];
+	}
+
+	zassert_equal(total, stats->count, "the histogram lost a sample");
+	zassert_true(stats->min_cycles <= stats->avg_cycles);
+	zassert_true(stats->avg_cycles <= stats->max_cycles);
+}
+
+ZTEST(audio_pipeline_profiling, test_a_node_is_charged_its_own_work_only)
+{
+	struct audio_node_stats nodes[4];
+	struct audio_pipeline_stats stats;
+	size_t count = ARRAY_SIZE(nodes);
+	uint32_t busy = k_us_to_cyc_floor32(PROF_BUSY_US);
+	size_t i;
+
+	start_prof();
+	play_to_eof();
+
+	zassert_equal(audio_pipeline_get_stats(&prof_pipeline, &stats, nodes, &count), 0);
+
+	/* The chain, sink first. */
+	zassert_equal(count, 3);
+	zassert_equal_ptr(nodes[0].node, &prof_sink);
+	zassert_equal_ptr(nodes[1].node, &prof_busy);
+	zassert_equal_ptr(nodes[2].node, &prof_source);
+
+	/* Every frame and the pull that found the end, on every node. */
+	zassert_equal(stats.frame.count, PROF_FRAMES + 1);
+	for (i = 0; i < count; i++) {
+		zassert_equal(nodes[i].inclusive.count, PROF_FRAMES + 1, "node %zu", i);
+		zassert_equal(nodes[i].exclusive.count, PROF_FRAMES + 1, "node %zu", i);
+		check_distribution(&nodes[i].inclusive);
+		check_distribution(&nodes[i].exclusive);
+	}
+	check_distribution(&stats.frame);
+
+	/* The wait is the filter's own work, and the sink's only through its
+	 * pull; the source upstream of it never saw it.
+	 */
+	zassert_true(nodes[1].exclusive.max_cycles >= busy, "the filter lost its own cycles");
+	zassert_true(nodes[0].inclusive.max_cycles >= busy);
+	zassert_true(nodes[0].exclusive.max_cycles < busy, "the sink was charged its upstream");
+	zassert_true(nodes[2].inclusive.max_cycles < busy);
+	zassert_true(stats.frame.max_cycles >= busy);
+}
+
+ZTEST(audio_pipeline_profiling, test_frames_are_held_against_the_budget)
+{
+	struct audio_pipeline_stats stats;
+	uint32_t budget = (uint32_t)((uint64_t)(PROF_FRAME_SAMPLES / PROF_CHANNELS) *
+				     sys_clock_hw_cycles_per_sec() / PROF_RATE_HZ);
+
+	start_prof();
+	play_to_eof();
+
+	zassert_equal(audio_pipeline_get_stats(&prof_pipeline, &stats, NULL, NULL), 0);
+	zassert_equal(stats.budget_cycles, budget, "budget %u, expected %u", stats.budget_cycles,
+		      budget);
+
+	/* Every frame with audio in it waited past its period; the empty one
+	 * that ended the stream did not.
+	 */
+	zassert_equal(stats.over_budget, PROF_FRAMES);
+}
+
+ZTEST(audio_pipeline_profiling, test_a_profile_covers_one_run)
+{
+	struct audio_node_stats node;
+	struct audio_pipeline_stats stats;
+
+	start_prof();
+	play_to_eof();
+
+	zassert_equal(audio_pipeline_reset_stats(&prof_pipeline), 0);
+	zassert_equal(audio_pipeline_get_stats(&prof_pipeline, &stats, NULL, NULL), 0);
+	zassert_equal(stats.frame.count, 0);
+	zassert_equal(stats.over_budget, 0);
+	zassert_equal(audio_node_get_stats(&prof_busy, &node), 0);
+	zassert_equal(node.exclusive.count, 0, "a reset left a node counting");
+
+	/* Counting resumes with the next track ... */
+	audio_fake_source_rewind(&prof_source_state);
+	play_to_eof();
+	zassert_equal(audio_node_get_stats(&prof_busy, &node), 0);
+	zassert_equal(node.inclusive.count, PROF_FRAMES + 1);
+
+	/* ... and a new start begins a new profile. */
+	zassert_equal(audio_pipeline_join(&prof_pipeline), 0);
+	start_prof();
+	zassert_equal(audio_node_get_stats(&prof_busy, &node), 0);
+	zassert_equal(node.inclusive.count, 0, "a restart inherited the last run's profile");
+}
+
+ZTEST(audio_pipeline_profiling, test_a_short_array_still_reports_the_chain)
+{
+	struct audio_node_stats nodes[1];
+	struct audio_pipeline_stats stats;
+	size_t count = ARRAY_SIZE(nodes);
+
+	start_prof();
+
+	zassert_equal(audio_pipeline_get_stats(&prof_pipeline, &stats, nodes, &count), 0);
+	zassert_equal(count, 3, "the chain length is reported in full");
+	zassert_equal_ptr(nodes[0].node, &prof_sink);
+
+	zassert_equal(audio_pipeline_get_stats(&prof_pipeline, &stats, nodes, NULL), -EINVAL);
+	zassert_equal(audio_node_get_stats(NULL, &nodes[0]), -EINVAL);
+	zassert_equal(audio_node_get_stats(&prof_sink, NULL), -EINVAL);
+}
+
+ZTEST_SUITE(audio_pipeline_profiling, NULL, NULL, prof_before, prof_after, NULL);
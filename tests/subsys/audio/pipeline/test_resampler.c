@@ -0,0 +1,296 @@
+/*
+ * Resampler node (CONFIG_AUDIO_PIPELINE_NODE_RESAMPLER).
+ *
+ * The node-level cases sit each converter on a stereo source that repeats one
+ * left and one right value for a given number of sample sets and then ends,
+ * and drive it the way the pipeline thread does, up to the end it reports. The
+ * kernel is held to its definition by the DSP suite, so the cases here are
+ * about the node's part: the count of outputs the ratio makes, unity gain at
+ * DC, no conversion at all when the rates agree, the state cleared by open(),
+ * the input rate set at run time, and the checks open() and process() make.
+ *
+ * One case runs a whole pipeline, for what only a chain walk shows: the nodes
+ * above the converter are opened with its input rate, the ones below with the
+ * pipeline's.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define RS_FRAME_SAMPLES 22
+#define RS_SETS		 400
+/* Room for the most outputs any case makes, 400 sets from 32 kHz to 48,
+ * and for the frame that finds the end.
+ */
+#define RS_OUT_SAMPLES	 (2 * 600 + RS_FRAME_SAMPLES)
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SETS_SOURCE_DEFINE(rs_lr_source);
+
+AUDIO_RESAMPLER_NODE_DEFINE(rs_from_44k1, &rs_lr_source, 44100U, BALANCED);
+AUDIO_RESAMPLER_NODE_DEFINE(rs_from_48k_fast, &rs_lr_source, 48000U, FAST);
+AUDIO_RESAMPLER_NODE_DEFINE(rs_from_48k_best, &rs_lr_source, 48000U, BEST);
+
+static const struct audio_stream_config stereo_48k = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config stereo_44k1 = {
+	.sample_rate_hz = 44100U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config stereo_16k = {
+	.sample_rate_hz = 16000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+/* 48 kHz to 4 kHz is a ratio of 12. */
+static const struct audio_stream_config stereo_4k = {
+	.sample_rate_hz = 4000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static const struct audio_stream_config three_channels = {
+	.sample_rate_hz = 48000U,
+	.channels = 3U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static int32_t rs_out[RS_OUT_SAMPLES];
+static int32_t rs_again[RS_OUT_SAMPLES];
+
+/* RS_SETS sets of @p left / @p right through @p node, opened at @p fmt, in
+ * frames up to the end of the stream, into @p out. Returns the sets out.
+ */
+static size_t run_sets(struct audio_node *node, const struct audio_stream_config *fmt,
+		       int32_t left, int32_t right, int32_t *out)
+{
+	audio_fake_sets_source_stereo(&rs_lr_source_state, left, right, RS_SETS);
+
+	return audio_fake_run_to_eof(node, fmt, RS_FRAME_SAMPLES, out, RS_OUT_SAMPLES);
+}
+
+ZTEST_SUITE(audio_pipeline_resampler, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(audio_pipeline_resampler, test_output_count_follows_the_ratio)
+{
+	/* One output per output period that starts within the input, each
+	 * direction, and then the end of the stream.
+	 */
+	zassert_equal(run_sets(&rs_from_44k1, &stereo_48k, 1 << 20, -(1 << 20), rs_out),
+		      DIV_ROUND_UP(RS_SETS * 160U, 147U));
+	zassert_equal(run_sets(&rs_from_48k_fast, &stereo_16k, 1 << 20, -(1 << 20), rs_out),
+		      DIV_ROUND_UP(RS_SETS, 3U));
+	zassert_equal(run_sets(&rs_from_48k_best, &stereo_44k1, 1 << 20, -(1 << 20), rs_out),
+		      DIV_ROUND_UP(RS_SETS * 147U, 160U));
+}
+
+ZTEST(audio_pipeline_resampler, test_dc_passes_at_unity_gain)
+{
+	static const struct {
+		struct audio_node *node;
+		const struct audio_stream_config *fmt;
+		int32_t tolerance;
+	} cases[] = {
+		/* The smaller the quality's images, the closer its DC gain
+		 * stays to 1 between the phases.
+		 */
+		{&rs_from_44k1, &stereo_48k, 1 << 15},
+		{&rs_from_48k_fast, &stereo_16k, 1 << 18},
+		{&rs_from_48k_best, &stereo_44k1, 1 << 12},
+	};
+	size_t c;
+	size_t i;
+
+	for (c = 0; c < ARRAY_SIZE(cases); c++) {
+		size_t sets = run_sets(cases[c].node, cases[c].fmt, 1 << 28, -(1 << 28), rs_out);
+
+		/* Away from the edges, where the filter reaches into the
+		 * silence either side of the input, the level is the input's.
+		 */
+		for (i = sets / 4U; i < 3U * sets / 4U; i++) {
+			zassert_within(rs_out[2U * i], 1 << 28, cases[c].tolerance,
+				       "case %zu, left %zu: %d", c, i, rs_out[2U * i]);
+			zassert_within(rs_out[2U * i + 1U], -(1 << 28), cases[c].tolerance,
+				       "case %zu, right %zu: %d", c, i, rs_out[2U * i + 1U]);
+		}
+
+		/* The first output is at the first input, not a filter's
+		 * delay later: the centre tap is on it and only the silence
+		 * before it is missing, so the level is already past half.
+		 */
+		zassert_true(rs_out[0] > (1 << 27) && rs_out[0] < (1 << 28),
+			     "case %zu starts at %d", c, rs_out[0]);
+	}
+}
+
+ZTEST(audio_pipeline_resampler, test_equal_rates_pass_through)
+{
+	size_t sets = run_sets(&rs_from_48k_fast, &stereo_48k, INT32_MAX, INT32_MIN, rs_out);
+	size_t i;
+
+	zassert_equal(sets, RS_SETS, "%zu sets", sets);
+	for (i = 0; i < sets; i++) {
+		zassert_equal(rs_out[2U * i], INT32_MAX, "left %zu: %d", i, rs_out[2U * i]);
+		zassert_equal(rs_out[2U * i + 1U], INT32_MIN, "right %zu: %d", i,
+			      rs_out[2U * i + 1U]);
+	}
+}
+
+ZTEST(audio_pipeline_resampler, test_open_starts_from_silence)
+{
+	size_t first;
+	size_t again;
+
+	/* The second run would start from the first one's input, or at its
+	 * position, if open() left either alone.
+	 */
+	first = run_sets(&rs_from_44k1, &stereo_48k, 1 << 28, 1 << 27, rs_out);
+	again = run_sets(&rs_from_44k1, &stereo_48k, 1 << 28, 1 << 27, rs_again);
+	zassert_equal(first, again);
+	zassert_mem_equal(rs_out, rs_again, first * 2U * sizeof(rs_out[0]));
+}
+
+ZTEST(audio_pipeline_resampler, test_input_rate_is_set_between_runs)
+{
+	struct audio_buffer_view view = {
+		.data = rs_out,
+		.capacity = RS_FRAME_SAMPLES,
+	};
+	size_t out_size;
+
+	zassert_equal(audio_resampler_set_input_rate(&rs_from_44k1, 32000U), 0);
+	zassert_equal(run_sets(&rs_from_44k1, &stereo_48k, 1 << 20, 0, rs_out),
+		      DIV_ROUND_UP(RS_SETS * 3U, 2U));
+
+	/* Not while the node converts at the rate it has. */
+	audio_fake_sets_source_stereo(&rs_lr_source_state, 1 << 20, 0, RS_SETS);
+	rs_from_44k1.pipeline_format = &stereo_48k;
+	zassert_equal(audio_node_open(&rs_from_44k1), 0);
+	zassert_equal(audio_node_process(&rs_from_44k1, &view, &out_size), 0);
+	zassert_equal(audio_resampler_set_input_rate(&rs_from_44k1, 44100U), -EBUSY);
+	zassert_equal(audio_node_close(&rs_from_44k1), 0);
+
+	zassert_equal(audio_resampler_set_input_rate(&rs_from_44k1, 44100U), 0);
+	zassert_equal(audio_resampler_set_input_rate(&rs_from_44k1, 0U), -EINVAL);
+	zassert_equal(audio_resampler_set_input_rate(&rs_lr_source, 44100U), -EINVAL,
+		      "a node that is not a resampler took a rate");
+	zassert_equal(audio_resampler_set_input_rate(NULL, 44100U), -EINVAL);
+}
+
+ZTEST(audio_pipeline_resampler, test_open_checks_the_format_and_the_ratio)
+{
+	rs_from_44k1.pipeline_format = &three_channels;
+	zassert_equal(audio_node_open(&rs_from_44k1), -ENOTSUP,
+		      "opened with more channels than it keeps input for");
+
+	rs_from_48k_fast.pipeline_format = &stereo_4k;
+	zassert_equal(audio_node_open(&rs_from_48k_fast), -ENOTSUP,
+		      "opened to decimate by more than its input is sized for");
+
+	rs_from_44k1.pipeline_format = NULL;
+	zassert_equal(audio_node_open(&rs_from_44k1), -EINVAL, "opened without a format");
+}
+
+ZTEST(audio_pipeline_resampler, test_process_before_open_is_refused)
+{
+	int32_t buf[RS_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+	size_t out_size;
+
+	rs_from_44k1.pipeline_format = &stereo_48k;
+	zassert_equal(audio_node_process(&rs_from_44k1, &view, &out_size), -EBADF,
+		      "process() ran on a closed resampler");
+}
+
+/* source (44.1 kHz) -> resampler -> sink (48 kHz), run by a pipeline. */
+#define RS_PIPELINE_FRAME_SAMPLES 32
+#define RS_PIPELINE_SETS	  100
+
+AUDIO_FAKE_SOURCE_DEFINE(rs_fake_source);
+AUDIO_RESAMPLER_NODE_DEFINE(rs_chain_converter, &rs_fake_source, 44100U, FAST);
+AUDIO_FAKE_SINK_DEFINE(rs_fake_sink, &rs_chain_converter);
+
+AUDIO_PIPELINE_DEFINE(rs_pipeline, RS_PIPELINE_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config rs_config = {
+	.frame_samples = RS_PIPELINE_FRAME_SAMPLES,
+};
+
+static const int32_t rs_samples[2 * RS_PIPELINE_SETS];
+
+ZTEST(audio_pipeline_resampler, test_upstream_is_opened_at_the_input_rate)
+{
+	const struct audio_stream_config *above;
+	const struct audio_stream_config *below;
+	struct audio_pipeline_event event;
+
+	audio_fake_source_reset(&rs_fake_source_state);
+	audio_fake_sink_reset(&rs_fake_sink_state);
+	rs_fake_source_state.samples = rs_samples;
+	rs_fake_source_state.sample_count = ARRAY_SIZE(rs_samples);
+
+	zassert_equal(audio_pipeline_init(&rs_pipeline, &rs_config, &rs_fake_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&rs_pipeline, &stereo_48k), 0);
+	zassert_equal(audio_pipeline_start(&rs_pipeline), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&rs_pipeline), 0, "play failed");
+	zassert_equal(audio_pipeline_get_event(&rs_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, AUDIO_PIPELINE_EVENT_EOF, "event %d", event.type);
+	(void)audio_pipeline_join(&rs_pipeline);
+
+	/* The same format either side, but for the rate. */
+	above = atomic_ptr_get(&rs_fake_source_state.seen_format);
+	below = atomic_ptr_get(&rs_fake_sink_state.seen_format);
+	zassert_not_null(above);
+	zassert_not_null(below);
+	zassert_equal(above->sample_rate_hz, 44100U, "upstream opened at %u Hz",
+		      above->sample_rate_hz);
+	zassert_equal(above->channels, 2U);
+	zassert_equal(above->format, AUDIO_SAMPLE_FORMAT_S32_LE);
+	zassert_equal(below->sample_rate_hz, 48000U, "downstream opened at %u Hz",
+		      below->sample_rate_hz);
+
+	/* A frame of 16 sets below is a third of a millisecond, which takes
+	 * 14.7 sets at 44.1 kHz: the segment above is sized for 15.
+	 */
+	zassert_equal(rs_fake_sink.frame_capacity, RS_PIPELINE_FRAME_SAMPLES);
+	zassert_equal(rs_fake_source.frame_capacity, 30U, "segment frame of %zu samples",
+		      rs_fake_source.frame_capacity);
+
+	/* Every input sample was pulled, and the output is the ratio's. */
+	zassert_equal(atomic_get(&rs_fake_source_state.samples_done), ARRAY_SIZE(rs_samples));
+	zassert_equal(atomic_get(&rs_fake_sink_state.frames_seen),
+		      DIV_ROUND_UP(DIV_ROUND_UP(RS_PIPELINE_SETS * 160U, 147U) * 2U,
+				   RS_PIPELINE_FRAME_SAMPLES));
+}
@@ -0,0 +1,242 @@
+/*
+ * Two-stage pipelines (spec §3.5, CONFIG_AUDIO_PIPELINE_RING).
+ *
+ * source -> filter -> sink, split at the filter: the filter does its work on
+ * the CPU, the sink sleeps like a sink blocked in i2s_write(). On one thread a
+ * frame costs both; split in two, the producer thread runs the filter while the
+ * worker is parked in the sink. The cases check that overlap, that every frame
+ * arrives intact and in the worker's slot rather than in a copy, and that end of
+ * stream, errors and join() cross the ring the way they cross a single stage.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define RING_FRAME_SAMPLES 64
+#define RING_DEPTH         3
+#define RING_PATTERN       0x12345600
+
+/* Per frame, on either side of the split. */
+#define RING_STAGE_US 3000U
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SOURCE_DEFINE(ring_source);
+AUDIO_FAKE_FILTER_DEFINE(ring_filter, &ring_source);
+AUDIO_FAKE_SINK_DEFINE(ring_sink, &ring_filter);
+
+AUDIO_PIPELINE_DEFINE(ring_pipeline, RING_FRAME_SAMPLES, 2048, 5, RING_DEPTH);
+
+/* Same chain on a single frame buffer, as the baseline and for the refusal. */
+AUDIO_PIPELINE_DEFINE(flat_pipeline, RING_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config split_config = {
+	.frame_samples = RING_FRAME_SAMPLES,
+	.split = &ring_filter,
+};
+
+static const struct audio_pipeline_config single_stage_config = {
+	.frame_samples = RING_FRAME_SAMPLES,
+};
+
+static const struct audio_pipeline_config split_at_sink_config = {
+	.frame_samples = RING_FRAME_SAMPLES,
+	.split = &ring_sink,
+};
+
+static const struct audio_stream_config ring_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void ring_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&ring_source_state);
+	audio_fake_sink_reset(&ring_filter_state);
+	audio_fake_sink_reset(&ring_sink_state);
+
+	ring_source_state.pattern = RING_PATTERN;
+	ring_sink_state.check_pattern = true;
+	ring_sink_state.expect_pattern = RING_PATTERN;
+}
+
+static void ring_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&ring_pipeline);
+	(void)audio_pipeline_join(&flat_pipeline);
+}
+
+static void start_chain(struct audio_pipeline *pipeline, const struct audio_pipeline_config *config)
+{
+	zassert_equal(audio_pipeline_init(pipeline, config, &ring_sink), 0, "init failed");
+	zassert_equal(audio_pipeline_set_format(pipeline, &ring_format), 0, "set_format failed");
+	zassert_equal(audio_pipeline_start(pipeline), 0, "start failed");
+}
+
+static void expect_event(struct audio_pipeline *pipeline, enum audio_pipeline_event_type type,
+			 int err)
+{
+	struct audio_pipeline_event event;
+	int ret;
+
+	ret = audio_pipeline_get_event(pipeline, &event, TEST_EVENT_TIMEOUT);
+	zassert_equal(ret, 0, "no event before the timeout (%d)", ret);
+	zassert_equal(event.type, type, "expected event %d, got %d", type, event.type);
+	zassert_equal(event.err, err, "expected error %d, got %d", err, event.err);
+}
+
+/* Play @p pipeline to end of stream and return the elapsed ms. */
+static int64_t play_to_eof(struct audio_pipeline *pipeline)
+{
+	int64_t start = k_uptime_get();
+
+	zassert_equal(audio_pipeline_play(pipeline), 0, "play failed");
+	expect_event(pipeline, AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	return k_uptime_get() - start;
+}
+
+ZTEST(audio_pipeline_ring, test_stages_overlap)
+{
+	int64_t single;
+	int64_t split;
+
+	ring_source_state.frames_total = 20U;
+	ring_filter_state.busy_us = RING_STAGE_US;
+	ring_sink_state.sleep_us = RING_STAGE_US;
+
+	start_chain(&flat_pipeline, &single_stage_config);
+	single = play_to_eof(&flat_pipeline);
+	zassert_equal(audio_pipeline_join(&flat_pipeline), 0);
+
+	start_chain(&ring_pipeline, &split_config);
+	split = play_to_eof(&ring_pipeline);
+
+	/* 20 frames of 3 + 3 ms are 120 ms on one thread; overlapped they are
+	 * one filter frame plus 20 sink frames, ~63 ms.
+	 */
+	zassert_true(single >= 120, "the single-stage run took only %lld ms", single);
+	zassert_true(split < 90, "split in two stages, 20 frames still took %lld ms", split);
+
+	zassert_equal(atomic_get(&ring_sink_state.frames_seen), 40, "frames lost");
+	zassert_equal(atomic_get(&ring_sink_state.corrupt_frames), 0, "frames damaged");
+}
+
+ZTEST(audio_pipeline_ring, test_stages_run_on_their_own_threads)
+{
+	ring_source_state.frames_total = 8U;
+
+	start_chain(&ring_pipeline, &split_config);
+	(void)play_to_eof(&ring_pipeline);
+
+	zassert_equal_ptr(atomic_ptr_get(&ring_sink_state.worker), &ring_pipeline.thread,
+			  "the consumer stage did not run on the worker");
+	zassert_equal_ptr(atomic_ptr_get(&ring_filter_state.worker), &ring_pipeline.ring.thread,
+			  "the producer stage did not run on the producer thread");
+
+	/* The consumer stage works in the ring slots in place: the sink was
+	 * handed one of them, not the first frame of the buffer every time.
+	 */
+	zassert_true((int32_t *)atomic_ptr_get(&ring_sink_state.seen_buf) >=
+			     ring_pipeline.frame_buf &&
+		     (int32_t *)atomic_ptr_get(&ring_sink_state.seen_buf) <
+			     ring_pipeline.frame_buf + RING_DEPTH * RING_FRAME_SAMPLES,
+		     "the sink was not handed a ring slot");
+	zassert_equal(atomic_get(&ring_sink_state.frames_seen), 8, "frames lost");
+	zassert_equal(atomic_get(&ring_sink_state.corrupt_frames), 0, "frames damaged");
+}
+
+ZTEST(audio_pipeline_ring, test_next_track_after_eof)
+{
+	ring_source_state.frames_total = 5U;
+
+	start_chain(&ring_pipeline, &split_config);
+	(void)play_to_eof(&ring_pipeline);
+	zassert_equal(atomic_get(&ring_sink_state.frames_seen), 5);
+
+	/* The producer parked on the end of the first track; the next play()
+	 * has it pull the second one without a reopen.
+	 */
+	audio_fake_source_rewind(&ring_source_state);
+	(void)play_to_eof(&ring_pipeline);
+
+	zassert_equal(atomic_get(&ring_sink_state.frames_seen), 10, "second track lost frames");
+	zassert_equal(atomic_get(&ring_source_state.open_calls), 1, "the chain was reopened");
+}
+
+ZTEST(audio_pipeline_ring, test_producer_error_arrives_in_stream_order)
+{
+	ring_source_state.frames_total = AUDIO_FAKE_ENDLESS;
+	ring_source_state.fail_at_frame = 5U;
+	ring_source_state.process_ret = -EIO;
+
+	start_chain(&ring_pipeline, &split_config);
+	zassert_equal(audio_pipeline_play(&ring_pipeline), 0);
+	expect_event(&ring_pipeline, AUDIO_PIPELINE_EVENT_ERROR, -EIO);
+
+	/* Every frame made before the failure was delivered first. */
+	zassert_equal(atomic_get(&ring_sink_state.frames_seen), 4, "frames before the error lost");
+	zassert_equal(atomic_get(&ring_source_state.close_calls), 1);
+	zassert_equal(atomic_get(&ring_filter_state.close_calls), 1);
+	zassert_equal(atomic_get(&ring_sink_state.close_calls), 1);
+
+	/* A restart reopens onto the same two threads with an empty ring. */
+	ring_source_state.fail_at_frame = 0U;
+	ring_source_state.frames_total = 3U;
+	zassert_equal(audio_pipeline_start(&ring_pipeline), 0, "restart failed");
+	(void)play_to_eof(&ring_pipeline);
+	zassert_equal(atomic_get(&ring_sink_state.frames_seen), 7, "restarted run lost frames");
+}
+
+ZTEST(audio_pipeline_ring, test_join_while_both_stages_run)
+{
+	ring_source_state.frames_total = AUDIO_FAKE_ENDLESS;
+	ring_sink_state.sleep_us = 1000U;
+
+	start_chain(&ring_pipeline, &split_config);
+	zassert_equal(audio_pipeline_play(&ring_pipeline), 0);
+	k_msleep(20);
+
+	zassert_equal(audio_pipeline_join(&ring_pipeline), 0, "join failed");
+	zassert_false(audio_pipeline_is_running(&ring_pipeline));
+	zassert_equal(atomic_get(&ring_source_state.close_calls), 1);
+	zassert_equal(atomic_get(&ring_sink_state.close_calls), 1);
+
+	/* The chain is wired back the way it was defined. */
+	zassert_equal_ptr(ring_sink.upstream, &ring_filter, "the ring is still in the chain");
+}
+
+ZTEST(audio_pipeline_ring, test_split_needs_ring_storage_and_a_consumer_stage)
+{
+	zassert_equal(audio_pipeline_init(&flat_pipeline, &split_config, &ring_sink), -EINVAL,
+		      "an instance without a ring was split");
+
+	zassert_equal(audio_pipeline_init(&ring_pipeline, &split_at_sink_config, &ring_sink), 0);
+	zassert_equal(audio_pipeline_set_format(&ring_pipeline, &ring_format), 0);
+	zassert_equal(audio_pipeline_start(&ring_pipeline), -EINVAL,
+		      "a split with nothing below it was accepted");
+	zassert_equal(atomic_get(&ring_sink_state.open_calls), 0);
+	zassert_false(audio_pipeline_is_running(&ring_pipeline));
+}
+
+ZTEST_SUITE(audio_pipeline_ring, NULL, NULL, ring_before, ring_after, NULL);
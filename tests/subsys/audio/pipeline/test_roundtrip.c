@@ -301,7 +301,8 @@ ZTEST(audio_pipeline_roundtrip, test_roundtrip_preserves_a_mono_44100_hz_track)
 		      wav.sample_rate_hz);
 	zassert_equal(wav.channels, 1U, "the header declares %u channels, not the bound 1",
 		      wav.channels);
-	zassert_equal(wav.bits_per_sample, 16U, "v1 writes 16 bit PCM");
+	zassert_equal(wav.bits_per_sample, 16U, "a 16 bit format written at %u bit",
+		      wav.bits_per_sample);
 	zassert_equal(wav.block_align, 2U, "a mono 16 bit frame is 2 bytes");
 	zassert_equal(wav.data_size, RT_MONO_PAYLOAD_BYTES, "payload length changed");
 
@@ -0,0 +1,259 @@
+/*
+ * Tee sink node (spec §4.5, CONFIG_AUDIO_PIPELINE_NODE_TEE).
+ *
+ * One source, one pull per frame, several branch sinks. The cases check that
+ * read-only branches are handed the pulled frame itself, that a writing branch
+ * gets a copy only when another writer follows it, that a branch a writer
+ * precedes in the definition still sees the samples unmodified, that open,
+ * close, errors and end of stream reach every branch chain, and that a frame
+ * the copy-on-write space cannot hold is refused when it would be used.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_pipeline.h>
+#include <zephyr/audio/audio_pipeline_events.h>
+
+#include "fake_nodes.h"
+
+#define TEE_FRAME_SAMPLES 32
+#define TEE_PATTERN       0x12345600
+/* TEE_PATTERN through a half-gain filter. */
+#define TEE_HALF_PATTERN  (TEE_PATTERN / 2)
+#define TEE_HALF_GAIN_Q15 (AUDIO_GAIN_UNITY_Q15 / 2)
+
+#define TEST_EVENT_TIMEOUT K_MSEC(2000)
+
+AUDIO_FAKE_SOURCE_DEFINE(tee_source);
+
+/* Two read-only branches. */
+AUDIO_TEE_TAP_NODE_DEFINE(reader_a_tap);
+AUDIO_FAKE_SINK_DEFINE(reader_a, &reader_a_tap);
+AUDIO_TEE_TAP_NODE_DEFINE(reader_b_tap);
+AUDIO_FAKE_SINK_DEFINE(reader_b, &reader_b_tap);
+
+AUDIO_TEE_NODE_DEFINE(shared_tee, &tee_source, TEE_FRAME_SAMPLES, AUDIO_TEE_BRANCH(&reader_a),
+		      AUDIO_TEE_BRANCH(&reader_b));
+
+/* Writer, reader, writer - declared in the order the tee must not run them. */
+AUDIO_TEE_TAP_NODE_DEFINE(writer_a_tap);
+AUDIO_GAIN_FILTER_NODE_DEFINE(writer_a_gain, &writer_a_tap, TEE_HALF_GAIN_Q15);
+AUDIO_FAKE_SINK_DEFINE(writer_a, &writer_a_gain);
+AUDIO_TEE_TAP_NODE_DEFINE(reader_c_tap);
+AUDIO_FAKE_SINK_DEFINE(reader_c, &reader_c_tap);
+AUDIO_TEE_TAP_NODE_DEFINE(writer_b_tap);
+AUDIO_GAIN_FILTER_NODE_DEFINE(writer_b_gain, &writer_b_tap, TEE_HALF_GAIN_Q15);
+AUDIO_FAKE_SINK_DEFINE(writer_b, &writer_b_gain);
+
+AUDIO_TEE_NODE_DEFINE(mixed_tee, &tee_source, TEE_FRAME_SAMPLES,
+		      AUDIO_TEE_BRANCH_WRITES(&writer_a), AUDIO_TEE_BRANCH(&reader_c),
+		      AUDIO_TEE_BRANCH_WRITES(&writer_b));
+
+/* A branch that ends in a plain source instead of a tap. */
+AUDIO_FAKE_SOURCE_DEFINE(stray_source);
+AUDIO_FAKE_SINK_DEFINE(stray_sink, &stray_source);
+
+AUDIO_TEE_NODE_DEFINE(untapped_tee, &tee_source, TEE_FRAME_SAMPLES,
+		      AUDIO_TEE_BRANCH(&reader_a), AUDIO_TEE_BRANCH(&stray_sink));
+
+/* Copy-on-write space for half the pipeline's frame. Enough for one writer,
+ * which never copies; not for two.
+ */
+AUDIO_TEE_NODE_DEFINE(small_two_writer_tee, &tee_source, TEE_FRAME_SAMPLES / 2,
+		      AUDIO_TEE_BRANCH_WRITES(&writer_a), AUDIO_TEE_BRANCH_WRITES(&writer_b));
+AUDIO_TEE_NODE_DEFINE(small_one_writer_tee, &tee_source, TEE_FRAME_SAMPLES / 2,
+		      AUDIO_TEE_BRANCH(&reader_c), AUDIO_TEE_BRANCH_WRITES(&writer_a));
+
+AUDIO_PIPELINE_DEFINE(tee_pipeline, TEE_FRAME_SAMPLES, 2048, 5);
+
+static const struct audio_pipeline_config tee_config = {
+	.frame_samples = TEE_FRAME_SAMPLES,
+};
+
+static const struct audio_stream_config tee_format = {
+	.sample_rate_hz = 48000U,
+	.channels = 2U,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
+static void expect_pattern(struct audio_fake_sink *sink, int32_t pattern)
+{
+	audio_fake_sink_reset(sink);
+	sink->check_pattern = true;
+	sink->expect_pattern = pattern;
+}
+
+static void tee_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	audio_fake_source_reset(&tee_source_state);
+	tee_source_state.pattern = TEE_PATTERN;
+
+	expect_pattern(&reader_a_state, TEE_PATTERN);
+	expect_pattern(&reader_b_state, TEE_PATTERN);
+	expect_pattern(&reader_c_state, TEE_PATTERN);
+	expect_pattern(&writer_a_state, TEE_HALF_PATTERN);
+	expect_pattern(&writer_b_state, TEE_HALF_PATTERN);
+	audio_fake_sink_reset(&stray_sink_state);
+}
+
+static void tee_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)audio_pipeline_join(&tee_pipeline);
+}
+
+static int start_tee(struct audio_node *tee)
+{
+	zassert_equal(audio_pipeline_init(&tee_pipeline, &tee_config, tee), 0, "init failed");
+	zassert_equal(audio_pipeline_set_format(&tee_pipeline, &tee_format), 0);
+
+	return audio_pipeline_start(&tee_pipeline);
+}
+
+static void expect_event(enum audio_pipeline_event_type type, int err)
+{
+	struct audio_pipeline_event event;
+
+	zassert_equal(audio_pipeline_get_event(&tee_pipeline, &event, TEST_EVENT_TIMEOUT), 0,
+		      "no event before the timeout");
+	zassert_equal(event.type, type, "expected event %d, got %d", type, event.type);
+	zassert_equal(event.err, err, "expected error %d, got %d", err, event.err);
+}
+
+ZTEST(audio_pipeline_tee, test_read_only_branches_share_the_frame)
+{
+	tee_source_state.frames_total = 6U;
+
+	zassert_equal(start_tee(&shared_tee), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&tee_pipeline), 0);
+	expect_event(AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	/* One pull per frame, whatever the number of branches. */
+	zassert_equal(atomic_get(&tee_source_state.open_calls), 1);
+	zassert_equal(atomic_get(&tee_source_state.frames_done), 6);
+
+	zassert_equal(atomic_get(&reader_a_state.frames_seen), 6);
+	zassert_equal(atomic_get(&reader_b_state.frames_seen), 6);
+	zassert_equal(atomic_get(&reader_a_state.corrupt_frames), 0);
+	zassert_equal(atomic_get(&reader_b_state.corrupt_frames), 0);
+
+	/* Both were handed the pipeline's frame, and nothing was copied. */
+	zassert_equal_ptr(atomic_ptr_get(&reader_a_state.seen_buf), tee_pipeline.frame_buf);
+	zassert_equal_ptr(atomic_ptr_get(&reader_b_state.seen_buf), tee_pipeline.frame_buf);
+	zassert_equal(shared_tee_state.copied_frames, 0U, "a read-only branch got a copy");
+
+	/* End of stream reached every branch sink, as it reaches a pipeline's. */
+	zassert_equal(atomic_get(&reader_a_state.eof_seen), 1);
+	zassert_equal(atomic_get(&reader_b_state.eof_seen), 1);
+}
+
+ZTEST(audio_pipeline_tee, test_writers_copy_only_when_another_follows)
+{
+	tee_source_state.frames_total = 4U;
+
+	zassert_equal(start_tee(&mixed_tee), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&tee_pipeline), 0);
+	expect_event(AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	/* Declared after a writer, the reader still saw the source's samples. */
+	zassert_equal(atomic_get(&reader_c_state.frames_seen), 4);
+	zassert_equal(atomic_get(&reader_c_state.corrupt_frames), 0, "a writer ran first");
+	zassert_equal_ptr(atomic_ptr_get(&reader_c_state.seen_buf), tee_pipeline.frame_buf);
+
+	/* Each writer applied its gain once, to an unmodified frame. */
+	zassert_equal(atomic_get(&writer_a_state.frames_seen), 4);
+	zassert_equal(atomic_get(&writer_b_state.frames_seen), 4);
+	zassert_equal(atomic_get(&writer_a_state.corrupt_frames), 0);
+	zassert_equal(atomic_get(&writer_b_state.corrupt_frames), 0);
+
+	/* The first writer worked on the copy, the last one in place. */
+	zassert_equal_ptr(atomic_ptr_get(&writer_a_state.seen_buf), mixed_tee_state.scratch);
+	zassert_equal_ptr(atomic_ptr_get(&writer_b_state.seen_buf), tee_pipeline.frame_buf);
+	zassert_equal(mixed_tee_state.copied_frames, 4U, "%u copies for 4 frames",
+		      mixed_tee_state.copied_frames);
+}
+
+ZTEST(audio_pipeline_tee, test_branch_error_fails_the_frame)
+{
+	tee_source_state.frames_total = AUDIO_FAKE_ENDLESS;
+	reader_b_state.fail_at_frame = 3U;
+	reader_b_state.process_ret = -EIO;
+
+	zassert_equal(start_tee(&shared_tee), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&tee_pipeline), 0);
+	expect_event(AUDIO_PIPELINE_EVENT_ERROR, -EIO);
+
+	/* The pipeline closed the tee, and the tee every branch chain. */
+	zassert_equal(atomic_get(&tee_source_state.close_calls), 1);
+	zassert_equal(atomic_get(&reader_a_state.close_calls), 1);
+	zassert_equal(atomic_get(&reader_b_state.close_calls), 1);
+	zassert_equal(atomic_get(&reader_a_state.frames_seen), 3);
+}
+
+ZTEST(audio_pipeline_tee, test_branch_open_failure_unwinds)
+{
+	int32_t sample;
+	struct audio_buffer_view view = {.data = &sample, .capacity = 1U};
+	size_t size;
+
+	reader_b_state.open_ret = -EIO;
+
+	zassert_equal(start_tee(&shared_tee), -EIO, "a branch failed to open unnoticed");
+
+	/* The branch that did open was closed again, and so was the source. */
+	zassert_equal(atomic_get(&reader_a_state.open_calls), 1);
+	zassert_equal(atomic_get(&reader_a_state.close_calls), 1);
+	zassert_equal(atomic_get(&tee_source_state.open_calls), 0);
+	zassert_false(audio_pipeline_is_running(&tee_pipeline));
+
+	/* Not opened, so the tap refuses a pull rather than faking a frame. */
+	zassert_equal(audio_node_process(&reader_a_tap, &view, &size), -EBADF);
+}
+
+ZTEST(audio_pipeline_tee, test_every_branch_needs_a_tap)
+{
+	zassert_equal(start_tee(&untapped_tee), -EINVAL, "a branch without a tap was accepted");
+	zassert_equal(atomic_get(&reader_a_state.open_calls), 0);
+	zassert_equal(atomic_get(&stray_sink_state.open_calls), 0);
+}
+
+ZTEST(audio_pipeline_tee, test_open_refuses_a_frame_larger_than_the_scratch)
+{
+	/* Refused at the start, not as -ENOBUFS at the first copy. */
+	zassert_equal(start_tee(&small_two_writer_tee), -EINVAL,
+		      "a frame larger than the scratch was accepted");
+	zassert_equal(atomic_get(&writer_a_state.open_calls), 0);
+	zassert_equal(atomic_get(&writer_b_state.open_calls), 0);
+	zassert_equal(atomic_get(&tee_source_state.open_calls), 0);
+	zassert_false(audio_pipeline_is_running(&tee_pipeline));
+}
+
+ZTEST(audio_pipeline_tee, test_one_writer_needs_no_scratch)
+{
+	tee_source_state.frames_total = 3U;
+
+	zassert_equal(start_tee(&small_one_writer_tee), 0, "start failed");
+	zassert_equal(audio_pipeline_play(&tee_pipeline), 0);
+	expect_event(AUDIO_PIPELINE_EVENT_EOF, 0);
+
+	zassert_equal(atomic_get(&writer_a_state.frames_seen), 3);
+	zassert_equal(atomic_get(&writer_a_state.corrupt_frames), 0);
+	zassert_equal(small_one_writer_tee_state.copied_frames, 0U);
+}
+
+ZTEST_SUITE(audio_pipeline_tee, NULL, NULL, tee_before, tee_after, NULL);
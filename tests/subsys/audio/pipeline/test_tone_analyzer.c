@@ -75,6 +75,13 @@
 #define ANA_DC_HZ      40U
 #define ANA_NYQUIST_HZ 23980U
 
+/*
+ * Eight channels, one tone each, every one of them on a whole 50 Hz bin - the
+ * width of a TDM microphone array, and four times what v1 could measure.
+ */
+#define ANA_OCTO_CHANNELS 8U
+#define ANA_OCTO_TONES    1000U, 2000U, 3000U, 4000U, 5000U, 6000U, 7000U, 8000U
+
 /* Windows measured per case; two are enough to show a second one starts clean. */
 #define ANA_WINDOWS 2U
 
@@ -210,6 +217,14 @@ AUDIO_FAKE_SOURCE_DEFINE(ana_replay_src);
 AUDIO_TONE_ANALYZER_NODE_DEFINE(ana_replay_sink, &ana_replay_src, ANA_WINDOW, ANA_LEFT_HZ,
 				ANA_RIGHT_HZ);
 
+/* Eight channels, then the same eight with the third and sixth wires crossed. */
+AUDIO_TONE_GEN_NODE_DEFINE(ana_gen_octo, AUDIO_TONE_GEN_FULL_SCALE_Q15, 0, ANA_OCTO_TONES);
+AUDIO_TONE_ANALYZER_NODE_DEFINE(ana_octo, &ana_gen_octo, ANA_WINDOW, ANA_OCTO_TONES);
+AUDIO_TONE_GEN_NODE_DEFINE(ana_gen_octo_crossed, AUDIO_TONE_GEN_FULL_SCALE_Q15, 0, 1000U, 2000U,
+			   6000U, 4000U, 5000U, 3000U, 7000U, 8000U);
+AUDIO_TONE_ANALYZER_NODE_DEFINE(ana_octo_crossed, &ana_gen_octo_crossed, ANA_WINDOW,
+				ANA_OCTO_TONES);
+
 /* Configurations open() has to refuse. */
 AUDIO_TONE_ANALYZER_NODE_DEFINE(ana_dc, &ana_silence_src, ANA_WINDOW, ANA_DC_HZ);
 AUDIO_TONE_ANALYZER_NODE_DEFINE(ana_nyquist, &ana_silence_src, ANA_WINDOW, ANA_NYQUIST_HZ);
@@ -249,8 +264,22 @@ static struct audio_node *const stereo_nodes[] = {
 	&ana_replay_src,  &ana_replay_sink,
 };
 
+static const struct audio_stream_config octo_format = {
+	.sample_rate_hz = ANA_RATE_HZ,
+	.channels = ANA_OCTO_CHANNELS,
+	.valid_bits_per_sample = 16U,
+	.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+};
+
 static struct audio_node *const mono_nodes[] = {&ana_gen_low, &ana_low, &ana_dc, &ana_nyquist};
 
+static struct audio_node *const octo_nodes[] = {
+	&ana_gen_octo,
+	&ana_octo,
+	&ana_gen_octo_crossed,
+	&ana_octo_crossed,
+};
+
 /* A frame of a few hundred samples has no business on the Ztest stack. */
 static int32_t ana_frame[CONFIG_AUDIO_PIPELINE_FRAME_SAMPLES];
 
@@ -270,6 +299,11 @@ static void ana_before(void *fixture)
 		(void)audio_node_close(mono_nodes[i]);
 	}
 
+	for (i = 0; i < ARRAY_SIZE(octo_nodes); i++) {
+		octo_nodes[i]->pipeline_format = &octo_format;
+		(void)audio_node_close(octo_nodes[i]);
+	}
+
 	/* Mono by default; the case that needs it stereo says so. */
 	ana_mono.pipeline_format = &mono_format;
 	(void)audio_node_close(&ana_mono);
@@ -560,6 +594,60 @@ ZTEST(audio_pipeline_tone_analyzer, test_sink_reports_a_channel_swap)
 		     "left does not carry the right channel's tone");
 }
 
+ZTEST(audio_pipeline_tone_analyzer, test_sink_measures_eight_channels)
+{
+	struct audio_tone_analyzer_result result;
+	uint8_t channel;
+	uint8_t tone;
+
+	ana_measure(&ana_gen_octo, &ana_octo, ANA_WINDOW, ANA_OCTO_CHANNELS, ANA_WINDOWS,
+		    &result);
+
+	zassert_equal(result.verdict, AUDIO_TONE_ANALYZER_VERDICT_PASS,
+		      "eight channels of their own tones were reported as %d",
+		      (int)result.verdict);
+	zassert_equal(result.channels, ANA_OCTO_CHANNELS, "the result lost channels");
+
+	/* Every tone on every channel, as at two: 64 readings, eight of them
+	 * the channel's own.
+	 */
+	for (channel = 0U; channel < ANA_OCTO_CHANNELS; channel++) {
+		const struct audio_tone_analyzer_channel_result *ch = &result.channel[channel];
+
+		zassert_equal(ch->strongest, channel, "channel %u's strongest tone is %d",
+			      channel, ch->strongest);
+
+		for (tone = 0U; tone < ANA_OCTO_CHANNELS; tone++) {
+			if (tone == channel) {
+				zassert_true(ch->in_band_q15[tone] > AUDIO_TONE_ANALYZER_PASS_Q15,
+					     "channel %u carries %d of its own tone", channel,
+					     ch->in_band_q15[tone]);
+			} else {
+				zassert_true(ch->in_band_q15[tone] < AUDIO_TONE_ANALYZER_PASS_Q15,
+					     "channel %u also carries tone %u", channel, tone);
+			}
+		}
+	}
+}
+
+ZTEST(audio_pipeline_tone_analyzer, test_sink_reports_one_crossed_pair_among_eight)
+{
+	struct audio_tone_analyzer_result result;
+
+	ana_measure(&ana_gen_octo_crossed, &ana_octo_crossed, ANA_WINDOW, ANA_OCTO_CHANNELS,
+		    ANA_WINDOWS, &result);
+
+	/* Six channels right and two crossed is still a wiring fault, and the
+	 * same one as a crossed stereo pair - not a wrong frequency, because
+	 * every tone that arrived is one that was expected.
+	 */
+	zassert_equal(result.verdict, AUDIO_TONE_ANALYZER_VERDICT_SWAPPED,
+		      "a crossed pair among eight was reported as %d", (int)result.verdict);
+	zassert_equal(result.channel[2].strongest, 5, "channel 2 does not carry channel 5's tone");
+	zassert_equal(result.channel[5].strongest, 2, "channel 5 does not carry channel 2's tone");
+	zassert_equal(result.channel[3].strongest, 3, "an uncrossed channel moved");
+}
+
 ZTEST(audio_pipeline_tone_analyzer, test_sink_prefers_a_quiet_right_tone_to_a_loud_wrong_one)
 {
 	struct audio_tone_analyzer_result quiet;
@@ -0,0 +1,278 @@
+/*
+ * WAV memory source (spec §10.15): a RIFF/WAVE image in memory parsed once
+ * and widened straight from its payload - whole, cut short, from an odd
+ * address, as a region and looped - and the images and regions it refuses.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/audio/audio_node.h>
+#include <zephyr/audio/audio_nodes.h>
+#include <zephyr/audio/audio_wav.h>
+
+#include "fake_nodes.h"
+
+/* Stereo sets of the payload every image below carries. */
+#define MEMORY_SETS 150U
+#define MEMORY_SAMPLES (MEMORY_SETS * 2U)
+
+/* Not a divisor of the payload, so the last frame is short. */
+#define MEMORY_FRAME_SAMPLES 32
+
+/* A byte of slack in front, so the image can also start at an odd address. */
+static uint8_t memory_image[1 + AUDIO_WAV_MAX_HEADER_SIZE + MEMORY_SAMPLES * sizeof(int16_t)];
+static int16_t memory_payload[MEMORY_SAMPLES];
+
+AUDIO_WAV_MEMORY_NODE_DEFINE(clip, memory_image, memory_image + sizeof(memory_image));
+AUDIO_GAIN_FILTER_NODE_DEFINE(clip_gain, &clip, AUDIO_GAIN_UNITY_Q15);
+
+/*
+ * Serialise an image at @p offset into memory_image: a header from @p hdr,
+ * then the first @p samples of memory_payload. Points the clip at exactly
+ * that much memory.
+ */
+static void build_image(size_t offset, const struct audio_wav_header *hdr, size_t samples)
+{
+	struct audio_wav_memory_state *state = clip.state;
+	size_t header_len = audio_wav_header_size(hdr);
+	size_t i;
+
+	zassert_equal(audio_wav_write_header(&memory_image[offset], sizeof(memory_image) - offset,
+					     hdr),
+		      0, "the WAV module refused the test header");
+
+	for (i = 0; i < samples; i++) {
+		sys_put_le16((uint16_t)memory_payload[i],
+			     &memory_image[offset + header_len + i * sizeof(int16_t)]);
+	}
+
+	state->image = &memory_image[offset];
+	state->image_end = &memory_image[offset + header_len + samples * sizeof(int16_t)];
+}
+
+static void build_stereo_image(size_t offset, uint32_t declared_sets, size_t sets)
+{
+	const struct audio_wav_header hdr = {
+		.sample_rate_hz = 16000U,
+		.data_size = declared_sets * 2U * sizeof(int16_t),
+		.format_tag = AUDIO_WAV_FORMAT_PCM,
+		.channels = 2U,
+		.bits_per_sample = 16U,
+	};
+
+	build_image(offset, &hdr, sets * 2U);
+}
+
+static void memory_before(void *fixture)
+{
+	size_t i;
+
+	ARG_UNUSED(fixture);
+
+	for (i = 0; i < ARRAY_SIZE(memory_payload); i++) {
+		memory_payload[i] = (int16_t)(i * 211U) - 31000;
+	}
+
+	clip.pipeline_format = NULL;
+	zassert_equal(audio_wav_memory_set_region(&clip, 0U, 0U, false), 0,
+		      "could not reset the region");
+}
+
+/*
+ * Pull @p frames frames of @p capacity samples and check every sample against
+ * memory_payload from stereo set @p first, wrapping from @p end back to
+ * @p first when @p loop is set. Returns the samples pulled.
+ */
+static size_t assert_plays(size_t capacity, unsigned int frames, size_t first, size_t end,
+			   bool loop)
+{
+	int32_t buf[MEMORY_FRAME_SAMPLES];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = capacity,
+	};
+	size_t pos = first * 2U;
+	size_t total = 0;
+	size_t produced;
+	unsigned int f;
+	size_t i;
+
+	zassert_true(capacity <= ARRAY_SIZE(buf), "frame larger than the test buffer");
+
+	for (f = 0U; f < frames; f++) {
+		zassert_equal(audio_node_process(&clip, &view, &produced), 0,
+			      "process failed in frame %u", f);
+		zassert_equal(produced % 2U, 0U, "a split stereo set");
+
+		for (i = 0; i < produced; i++) {
+			if (pos == end * 2U && loop) {
+				pos = first * 2U;
+			}
+			zassert_true(pos < end * 2U, "played past the region");
+			zassert_equal(buf[i], audio_test_s16_to_s32(memory_payload[pos]),
+				      "sample %zu of frame %u is wrong", i, f);
+			pos++;
+		}
+		total += produced;
+
+		if (produced == 0U) {
+			break;
+		}
+	}
+
+	return total;
+}
+
+ZTEST(audio_pipeline_wav_memory, test_memory_plays_the_payload_to_eof)
+{
+	struct audio_wav_memory_state *state = clip.state;
+	size_t produced;
+	int32_t buf[2];
+	struct audio_buffer_view view = {
+		.data = buf,
+		.capacity = ARRAY_SIZE(buf),
+	};
+
+	build_stereo_image(0U, MEMORY_SETS, MEMORY_SETS);
+
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(state->fmt.sample_rate_hz, 16000U, "wrong rate");
+	zassert_equal(state->fmt.channels, 2U, "wrong channel count");
+	zassert_equal(state->fmt.valid_bits_per_sample, 16U, "wrong depth");
+
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, UINT_MAX, 0U, MEMORY_SETS, false),
+		      MEMORY_SAMPLES, "did not play the whole payload");
+
+	/* And it stays at EOF. */
+	zassert_equal(audio_node_process(&clip, &view, &produced), 0, "EOF must return 0");
+	zassert_equal(produced, 0U, "restarted after EOF");
+
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+	zassert_equal(audio_node_process(&clip, &view, &produced), -EBADF,
+		      "process() after close() must fail");
+}
+
+ZTEST(audio_pipeline_wav_memory, test_memory_reads_an_unaligned_image)
+{
+	/* A payload at an odd address: reads a byte at a time. */
+	build_stereo_image(1U, MEMORY_SETS, MEMORY_SETS);
+
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, UINT_MAX, 0U, MEMORY_SETS, false),
+		      MEMORY_SAMPLES, "did not play the whole payload");
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_wav_memory, test_memory_stops_where_the_image_does)
+{
+	/* The header promises 150 sets, the image holds 100 and half a set. */
+	build_stereo_image(0U, MEMORY_SETS, 100U);
+	((struct audio_wav_memory_state *)clip.state)->image_end += sizeof(int16_t);
+
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, UINT_MAX, 0U, 100U, false), 200U,
+		      "did not stop at the end of the image");
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_wav_memory, test_memory_plays_a_region)
+{
+	build_stereo_image(0U, MEMORY_SETS, MEMORY_SETS);
+
+	zassert_equal(audio_wav_memory_set_region(&clip, 40U, 25U, false), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, UINT_MAX, 40U, 65U, false), 50U,
+		      "did not play exactly the region");
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+
+	/* 0 sets: from the start of the region to the end of the payload. */
+	zassert_equal(audio_wav_memory_set_region(&clip, 140U, 0U, false), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, UINT_MAX, 140U, MEMORY_SETS, false),
+		      20U, "did not play to the end of the payload");
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_wav_memory, test_memory_loops_a_region)
+{
+	build_stereo_image(0U, MEMORY_SETS, MEMORY_SETS);
+
+	/* Five sets, shorter than a frame: every frame wraps, most of them
+	 * several times, and none is ever short.
+	 */
+	zassert_equal(audio_wav_memory_set_region(&clip, 7U, 5U, true), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, 20U, 7U, 12U, true),
+		      20U * MEMORY_FRAME_SAMPLES, "a looping source ran dry");
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+
+	/* The whole payload, looped. */
+	zassert_equal(audio_wav_memory_set_region(&clip, 0U, 0U, true), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), 0, "open failed");
+	zassert_equal(assert_plays(MEMORY_FRAME_SAMPLES, 30U, 0U, MEMORY_SETS, true),
+		      30U * MEMORY_FRAME_SAMPLES, "a looping source ran dry");
+	zassert_equal(audio_node_close(&clip), 0, "close failed");
+}
+
+ZTEST(audio_pipeline_wav_memory, test_memory_refuses_what_it_cannot_play)
+{
+	static const struct audio_stream_config other_rate = {
+		.sample_rate_hz = 48000U,
+		.channels = 2U,
+		.valid_bits_per_sample = 16U,
+		.format = AUDIO_SAMPLE_FORMAT_S32_LE,
+	};
+	const struct audio_wav_header eight_bit = {
+		.sample_rate_hz = 16000U,
+		.data_size = MEMORY_SETS,
+		.format_tag = AUDIO_WAV_FORMAT_PCM,
+		.channels = 1U,
+		.bits_per_sample = 8U,
+	};
+	struct audio_wav_memory_state *state = clip.state;
+
+	/* Not a WAVE image at all. */
+	build_stereo_image(0U, MEMORY_SETS, MEMORY_SETS);
+	memcpy(memory_image, "RIFX", 4);
+	zassert_equal(audio_node_open(&clip), -EINVAL, "garbage accepted");
+	zassert_false(state->is_open, "a refused image left the node open");
+
+	build_image(0U, &eight_bit, 0U);
+	zassert_equal(audio_node_open(&clip), -ENOTSUP, "8 bit accepted");
+
+	/* A format the pipeline did not bind. */
+	build_stereo_image(0U, MEMORY_SETS, MEMORY_SETS);
+	clip.pipeline_format = &other_rate;
+	zassert_equal(audio_node_open(&clip), -ENOTSUP, "a 16 kHz clip opened at 48 kHz");
+	clip.pipeline_format = NULL;
+
+	/* Regions the payload does not hold, and nothing to loop. */
+	zassert_equal(audio_wav_memory_set_region(&clip, MEMORY_SETS + 1U, 0U, false), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), -EINVAL, "a region past the payload");
+	zassert_equal(audio_wav_memory_set_region(&clip, 100U, 51U, false), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), -EINVAL, "a region running off the payload");
+	zassert_equal(audio_wav_memory_set_region(&clip, MEMORY_SETS, 0U, true), 0,
+		      "could not set the region");
+	zassert_equal(audio_node_open(&clip), -EINVAL, "an empty region looped");
+
+	zassert_equal(audio_wav_memory_set_region(NULL, 0U, 0U, false), -EINVAL,
+		      "NULL node accepted");
+	zassert_equal(audio_wav_memory_set_region(&clip_gain, 0U, 0U, false), -EINVAL,
+		      "a gain node has no region");
+}
+
+ZTEST_SUITE(audio_pipeline_wav_memory, NULL, NULL, memory_before, NULL, NULL);
@@ -76,8 +76,8 @@ int audio_test_write_raw(const char *path, const void *data, size_t len)
 
 int audio_test_write_wav(const char *path, const struct audio_test_wav_spec *spec)
 {
-	/* Canonical header plus the largest payload any test needs. */
-	uint8_t buf[AUDIO_WAV_MIN_HEADER_SIZE + 1024];
+	/* The largest header plus the largest payload any test needs. */
+	uint8_t buf[AUDIO_WAV_MAX_HEADER_SIZE + 1024];
 	const struct audio_wav_header hdr = {
 		.sample_rate_hz = (spec->sample_rate_hz != 0U) ? spec->sample_rate_hz : 48000U,
 		.data_size = (spec->declared_data_size != 0U) ? spec->declared_data_size
@@ -86,7 +86,8 @@ int audio_test_write_wav(const char *path, const struct audio_test_wav_spec *spe
 		.channels = (spec->channels != 0U) ? spec->channels : 2U,
 		.bits_per_sample = (spec->bits_per_sample != 0U) ? spec->bits_per_sample : 16U,
 	};
-	size_t len = AUDIO_WAV_MIN_HEADER_SIZE + spec->payload_len;
+	size_t header_size = audio_wav_header_size(&hdr);
+	size_t len = header_size + spec->payload_len;
 	int ret;
 
 	if (len > sizeof(buf)) {
@@ -103,7 +104,7 @@ int audio_test_write_wav(const char *path, const struct audio_test_wav_spec *spe
 	}
 
 	if (spec->payload_len > 0U) {
-		memcpy(&buf[AUDIO_WAV_MIN_HEADER_SIZE], spec->payload, spec->payload_len);
+		memcpy(&buf[header_size], spec->payload, spec->payload_len);
 	}
 
 	return audio_test_write_raw(path, buf, len);
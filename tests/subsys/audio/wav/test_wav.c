@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <string.h>
 
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/ztest.h>
 
@@ -99,6 +100,8 @@ ZTEST(audio_wav, test_wav_round_trips_every_supported_format)
 		zassert_equal(out.channels, hdr.channels, "case %zu: wrong channel count", i);
 		zassert_equal(out.bits_per_sample, hdr.bits_per_sample, "case %zu: wrong depth", i);
 		zassert_equal(out.format_tag, AUDIO_WAV_FORMAT_PCM, "case %zu: wrong tag", i);
+		zassert_equal(out.subformat_tag, AUDIO_WAV_FORMAT_PCM, "case %zu: wrong samples",
+			      i);
 		zassert_equal(out.data_size, hdr.data_size, "case %zu: wrong data size", i);
 		/* The derived pair: the writer computes them, the reader gets
 		 * them back out of the bytes.
@@ -151,13 +154,14 @@ ZTEST(audio_wav, test_wav_writes_a_payload_size_it_has_not_seen)
 
 ZTEST(audio_wav, test_wav_writes_a_foreign_format_tag_verbatim)
 {
-	static const uint16_t tags[] = { 0x0000U, 0x0002U, 0x0003U, 0x0006U, 0xfffeU };
+	/* 0x0003 is float, but of 16 bits, which nothing writes. */
+	static const uint16_t tags[] = { 0x0000U, 0x0002U, 0x0003U, 0x0006U, 0x0055U };
 	uint8_t buf[AUDIO_WAV_MIN_HEADER_SIZE];
 	struct audio_wav_header out;
 	size_t i;
 
 	/* The module serialises the tag it is given; the reader is the one that
-	 * draws the line: structurally fine, but not PCM.
+	 * draws the line: structurally fine, but not a format it reads.
 	 */
 	for (i = 0; i < ARRAY_SIZE(tags); i++) {
 		struct audio_wav_header hdr = {
@@ -175,6 +179,113 @@ ZTEST(audio_wav, test_wav_writes_a_foreign_format_tag_verbatim)
 	}
 }
 
+ZTEST(audio_wav, test_wav_round_trips_an_extensible_header)
+{
+	struct audio_wav_header hdr = {
+		.sample_rate_hz = TEST_SAMPLE_RATE,
+		.data_size = TEST_DATA_BYTES,
+		.format_tag = AUDIO_WAV_FORMAT_EXTENSIBLE,
+		.channels = 8U,
+		.bits_per_sample = 24U,
+		.valid_bits_per_sample = 20U,
+		/* 7.1: FL FR FC LFE BL BR SL SR */
+		.channel_mask = 0x63fU,
+	};
+	uint8_t buf[AUDIO_WAV_MAX_HEADER_SIZE + 16U];
+	struct audio_wav_header out;
+	size_t i;
+
+	zassert_equal(audio_wav_header_size(&hdr), AUDIO_WAV_EXTENSIBLE_HEADER_SIZE,
+		      "wrong size promised for an extensible header");
+
+	memset(buf, 0xa5, sizeof(buf));
+	write_header(buf, sizeof(buf), &hdr);
+	for (i = AUDIO_WAV_EXTENSIBLE_HEADER_SIZE; i < sizeof(buf); i++) {
+		zassert_equal(buf[i], 0xa5U, "the writer touched byte %zu, past the header", i);
+	}
+
+	zassert_equal(audio_wav_read_header(buf, sizeof(buf), &out), 0,
+		      "the module cannot read its own extensible header");
+	zassert_equal(out.format_tag, AUDIO_WAV_FORMAT_EXTENSIBLE, "wrong tag");
+	zassert_equal(out.subformat_tag, AUDIO_WAV_FORMAT_PCM, "an unset sub-format is not PCM");
+	zassert_equal(out.channels, 8U, "wrong channel count");
+	zassert_equal(out.bits_per_sample, 24U, "wrong depth");
+	zassert_equal(out.valid_bits_per_sample, 20U, "wrong valid bit count");
+	zassert_equal(out.channel_mask, 0x63fU, "wrong channel mask");
+	zassert_equal(out.block_align, 8U * 3U, "wrong block align");
+	zassert_equal(out.data_size, TEST_DATA_BYTES, "wrong data size");
+	zassert_equal(out.data_offset, AUDIO_WAV_EXTENSIBLE_HEADER_SIZE,
+		      "payload is not at byte 68");
+	zassert_equal(sys_get_le32(&buf[4]), AUDIO_WAV_EXTENSIBLE_HEADER_SIZE - 8U + TEST_DATA_BYTES,
+		      "RIFF size does not count the longer fmt chunk");
+
+	/* Left at 0 the valid bit count is the whole sample, both ways. */
+	hdr.valid_bits_per_sample = 0U;
+	write_header(buf, sizeof(buf), &hdr);
+	zassert_equal(audio_wav_read_header(buf, sizeof(buf), &out), 0, "header rejected");
+	zassert_equal(out.valid_bits_per_sample, 24U, "an unset valid bit count read back short");
+
+	/* The 24 extra header bytes come off the largest payload. */
+	hdr.data_size = audio_wav_max_data_size(&hdr);
+	zassert_equal(hdr.data_size, AUDIO_WAV_MAX_DATA_SIZE - 24U, "wrong payload cap");
+	zassert_equal(audio_wav_write_header(buf, sizeof(buf), &hdr), 0,
+		      "the largest describable payload was rejected");
+	hdr.data_size++;
+	zassert_equal(audio_wav_write_header(buf, sizeof(buf), &hdr), -EFBIG,
+		      "an undescribable payload size was accepted");
+}
+
+ZTEST(audio_wav, test_wav_round_trips_float_headers)
+{
+	struct audio_wav_header hdr = {
+		.sample_rate_hz = TEST_SAMPLE_RATE,
+		.data_size = TEST_DATA_BYTES,
+		.format_tag = AUDIO_WAV_FORMAT_IEEE_FLOAT,
+		.channels = TEST_CHANNELS,
+		.bits_per_sample = 32U,
+	};
+	uint8_t buf[AUDIO_WAV_MAX_HEADER_SIZE];
+	struct audio_wav_header out;
+
+	/* The plain layout, tag and all, and the 44 bytes of a PCM one. */
+	zassert_equal(audio_wav_header_size(&hdr), AUDIO_WAV_MIN_HEADER_SIZE,
+		      "a float header is not the canonical size");
+	write_header(buf, sizeof(buf), &hdr);
+	zassert_equal(audio_wav_read_header(buf, sizeof(buf), &out), 0,
+		      "the module cannot read its own float header");
+	zassert_equal(out.format_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "wrong tag");
+	zassert_equal(out.subformat_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "wrong samples");
+	zassert_equal(out.bits_per_sample, 32U, "wrong depth");
+	zassert_equal(out.block_align, TEST_CHANNELS * 4U, "wrong block align");
+	zassert_equal(out.data_offset, AUDIO_WAV_MIN_HEADER_SIZE, "payload is not at byte 44");
+
+	/* And the extensible one, which names float by its GUID. */
+	hdr.format_tag = AUDIO_WAV_FORMAT_EXTENSIBLE;
+	hdr.subformat_tag = AUDIO_WAV_FORMAT_IEEE_FLOAT;
+	hdr.channels = 6U;
+	write_header(buf, sizeof(buf), &hdr);
+	zassert_equal(audio_wav_read_header(buf, sizeof(buf), &out), 0,
+		      "the module cannot read its own extensible float header");
+	zassert_equal(out.format_tag, AUDIO_WAV_FORMAT_EXTENSIBLE, "wrong tag");
+	zassert_equal(out.subformat_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "wrong samples");
+	zassert_equal(out.channels, 6U, "wrong channel count");
+	zassert_equal(out.valid_bits_per_sample, 32U, "wrong valid bit count");
+	zassert_equal(out.data_offset, AUDIO_WAV_EXTENSIBLE_HEADER_SIZE,
+		      "payload is not at byte 68");
+}
+
+ZTEST(audio_wav, test_wav_reads_a_plain_header_as_full_width_unmapped)
+{
+	uint8_t buf[AUDIO_WAV_MIN_HEADER_SIZE];
+	struct audio_wav_header out;
+
+	write_valid_header(buf, sizeof(buf));
+
+	zassert_equal(audio_wav_read_header(buf, sizeof(buf), &out), 0, "header rejected");
+	zassert_equal(out.valid_bits_per_sample, TEST_BITS, "a plain header read back short");
+	zassert_equal(out.channel_mask, 0U, "a plain header grew a channel mask");
+}
+
 ZTEST(audio_wav, test_wav_write_rejects_bad_arguments)
 {
 	const struct audio_wav_header hdr = {
@@ -194,6 +305,29 @@ ZTEST(audio_wav, test_wav_write_rejects_bad_arguments)
 		      "a buffer one byte short of the header accepted");
 }
 
+ZTEST(audio_wav, test_wav_write_sizes_the_buffer_check_by_the_layout)
+{
+	struct audio_wav_header hdr = {
+		.sample_rate_hz = TEST_SAMPLE_RATE,
+		.data_size = TEST_DATA_BYTES,
+		.format_tag = AUDIO_WAV_FORMAT_EXTENSIBLE,
+		.channels = TEST_CHANNELS,
+		.bits_per_sample = TEST_BITS,
+	};
+	uint8_t buf[AUDIO_WAV_MAX_HEADER_SIZE];
+
+	/* Room for a canonical header is not room for an extensible one. */
+	zassert_equal(audio_wav_write_header(buf, AUDIO_WAV_MIN_HEADER_SIZE, &hdr), -EINVAL,
+		      "an extensible header written into 44 bytes");
+	zassert_equal(audio_wav_write_header(buf, AUDIO_WAV_EXTENSIBLE_HEADER_SIZE - 1U, &hdr),
+		      -EINVAL, "a buffer one byte short of the header accepted");
+
+	/* Nor can a sample carry more signal than its bits. */
+	hdr.valid_bits_per_sample = TEST_BITS + 1U;
+	zassert_equal(audio_wav_write_header(buf, sizeof(buf), &hdr), -EINVAL,
+		      "more valid bits than bits accepted");
+}
+
 ZTEST(audio_wav, test_wav_write_rejects_headers_the_reader_would_reject)
 {
 	static const struct audio_wav_header cases[] = {
@@ -311,6 +445,32 @@ static void wb_fmt(struct wav_builder *b, uint16_t format_tag, uint16_t channels
 	wb_u16(b, bits);
 }
 
+/* A 40 byte extensible fmt naming @p subformat_tag by the usual GUID. */
+static void wb_fmt_extensible(struct wav_builder *b, uint16_t channels, uint16_t bits,
+			      uint16_t valid_bits, uint16_t subformat_tag)
+{
+	static const uint8_t guid_tail[14] = {
+		0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71,
+	};
+	uint16_t block_align = (uint16_t)(channels * (bits / 8U));
+
+	wb_tag(b, "fmt ");
+	wb_u32(b, 40U);
+	wb_u16(b, AUDIO_WAV_FORMAT_EXTENSIBLE);
+	wb_u16(b, channels);
+	wb_u32(b, TEST_SAMPLE_RATE);
+	wb_u32(b, TEST_SAMPLE_RATE * block_align);
+	wb_u16(b, block_align);
+	wb_u16(b, bits);
+	wb_u16(b, 22U);
+	wb_u16(b, valid_bits);
+	wb_u32(b, 0U);
+	wb_u16(b, subformat_tag);
+	for (size_t i = 0; i < sizeof(guid_tail); i++) {
+		wb_u8(b, guid_tail[i]);
+	}
+}
+
 static void wb_fmt_default(struct wav_builder *b)
 {
 	wb_fmt(b, AUDIO_WAV_FORMAT_PCM, TEST_CHANNELS, TEST_SAMPLE_RATE, TEST_BITS);
@@ -586,4 +746,105 @@ ZTEST(audio_wav, test_wav_rejects_oversized_bit_depth)
 	zassert_equal(read_built_header(&b, &res), -EINVAL, "64-bit sample depth accepted");
 }
 
+ZTEST(audio_wav, test_wav_reads_extensible_pcm_from_another_writer)
+{
+	struct audio_wav_header res;
+	struct wav_builder b;
+	size_t data_offset;
+
+	wb_start(&b);
+	wb_fmt_extensible(&b, 6U, 16U, 16U, AUDIO_WAV_FORMAT_PCM);
+	wb_chunk(&b, "fact", 4U);
+	data_offset = wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+
+	zassert_equal(read_built_header(&b, &res), 0, "extensible PCM rejected");
+	zassert_equal(res.format_tag, AUDIO_WAV_FORMAT_EXTENSIBLE, "wrong tag");
+	zassert_equal(res.channels, 6U, "wrong channel count");
+	zassert_equal(res.data_offset, (uint32_t)data_offset, "chunk walk found wrong offset");
+}
+
+ZTEST(audio_wav, test_wav_reads_float_from_another_writer)
+{
+	struct audio_wav_header res;
+	struct wav_builder b;
+	size_t data_offset;
+
+	/* The 18 byte fmt and the fact chunk most tools write float with. */
+	wb_start(&b);
+	wb_fmt(&b, AUDIO_WAV_FORMAT_IEEE_FLOAT, TEST_CHANNELS, TEST_SAMPLE_RATE, 32U);
+	sys_put_le32(18U, &b.buf[b.len - 20U]);
+	wb_u16(&b, 0U);
+	wb_chunk(&b, "fact", 4U);
+	data_offset = wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+
+	zassert_equal(read_built_header(&b, &res), 0, "float rejected");
+	zassert_equal(res.format_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "wrong tag");
+	zassert_equal(res.subformat_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "wrong samples");
+	zassert_equal(res.data_offset, (uint32_t)data_offset, "chunk walk found wrong offset");
+
+	/* KSDATAFORMAT_SUBTYPE_IEEE_FLOAT. */
+	wb_start(&b);
+	wb_fmt_extensible(&b, TEST_CHANNELS, 32U, 32U, AUDIO_WAV_FORMAT_IEEE_FLOAT);
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+	zassert_equal(read_built_header(&b, &res), 0, "an extensible float rejected");
+	zassert_equal(res.subformat_tag, AUDIO_WAV_FORMAT_IEEE_FLOAT, "wrong samples");
+
+	/* Doubles are a format this module does not read, not a corrupt one. */
+	wb_start(&b);
+	wb_fmt(&b, AUDIO_WAV_FORMAT_IEEE_FLOAT, TEST_CHANNELS, TEST_SAMPLE_RATE, 64U);
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+	zassert_equal(read_built_header(&b, &res), -ENOTSUP, "64-bit float accepted");
+
+	wb_start(&b);
+	wb_fmt_extensible(&b, TEST_CHANNELS, 64U, 64U, AUDIO_WAV_FORMAT_IEEE_FLOAT);
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+	zassert_equal(read_built_header(&b, &res), -ENOTSUP, "64-bit extensible float accepted");
+}
+
+ZTEST(audio_wav, test_wav_rejects_extensible_that_is_not_pcm_or_float)
+{
+	struct audio_wav_header res;
+	struct wav_builder b;
+
+	/* KSDATAFORMAT_SUBTYPE_ALAW: the right shape, the wrong payload. */
+	wb_start(&b);
+	wb_fmt_extensible(&b, TEST_CHANNELS, 8U, 8U, 0x0006U);
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+	zassert_equal(read_built_header(&b, &res), -ENOTSUP, "an A-law sub-format accepted");
+
+	/* The PCM tag in a GUID that is otherwise some other family's. */
+	wb_start(&b);
+	wb_fmt_extensible(&b, TEST_CHANNELS, TEST_BITS, TEST_BITS, AUDIO_WAV_FORMAT_PCM);
+	b.buf[12U + 8U + 24U + 15U] ^= 0xffU;
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+	zassert_equal(read_built_header(&b, &res), -ENOTSUP, "a foreign GUID accepted");
+
+	/* An extensible tag on a 16 byte fmt names no sub-format at all. */
+	wb_start(&b);
+	wb_fmt(&b, AUDIO_WAV_FORMAT_EXTENSIBLE, TEST_CHANNELS, TEST_SAMPLE_RATE, TEST_BITS);
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+	zassert_equal(read_built_header(&b, &res), -ENOTSUP, "a missing sub-format accepted");
+}
+
+ZTEST(audio_wav, test_wav_rejects_more_valid_bits_than_bits)
+{
+	struct audio_wav_header res;
+	struct wav_builder b;
+
+	wb_start(&b);
+	wb_fmt_extensible(&b, TEST_CHANNELS, TEST_BITS, TEST_BITS + 8U, AUDIO_WAV_FORMAT_PCM);
+	(void)wb_data(&b, TEST_DATA_BYTES);
+	wb_finish(&b);
+
+	zassert_equal(read_built_header(&b, &res), -EINVAL, "24 valid bits in 16 accepted");
+}
+
 ZTEST_SUITE(audio_wav, NULL, NULL, NULL, NULL, NULL);